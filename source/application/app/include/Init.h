@@ -36,7 +36,7 @@
 #define _INCLUDE_APP_INIT_H_
 
 /* We need to have the state values mapping to Intel SuC Communication Dev State*/
-#include <intel_suc_comm.h>
+#include <Intel_SuC_Comm.h>
 #include <stdint.h>
 
 /**
@@ -71,7 +71,8 @@ typedef enum xBIT_SHIFTS {
 /* user mode event handler bit definitions
  * These events are interpreted by the user mode application task
  */
-/* Bit 0 and 1 reserved for future */
+#define eventsBIOS_COMMAND			(1<<eBIT_SHIFT0)	/**< Intel command queued for user mode */
+#define eventsLE_PROXIMITY_CHANGE		(1<<eBIT_SHIFT1)	/**< LE status line changed level */
 #define eventsKEYFOB_NFC_AUTH_SUCCESS		(1<<eBIT_SHIFT2)	/**< NFC Authentication success event */
 #define eventsKEYFOB_NFC_AUTH_FAILURE		(1<<eBIT_SHIFT3)	/**< NFC Authentication Failure event */
 #define eventsKEYFOB_NFC_ASSOCIATION_SUCCESS	(1<<eBIT_SHIFT4)	/**< NFC association success event */
@@ -47,6 +47,7 @@
 #define pinentryGET_PASSWORD	(1 << 1)/**<Event bit for tap detection enable and read password */
 #define pinentryKEY_PRESS	(1 << 2)/**<Key press event can be long/short*/
 #define pinentryUSER_GET_PSWD	(1 << 3)/**<Event bit for pin entry and read password for user mode */
+#define pinentryKEY_DOUBLE_PRESS	(1 << 4)/**<Power button pressed twice within the double press window */
 
 /** Text displayed on oled */
 #define pinentryTEXT_ZERO	"0"
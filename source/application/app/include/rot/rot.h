@@ -80,6 +80,23 @@ void vRotModeTask( void *pvArg );
 
 void vRotRsaEncryption(uint8_t *pucMessage ,uint8_t *pucEncryptedMsg);
 
+/**
+ * @brief This function provisions the ROT RSA public key
+ *
+ * The key is stored in binary form in flash along with R^2 mod N, so it is
+ * used by vRotRsaEncryption() without parsing or recomputing it.
+ *
+ * @param pucN modulus, big endian, of enckeysROT_RSA_N_LEN bytes
+ * @param ulNLen length of modulus
+ * @param pucE public exponent, big endian
+ * @param ulELen length of exponent, at most enckeysROT_RSA_E_LEN
+ *
+ * @return NO_ERROR on success
+ *			error code on failure
+ */
+int32_t lRotRsaProvisionKey( const uint8_t *pucN, uint32_t ulNLen,
+	const uint8_t *pucE, uint32_t ulELen );
+
 /**
  * @brief This function generates SSD password and store on NVSRAM
  *
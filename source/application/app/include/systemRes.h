@@ -256,6 +256,9 @@ void vSystemResEraseAllKeys( void );
 /**
  * @brief This function will configure the LE Interrupt GPIO pin as input pin.
  *
+ * Both edges of the pin interrupt and set eventsLE_PROXIMITY_CHANGE in the user
+ * mode event group.
+ *
  * @return void
  */
 void vSystemResBT_GPIO_Config( void );
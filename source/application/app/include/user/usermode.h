@@ -84,6 +84,16 @@
 #define usermodeLE_MAX_RETRY			(300)		/**< Maximum LE alive check retry after NFC authentication */
 #define usermodeLE_NUM_OF_BYTES			(3)		/**< No of bytes to read to check GPIO status */
 #define usermodeLE_MAX_RETRY_UNLOCK_STATE	(15)		/**< Value for 9 seconds LE alive check retry in unlock state */
+#define usermodeLE_SAMPLE_PERIOD		(600)		/**< LE proximity sample period in unlock state, milliseconds */
+#define usermodeLE_LOST_HOLD			(usermodeLE_MAX_RETRY_UNLOCK_STATE * \
+						usermodeLE_SAMPLE_PERIOD) /**< Time LE line must report the peer lost in unlock state */
+#define usermodeLE_RESPONSE_TIMEOUT		(usermodeLE_MAX_RETRY * usermodeDELAY_MSEC_100) /**< Time for the peer to answer a new seed */
+#define usermodeLE_DEBOUNCE			(50)		/**< Time LE line must stay low to report the peer in proximity, milliseconds */
+
+/** Events the unlock state waits for */
+#define usermodeUNLOCKED_EVENTS			( eventsKEY_PRESS_SHORT | eventsKEY_PRESS_LONG | \
+						  eventsPROXIMITY_TIMEOUT | eventsLE_TIMER_OUT | \
+						  eventsBIOS_COMMAND | eventsLE_PROXIMITY_CHANGE )
 
 #define usermodeKEYFOB_SERIAL_LEN		(4)		/**< KeyFob serial length */
 #define usermodePWRBTN_LOW			(0)		/**< Power button status low */
@@ -164,9 +174,6 @@ typedef struct xSUC_SM_GLOBAL_RESOURCE_APPLICATION {
 	/** Queue to data transfer between nfc task and user application */
 	QueueHandle_t xNfcQueue;
 
-	/** Binary semaphore for I2C synchronization */
-	SemaphoreHandle_t prvI2CSemaphore;
-
 	/** Queue to transfer data between Intel suc task and user app
 	 * This Queue will be updated by Intel */
 	QueueHandle_t xSucBiosSendQueue;
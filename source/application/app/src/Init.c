@@ -47,6 +47,7 @@
 #include <mfgdata.h>
 #include <keyfobid.h>
 #include <orwl_disp_interface.h>
+#include <orwl_oled.h>
 #include <delay.h>
 #include <orwl_err.h>
 #include <mem_common.h>
@@ -80,7 +81,7 @@ int32_t lInitGetSuCBootMode( uint32_t *pulProdCycle )
 int32_t lInitSystemStateCheck( uint32_t ulProdCycle )
 {
     int32_t lResult = NO_ERROR;
-    devtamperTamperHist_t *pxTamperHistory;
+    devtamperLogEvent_t xLastTamper;
     uint32_t ulDevState = eBOOTMODE_DEV_USER_TAMPER;
     keysDSFT_MASTER_KEYS_t *pxMasterKeys;
     uint32_t ulSecalm = 0;
@@ -111,11 +112,8 @@ int32_t lInitSystemStateCheck( uint32_t ulProdCycle )
 	/* power OFF Intel sub-system. Should be NON-RTOS API */
 	gpioIntelCpuShutdown();
 
-	/* Memory allocation for tamper history storing */
-	pxTamperHistory = pvPortMalloc(sizeof(devtamperTamperHist_t));
-	configASSERT(pxTamperHistory != NULL);
-	/* memset tamper history buffer to 0xff */
-	memset(pxTamperHistory, 0xff, sizeof(devtamperTamperHist_t));
+	/* memset last tamper event to 0xff */
+	memset(&xLastTamper, 0xff, sizeof(xLastTamper));
 
 	/* Memory allocation for reading access key structure */
 	pxMasterKeys = pvPortMalloc(sizeof(keysDSFT_MASTER_KEYS_t));
@@ -129,8 +127,8 @@ int32_t lInitSystemStateCheck( uint32_t ulProdCycle )
 	 */
 	IO_READ_U32(secmonDLRTC, ulSecDLRTC);
 
-	/* Read the tamper structure from flash */
-	lResult = lDevtamperReadTampHistory(pxTamperHistory);
+	/* Read the last tamper event from flash */
+	lResult = lDevtamperLogGetLast(devtamperEVENT_TAMPER, &xLastTamper);
 	if(lResult != NO_ERROR)
 	{
 	    debugPRINT("There is no tamper history in flash, same will be updated \n");
@@ -148,25 +146,8 @@ int32_t lInitSystemStateCheck( uint32_t ulProdCycle )
 	 * if it does matches than this tamper is different than that of updated
 	 * in flash so update the tamper structure with new data in flash.
 	 */
-	if(ulSecDLRTC != pxTamperHistory->xTamperEvent[0].ulDRSLogRTC)
+	if(ulSecDLRTC != xLastTamper.ulTime)
 	{
-	    /* Update new DRS log RTC to tamper structure */
-	    pxTamperHistory->xTamperEvent[0].ulDRSLogRTC = ulSecDLRTC;
-
-	    /* Now convert the 32 bit second DRS Log RTC register value to human
-	     * readable values in rtcDateTime_t format.
-	     */
-	    lResult = lRtcConvertRawToDateTime(
-		    pxTamperHistory->xTamperEvent[0].ulDRSLogRTC,
-		    &pxTamperHistory->xTamperEvent[0].xTamperDateTime);
-	    if(lResult != NO_ERROR)
-	    {
-		/* Just show error message on console. Should not go to error state
-		 * because this tamper might have occurred because of RTC.
-		 */
-		debugERROR_PRINT("Failed to convert raw to date and time..\n");
-	    }
-
 	    /* Read security monitor status register */
 	    IO_READ_U32(secmonSECST, ulSecStatus);
 
@@ -195,14 +176,9 @@ int32_t lInitSystemStateCheck( uint32_t ulProdCycle )
 		IO_READ_U32(secmonSECALM, ulSecalm);
 	    }
 
-	    /* Update the tamper cause */
-	    pxTamperHistory->xTamperEvent[0].ultamperCause = ulSecalm;
-
-	    /* Event type */
-	    pxTamperHistory->xTamperEvent[0].ulEventTyype = devtamperEVENT_TAMPER;
-
-	    /*Write tamper history */
-	    lResult = lDevtamperWriteTampHistoryNONRTOS(pxTamperHistory);
+	    /* Append the tamper event, with its cause, to tamper history */
+	    lResult = lDevtamperLogAppendNONRTOS(devtamperEVENT_TAMPER,
+		    ulSecDLRTC, ulSecalm);
 	    if( lResult != NO_ERROR )
 	    {
 		debugERROR_PRINT("Failed to write tamper history..\n");
@@ -240,10 +216,6 @@ int32_t lInitSystemStateCheck( uint32_t ulProdCycle )
 
 	ERRORSTATE :
 	/* release allocated resources */
-	if(pxTamperHistory)
-	{
-	    vPortFree(pxTamperHistory);
-	}
 	if(pxMasterKeys)
 	{
 	    vPortFree(pxMasterKeys);
@@ -339,6 +311,8 @@ void vInitDisplayTamperScreen ( void )
 
 void vInitDisplayTamperScreenNONRTOS ( void )
 {
+    /* May run in the NMI during a display update */
+    vOledFbDirect();
     vDisplayClearScreenNONRTOS(dispWELCOME_IMGLTX, dispWELCOME_IMGLTY,
 	    dispWELCOME_IMGRBX, dispWELCOME_IMGRBY, dispBACKGROUND_BLACK);
 
@@ -58,12 +58,12 @@
 #include <oled_ui.h>
 #include <nvsram.h>
 #include <events.h>
-#include <init.h>
+#include <Init.h>
 #include <reset.h>
 #include <mfgdata.h>
 #include <powerbtn.h>
 #include <irq.h>
-#include <init.h>
+#include <Init.h>
 #include <usermode.h>
 #include <nfc_common.h>
 #include <systemRes.h>
@@ -315,11 +315,6 @@ static void prvOobUnlockedState(eSuCOobStates *xpDevState,
 	vPortFree(pucHashOLED);
     }
 
-    /* Enable TAP detection thread */
-#ifdef ENABLE_MPU_GIO_INTERRUPT
-    /* Resume Tap detection task */
-    vTaskResume(pxResHandle->xMpuFifoTskHandle);
-#endif
     /* Wait for TAP/Timeout */
 #ifdef ENABLE_TAP_FEATURE
     xBits = xEventGroupWaitBits(pxResHandle->xEventGroupPinEntry,
@@ -363,10 +358,6 @@ static void prvOobUnlockedState(eSuCOobStates *xpDevState,
 	resetSYSTEM_RESET;
     }
 
-    /* Disable TAP detection thread */
-#ifdef ENABLE_MPU_GIO_INTERRUPT
-    vTaskSuspend(pxResHandle->xMpuFifoTskHandle);
-#endif
     vUiMessageDisplay((const int8_t *)uiUSER_KEY_MSG,
 		    uiXCORDINATE_0 ,uiYCORDINATE_C);
     vTaskDelay(uiTHREE_SEC_DELAY);
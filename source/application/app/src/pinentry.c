@@ -61,7 +61,7 @@
 #include <trng.h>
 #include <irq.h>
 #include <powerbtn.h>
-#include <init.h>
+#include <Init.h>
 
 extern xSMAppResources_t xgResource;
 
@@ -110,10 +110,6 @@ void vPinentryTask(void *pvArg)
 	    debugPRINT_APP("Got pinentryGET_PASSWORD\n");
 	    /* In oob mode set xTicksToWaitForButtonPress to portMAX_DELAY */
 	    xTicksToWaitForButtonPress = portMAX_DELAY;
-#ifdef ENABLE_MPU_GIO_INTERRUPT
-	    /* Resume Tap detection task */
-	    vTaskResume(xgResource.xMpuFifoTskHandle);
-#endif
 	    xEventGroupClearBits(pxResHandle->xEventGroupPinEntry, xBits);
 	}
 	else if(xBits & pinentryUSER_GET_PSWD)
@@ -399,11 +395,6 @@ void vPinentryTask(void *pvArg)
 	    vUiClearCursor(uiCURSOR_POS_0 + ucDispCount, uiYCORDINATE_1);
 	    if(ucPinIndex == pinentryPIN_LENGTH)
 	    {
-#ifdef ENABLE_MPU_GIO_INTERRUPT
-		/* collected password. suspend the pin entry read task again */
-		vTaskSuspend(xgResource.xMpuFifoTskHandle);
-#endif
-
 		debugPRINT_APP("Sending password to the initiator: ");
 		xData.lStatus = NO_ERROR;
 		xQueueSend(pxResHandle->xPinQueue, &xData, portMAX_DELAY);
@@ -58,12 +58,12 @@
 #include <oled_ui.h>
 #include <nvsram.h>
 #include <events.h>
-#include <init.h>
+#include <Init.h>
 #include <reset.h>
 #include <mfgdata.h>
 #include <powerbtn.h>
 #include <irq.h>
-#include <init.h>
+#include <Init.h>
 #include <usermode.h>
 #include <nfc_common.h>
 #include <systemRes.h>
@@ -44,6 +44,8 @@
 #include <trng.h>
 #include <access_keys.h>
 #include <mfgdata.h>
+#include <enckeys.h>
+#include <mem_common.h>
 #include <pinentry.h>
 #include <nvsram.h>
 #include <rtc.h>
@@ -51,13 +53,13 @@
 #include <mbedtls/pk.h>
 #include <events.h>
 #include <user_config.h>
-#include <intel_suc_comm.h>
+#include <Intel_SuC_Comm.h>
 #include <orwl_err.h>
 #include <oled_ui.h>
 #include <orwl_gpio.h>
 #include <mfgdata.h>
 
-/** Modulus for encrypting data */
+/** Default modulus for encrypting data, provisioned to flash on first use */
 #define rotRSA_N "df5bb8a343906d96c7a8fff6a6fffffba1937245c39a05f9adcb756ba59d" \
 		 "81249508719b91e0aa2f2ef3e4ee2026c08c4f2107bc0a7965419aa3dab2" \
 		 "0ac80d60727b3d86dc736d64b49b8898ff1d4d3a90b6b840e4018b88cd34" \
@@ -68,7 +70,7 @@
 		 "9bf54b19541b423fd1c1c3d13ab5af53753fc5eb8aa06c76bd10ce821a8b" \
 		 "197e562702a57e463943c5b12cb6fb2f"
 
-/** Public key exponent for encryption */
+/** Default public key exponent for encryption */
 #define rotRSA_E "10001"
 
 #define rotBASEVALUE_FOR_HEX		(16)	/** Base value for hexadecimal */
@@ -84,6 +86,12 @@
 
 /** global resource handler */
 extern xSMAppResources_t xgResource;
+
+/** ROT RSA public key context, kept across encryptions */
+static mbedtls_rsa_context xRotRsa;
+
+/** set once xRotRsa holds the provisioned key */
+static uint8_t ucRotRsaReady;
 /**
  * @brief function pointer table holds various function pointers to
  * to handle different states in OOB mode.
@@ -214,6 +222,16 @@ static uint32_t prvSetUserConfiguration ( void );
  */
 static uint8_t prvWriteSSDSerialNUM( IntelUserData_t *xIntelUserData, uint32_t *ulIsOsInstalled );
 
+/**
+ * @brief This function sets up the ROT RSA context from the key provisioned
+ * in flash. The built in key is provisioned if flash holds none. Once set up,
+ * the context is reused and an encryption only costs the exponentiation.
+ *
+ * @return NO_ERROR on success
+ *	   error code on failure
+ */
+static int32_t prvRotRsaLoadKey( void );
+
 /*---------------------------------------------------------------------------*/
 
 static void (*prvROTModeStates[eSTATE_ROT_MAX])(eSuCRotStates *pxDevState,
@@ -1074,22 +1092,8 @@ void vRotRsaEncryption(uint8_t *pucMessage ,uint8_t *pucEncryptedMsg)
     configASSERT(pucMessage != NULL);
     configASSERT(pucEncryptedMsg != NULL);
 
-    mbedtls_rsa_context xRsa;
-    /* Initialize the RSA context */
-    mbedtls_rsa_init( &xRsa, MBEDTLS_RSA_PKCS_V15, 0 );
-
-    xRsa.len = rotENCRYPTED_MSG_SIZE;
-    /* Convert data in hex & assign to RSA Structure */
-    lRet = mbedtls_mpi_read_string( &xRsa.N, rotBASEVALUE_FOR_HEX, rotRSA_N );
-    lRet |= mbedtls_mpi_read_string( &xRsa.E, rotBASEVALUE_FOR_HEX, rotRSA_E );
-    if( lRet )
-    {
-	debugPRINT("Failed to convert in hex format.. \n");
-	while(1);
-    }
-
-    /* Check for the validation of public key */
-    lRet = mbedtls_rsa_check_pubkey( &xRsa );
+    /* Set up the public key on first use */
+    lRet = prvRotRsaLoadKey( );
     if( lRet )
     {
 	debugPRINT("Invalid public key..\n");
@@ -1097,7 +1101,7 @@ void vRotRsaEncryption(uint8_t *pucMessage ,uint8_t *pucEncryptedMsg)
     }
 
     /* Encryption of msg */
-    lRet = mbedtls_rsa_pkcs1_encrypt( &xRsa, ucTrue_Rand, NULL,
+    lRet = mbedtls_rsa_pkcs1_encrypt( &xRotRsa, ucTrue_Rand, NULL,
 	    MBEDTLS_RSA_PUBLIC, rotMAX_DATA_SIZE, pucMessage, pucEncryptedMsg);
     if( lRet )
     {
@@ -1107,6 +1111,151 @@ void vRotRsaEncryption(uint8_t *pucMessage ,uint8_t *pucEncryptedMsg)
 }
 /*---------------------------------------------------------------------------*/
 
+int32_t lRotRsaProvisionKey( const uint8_t *pucN, uint32_t ulNLen,
+	const uint8_t *pucE, uint32_t ulELen )
+{
+    enckeysRotRsaKey_t *pxKey;
+    mbedtls_rsa_context xRsa;
+    int32_t lRet;
+
+    if( ( pucN == NULL ) || ( pucE == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( ( ulNLen != enckeysROT_RSA_N_LEN ) || ( ulELen == 0 ) ||
+	    ( ulELen > enckeysROT_RSA_E_LEN ) )
+    {
+	return COMMON_ERR_INVAL;
+    }
+
+    pxKey = pvPortMalloc(sizeof(enckeysRotRsaKey_t));
+    if( pxKey == NULL )
+    {
+	debugERROR_PRINT("Failed to allocate memory\n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    memset(pxKey, 0, sizeof(enckeysRotRsaKey_t));
+    mbedtls_rsa_init( &xRsa, MBEDTLS_RSA_PKCS_V15, 0 );
+
+    lRet = mbedtls_mpi_read_binary( &xRsa.N, pucN, ulNLen );
+    lRet |= mbedtls_mpi_read_binary( &xRsa.E, pucE, ulELen );
+    xRsa.len = mbedtls_mpi_size( &xRsa.N );
+    if( lRet || ( xRsa.len != enckeysROT_RSA_N_LEN ) ||
+	    mbedtls_rsa_check_pubkey( &xRsa ) )
+    {
+	debugERROR_PRINT("Invalid public key\n");
+	lRet = COMMON_ERR_INVAL;
+	goto cleanup;
+    }
+
+    /* Montgomery constant as computed by mbedtls_mpi_exp_mod(), the modulus
+     * fills all of its limbs so R = 2^(8 * enckeysROT_RSA_N_LEN)
+     */
+    lRet = mbedtls_mpi_lset( &xRsa.RN, 1 );
+    lRet |= mbedtls_mpi_shift_l( &xRsa.RN, 2 * 8 * enckeysROT_RSA_N_LEN );
+    lRet |= mbedtls_mpi_mod_mpi( &xRsa.RN, &xRsa.RN, &xRsa.N );
+    lRet |= mbedtls_mpi_write_binary( &xRsa.N, pxKey->ucN,
+	    sizeof(pxKey->ucN) );
+    lRet |= mbedtls_mpi_write_binary( &xRsa.E, pxKey->ucE,
+	    sizeof(pxKey->ucE) );
+    lRet |= mbedtls_mpi_write_binary( &xRsa.RN, pxKey->ucRR,
+	    sizeof(pxKey->ucRR) );
+    if( lRet )
+    {
+	debugERROR_PRINT("Failed to compute key constants\n");
+	goto cleanup;
+    }
+
+    lRet = lEnckeysWriteRotRsaKey( pxKey );
+    if( lRet != NO_ERROR )
+    {
+	goto cleanup;
+    }
+
+    /* Next encryption picks up the new key */
+    if( ucRotRsaReady )
+    {
+	mbedtls_rsa_free( &xRotRsa );
+	ucRotRsaReady = 0;
+    }
+
+cleanup:
+    mbedtls_rsa_free( &xRsa );
+    vPortFree(pxKey);
+    return lRet;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvRotRsaLoadKey( void )
+{
+    enckeysRotRsaKey_t *pxKey;
+    mbedtls_mpi xN;
+    mbedtls_mpi xE;
+    int32_t lRet;
+
+    if( ucRotRsaReady )
+    {
+	return NO_ERROR;
+    }
+
+    pxKey = pvPortMalloc(sizeof(enckeysRotRsaKey_t));
+    if( pxKey == NULL )
+    {
+	debugERROR_PRINT("Failed to allocate memory\n");
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    lRet = lEnckeysReadRotRsaKey( pxKey );
+    if( lRet == commonPARTITIONNONE )
+    {
+	/* Not provisioned yet, store the built in key */
+	mbedtls_mpi_init( &xN );
+	mbedtls_mpi_init( &xE );
+	lRet = mbedtls_mpi_read_string( &xN, rotBASEVALUE_FOR_HEX, rotRSA_N );
+	lRet |= mbedtls_mpi_read_string( &xE, rotBASEVALUE_FOR_HEX, rotRSA_E );
+	lRet |= mbedtls_mpi_write_binary( &xN, pxKey->ucN, sizeof(pxKey->ucN) );
+	lRet |= mbedtls_mpi_write_binary( &xE, pxKey->ucE, sizeof(pxKey->ucE) );
+	mbedtls_mpi_free( &xN );
+	mbedtls_mpi_free( &xE );
+	if( lRet == 0 )
+	{
+	    lRet = lRotRsaProvisionKey( pxKey->ucN, sizeof(pxKey->ucN),
+		    pxKey->ucE, sizeof(pxKey->ucE) );
+	}
+	if( lRet == NO_ERROR )
+	{
+	    lRet = lEnckeysReadRotRsaKey( pxKey );
+	}
+    }
+    if( lRet != NO_ERROR )
+    {
+	debugERROR_PRINT("Failed to read ROT RSA key\n");
+	goto cleanup;
+    }
+
+    mbedtls_rsa_init( &xRotRsa, MBEDTLS_RSA_PKCS_V15, 0 );
+    lRet = mbedtls_mpi_read_binary( &xRotRsa.N, pxKey->ucN,
+	    sizeof(pxKey->ucN) );
+    lRet |= mbedtls_mpi_read_binary( &xRotRsa.E, pxKey->ucE,
+	    sizeof(pxKey->ucE) );
+    /* exponentiation takes R^2 mod N as is when already set */
+    lRet |= mbedtls_mpi_read_binary( &xRotRsa.RN, pxKey->ucRR,
+	    sizeof(pxKey->ucRR) );
+    xRotRsa.len = mbedtls_mpi_size( &xRotRsa.N );
+    if( lRet || mbedtls_rsa_check_pubkey( &xRotRsa ) )
+    {
+	mbedtls_rsa_free( &xRotRsa );
+	lRet = COMMON_ERR_INVAL;
+	goto cleanup;
+    }
+    ucRotRsaReady = 1;
+
+cleanup:
+    vPortFree(pxKey);
+    return lRet;
+}
+/*---------------------------------------------------------------------------*/
+
 static uint32_t prvSetUserConfiguration ( void )
 {
     xUserConfig_t *pxUserConfig;
@@ -43,11 +43,29 @@
 /* local include */
 #include <orwl_gpio.h>
 #include <systemRes.h>
+#include <irq.h>
+#include <events.h>
+#include <usermode.h>
 
 
 /* system resource */
 static xgSysRes_t prvSystemResHandle;
 
+/* LE status line interrupt is registered */
+static uint8_t prvSystemResBTIrqSetup;
+
+extern xSMAppResources_t xgResource;
+
+/**
+ * @brief LE status line interrupt handler.
+ *
+ * The line has one polarity per pin, so the handler arms the opposite edge
+ * and signals the user mode application, which filters the transitions.
+ *
+ * @return void
+ */
+static void prvSystemResBT_ISR( void );
+
 uint32_t ulSystemResInitGlobalSystemResources( void )
 {
 	/* GIO handler assignment */
@@ -230,14 +248,53 @@ void vSystemResPowerOff_IntelDisp( void )
 void vSystemResBT_GPIO_Config( void )
 {
 	mml_gpio_config_t xconfig;
+	int32_t lResult = NO_ERROR;
+	uint8_t ucStatus = 0;
 	xconfig.gpio_direction = MML_GPIO_DIR_IN;
 	xconfig.gpio_function = MML_GPIO_NORMAL_FUNCTION;
-	xconfig.gpio_intr_mode = 0;
-	xconfig.gpio_intr_polarity = 0;
+	xconfig.gpio_intr_mode = MML_GPIO_INT_MODE_EDGE_TRIGGERED;
+	xconfig.gpio_intr_polarity = MML_GPIO_INT_POL_RAISING;
 	xconfig.gpio_pad_config = MML_GPIO_PAD_NORMAL;
 	/* Configuring as input */
 	mml_gpio_set_config(prvSystemResHandle.xProximityCheck.ulGropuId,
 		prvSystemResHandle.xProximityCheck.ulOPinId, 1, xconfig);
+
+	/* Handler is registered once, the state machine configures the pin
+	 * every time it restarts */
+	if(prvSystemResBTIrqSetup == 0)
+	{
+		lResult = lIrqSetup(prvSystemResHandle.xProximityCheck.ulGropuId,
+			prvSystemResHandle.xProximityCheck.ulOPinId,
+			MML_GPIO_INT_MODE_EDGE_TRIGGERED,
+			MML_GPIO_INT_POL_RAISING, prvSystemResBT_ISR);
+		prvSystemResBTIrqSetup = 1;
+	}
+	/* Arm the edge leaving the present level */
+	vSystemResBT_GPIO_Status(&ucStatus);
+	lResult |= mml_gpio_set_int_pol(prvSystemResHandle.xProximityCheck.ulGropuId,
+		prvSystemResHandle.xProximityCheck.ulOPinId,
+		(ucStatus) ? MML_GPIO_INT_POL_FALLING : MML_GPIO_INT_POL_RAISING);
+	lResult |= lIrqClearInterrupt(prvSystemResHandle.xProximityCheck.ulGropuId,
+		prvSystemResHandle.xProximityCheck.ulOPinId);
+	lResult |= lIrqEnableInterrupt(prvSystemResHandle.xProximityCheck.ulGropuId,
+		prvSystemResHandle.xProximityCheck.ulOPinId);
+	configASSERT(lResult == NO_ERROR);
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvSystemResBT_ISR( void )
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	/* The task reads the level itself */
+	(void)ucIrqArmToggle(prvSystemResHandle.xProximityCheck.ulGropuId,
+		prvSystemResHandle.xProximityCheck.ulOPinId);
+
+	if(xEventGroupSetBitsFromISR(xgResource.xEventGroupUserModeApp,
+		eventsLE_PROXIMITY_CHANGE, &xHigherPriorityTaskWoken) == pdPASS)
+	{
+		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+	}
 }
 /*----------------------------------------------------------------------------*/
 
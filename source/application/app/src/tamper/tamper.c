@@ -46,11 +46,11 @@
 #include <stdlib.h>
 #include <systemRes.h>
 #include <orwl_disp_interface.h>
-#include <intel_suc_comm.h>
+#include <Intel_SuC_Comm.h>
 #include <orwl_err.h>
 #include <usermode.h>
 #include <orwl_gpio.h>
-#include <intel_SuC_Comm.h>
+#include <Intel_SuC_Comm.h>
 #include <reset.h>
 
 /* Local includes */
@@ -112,6 +112,47 @@ static BaseType_t prvCheckShortBtnPress( xSMAppResources_t *pxResHandle);
  */
 static void prvCheckLongBtnPress( xSMAppResources_t *pxResHandle);
 
+/**
+ * @brief This function handles a Long power button press. It sends long press
+ * event to intel and resets the SuC.
+ *
+ * @return void
+ */
+static void prvLongBtnPressAction( void );
+
+/**
+ * @brief This function executes one Intel command received in unlocked state.
+ *
+ * @param *pxResHandle user mode resource handle
+ * @param *pxIntelUserData Intel command received.
+ *
+ * @return Intel error code, usermodeERROR_STATE on fatal error.
+ */
+static uint8_t prvUnlockedIntelCommand( xSMAppResources_t *pxResHandle,
+	IntelUserData_t *pxIntelUserData );
+
+/**
+ * @brief This function checks the LE status line stays low for
+ * usermodeLE_DEBOUNCE. A change meanwhile is left pending in the event group.
+ *
+ * @param *pxResHandle user mode resource handle
+ *
+ * @return pdTRUE if the line settled low otherwise pdFALSE.
+ */
+static BaseType_t prvLeLineSettled( xSMAppResources_t *pxResHandle );
+
+/**
+ * @brief This function waits for the peer to report proximity on the LE
+ * status line. It wakes on the line interrupt, not by polling.
+ *
+ * @param *pxResHandle user mode resource handle
+ * @param xTimeout time to wait for the peer.
+ *
+ * @return pdTRUE when the peer is in proximity, pdFALSE on timeout.
+ */
+static BaseType_t prvWaitLeProximity( xSMAppResources_t *pxResHandle,
+	TickType_t xTimeout );
+
 /**
  * @brief This function set new AES keys, erase NVSRAM and re generate new SSD
  * password.
@@ -958,16 +999,7 @@ static void prvCheckLongBtnPress( xSMAppResources_t *pxResHandle)
 	vTaskDelay(usermodeDELAY_MSEC_100);
 	if((xBits & eventsKEY_PRESS_LONG) == eventsKEY_PRESS_LONG)
 	{
-		debugPRINT_APP(" Receive event: eventsKEY_PRESS_LONG ");
-		if(lDisplayImageFullScreen(eDipsInt_FORCE_SHUTDOWN)!=NO_ERROR)
-		{
-			debugERROR_PRINT("Failed to display present key image"
-						" on OLED");
-		}
-		/* Send Long press event to Intel */
-		vSystemResIntel_LongPress();
-		/* Reset the system for long button press */
-		resetSYSTEM_RESET
+		prvLongBtnPressAction();
 	}
 	else
 	{
@@ -977,6 +1009,21 @@ static void prvCheckLongBtnPress( xSMAppResources_t *pxResHandle)
 }
 /*----------------------------------------------------------------------------*/
 
+static void prvLongBtnPressAction( void )
+{
+	debugPRINT_APP(" Receive event: eventsKEY_PRESS_LONG ");
+	if(lDisplayImageFullScreen(eDipsInt_FORCE_SHUTDOWN)!=NO_ERROR)
+	{
+		debugERROR_PRINT("Failed to display present key image"
+					" on OLED");
+	}
+	/* Send Long press event to Intel */
+	vSystemResIntel_LongPress();
+	/* Reset the system for long button press */
+	resetSYSTEM_RESET
+}
+/*----------------------------------------------------------------------------*/
+
 static uint8_t prvUserRotReGen( void )
 {
 	NvsramData_t xNvsData;
@@ -1782,24 +1829,15 @@ static void prvSuCSM_LeAliveCheckState( eUserSuCUserStates *pxDevState,
 			break;
 		}
 #if usermodeENABLE_GPIO_READ
-		/* Providing delay in loop as BLE central toggle GPIO after few seconds */
-		for(ulLeStatusCount = 0; ulLeStatusCount < usermodeLE_MAX_RETRY;
-					ulLeStatusCount++)
-		{
-			vTaskDelay(usermodeDELAY_MSEC_100);
-			vSystemResBT_GPIO_Status(&ucPinStatus);
-			if ( ucPinStatus == usermodeLE_GPIO_LOW )
-			{
-				*pxDevState = eSTATE_SUC_UST_5;
-				break;
-			}
-		}
-		if(ulLeStatusCount == usermodeLE_MAX_RETRY)
+		/* BLE central toggles GPIO after few seconds */
+		if(prvWaitLeProximity(pxResHandle, usermodeLE_RESPONSE_TIMEOUT)
+			!= pdTRUE)
 		{
 			debugERROR_PRINT(" Peer is out of proximity ");
 			lErr = COMMON_ERR_OUT_OF_RANGE;
 			break;
 		}
+		*pxDevState = eSTATE_SUC_UST_5;
 #else
 		/* Check LE status using GPIO pin in EVT3 board */
 		/* In EVT2 reading the eeprom value to get the GPIO status */
@@ -2022,6 +2060,205 @@ static void prvSuCSM_ProximityError( eUserSuCUserStates *pxDevState,
 }
 /*----------------------------------------------------------------------------*/
 
+static BaseType_t prvLeLineSettled( xSMAppResources_t *pxResHandle )
+{
+	EventBits_t xBits;
+	uint8_t ucPinStatus = -1;
+	configASSERT(pxResHandle != NULL);
+
+	xEventGroupClearBits(pxResHandle->xEventGroupUserModeApp,
+		eventsLE_PROXIMITY_CHANGE);
+	vSystemResBT_GPIO_Status(&ucPinStatus);
+	if(ucPinStatus != usermodeLE_GPIO_LOW)
+	{
+		return pdFALSE;
+	}
+	xBits = xEventGroupWaitBits(pxResHandle->xEventGroupUserModeApp,
+					eventsLE_PROXIMITY_CHANGE,
+					pdFALSE,
+					pdFALSE,
+					usermodeLE_DEBOUNCE);
+	return ((xBits & eventsLE_PROXIMITY_CHANGE) == 0) ? pdTRUE : pdFALSE;
+}
+/*----------------------------------------------------------------------------*/
+
+static BaseType_t prvWaitLeProximity( xSMAppResources_t *pxResHandle,
+	TickType_t xTimeout )
+{
+	TickType_t xStart = xTaskGetTickCount();
+	TickType_t xElapsed;
+	configASSERT(pxResHandle != NULL);
+
+	while(prvLeLineSettled(pxResHandle) != pdTRUE)
+	{
+		xElapsed = xTaskGetTickCount() - xStart;
+		if(xElapsed >= xTimeout)
+		{
+			return pdFALSE;
+		}
+		/* Sleep until the line changes level again */
+		xEventGroupWaitBits(pxResHandle->xEventGroupUserModeApp,
+					eventsLE_PROXIMITY_CHANGE,
+					pdFALSE,
+					pdFALSE,
+					xTimeout - xElapsed);
+	}
+	return pdTRUE;
+}
+/*----------------------------------------------------------------------------*/
+
+static uint8_t prvUnlockedIntelCommand( xSMAppResources_t *pxResHandle,
+	IntelUserData_t *pxIntelUserData )
+{
+	uint8_t ucIntelRet = SUC_WRITE_STATUS_FAIL_UNKOWN;
+	NfcEventData_t xNfcData;
+	configASSERT(pxResHandle != NULL);
+	configASSERT(pxIntelUserData != NULL);
+
+	switch(pxIntelUserData->ucCommand)
+	{
+	case ORWL_KEY_MGT:
+	    memcpy(xNfcData.ucKeyFobName,
+	     ((OrwlKeyMgt_t *)pxIntelUserData->pvData)->keyFobNam,
+	     keyfobidNAME_LEN);
+	    if((((OrwlKeyMgt_t *)pxIntelUserData->pvData)->preAttr)
+		== ORWL_KEY_FOB_ATTR_ADMIN)
+	    {
+	        xNfcData.ulKeyPrivilege = nfccommonKEY_PRIVILEGE_ADMIN;
+	    }
+	    else if((((OrwlKeyMgt_t *)pxIntelUserData->pvData)->preAttr)
+	    	== ORWL_KEY_FOB_ATTR_USER)
+	    {
+		xNfcData.ulKeyPrivilege = nfccommonKEY_PRIVILEGE_USER;
+	    }
+	    if(xQueueSend(pxResHandle->xNfcQueue, &xNfcData,
+		    portMAX_DELAY) != pdTRUE)
+	    {
+		debugERROR_PRINT(" Failed to send data"
+			    " into the queue ");
+	    }
+	    if( pxIntelUserData->ucSubCommand ==
+					ORWL_KEY_FOB_MGT_ADD)
+	    {
+		ucIntelRet = prvAddKeyFob( pxResHandle );
+	    }
+	    else if( pxIntelUserData->ucSubCommand ==
+					ORWL_KEY_FOB_MGT_DEL)
+	    {
+		ucIntelRet = prvDeleteNFCKeyEntry(pxResHandle);
+	    }
+	    break;
+	case ORWL_SEC_CHECK_LEVEL0:
+	    ucIntelRet = prvCheckNfcBlePin( pxResHandle, pdFALSE,
+		    pdFALSE);
+	    switch(ucIntelRet)
+	    {
+		case SUC_WRITE_STATUS_SUCCESS:
+			    break;
+		case SUC_WRITE_STATUS_TIMEOUT:
+			    vDisplayClearScreen(
+				    dispWELCOME_IMGLTX,
+				    dispWELCOME_IMGLTY,
+				    dispWELCOME_IMGRBX,
+				    dispWELCOME_IMGRBY,
+				    dispBACKGROUND_BLACK);
+			    vDisplaySetTextPos(
+				    dispWELCOME_STR_XCOR,
+				    dispWELCOME_STR_YCOR);
+			    vDisplayText(
+				    (const int8_t *)
+				    uiTIME_OUT);
+			    break;
+
+		case SUC_WRITE_STATUS_FAIL_AUTH:
+			    vDisplayClearScreen(
+				    dispWELCOME_IMGLTX,
+				    dispWELCOME_IMGLTY,
+				    dispWELCOME_IMGRBX,
+				    dispWELCOME_IMGRBY,
+				    dispBACKGROUND_BLACK);
+			    vDisplaySetTextPos(
+				    dispWELCOME_STR_XCOR,
+				    dispWELCOME_STR_YCOR);
+			    vDisplayText(
+				    (const int8_t *)
+				    uiSECURITY_CHECK_FAIL);
+				break;
+		default:
+			debugERROR_PRINT("Unknown error\n");
+			while(1);
+	    }
+	    break;
+	case ORWL_SEC_CHECK_LEVEL1:
+	    ucIntelRet = prvCheckNfcBlePin( pxResHandle, pdTRUE,
+		    pdTRUE);
+	    switch(ucIntelRet)
+	    {
+		case SUC_WRITE_STATUS_SUCCESS:
+			    break;
+		case SUC_WRITE_STATUS_TIMEOUT:
+			    vDisplayClearScreen(
+				    dispWELCOME_IMGLTX,
+				    dispWELCOME_IMGLTY,
+				    dispWELCOME_IMGRBX,
+				    dispWELCOME_IMGRBY,
+				    dispBACKGROUND_BLACK);
+			    vDisplaySetTextPos(
+				    dispWELCOME_STR_XCOR,
+				    dispWELCOME_STR_YCOR);
+			    vDisplayText(
+				    (const int8_t *)
+				    uiTIME_OUT);
+			    break;
+
+		case SUC_WRITE_STATUS_FAIL_AUTH:
+			    vDisplayClearScreen(
+				    dispWELCOME_IMGLTX,
+				    dispWELCOME_IMGLTY,
+				    dispWELCOME_IMGRBX,
+				    dispWELCOME_IMGRBY,
+				    dispBACKGROUND_BLACK);
+			    vDisplaySetTextPos(
+				    dispWELCOME_STR_XCOR,
+				    dispWELCOME_STR_YCOR);
+			    vDisplayText(
+				    (const int8_t *)
+				    uiSECURITY_CHECK_FAIL);
+				break;
+		default:
+			debugERROR_PRINT("Unknown error\n");
+			while(1);
+	    }
+	    break;
+	case SUC_ROT_REGEN:
+	    ucIntelRet = prvCheckNfcBlePin( pxResHandle, pdTRUE,
+		    pdTRUE );
+	    if(ucIntelRet == SUC_WRITE_STATUS_SUCCESS)
+	    {
+		ucIntelRet = prvUserRotReGen();
+	    }
+	    break;
+	case INTEL_DEV_ACT:
+	    ucIntelRet = prvHandleIntelDevState( pxResHandle, pxIntelUserData );
+	    break;
+	case ORWL_KEY_FOR_DAT:
+	    ucIntelRet = prvReadKeyFobData( pxIntelUserData );
+	    break;
+	case GET_RTC_TIME:
+	    ucIntelRet = prvGetRTCDateTime( pxIntelUserData );
+	    break;
+	case SET_RTC_TIME:
+	    ucIntelRet = prvSetRTCDateTime( pxIntelUserData );
+	    break;
+	default:
+	    debugERROR_PRINT(" Invalid case ");
+	    ucIntelRet = SUC_WRITE_STATUS_FAIL_UNKOWN;
+	    break;
+	}
+	return ucIntelRet;
+}
+/*----------------------------------------------------------------------------*/
+
 static void prvSuCSM_UnlockedState( eUserSuCUserStates *pxDevState,
 	xSMAppResources_t *pxResHandle )
 {
@@ -2034,9 +2271,12 @@ static void prvSuCSM_UnlockedState( eUserSuCUserStates *pxDevState,
 	uint32_t ulGPIOVal ;
 	uint32_t ulLeStatusCount = 0;
 	xSMAppResources_t *pxRes = pxResHandle;
-	NfcEventData_t xNfcData;
 	IntelUserData_t xIntelUserData;
 	EventBits_t xBits = 0;
+	EventBits_t xWaitBits;
+	TickType_t xLastSample;
+	TickType_t xElapsed;
+	TickType_t xTimeout;
 	configASSERT(pxDevState!= NULL);
 	configASSERT(pxResHandle!= NULL);
 	configASSERT(pxResHandle->xSucBiosSendQueue!=NULL);
@@ -2058,209 +2298,162 @@ static void prvSuCSM_UnlockedState( eUserSuCUserStates *pxDevState,
 		*pxDevState = eSTATE_SUC_UST_12;
 		goto ERR_STATE;
 	}
-	/* This while poll for 4 events */
-	/* Check for Power button Press */
-	/* Check for Proximity for infinite/23:59:00 hrs timeout */
-	/* Check for Intel Command */
-	/* Check for Le Seed update timeout */
+	/* Single wait on the user mode event group for all events:
+	 * Power button presses, set by the power button task
+	 * Proximity for infinite/23:59:00 hrs timeout and Le seed update
+	 * timeout, set by the timers
+	 * Intel Command, set along with every command queued by Intel SuC task
+	 * Le proximity change, set by the LE status line interrupt
+	 * The wait times out only while the peer is reported lost. Intel
+	 * commands are left pending while the peer is out of proximity. */
+	xWaitBits = usermodeUNLOCKED_EVENTS;
+	xLastSample = xTaskGetTickCount();
+#if usermodeENABLE_GPIO_READ
+	/* Start from the present level of the LE status line */
+	xEventGroupSetBits(pxRes->xEventGroupUserModeApp,
+		eventsLE_PROXIMITY_CHANGE);
+#endif
 	while(1)
 	{
-		/* Check for Short Power button Press */
-		if( prvCheckShortBtnPress( pxRes ) != pdTRUE)
-		{
-			vSystemResIntel_ShortPress();
-		}
-		/* Check for Long Power button Press */
-		prvCheckLongBtnPress( pxRes );
-		/* Check for Proximity for infinite/24 hrs time */
+		xElapsed = xTaskGetTickCount() - xLastSample;
 #if usermodeENABLE_GPIO_READ
-		vSystemResBT_GPIO_Status(&ucPinstatus);
-		if ( ucPinstatus == usermodeLE_GPIO_HIGH )
+		if(ulLeStatusCount == 0)
 		{
-			ulLeStatusCount++;
-			vTaskDelay(usermodeDELAY_MSEC_100);
+			xTimeout = portMAX_DELAY;
 		}
 		else
 		{
-			ulLeStatusCount = 0;
+			xTimeout = (xElapsed < usermodeLE_LOST_HOLD) ?
+				(usermodeLE_LOST_HOLD - xElapsed) :
+				usermodeDELAY_0;
 		}
 #else
-		if(lI2cRead((uint8_t)leNORDIC_I2C_SLAVE_ADDR,
-					(uint8_t)leGPIO_REG_ADDR,
-					usermodeLE_NUM_OF_BYTES,
-					ucLeGpioReg))
+		xTimeout = (xElapsed < usermodeLE_SAMPLE_PERIOD) ?
+			(usermodeLE_SAMPLE_PERIOD - xElapsed) : usermodeDELAY_0;
+#endif
+		xBits = xEventGroupWaitBits(pxRes->xEventGroupUserModeApp ,
+						xWaitBits,
+						pdFALSE ,
+						pdFALSE ,
+						xTimeout );
+		xBits &= xWaitBits;
+		if(xBits)
 		{
-			*pxDevState = eSTATE_SUC_UST_8;
-			debugERROR_PRINT(" Failed to read data from LE "
-				"EEPROM ");
-			break;
+			xEventGroupClearBits(pxRes->xEventGroupUserModeApp,
+				xBits);
 		}
-		else if(ucLeGpioReg[usermodeINDEX_0] ||
-			ucLeGpioReg[usermodeINDEX_1] ||
-			ucLeGpioReg[usermodeINDEX_2])
+		/* Check for Long Power button Press */
+		if(xBits & eventsKEY_PRESS_LONG)
 		{
-			/* continue with further checking */
-		ulLeStatusCount = 0;
+			prvLongBtnPressAction();
 		}
-		else
+		/* Check for Short Power button Press */
+		if(xBits & eventsKEY_PRESS_SHORT)
 		{
-		ulLeStatusCount++;
-		vTaskDelay(usermodeDELAY_MSEC_100);
+			debugPRINT_APP(" Receive event: eventsKEY_PRESS_SHORT ");
+			vSystemResIntel_ShortPress();
 		}
-#endif
-		/* Check for Le retry count */
-		if(ulLeStatusCount == usermodeLE_MAX_RETRY_UNLOCK_STATE )
+		if(xBits & eventsPROXIMITY_TIMEOUT)
 		{
-		    debugERROR_PRINT(" Peer is out of proximity ");
-		    *pxDevState = eSTATE_SUC_UST_8;
-		    break;
+			/* 23:59:00 hrs proximity timeout occurred */
+			debugPRINT_APP(" 23:59:00 hrs proximity timeout"
+				" occurred. Please re authenticate");
+			*pxDevState = eSTATE_SUC_UST_8;
+			break;
 		}
-		/* Check for Intel Command only if BLE Advertise is proper */
-		if (ulLeStatusCount ==0 )
+		if(xBits & eventsLE_TIMER_OUT)
 		{
-		if(xQueueReceive(pxRes->xSucBiosSendQueue, &xIntelUserData,
-			usermodeDELAY_SEC_1) == pdTRUE)
+			/* Update LE seed */
+			if( prvUpdateLeSeed() == usermodeERROR_STATE )
+			{
+				*pxDevState = eSTATE_SUC_UST_12;
+				goto ERR_STATE;
+			}
+			debugPRINT_APP(" LE seed updated ");
+		}
+#if usermodeENABLE_GPIO_READ
+		/* Check for Proximity. Peer lost is taken at once, the hold time
+		 * and the settle time on return filter out glitches */
+		if(xBits & eventsLE_PROXIMITY_CHANGE)
 		{
-			switch(xIntelUserData.ucCommand)
+			vSystemResBT_GPIO_Status(&ucPinstatus);
+			if ( ucPinstatus == usermodeLE_GPIO_HIGH )
 			{
-			case ORWL_KEY_MGT:
-			    memcpy(xNfcData.ucKeyFobName,
-			     ((OrwlKeyMgt_t *)xIntelUserData.pvData)->keyFobNam,
-			     keyfobidNAME_LEN);
-			    if((((OrwlKeyMgt_t *)xIntelUserData.pvData)->preAttr)
-				== ORWL_KEY_FOB_ATTR_ADMIN)
-			    {
-			        xNfcData.ulKeyPrivilege = nfccommonKEY_PRIVILEGE_ADMIN;
-			    }
-			    else if((((OrwlKeyMgt_t *)xIntelUserData.pvData)->preAttr)
-			    	== ORWL_KEY_FOB_ATTR_USER)
-			    {
-				xNfcData.ulKeyPrivilege = nfccommonKEY_PRIVILEGE_USER;
-			    }
-			    if(xQueueSend(pxRes->xNfcQueue, &xNfcData,
-				    portMAX_DELAY) != pdTRUE)
-			    {
-				debugERROR_PRINT(" Failed to send data"
-					    " into the queue ");
-			    }
-			    if( xIntelUserData.ucSubCommand ==
-							ORWL_KEY_FOB_MGT_ADD)
-			    {
-				ucIntelRet = prvAddKeyFob( pxRes );
-			    }
-			    else if( xIntelUserData.ucSubCommand ==
-							ORWL_KEY_FOB_MGT_DEL)
-			    {
-				ucIntelRet = prvDeleteNFCKeyEntry(pxRes);
-			    }
-			    break;
-			case ORWL_SEC_CHECK_LEVEL0:
-			    ucIntelRet = prvCheckNfcBlePin( pxRes, pdFALSE,
-				    pdFALSE);
-			    switch(ucIntelRet)
-			    {
-				case SUC_WRITE_STATUS_SUCCESS:
-					    break;
-				case SUC_WRITE_STATUS_TIMEOUT:
-					    vDisplayClearScreen(
-						    dispWELCOME_IMGLTX,
-						    dispWELCOME_IMGLTY,
-						    dispWELCOME_IMGRBX,
-						    dispWELCOME_IMGRBY,
-						    dispBACKGROUND_BLACK);
-					    vDisplaySetTextPos(
-						    dispWELCOME_STR_XCOR,
-						    dispWELCOME_STR_YCOR);
-					    vDisplayText(
-						    (const int8_t *)
-						    uiTIME_OUT);
-					    break;
-
-				case SUC_WRITE_STATUS_FAIL_AUTH:
-					    vDisplayClearScreen(
-						    dispWELCOME_IMGLTX,
-						    dispWELCOME_IMGLTY,
-						    dispWELCOME_IMGRBX,
-						    dispWELCOME_IMGRBY,
-						    dispBACKGROUND_BLACK);
-					    vDisplaySetTextPos(
-						    dispWELCOME_STR_XCOR,
-						    dispWELCOME_STR_YCOR);
-					    vDisplayText(
-						    (const int8_t *)
-						    uiSECURITY_CHECK_FAIL);
-						break;
-				default:
-					debugERROR_PRINT("Unknown error\n");
-					while(1);
-			    }
-			    break;
-			case ORWL_SEC_CHECK_LEVEL1:
-			    ucIntelRet = prvCheckNfcBlePin( pxRes, pdTRUE,
-				    pdTRUE);
-			    switch(ucIntelRet)
-			    {
-				case SUC_WRITE_STATUS_SUCCESS:
-					    break;
-				case SUC_WRITE_STATUS_TIMEOUT:
-					    vDisplayClearScreen(
-						    dispWELCOME_IMGLTX,
-						    dispWELCOME_IMGLTY,
-						    dispWELCOME_IMGRBX,
-						    dispWELCOME_IMGRBY,
-						    dispBACKGROUND_BLACK);
-					    vDisplaySetTextPos(
-						    dispWELCOME_STR_XCOR,
-						    dispWELCOME_STR_YCOR);
-					    vDisplayText(
-						    (const int8_t *)
-						    uiTIME_OUT);
-					    break;
-
-				case SUC_WRITE_STATUS_FAIL_AUTH:
-					    vDisplayClearScreen(
-						    dispWELCOME_IMGLTX,
-						    dispWELCOME_IMGLTY,
-						    dispWELCOME_IMGRBX,
-						    dispWELCOME_IMGRBY,
-						    dispBACKGROUND_BLACK);
-					    vDisplaySetTextPos(
-						    dispWELCOME_STR_XCOR,
-						    dispWELCOME_STR_YCOR);
-					    vDisplayText(
-						    (const int8_t *)
-						    uiSECURITY_CHECK_FAIL);
-						break;
-				default:
-					debugERROR_PRINT("Unknown error\n");
-					while(1);
-			    }
-			    break;
-			case SUC_ROT_REGEN:
-			    ucIntelRet = prvCheckNfcBlePin( pxRes, pdTRUE,
-				    pdTRUE );
-			    if(ucIntelRet == SUC_WRITE_STATUS_SUCCESS)
-			    {
-				ucIntelRet = prvUserRotReGen();
-			    }
-			    break;
-			case INTEL_DEV_ACT:
-			    ucIntelRet = prvHandleIntelDevState( pxRes, &xIntelUserData );
-			    break;
-			case ORWL_KEY_FOR_DAT:
-			    ucIntelRet = prvReadKeyFobData( &xIntelUserData );
-			    break;
-			case GET_RTC_TIME:
-			    ucIntelRet = prvGetRTCDateTime( &xIntelUserData );
-			    break;
-			case SET_RTC_TIME:
-			    ucIntelRet = prvSetRTCDateTime( &xIntelUserData );
-			    break;
-			default:
-			    debugERROR_PRINT(" Invalid case ");
-			    ucIntelRet = SUC_WRITE_STATUS_FAIL_UNKOWN;
+				if(ulLeStatusCount == 0)
+				{
+					ulLeStatusCount = 1;
+					xLastSample = xTaskGetTickCount();
+				}
+			}
+			else if((ulLeStatusCount != 0) &&
+				(prvLeLineSettled(pxRes) == pdTRUE))
+			{
+				ulLeStatusCount = 0;
+			}
+		}
+		/* Check for Le lost for the whole hold time */
+		if((ulLeStatusCount != 0) &&
+			((xTaskGetTickCount() - xLastSample) >= usermodeLE_LOST_HOLD))
+		{
+			debugERROR_PRINT(" Peer is out of proximity ");
+			*pxDevState = eSTATE_SUC_UST_8;
+			break;
+		}
+#else
+		/* Check for Proximity, once every sample period whatever woke
+		 * the task */
+		if((xTaskGetTickCount() - xLastSample) >= usermodeLE_SAMPLE_PERIOD)
+		{
+			xLastSample = xTaskGetTickCount();
+			if(lI2cRead((uint8_t)leNORDIC_I2C_SLAVE_ADDR,
+						(uint8_t)leGPIO_REG_ADDR,
+						usermodeLE_NUM_OF_BYTES,
+						ucLeGpioReg))
+			{
+				*pxDevState = eSTATE_SUC_UST_8;
+				debugERROR_PRINT(" Failed to read data from LE "
+					"EEPROM ");
+				break;
+			}
+			else if(ucLeGpioReg[usermodeINDEX_0] ||
+				ucLeGpioReg[usermodeINDEX_1] ||
+				ucLeGpioReg[usermodeINDEX_2])
+			{
+				ulLeStatusCount = 0;
+			}
+			else
+			{
+				ulLeStatusCount++;
+			}
+			/* Check for Le retry count */
+			if(ulLeStatusCount == usermodeLE_MAX_RETRY_UNLOCK_STATE )
+			{
+			    debugERROR_PRINT(" Peer is out of proximity ");
+			    *pxDevState = eSTATE_SUC_UST_8;
 			    break;
 			}
+		}
+#endif
+		/* Accept Intel Command only if BLE Advertise is proper */
+		if (ulLeStatusCount == 0)
+		{
+			xWaitBits |= eventsBIOS_COMMAND;
+		}
+		else
+		{
+			xWaitBits &= ~eventsBIOS_COMMAND;
+		}
+		if((xBits & eventsBIOS_COMMAND) == 0)
+		{
+			continue;
+		}
+		/* Event is cleared before the queue is drained, a command queued
+		 * meanwhile sets it again */
+		while(xQueueReceive(pxRes->xSucBiosSendQueue, &xIntelUserData,
+			usermodeDELAY_0) == pdTRUE)
+		{
+			ucIntelRet = prvUnlockedIntelCommand( pxRes,
+				&xIntelUserData );
 			if (ucIntelRet == usermodeERROR_STATE)
 			{
 				/* Send the error to Intel */
@@ -2287,39 +2480,6 @@ static void prvSuCSM_UnlockedState( eUserSuCUserStates *pxDevState,
 				goto ERR_STATE;
 			}
 		}
-		}
-		/* Check for Le Seed update event and 23:59:00 hrs timeout */
-		xBits = xEventGroupWaitBits(pxRes->xEventGroupUserModeApp ,
-						eventsLE_TIMER_OUT |
-						eventsPROXIMITY_TIMEOUT,
-						pdFALSE ,
-						pdFALSE ,
-						usermodeMIN_WAIT_DELAY );
-		if(( xBits & eventsPROXIMITY_TIMEOUT) ==
-			eventsPROXIMITY_TIMEOUT)
-		{
-			xBits = xEventGroupClearBits(
-				pxRes->xEventGroupUserModeApp,
-				eventsPROXIMITY_TIMEOUT );
-			/* 23:59:00 hrs proximity timeout occurred */
-			debugPRINT_APP(" 23:59:00 hrs proximity timeout"
-				" occurred. Please re authenticate");
-			*pxDevState = eSTATE_SUC_UST_8;
-			break;
-		}
-		if( (xBits & eventsLE_TIMER_OUT) == eventsLE_TIMER_OUT )
-		{
-			xBits = xEventGroupClearBits(
-				pxRes->xEventGroupUserModeApp,
-				eventsLE_TIMER_OUT );
-			/* Update LE seed */
-			if( prvUpdateLeSeed() == usermodeERROR_STATE )
-			{
-				*pxDevState = eSTATE_SUC_UST_12;
-				goto ERR_STATE;
-			}
-			debugPRINT_APP(" LE seed updated ");
-		}
 	}
 	/* Display proximity lock on OLED */
 	lErr = lDisplayImageFullScreen(eDipsInt_PROXIMITY_PROTECT);
@@ -2742,23 +2902,14 @@ static void prvSuCSM_ReLeAliveCheckState( eUserSuCUserStates *pxDevState,
 			break;
 		}
 #if usermodeENABLE_GPIO_READ
-		/* Delay is required as BLE central toggle GPIO after few seconds */
-		for(ulLeStatusCount = 0; ulLeStatusCount < usermodeLE_MAX_RETRY;
-			ulLeStatusCount++)
-		{
-			vTaskDelay(usermodeDELAY_MSEC_100);
-			vSystemResBT_GPIO_Status(&ucPinStatus);
-			if ( ucPinStatus == usermodeLE_GPIO_LOW  )
-			{
-				*pxDevState = eSTATE_SUC_UST_7;
-				break;
-			}
-		}
-		if(ulLeStatusCount == usermodeLE_MAX_RETRY)
+		/* BLE central toggles GPIO after few seconds */
+		if(prvWaitLeProximity(pxResHandle, usermodeLE_RESPONSE_TIMEOUT)
+			!= pdTRUE)
 		{
 			lErr = COMMON_ERR_OUT_OF_RANGE;
 			break;
 		}
+		*pxDevState = eSTATE_SUC_UST_7;
 #else
 		/* Delay is required as BLE central toggle GPIO after few seconds */
 		/* Check LE status using GPIO pin in EVT3 board */
@@ -2940,17 +3091,6 @@ uint32_t ulUserModeInitGlobalApplicationResources( xSMAppResources_t *pxRes )
 	    debugERROR_PRINT("Insufficient Heap: Failed to create User Rx SuCBIOS Queue");
 	    return COMMON_ERR_FATAL_ERROR;
 	}
-
-	pxRes->prvI2CSemaphore = xSemaphoreCreateBinary();
-	if (pxRes->prvI2CSemaphore == NULL)
-	{
-	    debugERROR_PRINT("Failed to create prvI2CSemaphore");
-	    return COMMON_ERR_FATAL_ERROR;
-	}
-	else
-	{
-	    xSemaphoreGive(pxRes->prvI2CSemaphore);
-	}
 	return NO_ERROR;
 }
 /*----------------------------------------------------------------------------*/
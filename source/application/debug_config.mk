@@ -46,6 +46,8 @@
 #	-D_DEBUG_MODULE_TRNG_
 #	/* system debug option: Which can't be classified as nmodule */
 #	-D_DEBUG_SYS_
+#	/* console log as binary frames, see tools/logring_decode.py */
+#	-D_DEBUG_LOG_BINARY_
 
 ## Enable debug option for all the modules
 APP_DEBUG_FLAGS	+=	-D_DEBUG_MODULE_OLED_ \
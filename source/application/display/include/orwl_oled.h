@@ -71,6 +71,22 @@
 #define oledTOGGLE_DELAY			( 1000 )
 /** Delay before powering on OLED */
 #define oledPOWER_ON_DELAY			( 2000 )
+/** SSD1327 GDDRAM columns, two pixels per byte */
+#define oledFB_COLUMNS				( 64 )
+/** SSD1327 GDDRAM rows */
+#define oledFB_ROWS				( 128 )
+/** Cmd for setting column address window */
+#define oledCMD_SET_COLUMN			( 0x15 )
+/** Cmd for setting row address window */
+#define oledCMD_SET_ROW				( 0x75 )
+/** Cmd for setting re-map */
+#define oledCMD_REMAP				( 0xA0 )
+/** Re-map bit selecting vertical address increment */
+#define oledREMAP_VERTICAL			( 0x04 )
+/** Cmd for setting the gray scale table, takes 15 bytes */
+#define oledCMD_GRAY_TABLE			( 0xB8 )
+/** Wait for the framebuffer lock in ms */
+#define oledFB_LOCK_TIMEOUT_MS			( 2000 )
 /* Function Declaration */
 
 /**@brief For setting DC line
@@ -130,4 +146,58 @@ int32_t lOledspiWrite(uint8_t *pucData);
 * @return NO_ERROR in case of success and error code in case of failure
 */
 int32_t lOledspiInit(mml_spi_params_t *pxSpiConfig);
+
+/**@brief Framebuffer initialization
+*
+* Creates the lock of the RAM shadow of the OLED memory and starts capturing
+* the output of the display library. The first flush writes the whole
+* screen, as the OLED memory is not known yet.
+*
+* @return NO_ERROR in case of success and error code in case of failure
+*/
+int32_t lOledFbInit( void );
+
+/**@brief Start of a display update
+*
+* Takes the framebuffer lock. Bytes written by the display library up to
+* lOledFbEnd() only update the shadow and the dirty rectangle.
+*
+* @return NO_ERROR in case of success and error code in case of failure
+*/
+int32_t lOledFbBegin( void );
+
+/**@brief End of a display update
+*
+* Writes the dirty rectangle of the shadow to the OLED in SPI bursts and
+* releases the framebuffer lock. Returns once the transfer is done.
+*
+* @return NO_ERROR in case of success and error code in case of failure
+*/
+int32_t lOledFbEnd( void );
+
+/**@brief Bypass the framebuffer
+*
+* Used by the NON RTOS paths (NMI and timer ISR): following bytes go to the
+* OLED directly and the next flush rewrites the whole screen.
+*
+* @return void
+*/
+void vOledFbDirect( void );
+
+/**@brief Capture of a DC line change
+*
+* @param ulCmd oledCMD_SESSION or oledDATA_SESSION.
+*
+* @return 1 if captured, 0 if the DC line must be driven
+*/
+uint32_t ulOledFbSession( uint32_t ulCmd );
+
+/**@brief Capture of a byte written by the display library
+*
+* @param ucData byte.
+* @param plResult status of a command forwarded to the OLED.
+*
+* @return 1 if captured, 0 if the byte must be written to the OLED
+*/
+uint32_t ulOledFbWrite( uint8_t ucData, int32_t *plResult );
 #endif /* INCLUDE_ORWL_OLED_H_ */
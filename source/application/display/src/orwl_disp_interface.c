@@ -54,83 +54,59 @@
 
 void vDisplayText( const int8_t *pcStr )
 {
-	/* Enter critical section and suspend all task
-	 * before updating OLED.Entering critical section
-	 * will disable interrupt globally and suspending
-	 * avoids task switching while updating OLED.This
-	 * will avoid corruption of gbuf buffer.Once OLED
-	 * is updated resume all the task and exit from
-	 * critical section.
-	 */
-	taskENTER_CRITICAL();
-	vTaskSuspendAll();
+	/* Render under the display lock, see lOledFbBegin() */
+	if( lOledFbBegin() != NO_ERROR )
+	{
+	    return;
+	}
 	/* Displaying text on OLED */
 	vDisplayTextOnOLED((const int8_t *)pcStr);
-	xTaskResumeAll();
-	taskEXIT_CRITICAL();
+	(void) lOledFbEnd();
 }
 /*---------------------------------------------------------------------------*/
 
 void vDisplayClearScreen(int32_t lLtx, int32_t lLty, int32_t lRbx, int32_t lRby,
 	int16_t sBackGroundClr)
 {
-	/* Enter critical section and suspend all task
-	 * before updating OLED.Entering critical section
-	 * will disable interrupt globally and suspending
-	 * avoids task switching while updating OLED.This
-	 * will avoid corruption of gbuf buffer.Once OLED
-	 * is updated resume all the task and exit from
-	 * critical section.
-	 */
-	taskENTER_CRITICAL();
-	vTaskSuspendAll();
+	/* Render under the display lock, see lOledFbBegin() */
+	if( lOledFbBegin() != NO_ERROR )
+	{
+	    return;
+	}
 	vDisplayClearScreenOnOLED( lLtx, lLty, lRbx, lRby ,sBackGroundClr );
 	vDisplayHwUpdate();
-	xTaskResumeAll();
-	taskEXIT_CRITICAL();
+	(void) lOledFbEnd();
 }
 /*---------------------------------------------------------------------------*/
 
 void vDisplaySetTextPos( uint8_t ucXPos, uint8_t ucYPos )
 {
-	/* Enter critical section and suspend all task
-	 * before updating OLED.Entering critical section
-	 * will disable interrupt globally and suspending
-	 * avoids task switching while updating OLED.This
-	 * will avoid corruption of gbuf buffer.Once OLED
-	 * is updated resume all the task and exit from
-	 * critical section.
-	 */
-	taskENTER_CRITICAL();
-	vTaskSuspendAll();
+	/* Render under the display lock, see lOledFbBegin() */
+	if( lOledFbBegin() != NO_ERROR )
+	{
+	    return;
+	}
 	vDisplaySetTextPosOnOLED( ucXPos, ucYPos );
-	xTaskResumeAll();
-	taskEXIT_CRITICAL();
+	(void) lOledFbEnd();
 }
 /*---------------------------------------------------------------------------*/
 
 uint8_t ucDisplayChar(uint8_t ucChar)
 {
 	uint8_t ucResult;
+
+	/* Character and update are one display update */
+	if( lOledFbBegin() != NO_ERROR )
+	{
+	    return (uint8_t) COMMON_ERR_IN_PROGRESS;
+	}
 	ucResult = cDisplayPutChar( ucChar );
-	if(ucResult != 0 )
+	if(ucResult == 0 )
 	{
-	    return ucResult;
+	    vDisplayHwUpdate();
 	}
-	/* Enter critical section and suspend all task
-	 * before updating OLED.Entering critical section
-	 * will disable interrupt globally and suspending
-	 * avoids task switching while updating OLED.This
-	 * will avoid corruption of gbuf buffer.Once OLED
-	 * is updated resume all the task and exit from
-	 * critical section.
-	 */
-	taskENTER_CRITICAL();
-	vTaskSuspendAll();
-	vDisplayHwUpdate();
+	(void) lOledFbEnd();
 	return ucResult;
-	xTaskResumeAll();
-	taskEXIT_CRITICAL();
 }
 
 /*---------------------------------------------------------------------------*/
@@ -138,7 +114,13 @@ uint8_t ucDisplayChar(uint8_t ucChar)
 int32_t lDisplayImageFullScreen( eImageIndex xImageId )
 {
     int32_t lResult = NO_ERROR;
-    taskENTER_CRITICAL();
+
+    /* Only the image area that differs from the screen is sent */
+    lResult = lOledFbBegin();
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
 
     switch(xImageId)
     {
@@ -183,11 +165,11 @@ int32_t lDisplayImageFullScreen( eImageIndex xImageId )
 		dispWELCOME_IMGRBX, dispWELCOME_IMGRBY, eDipsInt_PROXIMITY_LOCK);
 	break;
     default:
-	return COMMON_ERR_INVAL;
+	lResult = COMMON_ERR_INVAL;
 	break;
     }
 
-    taskEXIT_CRITICAL();
+    lResult |= lOledFbEnd();
     return lResult;
 }
 /*---------------------------------------------------------------------------*/
@@ -195,9 +177,12 @@ int32_t lDisplayImageFullScreen( eImageIndex xImageId )
 int32_t lDisplayImageFullScreenNONRTOS( eImageIndex xImageId )
 {
     /* This is function will be called from NON RTOS context, so no need to enter
-     * critical section and suspend task.
+     * critical section and suspend task. It may interrupt a display update,
+     * so the OLED is written directly.
      */
     int32_t lResult = NO_ERROR;
+
+    vOledFbDirect();
     switch(xImageId)
     {
     case eDipsInt_ACCESS_DENIED:
@@ -251,17 +236,11 @@ int32_t lDisplayImageFullScreenNONRTOS( eImageIndex xImageId )
 
 void vDisplayRectangle(void)
 {
-	/* Enter critical section and suspend all task
-	 * before updating OLED.Entering critical section
-	 * will disable interrupt globally and suspending
-	 * avoids task switching while updating OLED.This
-	 * will avoid corruption of gbuf buffer.Once OLED
-	 * is updated resume all the task and exit from
-	 * critical section.
-	 */
-	taskENTER_CRITICAL();
-	vTaskSuspendAll();
+	/* Render under the display lock, see lOledFbBegin() */
+	if( lOledFbBegin() != NO_ERROR )
+	{
+	    return;
+	}
 	vDisplayRectangleOnOLED();
-	xTaskResumeAll();
-	taskEXIT_CRITICAL();
+	(void) lOledFbEnd();
 }
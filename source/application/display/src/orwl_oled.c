@@ -73,6 +73,7 @@ uint32_t ulOledInit( void )
 uint32_t ulOledPowerOn( void )
 {
 	uint32_t ulResult = COMMON_ERR_UNKNOWN;
+	uint8_t ucCmd;
 
 	/** keep reset line & d/c line high */
 	ulResult = mml_gpio_write_bit_pattern(MML_GPIO_DEV0,
@@ -104,11 +105,14 @@ uint32_t ulOledPowerOn( void )
 	/** set dc & wait for 1ms at-least [for command d/c must be low] */
 	ulResult |= mml_gpio_write_bit_pattern(MML_GPIO_DEV0 ,
 		gpioOLED_DC_3V3 ,gpioNO_OF_PINS, oledGPIO_LOW);
+	/** framebuffer tracks the DC line to parse the command stream */
+	(void) ulOledFbSession(oledCMD_SESSION);
 
 	delayMICRO_SEC(oledDELAY_STABILIZATION);
 
 	/** send command POWER_ON to OLED */
-	ulResult |= lOledspiWrite(oledSPI_DEV);
+	ucCmd = oledCMD_POWER_ON;
+	ulResult |= lOledspiWrite(&ucCmd);
 
 	delayMICRO_SEC(oledPOWER_ON_DELAY);
 
@@ -122,6 +126,11 @@ uint32_t ulOledPowerOn( void )
 
 void vOledSessionStartCmd( uint32_t ulCmd )
 {
+	/** DC is driven by the framebuffer during a display update */
+	if( ulOledFbSession(ulCmd) )
+	{
+	    return;
+	}
 	/** For data DC must be high  & for command it must be low */
 	mml_gpio_write_bit_pattern(MML_GPIO_DEV0, gpioOLED_DC_3V3,
 		gpioNO_OF_PINS, ulCmd);
@@ -0,0 +1,499 @@
+ /**===========================================================================
+ * @file orwl_oled_fb.c
+ *
+ * @brief This file contains the RAM shadow of the OLED memory. The display
+ *  * library writes SSD1327 commands and pixel data byte by byte through
+ *  * lOledspiWrite(). Inside lOledFbBegin()/lOledFbEnd() the address window
+ *  * commands and pixel data are captured here: data updates the shadow and a
+ *  * dirty rectangle, and the end of the update writes only the changed rows
+ *  * and columns to the OLED in SPI bursts. The display lock replaces the
+ *  * critical section and scheduler suspension of the display interface.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <stdint.h>
+#include <string.h>
+
+/* Driver includes */
+#include <errors.h>
+#include <mml_spi.h>
+#include <mml_gpio.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Application includes */
+#include <orwl_gpio.h>
+#include <orwl_oled.h>
+
+/**
+ * @brief Framebuffer state
+ */
+typedef struct
+{
+    SemaphoreHandle_t xLock;	/**< display lock */
+    uint32_t ulInit;		/**< lOledFbInit() done */
+    uint32_t ulCapture;		/**< update in progress, bytes are captured */
+    uint32_t ulFullFlush;	/**< OLED memory differs from the shadow */
+    uint32_t ulSession;		/**< DC level requested by the library */
+    uint32_t ulDcLevel;		/**< DC level driven on the pin */
+    uint8_t ucCmd;		/**< command being parsed */
+    uint8_t ucArgs;		/**< argument bytes still expected */
+    uint8_t ucArg0;		/**< first argument byte */
+    uint8_t ucRemap;		/**< last re-map setting */
+    uint8_t ucColStart;		/**< library address window */
+    uint8_t ucColEnd;
+    uint8_t ucRowStart;
+    uint8_t ucRowEnd;
+    uint8_t ucCol;		/**< library write address */
+    uint8_t ucRow;
+    uint8_t ucDirty;		/**< dirty rectangle valid */
+    uint8_t ucDirtyCol0;	/**< dirty rectangle, inclusive */
+    uint8_t ucDirtyCol1;
+    uint8_t ucDirtyRow0;
+    uint8_t ucDirtyRow1;
+} oledFbState_t;
+
+/** Shadow of the OLED memory, row major */
+static uint8_t ucOledFbShadow[oledFB_ROWS][oledFB_COLUMNS];
+
+/** Framebuffer state; the window covers the whole OLED after reset */
+static oledFbState_t xOledFb = {
+    .ulSession = oledDATA_SESSION,
+    .ulDcLevel = oledDATA_SESSION,
+    .ucColEnd = oledFB_COLUMNS - 1,
+    .ucRowEnd = oledFB_ROWS - 1,
+};
+
+/**
+ * @brief Drive the DC line
+ *
+ * @param ulLevel oledCMD_SESSION or oledDATA_SESSION.
+ *
+ * @return void
+ */
+static void prvOledFbDc( uint32_t ulLevel );
+
+/**
+ * @brief Number of argument bytes of a SSD1327 command
+ *
+ * @param ucCmd command.
+ *
+ * @return argument bytes
+ */
+static uint8_t prvOledFbCmdArgs( uint8_t ucCmd );
+
+/**
+ * @brief Track a command byte written by the library
+ *
+ * @param ucData byte.
+ *
+ * @return 1 for address window bytes, which are not forwarded while
+ * capturing
+ */
+static uint32_t prvOledFbCommand( uint8_t ucData );
+
+/**
+ * @brief Store a data byte at the library write address and advance it
+ *
+ * @param ucData byte.
+ * @param ulMarkDirty 1 if the byte is not on the OLED yet.
+ *
+ * @return void
+ */
+static void prvOledFbData( uint8_t ucData, uint32_t ulMarkDirty );
+
+/**
+ * @brief Write an address window to the OLED
+ *
+ * @param ucCol0 first column.
+ * @param ucCol1 last column.
+ * @param ucRow0 first row.
+ * @param ucRow1 last row.
+ *
+ * @return NO_ERROR in case of success and error code in case of failure
+ */
+static int32_t prvOledFbWindow( uint8_t ucCol0, uint8_t ucCol1,
+				uint8_t ucRow0, uint8_t ucRow1 );
+
+/**
+ * @brief Write the dirty rectangle to the OLED
+ *
+ * @return NO_ERROR in case of success and error code in case of failure
+ */
+static int32_t prvOledFbFlush( void );
+
+/*---------------------------------------------------------------------------*/
+
+static void prvOledFbDc( uint32_t ulLevel )
+{
+    if( xOledFb.ulDcLevel != ulLevel )
+    {
+	mml_gpio_write_bit_pattern(MML_GPIO_DEV0, gpioOLED_DC_3V3,
+		gpioNO_OF_PINS, ulLevel);
+	xOledFb.ulDcLevel = ulLevel;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static uint8_t prvOledFbCmdArgs( uint8_t ucCmd )
+{
+    switch( ucCmd )
+    {
+    case oledCMD_SET_COLUMN:
+    case oledCMD_SET_ROW:
+	return 2;
+    case oledCMD_GRAY_TABLE:
+	return 15;
+    case 0x26: /* horizontal scroll setup */
+    case 0x27:
+	return 7;
+    case 0x81: /* contrast */
+    case oledCMD_REMAP:
+    case 0xA1: /* start line */
+    case 0xA2: /* display offset */
+    case 0xA8: /* multiplex ratio */
+    case 0xAB: /* function selection A */
+    case 0xB1: /* phase length */
+    case 0xB3: /* clock divider */
+    case 0xB6: /* second pre-charge */
+    case 0xBC: /* pre-charge voltage */
+    case 0xBE: /* VCOMH */
+    case 0xD5: /* function selection B */
+    case 0xFD: /* command lock */
+	return 1;
+    default:
+	return 0;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static uint32_t prvOledFbCommand( uint8_t ucData )
+{
+    if( xOledFb.ucArgs == 0 )
+    {
+	xOledFb.ucCmd = ucData;
+	xOledFb.ucArgs = prvOledFbCmdArgs(ucData);
+	return ( ucData == oledCMD_SET_COLUMN ) || ( ucData == oledCMD_SET_ROW );
+    }
+
+    xOledFb.ucArgs--;
+    switch( xOledFb.ucCmd )
+    {
+    case oledCMD_SET_COLUMN:
+    case oledCMD_SET_ROW:
+	if( xOledFb.ucArgs == 1 )
+	{
+	    xOledFb.ucArg0 = ucData;
+	    return 1;
+	}
+	if( xOledFb.ucCmd == oledCMD_SET_COLUMN )
+	{
+	    xOledFb.ucColStart = xOledFb.ucArg0 & ( oledFB_COLUMNS - 1 );
+	    xOledFb.ucColEnd = ucData & ( oledFB_COLUMNS - 1 );
+	}
+	else
+	{
+	    xOledFb.ucRowStart = xOledFb.ucArg0 & ( oledFB_ROWS - 1 );
+	    xOledFb.ucRowEnd = ucData & ( oledFB_ROWS - 1 );
+	}
+	/* Setting a window moves the write address to its start */
+	xOledFb.ucCol = xOledFb.ucColStart;
+	xOledFb.ucRow = xOledFb.ucRowStart;
+	return 1;
+    case oledCMD_REMAP:
+	xOledFb.ucRemap = ucData;
+	return 0;
+    default:
+	return 0;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvOledFbData( uint8_t ucData, uint32_t ulMarkDirty )
+{
+    uint8_t *pucCell = &ucOledFbShadow[xOledFb.ucRow][xOledFb.ucCol];
+
+    if( *pucCell != ucData )
+    {
+	*pucCell = ucData;
+	if( ulMarkDirty )
+	{
+	    if( !xOledFb.ucDirty )
+	    {
+		xOledFb.ucDirty = 1;
+		xOledFb.ucDirtyCol0 = xOledFb.ucDirtyCol1 = xOledFb.ucCol;
+		xOledFb.ucDirtyRow0 = xOledFb.ucDirtyRow1 = xOledFb.ucRow;
+	    }
+	    else
+	    {
+		if( xOledFb.ucCol < xOledFb.ucDirtyCol0 )
+		{
+		    xOledFb.ucDirtyCol0 = xOledFb.ucCol;
+		}
+		if( xOledFb.ucCol > xOledFb.ucDirtyCol1 )
+		{
+		    xOledFb.ucDirtyCol1 = xOledFb.ucCol;
+		}
+		if( xOledFb.ucRow < xOledFb.ucDirtyRow0 )
+		{
+		    xOledFb.ucDirtyRow0 = xOledFb.ucRow;
+		}
+		if( xOledFb.ucRow > xOledFb.ucDirtyRow1 )
+		{
+		    xOledFb.ucDirtyRow1 = xOledFb.ucRow;
+		}
+	    }
+	}
+    }
+
+    /* Same address increment as the OLED, wrapping inside the window */
+    if( xOledFb.ucRemap & oledREMAP_VERTICAL )
+    {
+	if( xOledFb.ucRow++ >= xOledFb.ucRowEnd )
+	{
+	    xOledFb.ucRow = xOledFb.ucRowStart;
+	    if( xOledFb.ucCol++ >= xOledFb.ucColEnd )
+	    {
+		xOledFb.ucCol = xOledFb.ucColStart;
+	    }
+	}
+    }
+    else
+    {
+	if( xOledFb.ucCol++ >= xOledFb.ucColEnd )
+	{
+	    xOledFb.ucCol = xOledFb.ucColStart;
+	    if( xOledFb.ucRow++ >= xOledFb.ucRowEnd )
+	    {
+		xOledFb.ucRow = xOledFb.ucRowStart;
+	    }
+	}
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvOledFbWindow( uint8_t ucCol0, uint8_t ucCol1,
+				uint8_t ucRow0, uint8_t ucRow1 )
+{
+    uint8_t ucCmd[6];
+
+    ucCmd[0] = oledCMD_SET_COLUMN;
+    ucCmd[1] = ucCol0;
+    ucCmd[2] = ucCol1;
+    ucCmd[3] = oledCMD_SET_ROW;
+    ucCmd[4] = ucRow0;
+    ucCmd[5] = ucRow1;
+    prvOledFbDc(oledCMD_SESSION);
+    return mml_spi_transmit(oledSPI_DEV, ucCmd, sizeof(ucCmd));
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvOledFbFlush( void )
+{
+    int32_t lResult = NO_ERROR;
+    uint32_t ulWidth;
+    uint8_t ucRow;
+
+    if( xOledFb.ulFullFlush )
+    {
+	xOledFb.ucDirty = 1;
+	xOledFb.ucDirtyCol0 = 0;
+	xOledFb.ucDirtyCol1 = oledFB_COLUMNS - 1;
+	xOledFb.ucDirtyRow0 = 0;
+	xOledFb.ucDirtyRow1 = oledFB_ROWS - 1;
+    }
+    if( !xOledFb.ucDirty )
+    {
+	return NO_ERROR;
+    }
+
+    ulWidth = xOledFb.ucDirtyCol1 - xOledFb.ucDirtyCol0 + 1;
+    if( !( xOledFb.ucRemap & oledREMAP_VERTICAL ) )
+    {
+	/* Rows of the window follow each other in OLED memory */
+	lResult = prvOledFbWindow(xOledFb.ucDirtyCol0, xOledFb.ucDirtyCol1,
+		xOledFb.ucDirtyRow0, xOledFb.ucDirtyRow1);
+	prvOledFbDc(oledDATA_SESSION);
+	if( ulWidth == oledFB_COLUMNS )
+	{
+	    /* Full width rows are contiguous in the shadow too */
+	    lResult |= mml_spi_transmit(oledSPI_DEV,
+		    &ucOledFbShadow[xOledFb.ucDirtyRow0][0], oledFB_COLUMNS *
+		    ( xOledFb.ucDirtyRow1 - xOledFb.ucDirtyRow0 + 1 ));
+	}
+	else
+	{
+	    for( ucRow = xOledFb.ucDirtyRow0; ucRow <= xOledFb.ucDirtyRow1;
+		    ucRow++ )
+	    {
+		lResult |= mml_spi_transmit(oledSPI_DEV,
+			&ucOledFbShadow[ucRow][xOledFb.ucDirtyCol0], ulWidth);
+	    }
+	}
+    }
+    else
+    {
+	/* Vertical increment: a single row window per burst */
+	for( ucRow = xOledFb.ucDirtyRow0; ucRow <= xOledFb.ucDirtyRow1;
+		ucRow++ )
+	{
+	    lResult |= prvOledFbWindow(xOledFb.ucDirtyCol0,
+		    xOledFb.ucDirtyCol1, ucRow, ucRow);
+	    prvOledFbDc(oledDATA_SESSION);
+	    lResult |= mml_spi_transmit(oledSPI_DEV,
+		    &ucOledFbShadow[ucRow][xOledFb.ucDirtyCol0], ulWidth);
+	}
+    }
+
+    /* Give the library its window and DC level back */
+    lResult |= prvOledFbWindow(xOledFb.ucColStart, xOledFb.ucColEnd,
+	    xOledFb.ucRowStart, xOledFb.ucRowEnd);
+    xOledFb.ucCol = xOledFb.ucColStart;
+    xOledFb.ucRow = xOledFb.ucRowStart;
+    prvOledFbDc(xOledFb.ulSession);
+
+    if( lResult == NO_ERROR )
+    {
+	xOledFb.ucDirty = 0;
+	xOledFb.ulFullFlush = 0;
+    }
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lOledFbInit( void )
+{
+    if( xOledFb.xLock == NULL )
+    {
+	xOledFb.xLock = xSemaphoreCreateMutex();
+	if( xOledFb.xLock == NULL )
+	{
+	    return COMMON_ERR_NULL_PTR;
+	}
+    }
+    /* OLED memory written before may not match the shadow */
+    xOledFb.ulFullFlush = 1;
+    xOledFb.ulInit = 1;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lOledFbBegin( void )
+{
+    if( !xOledFb.ulInit )
+    {
+	/* Library writes the OLED directly */
+	return NO_ERROR;
+    }
+    if( ( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED ) &&
+	( xSemaphoreTake(xOledFb.xLock,
+		pdMS_TO_TICKS(oledFB_LOCK_TIMEOUT_MS)) != pdTRUE ) )
+    {
+	return COMMON_ERR_IN_PROGRESS;
+    }
+    xOledFb.ulCapture = 1;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lOledFbEnd( void )
+{
+    int32_t lResult = NO_ERROR;
+
+    if( !xOledFb.ulInit )
+    {
+	return NO_ERROR;
+    }
+    /* The lock may have been broken by vOledFbDirect() */
+    if( xOledFb.ulCapture )
+    {
+	lResult = prvOledFbFlush();
+	xOledFb.ulCapture = 0;
+    }
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+	xSemaphoreGive(xOledFb.xLock);
+    }
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+void vOledFbDirect( void )
+{
+    /* May interrupt an update: drop the capture and any partial command,
+     * the next update rewrites the whole screen.
+     */
+    xOledFb.ulCapture = 0;
+    xOledFb.ucArgs = 0;
+    xOledFb.ulFullFlush = 1;
+}
+/*---------------------------------------------------------------------------*/
+
+uint32_t ulOledFbSession( uint32_t ulCmd )
+{
+    xOledFb.ulSession = ulCmd;
+    if( xOledFb.ulCapture )
+    {
+	/* DC is driven when the captured bytes are written */
+	return 1;
+    }
+    xOledFb.ulDcLevel = ulCmd;
+    return 0;
+}
+/*---------------------------------------------------------------------------*/
+
+uint32_t ulOledFbWrite( uint8_t ucData, int32_t *plResult )
+{
+    uint32_t ulWindow;
+
+    if( xOledFb.ulSession == oledCMD_SESSION )
+    {
+	ulWindow = prvOledFbCommand(ucData);
+	if( !xOledFb.ulCapture )
+	{
+	    return 0;
+	}
+	if( !ulWindow )
+	{
+	    /* Other commands take effect right away */
+	    prvOledFbDc(oledCMD_SESSION);
+	    *plResult = mml_spi_transmit(oledSPI_DEV, &ucData, sizeof(ucData));
+	}
+	return 1;
+    }
+
+    /* Data written directly is on the OLED already */
+    prvOledFbData(ucData, xOledFb.ulCapture);
+    return xOledFb.ulCapture;
+}
+/*---------------------------------------------------------------------------*/
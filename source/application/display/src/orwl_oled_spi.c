@@ -43,6 +43,13 @@
 
 int32_t lOledspiWrite( uint8_t *pucData )
 {
+	int32_t lResult = NO_ERROR;
+
+	/* During a display update the byte goes to the framebuffer */
+	if( ulOledFbWrite(*pucData, &lResult) )
+	{
+	    return lResult;
+	}
 	return mml_spi_transmit(oledSPI_DEV, pucData, sizeof(int8_t));
 }
 /*---------------------------------------------------------------------------*/
@@ -63,7 +70,8 @@ uint32_t ulOledspiRegister( void )
 	xSpiConfig.ssv = MML_SPI_SSV_LOW;
 	xSpiConfig.ssio = MML_SPI_SSIO_OUTPUT;
 	xSpiConfig.tlj = MML_SPI_TLJ_DIRECT;
-	xSpiConfig.dma_tx.active = MML_SPI_DMA_DISABLE;
+	/* framebuffer bursts are moved by DMA */
+	xSpiConfig.dma_tx.active = MML_SPI_DMA_ENABLE;
 	xSpiConfig.dma_rx.active = MML_SPI_DMA_DISABLE;
 
 	/* Set CS1
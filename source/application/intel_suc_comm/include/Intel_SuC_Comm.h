@@ -42,6 +42,9 @@
  *			1.7 : Updated with new command for updating error status from Intel to SuC
  *          1.8 : Updated with two new commands for RTC management
  *          1.9 : Updated with Macros for masking WiFi Enable and Disable option.
+*          2.0 : Added link version 2 - sequenced frames, sliding window,
+*                selective ACK, CRC-16 and multi-frame messages - and the
+*                ORWL_LINK_VERSION command for negotiating it.
  * $RevLog$
  *
  *============================================================================
@@ -65,6 +68,28 @@ extern "C" {
 #define UART_TRANS_NACK			0x02		/**< UART Received packet has checksum error. */
 #define UART_TRANS_ACK			0x01		/**< UART Received packet checksum is good. */
 
+#define UART_TYP_DATA_V2		0x04		/**< UART Packet is a sequenced data frame. Link version 2 only. */
+#define UART_TYP_ACK_V2			0x05		/**< UART Packet is a selective acknowledgement. Link version 2 only. */
+
+/** Intel SuC link layer versions. Link starts in version 1 after every reset of
+*   either peer. BIOS negotiates version 2 with ORWL_LINK_VERSION, which is sent
+*   in version 1 framing. Both peers switch once the RESP_WRITE of SuC is ACKed.
+*   A version 1 data packet received in version 2 takes the SuC back to version 1,
+*   as BIOS is restarted.
+*   SuC firmware without this support reboots on unknown commands; BIOS must send
+*   ORWL_LINK_VERSION only to SuC reporting a release that supports it.
+*/
+#define UART_LINK_VERSION_1		0x01		/**< Checksum framing with stop and wait ACK/NACK. */
+#define UART_LINK_VERSION_2		0x02		/**< CRC-16 framing with sequence numbers and sliding window. */
+
+#define UART_V2_FLAG_MORE		0x01		/**< More frames of the same message follow this one. */
+#define UART_V2_MAX_WINDOW		8		/**< Largest window that can be negotiated. */
+#define UART_V2_MAX_MESSAGE		1024		/**< Largest message that can be negotiated. */
+#define UART_V2_HDR_SIZE		6		/**< sof, typ, seq, flags and len of IntelSuCDataV2_t. */
+#define UART_V2_CRC_SIZE		2		/**< CRC-16 field size. */
+#define UART_V2_ACK_SIZE		7		/**< Size of IntelSuCAckV2_t. */
+#define UART_V2_CRC_INIT		0xFFFF		/**< CRC-16/CCITT-FALSE, poly 0x1021, init 0xFFFF, no reflection. */
+
 
 /** Intel SuC communication "Data" packet purpose
 */
@@ -96,6 +121,8 @@ extern "C" {
 #define DATA_ERROR_STATAUS		0x14		/**< Coreboot when received un-aligned or out of range data, this will be sent for OLED Update.*/
 #define GET_RTC_TIME			0x15		/**< Get RTC Time of SUC for managing.*/
 #define SET_RTC_TIME			0x16		/**< Set RTC Time of SUC for managing.*/
+#define ORWL_LINK_VERSION		0x17		/**< Negotiate the link layer version. Always sent in link version 1 framing.*/
+#define ORWL_CMD_STATS			0x18		/**< Read the per command statistics of the SuC command dispatcher.*/
 
 /** ORWL Product Dev State for respective Intel BIOS Behavior
 */
@@ -228,6 +255,41 @@ typedef struct urtIntelSuCAckNack
 }IntelSuCAckNack_t ;
 
 
+/** @struct IntelSuCDataV2_t
+    @brief Data frame for link version 2.
+
+    Message is cut into frames of up to UART_MAX_DATA bytes. All frames but the last
+    one of a message have UART_V2_FLAG_MORE set. CRC is sent high byte first, right
+    after len bytes of data, and covers typ to the end of data.
+*/
+typedef struct urtIntelSuCDataV2
+{
+	unsigned char sof[2] ;		/**<  UART Start of Frame.UART_SOF startOfFrame[0] = 0xFE; startOfFrame[1] = 0xDF;*/
+	unsigned char typ ;			/**<  UART_TYP_DATA_V2. */
+	unsigned char seq ;			/**<  Sequence number of the frame, counts modulo 256 per direction. */
+	unsigned char flags ;		/**<  UART_V2_FLAG_xxx. */
+	unsigned char len ;			/**<  Length of the data. */
+	unsigned char data[UART_MAX_DATA + UART_V2_CRC_SIZE] ;	/**<  Data followed by CRC-16. */
+}IntelSuCDataV2_t ;
+
+
+/** @struct IntelSuCAckV2_t
+    @brief Selective acknowledgement for link version 2.
+
+    Sent by the receiver for every valid data frame. Frames with a bad CRC are
+    dropped silently; the sender retransmits the frames missing before a selectively
+    acknowledged one, and on timeout all unacknowledged frames.
+*/
+typedef struct urtIntelSuCAckV2
+{
+	unsigned char sof[2] ;		/**<  UART Start of Frame.UART_SOF startOfFrame[0] = 0xFE; startOfFrame[1] = 0xDF;*/
+	unsigned char typ ;			/**<  UART_TYP_ACK_V2. */
+	unsigned char ack ;			/**<  Next sequence number expected in order. All before it are received. */
+	unsigned char sack ;		/**<  Bit n set - frame ack+1+n is received out of order. */
+	unsigned char crc[UART_V2_CRC_SIZE] ;	/**<  CRC-16 of typ, ack and sack. High byte first. */
+}IntelSuCAckV2_t ;
+
+
 
 /**
 Intel SuC Commmand Response data structure exchanged from peer to peer
@@ -244,12 +306,14 @@ ORWL_SEC_PIN_UPDATE		|	NA	|	NA		|OrwlPinUpdate_t	|SucAckWriteStat	| Intel -> SuC
 INTEL_DEV_ACT			|	NA	|	NA		|IntelSubState_t	|SucAckWriteStat	| Intel -> SuC
 INT_SSD_MGMT_INTEL		|BiosSucAction_t|BiosSsdMgt_t		|	NA		|		NA	| Intel -> SuC
 ORWL_TAMPER_LOG			|BiosSucAction_t|OrwlTamperLog_t	|	NA		|		NA	| Intel -> SuC
+ORWL_TAMPER_LOG			|OrwlTamperLogQuery_t|OrwlTamperLogPage_t|	NA		|		NA	| Intel -> SuC
 ORWL_TAMPER_MGT			|	NA	|	NA		|TamperMgtAct_t		|SucAckWriteStat	| Intel -> SuC
 ORWL_SEC_CHECK_LEVEL0		|BiosSucAction_t|SucAckWriteStat	|	NA		|		NA	| Intel -> SuC
 ORWL_SEC_CHECK_LEVEL1		|BiosSucAction_t|SucAckWriteStat	|	NA		|		NA	| Intel -> SuC
 INTEL_HLOS_STATUS		|	NA	|	NA		|HlosInstallStat_t	|SucAckWriteStat	| Intel -> SuC
 COREBOOT_PUBLIC_KEY		|BiosSucAction_t	|PublicKeyOrwlEcc	|	NA				|		NA			| Intel -> SuC
 DATA_ERROR_STATAUS		|NA					|NA					|OrwlDataVal_t		|SucAckWriteStat	| Intel -> SuC
+ORWL_LINK_VERSION		|	NA	|	NA		|OrwlLinkVersion_t	|OrwlLinkVersion_t	| Intel -> SuC
 ======================================================================================================================
 */
 
@@ -391,6 +455,51 @@ typedef struct orwlTamperLog
 	unsigned char formatLog[128] ;
 } OrwlTamperLog_t;
 
+#define TAMPER_LOG_BY_SEQ		0x00	/**< Query events from a sequence number on */
+#define TAMPER_LOG_BY_TIME		0x01	/**< Query events within a time range */
+
+#define TAMPER_LOG_TYPE_CLEAR		0x00	/**< Tamper cleared by the user */
+#define TAMPER_LOG_TYPE_TAMPER		0x01	/**< Tamper detected */
+
+#define TAMPER_LOG_MAX_EVENTS		18	/**< Events in one OrwlTamperLogPage_t */
+
+/** @struct OrwlTamperLogQuery_t
+    @brief Query of the tamper event log. Multi-byte fields are little endian.
+
+    BIOS starts with cursor 0 and, while the page returned has more set, repeats the
+    same query with cursor set to next of that page.
+*/
+typedef struct orwlTamperLogQuery
+{
+	unsigned char by ;		/**< by - TAMPER_LOG_BY_xxx */
+	unsigned char from[4] ;		/**< from - First sequence number, or first RTC second for TAMPER_LOG_BY_TIME */
+	unsigned char to[4] ;		/**< to - Last sequence number, or last RTC second for TAMPER_LOG_BY_TIME */
+	unsigned char cursor[4] ;	/**< cursor - Sequence number to continue from, 0 to start */
+} OrwlTamperLogQuery_t;
+
+/** @struct OrwlTamperLogEvent_t
+    @brief One event of the tamper event log. Multi-byte fields are little endian.
+*/
+typedef struct orwlTamperLogEvent
+{
+	unsigned char seq[4] ;		/**< seq - Sequence number, increments for every event logged */
+	unsigned char time[4] ;		/**< time - RTC seconds of occurrence */
+	unsigned char cause[4] ;	/**< cause - Secure monitor alarm bits of the tamper */
+	unsigned char type ;		/**< type - TAMPER_LOG_TYPE_xxx */
+} OrwlTamperLogEvent_t;
+
+/** @struct OrwlTamperLogPage_t
+    @brief Events matching OrwlTamperLogQuery_t, oldest first. Multi-byte fields are little endian.
+*/
+typedef struct orwlTamperLogPage
+{
+	unsigned char count ;		/**< count - Valid entries in event */
+	unsigned char more ;		/**< more - 1 if further events match, query again with cursor = next */
+	unsigned char next[4] ;		/**< next - Cursor of the following page */
+	unsigned char first[4] ;	/**< first - Oldest sequence number still in the log, older ones were dropped */
+	OrwlTamperLogEvent_t event[TAMPER_LOG_MAX_EVENTS] ;	/**< event - Events of this page */
+} OrwlTamperLogPage_t;
+
 /** @struct OrwlPinUpdate_t
     @brief 6-Digit security PIN in ASCII value for the digit. Index 0 corresponds to first digit to be entered.
 */
@@ -446,6 +555,59 @@ typedef struct publiKeyORWLEcc
 	unsigned char key[32] ;		/**< key - 256bit public key .  */
 } PublicKeyOrwlEcc;
 
+/** @struct OrwlLinkVersion_t
+    @brief Link layer capabilities. BIOS sends the highest version and the limits it
+    supports; SuC answers with the version and limits both sides will use.
+*/
+typedef struct orwlLinkVersion
+{
+	unsigned char version ;		/**< version - UART_LINK_VERSION_xxx */
+	unsigned char window ;		/**< window - Frames a sender may have unacknowledged, 1 to UART_V2_MAX_WINDOW */
+	unsigned char maxMsgLo ;	/**< maxMsgLo - Low byte of the largest message, up to UART_V2_MAX_MESSAGE */
+	unsigned char maxMsgHi ;	/**< maxMsgHi - High byte of the largest message */
+} OrwlLinkVersion_t;
+
+#define CMD_STATS_HIST_BUCKETS		12	/**< Latency buckets, bucket n counts commands done under 2^n ms, the last one the rest */
+#define CMD_STATS_MAX_ENTRIES		6	/**< Entries in one OrwlCmdStatsPage_t */
+
+/** @struct OrwlCmdStatsQuery_t
+    @brief Query of the command statistics.
+
+    BIOS starts with first 0 and, while the page returned has more set, repeats the
+    query with first set to next of that page.
+*/
+typedef struct orwlCmdStatsQuery
+{
+	unsigned char first ;		/**< first - Packet type to report from */
+	unsigned char clear ;		/**< clear - 1 to clear all statistics once the last page is read */
+} OrwlCmdStatsQuery_t;
+
+/** @struct OrwlCmdStatsEntry_t
+    @brief Statistics of one packet type. Multi-byte fields are little endian.
+
+    Latency runs from the dispatch of the command to its response being queued, including
+    the wait for the user mode application.
+*/
+typedef struct orwlCmdStatsEntry
+{
+	unsigned char pktType ;		/**< pktType - Packet type of the command */
+	unsigned char count[4] ;	/**< count - Commands run */
+	unsigned char errors[4] ;	/**< errors - Commands whose handler failed or whose write was refused */
+	unsigned char maxUs[4] ;	/**< maxUs - Longest latency in microseconds */
+	unsigned char hist[CMD_STATS_HIST_BUCKETS][2] ;	/**< hist - Latency histogram, counts saturate at 0xFFFF */
+} OrwlCmdStatsEntry_t;
+
+/** @struct OrwlCmdStatsPage_t
+    @brief Packet types run since the statistics were cleared, in increasing order.
+*/
+typedef struct orwlCmdStatsPage
+{
+	unsigned char count ;		/**< count - Valid entries in entry */
+	unsigned char more ;		/**< more - 1 if further packet types follow, query again with first = next */
+	unsigned char next ;		/**< next - First packet type of the following page */
+	OrwlCmdStatsEntry_t entry[CMD_STATS_MAX_ENTRIES] ;	/**< entry - Entries of this page */
+} OrwlCmdStatsPage_t;
+
 #ifdef __cplusplus
 extern "C" }
 #endif
@@ -35,6 +35,7 @@
 #ifndef __INTEL_SUC_COM_H__
 #define __INTEL_SUC_COM_H__
 #include <Intel_SuC_Comm.h>   /**< Common definition file between Intel and SuC development*/
+#include <intel_suc_link.h>
 
 
 /* Create event flags for the data buffer */
@@ -49,8 +50,10 @@
 #define intelSESSION_AUTH_FAIL		(1<<7)  /**< Event bit for authentication failure */
 #define intelSESSION_INVALID_COMMAND	(1<<8)  /**< Event bit for invalid command from Intel */
 
-/** Maximum possible packet size - 255+ len + chksum + 0xFE + 0xDF + pktype */
-#define intelSUC_BUFF_RX_SIZE		(255 + 5)
+/** Receive ring holds a full window of the largest link version 2 frames,
+ * which is more than one version 1 packet - 255 + len + chksum + 0xFE + 0xDF
+ * + pktype */
+#define intelSUC_BUFF_RX_SIZE		(intelLINK_MAX_WINDOW * intelLINK_FRAME_SIZE)
 #define intelHW_VERSION			(0x2)/**< hwVer - PCBA HW Version for SuC Config */
 #define intelSUC_SW_MAJOR_RELEASE_NO	(VERSION_MAJOR)/**< swVerMajor-SuC SW Major Release number */
 #define intelSUC_SW_MINOR_RELEASE_NO	(VERSION_MINOR)/**< swVerMinor - SuC SW Minor Release number.*/
@@ -65,6 +68,22 @@
 #define intelMAX_TAMPER_LOG_SIZE	(8)  /**< Maximum size of tamper log */
 #define intelMAX_DATE_TIME_SIZE		(20) /**< Maximum size of date & time */
 
+/* Task notification bits, set by UART ISR for the IntelSuC task */
+#define intelNOTIFY_RX			(1<<0)  /**< Data or rx error received */
+#define intelNOTIFY_TX_DONE		(1<<1)  /**< Last byte handed to tx FIFO */
+#define intelNOTIFY_ALL			(intelNOTIFY_RX | intelNOTIFY_TX_DONE)
+
+/** Maximum size of transmit frame - pre amble and payload */
+#define intelTX_FRAME_SIZE		(intelPRE_AMBLE_SIZE + 255)
+#define intelUART_BITS_PER_CHAR		(10) /**< start + 8 data + stop bit */
+#define intelTX_TIMEOUT_MARGIN_MS	(20) /**< margin over wire time of tx */
+#define intelLINK_ACK_TIMEOUT_MS	(100) /**< link version 2 wait for ack before resending */
+#define intelDEFER_POLL_MS		(20) /**< check for the reply of a deferred command */
+/** Payload types covered by the dispatch table */
+#define intelDISPATCH_SIZE		(ORWL_CMD_STATS + 1)
+/** Returned by a command handler whose response waits for the user mode app */
+#define intelCMD_DEFERRED		(COMMON_ERR_IN_PROGRESS)
+
 typedef enum
 {
 	eINIT_STATE = 0x01,	/**< Initial state */
@@ -74,7 +93,8 @@ typedef enum
 	eCHECKSUM_STATE,	/**< Checksum state */
 	ePAYLOAD_STATE,		/**< Payload state */
 	ePAYLOAD_COMPLETE,	/**< Payload complete state */
-	eACK_NACK_STATE		/**< Acknowledgement and not acknowledgement state */
+	eACK_NACK_STATE,	/**< Acknowledgement and not acknowledgement state */
+	eLINK_V2_STATE		/**< Link version 2 frame, parsed by link layer */
 } eORWLDataLinkPacketReceiveState;
 
 typedef union
@@ -101,14 +121,16 @@ typedef struct
 /** Structure for uart rx buffer */
 typedef struct
 {
-   uint16_t usInPtr;
-   uint16_t usOutPtr;
-   uint16_t usByteFree;
+   volatile uint16_t usInPtr;	/**< written only by ISR */
+   volatile uint16_t usOutPtr;	/**< written only by IntelSuC task */
    uint8_t ucBuff[intelSUC_BUFF_RX_SIZE];
 } xSplRxUartBuffer_t;
 
 typedef int32_t (*tpfnCommand)(void);
 
+/** Completes a deferred command with the reply of the user mode app */
+typedef int32_t (*tpfnReply)(uint8_t ucAck);
+
 typedef struct
 {
     uint8_t ucPktType;		/**< type of packet */
@@ -116,6 +138,23 @@ typedef struct
     tpfnCommand cmd_write;	/**< command for writing data */
 }xIntelSucCommHandling;
 
+/** Statistics of one command of the lookup table */
+typedef struct
+{
+    uint32_t ulCount;				/**< commands run */
+    uint32_t ulErrors;				/**< handler failed or write refused */
+    uint32_t ulMaxUs;				/**< longest latency in us */
+    uint32_t ulHist[CMD_STATS_HIST_BUCKETS];	/**< latency histogram */
+}xIntelSucCmdStats_t;
+
+/** Command waiting for the reply of the user mode app */
+typedef struct
+{
+    tpfnReply pfnDone;		/**< queues the response, NULL if none waits */
+    uint8_t ucRow;		/**< lookup table row of the command */
+    uint32_t ulStart;		/**< timestamp of the dispatch */
+}xIntelSucDeferred_t;
+
 /* Variables of structure */
 extern EventGroupHandle_t xUartTxRXSync ;
 extern xUartBuffer_t xTxBuffer ;
@@ -137,10 +176,11 @@ extern xUartBuffer_t xTxBuffer ;
 int32_t lIntelSendPacket(uint8_t *pucMsg, uint8_t *pucLen, TickType_t * pxTimeout );
 
 /**
- * @brief Interrupt service routine
+ * @brief IntelSuC communication task
  *
- * This isr is used to check if there is some data received
- * or rx error interrupt received by reading interrupt status reg.
+ * Task sleeps on its task notification till UART ISR reports received data
+ * or end of transmission, then processes received packets and sends the
+ * responses queued by the command handlers.
  *
  * @return void
  */
@@ -159,7 +199,9 @@ void vIntelProcessRxPacket( void );
 /**
  * @brief For transmitting the data
  *
- * This function is is used for transmitting the data on UART.
+ * This function is is used for transmitting the data on UART. Data is fed
+ * to tx FIFO by UART ISR, caller is blocked till all of it is handed over.
+ * Should be called only from IntelSuC task.
  *
  * @param pucMsg is pointer to data to be transmitted
  * @param ucLen is the size of data
@@ -0,0 +1,200 @@
+ /**===========================================================================
+ * @file intel_suc_link.h
+ *
+ * @brief Sliding window link layer (version 2) of the Intel SuC UART protocol.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef __INTEL_SUC_LINK_H__
+#define __INTEL_SUC_LINK_H__
+
+#include <stdint.h>
+#include <Intel_SuC_Comm.h>
+
+/** Number of frames the SuC keeps outstanding or buffered out of order */
+#define intelLINK_MAX_WINDOW		(4)
+/** Payload size the SuC cuts outgoing messages into; a frame of it must fit
+ * intelTX_FRAME_SIZE */
+#define intelLINK_TX_FRAME_DATA		(64)
+/** Maximum number of frames of one outgoing message */
+#define intelLINK_MAX_TX_FRAMES		((UART_V2_MAX_MESSAGE + \
+					intelLINK_TX_FRAME_DATA - 1) / \
+					intelLINK_TX_FRAME_DATA)
+/** Maximum retransmissions of one frame before the message is failed */
+#define intelLINK_MAX_RETRY		(3)
+/** Largest frame on the wire - sof, typ, seq, flags, len, data, crc */
+#define intelLINK_FRAME_SIZE		(UART_V2_HDR_SIZE + UART_MAX_DATA + \
+					UART_V2_CRC_SIZE)
+
+/* Return values of lIntelLinkRxByte() and lIntelLinkRxDeliver() */
+#define intelLINK_RX_MORE		(0)  /**< frame is not complete yet */
+#define intelLINK_RX_DONE		(1)  /**< frame consumed, nothing to deliver */
+#define intelLINK_RX_DATA		(2)  /**< data frame accepted, send ack */
+#define intelLINK_RX_ACKED		(3)  /**< ack frame updated tx window */
+#define intelLINK_RX_MESSAGE		(4)  /**< complete message available */
+#define intelLINK_RX_ERROR		(5)  /**< frame dropped on crc or length */
+
+/* Return values of lIntelLinkTxStatus() */
+#define intelLINK_TX_IDLE		(0)  /**< no message being sent */
+#define intelLINK_TX_BUSY		(1)  /**< frames outstanding */
+#define intelLINK_TX_DONE		(2)  /**< all frames acknowledged */
+#define intelLINK_TX_FAIL		(3)  /**< retries exhausted */
+
+/**
+ * @brief Calculate CRC-16/CCITT-FALSE
+ *
+ * Polynomial 0x1021, no reflection. Start a new CRC with
+ * UART_V2_CRC_INIT and feed the data in as many parts as needed.
+ *
+ * @param usCrc CRC of the data so far.
+ * @param pucData data to add.
+ * @param ulLen length of data.
+ *
+ * @return updated CRC
+ */
+uint16_t usIntelLinkCrc16( uint16_t usCrc, const uint8_t *pucData,
+			   uint32_t ulLen );
+
+/**
+ * @brief Select the link version
+ *
+ * Sequence numbers, windows and reassembly are reset. Selecting
+ * UART_LINK_VERSION_1 returns to legacy framing.
+ *
+ * @param ucVersion link version, UART_LINK_VERSION_xxx.
+ * @param ucWindow window agreed with BIOS.
+ * @param usMaxMsg largest message agreed with BIOS.
+ *
+ * @return void
+ */
+void vIntelLinkReset( uint8_t ucVersion, uint8_t ucWindow, uint16_t usMaxMsg );
+
+/**
+ * @brief Get the link version in use
+ *
+ * @return UART_LINK_VERSION_xxx
+ */
+uint8_t ucIntelLinkVersion( void );
+
+/**
+ * @brief Start parsing a version 2 frame
+ *
+ * Called once start of frame and type are received.
+ *
+ * @param ucType UART_TYP_DATA_V2 or UART_TYP_ACK_V2.
+ *
+ * @return void
+ */
+void vIntelLinkRxStart( uint8_t ucType );
+
+/**
+ * @brief Feed one received byte of a version 2 frame
+ *
+ * @param ucByte received byte.
+ *
+ * @return intelLINK_RX_xxx
+ */
+int32_t lIntelLinkRxByte( uint8_t ucByte );
+
+/**
+ * @brief Move in order frames to the message being reassembled
+ *
+ * Stops at the end of each message; the message must be taken with
+ * pucIntelLinkRxMessage() before the next call.
+ *
+ * @return intelLINK_RX_MESSAGE or intelLINK_RX_DONE
+ */
+int32_t lIntelLinkRxDeliver( void );
+
+/**
+ * @brief Check for received frames not yet moved to a message
+ *
+ * @return 1 if lIntelLinkRxDeliver() has work, 0 otherwise
+ */
+uint8_t ucIntelLinkRxBacklog( void );
+
+/**
+ * @brief Get the message completed by lIntelLinkRxDeliver()
+ *
+ * @param pusLen length of the message.
+ *
+ * @return pointer to the message, valid till next lIntelLinkRxDeliver()
+ */
+const uint8_t *pucIntelLinkRxMessage( uint16_t *pusLen );
+
+/**
+ * @brief Build the acknowledgement of received data frames
+ *
+ * @param pucFrame buffer of at least UART_V2_ACK_SIZE bytes.
+ *
+ * @return length of the frame
+ */
+uint16_t usIntelLinkBuildAck( uint8_t *pucFrame );
+
+/**
+ * @brief Queue a message for sending
+ *
+ * Message is copied, caller may reuse its buffer.
+ *
+ * @param pucMsg message.
+ * @param usLen length of message.
+ *
+ * @return error code
+ */
+int32_t lIntelLinkTxStart( const uint8_t *pucMsg, uint16_t usLen );
+
+/**
+ * @brief Build the next frame to put on the wire
+ *
+ * Retransmissions come first, then new frames as long as the window
+ * allows.
+ *
+ * @param pucFrame buffer of at least intelLINK_FRAME_SIZE bytes.
+ *
+ * @return length of the frame, 0 if nothing is to be sent now
+ */
+uint16_t usIntelLinkTxNext( uint8_t *pucFrame );
+
+/**
+ * @brief Report that no acknowledgement came in time
+ *
+ * All unacknowledged frames of the window are sent again.
+ *
+ * @return void
+ */
+void vIntelLinkTxTimeout( void );
+
+/**
+ * @brief Get state of the message being sent
+ *
+ * @return intelLINK_TX_xxx
+ */
+int32_t lIntelLinkTxStatus( void );
+
+#endif /* __INTEL_SUC_LINK_H__ */
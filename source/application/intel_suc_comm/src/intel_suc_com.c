@@ -57,7 +57,7 @@
 #include <debug.h>
 #include <Intel_SuC_Comm.h>
 #include <intel_suc_comm_manager.h>
-#include <init.h>
+#include <Init.h>
 #include <mfgdata.h>
 #include <task_config.h>
 #include <rtc.h>
@@ -73,6 +73,11 @@
 #include <orwl_disp_interface.h>
 #include <systemRes.h>
 #include <tamper_log_intel.h>
+#include <events.h>
+#include <orwl_timer.h>
+#ifdef ORWL_HOST_SIM
+#include <sim.h>
+#endif
 #include <orwl_secalm.h>
 #include <oled_ui.h>
 #include <pinhandling.h>
@@ -106,6 +111,48 @@ extern xSMAppResources_t xgResource;
  */
 static void prvIntelSucUartIsr( void );
 
+/**
+ * @brief Fill tx FIFO from the frame being sent
+ *
+ * Called from UART ISR.
+ *
+ * @return pdTRUE if all of the frame is handed to tx FIFO
+ */
+static BaseType_t prvIntelSucTxFill( void );
+
+/**
+ * @brief Send data on UART
+ *
+ * Data is fed to tx FIFO by UART ISR. Calling task is blocked till all of
+ * the data is handed over, or wire time of the data is over by
+ * intelTX_TIMEOUT_MARGIN_MS.
+ *
+ * @param pucMsg data to send.
+ * @param usLen length of data.
+ *
+ * @return error code
+ */
+static int32_t prvIntelSucUartSend( const uint8_t *pucMsg, uint16_t usLen );
+
+/**
+ * @brief Wait for notification from UART ISR
+ *
+ * Notifications not asked for are kept pending for a later wait.
+ *
+ * @param ulBits notification bits to wait for.
+ * @param xTicks ticks to wait.
+ *
+ * @return notification bits received out of ulBits, 0 on timeout
+ */
+static uint32_t prvIntelSucWait( uint32_t ulBits, TickType_t xTicks );
+
+/**
+ * @brief Check for unprocessed data in rx buffer
+ *
+ * @return pdTRUE if there is data to process
+ */
+static BaseType_t prvIntelSucRxPending( void );
+
 /**
  * @brief For initializing uart port
  *
@@ -167,11 +214,58 @@ static int32_t prvKeyData( void );
  * @brief For tamper log
  *
  * This function is used for reading tamper log and transmitting the same.
+ * Without query the last tamper is sent formatted, with OrwlTamperLogQuery_t
+ * one page of matching events is sent.
  *
  * @return void
  */
 static int32_t prvTamperLog( void );
 
+/**
+ * @brief Queues a command for the user mode application.
+ *
+ * The command is queued and the user mode application is woken through its
+ * event group.
+ *
+ * @param pxData command to queue.
+ *
+ * @return void
+ */
+static void prvSendToUserApp( IntelUserData_t *pxData );
+
+/**
+ * @brief Fills one page of the tamper event log.
+ *
+ * Events dropped or torn while written are skipped. Unknown query types give
+ * an empty page.
+ *
+ * @param pxQuery query received from BIOS.
+ * @param pxPage page to fill.
+ *
+ * @return error code
+ */
+static int32_t prvTamperLogPage( const OrwlTamperLogQuery_t *pxQuery,
+	OrwlTamperLogPage_t *pxPage );
+
+/**
+ * @brief Reads a little endian 32 bit protocol field.
+ *
+ * @param pucField field to read.
+ *
+ * @return value of the field
+ */
+static uint32_t prvGetLe32( const unsigned char *pucField );
+
+/**
+ * @brief Writes a little endian 32 bit protocol field.
+ *
+ * @param pucField field to write.
+ * @param ulValue value to write.
+ *
+ * @return void
+ */
+static void prvPutLe32( unsigned char *pucField, uint32_t ulValue );
+
 /**
  * @brief For security check of level1.
  *
@@ -277,20 +371,22 @@ static int32_t prvSetRTCTime( void );
  * @brief Send data to supervisor task.
  *
  * This function is used for sending command and data to supervisory task.
+ * The response is sent by prvKeyMgtReply once the supervisory task replies.
  *
  * @param pxData pointer to the keyfob data.
  *
- * @return NO_ERROR on success and error code on failure.
+ * @return intelCMD_DEFERRED or SUC_WRITE_STATUS_FAIL_INVALID for unknown
+ * action.
  */
 static int32_t prvIntelSendKeyFobData( OrwlKeyMgt_t *pxData );
 
 /**
  * @brief Send SSD password generate command to supervisor task.
- *        Waits for the data from supervisor to be sent to BIOS
+ *        The response is sent by prvRotRegenReply.
  *
- * @param pxData pointer to the data.
+ * @param pxData pointer to the data, has to stay valid till the reply.
  *
- * @return NO_ERROR in success or error code on failure.
+ * @return intelCMD_DEFERRED
  */
 static int32_t prvIntelSSDGenCmd(BiosSuc1B_t *pxData);
 
@@ -298,10 +394,134 @@ static int32_t prvIntelSSDGenCmd(BiosSuc1B_t *pxData);
  * @brief Send security check command to supervisor task.
  *
  * @param ucCommand level check command.
+ * @param pfnDone sends the response once the supervisory task replies.
+ *
+ * @return intelCMD_DEFERRED
+ */
+static int32_t prvIntelSecCommand( uint32_t ucCommand, tpfnReply pfnDone );
+
+/**
+ * @brief Queues a command for the user mode app and defers the response.
+ *
+ * The IntelSuC task goes on servicing the link while the user mode app runs
+ * the command, see prvIntelDeferPoll.
+ *
+ * @param pxData command to queue, pvData has to stay valid till the reply.
+ * @param pfnDone sends the response once the user mode app replies.
+ *
+ * @return intelCMD_DEFERRED
+ */
+static int32_t prvIntelDefer( IntelUserData_t *pxData, tpfnReply pfnDone );
+
+/**
+ * @brief Completes the deferred command if the user mode app has replied.
+ *
+ * @return pdTRUE if a command was completed
+ */
+static BaseType_t prvIntelDeferPoll( void );
+
+/**
+ * @brief Checks for received data or commands to process.
+ *
+ * Link version 2 commands are held while a reply is deferred.
+ *
+ * @return pdTRUE if vIntelProcessRxPacket has work
+ */
+static BaseType_t prvIntelSucHasWork( void );
+
+/**
+ * @brief Records a command in its statistics.
+ *
+ * @param ucRow lookup table row of the command.
+ * @param ulStart timestamp of the dispatch.
+ * @param xFailed pdTRUE if the handler failed or the write was refused.
  *
- * @return NO_ERROR in success or error code on failure.
+ * @return void
  */
-static int32_t prvIntelSecCommand( uint32_t ucCommand );
+static void prvIntelStatsRecord( uint8_t ucRow, uint32_t ulStart,
+	BaseType_t xFailed );
+
+/**
+ * @brief Sends the key management response.
+ *
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvKeyMgtReply( uint8_t ucAck );
+
+/**
+ * @brief Sends the keyfob data read by the supervisory task.
+ *
+ * @param ucAck reply of the supervisory task.
+ *
+ * @return error code
+ */
+static int32_t prvKeyDataReply( uint8_t ucAck );
+
+/**
+ * @brief Sends the security check level 1 response.
+ *
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvSecLevel1Reply( uint8_t ucAck );
+
+/**
+ * @brief Sends the security check level 2 response.
+ *
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvSecLevel2Reply( uint8_t ucAck );
+
+/**
+ * @brief Sends the response of a security check.
+ *
+ * @param ucPktType ORWL_SEC_CHECK_LEVEL0 or ORWL_SEC_CHECK_LEVEL1.
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvSecLevelReply( uint8_t ucPktType, uint8_t ucAck );
+
+/**
+ * @brief Sends the ROT regeneration response.
+ *
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvRotRegenReply( uint8_t ucAck );
+
+/**
+ * @brief Sends the Intel device state update response.
+ *
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvIntelDevStateReply( uint8_t ucAck );
+
+/**
+ * @brief Sends the OS installation status response.
+ *
+ * @param ucAck reply of the supervisory task, SUC_WRITE_STATUS_xxx.
+ *
+ * @return error code
+ */
+static int32_t prvHlosStatReply( uint8_t ucAck );
+
+/**
+ * @brief To read the command statistics.
+ *
+ * Sends one OrwlCmdStatsPage_t for the OrwlCmdStatsQuery_t received.
+ *
+ * @return error code
+ */
+static int32_t prvCmdStats( void );
 
 /**
  * @brief Displays message on oled .
@@ -334,6 +554,54 @@ static void prvFormatLog(uint32_t ulTamperCause, rtcDateTime_t* pxRtcDateTime,
  */
 static int32_t prvHandleDataError( void );
 
+/**
+ * @brief To negotiate the link version.
+ *
+ * This function picks the link version and limits both sides support and
+ * sends them to Intel. Link version 2 is taken in use once Intel ACKs the
+ * response.
+ *
+ * @return error code
+ */
+static int32_t prvLinkVersion( void );
+
+/**
+ * @brief Run the command in receive buffer
+ *
+ * Looks up the packet type of xRxProcessBuff and calls its read or write
+ * handler.
+ *
+ * @return void
+ */
+static void prvIntelDispatchPacket( void );
+
+/**
+ * @brief Run next command received on link version 2
+ *
+ * Held while the response of an earlier command is waiting for transmit,
+ * as there is a single transmit buffer.
+ *
+ * @return pdTRUE if a command was run
+ */
+static BaseType_t prvIntelLinkDeliver( void );
+
+/**
+ * @brief Send xTxBuffer on link version 2
+ *
+ * Window is kept full, lost frames are sent again on selective ack or
+ * timeout. Sets intelSESSION_TX_SUCCESS or intelSESSION_TX_FAIL.
+ *
+ * @return void
+ */
+static void prvIntelSucSendLinkV2( void );
+
+/**
+ * @brief Switch link version once negotiation response is delivered
+ *
+ * @return void
+ */
+static void prvIntelLinkSwitch( void );
+
 static xIntelSucCommHandling xIntelSucLookUpAction[] =
 	{   /* Command Packet Type      cmd_read		, cmd_write*/
 	    {ORWL_DEV_STATE	 	,prvDevStateRead	,NULL},
@@ -356,12 +624,42 @@ static xIntelSucCommHandling xIntelSucLookUpAction[] =
 	    {COREBOOT_PUBLIC_KEY	,NULL			,NULL},
 	    {GET_RTC_TIME	        ,prvGetRTCTime		,NULL},
 	    {SET_RTC_TIME	        ,NULL			,prvSetRTCTime},
-	    {DATA_ERROR_STATAUS         ,NULL			,prvHandleDataError}
+	    {DATA_ERROR_STATAUS         ,NULL			,prvHandleDataError},
+	    {ORWL_LINK_VERSION		,NULL			,prvLinkVersion},
+	    {ORWL_CMD_STATS		,prvCmdStats		,NULL}
 	};
+/** Rows of xIntelSucLookUpAction */
+#define intelLOOKUP_ROWS	(sizeof(xIntelSucLookUpAction) / \
+				sizeof(xIntelSucCommHandling))
 /*---------------------------------------------------------------------------*/
 static uint8_t ucPreAmble[intelPRE_AMBLE_SIZE] = {0xFE, 0xDF,0x02, 0x0, 0x0} ;
 xSplRxUartBuffer_t xBuffer;
-static int32_t lSizxIntelSucLookUpAction ;
+/** lookup table row + 1 of each payload type, 0 if not supported */
+static uint8_t ucIntelSucDispatch[intelDISPATCH_SIZE];
+/** statistics of each lookup table row */
+static xIntelSucCmdStats_t xIntelSucStats[intelLOOKUP_ROWS];
+/** command whose response waits for the user mode app */
+static xIntelSucDeferred_t xIntelSucDeferred;
+/** keyfob data read by the user mode app for a deferred ORWL_KEY_FOR_DAT */
+static OrwlKeyData_t xKeyDataReply;
+/** data of a deferred SUC_ROT_REGEN */
+static BiosSuc1B_t xRotRegenData;
+/** IntelSuC task, notified by UART ISR */
+static TaskHandle_t xIntelSucTask = NULL;
+/** frame being sent, pre amble and payload */
+static uint8_t ucTxFrame[intelTX_FRAME_SIZE];
+/** next byte to hand to tx FIFO, owned by ISR while tx interrupt is on */
+static const uint8_t * volatile pucTxNext = NULL;
+/** bytes left to hand to tx FIFO */
+static volatile uint16_t usTxLeft = 0;
+/** notifications received but not yet waited for */
+static uint32_t ulNotifyPending = 0;
+/** link version 2 acknowledgement frame */
+static uint8_t ucLinkAck[UART_V2_ACK_SIZE];
+/** link parameters to use once negotiation response is ACKed */
+static OrwlLinkVersion_t xLinkPending;
+/** negotiation response is being sent */
+static uint8_t ucLinkSwitch = 0;
 int32_t *plSuCState;
 /**
  * Static functions
@@ -371,7 +669,6 @@ int32_t *plSuCState;
 static int32_t prvIntelSendKeyFobData( OrwlKeyMgt_t *pxData )
 {
     IntelUserData_t xKeyFobData;
-    uint8_t ucAck;
 
     /* Check for NULL */
     configASSERT( pxData != NULL );
@@ -398,46 +695,100 @@ static int32_t prvIntelSendKeyFobData( OrwlKeyMgt_t *pxData )
 
     xKeyFobData.pvData = pxData;
     /* Send the Keyfob Add/Delete command to supervisory task */
-    xQueueSend(xgResource.xSucBiosSendQueue, &xKeyFobData, portMAX_DELAY);
-    /* Receive the acknowledgment for the sent command */
-    xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucAck, portMAX_DELAY);
-    /* Return the acknowledgment received */
-    return (ucAck);
+    return prvIntelDefer(&xKeyFobData, prvKeyMgtReply);
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvSendToUserApp( IntelUserData_t *pxData )
+{
+    xQueueSend(xgResource.xSucBiosSendQueue, pxData, portMAX_DELAY);
+    xEventGroupSetBits(xgResource.xEventGroupUserModeApp, eventsBIOS_COMMAND);
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvIntelDefer( IntelUserData_t *pxData, tpfnReply pfnDone )
+{
+    prvSendToUserApp(pxData);
+    /* Row and start time were set by prvIntelDispatchPacket */
+    xIntelSucDeferred.pfnDone = pfnDone;
+    return intelCMD_DEFERRED;
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvIntelDeferPoll( void )
+{
+    tpfnReply pfnDone = xIntelSucDeferred.pfnDone;
+    uint8_t ucAck;
+    int32_t lResult;
+
+    if((pfnDone == NULL) ||
+	    (xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucAck, 0) != pdTRUE))
+    {
+	return pdFALSE;
+    }
+    xIntelSucDeferred.pfnDone = NULL;
+    lResult = pfnDone(ucAck);
+    prvIntelStatsRecord(xIntelSucDeferred.ucRow, xIntelSucDeferred.ulStart,
+	    ((lResult != NO_ERROR) || (ucAck != SUC_WRITE_STATUS_SUCCESS)) ?
+		    pdTRUE : pdFALSE);
+    if(lResult != NO_ERROR)
+    {
+	prvShutdownAndDisplayMessage(
+		(int8_t *)"Intel SuC Com   Failed Reboot...");
+    }
+    return pdTRUE;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvIntelStatsRecord( uint8_t ucRow, uint32_t ulStart,
+	BaseType_t xFailed )
+{
+    xIntelSucCmdStats_t *pxStats = &xIntelSucStats[ucRow];
+    uint32_t ulBucket = 0;
+    uint32_t ulUs;
+
+    ulUs = (uint32_t)(((uint64_t)(ulTimerTimestamp() - ulStart) * 1000000) /
+	    timerTIMESTAMP_HZ);
+
+    pxStats->ulCount++;
+    if(xFailed == pdTRUE)
+    {
+	pxStats->ulErrors++;
+    }
+    if(ulUs > pxStats->ulMaxUs)
+    {
+	pxStats->ulMaxUs = ulUs;
+    }
+    /* Bucket n holds latencies under 2^n ms */
+    while((ulBucket < (CMD_STATS_HIST_BUCKETS - 1)) &&
+	    (ulUs >= (1000UL << ulBucket)))
+    {
+	ulBucket++;
+    }
+    pxStats->ulHist[ulBucket]++;
 }
 /*---------------------------------------------------------------------------*/
 
 static int32_t prvIntelSSDGenCmd(BiosSuc1B_t *pxData)
 {
     IntelUserData_t xSSData;
-    uint8_t ucAck;
 
     xSSData.ucCommand = SUC_ROT_REGEN;
     xSSData.pvData = pxData;
 
     /* Send the ssd password generate command to supervisory task */
-    xQueueSend(xgResource.xSucBiosSendQueue, &xSSData, portMAX_DELAY);
-    /* Receive the acknowledgment for the sent command */
-    xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucAck, portMAX_DELAY);
-
-    /* Return the acknowledgment received */
-    return (ucAck);
+    return prvIntelDefer(&xSSData, prvRotRegenReply);
 }
 /*---------------------------------------------------------------------------*/
 
-static int32_t prvIntelSecCommand( uint32_t ucCommand )
+static int32_t prvIntelSecCommand( uint32_t ucCommand, tpfnReply pfnDone )
 {
     IntelUserData_t xSecData;
-    uint8_t ucAck;
 
     /* Security check 1 or 2 command*/
     xSecData.ucCommand = ucCommand;
     /* Send the Security check 1 or 2  command to supervisory task */
-    xQueueSend(xgResource.xSucBiosSendQueue, &xSecData, portMAX_DELAY);
-    /* Receive the acknowledgment for the sent command */
-    xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucAck, portMAX_DELAY);
-
-    /* Return the acknowledgment received */
-    return (ucAck);
+    return prvIntelDefer(&xSecData, pfnDone);
 }
 /*---------------------------------------------------------------------------*/
 
@@ -717,9 +1068,8 @@ static int32_t prvDevProdConfig( void )
 static int32_t prvKeyMgtAdd( void )
 {
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
-    BiosSuc1B_t xResPack;
     OrwlKeyMgt_t * pxDataReceived;
-    int32_t lResult = NO_ERROR;
+    int32_t lResult;
 
     /* Point to the data buffer */
     pxDataReceived =(OrwlKeyMgt_t *) &xRxProcessBuff.xBuff.actWithData.data[0];
@@ -728,11 +1078,25 @@ static int32_t prvKeyMgtAdd( void )
     debugPRINT_SUC_INTEL_COMM("Key Management Key Name Received %s\n\r",pxDataReceived->keyFobNam);
     debugPRINT_SUC_INTEL_COMM("Key Management Key Name Attribute %c\n\r",pxDataReceived->preAttr);
 
-    /* Add new keyfob or delete the existing one.
-     * Check for add/delete operation failure.
+    /* Add new keyfob or delete the existing one. Response is sent once the
+     * supervisory task replies.
      */
-    if ((lResult = prvIntelSendKeyFobData(pxDataReceived))
-	    != SUC_WRITE_STATUS_SUCCESS)
+    lResult = prvIntelSendKeyFobData(pxDataReceived);
+    if(lResult == intelCMD_DEFERRED)
+    {
+	return intelCMD_DEFERRED;
+    }
+    return prvKeyMgtReply((uint8_t)lResult);
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvKeyMgtReply( uint8_t ucAck )
+{
+    BiosSuc1B_t xResPack;
+    int32_t lResult = ucAck;
+
+    /* Check for add/delete operation failure */
+    if(lResult != SUC_WRITE_STATUS_SUCCESS)
     {
 	debugERROR_PRINT("Failed to Add/Delete key\n");
     }
@@ -770,37 +1134,37 @@ static int32_t prvKeyMgtAdd( void )
 
 static int32_t prvKeyData( void )
 {
-    BiosSucActionWithData_t xResPack;
     /* Read KeyFob data to send to BIOS */
     IntelUserData_t xReadKeyFOb;
-    /* ORWL keyfob data */
-    OrwlKeyData_t xDataToSend;
-    /* ACK from supervisory/waiting task */
-    uint8_t ucACK = 0;
 
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
-    memset(&xDataToSend,0,sizeof(xDataToSend));
+    memset(&xKeyDataReply,0,sizeof(xKeyDataReply));
 
-    /* Asign xDataToSend to xReadKeyFOb.pvData, so that KeyFob information will
-     * be read at waiting task and updated the same to xReadKeyFOb.pvData.
+    /* Asign xKeyDataReply to xReadKeyFOb.pvData, so that KeyFob information
+     * will be read at waiting task and updated the same to xReadKeyFOb.pvData.
      */
-    xReadKeyFOb.pvData = &xDataToSend;
+    xReadKeyFOb.pvData = &xKeyDataReply;
 
     /* Send the event to the task waiting for this event */
     xReadKeyFOb.ucCommand = ORWL_KEY_FOR_DAT;
 
     /* Send the Intel device state to supervisory/waiting task */
-    xQueueSend(xgResource.xSucBiosSendQueue, &xReadKeyFOb, portMAX_DELAY);
-    /* Receive the acknowledgment for the sent command */
-    xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucACK, portMAX_DELAY);
+    return prvIntelDefer(&xReadKeyFOb, prvKeyDataReply);
+}
+/*---------------------------------------------------------------------------*/
 
+static int32_t prvKeyDataReply( uint8_t ucAck )
+{
+    BiosSucActionWithData_t xResPack;
+
+    (void) ucAck;
     /* Populate the data payload */
     xResPack.action.cmd = RESP_READ;
     xResPack.action.dataPktTyp = ORWL_KEY_FOR_DAT;
-    /* Copy the xDataToSend(xReadKeyFOb.pvData) to response packet. */
-    memcpy(&xResPack.data[0],&xDataToSend,sizeof(xDataToSend));
+    /* Copy the xKeyDataReply(xReadKeyFOb.pvData) to response packet. */
+    memcpy(&xResPack.data[0],&xKeyDataReply,sizeof(xKeyDataReply));
     /* Two bytes to compensate for the Cmd+Pkttype */
-    prvCreateTxPacket ((uint8_t *)&xResPack, (sizeof(xDataToSend)+2));
+    prvCreateTxPacket ((uint8_t *)&xResPack, (sizeof(xKeyDataReply)+2));
 
     /* Start the transmission*/
     xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX);
@@ -810,61 +1174,159 @@ static int32_t prvKeyData( void )
 }
 /*---------------------------------------------------------------------------*/
 
-static int32_t prvTamperLog( void )
+static uint32_t prvGetLe32( const unsigned char *pucField )
 {
-    BiosSucActionWithData_t xResPack ;
-    OrwlTamperLog_t xDataToSend ;
-    int32_t lResult;
+    return (uint32_t)pucField[0] | ((uint32_t)pucField[1] << 8) |
+	    ((uint32_t)pucField[2] << 16) | ((uint32_t)pucField[3] << 24);
+}
+/*---------------------------------------------------------------------------*/
 
-    /* Variable for reading tamper history */
-    devtamperTamperHist_t *pxDevTamHist;
+static void prvPutLe32( unsigned char *pucField, uint32_t ulValue )
+{
+    pucField[0] = (unsigned char)ulValue;
+    pucField[1] = (unsigned char)(ulValue >> 8);
+    pucField[2] = (unsigned char)(ulValue >> 16);
+    pucField[3] = (unsigned char)(ulValue >> 24);
+}
+/*---------------------------------------------------------------------------*/
 
-    debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
-    memset(&xDataToSend,0,sizeof(xDataToSend));
+static int32_t prvTamperLogPage( const OrwlTamperLogQuery_t *pxQuery,
+	OrwlTamperLogPage_t *pxPage )
+{
+    devtamperLogInfo_t xInfo;
+    devtamperLogEvent_t xEvent;
+    OrwlTamperLogEvent_t *pxOut;
+    uint32_t ulFrom;
+    uint32_t ulTo;
+    uint32_t ulSeq;
+    int32_t lResult;
 
-    /* Memory allocation for variable of tamper history */
-    pxDevTamHist = pvPortMalloc(sizeof(devtamperTamperHist_t));
-    if( pxDevTamHist == NULL )
+    memset(pxPage, 0, sizeof(*pxPage));
+    lResult = lDevtamperLogGetInfo(&xInfo);
+    if(lResult != NO_ERROR)
     {
-	debugERROR_PRINT("Failed to allocate memory.\n");
-	return COMMON_ERR_NULL_PTR;
+	return lResult;
     }
+    prvPutLe32(pxPage->first, xInfo.ulFirstSeq);
 
-    /* Reading of tamper history */
-    lResult = lDevtamperReadTampHistory(pxDevTamHist);
-    if(lResult !=NO_ERROR)
+    ulFrom = prvGetLe32(pxQuery->from);
+    ulTo = prvGetLe32(pxQuery->to);
+    ulSeq = prvGetLe32(pxQuery->cursor);
+    if((pxQuery->by == TAMPER_LOG_BY_SEQ) && (ulSeq < ulFrom))
     {
-	debugERROR_PRINT("Failed to read tamper history..\n");
-	if( pxDevTamHist )
+	ulSeq = ulFrom;
+    }
+    if(ulSeq < xInfo.ulFirstSeq)
+    {
+	ulSeq = xInfo.ulFirstSeq;
+    }
+    if((pxQuery->by != TAMPER_LOG_BY_SEQ) && (pxQuery->by != TAMPER_LOG_BY_TIME))
+    {
+	ulSeq = xInfo.ulNextSeq;
+    }
+
+    while(ulSeq < xInfo.ulNextSeq)
+    {
+	if(pxQuery->by == TAMPER_LOG_BY_TIME)
 	{
-	    vPortFree(pxDevTamHist);
+	    /* Pages out of the time range are not read at all */
+	    if(lDevtamperLogFindTime(ulSeq, ulFrom, ulTo, &ulSeq) != NO_ERROR)
+	    {
+		ulSeq = xInfo.ulNextSeq;
+		break;
+	    }
 	}
-	return lResult;
+	else if(ulSeq > ulTo)
+	{
+	    break;
+	}
+
+	/* Another event matches, BIOS continues from it */
+	if(pxPage->count == TAMPER_LOG_MAX_EVENTS)
+	{
+	    pxPage->more = 1;
+	    break;
+	}
+
+	lResult = lDevtamperLogRead(ulSeq, &xEvent);
+	ulSeq++;
+	if(lResult != NO_ERROR)
+	{
+	    continue;
+	}
+	pxOut = &pxPage->event[pxPage->count++];
+	prvPutLe32(pxOut->seq, xEvent.ulSeq);
+	prvPutLe32(pxOut->time, xEvent.ulTime);
+	prvPutLe32(pxOut->cause, xEvent.ulCause);
+	pxOut->type = xEvent.ucType;
     }
+    prvPutLe32(pxPage->next, ulSeq);
 
-    /* Formatting the tamper log */
-    prvFormatLog(pxDevTamHist->xTamperEvent[0].ultamperCause,
-	    &pxDevTamHist->xTamperEvent[0].xTamperDateTime,
-	    xDataToSend.formatLog);
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvTamperLog( void )
+{
+    BiosSucActionWithData_t xResPack ;
+    OrwlTamperLog_t xDataToSend ;
+    OrwlTamperLogQuery_t xQuery ;
+    OrwlTamperLogPage_t xPage ;
+    devtamperLogEvent_t xEvent ;
+    rtcDateTime_t xDateTime ;
+    uint8_t ucDataLen ;
+    int32_t lResult;
+
+    debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
 
     /*Populate the data payload*/
     xResPack.action.cmd = RESP_READ;
     xResPack.action.dataPktTyp = ORWL_TAMPER_LOG;
-    memcpy(&xResPack.data[0],&xDataToSend,sizeof(xDataToSend));
+
+    if(xRxProcessBuff.ucLen >=
+	    (sizeof(BiosSucAction_t) + sizeof(OrwlTamperLogQuery_t)))
+    {
+	/* Query of the event log, answered page by page */
+	memcpy(&xQuery, xRxProcessBuff.xBuff.actWithData.data, sizeof(xQuery));
+	lResult = prvTamperLogPage(&xQuery, &xPage);
+	if(lResult != NO_ERROR)
+	{
+	    debugERROR_PRINT("Failed to read tamper log..\n");
+	    return lResult;
+	}
+	memcpy(&xResPack.data[0],&xPage,sizeof(xPage));
+	ucDataLen = sizeof(xPage);
+    }
+    else
+    {
+	memset(&xDataToSend,0,sizeof(xDataToSend));
+
+	/* Reading of the last tamper */
+	lResult = lDevtamperLogGetLast(devtamperEVENT_TAMPER, &xEvent);
+	if(lResult == NO_ERROR)
+	{
+	    lResult = lRtcConvertRawToDateTime(xEvent.ulTime, &xDateTime);
+	}
+	if(lResult !=NO_ERROR)
+	{
+	    debugERROR_PRINT("Failed to read tamper history..\n");
+	    return lResult;
+	}
+
+	/* Formatting the tamper log */
+	prvFormatLog(xEvent.ulCause, &xDateTime, xDataToSend.formatLog);
+	memcpy(&xResPack.data[0],&xDataToSend,sizeof(xDataToSend));
+	ucDataLen = sizeof(xDataToSend);
+    }
 
     /* Two bytes to compensate for the Cmd + Pkttype */
-    prvCreateTxPacket ((uint8_t *)&xResPack, (sizeof(xDataToSend)+2)) ;
+    prvCreateTxPacket ((uint8_t *)&xResPack, (ucDataLen+2)) ;
 
     /* Start the transmission*/
     xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX) ;
 
     debugPRINT_SUC_INTEL_COMM("Exit %s\n\r",__FUNCTION__) ;
 
-    /* Release allocated memory */
-    if( pxDevTamHist )
-    {
-	vPortFree(pxDevTamHist);
-    }
     return NO_ERROR;
 }
 /*---------------------------------------------------------------------------*/
@@ -872,62 +1334,46 @@ static int32_t prvTamperLog( void )
 static int32_t prvCheckSecLevel1( void )
 {
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
-    BiosSuc1B_t xResPack;
-    int32_t lResult = NO_ERROR;
 
-    if((lResult = prvIntelSecCommand(ORWL_SEC_CHECK_LEVEL0)) !=
-	    SUC_WRITE_STATUS_SUCCESS)
-    {
-	debugERROR_PRINT("Failed to check security  level 1\n");
-    }
-    /* Update the response packet */
-    xResPack.action.cmd = RESP_WRITE;
-    xResPack.action.dataPktTyp = ORWL_SEC_CHECK_LEVEL0;
-    xResPack.statUpdate = lResult;
+    return prvIntelSecCommand(ORWL_SEC_CHECK_LEVEL0, prvSecLevel1Reply);
+}
+/*---------------------------------------------------------------------------*/
 
-    prvCreateTxPacket((uint8_t *)&xResPack, sizeof(xResPack));
+static int32_t prvCheckSecLevel2( void )
+{
+    debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
 
-    /* Start the transmission*/
-    xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX);
+    return prvIntelSecCommand(ORWL_SEC_CHECK_LEVEL1, prvSecLevel2Reply);
+}
+/*---------------------------------------------------------------------------*/
 
-    if(lResult == SUC_WRITE_STATUS_FAIL_AUTH)
-    {
-	/* Got Auth fail response from supervisory task.
-	 * Set intelSESSION_AUTH_FAIL bit.
-	 */
-	xEventGroupSetBits(xUartTxRXSync, intelSESSION_AUTH_FAIL);
-    }
-    else if(lResult == SUC_WRITE_STATUS_FAIL_UNKOWN)
-    {
-	/* Got unknown error response from supervisory task.
-	 * Set intelSESSION_COM_FAIL bit.
-	 */
-	xEventGroupSetBits(xUartTxRXSync, intelSESSION_TX_RX_COM_FAIL);
-    }
-    debugPRINT_SUC_INTEL_COMM("Exit %s\n\r",__FUNCTION__);
-    return NO_ERROR;
+static int32_t prvSecLevel1Reply( uint8_t ucAck )
+{
+    return prvSecLevelReply(ORWL_SEC_CHECK_LEVEL0, ucAck);
 }
 /*---------------------------------------------------------------------------*/
 
-static int32_t prvCheckSecLevel2( void )
+static int32_t prvSecLevel2Reply( uint8_t ucAck )
 {
-    BiosSuc1B_t xResPack;
-    int32_t lResult = NO_ERROR;
+    return prvSecLevelReply(ORWL_SEC_CHECK_LEVEL1, ucAck);
+}
+/*---------------------------------------------------------------------------*/
 
-    debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
+static int32_t prvSecLevelReply( uint8_t ucPktType, uint8_t ucAck )
+{
+    BiosSuc1B_t xResPack;
+    int32_t lResult = ucAck;
 
-    if((lResult = prvIntelSecCommand(ORWL_SEC_CHECK_LEVEL1)) !=
-	    SUC_WRITE_STATUS_SUCCESS)
+    if(lResult != SUC_WRITE_STATUS_SUCCESS)
     {
-	debugERROR_PRINT("Failed to check security  level 1\n");
+	debugERROR_PRINT("Failed to check security level 0x%x\n", ucPktType);
     }
-
     /* Update the response packet */
-    xResPack.action.cmd = RESP_WRITE ;
-    xResPack.action.dataPktTyp = ORWL_SEC_CHECK_LEVEL1;
-    xResPack.statUpdate = lResult ;
+    xResPack.action.cmd = RESP_WRITE;
+    xResPack.action.dataPktTyp = ucPktType;
+    xResPack.statUpdate = lResult;
 
-    prvCreateTxPacket ((uint8_t *)&xResPack, sizeof(xResPack));
+    prvCreateTxPacket((uint8_t *)&xResPack, sizeof(xResPack));
 
     /* Start the transmission*/
     xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX);
@@ -946,7 +1392,6 @@ static int32_t prvCheckSecLevel2( void )
 	 */
 	xEventGroupSetBits(xUartTxRXSync, intelSESSION_TX_RX_COM_FAIL);
     }
-
     debugPRINT_SUC_INTEL_COMM("Exit %s\n\r",__FUNCTION__);
     return NO_ERROR;
 }
@@ -954,14 +1399,19 @@ static int32_t prvCheckSecLevel2( void )
 
 static int32_t prvRotRegen( void )
 {
-    BiosSuc1B_t xResPack;
-    int32_t lResult = NO_ERROR;
-
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
 
     /* Send command to supervisory task to generate SSD password*/
-    if((lResult = prvIntelSSDGenCmd(&xResPack)) !=
-	    SUC_WRITE_STATUS_SUCCESS)
+    return prvIntelSSDGenCmd(&xRotRegenData);
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvRotRegenReply( uint8_t ucAck )
+{
+    BiosSuc1B_t xResPack;
+    int32_t lResult = ucAck;
+
+    if(lResult != SUC_WRITE_STATUS_SUCCESS)
     {
 	debugERROR_PRINT("Failed to generate SSD password\n");
     }
@@ -1152,8 +1602,6 @@ static int32_t prvIntelDevStateUpdate( void )
 {
     /* Intel device state to send to waiting task */
     IntelUserData_t xIntelDevState;
-    /* ACK from supervisory/waiting task */
-    uint8_t ucACK = 0;
     BiosSuc1B_t xResPack;
     IntelSubState_t *pxDataReceived;
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
@@ -1209,9 +1657,13 @@ static int32_t prvIntelDevStateUpdate( void )
     xIntelDevState.ucCommand = INTEL_DEV_ACT;
 
     /* Send the Intel device state to supervisory/waiting task */
-    xQueueSend(xgResource.xSucBiosSendQueue, &xIntelDevState, portMAX_DELAY);
-    /* Receive the acknowledgment for the sent command */
-    xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucACK, portMAX_DELAY);
+    return prvIntelDefer(&xIntelDevState, prvIntelDevStateReply);
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvIntelDevStateReply( uint8_t ucACK )
+{
+    BiosSuc1B_t xResPack;
 
     /* Send the response write to the Intel */
     xResPack.action.cmd = RESP_WRITE ;
@@ -1238,11 +1690,8 @@ static int32_t prvIntelDevStateUpdate( void )
 
 static int32_t prvHlosStatUpdate( void )
 {
-    BiosSuc1B_t xResPack ;
     /* OS installation status update */
     IntelUserData_t xOSInstallationStatus;
-    /* ACK from waiting task */
-    uint8_t ucACK = 0;
 
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
 
@@ -1258,9 +1707,13 @@ static int32_t prvHlosStatUpdate( void )
     xOSInstallationStatus.ucCommand = INTEL_HLOS_STATUS;
 
     /* Send xOSInstallationStatus to supervisory/waiting task */
-    xQueueSend(xgResource.xSucBiosSendQueue, &xOSInstallationStatus, portMAX_DELAY);
-    /* Receive the acknowledgment for the sent command */
-    xQueueReceive(xgResource.xSucBiosReceiveQueue, &ucACK, portMAX_DELAY);
+    return prvIntelDefer(&xOSInstallationStatus, prvHlosStatReply);
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvHlosStatReply( uint8_t ucACK )
+{
+    BiosSuc1B_t xResPack ;
 
     /* Update the response packet */
     xResPack.action.cmd = RESP_WRITE;
@@ -1562,6 +2015,134 @@ static int32_t prvHandleDataError( void )
 }
 /*---------------------------------------------------------------------------*/
 
+static int32_t prvLinkVersion( void )
+{
+    BiosSucActionWithData_t xResPack ;
+    OrwlLinkVersion_t xOffer ;
+    OrwlLinkVersion_t xLink ;
+    uint16_t usMaxMsg ;
+
+    debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
+
+    memcpy(&xOffer, xRxProcessBuff.xBuff.actWithData.data, sizeof(xOffer));
+    usMaxMsg = xOffer.maxMsgLo | (xOffer.maxMsgHi << 8);
+
+    /* Take the lower of what both sides support */
+    xLink.version = (xOffer.version > UART_LINK_VERSION_2) ?
+	    UART_LINK_VERSION_2 : xOffer.version;
+    xLink.window = (xOffer.window > intelLINK_MAX_WINDOW) ?
+	    intelLINK_MAX_WINDOW : xOffer.window;
+    if(usMaxMsg > UART_V2_MAX_MESSAGE)
+    {
+	usMaxMsg = UART_V2_MAX_MESSAGE;
+    }
+
+    /* Every response must still fit, else stay on version 1 */
+    if((xLink.version != UART_LINK_VERSION_2) || (xLink.window == 0) ||
+	    (usMaxMsg < UART_MAX_DATA))
+    {
+	xLink.version = UART_LINK_VERSION_1;
+	xLink.window = 1;
+	usMaxMsg = UART_MAX_DATA;
+    }
+    xLink.maxMsgLo = (uint8_t)usMaxMsg;
+    xLink.maxMsgHi = (uint8_t)(usMaxMsg >> 8);
+
+    /* Update the response packet */
+    xResPack.action.cmd = RESP_WRITE;
+    xResPack.action.dataPktTyp = ORWL_LINK_VERSION;
+    memcpy(xResPack.data, &xLink, sizeof(xLink));
+
+    prvCreateTxPacket ((uint8_t *)&xResPack,
+	    sizeof(xResPack.action) + sizeof(xLink)) ;
+
+    /* Response itself goes out on the current version */
+    xLinkPending = xLink;
+    ucLinkSwitch = 1;
+
+    /* Start the transmission*/
+    xEventGroupSetBits(xUartTxRXSync, intelSESSION_TX) ;
+
+    debugPRINT_SUC_INTEL_COMM("Exit %s link version %d window %d\n\r",
+	    __FUNCTION__, xLink.version, xLink.window) ;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvCmdStats( void )
+{
+    BiosSucActionWithData_t xResPack;
+    OrwlCmdStatsQuery_t xQuery;
+    OrwlCmdStatsPage_t *pxPage;
+    OrwlCmdStatsEntry_t *pxEntry;
+    xIntelSucCmdStats_t *pxStats;
+    uint32_t ulPktType;
+    uint32_t ulBucket;
+    uint32_t ulHits;
+    uint8_t ucRow;
+
+    debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__);
+
+    memset(&xResPack, 0, sizeof(xResPack));
+    memset(&xQuery, 0, sizeof(xQuery));
+    if(xRxProcessBuff.ucLen >=
+	    (sizeof(BiosSucAction_t) + sizeof(OrwlCmdStatsQuery_t)))
+    {
+	memcpy(&xQuery, xRxProcessBuff.xBuff.actWithData.data, sizeof(xQuery));
+    }
+
+    /*Populate the data payload*/
+    xResPack.action.cmd = RESP_READ;
+    xResPack.action.dataPktTyp = ORWL_CMD_STATS;
+    pxPage = (OrwlCmdStatsPage_t *)&xResPack.data[0];
+
+    for(ulPktType = xQuery.first; ulPktType < intelDISPATCH_SIZE; ulPktType++)
+    {
+	ucRow = ucIntelSucDispatch[ulPktType];
+	if((ucRow == 0) || (xIntelSucStats[ucRow - 1].ulCount == 0))
+	{
+	    continue;
+	}
+	if(pxPage->count == CMD_STATS_MAX_ENTRIES)
+	{
+	    pxPage->more = 1;
+	    pxPage->next = ulPktType;
+	    break;
+	}
+	pxStats = &xIntelSucStats[ucRow - 1];
+	pxEntry = &pxPage->entry[pxPage->count++];
+	pxEntry->pktType = ulPktType;
+	prvPutLe32(pxEntry->count, pxStats->ulCount);
+	prvPutLe32(pxEntry->errors, pxStats->ulErrors);
+	prvPutLe32(pxEntry->maxUs, pxStats->ulMaxUs);
+	for(ulBucket = 0; ulBucket < CMD_STATS_HIST_BUCKETS; ulBucket++)
+	{
+	    ulHits = pxStats->ulHist[ulBucket];
+	    if(ulHits > 0xFFFF)
+	    {
+		ulHits = 0xFFFF;
+	    }
+	    pxEntry->hist[ulBucket][0] = ulHits & 0xFF;
+	    pxEntry->hist[ulBucket][1] = ulHits >> 8;
+	}
+    }
+
+    if((xQuery.clear == 1) && (pxPage->more == 0))
+    {
+	memset(xIntelSucStats, 0, sizeof(xIntelSucStats));
+    }
+
+    /* Two bytes to compensate for the Cmd + Pkttype */
+    prvCreateTxPacket ((uint8_t *)&xResPack, (sizeof(OrwlCmdStatsPage_t)+2)) ;
+
+    /* Start the transmission*/
+    xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX) ;
+
+    debugPRINT_SUC_INTEL_COMM("Exit %s\n\r",__FUNCTION__) ;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
 static void prvFormatLog(uint32_t ulTamperCause, rtcDateTime_t* pxRtcDateTime,
 			uint8_t* pucString)
 {
@@ -1613,7 +2194,6 @@ static int32_t prvInitUartPort( void )
 
     /* Initialize the buffer. */
     memset(&xBuffer, 0 ,sizeof(xBuffer)) ;
-    xBuffer.usByteFree = intelSUC_BUFF_RX_SIZE ;
     xRxProcessBuff.eState = eINIT_STATE ;
 
     /* Let us initialize the UART1 for Receiving the data */
@@ -1687,17 +2267,22 @@ void vProcessRxInterrupt( void )
     register uint32_t ulSr;
     volatile mml_uart_regs_t *pxReg_uart = (volatile mml_uart_regs_t*)MML_UART1_IOBASE;
     volatile uint8_t ucChar ;
+    uint16_t usNext;
     do
     {
 	ucChar = pxReg_uart->dr ;
 
-	xBuffer.ucBuff[xBuffer.usInPtr++] = ucChar ;
-
-	if(xBuffer.usInPtr == intelSUC_BUFF_RX_SIZE)
+	usNext = xBuffer.usInPtr + 1;
+	if(usNext == intelSUC_BUFF_RX_SIZE)
 	{
-	    xBuffer.usInPtr = 0 ;
+	    usNext = 0 ;
+	}
+	/* Buffer full, byte is dropped and packet checksum fails */
+	if(usNext != xBuffer.usOutPtr)
+	{
+	    xBuffer.ucBuff[xBuffer.usInPtr] = ucChar ;
+	    xBuffer.usInPtr = usNext ;
 	}
-	xBuffer.usByteFree-- ;
 
 	ulSr = pxReg_uart->sr ;
 
@@ -1709,6 +2294,8 @@ static void prvIntelSucUartIsr( void )
 {
     register uint32_t ulIsr;
     volatile mml_uart_regs_t *pxRegUart = (volatile mml_uart_regs_t*)MML_UART1_IOBASE;
+    uint32_t ulNotify = 0;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
     /* Read the interrupt status register */
     ulIsr = pxRegUart->isr ;
@@ -1721,12 +2308,25 @@ static void prvIntelSucUartIsr( void )
 
 	/* Check this is in data packet stage or header */
 	xBuffer.usInPtr = xBuffer.usOutPtr ;
-	xBuffer.usByteFree = intelSUC_BUFF_RX_SIZE ;
+	ulNotify |= intelNOTIFY_RX;
     }
     /* Check if there is some data received */
     else if (ulIsr & MML_UART_ISR_FFRXIS_MASK)
     {
 	vProcessRxInterrupt() ;
+	ulNotify |= intelNOTIFY_RX;
+    }
+
+    /* Tx FIFO has room, feed the rest of frame */
+    if ((ulIsr & MML_UART_ISR_FFTXHIS_MASK) &&
+	    (pxRegUart->ier & MML_UART_IER_FFTXHIE_MASK))
+    {
+	if (prvIntelSucTxFill() == pdTRUE)
+	{
+	    /* Whole frame is in FIFO, no more tx interrupts */
+	    pxRegUart->ier &= ~MML_UART_IER_FFTXHIE_MASK;
+	    ulNotify |= intelNOTIFY_TX_DONE;
+	}
     }
 
     /*Lets clear the interrupt at UART level and then at UART peripheral level*/
@@ -1735,6 +2335,282 @@ static void prvIntelSucUartIsr( void )
 
     /** Acknowledge interrupt at platform level */
     mml_uart_interrupt_ack(MML_UART_DEV1);
+
+    /* Wake the IntelSuC task, data received before it is created is
+     * processed when it starts.
+     */
+    if ((ulNotify != 0) && (xIntelSucTask != NULL))
+    {
+	xTaskNotifyFromISR(xIntelSucTask, ulNotify, eSetBits,
+		&xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvIntelSucTxFill( void )
+{
+    volatile mml_uart_regs_t *pxRegUart = (volatile mml_uart_regs_t*)MML_UART1_IOBASE;
+
+    /* Tx FIFO Is not full */
+    while ((usTxLeft != 0) &&
+	    ((pxRegUart->sr & MML_UART_SR_TXFULL_MASK) != MML_UART_SR_TXFULL_MASK))
+    {
+	pxRegUart->dr = *pucTxNext ;
+#ifdef ORWL_HOST_SIM
+	/* Data register writes are not observable in the simulation */
+	vSimUartTxPut(MML_UART_DEV1, *pucTxNext);
+#endif
+	pucTxNext++ ;
+	usTxLeft-- ;
+    }
+    return (usTxLeft == 0) ? pdTRUE : pdFALSE;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvIntelSucUartSend( const uint8_t *pucMsg, uint16_t usLen )
+{
+    volatile mml_uart_regs_t *pxRegUart = (volatile mml_uart_regs_t*)MML_UART1_IOBASE;
+    /* Wire time of the data and margin */
+    TickType_t xTicks = pdMS_TO_TICKS(((uint32_t) usLen *
+	    intelUART_BITS_PER_CHAR * 1000) / K_LITE_UART0_DEFAULT_BAUDRATE +
+	    intelTX_TIMEOUT_MARGIN_MS);
+
+    if (usLen == 0)
+    {
+	return NO_ERROR;
+    }
+
+    /* Stale completion from an earlier frame must not end this one */
+    ulNotifyPending &= ~intelNOTIFY_TX_DONE;
+    pucTxNext = pucMsg;
+    usTxLeft = usLen;
+
+    /* ISR feeds the FIFO from here on, it turns the interrupt off at end */
+    taskENTER_CRITICAL();
+    mml_uart_interrupt_clear(MML_UART_DEV1, MML_UART_ISR_FFTXHIS_MASK);
+    pxRegUart->ier |= MML_UART_IER_FFTXHIE_MASK;
+    taskEXIT_CRITICAL();
+#ifdef ORWL_HOST_SIM
+    /* Simulated tx FIFO is always empty, raise the interrupt once */
+    vSimUartTxKick(MML_UART_DEV1);
+#endif
+
+    if (prvIntelSucWait(intelNOTIFY_TX_DONE, xTicks) == 0)
+    {
+	/* Take the frame back from ISR */
+	taskENTER_CRITICAL();
+	pxRegUart->ier &= ~MML_UART_IER_FFTXHIE_MASK;
+	usTxLeft = 0;
+	taskEXIT_CRITICAL();
+	debugERROR_PRINT("Intel UART transmit timed out\n");
+	return intelSEND_TIMEOUT;
+    }
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static uint32_t prvIntelSucWait( uint32_t ulBits, TickType_t xTicks )
+{
+    uint32_t ulNotify = 0;
+    TimeOut_t xTimeOut;
+
+    vTaskSetTimeOutState(&xTimeOut);
+    while ((ulNotifyPending & ulBits) == 0)
+    {
+	if (xTaskNotifyWait(0, intelNOTIFY_ALL, &ulNotify, xTicks) == pdTRUE)
+	{
+	    ulNotifyPending |= ulNotify;
+	}
+	/* Wake up for other bits does not restart the wait */
+	if (xTaskCheckForTimeOut(&xTimeOut, &xTicks) == pdTRUE)
+	{
+	    break;
+	}
+    }
+    ulNotify = ulNotifyPending & ulBits;
+    ulNotifyPending &= ~ulBits;
+    return ulNotify;
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvIntelSucRxPending( void )
+{
+    return (xBuffer.usInPtr != xBuffer.usOutPtr) ? pdTRUE : pdFALSE;
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvIntelSucHasWork( void )
+{
+    if(prvIntelSucRxPending() == pdTRUE)
+    {
+	return pdTRUE;
+    }
+    return ((ucIntelLinkRxBacklog() != 0) &&
+	    (xIntelSucDeferred.pfnDone == NULL)) ? pdTRUE : pdFALSE;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvIntelDispatchPacket( void )
+{
+    uint8_t ucPktType = xRxProcessBuff.xBuff.action.dataPktTyp;
+    tpfnCommand pfnCommand;
+    uint8_t ucRow = 0;
+    int32_t lResult;
+
+    if(ucPktType < intelDISPATCH_SIZE)
+    {
+	ucRow = ucIntelSucDispatch[ucPktType];
+    }
+    /* There might be case where BIOS can send some command
+     * which are not yet supported from SUC. In that case
+     * handle this error case to avoid SUC hanging.
+     */
+    if(ucRow == 0)
+    {
+	/* Send invalid command event */
+	xEventGroupSetBits(xUartTxRXSync, intelSESSION_INVALID_COMMAND);
+	/* We don't want to proceed further in this case
+	 * return the context.
+	 */
+	return;
+    }
+    ucRow--;
+    debugPRINT_SUC_INTEL_COMM(" Received Pkt type 0x%x\n\r", ucPktType) ;
+
+    /* We received right data. Let us process the command*/
+    if(xRxProcessBuff.xBuff.action.cmd == CMD_READ)
+    {
+	pfnCommand = xIntelSucLookUpAction[ucRow].cmd_read;
+    }
+    else
+    {
+	pfnCommand = xIntelSucLookUpAction[ucRow].cmd_write;
+    }
+    if(pfnCommand == NULL)
+    {
+	debugPRINT_SUC_INTEL_COMM(
+		" No %s functionality defined for packet type 0x%x\n\r",
+		(xRxProcessBuff.xBuff.action.cmd == CMD_READ) ?
+			"Read" : "Write", ucPktType);
+	return;
+    }
+
+    debugPRINT_SUC_INTEL_COMM(" Processing %s of packet type 0x%x\n\r",
+	    (xRxProcessBuff.xBuff.action.cmd == CMD_READ) ? "Read" : "Write",
+	    ucPktType);
+    xIntelSucDeferred.ucRow = ucRow;
+    xIntelSucDeferred.ulStart = ulTimerTimestamp();
+    lResult = pfnCommand();
+    if(lResult == intelCMD_DEFERRED)
+    {
+	/* Response is sent from prvIntelDeferPoll */
+	return;
+    }
+    prvIntelStatsRecord(ucRow, xIntelSucDeferred.ulStart,
+	    (lResult != NO_ERROR) ? pdTRUE : pdFALSE);
+    if(lResult != NO_ERROR)
+    {
+	prvShutdownAndDisplayMessage(
+		(int8_t *)"Intel SuC Com   "
+			"Failed Reboot...");
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvIntelLinkDeliver( void )
+{
+    const uint8_t *pucMsg;
+    uint16_t usMsgLen;
+
+    if((ucIntelLinkRxBacklog() == 0) ||
+	    (xIntelSucDeferred.pfnDone != NULL) ||
+	    (xEventGroupGetBits(xUartTxRXSync) & intelSESSION_TX))
+    {
+	return pdFALSE;
+    }
+    if(lIntelLinkRxDeliver() != intelLINK_RX_MESSAGE)
+    {
+	return pdFALSE;
+    }
+
+    pucMsg = pucIntelLinkRxMessage(&usMsgLen);
+    if(usMsgLen > sizeof(xRxProcessBuff.xBuff))
+    {
+	/* No command takes more than one version 1 packet */
+	debugERROR_PRINT("Link message of %d bytes dropped\n", usMsgLen);
+	return pdFALSE;
+    }
+    memcpy(xRxProcessBuff.xBuff.ucRawData, pucMsg, usMsgLen);
+    xRxProcessBuff.ucLen = (uint8_t)usMsgLen;
+    prvIntelDispatchPacket();
+
+    return pdTRUE;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvIntelSucSendLinkV2( void )
+{
+    uint16_t usLen;
+
+    if(lIntelLinkTxStart(xTxBuffer.xBuff.ucRawData, xTxBuffer.ucLen)
+	    != NO_ERROR)
+    {
+	xEventGroupSetBits(xUartTxRXSync, intelSESSION_TX_FAIL);
+	return;
+    }
+
+    while(lIntelLinkTxStatus() == intelLINK_TX_BUSY)
+    {
+	/* Fill the window, resent frames first */
+	while((usLen = usIntelLinkTxNext(ucTxFrame)) != 0)
+	{
+	    if(prvIntelSucUartSend(ucTxFrame, usLen) != NO_ERROR)
+	    {
+		debugERROR_PRINT("Failed to transmit frame\n");
+	    }
+	}
+	if(lIntelLinkTxStatus() != intelLINK_TX_BUSY)
+	{
+	    break;
+	}
+
+	/* Acks are parsed from received data; silence means loss */
+	if((prvIntelSucRxPending() != pdTRUE) &&
+		(prvIntelSucWait(intelNOTIFY_RX,
+			pdMS_TO_TICKS(intelLINK_ACK_TIMEOUT_MS)) == 0))
+	{
+	    debugPRINT_SUC_INTEL_COMM("Link ack timeout, resending\n\r");
+	    vIntelLinkTxTimeout();
+	    continue;
+	}
+	vIntelProcessRxPacket();
+    }
+
+    if(lIntelLinkTxStatus() == intelLINK_TX_DONE)
+    {
+	xEventGroupSetBits(xUartTxRXSync, intelSESSION_TX_SUCCESS);
+	prvIntelLinkSwitch();
+    }
+    else
+    {
+	ucLinkSwitch = 0;
+	xEventGroupSetBits(xUartTxRXSync, intelSESSION_TX_FAIL);
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvIntelLinkSwitch( void )
+{
+    if(ucLinkSwitch == 0)
+    {
+	return;
+    }
+    ucLinkSwitch = 0;
+    vIntelLinkReset(xLinkPending.version, xLinkPending.window,
+	    xLinkPending.maxMsgLo | (xLinkPending.maxMsgHi << 8));
+    debugPRINT_SUC_INTEL_COMM("Link version %d in use\n\r",
+	    xLinkPending.version);
 }
 /*---------------------------------------------------------------------------*/
 
@@ -1768,29 +2644,15 @@ int32_t lIntelSendPacket(uint8_t *pucMsg, uint8_t *pucLen, TickType_t * pxTimeou
 
 uint8_t ucIntelTxUartData (uint8_t *pucMsg, uint8_t ucLen)
 {
-
-    uint8_t ucTxLen = 0;
-    volatile mml_uart_regs_t *xReg_uart = (volatile mml_uart_regs_t*)MML_UART1_IOBASE;
-
     debugPRINT_SUC_INTEL_COMM("Entry %s\n\r",__FUNCTION__) ;
 
-    do
+    if (prvIntelSucUartSend(pucMsg, ucLen) != NO_ERROR)
     {
-	xReg_uart->dr = pucMsg[ucTxLen] ;
-
-	debugPRINT_SUC_INTEL_COMM("TxData - 0x%x\n\r",pucMsg[ucTxLen]) ;
-	ucTxLen++ ;
-
-	if(ucTxLen == ucLen)
-	{
-	    break ;
-	}
-
-    /* Tx FIFO Is not full */
-    }while((xReg_uart->sr & MML_UART_SR_TXFULL_MASK) != MML_UART_SR_TXFULL_MASK);
+	return 0 ;
+    }
     debugPRINT_SUC_INTEL_COMM("Exit %s\n\r",__FUNCTION__) ;
 
-    return ucTxLen ;
+    return ucLen ;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -1799,27 +2661,39 @@ void vIntelProcessRxPacket( void )
     uint8_t ucTxLen;
     uint8_t ucIndex;
     uint8_t ucChecksum;
-    uint8_t ucSizeToRead;
+    uint16_t usSizeToRead;
+    uint16_t usInPtr;
+    uint16_t usAckLen;
+    int32_t lLinkStatus;
     uint8_t ucTemp ;
 
     EventBits_t xTempSetBit ;
 
-    if(xBuffer.usInPtr == xBuffer.usOutPtr)
+    /* Commands received on link version 2 while a response was pending */
+    if(prvIntelLinkDeliver() == pdTRUE)
+    {
+	return;
+    }
+
+    /* ISR moves only the in pointer, take one snapshot of it */
+    usInPtr = xBuffer.usInPtr;
+    if(usInPtr == xBuffer.usOutPtr)
     {
 	/* Indicates that there is no received data */
 	return;
     }
     else
     {
-	debugPRINT_SUC_INTEL_COMM(
-		" vProcessRxPacket Entry free buffer size %d \n\r",
-		xBuffer.usByteFree);
 	/**
 	 * Received some data.
 	 * let us see whether we have right data.
 	 */
-	ucSizeToRead = intelSUC_BUFF_RX_SIZE - xBuffer.usByteFree;
-	if(ucSizeToRead)
+	usSizeToRead = (usInPtr + intelSUC_BUFF_RX_SIZE - xBuffer.usOutPtr)
+		% intelSUC_BUFF_RX_SIZE;
+	debugPRINT_SUC_INTEL_COMM(
+		" vProcessRxPacket Entry received size %d \n\r",
+		usSizeToRead);
+	if(usSizeToRead)
 	{
 	    /**
 	     * We have received some data and let us see whether it makes
@@ -1827,14 +2701,17 @@ void vIntelProcessRxPacket( void )
 	     */
 	    do
 	    {
-		ucTemp = xBuffer.ucBuff[xBuffer.usOutPtr++];
+		ucTemp = xBuffer.ucBuff[xBuffer.usOutPtr];
 		debugPRINT_SUC_INTEL_COMM(" Received buffer data 0x%2x \n\r"
 			,ucTemp);
-		if (xBuffer.usOutPtr == intelSUC_BUFF_RX_SIZE)
+		if ((xBuffer.usOutPtr + 1) == intelSUC_BUFF_RX_SIZE)
 		{
 		    xBuffer.usOutPtr = 0 ;
 		}
-		xBuffer.usByteFree++ ;
+		else
+		{
+		    xBuffer.usOutPtr++ ;
+		}
 		switch(xRxProcessBuff.eState)
 		{
 		case eINIT_STATE:
@@ -1852,10 +2729,33 @@ void vIntelProcessRxPacket( void )
 		    break ;
 
 		case ePACKET_TYPE_STATE:
-		    if (ucTemp == UART_TYP_ENC ||ucTemp ==UART_TYP_ENC_NO )
+		    if ((ucTemp == UART_TYP_ENC ||ucTemp ==UART_TYP_ENC_NO ) &&
+			    (xIntelSucDeferred.pfnDone != NULL))
+		    {
+			/* Receive buffer holds the deferred command, BIOS
+			 * sends again without an ACK */
+			debugPRINT_SUC_INTEL_COMM(
+				" Packet dropped, reply pending\n\r") ;
+			xRxProcessBuff.eState = eINIT_STATE;
+		    }
+		    else if (ucTemp == UART_TYP_ENC ||ucTemp ==UART_TYP_ENC_NO )
 		    {
 			xRxProcessBuff.eState = eLENGTH_STATE;
 		    }
+		    else if (ucTemp == UART_TYP_DATA_V2 ||
+			    ucTemp == UART_TYP_ACK_V2)
+		    {
+			if (ucIntelLinkVersion() == UART_LINK_VERSION_2)
+			{
+			    vIntelLinkRxStart(ucTemp);
+			    xRxProcessBuff.eState = eLINK_V2_STATE;
+			}
+			else
+			{
+			    /* Not negotiated, resync on next frame */
+			    xRxProcessBuff.eState = eINIT_STATE;
+			}
+		    }
 		    else
 		     {
 			/* Received ACK/NACK Packet */
@@ -1881,6 +2781,28 @@ void vIntelProcessRxPacket( void )
 			    "information for 0x%x\n\r",xTempSetBit);
 		    break ;
 
+		case eLINK_V2_STATE:
+		    lLinkStatus = lIntelLinkRxByte(ucTemp);
+		    if (lLinkStatus == intelLINK_RX_MORE)
+		    {
+			break;
+		    }
+		    xRxProcessBuff.eState = eINIT_STATE ;
+		    if (lLinkStatus == intelLINK_RX_DATA)
+		    {
+			/* Ack before running the command, it may wait for
+			 * the user */
+			usAckLen = usIntelLinkBuildAck(ucLinkAck);
+			if (prvIntelSucUartSend(ucLinkAck, usAckLen) != NO_ERROR)
+			{
+			    debugPRINT_SUC_INTEL_COMM(
+				    " Couldn't transmit link ack\n\r") ;
+			}
+			(void) prvIntelLinkDeliver();
+		    }
+		    /* One frame per call, as for version 1 packets */
+		    return ;
+
 		case eLENGTH_STATE:
 		    xRxProcessBuff.ucLen = ucTemp ;
 		    xRxProcessBuff.eState = eCHECKSUM_STATE ;
@@ -1946,81 +2868,16 @@ void vIntelProcessRxPacket( void )
 
 			if(ucChecksum == xRxProcessBuff.ucChksum)
 			{
-			    for(ucIndex=0 ; ucIndex<(sizeof(xIntelSucLookUpAction)
-				    /sizeof(xIntelSucCommHandling));ucIndex++)
-			    {
-				if(xRxProcessBuff.xBuff.action.dataPktTyp ==
-					xIntelSucLookUpAction[ucIndex].ucPktType )
-				    break ;
-			    }
-			    /* There might be case where BIOS can send some command
-			     * which are not yet supported from SUC. In that case
-			     * handle this error case to avoid SUC hanging.
-			     */
-			    if(ucIndex >= (sizeof(xIntelSucLookUpAction)
-					    / sizeof(xIntelSucCommHandling)))
-			    {
-				/* Send invalid command event */
-				xEventGroupSetBits(xUartTxRXSync, intelSESSION_INVALID_COMMAND);
-				/* We don't want to proceed further in this case
-				 * return the context.
-				 */
-				return;
-			    }
-			    debugPRINT_SUC_INTEL_COMM(" Received Pkt type 0x%x\n\r",
-				    xRxProcessBuff.xBuff.action.dataPktTyp) ;
-
-			    /* We received right data. Let us process the command*/
-			    if(xRxProcessBuff.xBuff.action.cmd == CMD_READ)
+			    if(ucIntelLinkVersion() != UART_LINK_VERSION_1)
 			    {
-				if (xIntelSucLookUpAction[ucIndex].cmd_read
-					!= NULL)
-				{
-				    debugPRINT_SUC_INTEL_COMM(
-					    " Processing Read of packet type "
-					    "0x%x\n\r",
-					    xRxProcessBuff.xBuff.action.dataPktTyp);
-				    if( xIntelSucLookUpAction[ucIndex].cmd_read()
-					    != NO_ERROR )
-				    {
-					prvShutdownAndDisplayMessage(
-						(int8_t *)"Intel SuC Com   "
-							"Failed Reboot...");
-				    }
-
-				}
-				else
-				{
-				    debugPRINT_SUC_INTEL_COMM(
-					    " No Read functionality defined"
-					    "for packet type 0x%x\n\r",xRxProcessBuff.
-					    xBuff.action.dataPktTyp);
-				}
-			    }
-			    else
-			    {
-				if (xIntelSucLookUpAction[ucIndex].cmd_write != NULL)
-				{
-				    debugPRINT_SUC_INTEL_COMM(
-					    " Processing Write of packet type"
-					    "  0x%x\n\r",
-					    xRxProcessBuff.xBuff.action.dataPktTyp);
-				    if(xIntelSucLookUpAction[ucIndex].cmd_write() !=
-					    NO_ERROR)
-				    {
-					prvShutdownAndDisplayMessage(
-						(int8_t *)"Intel SuC Com   "
-							"Failed Reboot...");
-				    }
-				}
-				else
-				{
-				    debugPRINT_SUC_INTEL_COMM(
-					    " No Write functionality defined"
-					    " for packet type  0x%x\n\r",
-					    xRxProcessBuff.xBuff.action.dataPktTyp) ;
-				}
+				/* Only a restarted BIOS talks version 1 now */
+				debugPRINT_SUC_INTEL_COMM(
+					" Version 1 packet, link back to "
+					"version 1\n\r") ;
+				vIntelLinkReset(UART_LINK_VERSION_1, 1,
+					UART_MAX_DATA);
 			    }
+			    prvIntelDispatchPacket();
 			}
 
 			/*
@@ -2040,10 +2897,10 @@ void vIntelProcessRxPacket( void )
 		    break ;
 
 		}
-		ucSizeToRead-- ;
+		usSizeToRead-- ;
 
 	    /* Indicates that we have completed all the bytes to be read */
-	    }while(ucSizeToRead);
+	    }while(usSizeToRead);
 	}
 
     }
@@ -2055,59 +2912,63 @@ void vUartTxRx( void )
 {
     EventBits_t xRetBits;
     EventBits_t xRetBitsTx ;
-    uint32_t ulTxLen,ulTotTxLen ,ulRetryCount;
-    /* Block for 5ms. */
-    const TickType_t xDelay = intelDELAY_MS / portTICK_PERIOD_MS;
+    uint32_t ulRetryCount;
+    const EventBits_t xSessionBits = ( intelSESSION_TX |
+	    intelSESSION_TX_RX_COM_FAIL | intelSESSION_AUTH_FAIL |
+	    intelSESSION_INVALID_COMMAND );
     ulRetryCount = 0 ;
 
     debugPRINT_SUC_INTEL_COMM(" In UART Rx TX Task\n\r") ;
 
     while(1)
     {
-	/* Wait for the events that need to be set for activity to be performed.*/
-	xRetBits = xEventGroupWaitBits(xUartTxRXSync,
-		( intelSESSION_TX | intelSESSION_TX_RX_COM_FAIL |
-		  intelSESSION_AUTH_FAIL | intelSESSION_INVALID_COMMAND), /* const EventBits_t uxBitsToWaitFor */
-		    pdTRUE,		/* const BaseType_t xClearOnExit */
-			pdFALSE ,	/*const BaseType_t xWaitForAllBits */
-			    0 );	/* Return immediately */
+	/* Reply of the user mode app to a deferred command queues the
+	 * response */
+	(void) prvIntelDeferPoll();
 
+	/* Sleep till UART ISR reports data, unless there is work left from
+	 * last round. Only this task sets the session bits. A deferred command
+	 * is checked for its reply on every intelDEFER_POLL_MS.
+	 */
+	if((prvIntelSucHasWork() != pdTRUE) &&
+		((xEventGroupGetBits(xUartTxRXSync) & xSessionBits) == 0))
+	{
+	    (void) prvIntelSucWait(intelNOTIFY_RX,
+		    (xIntelSucDeferred.pfnDone != NULL) ?
+			    pdMS_TO_TICKS(intelDEFER_POLL_MS) : portMAX_DELAY);
+	}
 
+	/* Command handlers queue the response by setting intelSESSION_TX */
 	vIntelProcessRxPacket();
 
-	if(xRetBits & intelSESSION_TX)
+	xRetBits = xEventGroupClearBits(xUartTxRXSync, xSessionBits);
+
+	if((xRetBits & intelSESSION_TX) &&
+		(ucIntelLinkVersion() == UART_LINK_VERSION_2))
+	{
+	    prvIntelSucSendLinkV2();
+	}
+	else if(xRetBits & intelSESSION_TX)
 	{
 	    debugPRINT_SUC_INTEL_COMM(" Received Transmit Session\n\r") ;
-	    ulTotTxLen = 0 ;
 	    ucPreAmble[3] = xTxBuffer.ucLen ;
 	    ucPreAmble[4] = xTxBuffer.ucChksum;
-	    ulTotTxLen = 0 ;
 
-	    /* Lets Transmit ucPreAmble*/
-	    do
-	    {
-		ulTxLen = ucIntelTxUartData((uint8_t *)&ucPreAmble[ulTotTxLen], sizeof( ucPreAmble ) - ulTotTxLen);
-		ulTotTxLen = ulTotTxLen + ulTxLen ;
-		vTaskDelay(xDelay) ;
-	    }while (ulTotTxLen != sizeof(ucPreAmble));
-
-	    ulTotTxLen = 0 ;
-	    do
-	    {
-		ulTxLen = ucIntelTxUartData(&xTxBuffer.xBuff.ucRawData[ulTotTxLen],
+	    /* Pre amble and payload go out as one frame */
+	    memcpy(ucTxFrame, ucPreAmble, sizeof(ucPreAmble));
+	    memcpy(&ucTxFrame[sizeof(ucPreAmble)], xTxBuffer.xBuff.ucRawData,
 		    xTxBuffer.ucLen);
-		ulTotTxLen = ulTotTxLen + ulTxLen ;
-		vTaskDelay(xDelay) ;
-	    }while (ulTotTxLen != xTxBuffer.ucLen) ;
+	    if(prvIntelSucUartSend(ucTxFrame,
+		    sizeof(ucPreAmble) + xTxBuffer.ucLen) != NO_ERROR)
+	    {
+		debugERROR_PRINT("Failed to transmit packet\n");
+	    }
 
 	    do
 	    {
 		/* Wait for the ACK/NACK Packet */
-		xRetBitsTx = xEventGroupWaitBits(xUartTxRXSync,
-			( intelSESSION_RX_NACK | intelSESSION_RX_ACK) /* const EventBits_t uxBitsToWaitFor */,
-			    pdTRUE 		/* const BaseType_t xClearOnExit */,
-				pdFALSE		/* const BaseType_t xWaitForAllBits */,
-				    0 );
+		xRetBitsTx = xEventGroupClearBits(xUartTxRXSync,
+			( intelSESSION_RX_NACK | intelSESSION_RX_ACK));
 		debugPRINT_SUC_INTEL_COMM("Waiting for ACK/NACK Packet 0x%x\n\r",xRetBitsTx);
 
 		if ((xRetBitsTx & intelSESSION_RX_ACK))
@@ -2115,6 +2976,7 @@ void vUartTxRx( void )
 		    /* Recieved ACK. So we are success*/
 		    xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX_SUCCESS);
 		    ulRetryCount = 0 ;
+		    prvIntelLinkSwitch();
 		    debugPRINT_SUC_INTEL_COMM(
 			    "Received ACK. Success in transmission \n\r");
 
@@ -2136,6 +2998,7 @@ void vUartTxRx( void )
 		    else
 		    {
 			ulRetryCount = 0 ;
+			ucLinkSwitch = 0 ;
 			xEventGroupSetBits(xUartTxRXSync,intelSESSION_TX_FAIL) ;
 			debugPRINT_SUC_INTEL_COMM(
 				"Received NACK. After %d try, fail to transmit\n\r",
@@ -2143,7 +3006,11 @@ void vUartTxRx( void )
 			break ;
 		    }
 		}
-		vTaskDelay(xDelay) ;
+		/* Block till next data from host, ACK/NACK is parsed from it */
+		if(prvIntelSucRxPending() != pdTRUE)
+		{
+		    (void) prvIntelSucWait(intelNOTIFY_RX, portMAX_DELAY);
+		}
 		vIntelProcessRxPacket();
 	    }while(1) ; /* Do for the reception of ACK/NACK packet */
 	}
@@ -2164,8 +3031,6 @@ void vUartTxRx( void )
 	    prvShutdownAndDisplayMessage(
 		    (int8_t *)"Invalid command received Reboot...");
 	}
-	/* Let us sleep for the scheduler to spawn */
-	vTaskDelay(xDelay) ;
     }
 }
 /*---------------------------------------------------------------------------*/
@@ -2183,7 +3048,22 @@ int32_t lIntelSucComInit( void )
     xAckNackPkt.sof[1] = 0xDF ;
     xAckNackPkt.typ = UART_TYP_ACK_NACK ;
     TaskHandle_t xTempHandle;
-    lSizxIntelSucLookUpAction = sizeof(xIntelSucLookUpAction)/sizeof(xIntelSucCommHandling);
+    uint8_t ucRow;
+
+    /* Payload type indexes the lookup table directly */
+    for(ucRow = 0; ucRow < intelLOOKUP_ROWS; ucRow++)
+    {
+	configASSERT(xIntelSucLookUpAction[ucRow].ucPktType <
+		intelDISPATCH_SIZE);
+	ucIntelSucDispatch[xIntelSucLookUpAction[ucRow].ucPktType] = ucRow + 1;
+    }
+
+    /* Command latency is measured on the timestamp timer */
+    lResult = lTimerTimestampInit();
+    if ( lResult!= NO_ERROR )
+    {
+	return lResult ;
+    }
 
     /* Initialize the data link layer of IntelSuC Communication. i.e. UART */
     lResult = prvInitUartPort();
@@ -2212,6 +3092,8 @@ int32_t lIntelSucComInit( void )
 	    while ( 1 )
 		    ;
     }
+    /* UART ISR can wake the task from now on */
+    xIntelSucTask = xTempHandle;
 
     debugPRINT_SUC_INTEL_COMM(" Task Created Successfully\n\r") ;
 
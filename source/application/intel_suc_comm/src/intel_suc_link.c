@@ -0,0 +1,548 @@
+ /**===========================================================================
+ * @file intel_suc_link.c
+ *
+ * @brief This file contains link version 2 of the Intel SuC UART protocol.
+ *  * Frames carry a sequence number and CRC-16, up to a window of them may be
+ *  * outstanding, lost frames are resent selectively and messages longer than
+ *  * one frame are cut and reassembled. It holds no OS objects; the IntelSuC
+ *  * task drives it from its receive and transmit paths.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <stdint.h>
+#include <string.h>
+
+/* Local includes */
+#include <errors.h>
+#include <printf_lite.h>
+#include <debug.h>
+#include <Intel_SuC_Comm.h>
+#include <intel_suc_link.h>
+
+/* States of an outgoing frame */
+#define linkFRAME_UNSENT		(0)  /**< not put on the wire yet */
+#define linkFRAME_SENT			(1)  /**< waiting for acknowledgement */
+#define linkFRAME_ACKED			(2)  /**< acknowledged by BIOS */
+
+/** Header bytes received after typ - seq, flags, len */
+#define linkDATA_HDR			(3)
+/** Header bytes received after typ - ack, sack */
+#define linkACK_HDR			(2)
+
+/**
+ * @brief Out of order receive slot.
+ */
+typedef struct
+{
+    uint8_t ucPresent;			/**< slot holds a frame */
+    uint8_t ucSeq;			/**< sequence number of the frame */
+    uint8_t ucFlags;			/**< UART_V2_FLAG_xxx of the frame */
+    uint8_t ucLen;			/**< length of data */
+    uint8_t ucData[UART_MAX_DATA];	/**< data of the frame */
+} linkRxSlot_t;
+
+/**
+ * @brief Transmit state of one frame of the outgoing message.
+ */
+typedef struct
+{
+    uint8_t ucState;			/**< linkFRAME_xxx */
+    uint8_t ucResend;			/**< frame is to be sent again */
+    uint8_t ucRetry;			/**< retransmissions so far */
+    uint32_t ulStamp;			/**< send order of last transmission */
+} linkTxFrame_t;
+
+/** link version in use */
+static uint8_t ucLinkVersion = UART_LINK_VERSION_1;
+/** negotiated window */
+static uint8_t ucLinkWindow = 1;
+/** negotiated maximum message length */
+static uint16_t usLinkMaxMsg = UART_MAX_DATA;
+
+/** frame being parsed - typ, header, data and crc */
+static uint8_t ucRxFrame[1 + linkDATA_HDR + UART_MAX_DATA + UART_V2_CRC_SIZE];
+/** bytes of ucRxFrame received */
+static uint16_t usRxPos;
+/** header length of frame being parsed */
+static uint8_t ucRxHdr;
+/** out of order receive slots, indexed by sequence modulo slot count */
+static linkRxSlot_t xRxSlot[intelLINK_MAX_WINDOW];
+/** next sequence expected in order, everything before is acknowledged */
+static uint8_t ucRxExpected;
+/** next sequence to move into the message, trails ucRxExpected */
+static uint8_t ucRxDeliver;
+/** message being reassembled */
+static uint8_t ucRxMsg[UART_V2_MAX_MESSAGE];
+/** length of message being reassembled */
+static uint16_t usRxMsgLen;
+/** message in ucRxMsg is complete and handed out */
+static uint8_t ucRxMsgReady;
+/** message being reassembled overflowed and is dropped */
+static uint8_t ucRxMsgDrop;
+
+/** message being sent */
+static uint8_t ucTxMsg[UART_V2_MAX_MESSAGE];
+/** length of message being sent */
+static uint16_t usTxLen;
+/** frames of message being sent */
+static uint8_t ucTxFrames;
+/** sequence of first frame of message being sent */
+static uint8_t ucTxFirst;
+/** frames acknowledged in order */
+static uint8_t ucTxAcked;
+/** sequence of the first frame of next message */
+static uint8_t ucTxSeq;
+/** transmit order counter for loss detection */
+static uint32_t ulTxStamp;
+/** intelLINK_TX_xxx */
+static int32_t lTxStatus = intelLINK_TX_IDLE;
+/** per frame transmit state */
+static linkTxFrame_t xTxFrame[intelLINK_MAX_TX_FRAMES];
+
+/** CRC-16/CCITT-FALSE, one entry per nibble */
+static const uint16_t usCrc16Table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/**
+ * @brief Handle a received selective acknowledgement
+ *
+ * Frames before ack and those marked in sack are acknowledged. An
+ * unacknowledged frame sent before the newest selectively acknowledged
+ * one is lost and marked for retransmission.
+ *
+ * @param ucAck next sequence BIOS expects.
+ * @param ucSack out of order bitmap.
+ *
+ * @return void
+ */
+static void prvLinkTxAck( uint8_t ucAck, uint8_t ucSack );
+
+/**
+ * @brief Accept a received data frame
+ *
+ * Frame is kept if it is inside the receive window, then the in order
+ * point is advanced over all frames held.
+ *
+ * @return void
+ */
+static void prvLinkRxData( void );
+
+/*---------------------------------------------------------------------------*/
+
+uint16_t usIntelLinkCrc16( uint16_t usCrc, const uint8_t *pucData,
+			   uint32_t ulLen )
+{
+    while (ulLen--)
+    {
+	usCrc ^= (uint16_t)(*pucData++) << 8;
+	usCrc = (usCrc << 4) ^ usCrc16Table[usCrc >> 12];
+	usCrc = (usCrc << 4) ^ usCrc16Table[usCrc >> 12];
+    }
+    return usCrc;
+}
+/*---------------------------------------------------------------------------*/
+
+void vIntelLinkReset( uint8_t ucVersion, uint8_t ucWindow, uint16_t usMaxMsg )
+{
+    ucLinkVersion = ucVersion;
+    ucLinkWindow = ucWindow;
+    usLinkMaxMsg = usMaxMsg;
+
+    /* Both peers start counting from 0 on every switch */
+    memset(xRxSlot, 0, sizeof(xRxSlot));
+    usRxPos = 0;
+    ucRxExpected = 0;
+    ucRxDeliver = 0;
+    usRxMsgLen = 0;
+    ucRxMsgReady = 0;
+    ucRxMsgDrop = 0;
+
+    memset(xTxFrame, 0, sizeof(xTxFrame));
+    ucTxSeq = 0;
+    ucTxFrames = 0;
+    ucTxAcked = 0;
+    lTxStatus = intelLINK_TX_IDLE;
+}
+/*---------------------------------------------------------------------------*/
+
+uint8_t ucIntelLinkVersion( void )
+{
+    return ucLinkVersion;
+}
+/*---------------------------------------------------------------------------*/
+
+void vIntelLinkRxStart( uint8_t ucType )
+{
+    ucRxFrame[0] = ucType;
+    usRxPos = 1;
+    ucRxHdr = (ucType == UART_TYP_DATA_V2) ? linkDATA_HDR : linkACK_HDR;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lIntelLinkRxByte( uint8_t ucByte )
+{
+    uint16_t usDataLen = 0;
+    uint16_t usCrc;
+
+    ucRxFrame[usRxPos++] = ucByte;
+
+    /* Length is known once the header is in */
+    if (usRxPos <= (1 + ucRxHdr))
+    {
+	return intelLINK_RX_MORE;
+    }
+    if (ucRxHdr == linkDATA_HDR)
+    {
+	usDataLen = ucRxFrame[3];
+    }
+    if (usRxPos < (1 + ucRxHdr + usDataLen + UART_V2_CRC_SIZE))
+    {
+	return intelLINK_RX_MORE;
+    }
+
+    /* Whole frame is in, check it */
+    usCrc = usIntelLinkCrc16(UART_V2_CRC_INIT, ucRxFrame,
+	    1 + ucRxHdr + usDataLen);
+    if ((ucRxFrame[1 + ucRxHdr + usDataLen] != (uint8_t)(usCrc >> 8)) ||
+	    (ucRxFrame[2 + ucRxHdr + usDataLen] != (uint8_t)usCrc))
+    {
+	/* Sender finds the gap from later acks or its timeout */
+	debugPRINT_SUC_INTEL_COMM("Link CRC error typ 0x%x\n\r", ucRxFrame[0]);
+	return intelLINK_RX_ERROR;
+    }
+
+    if (ucRxHdr == linkACK_HDR)
+    {
+	prvLinkTxAck(ucRxFrame[1], ucRxFrame[2]);
+	return intelLINK_RX_ACKED;
+    }
+    prvLinkRxData();
+
+    /* Duplicates are acknowledged too, the earlier ack may be lost */
+    return intelLINK_RX_DATA;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvLinkRxData( void )
+{
+    linkRxSlot_t *pxSlot;
+    uint8_t ucSeq = ucRxFrame[1];
+
+    /* Keep frames inside the window with a free slot only */
+    if (((uint8_t)(ucSeq - ucRxExpected) < ucLinkWindow) &&
+	    ((uint8_t)(ucSeq - ucRxDeliver) < intelLINK_MAX_WINDOW))
+    {
+	pxSlot = &xRxSlot[ucSeq % intelLINK_MAX_WINDOW];
+	if (pxSlot->ucPresent == 0)
+	{
+	    pxSlot->ucPresent = 1;
+	    pxSlot->ucSeq = ucSeq;
+	    pxSlot->ucFlags = ucRxFrame[2];
+	    pxSlot->ucLen = ucRxFrame[3];
+	    memcpy(pxSlot->ucData, &ucRxFrame[1 + linkDATA_HDR], pxSlot->ucLen);
+	}
+    }
+
+    /* Advance the in order point over frames held */
+    while ((uint8_t)(ucRxExpected - ucRxDeliver) < intelLINK_MAX_WINDOW)
+    {
+	pxSlot = &xRxSlot[ucRxExpected % intelLINK_MAX_WINDOW];
+	if ((pxSlot->ucPresent == 0) || (pxSlot->ucSeq != ucRxExpected))
+	{
+	    break;
+	}
+	ucRxExpected++;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lIntelLinkRxDeliver( void )
+{
+    linkRxSlot_t *pxSlot;
+
+    /* Message handed out last time is consumed */
+    if (ucRxMsgReady)
+    {
+	ucRxMsgReady = 0;
+	usRxMsgLen = 0;
+    }
+
+    while (ucRxDeliver != ucRxExpected)
+    {
+	pxSlot = &xRxSlot[ucRxDeliver % intelLINK_MAX_WINDOW];
+	if ((usRxMsgLen + pxSlot->ucLen) > usLinkMaxMsg)
+	{
+	    /* Drop the rest of an oversized message */
+	    ucRxMsgDrop = 1;
+	}
+	else if (ucRxMsgDrop == 0)
+	{
+	    memcpy(&ucRxMsg[usRxMsgLen], pxSlot->ucData, pxSlot->ucLen);
+	    usRxMsgLen += pxSlot->ucLen;
+	}
+	pxSlot->ucPresent = 0;
+	ucRxDeliver++;
+
+	if ((pxSlot->ucFlags & UART_V2_FLAG_MORE) == 0)
+	{
+	    if (ucRxMsgDrop)
+	    {
+		debugERROR_PRINT("Link message over %d bytes dropped\n",
+			usLinkMaxMsg);
+		ucRxMsgDrop = 0;
+		usRxMsgLen = 0;
+		continue;
+	    }
+	    ucRxMsgReady = 1;
+	    return intelLINK_RX_MESSAGE;
+	}
+    }
+    return intelLINK_RX_DONE;
+}
+/*---------------------------------------------------------------------------*/
+
+uint8_t ucIntelLinkRxBacklog( void )
+{
+    return (ucRxDeliver != ucRxExpected) ? 1 : 0;
+}
+/*---------------------------------------------------------------------------*/
+
+const uint8_t *pucIntelLinkRxMessage( uint16_t *pusLen )
+{
+    *pusLen = ucRxMsgReady ? usRxMsgLen : 0;
+    return ucRxMsg;
+}
+/*---------------------------------------------------------------------------*/
+
+uint16_t usIntelLinkBuildAck( uint8_t *pucFrame )
+{
+    linkRxSlot_t *pxSlot;
+    uint16_t usCrc;
+    uint8_t ucSeq;
+    uint8_t ucSack = 0;
+    uint8_t ucBit;
+
+    /* Mark frames held beyond the in order point */
+    for (ucBit = 0; (ucBit + 1) < ucLinkWindow; ucBit++)
+    {
+	ucSeq = ucRxExpected + 1 + ucBit;
+	pxSlot = &xRxSlot[ucSeq % intelLINK_MAX_WINDOW];
+	if (pxSlot->ucPresent && (pxSlot->ucSeq == ucSeq))
+	{
+	    ucSack |= (1 << ucBit);
+	}
+    }
+
+    pucFrame[0] = UART_SOF_0;
+    pucFrame[1] = UART_SOF_1;
+    pucFrame[2] = UART_TYP_ACK_V2;
+    pucFrame[3] = ucRxExpected;
+    pucFrame[4] = ucSack;
+    usCrc = usIntelLinkCrc16(UART_V2_CRC_INIT, &pucFrame[2], 3);
+    pucFrame[5] = (uint8_t)(usCrc >> 8);
+    pucFrame[6] = (uint8_t)usCrc;
+
+    return UART_V2_ACK_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lIntelLinkTxStart( const uint8_t *pucMsg, uint16_t usLen )
+{
+    if ((pucMsg == NULL) || (usLen == 0))
+    {
+	return COMMON_ERR_INVAL;
+    }
+    if (usLen > usLinkMaxMsg)
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+
+    memcpy(ucTxMsg, pucMsg, usLen);
+    usTxLen = usLen;
+    ucTxFrames = (usLen + intelLINK_TX_FRAME_DATA - 1) /
+	    intelLINK_TX_FRAME_DATA;
+    memset(xTxFrame, 0, sizeof(xTxFrame));
+    ucTxFirst = ucTxSeq;
+    ucTxSeq += ucTxFrames;
+    ucTxAcked = 0;
+    lTxStatus = intelLINK_TX_BUSY;
+
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+uint16_t usIntelLinkTxNext( uint8_t *pucFrame )
+{
+    linkTxFrame_t *pxFrame;
+    uint16_t usOffset;
+    uint16_t usCrc;
+    uint8_t ucLen;
+    uint8_t ucIndex;
+    uint8_t ucEnd;
+
+    if (lTxStatus != intelLINK_TX_BUSY)
+    {
+	return 0;
+    }
+
+    ucEnd = ucTxAcked + ucLinkWindow;
+    if (ucEnd > ucTxFrames)
+    {
+	ucEnd = ucTxFrames;
+    }
+    for (ucIndex = ucTxAcked; ucIndex < ucEnd; ucIndex++)
+    {
+	pxFrame = &xTxFrame[ucIndex];
+	if ((pxFrame->ucState == linkFRAME_UNSENT) || pxFrame->ucResend)
+	{
+	    break;
+	}
+    }
+    if (ucIndex == ucEnd)
+    {
+	/* Window is full or everything is out */
+	return 0;
+    }
+
+    if (pxFrame->ucResend)
+    {
+	if (pxFrame->ucRetry == intelLINK_MAX_RETRY)
+	{
+	    debugERROR_PRINT("Link frame %d not acknowledged, giving up\n",
+		    (uint8_t)(ucTxFirst + ucIndex));
+	    lTxStatus = intelLINK_TX_FAIL;
+	    return 0;
+	}
+	pxFrame->ucRetry++;
+	pxFrame->ucResend = 0;
+    }
+    pxFrame->ucState = linkFRAME_SENT;
+    pxFrame->ulStamp = ++ulTxStamp;
+
+    usOffset = ucIndex * intelLINK_TX_FRAME_DATA;
+    ucLen = ((usTxLen - usOffset) > intelLINK_TX_FRAME_DATA) ?
+	    intelLINK_TX_FRAME_DATA : (usTxLen - usOffset);
+
+    pucFrame[0] = UART_SOF_0;
+    pucFrame[1] = UART_SOF_1;
+    pucFrame[2] = UART_TYP_DATA_V2;
+    pucFrame[3] = ucTxFirst + ucIndex;
+    pucFrame[4] = ((ucIndex + 1) < ucTxFrames) ? UART_V2_FLAG_MORE : 0;
+    pucFrame[5] = ucLen;
+    memcpy(&pucFrame[UART_V2_HDR_SIZE], &ucTxMsg[usOffset], ucLen);
+    usCrc = usIntelLinkCrc16(UART_V2_CRC_INIT, &pucFrame[2],
+	    linkDATA_HDR + 1 + ucLen);
+    pucFrame[UART_V2_HDR_SIZE + ucLen] = (uint8_t)(usCrc >> 8);
+    pucFrame[UART_V2_HDR_SIZE + ucLen + 1] = (uint8_t)usCrc;
+
+    return UART_V2_HDR_SIZE + ucLen + UART_V2_CRC_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvLinkTxAck( uint8_t ucAck, uint8_t ucSack )
+{
+    linkTxFrame_t *pxFrame;
+    uint32_t ulNewest = 0;
+    uint8_t ucAcked;
+    uint8_t ucIndex;
+    uint8_t ucBit;
+
+    if (lTxStatus != intelLINK_TX_BUSY)
+    {
+	return;
+    }
+
+    /* Acks of an earlier message fall outside, ignore them */
+    ucAcked = (uint8_t)(ucAck - ucTxFirst);
+    if ((ucAcked > ucTxFrames) || (ucAcked < ucTxAcked))
+    {
+	return;
+    }
+    for (ucIndex = ucTxAcked; ucIndex < ucAcked; ucIndex++)
+    {
+	xTxFrame[ucIndex].ucState = linkFRAME_ACKED;
+	xTxFrame[ucIndex].ucResend = 0;
+    }
+    ucTxAcked = ucAcked;
+
+    for (ucBit = 0; ((ucBit + 1) < ucLinkWindow) &&
+	    ((ucAcked + 1 + ucBit) < ucTxFrames); ucBit++)
+    {
+	pxFrame = &xTxFrame[ucAcked + 1 + ucBit];
+	if ((ucSack & (1 << ucBit)) && (pxFrame->ucState == linkFRAME_SENT))
+	{
+	    pxFrame->ucState = linkFRAME_ACKED;
+	    pxFrame->ucResend = 0;
+	    if (pxFrame->ulStamp > ulNewest)
+	    {
+		ulNewest = pxFrame->ulStamp;
+	    }
+	}
+    }
+
+    /* A frame sent before one that made it across is lost */
+    for (ucIndex = ucTxAcked; ucIndex < ucTxFrames; ucIndex++)
+    {
+	pxFrame = &xTxFrame[ucIndex];
+	if ((pxFrame->ucState == linkFRAME_SENT) &&
+		(pxFrame->ulStamp < ulNewest))
+	{
+	    pxFrame->ucResend = 1;
+	}
+    }
+
+    if (ucTxAcked == ucTxFrames)
+    {
+	lTxStatus = intelLINK_TX_DONE;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+void vIntelLinkTxTimeout( void )
+{
+    uint8_t ucIndex;
+
+    for (ucIndex = ucTxAcked; ucIndex < ucTxFrames; ucIndex++)
+    {
+	if (xTxFrame[ucIndex].ucState == linkFRAME_SENT)
+	{
+	    xTxFrame[ucIndex].ucResend = 1;
+	}
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lIntelLinkTxStatus( void )
+{
+    return lTxStatus;
+}
+/*---------------------------------------------------------------------------*/
@@ -54,13 +54,8 @@ int32_t lLeInterfaceRead_Version(leDeviceInfo_t * pxDeviceInfo)
 	debugERROR_PRINT(" Uninitialized Version Info pointer");
 	return COMMON_ERR_INVAL;
     }
-    lRet = mml_i2c_ioctl(MML_I2C_RXFLUSH, 0);
-    lRet |= mml_i2c_ioctl(MML_I2C_TXFLUSH, 0);
-    if( lRet != NO_ERROR)
-    {
-	debugERROR_PRINT(" mml_i2c_ioctl failed");
-        return lRet;
-    }
+    /* The FIFOs are flushed by the transfer, the controller may be busy
+     * with another client here */
     lRet = lI2cRead((uint8_t)leNORDIC_I2C_SLAVE_ADDR,
 		    (uint8_t)leVERSION_READ_ADDR,
 		    sizeof(leDeviceInfo_t),
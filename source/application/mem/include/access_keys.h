@@ -39,6 +39,11 @@
 /*Global includes */
 #include <stdint.h>
 
+/**
+ * Magic number for access keys.
+ */
+#define keyACCESS_KEY_MAGIC		(0xACCE551E)
+
 /** Macros for DSFT encryption keys */
 
 /**
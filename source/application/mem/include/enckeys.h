@@ -39,6 +39,21 @@
 /*Global includes */
 #include <stdint.h>
 
+/**
+ * magic number to access DesignShift encryption keys
+ */
+#define enckeyENC_KEY_MAGIC		(0xE9C801E5U)
+
+/**
+ * magic number of the ROT RSA public key record
+ */
+#define enckeyROT_RSA_MAGIC		(0x7A5A9B1CU)
+
+/**
+ * Number of records in the encryption key store
+ */
+#define enckeysNUM_RECORDS		(2)
+
 /** Macros for DSFT encryption keys */
 /**
  * Design Shift RSA publick Key length
@@ -62,6 +77,34 @@ typedef struct
     uint8_t  ucReserved[enckeysRESERVED_LEN];
 } enckeysDsftEncKeys_t;
 
+/** Macros for ROT RSA public key */
+/**
+ * ROT RSA modulus length in bytes
+ */
+#define enckeysROT_RSA_N_LEN		(256)
+
+/**
+ * ROT RSA public exponent length in bytes
+ */
+#define enckeysROT_RSA_E_LEN		(4)
+
+/**
+ * @brief ROT RSA public key, provisioned in binary form together with the
+ * Montgomery constant so the key can be used without any parsing or setup
+ * arithmetic. All the numbers are big endian.
+ */
+typedef struct
+{
+    /** ROT RSA key magic header */
+    uint32_t ulRotRsaMagic;
+    /** modulus N */
+    uint8_t  ucN[enckeysROT_RSA_N_LEN];
+    /** public exponent E */
+    uint8_t  ucE[enckeysROT_RSA_E_LEN];
+    /** R^2 mod N, where R = 2^(8 * enckeysROT_RSA_N_LEN) */
+    uint8_t  ucRR[enckeysROT_RSA_N_LEN];
+} enckeysRotRsaKey_t;
+
 /** @brief Writes encryption key.
  *
  * This function writes encryption key structure to flash.
@@ -101,4 +144,24 @@ int32_t lEnckeysUpdatePublicKey( uint8_t *pucPublicKey );
  *
  */
 int32_t lEnckeysGetPublicKey( uint8_t *pucPublicKey );
+
+/** @brief Writes ROT RSA public key.
+ *
+ * This function writes the ROT RSA public key record to flash.
+ *
+ * @pxRsaKey pointer to ROT RSA key structure.
+ * @return error code..
+ *
+ */
+int32_t lEnckeysWriteRotRsaKey( enckeysRotRsaKey_t *pxRsaKey );
+
+/** @brief Reads ROT RSA public key.
+ *
+ * This function reads the ROT RSA public key record from flash.
+ *
+ * @pxRsaKey pointer to ROT RSA key structure.
+ * @return error code, commonPARTITIONNONE if key was never provisioned.
+ *
+ */
+int32_t lEnckeysReadRotRsaKey( enckeysRotRsaKey_t *pxRsaKey );
 #endif /* enckeysINCLUDE_ENC_KEYS_H_ */
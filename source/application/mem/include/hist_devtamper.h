@@ -40,6 +40,11 @@
 #include <stdint.h>
 #include <rtc.h>
 /** ORWL Tamper history management macros */
+/**
+ * tamper and clear event section magic
+ */
+#define devtamperTAMPER_CLEAR_MAGIC	(0x1A39E8C1)
+
 /**
  * length of time field
  */
@@ -61,20 +66,30 @@
 #define	devtamperCLR_RESERVED		(7)
 
 /**
- * max tamper/clr history that can be stored on flash
+ * tamper/clr history kept by the tamper history of earlier releases
  */
 #define devtamperEVENT_HIST_MAX_COUNT	(1)
 
 /**
- * max tamper/clr history that can be stored on flash
+ * event type of a tamper
  */
 #define devtamperEVENT_TAMPER		(1)
 
 /**
- * max tamper/clr history that can be stored on flash
+ * event type of a tamper clear
  */
 #define devtamperEVENT_CLEAR		(0)
 
+/**
+ * tamper event log page magic
+ */
+#define devtamperLOG_PAGE_MAGIC		(0x7A3B10C5U)
+
+/**
+ * tamper event reserved field
+ */
+#define devtamperLOG_RESERVED		(3)
+
 /**
  * @brief This structure defines tamper events identification elements
  */
@@ -112,8 +127,9 @@ typedef struct
 } devtamperClearEvent_t;
 
 /**
- * @brief This structure defines * @brief This structure defines tamper clear event
- * identification elements
+ * @brief This structure defines the tamper history of earlier releases, which
+ * kept the last tamper and clear event only. It is imported in to the tamper
+ * event log on first boot.
  */
 typedef struct
 {
@@ -127,46 +143,122 @@ typedef struct
     uint32_t	  Reserved;
 } devtamperTamperHist_t;
 
+/**
+ * @brief This structure defines an event of the tamper event log. Events are
+ * appended to a circular log over the tamper history pages, the oldest page
+ * of events is dropped when the log is full.
+ */
+typedef struct
+{
+    /** sequence number, counts up from 1 over the life of the log */
+    uint32_t ulSeq;
+    /** RTC seconds of occurrence */
+    uint32_t ulTime;
+    /** cause of tamper, security alarm register. 0 for clear event */
+    uint32_t ulCause;
+    /** differentiate clear or tamper, devtamperEVENT_xxx */
+    uint8_t  ucType;
+    /** Reserved */
+    uint8_t  ucReserved[devtamperLOG_RESERVED];
+    /** CRC over the fields above */
+    uint32_t ulCrc;
+} devtamperLogEvent_t;
+
+/**
+ * @brief This structure defines the range of sequence numbers in the log.
+ */
+typedef struct
+{
+    /** sequence number of the oldest event kept */
+    uint32_t ulFirstSeq;
+    /** sequence number the next event will get */
+    uint32_t ulNextSeq;
+    /** events the log holds at least before dropping old ones */
+    uint32_t ulCapacity;
+} devtamperLogInfo_t;
+
 /* Function declaration */
 
-/** @brief Writes device tamper history structure.
+/** @brief Mounts the tamper event log.
+ *
+ * This function scans the tamper history pages. On first boot the tamper
+ * history of earlier releases is imported from the record store, so it must
+ * be called after lLogstoreInit() and before tamper NMI can occur.
  *
- * This function writes device tamper history structure to flash.
+ * @return error code.
+ *
+ */
+int32_t lDevtamperLogInit( void );
+
+/** @brief Appends an event to the tamper event log.
  *
- * @pxDevTamHist pointer to devtamperTamperHist_t structure.
+ * @param ucType event type, devtamperEVENT_xxx.
+ * @param ulTime RTC seconds of occurrence.
+ * @param ulCause cause of tamper.
  * @return error code.
  *
  */
-int32_t lDevtamperWriteTampHistory(devtamperTamperHist_t *pxDevTamHist);
+int32_t lDevtamperLogAppend( uint8_t ucType, uint32_t ulTime,
+	uint32_t ulCause );
 
-/** @brief Writes device tamper history structure, NON RTOS.
+/** @brief Appends an event to the tamper event log, NON RTOS.
  *
- * This function writes device tamper history structure to flash. This function
- * should be called from NON RTOS context.
+ * Same as lDevtamperLogAppend without taking the log mutex. This function
+ * should be called from NON RTOS context or tamper NMI.
  *
- * @pxDevTamHist pointer to devtamperTamperHist_t structure.
+ * @param ucType event type, devtamperEVENT_xxx.
+ * @param ulTime RTC seconds of occurrence.
+ * @param ulCause cause of tamper.
  * @return error code.
  *
  */
-int32_t lDevtamperWriteTampHistoryNONRTOS(devtamperTamperHist_t *pxDevTamHist);
+int32_t lDevtamperLogAppendNONRTOS( uint8_t ucType, uint32_t ulTime,
+	uint32_t ulCause );
 
-/** @brief Reads device tamper history structure.
+/** @brief Reads an event by sequence number.
+ *
+ * The slot of the event is computed from its sequence number, only the event
+ * itself is read from flash.
+ *
+ * @param ulSeq sequence number.
+ * @param pxEvent pointer to event to fill.
+ * @return error code, COMMON_ERR_NO_MATCH if the event was dropped or not
+ * yet written, COMMON_ERR_BAD_STATE if it fails its CRC.
  *
- * This function reads device tamper history structure from flash.
+ */
+int32_t lDevtamperLogRead( uint32_t ulSeq, devtamperLogEvent_t *pxEvent );
+
+/** @brief Finds the next event in a time range.
+ *
+ * Searches in sequence order from ulSeq for an event with ulFrom <= time <=
+ * ulTo. Pages holding no event of the range are skipped without reading
+ * them, so times need not be in order when RTC was set back.
+ *
+ * @param ulSeq sequence number to search from.
+ * @param ulFrom start of time range, RTC seconds.
+ * @param ulTo end of time range, RTC seconds.
+ * @param pulSeq pointer to sequence number found.
+ * @return error code, COMMON_ERR_NO_MATCH if no event is left in the range.
+ *
+ */
+int32_t lDevtamperLogFindTime( uint32_t ulSeq, uint32_t ulFrom, uint32_t ulTo,
+	uint32_t *pulSeq );
+
+/** @brief Reads the newest event of a type.
+ *
+ * @param ucType event type, devtamperEVENT_xxx.
+ * @param pxEvent pointer to event to fill.
+ * @return error code, COMMON_ERR_NO_MATCH if the log holds no such event.
+ *
+ */
+int32_t lDevtamperLogGetLast( uint8_t ucType, devtamperLogEvent_t *pxEvent );
+
+/** @brief Gets the range of sequence numbers in the log.
  *
- * @pxDevTamHist pointer to devtamperTamperHist_t structure.
+ * @param pxInfo pointer to information structure to fill.
  * @return error code.
  *
  */
-int32_t lDevtamperReadTampHistory(devtamperTamperHist_t *pxDevTamHist);
+int32_t lDevtamperLogGetInfo( devtamperLogInfo_t *pxInfo );
 
-#if 0
-/** TO BE DONE */
-int32_t ulAddTamperEventEntry( devtamperTamperHist_t *pData );
-int32_t ulAddClearEventEntry( devtamperClearEvent_t *pData );
-int32_t ulGetLastTamperEvent( devtamperTamperHist_t *pData );
-int32_t ulGetLastClearEvent( devtamperClearEvent_t *pData );
-int32_t ulGetTamperEventList( devtamperTamperHist_t *pData[] );
-int32_t ulGetClearEventList( devtamperClearEvent_t *pData[] );
-#endif
 #endif /* devtamperINCLUDE_TAMPER_CLEAR_H_ */
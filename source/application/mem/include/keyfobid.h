@@ -83,7 +83,19 @@
 /**
  * Reserved
  */
-#define keyfobidKEY_INFO_RESERVED	(16)
+#define keyfobidKEY_INFO_RESERVED	(12)
+
+/**
+ * Key type of a keyfob authenticated with AES-128 and CMAC. Any other value,
+ * including the reserved bytes of entries written before the field existed,
+ * selects the legacy 3DES scheme.
+ */
+#define keyfobidKEY_TYPE_AES128		(0x41455331U)
+
+/**
+ * Key type of a keyfob authenticated with the legacy 3DES scheme
+ */
+#define keyfobidKEY_TYPE_TDES		(0x54444553U)
 
 /**
  * Unique data of Keyfob - Optional filed
@@ -179,6 +191,8 @@ typedef struct
     SecretKey_t	xSecKeyY;
     /** KeyFob unique CVM PIN*/
     uint8_t	ulKeyPIN[keyfobidCVM_PIN_LEN];
+    /** Authentication scheme, keyfobidKEY_TYPE_AES128 or legacy 3DES */
+    uint32_t	ulKeyType;
     /** Reserved for future */
     uint8_t	ucReserved[keyfobidKEY_INFO_RESERVED];
     /** Optional unique data for the keyfob */
@@ -282,4 +296,48 @@ int32_t lKeyfobidUpdateKeyPrivilages( uint32_t ulKeyFobId, uint32_t ulKeyPrevila
  * @return error code.
  */
 int32_t lKeyfobidCheckFreeIndex( uint8_t *pucIndexAdd);
+
+/** @brief Find keyfob key by name.
+ *
+ * This function looks up the RAM index of keyfob table, flash is read only
+ * if the index has to be built.
+ *
+ * @param pucKeyName pointer to key name.
+ * @param ucKeyLen length of key name to compare.
+ * @param pucIndex pointer to get the index of key.
+ *
+ * @return error code.
+ */
+int32_t lKeyfobidFindKeyName( const uint8_t *pucKeyName, uint8_t ucKeyLen,
+	uint8_t *pucIndex );
+
+/** @brief Find keyfob key by keyfobID.
+ *
+ * This function looks up the RAM index of keyfob table, flash is read only
+ * if the index has to be built.
+ *
+ * @param ulKeyFobId keyfobid value.
+ * @param pucIndex pointer to get the index of key.
+ *
+ * @return error code.
+ */
+int32_t lKeyfobidFindKeyFobID( uint32_t ulKeyFobId, uint8_t *pucIndex );
+
+/** @brief Get generation of keyfob table.
+ *
+ * Generation changes every time a key is added, removed or updated. Copies
+ * of a key taken with an older generation may be stale.
+ *
+ * @return generation count.
+ */
+uint32_t ulKeyfobidGetGeneration( void );
+
+/** @brief Invalidate RAM index of keyfob table.
+ *
+ * This function should be called when keyfob partition is changed without
+ * using keyfobid functions, index is built again on next lookup.
+ *
+ * @return void.
+ */
+void vKeyfobidInvalidateIndex( void );
 #endif /* keyfobidINCLUDE_KEYFOB_ID_H_ */
@@ -0,0 +1,197 @@
+ /**===========================================================================
+ * @file logstore.h
+ *
+ * @brief This file contains the log structured flash record store used by
+ * the key, keyfob and tamper history partitions.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef logstoreINCLUDE_LOGSTORE_H_
+#define logstoreINCLUDE_LOGSTORE_H_
+
+/* Global includes */
+#include <stdint.h>
+
+/**
+ * Maximum number of record ID's a store can hold. Keyfob store uses one
+ * record per keyfob slot.
+ */
+#define logstoreMAX_RECORD_IDS		(10)
+
+/**
+ * Maximum number of flash pages a store can span.
+ */
+#define logstoreMAX_PAGES		(4)
+
+/**
+ * Store flag, superseded copies of a record are overwritten with zeros once
+ * the new copy is committed. Used for stores holding secrets so that removed
+ * or changed keys do not stay readable in flash till the page is collected.
+ */
+#define logstoreFLAG_SCRUB		(0x01)
+
+/**
+ * Identifies each record store. Flash regions are defined in flash.h.
+ */
+typedef enum xLOGSTORE_IDS
+{
+    eLOGSTORE_ACCESS_KEY = 0,	/**< Access keys & PIN partition */
+    eLOGSTORE_ENC_KEY,		/**< Encryption key partition */
+    eLOGSTORE_KEYFOB_ID,	/**< Keyfob ID partition, one record per slot */
+    eLOGSTORE_TAMP_HIST,	/**< Tamper history of earlier releases, read once
+				  by the tamper event log to import it */
+    eLOGSTORE_MAX,		/**< Number of stores */
+}xLogstoreId;
+
+/**
+ * Store usage information, for diagnostics.
+ */
+typedef struct
+{
+    /** Number of records present, deleted records excluded */
+    uint32_t ulRecords;
+    /** Bytes which can be appended before the next garbage collection */
+    uint32_t ulFreeBytes;
+    /** Number of pages collected since boot */
+    uint32_t ulCollections;
+    /** Lowest erase count among the store pages */
+    uint32_t ulMinEraseCount;
+    /** Highest erase count among the store pages */
+    uint32_t ulMaxEraseCount;
+} xLogstoreInfo_t;
+
+/* function declaration */
+
+/** @brief Initialize record stores.
+ *
+ * This function mounts all the record stores: scans the pages, rebuilds the
+ * record index, discards records torn by a power off and imports data still
+ * stored in the old A/B partition format. Must be called once before the
+ * scheduler is started and before any other logstore API.
+ *
+ * @return error code.
+ *
+ */
+int32_t lLogstoreInit( void );
+
+/** @brief Read a record.
+ *
+ * This function reads the latest copy of a record. If the stored record is
+ * shorter than the buffer, remaining bytes are set to commonDEFAULT_VALUE,
+ * if longer, it is truncated. Record is verified against its CRC. Does not
+ * block, can be used from any context.
+ *
+ * @param eStore store to read from.
+ * @param usId record ID.
+ * @param pvData buffer to read the record into.
+ * @param usLen size of the buffer.
+ * @return error code, COMMON_ERR_NO_MATCH if the record is not present.
+ *
+ */
+int32_t lLogstoreRead( xLogstoreId eStore, uint16_t usId, void *pvData,
+	uint16_t usLen );
+
+/** @brief Get the flash address of a record.
+ *
+ * This function gives the address of the latest copy of a record, so a
+ * caller taking over the store pages can keep that page until last.
+ *
+ * @param eStore store of the record.
+ * @param usId record ID.
+ * @param pulAddress address of the record header.
+ * @return error code, COMMON_ERR_NO_MATCH if the record is not present.
+ *
+ */
+int32_t lLogstoreGetRecordAddr( xLogstoreId eStore, uint16_t usId,
+	uint32_t *pulAddress );
+
+/** @brief Write a record.
+ *
+ * This function appends a new copy of the record to the store. Interrupts
+ * are not disabled, stores are serialized with a mutex. A page is erased only
+ * when the store runs out of free space, after its live records have been
+ * copied forward.
+ *
+ * @param eStore store to write to.
+ * @param usId record ID.
+ * @param pvData record data.
+ * @param usLen record length.
+ * @return error code.
+ *
+ */
+int32_t lLogstoreWrite( xLogstoreId eStore, uint16_t usId, const void *pvData,
+	uint16_t usLen );
+
+/** @brief Write a record, Non RTOS API.
+ *
+ * Same as lLogstoreWrite without taking the store mutex. Use this function
+ * only when no task can access the store, before the scheduler is started
+ * or from tamper handler.
+ *
+ * @param eStore store to write to.
+ * @param usId record ID.
+ * @param pvData record data.
+ * @param usLen record length.
+ * @return error code.
+ *
+ */
+int32_t lLogstoreWriteNONRTOS( xLogstoreId eStore, uint16_t usId,
+	const void *pvData, uint16_t usLen );
+
+/** @brief Delete a record.
+ *
+ * This function appends a delete marker for the record.
+ *
+ * @param eStore store to delete from.
+ * @param usId record ID.
+ * @return error code.
+ *
+ */
+int32_t lLogstoreDelete( xLogstoreId eStore, uint16_t usId );
+
+/** @brief Erase a store.
+ *
+ * This function erases all the pages of the store and drops every record.
+ *
+ * @param eStore store to erase.
+ * @return error code.
+ *
+ */
+int32_t lLogstoreFormat( xLogstoreId eStore );
+
+/** @brief Get store information.
+ *
+ * @param eStore store to query.
+ * @param pxInfo pointer to information structure to fill.
+ * @return error code.
+ *
+ */
+int32_t lLogstoreGetInfo( xLogstoreId eStore, xLogstoreInfo_t *pxInfo );
+
+#endif /* logstoreINCLUDE_LOGSTORE_H_ */
@@ -156,4 +156,17 @@ int32_t lcommonEraseKeyFobId( void );
  */
 int32_t lcommonEraseUserConfigData( void );
 
+/** @brief Calculate CRC-32
+ *
+ * This function calculates IEEE 802.3 CRC-32. CRC of data split in parts
+ * can be calculated by passing CRC of previous part, 0 for the first part.
+ *
+ * @param ulCrc CRC of previous part.
+ * @param pucData pointer to data.
+ * @param ulLen length of data.
+ *
+ * @return CRC.
+ */
+uint32_t ulCommonCrc32( uint32_t ulCrc, const uint8_t *pucData, uint32_t ulLen );
+
 #endif /*commonINCLUDE_MEM_COMMON_H_ */
@@ -39,7 +39,6 @@
 #include <debug.h>
 #include <printf_lite.h>
 #include <string.h>
-#include <mml_sflc.h>
 
 /* Freertos includes */
 #include <FreeRTOS.h>
@@ -49,28 +48,13 @@
 /* Local includes */
 #include <mem_common.h>
 #include <access_keys.h>
-/* Not exposing flash.h to users */
-#include "flash.h"
+#include <logstore.h>
 
 /**
- * Magic number for access keys.
+ * Record ID of access keys in the record store, whole structure is one
+ * record.
  */
-#define keyACCESS_KEY_MAGIC		(0xACCE551E)
-
-/**
- * Magic number size for access keys is 4 bytes.
- */
-#define keyACCESS_KEY_MAGIC_SIZE	(4)
-
-/**
- * access keys partition 1 address.
- */
-#define keysACCESS_KEY_PART1	(flashACCESS_KEY_START_ADDR)
-
-/**
- * Access key partition 2(backup) address.
- */
-#define keysACCESS_KEY_PART2	((keysACCESS_KEY_PART1 + flashPAGE_SIZE))
+#define keysACCESS_KEY_RECORD_ID	(0)
 
 /** function definition */
 
@@ -78,8 +62,6 @@ int32_t lKeysWriteMasterKeys( keysDSFT_MASTER_KEYS_t *pxACKeys )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -88,121 +70,20 @@ int32_t lKeysWriteMasterKeys( keysDSFT_MASTER_KEYS_t *pxACKeys )
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* access key structure for backup */
-    keysDSFT_MASTER_KEYS_t *pxBackUpAKData = NULL;
-    /* allocate dynamic memory */
-    pxBackUpAKData = (keysDSFT_MASTER_KEYS_t *) pvPortMalloc(
-	    sizeof(keysDSFT_MASTER_KEYS_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpAKData == NULL)
-    {
-	debugERROR_PRINT(
-		"Failed to allocate memory for access key structure \r\n");
-	return COMMON_ERR_NULL_PTR;
-    }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpAKData, commonDEFAULT_VALUE, sizeof(keysDSFT_MASTER_KEYS_t));
-
-    /* We need to check which partition has a valid data, based on valid magic
-     * number. If both partition does not have valid magic number than, data
-     * will be written to partition 1.
-     */
-    ulPartition = lCommonChoosePartition(keysACCESS_KEY_PART1,
-	    keysACCESS_KEY_PART2, keyACCESS_KEY_MAGIC,
-	    keyACCESS_KEY_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	/* assuming partition 1 has latest updated data, copy the partition 1
-	 * data to backup structure.
-	 */
-	lStatus = lKeysReadMasterKeys(pxBackUpAKData);
-	if(lStatus != NO_ERROR)
-	{
-	    debugERROR_PRINT("failed to read access key data \r\n");
-	    goto CLEANUP;
-	}
-	/* Now write primary partition data to backup partition */
-	/* Before writing flash scheduler and interrupts should be disabled,
-	 * once the write is done,then both can be enabled
-	 */
-	/* Commenting suspend and resume scheduler since, it is observed
-	 * Flash hangs sometimes because of this. Please revisit the same
-	 * if required.
-	 */
-	taskENTER_CRITICAL();
-	/* vTaskSuspendAll(); */
-	lStatus = lCommonUpdatePartition(keysACCESS_KEY_PART2,
-		sizeof(keysDSFT_MASTER_KEYS_t), (uint8_t *) pxBackUpAKData,
-		keyACCESS_KEY_MAGIC, keyACCESS_KEY_MAGIC_SIZE);
-	/* xTaskResumeAll(); */
-	taskEXIT_CRITICAL();
-        if(lStatus != NO_ERROR)
-	{
-	     debugERROR_PRINT("failed to update backup partition \r\n");
-	     goto CLEANUP;
-	}
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
-    {
-	/* Backup Partition has valid magic header, this can occur in case where
-	 * there was power off while writing primary partition. we don't need to
-	 * restore the same for primary partition because we will be writing the
-	 * latest data given by user to primary partition. Also in case if user
-	 * does not write latest data to primary partition, while reading data
-	 * will be read from secondary partition.
-	 */
-	/* Do nothing for this else if */
-    }
-    /* check if both the partition does not have valid header */
-    else if (ulPartition == commonPARTITIONNONE)
-    {
-	/* Both partitions does not have valid data, inform user but,
-	 * don't return. Update latest user data to primary partition.
-	 */
-	debugPRINT("Both partition does not have valid header \r\n");
-    }
-    /* Some error has occurred. */
-    else
-    {
-	debugERROR_PRINT("failed to choose partition \r\n");
-	/* update error code */
-	lStatus = ulPartition;
-	goto CLEANUP;
-    }
 
     /* Before writing the user data we must update the magic header because user
      * is not aware of it.
      */
     pxACKeys->ulAccessKeyMagic = keyACCESS_KEY_MAGIC;
 
-    /* Now update the primary partition with latest data given by the user*/
-    /* Before writing flash scheduler and interrupts should be disabled,
-     * once the write is done,then both can be enabled
-     */
-    /* Commenting suspend and resume scheduler since, it is observed
-     * Flash hangs sometimes because of this. Please revisit the same
-     * if required.
+    /* Append the keys to the record store. Previous copy stays valid till the
+     * new one is committed, and is scrubbed after.
      */
-    taskENTER_CRITICAL();
-    /* vTaskSuspendAll(); */
-    lStatus = lCommonUpdatePartition(keysACCESS_KEY_PART1,
-	    sizeof(keysDSFT_MASTER_KEYS_t), (uint8_t *) pxACKeys,
-	    keyACCESS_KEY_MAGIC, keyACCESS_KEY_MAGIC_SIZE);
-    /* xTaskResumeAll(); */
-    taskEXIT_CRITICAL();
+    lStatus = lLogstoreWrite(eLOGSTORE_ACCESS_KEY, keysACCESS_KEY_RECORD_ID,
+	    pxACKeys, sizeof(keysDSFT_MASTER_KEYS_t));
     if(lStatus != NO_ERROR)
-	{
-	     debugERROR_PRINT("failed to write access key data \r\n");
-	     goto CLEANUP;
-	}
-
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpAKData)
     {
-	vPortFree(pxBackUpAKData);
+	debugERROR_PRINT("failed to write access key data \r\n");
     }
     /* return the error code */
     return lStatus;
@@ -213,8 +94,6 @@ int32_t lKeysWriteMasterKeysNONRTOS( keysDSFT_MASTER_KEYS_t *pxACKeys )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -223,99 +102,18 @@ int32_t lKeysWriteMasterKeysNONRTOS( keysDSFT_MASTER_KEYS_t *pxACKeys )
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* access key structure for backup */
-    keysDSFT_MASTER_KEYS_t *pxBackUpAKData = NULL;
-    /* allocate dynamic memory */
-    pxBackUpAKData = (keysDSFT_MASTER_KEYS_t *) pvPortMalloc(
-	    sizeof(keysDSFT_MASTER_KEYS_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpAKData == NULL)
-    {
-	debugERROR_PRINT(
-		"Failed to allocate memory for access key structure \r\n");
-	return COMMON_ERR_NULL_PTR;
-    }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpAKData, commonDEFAULT_VALUE, sizeof(keysDSFT_MASTER_KEYS_t));
-
-    /* We need to check which partition has a valid data, based on valid magic
-     * number. If both partition does not have valid magic number than, data
-     * will be written to partition 1.
-     */
-    ulPartition = lCommonChoosePartition(keysACCESS_KEY_PART1,
-	    keysACCESS_KEY_PART2, keyACCESS_KEY_MAGIC,
-	    keyACCESS_KEY_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	/* assuming partition 1 has latest updated data, copy the partition 1
-	 * data to backup structure.
-	 */
-	lStatus = lKeysReadMasterKeys(pxBackUpAKData);
-	if(lStatus != NO_ERROR)
-	{
-	    debugERROR_PRINT("failed to read access key data \r\n");
-	    goto CLEANUP;
-	}
-	/* Now write primary partition data to backup partition */
-	lStatus = lCommonUpdatePartition(keysACCESS_KEY_PART2,
-		sizeof(keysDSFT_MASTER_KEYS_t), (uint8_t *) pxBackUpAKData,
-		keyACCESS_KEY_MAGIC, keyACCESS_KEY_MAGIC_SIZE);
-        if(lStatus != NO_ERROR)
-	{
-	     debugERROR_PRINT("failed to update backup partition \r\n");
-	     goto CLEANUP;
-	}
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
-    {
-	/* Backup Partition has valid magic header, this can occur in case where
-	 * there was power off while writing primary partition. we don't need to
-	 * restore the same for primary partition because we will be writing the
-	 * latest data given by user to primary partition. Also in case if user
-	 * does not write latest data to primary partition, while reading data
-	 * will be read from secondary partition.
-	 */
-	/* Do nothing for this else if */
-    }
-    /* check if both the partition does not have valid header */
-    else if (ulPartition == commonPARTITIONNONE)
-    {
-	/* Both partitions does not have valid data, inform user but,
-	 * don't return. Update latest user data to primary partition.
-	 */
-	debugPRINT("Both partition does not have valid header \r\n");
-    }
-    /* Some error has occurred. */
-    else
-    {
-	debugERROR_PRINT("failed to choose partition \r\n");
-	/* update error code */
-	lStatus = ulPartition;
-	goto CLEANUP;
-    }
 
     /* Before writing the user data we must update the magic header because user
      * is not aware of it.
      */
     pxACKeys->ulAccessKeyMagic = keyACCESS_KEY_MAGIC;
 
-    /* Now update the primary partition with latest data given by the user*/
-    lStatus = lCommonUpdatePartition(keysACCESS_KEY_PART1,
-	    sizeof(keysDSFT_MASTER_KEYS_t), (uint8_t *) pxACKeys,
-	    keyACCESS_KEY_MAGIC, keyACCESS_KEY_MAGIC_SIZE);
+    /* Append the keys to the record store, without taking the store lock */
+    lStatus = lLogstoreWriteNONRTOS(eLOGSTORE_ACCESS_KEY,
+	    keysACCESS_KEY_RECORD_ID, pxACKeys, sizeof(keysDSFT_MASTER_KEYS_t));
     if(lStatus != NO_ERROR)
-	{
-	     debugERROR_PRINT("failed to write access key data \r\n");
-	     goto CLEANUP;
-	}
-
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpAKData)
     {
-	vPortFree(pxBackUpAKData);
+	debugERROR_PRINT("failed to write access key data \r\n");
     }
     /* return the error code */
     return lStatus;
@@ -326,10 +124,6 @@ int32_t lKeysReadMasterKeys( keysDSFT_MASTER_KEYS_t *pxMKeys )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
-    /* address to write data */
-    uint32_t ulAddress = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -338,33 +132,16 @@ int32_t lKeysReadMasterKeys( keysDSFT_MASTER_KEYS_t *pxMKeys )
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* We need to check if data needs to be written to partition 1 or 2
-     * based on the valid magic number. If both partition does not have valid
-     * magic number than choose partition 1.
-     */
-    ulPartition = lCommonChoosePartition(keysACCESS_KEY_PART1,
-	    keysACCESS_KEY_PART2, keyACCESS_KEY_MAGIC,
-	    keyACCESS_KEY_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	ulAddress = keysACCESS_KEY_PART1;
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
-    {
-	ulAddress = keysACCESS_KEY_PART2;
-    }
-    /* Some error has occurred. */
-    else
+
+    /* read the access key data from the record store */
+    lStatus = lLogstoreRead(eLOGSTORE_ACCESS_KEY, keysACCESS_KEY_RECORD_ID,
+	    pxMKeys, sizeof(keysDSFT_MASTER_KEYS_t));
+    if(lStatus == COMMON_ERR_NO_MATCH)
     {
+	/* keys were never written, callers expect no valid partition */
 	debugERROR_PRINT("No valid header partition found \r\n");
-	return ulPartition;
+	return commonPARTITIONNONE;
     }
-
-    /* read the access key data from the flash */
-    lStatus = mml_sflc_read(ulAddress, (uint8_t *) pxMKeys,
-	    sizeof(keysDSFT_MASTER_KEYS_t));
     if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("failed to read accees key data \r\n");
@@ -38,7 +38,6 @@
 #include <debug.h>
 #include <printf_lite.h>
 #include <stdint.h>
-#include <mml_sflc.h>
 #include <string.h>
 
 /* Freertos includes */
@@ -49,28 +48,18 @@
 /* Local includes */
 #include <enckeys.h>
 #include <mem_common.h>
-/* Not exposing flash.h to users */
-#include "flash.h"
+#include <logstore.h>
 
 /**
- * magic number to access DesignShift encryption keys
+ * Record ID of encryption keys in the record store, whole structure is one
+ * record.
  */
-#define enckeyENC_KEY_MAGIC		(0xE9C801E5U)
+#define enckeyENC_KEY_RECORD_ID		(0)
 
 /**
- * encryption key magic number size.
+ * Record ID of the ROT RSA public key in the record store.
  */
-#define enckeyENC_KEY_MAGIC_SIZE	(4)
-
-/**
- * encryption key partition 1 address.
- */
-#define	enckeysEN_KEY_PART1	(flashENC_KEY_START_ADDR)
-
-/**
- * encryption key partition 2(backup) address.
- */
-#define	enckeysEN_KEY_PART2	(enckeysEN_KEY_PART1 + flashPAGE_SIZE)
+#define enckeyROT_RSA_RECORD_ID		(1)
 
 /** function definition */
 
@@ -78,8 +67,6 @@ int32_t lEnckeysWriteEncKey( enckeysDsftEncKeys_t *pxENKey )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -88,120 +75,20 @@ int32_t lEnckeysWriteEncKey( enckeysDsftEncKeys_t *pxENKey )
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* encryption structure for backup */
-    enckeysDsftEncKeys_t *xBackUpENKey = NULL;
-    /* allocate dynamic memory */
-    xBackUpENKey = (enckeysDsftEncKeys_t *) pvPortMalloc(
-	    sizeof(enckeysDsftEncKeys_t));
-    /* check if memory was allocated properly */
-    if(xBackUpENKey == NULL)
-    {
-	debugERROR_PRINT(
-		"Failed to allocate memory for encryption key structure \r\n");
-	return COMMON_ERR_NULL_PTR;
-    }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(xBackUpENKey, commonDEFAULT_VALUE, sizeof(enckeysDsftEncKeys_t));
-
-    /* We need to check which partition has a valid data, based on valid magic
-     * number. If both partition does not have valid magic number than, data
-     * will be written to partition 1.
-     */
-    ulPartition = lCommonChoosePartition(enckeysEN_KEY_PART1,
-	    enckeysEN_KEY_PART2, enckeyENC_KEY_MAGIC, enckeyENC_KEY_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	/* assuming partition 1 has latest updated data, copy the partition 1
-	 * data to backup structure.
-	 */
-	lStatus = lEnckeysReadEncKey(xBackUpENKey);
-	if(lStatus != NO_ERROR)
-	{
-	    debugERROR_PRINT("failed to back up encryption key \r\n");
-	    goto CLEANUP;
-	}
-	/* Now write primary partition data to backup partition */
-	/* Before writing flash scheduler and interrupts should be disabled,
-	 * once the write is done,then both can be enabled
-	 */
-	/* Commenting suspend and resume scheduler since, it is observed
-	 * Flash hangs sometimes because of this. Please revisit the same
-	 * if required.
-	 */
-	taskENTER_CRITICAL();
-	/* vTaskSuspendAll(); */
-	lStatus = lCommonUpdatePartition(enckeysEN_KEY_PART2,
-		sizeof(enckeysDsftEncKeys_t), (uint8_t *) xBackUpENKey,
-		enckeyENC_KEY_MAGIC, enckeyENC_KEY_MAGIC_SIZE);
-	/* xTaskResumeAll(); */
-	taskEXIT_CRITICAL();
-        if(lStatus != NO_ERROR)
-	{
-	     debugERROR_PRINT("failed to update encryption key \r\n");
-	     goto CLEANUP;
-	}
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
-    {
-	/* Backup Partition has valid magic header, this can occur in case where
-	 * there was power off while writing primary partition. we don't need to
-	 * restore the same for primary partition because we will be writing the
-	 * latest data given by user to primary partition. Also in case if user
-	 * does not write latest data to primary partition, while reading data
-	 * will be read from secondary partition.
-	 */
-	/* Do nothing for this else if */
-    }
-    /* check if both the partition does not have valid header */
-    else if (ulPartition == commonPARTITIONNONE)
-    {
-	/* Both partitions does not have valid data, inform user but,
-	 * don't return. Update latest user data to primary partition.
-	 */
-	debugPRINT("Both partition does not have valid header \r\n");
-    }
-    /* Some error has occurred. */
-    else
-    {
-	debugERROR_PRINT("failed to choose partition \r\n");
-	/* update the error code */
-	lStatus = ulPartition;
-	goto CLEANUP;
-    }
 
     /* Before writing the user data we must update the magic header because user
      * is not aware of it.
      */
     pxENKey->ulEncKeyMagic = enckeyENC_KEY_MAGIC;
 
-    /* Now update the primary partition with latest data given by the user*/
-    /* Before writing flash scheduler and interrupts should be disabled,
-     * once the write is done,then both can be enabled
+    /* Append the key to the record store. Previous copy stays valid till the
+     * new one is committed.
      */
-    /* Commenting suspend and resume scheduler since, it is observed
-     * Flash hangs sometimes because of this. Please revisit the same
-     * if required.
-     */
-    taskENTER_CRITICAL();
-    /* vTaskSuspendAll(); */
-    lStatus = lCommonUpdatePartition(enckeysEN_KEY_PART1,
-	    sizeof(enckeysDsftEncKeys_t), (uint8_t *) pxENKey,
-	    enckeyENC_KEY_MAGIC, enckeyENC_KEY_MAGIC_SIZE);
-    /* xTaskResumeAll(); */
-    taskEXIT_CRITICAL();
+    lStatus = lLogstoreWrite(eLOGSTORE_ENC_KEY, enckeyENC_KEY_RECORD_ID,
+	    pxENKey, sizeof(enckeysDsftEncKeys_t));
     if(lStatus != NO_ERROR)
     {
-	     debugERROR_PRINT("failed to write encryption keys Data \r\n");
-	     goto CLEANUP;
-    }
-
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(xBackUpENKey)
-    {
-	vPortFree(xBackUpENKey);
+	debugERROR_PRINT("failed to write encryption key data \r\n");
     }
     /* return the error code */
     return lStatus;
@@ -212,10 +99,6 @@ int32_t lEnckeysReadEncKey( enckeysDsftEncKeys_t *pxENKey )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
-    /* address to write data */
-    uint32_t ulAddress = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -224,32 +107,16 @@ int32_t lEnckeysReadEncKey( enckeysDsftEncKeys_t *pxENKey )
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* We need to check if data needs to be written to partition 1 or 2
-     * based on the valid magic number. If both partition does not have valid
-     * magic number than choose partition 1.
-     */
-    ulPartition = lCommonChoosePartition(enckeysEN_KEY_PART1,
-	    enckeysEN_KEY_PART2, enckeyENC_KEY_MAGIC, enckeyENC_KEY_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	ulAddress = enckeysEN_KEY_PART1;
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
-    {
-	ulAddress = enckeysEN_KEY_PART2;
-    }
-    /* Some error has occurred. */
-    else
+
+    /* read the encryption data from the record store */
+    lStatus = lLogstoreRead(eLOGSTORE_ENC_KEY, enckeyENC_KEY_RECORD_ID,
+	    pxENKey, sizeof(enckeysDsftEncKeys_t));
+    if(lStatus == COMMON_ERR_NO_MATCH)
     {
+	/* key was never written, callers expect no valid partition */
 	debugERROR_PRINT("No valid header partition found \r\n");
-	return ulPartition;
+	return commonPARTITIONNONE;
     }
-
-    /* read the encryption data from the flash */
-    lStatus = mml_sflc_read(ulAddress, (uint8_t *) pxENKey,
-	    sizeof(enckeysDsftEncKeys_t));
     if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("failed to read encryption key data \r\n");
@@ -374,3 +241,55 @@ int32_t lEnckeysUpdatePublicKey( uint8_t *pucPublicKey )
     return lStatus;
 }
 /*----------------------------------------------------------------------------*/
+
+int32_t lEnckeysWriteRotRsaKey( enckeysRotRsaKey_t *pxRsaKey )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+
+    if(pxRsaKey == NULL)
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    /* magic header is not known to the user */
+    pxRsaKey->ulRotRsaMagic = enckeyROT_RSA_MAGIC;
+
+    lStatus = lLogstoreWrite(eLOGSTORE_ENC_KEY, enckeyROT_RSA_RECORD_ID,
+	    pxRsaKey, sizeof(enckeysRotRsaKey_t));
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to write ROT RSA key \r\n");
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lEnckeysReadRotRsaKey( enckeysRotRsaKey_t *pxRsaKey )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+
+    if(pxRsaKey == NULL)
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    lStatus = lLogstoreRead(eLOGSTORE_ENC_KEY, enckeyROT_RSA_RECORD_ID,
+	    pxRsaKey, sizeof(enckeysRotRsaKey_t));
+    if((lStatus == COMMON_ERR_NO_MATCH) ||
+	    ((lStatus == NO_ERROR) &&
+	    (pxRsaKey->ulRotRsaMagic != enckeyROT_RSA_MAGIC)))
+    {
+	/* key was never provisioned */
+	return commonPARTITIONNONE;
+    }
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to read ROT RSA key \r\n");
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
@@ -36,349 +36,770 @@
 /* Global includes */
 #include <stdint.h>
 #include <errors.h>
+#include <mml_sflc.h>
 #include <debug.h>
 #include <printf_lite.h>
-#include <mml_sflc.h>
 #include <string.h>
+#include <stddef.h>
 
 /* Freertos includes */
 #include <FreeRTOS.h>
 #include <task.h>
+#include <semphr.h>
 #include <portable.h>
 
 /* Local includes */
 #include <hist_devtamper.h>
 #include <mem_common.h>
+#include <logstore.h>
 /* Not exposing flash.h to users */
 #include "flash.h"
 
 /**
- * tamper and clear event section magic
+ * Record ID of tamper history of earlier releases in the record store, whole
+ * structure is one record.
  */
-#define devtamperTAMPER_CLEAR_MAGIC	(0x1A39E8C1)
+#define devtamperTAMPER_HIST_RECORD_ID	(0)
 
-/*
- * Tamper and clear event section magic size.
+/**
+ * Number of pages of the event log.
  */
-#define devtamperTAMPER_CLEAR_MAGIC_SIZE (4)
+#define devtamperLOG_PAGES		(flashTAMP_HISTORY_NUM_PAGES)
 
 /**
- * device tamper partition 1 address.
+ * Number of event slots in a page.
  */
-#define devtamperDEVTAM_PART1_ADDRESS	(flashTAMP_HIST_START_ADDR)
+#define devtamperLOG_SLOTS		((flashPAGE_SIZE - \
+					sizeof(devtamperLogPageHdr_t)) / \
+					sizeof(devtamperLogEvent_t))
 
 /**
- * device tamper partition 2(backup) address.
+ * No page in use.
  */
-#define devtamperDEVTAM_PART2_ADDRESS	(devtamperDEVTAM_PART1_ADDRESS + flashPAGE_SIZE)
+#define devtamperNO_PAGE		(0xFF)
 
-#if 0
-/* To be Done */
-static uint32_t sulEraseTamperEventEntry( );
-static uint32_t sulEraseClearEventEntry( );
-#endif
+/**
+ * Value of an erased flash word.
+ */
+#define devtamperBLANK_WORD		(0xFFFFFFFFU)
 
-/** function prototypes */
+/**
+ * Page header of the event log. Slot n of a page holds event ulFirstSeq + n,
+ * so an event is found without scanning.
+ */
+typedef struct
+{
+    /** devtamperLOG_PAGE_MAGIC */
+    uint32_t ulMagic;
+    /** sequence number of the event in the first slot */
+    uint32_t ulFirstSeq;
+    /** CRC over magic and sequence */
+    uint32_t ulHdrCrc;
+} devtamperLogPageHdr_t;
 
-int32_t lDevtamperWriteTampHistory(devtamperTamperHist_t *pxDevTamHist)
+/**
+ * Run time state of the event log.
+ */
+typedef struct
+{
+    /** sequence number of first slot of each page, 0 if page is not in use */
+    uint32_t ulFirstSeq[devtamperLOG_PAGES];
+    /** slots taken in each page, including torn ones */
+    uint16_t usUsed[devtamperLOG_PAGES];
+    /** lowest event time in each page */
+    uint32_t ulMinTime[devtamperLOG_PAGES];
+    /** highest event time in each page */
+    uint32_t ulMaxTime[devtamperLOG_PAGES];
+    /** sequence number of next event */
+    uint32_t ulNextSeq;
+    /** page events are appended to */
+    uint8_t  ucActive;
+    /** log is mounted */
+    uint8_t  ucMounted;
+    /** Serializes writers */
+    SemaphoreHandle_t xLock;
+} devtamperLogState_t;
+
+/**
+ * Event log state.
+ */
+static devtamperLogState_t xDevtamperLog;
+
+/**
+ * @brief Flash address of an event slot.
+ *
+ * @param ucPage page index.
+ * @param ulSlot slot index.
+ *
+ * @return slot address.
+ */
+static uint32_t prvDevtamperSlotAddr( uint8_t ucPage, uint32_t ulSlot );
+
+/**
+ * @brief CRC of an event.
+ *
+ * @param pxEvent event.
+ *
+ * @return CRC over all the fields but ulCrc.
+ */
+static uint32_t prvDevtamperEventCrc( const devtamperLogEvent_t *pxEvent );
+
+/**
+ * @brief Page holding a sequence number.
+ *
+ * @param ulSeq sequence number.
+ *
+ * @return page index, devtamperNO_PAGE if the event is not in the log.
+ */
+static uint8_t prvDevtamperFindPage( uint32_t ulSeq );
+
+/**
+ * @brief Scans a page and sets up its state.
+ *
+ * @param ucPage page index.
+ *
+ * @return error code.
+ */
+static int32_t prvDevtamperScanPage( uint8_t ucPage );
+
+/**
+ * @brief Writes the header which makes a page part of the log.
+ *
+ * @param ucPage page index, its first sequence number set.
+ *
+ * @return error code.
+ */
+static int32_t prvDevtamperWriteHeader( uint8_t ucPage );
+
+/**
+ * @brief Erases a page and starts appending to it. Events of the erased page
+ * are dropped.
+ *
+ * @param ucPage page index.
+ * @param ucHeader write the page header now, else the caller writes it with
+ *        prvDevtamperWriteHeader() once the page content is in place.
+ *
+ * @return error code.
+ */
+static int32_t prvDevtamperFormatPage( uint8_t ucPage, uint8_t ucHeader );
+
+/**
+ * @brief Erases the page after the active one and starts appending to it.
+ * Events of the erased page are dropped.
+ *
+ * @return error code.
+ */
+static int32_t prvDevtamperOpenPage( void );
+
+/**
+ * @brief Appends an event.
+ *
+ * @param ucType event type.
+ * @param ulTime RTC seconds of occurrence.
+ * @param ulCause cause of tamper.
+ * @param ucLock take the log mutex.
+ *
+ * @return error code.
+ */
+static int32_t prvDevtamperAppend( uint8_t ucType, uint32_t ulTime,
+	uint32_t ulCause, uint8_t ucLock );
+
+/**
+ * @brief Imports the tamper history of earlier releases and formats the log.
+ *
+ * The log starts in a page not holding the old record. Its header is written
+ * once the imported event reads back, and the old record is erased after
+ * that, so a power off at any point leaves either the log or the old record
+ * for the next boot.
+ *
+ * @return error code.
+ */
+static int32_t prvDevtamperImport( void );
+
+/** function definition */
+
+static uint32_t prvDevtamperSlotAddr( uint8_t ucPage, uint32_t ulSlot )
+{
+    return flashTAMP_HIST_START_ADDR + ((uint32_t) ucPage * flashPAGE_SIZE) +
+	    sizeof(devtamperLogPageHdr_t) +
+	    (ulSlot * sizeof(devtamperLogEvent_t));
+}
+/*----------------------------------------------------------------------------*/
+
+static uint32_t prvDevtamperEventCrc( const devtamperLogEvent_t *pxEvent )
+{
+    return ulCommonCrc32(0, (const uint8_t *) pxEvent,
+	    offsetof(devtamperLogEvent_t, ulCrc));
+}
+/*----------------------------------------------------------------------------*/
+
+static uint8_t prvDevtamperFindPage( uint32_t ulSeq )
+{
+    /* index of page */
+    uint8_t ucPage = 0;
+
+    for(ucPage = 0; ucPage < devtamperLOG_PAGES; ucPage++)
+    {
+	if((xDevtamperLog.ulFirstSeq[ucPage] != 0) &&
+		(ulSeq >= xDevtamperLog.ulFirstSeq[ucPage]) &&
+		(ulSeq < (xDevtamperLog.ulFirstSeq[ucPage] +
+			xDevtamperLog.usUsed[ucPage])))
+	{
+	    return ucPage;
+	}
+    }
+    return devtamperNO_PAGE;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvDevtamperScanPage( uint8_t ucPage )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
-    /* First we need to check if the pointer passed by the user is valid and
-     * not NULL.
-     */
-    if(pxDevTamHist == NULL)
+    /* page header */
+    devtamperLogPageHdr_t xHdr;
+    /* event read */
+    devtamperLogEvent_t xEvent;
+    /* index of slot */
+    uint32_t ulSlot = 0;
+    /* index of word */
+    uint32_t ulWord = 0;
+    /* words of event */
+    const uint32_t *pulWord = (const uint32_t *) &xEvent;
+
+    xDevtamperLog.ulFirstSeq[ucPage] = 0;
+    xDevtamperLog.usUsed[ucPage] = 0;
+    xDevtamperLog.ulMinTime[ucPage] = devtamperBLANK_WORD;
+    xDevtamperLog.ulMaxTime[ucPage] = 0;
+
+    lStatus = mml_sflc_read(flashTAMP_HIST_START_ADDR +
+	    ((uint32_t) ucPage * flashPAGE_SIZE), (uint8_t *) &xHdr,
+	    sizeof(xHdr));
+    if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("Invalid argument \n");
-	return COMMON_ERR_NULL_PTR;
+	return lStatus;
     }
-    /* Devtamper history structure for backup */
-    devtamperTamperHist_t *pxBackUpdevtamper = NULL;
-    /* allocate dynamic memory */
-    pxBackUpdevtamper = (devtamperTamperHist_t *) pvPortMalloc(
-	    sizeof(devtamperTamperHist_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpdevtamper == NULL)
+    if((xHdr.ulMagic != devtamperLOG_PAGE_MAGIC) || (xHdr.ulFirstSeq == 0) ||
+	    (xHdr.ulHdrCrc != ulCommonCrc32(0, (const uint8_t *) &xHdr,
+		    offsetof(devtamperLogPageHdr_t, ulHdrCrc))))
     {
-	debugERROR_PRINT(
-		"Failed to allocate memory for devtamper history entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
+	/* not a log page, or header torn by power off */
+	return NO_ERROR;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpdevtamper, commonDEFAULT_VALUE, sizeof(devtamperTamperHist_t));
+    xDevtamperLog.ulFirstSeq[ucPage] = xHdr.ulFirstSeq;
 
-    /* We need to check which partition has a valid data, based on valid magic
-     * number. If both partition does not have valid magic number than, data
-     * will be written to partition 1.
-     */
-    ulPartition = lCommonChoosePartition(devtamperDEVTAM_PART1_ADDRESS,
-	    devtamperDEVTAM_PART2_ADDRESS, devtamperTAMPER_CLEAR_MAGIC,
-	    devtamperTAMPER_CLEAR_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	/* assuming partition 1 has latest updated data, copy the partition 1
-	 * data to backup structure.
-	 */
-	lStatus = lDevtamperReadTampHistory(pxBackUpdevtamper);
+    /* slots are taken in order, first blank one ends the page */
+    for(ulSlot = 0; ulSlot < devtamperLOG_SLOTS; ulSlot++)
+    {
+	lStatus = mml_sflc_read(prvDevtamperSlotAddr(ucPage, ulSlot),
+		(uint8_t *) &xEvent, sizeof(xEvent));
 	if(lStatus != NO_ERROR)
 	{
-	    debugERROR_PRINT("failed to back up device tamper data \r\n");
-	    goto CLEANUP;
+	    return lStatus;
+	}
+	for(ulWord = 0; ulWord < (sizeof(xEvent) / sizeof(uint32_t));
+		ulWord++)
+	{
+	    if(pulWord[ulWord] != devtamperBLANK_WORD)
+	    {
+		break;
+	    }
+	}
+	if(ulWord == (sizeof(xEvent) / sizeof(uint32_t)))
+	{
+	    break;
 	}
-	/* Now write primary partition data to backup partition */
-	/* Before writing flash scheduler and interrupts should be disabled,
-	 * once the write is done,then both can be enabled
-	 */
-	/* Commenting suspend and resume scheduler since, it is observed
-	 * Flash hangs sometimes because of this. Please revisit the same
-	 * if required.
-	 */
-	taskENTER_CRITICAL();
-	/* vTaskSuspendAll(); */
-	lStatus = lCommonUpdatePartition(devtamperDEVTAM_PART2_ADDRESS,
-		sizeof(devtamperTamperHist_t),
-		(uint8_t *) pxBackUpdevtamper,
-		devtamperTAMPER_CLEAR_MAGIC, devtamperTAMPER_CLEAR_MAGIC_SIZE);
-	/* xTaskResumeAll(); */
-	taskEXIT_CRITICAL();
-        if(lStatus != NO_ERROR)
+	/* torn slot still takes its sequence number */
+	xDevtamperLog.usUsed[ucPage] = ulSlot + 1;
+	if((xEvent.ulSeq == (xHdr.ulFirstSeq + ulSlot)) &&
+		(xEvent.ulCrc == prvDevtamperEventCrc(&xEvent)))
 	{
-	     debugERROR_PRINT("failed to update backup device tamper data \r\n");
-	     goto CLEANUP;
+	    if(xEvent.ulTime < xDevtamperLog.ulMinTime[ucPage])
+	    {
+		xDevtamperLog.ulMinTime[ucPage] = xEvent.ulTime;
+	    }
+	    if(xEvent.ulTime > xDevtamperLog.ulMaxTime[ucPage])
+	    {
+		xDevtamperLog.ulMaxTime[ucPage] = xEvent.ulTime;
+	    }
 	}
     }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvDevtamperWriteHeader( uint8_t ucPage )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* page header */
+    devtamperLogPageHdr_t xHdr;
+    /* page address */
+    uint32_t ulAddress = 0;
+
+    ulAddress = flashTAMP_HIST_START_ADDR + ((uint32_t) ucPage * flashPAGE_SIZE);
+    xHdr.ulMagic = devtamperLOG_PAGE_MAGIC;
+    xHdr.ulFirstSeq = xDevtamperLog.ulFirstSeq[ucPage];
+    xHdr.ulHdrCrc = ulCommonCrc32(0, (const uint8_t *) &xHdr,
+	    offsetof(devtamperLogPageHdr_t, ulHdrCrc));
+    lStatus = mml_sflc_write(ulAddress, (uint8_t *) &xHdr, sizeof(xHdr));
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to format page 0x%x \r\n", ulAddress);
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvDevtamperFormatPage( uint8_t ucPage, uint8_t ucHeader )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* page address */
+    uint32_t ulAddress = 0;
+
+    ulAddress = flashTAMP_HIST_START_ADDR + ((uint32_t) ucPage * flashPAGE_SIZE);
+
+    /* oldest events go */
+    xDevtamperLog.ulFirstSeq[ucPage] = 0;
+    xDevtamperLog.usUsed[ucPage] = 0;
+    xDevtamperLog.ulMinTime[ucPage] = devtamperBLANK_WORD;
+    xDevtamperLog.ulMaxTime[ucPage] = 0;
+    lStatus = mml_sflc_erase(ulAddress, flashPAGE_SIZE);
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to erase page 0x%x \r\n", ulAddress);
+	return lStatus;
+    }
+
+    xDevtamperLog.ulFirstSeq[ucPage] = xDevtamperLog.ulNextSeq;
+    if(ucHeader)
     {
-	/* Backup Partition has valid magic header, this can occur in case where
-	 * there was power off while writing primary partition. we don't need to
-	 * restore the same for primary partition because we will be writing the
-	 * latest data given by user to primary partition. Also in case if user
-	 * does not write latest data to primary partition, while reading data
-	 * will be read from secondary partition.
-	 */
-	/* Do nothing for this else if */
+	lStatus = prvDevtamperWriteHeader(ucPage);
+	if(lStatus != NO_ERROR)
+	{
+	    xDevtamperLog.ulFirstSeq[ucPage] = 0;
+	    return lStatus;
+	}
     }
-    /* check if both the partition does not have valid header */
-    else if (ulPartition == commonPARTITIONNONE)
+    xDevtamperLog.ucActive = ucPage;
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvDevtamperOpenPage( void )
+{
+    /* page to open */
+    uint8_t ucPage = 0;
+
+    if(xDevtamperLog.ucActive != devtamperNO_PAGE)
     {
-	/* Both partitions does not have valid data, inform user but,
-	 * don't return. Update latest user data to primary partition.
-	 */
-	debugPRINT("Both partition does not have valid header \r\n");
+	ucPage = (xDevtamperLog.ucActive + 1) % devtamperLOG_PAGES;
     }
-    /* Some error has occurred. */
-    else
+    return prvDevtamperFormatPage(ucPage, 1);
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvDevtamperAppend( uint8_t ucType, uint32_t ulTime,
+	uint32_t ulCause, uint8_t ucLock )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* event to append */
+    devtamperLogEvent_t xEvent;
+    /* active page */
+    uint8_t ucPage = 0;
+
+    if(!xDevtamperLog.ucMounted)
     {
-	debugERROR_PRINT("failed to choose partition \r\n");
-	/* update the error code */
-	lStatus = ulPartition;
-	goto CLEANUP;
+	return COMMON_ERR_NOT_INITIALIZED;
     }
 
-    /* Before writing the user data we must update the magic header because user
-     * is not aware of it.
-     */
-    pxDevTamHist->ulKeyTamperMagic = devtamperTAMPER_CLEAR_MAGIC;
+    if(ucLock)
+    {
+	xSemaphoreTake(xDevtamperLog.xLock, portMAX_DELAY);
+    }
 
-    /* Now update the primary partition with latest data given by the user*/
-    /* Before writing flash scheduler and interrupts should be disabled,
-     * once the write is done,then both can be enabled
-     */
-    /* Commenting suspend and resume scheduler since, it is observed
-     * Flash hangs sometimes because of this. Please revisit the same
-     * if required.
+    if((xDevtamperLog.ucActive == devtamperNO_PAGE) ||
+	    (xDevtamperLog.usUsed[xDevtamperLog.ucActive] >=
+		    devtamperLOG_SLOTS))
+    {
+	lStatus = prvDevtamperOpenPage();
+	if(lStatus != NO_ERROR)
+	{
+	    goto UNLOCK;
+	}
+    }
+    ucPage = xDevtamperLog.ucActive;
+
+    memset(&xEvent, 0, sizeof(xEvent));
+    xEvent.ulSeq = xDevtamperLog.ulNextSeq;
+    xEvent.ulTime = ulTime;
+    xEvent.ulCause = ulCause;
+    xEvent.ucType = ucType;
+    xEvent.ulCrc = prvDevtamperEventCrc(&xEvent);
+
+    /* slot is taken even if programming fails, sequence stays in step with
+     * the slot.
      */
-    taskENTER_CRITICAL();
-    /* vTaskSuspendAll(); */
-    lStatus = lCommonUpdatePartition(devtamperDEVTAM_PART1_ADDRESS,
-	    sizeof(devtamperTamperHist_t), (uint8_t *) pxDevTamHist,
-	    devtamperTAMPER_CLEAR_MAGIC, devtamperTAMPER_CLEAR_MAGIC_SIZE);
-    /* xTaskResumeAll(); */
-    taskEXIT_CRITICAL();
+    lStatus = mml_sflc_write(prvDevtamperSlotAddr(ucPage,
+	    xDevtamperLog.usUsed[ucPage]), (uint8_t *) &xEvent, sizeof(xEvent));
+    xDevtamperLog.usUsed[ucPage]++;
+    xDevtamperLog.ulNextSeq++;
     if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("failed to write device tamper Data \r\n");
-	goto CLEANUP;
+	debugERROR_PRINT("failed to write tamper event %d \r\n", xEvent.ulSeq);
+	goto UNLOCK;
+    }
+    if(ulTime < xDevtamperLog.ulMinTime[ucPage])
+    {
+	xDevtamperLog.ulMinTime[ucPage] = ulTime;
+    }
+    if(ulTime > xDevtamperLog.ulMaxTime[ucPage])
+    {
+	xDevtamperLog.ulMaxTime[ucPage] = ulTime;
     }
 
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpdevtamper)
+    UNLOCK:
+    if(ucLock)
     {
-	vPortFree(pxBackUpdevtamper);
+	xSemaphoreGive(xDevtamperLog.xLock);
     }
-    /* return the error code */
     return lStatus;
 }
 /*----------------------------------------------------------------------------*/
 
-int32_t lDevtamperWriteTampHistoryNONRTOS(devtamperTamperHist_t *pxDevTamHist)
+static int32_t prvDevtamperImport( void )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
-    /* First we need to check if the pointer passed by the user is valid and
-     * not NULL.
-     */
+    /* tamper history of earlier releases */
+    devtamperTamperHist_t *pxDevTamHist = NULL;
+    /* imported event read back */
+    devtamperLogEvent_t xEvent;
+    /* address of the old record */
+    uint32_t ulRecAddr = 0;
+    /* index of page */
+    uint8_t ucPage = 0;
+    /* page the log starts in */
+    uint8_t ucFirst = 0;
+    /* history found */
+    uint8_t ucFound = 0;
+
+    pxDevTamHist = (devtamperTamperHist_t *) pvPortMalloc(
+	    sizeof(devtamperTamperHist_t));
     if(pxDevTamHist == NULL)
     {
-	debugERROR_PRINT("Invalid argument \n");
+	debugERROR_PRINT("Failed to allocate memory for import \r\n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* Devtamper history structure for backup */
-    devtamperTamperHist_t *pxBackUpdevtamper = NULL;
-    /* allocate dynamic memory */
-    pxBackUpdevtamper = (devtamperTamperHist_t *) pvPortMalloc(
-	    sizeof(devtamperTamperHist_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpdevtamper == NULL)
+
+    /* record store has already imported the old A/B partition format */
+    lStatus = lLogstoreRead(eLOGSTORE_TAMP_HIST, devtamperTAMPER_HIST_RECORD_ID,
+	    pxDevTamHist, sizeof(devtamperTamperHist_t));
+    if((lStatus == NO_ERROR) &&
+	    (pxDevTamHist->ulKeyTamperMagic == devtamperTAMPER_CLEAR_MAGIC) &&
+	    (pxDevTamHist->xTamperEvent[0].ulEventTyype ==
+		    devtamperEVENT_TAMPER))
     {
-	debugERROR_PRINT(
-		"Failed to allocate memory for devtamper history entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
+	ucFound = 1;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpdevtamper, commonDEFAULT_VALUE, sizeof(devtamperTamperHist_t));
 
-    /* We need to check which partition has a valid data, based on valid magic
-     * number. If both partition does not have valid magic number than, data
-     * will be written to partition 1.
-     */
-    ulPartition = lCommonChoosePartition(devtamperDEVTAM_PART1_ADDRESS,
-	    devtamperDEVTAM_PART2_ADDRESS, devtamperTAMPER_CLEAR_MAGIC,
-	    devtamperTAMPER_CLEAR_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	/* assuming partition 1 has latest updated data, copy the partition 1
-	 * data to backup structure.
-	 */
-	lStatus = lDevtamperReadTampHistory(pxBackUpdevtamper);
+    /* start the log in a page not holding the old record */
+    if(lLogstoreGetRecordAddr(eLOGSTORE_TAMP_HIST,
+	    devtamperTAMPER_HIST_RECORD_ID, &ulRecAddr) == NO_ERROR)
+    {
+	ucFirst = (uint8_t) (((ulRecAddr - flashTAMP_HIST_START_ADDR) /
+		flashPAGE_SIZE + 1) % devtamperLOG_PAGES);
+    }
+    lStatus = prvDevtamperFormatPage(ucFirst, 0);
+    if(lStatus != NO_ERROR)
+    {
+	goto CLEANUP;
+    }
+    xDevtamperLog.ucMounted = 1;
+
+    if(ucFound)
+    {
+	debugPRINT("importing tamper history \r\n");
+	lStatus = prvDevtamperAppend(devtamperEVENT_TAMPER,
+		pxDevTamHist->xTamperEvent[0].ulDRSLogRTC,
+		pxDevTamHist->xTamperEvent[0].ultamperCause, 0);
+	if(lStatus != NO_ERROR)
+	{
+	    goto CLEANUP;
+	}
+	lStatus = mml_sflc_read(prvDevtamperSlotAddr(ucFirst, 0),
+		(uint8_t *) &xEvent, sizeof(xEvent));
 	if(lStatus != NO_ERROR)
 	{
-	    debugERROR_PRINT("failed to back up device tamper data \r\n");
 	    goto CLEANUP;
 	}
-	/* Now write primary partition data to backup partition */
-	lStatus = lCommonUpdatePartition(devtamperDEVTAM_PART2_ADDRESS,
-		sizeof(devtamperTamperHist_t),
-		(uint8_t *) pxBackUpdevtamper,
-		devtamperTAMPER_CLEAR_MAGIC, devtamperTAMPER_CLEAR_MAGIC_SIZE);
-        if(lStatus != NO_ERROR)
+	if((xEvent.ulSeq != xDevtamperLog.ulFirstSeq[ucFirst]) ||
+		(xEvent.ulCrc != prvDevtamperEventCrc(&xEvent)) ||
+		(xEvent.ulTime != pxDevTamHist->xTamperEvent[0].ulDRSLogRTC) ||
+		(xEvent.ulCause != pxDevTamHist->xTamperEvent[0].ultamperCause))
 	{
-	     debugERROR_PRINT("failed to update backup device tamper data \r\n");
-	     goto CLEANUP;
+	    /* old record is kept, import runs again on next boot */
+	    debugERROR_PRINT("imported tamper event does not read back \r\n");
+	    lStatus = COMMON_ERR_BAD_STATE;
+	    goto CLEANUP;
 	}
     }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
+
+    /* page is part of the log from here on */
+    lStatus = prvDevtamperWriteHeader(ucFirst);
+    if(lStatus != NO_ERROR)
     {
-	/* Backup Partition has valid magic header, this can occur in case where
-	 * there was power off while writing primary partition. we don't need to
-	 * restore the same for primary partition because we will be writing the
-	 * latest data given by user to primary partition. Also in case if user
-	 * does not write latest data to primary partition, while reading data
-	 * will be read from secondary partition.
-	 */
-	/* Do nothing for this else if */
+	goto CLEANUP;
     }
-    /* check if both the partition does not have valid header */
-    else if (ulPartition == commonPARTITIONNONE)
+
+    /* remaining pages are taken over by the log */
+    for(ucPage = 0; ucPage < devtamperLOG_PAGES; ucPage++)
     {
-	/* Both partitions does not have valid data, inform user but,
-	 * don't return. Update latest user data to primary partition.
-	 */
-	debugPRINT("Both partition does not have valid header \r\n");
+	if(ucPage == ucFirst)
+	{
+	    continue;
+	}
+	lStatus = mml_sflc_erase(flashTAMP_HIST_START_ADDR +
+		((uint32_t) ucPage * flashPAGE_SIZE), flashPAGE_SIZE);
+	if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("failed to erase tamper history \r\n");
+	    goto CLEANUP;
+	}
     }
-    /* Some error has occurred. */
-    else
+
+    /* clean up the allocated memory before returning error */
+    CLEANUP:
+    vPortFree(pxDevTamHist);
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lDevtamperLogInit( void )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* index of page */
+    uint8_t ucPage = 0;
+
+    if(xDevtamperLog.xLock == NULL)
     {
-	debugERROR_PRINT("failed to choose partition \r\n");
-	/* update the error code */
-	lStatus = ulPartition;
-	goto CLEANUP;
+	xDevtamperLog.xLock = xSemaphoreCreateMutex();
+	if(xDevtamperLog.xLock == NULL)
+	{
+	    debugERROR_PRINT("Failed to create tamper log mutex \r\n");
+	    return COMMON_ERR_NULL_PTR;
+	}
     }
+    xDevtamperLog.ucMounted = 0;
+    xDevtamperLog.ucActive = devtamperNO_PAGE;
+    xDevtamperLog.ulNextSeq = 1;
 
-    /* Before writing the user data we must update the magic header because user
-     * is not aware of it.
-     */
-    pxDevTamHist->ulKeyTamperMagic = devtamperTAMPER_CLEAR_MAGIC;
-
-    /* Now update the primary partition with latest data given by the user*/
-    lStatus = lCommonUpdatePartition(devtamperDEVTAM_PART1_ADDRESS,
-	    sizeof(devtamperTamperHist_t), (uint8_t *) pxDevTamHist,
-	    devtamperTAMPER_CLEAR_MAGIC, devtamperTAMPER_CLEAR_MAGIC_SIZE);
-    if(lStatus != NO_ERROR)
+    /* newest page is the one with highest first sequence */
+    for(ucPage = 0; ucPage < devtamperLOG_PAGES; ucPage++)
     {
-	debugERROR_PRINT("failed to write device tamper Data \r\n");
-	goto CLEANUP;
+	lStatus = prvDevtamperScanPage(ucPage);
+	if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("Failed to scan tamper log \r\n");
+	    return lStatus;
+	}
+	if((xDevtamperLog.ulFirstSeq[ucPage] != 0) &&
+		((xDevtamperLog.ucActive == devtamperNO_PAGE) ||
+		 (xDevtamperLog.ulFirstSeq[ucPage] >
+		  xDevtamperLog.ulFirstSeq[xDevtamperLog.ucActive])))
+	{
+	    xDevtamperLog.ucActive = ucPage;
+	}
     }
 
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpdevtamper)
+    if(xDevtamperLog.ucActive == devtamperNO_PAGE)
     {
-	vPortFree(pxBackUpdevtamper);
+	return prvDevtamperImport();
     }
-    /* return the error code */
-    return lStatus;
+    xDevtamperLog.ulNextSeq =
+	    xDevtamperLog.ulFirstSeq[xDevtamperLog.ucActive] +
+	    xDevtamperLog.usUsed[xDevtamperLog.ucActive];
+    xDevtamperLog.ucMounted = 1;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lDevtamperLogAppend( uint8_t ucType, uint32_t ulTime,
+	uint32_t ulCause )
+{
+    return prvDevtamperAppend(ucType, ulTime, ulCause, 1);
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lDevtamperLogAppendNONRTOS( uint8_t ucType, uint32_t ulTime,
+	uint32_t ulCause )
+{
+    return prvDevtamperAppend(ucType, ulTime, ulCause, 0);
 }
 /*----------------------------------------------------------------------------*/
 
-int32_t lDevtamperReadTampHistory(devtamperTamperHist_t *pxDevTamHist)
+int32_t lDevtamperLogRead( uint32_t ulSeq, devtamperLogEvent_t *pxEvent )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
-    /* address to write data */
-    uint32_t ulAddress = 0;
-    /* First we need to check if the pointer passed by the user is valid and
-     * not NULL.
-     */
-    if(pxDevTamHist == NULL)
+    /* page holding the event */
+    uint8_t ucPage = 0;
+
+    if(pxEvent == NULL)
     {
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* We need to check if data needs to be written to partition 1 or 2
-     * based on the valid magic number. If both partition does not have valid
-     * magic number than choose partition 1.
+    if(!xDevtamperLog.ucMounted)
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    ucPage = prvDevtamperFindPage(ulSeq);
+    if(ucPage == devtamperNO_PAGE)
+    {
+	return COMMON_ERR_NO_MATCH;
+    }
+
+    /* No lock taken, a writer can drop the page while it is being read.
+     * Sequence number and CRC tell if what was read is the event.
      */
-    ulPartition = lCommonChoosePartition(devtamperDEVTAM_PART1_ADDRESS,
-	    devtamperDEVTAM_PART2_ADDRESS, devtamperTAMPER_CLEAR_MAGIC,
-	    devtamperTAMPER_CLEAR_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
+    lStatus = mml_sflc_read(prvDevtamperSlotAddr(ucPage,
+	    ulSeq - xDevtamperLog.ulFirstSeq[ucPage]), (uint8_t *) pxEvent,
+	    sizeof(devtamperLogEvent_t));
+    if(lStatus != NO_ERROR)
     {
-	ulAddress = devtamperDEVTAM_PART1_ADDRESS;
+	return lStatus;
+    }
+    if((pxEvent->ulSeq != ulSeq) ||
+	    (pxEvent->ulCrc != prvDevtamperEventCrc(pxEvent)))
+    {
+	debugERROR_PRINT("tamper event %d CRC error \r\n", ulSeq);
+	return COMMON_ERR_BAD_STATE;
     }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lDevtamperLogFindTime( uint32_t ulSeq, uint32_t ulFrom, uint32_t ulTo,
+	uint32_t *pulSeq )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* log range */
+    devtamperLogInfo_t xInfo;
+    /* event read */
+    devtamperLogEvent_t xEvent;
+    /* page holding the event */
+    uint8_t ucPage = 0;
+
+    if(pulSeq == NULL)
     {
-	ulAddress = devtamperDEVTAM_PART2_ADDRESS;
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
     }
-    /* Some error has occurred. */
-    else
+    lStatus = lDevtamperLogGetInfo(&xInfo);
+    if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("No valid header partition found \r\n");
-	return ulPartition;
+	return lStatus;
     }
 
-    /* read the manufacture data from the flash */
-    lStatus = mml_sflc_read(ulAddress, (uint8_t *) pxDevTamHist,
-	    sizeof(devtamperTamperHist_t));
+    /* dropped events are skipped */
+    if(ulSeq < xInfo.ulFirstSeq)
+    {
+	ulSeq = xInfo.ulFirstSeq;
+    }
+    while(ulSeq < xInfo.ulNextSeq)
+    {
+	ucPage = prvDevtamperFindPage(ulSeq);
+	if(ucPage == devtamperNO_PAGE)
+	{
+	    /* page dropped by a writer meanwhile */
+	    break;
+	}
+	if((xDevtamperLog.ulMaxTime[ucPage] < ulFrom) ||
+		(xDevtamperLog.ulMinTime[ucPage] > ulTo))
+	{
+	    /* nothing of the range in this page */
+	    ulSeq = xDevtamperLog.ulFirstSeq[ucPage] +
+		    xDevtamperLog.usUsed[ucPage];
+	    continue;
+	}
+	if((lDevtamperLogRead(ulSeq, &xEvent) == NO_ERROR) &&
+		(xEvent.ulTime >= ulFrom) && (xEvent.ulTime <= ulTo))
+	{
+	    *pulSeq = ulSeq;
+	    return NO_ERROR;
+	}
+	ulSeq++;
+    }
+    return COMMON_ERR_NO_MATCH;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lDevtamperLogGetLast( uint8_t ucType, devtamperLogEvent_t *pxEvent )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* log range */
+    devtamperLogInfo_t xInfo;
+    /* sequence number */
+    uint32_t ulSeq = 0;
+
+    if(pxEvent == NULL)
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    lStatus = lDevtamperLogGetInfo(&xInfo);
     if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("failed to read device tamper data \r\n");
 	return lStatus;
     }
-    /* return the error code */
-    return lStatus;
+
+    /* newest first */
+    for(ulSeq = xInfo.ulNextSeq; ulSeq > xInfo.ulFirstSeq; ulSeq--)
+    {
+	if((lDevtamperLogRead(ulSeq - 1, pxEvent) == NO_ERROR) &&
+		(pxEvent->ucType == ucType))
+	{
+	    return NO_ERROR;
+	}
+    }
+    return COMMON_ERR_NO_MATCH;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lDevtamperLogGetInfo( devtamperLogInfo_t *pxInfo )
+{
+    /* index of page */
+    uint8_t ucPage = 0;
+
+    if(pxInfo == NULL)
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    if(!xDevtamperLog.ucMounted)
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    pxInfo->ulNextSeq = xDevtamperLog.ulNextSeq;
+    pxInfo->ulFirstSeq = xDevtamperLog.ulNextSeq;
+    for(ucPage = 0; ucPage < devtamperLOG_PAGES; ucPage++)
+    {
+	if((xDevtamperLog.ulFirstSeq[ucPage] != 0) &&
+		(xDevtamperLog.ulFirstSeq[ucPage] < pxInfo->ulFirstSeq))
+	{
+	    pxInfo->ulFirstSeq = xDevtamperLog.ulFirstSeq[ucPage];
+	}
+    }
+    /* active page may have just been started */
+    pxInfo->ulCapacity = devtamperLOG_SLOTS * (devtamperLOG_PAGES - 1);
+    return NO_ERROR;
 }
 /*----------------------------------------------------------------------------*/
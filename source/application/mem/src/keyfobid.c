@@ -38,7 +38,6 @@
 #include <errors.h>
 #include <debug.h>
 #include <printf_lite.h>
-#include <mml_sflc.h>
 #include <string.h>
 
 /* Freertos includes */
@@ -49,24 +48,131 @@
 /* Local include */
 #include <keyfobid.h>
 #include <mem_common.h>
-/* Not exposing flash.h to users */
-#include "flash.h"
+#include <logstore.h>
+
+/** Macros */
+
+/**
+ * buckets in each lookup hash table of keyfob index, must be power of two
+ * and more than keyfobidMAX_KEFOB_ENTRIES
+ */
+#define keyfobidHASH_BUCKETS		(16)
+
+/**
+ * empty hash bucket
+ */
+#define keyfobidHASH_EMPTY		(0xFF)
+
+/**
+ * FNV-1a hash parameters for key name
+ */
+#define keyfobidFNV_OFFSET		(0x811C9DC5U)
+#define keyfobidFNV_PRIME		(0x01000193U)
+
+/**
+ * multiplier for hash of keyfobID, golden ratio
+ */
+#define keyfobidID_HASH_MUL		(0x9E3779B1U)
+
+/**
+ * @brief RAM index of keyfob table.
+ *
+ * Holds only what is needed to locate a key, keys stay in flash.
+ */
+typedef struct
+{
+    /** index matches keyfob table in flash */
+    uint8_t	ucValid;
+    /** slot holds a valid key */
+    uint8_t	ucUsed[keyfobidMAX_KEFOB_ENTRIES];
+    /** KeyFob name length of slot */
+    uint8_t	ucNameLen[keyfobidMAX_KEFOB_ENTRIES];
+    /** KeyFob name of slot */
+    uint8_t	ucKeyName[keyfobidMAX_KEFOB_ENTRIES][keyfobidNAME_LEN];
+    /** KeyFob identification of slot */
+    uint32_t	ulKeyFobId[keyfobidMAX_KEFOB_ENTRIES];
+    /** slots hashed by name, open addressing */
+    uint8_t	ucByName[keyfobidHASH_BUCKETS];
+    /** slots hashed by keyfobID, open addressing */
+    uint8_t	ucById[keyfobidHASH_BUCKETS];
+} keyfobidIndex_t;
+
+/** Global variables */
+
+/**
+ * RAM index of keyfob table
+ */
+static keyfobidIndex_t gxKeyfobidIndex;
+
+/**
+ * generation of keyfob table, changes on every update of the table
+ */
+static volatile uint32_t gulKeyfobidGeneration;
+
+/** static function declaration */
+
+/**
+ * @brief Hash key name.
+ *
+ * @param pucKeyName key name.
+ * @param ucKeyLen length of key name.
+ *
+ * @return hash bucket.
+ */
+static uint8_t prvKeyfobidHashName( const uint8_t *pucKeyName,
+	uint8_t ucKeyLen );
 
 /**
- * Size of magic header.
+ * @brief Hash keyfobID.
+ *
+ * @param ulKeyFobId keyfobid value.
+ *
+ * @return hash bucket.
  */
-#define keyfobidKEYFOB_ID_MAGIC_SIZE	(4)
+static uint8_t prvKeyfobidHashId( uint32_t ulKeyFobId );
 
 /**
- * Keyfob partition 1 address.
+ * @brief Fill hash tables from the slots of index.
+ *
+ * Should be called with index locked.
+ *
+ * @param pxIndex index to rehash.
+ *
+ * @return void.
  */
-#define keyfobidKEYFOB_PART1_ADDRESS	(flashKEYFOB_ID_START_ADDR)
+static void prvKeyfobidIndexRehash( keyfobidIndex_t *pxIndex );
 
 /**
- * Keyfob partition 2(backup) address. Partition 1, plus 2 page size because
- * the size of keyfob entry structure is 2 pages(please refer flash.h).
+ * @brief Set or clear a slot of index.
+ *
+ * Should be called with index locked.
+ *
+ * @param pxIndex index to update.
+ * @param ucIndex slot to update.
+ * @param pxKeyInfo key stored in slot, NULL if slot is free.
+ *
+ * @return void.
  */
-#define keyfobidKEYFOB_PART2_ADDRESS	(keyfobidKEYFOB_PART1_ADDRESS + (flashPAGE_SIZE * 2))
+static void prvKeyfobidIndexSlot( keyfobidIndex_t *pxIndex, uint8_t ucIndex,
+	const keyfobidKeyFobInfo_t *pxKeyInfo );
+
+/**
+ * @brief Update index after a slot is written to flash.
+ *
+ * @param ucIndex slot written.
+ * @param pxKeyInfo key stored in slot, NULL if slot is freed.
+ *
+ * @return void.
+ */
+static void prvKeyfobidIndexUpdate( uint8_t ucIndex,
+	const keyfobidKeyFobInfo_t *pxKeyInfo );
+
+/**
+ * @brief Build index from flash, if it is not valid.
+ *
+ * @return error code.
+ */
+static int32_t prvKeyfobidIndexLoad( void );
 
 /** function definition */
 
@@ -74,8 +180,10 @@ int32_t lKeyfobidWriteKeyFobEntry(keyfobidKeyFobEntry_t *pxKeyFobEntry)
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
+    /* Index for keyfob info */
+    uint8_t ucIndex = 0;
+    /* slot is present in flash */
+    uint8_t ucStored = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -84,122 +192,85 @@ int32_t lKeyfobidWriteKeyFobEntry(keyfobidKeyFobEntry_t *pxKeyFobEntry)
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* Keyfob entry structure for backup */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
+    /* Keyfob info currently stored in flash */
+    keyfobidKeyFobInfo_t *pxStoredInfo = NULL;
     /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
+    pxStoredInfo = (keyfobidKeyFobInfo_t *) pvPortMalloc(
+	    sizeof(keyfobidKeyFobInfo_t));
     /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
+    if(pxStoredInfo == NULL)
     {
 	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
+		"Failed to allocate memory for keyfob info structure \r\n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
-
-    /* We need to check which partition has a valid data, based on valid magic
-     * number. If both partition does not have valid magic number than, data
-     * will be written to partition 1.
-     */
-    ulPartition = lCommonChoosePartition(keyfobidKEYFOB_PART1_ADDRESS,
-	    keyfobidKEYFOB_PART2_ADDRESS, keyfobidKEYFOB_ID_MAGIC,
-	    keyfobidKEYFOB_ID_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	/* assuming partition 1 has latest updated data, copy the partition 1
-	 * data to backup structure.
-	 */
-	lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
-	if(lStatus != NO_ERROR)
-	{
-	    debugERROR_PRINT("failed to back up keyfob data \r\n");
-	    goto CLEANUP;
-	}
-	/* Now write primary partition data to backup partition */
-	/* Before writing flash scheduler and interrupts should be disabled,
-	 * once the write is done,then both can be enabled
-	 */
-	/* Commenting suspend and resume scheduler since, it is observed
-	 * Flash hangs sometimes because of this. Please revisit the same
-	 * if required.
-	 */
-	taskENTER_CRITICAL();
-	/* vTaskSuspendAll(); */
-	lStatus = lCommonUpdatePartition(keyfobidKEYFOB_PART2_ADDRESS,
-		sizeof(keyfobidKeyFobEntry_t),
-		(uint8_t *) pxBackUpKeyfobData, keyfobidKEYFOB_ID_MAGIC,
-		keyfobidKEYFOB_ID_MAGIC_SIZE);
-	/* xTaskResumeAll(); */
-	taskEXIT_CRITICAL();
-        if(lStatus != NO_ERROR)
-	{
-	     debugERROR_PRINT("failed to update backup partition \r\n");
-	     goto CLEANUP;
-	}
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
-    {
-	/* Backup Partition has valid magic header, this can occur in case where
-	 * there was power off while writing primary partition. we don't need to
-	 * restore the same for primary partition because we will be writing the
-	 * latest data given by user to primary partition. Also in case if user
-	 * does not write latest data to primary partition, while reading data
-	 * will be read from secondary partition.
-	 */
-	/* Do nothing for this else if */
-    }
-    /* check if both the partition does not have valid header */
-    else if (ulPartition == commonPARTITIONNONE)
-    {
-	/* Both partitions does not have valid data, inform user but,
-	 * don't return. Update latest user data to primary partition.
-	 */
-	debugPRINT("Both partition does not have valid header \r\n");
-    }
-    /* Some error has occurred. */
-    else
-    {
-	debugERROR_PRINT("failed to choose partition \r\n");
-	/* update the error code */
-	lStatus = ulPartition;
-	goto CLEANUP;
-    }
 
     /* Before writing the user data we must update the magic header because user
      * is not aware of it.
      */
     pxKeyFobEntry->ulKeyFobIdMagic = keyfobidKEYFOB_ID_MAGIC;
 
-    /* Now update the primary partition with latest data given by the user*/
-    /* Before writing flash scheduler and interrupts should be disabled,
-     * once the write is done,then both can be enabled
-     */
-    /* Commenting suspend and resume scheduler since, it is observed
-     * Flash hangs sometimes because of this. Please revisit the same
-     * if required.
+    /* Each keyfob slot is a separate record in the record store. Only the
+     * slots which differ from flash are written, so adding, removing or
+     * updating one key programs only that key.
      */
-    taskENTER_CRITICAL();
-    /* vTaskSuspendAll(); */
-    lStatus = lCommonUpdatePartition(keyfobidKEYFOB_PART1_ADDRESS,
-	    sizeof(keyfobidKeyFobEntry_t), (uint8_t *) pxKeyFobEntry,
-	    keyfobidKEYFOB_ID_MAGIC, keyfobidKEYFOB_ID_MAGIC_SIZE);
-    /* xTaskResumeAll(); */
-    taskEXIT_CRITICAL();
-    if(lStatus != NO_ERROR)
+    for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
     {
-	debugERROR_PRINT("failed to write keyfob Data \r\n");
-	goto CLEANUP;
+	lStatus = lLogstoreRead(eLOGSTORE_KEYFOB_ID, ucIndex, pxStoredInfo,
+		sizeof(keyfobidKeyFobInfo_t));
+	if(lStatus == NO_ERROR)
+	{
+	    ucStored = 1;
+	}
+	else if(lStatus == COMMON_ERR_NO_MATCH)
+	{
+	    ucStored = 0;
+	}
+	else
+	{
+	    debugERROR_PRINT("failed to read keyfob slot %d \r\n", ucIndex);
+	    goto CLEANUP;
+	}
+
+	if (pxKeyFobEntry->xKeyFobInfo[ucIndex].ulKeyMagic
+		== keyfobidKEYFOB_INFO_MAGIC)
+	{
+	    /* slot is valid, write it if it is new or changed */
+	    if((!ucStored) || memcmp(pxStoredInfo,
+		    &pxKeyFobEntry->xKeyFobInfo[ucIndex],
+		    sizeof(keyfobidKeyFobInfo_t)))
+	    {
+		lStatus = lLogstoreWrite(eLOGSTORE_KEYFOB_ID, ucIndex,
+			&pxKeyFobEntry->xKeyFobInfo[ucIndex],
+			sizeof(keyfobidKeyFobInfo_t));
+	    }
+	    else
+	    {
+		lStatus = NO_ERROR;
+	    }
+	}
+	else
+	{
+	    /* slot is free, drop the stored key if any */
+	    lStatus = (ucStored) ?
+		    lLogstoreDelete(eLOGSTORE_KEYFOB_ID, ucIndex) : NO_ERROR;
+	}
+	if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("failed to write keyfob Data \r\n");
+	    goto CLEANUP;
+	}
     }
 
     /* clean up the allocated memory before returning error */
     CLEANUP:
-    if(pxBackUpKeyfobData)
+    /* whole table may have changed, index is built again on next lookup */
+    vKeyfobidInvalidateIndex();
+    if(pxStoredInfo)
     {
-	vPortFree(pxBackUpKeyfobData);
+	/* stored info holds the keys */
+	memset(pxStoredInfo, 0, sizeof(keyfobidKeyFobInfo_t));
+	vPortFree(pxStoredInfo);
     }
     /* return the error code */
     return lStatus;
@@ -210,10 +281,10 @@ int32_t lKeyfobidReadKeyFobEntry(keyfobidKeyFobEntry_t *pxKeyFobEntry)
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Partition to write */
-    uint32_t ulPartition = 0;
-    /* address to write data */
-    uint32_t ulAddress = 0;
+    /* Index for keyfob info */
+    uint8_t ucIndex = 0;
+    /* record store information */
+    xLogstoreInfo_t xInfo;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -222,37 +293,38 @@ int32_t lKeyfobidReadKeyFobEntry(keyfobidKeyFobEntry_t *pxKeyFobEntry)
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* We need to check if data needs to be written to partition 1 or 2
-     * based on the valid magic number. If both partition does not have valid
-     * magic number than choose partition 1.
-     */
-    ulPartition = lCommonChoosePartition(keyfobidKEYFOB_PART1_ADDRESS,
-	    keyfobidKEYFOB_PART2_ADDRESS, keyfobidKEYFOB_ID_MAGIC,
-	    keyfobidKEYFOB_ID_MAGIC_SIZE);
-    /* check if partition one has valid header */
-    if(ulPartition == commonPARTITION1)
-    {
-	ulAddress = keyfobidKEYFOB_PART1_ADDRESS;
-    }
-    /* check if partition two has valid header */
-    else if (ulPartition == commonPARTITION2)
+
+    /* No slot in flash means keyfob entry was never written */
+    lStatus = lLogstoreGetInfo(eLOGSTORE_KEYFOB_ID, &xInfo);
+    if(lStatus != NO_ERROR)
     {
-	ulAddress = keyfobidKEYFOB_PART2_ADDRESS;
+	return lStatus;
     }
-    /* Some error has occurred. */
-    else
+    if(xInfo.ulRecords == 0)
     {
 	debugERROR_PRINT("No valid header partition found \r\n");
-	return ulPartition;
+	return commonPARTITIONNONE;
     }
 
-    /* read the manufacture data from the flash */
-    lStatus = mml_sflc_read(ulAddress, (uint8_t *) pxKeyFobEntry,
-	    sizeof(keyfobidKeyFobEntry_t));
-    if(lStatus != NO_ERROR)
+    /* free slots read as erased flash */
+    memset(pxKeyFobEntry, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
+    pxKeyFobEntry->ulKeyFobIdMagic = keyfobidKEYFOB_ID_MAGIC;
+
+    /* read each slot from the record store */
+    for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
     {
-	debugERROR_PRINT("failed to read keyfob data \r\n");
-	return lStatus;
+	lStatus = lLogstoreRead(eLOGSTORE_KEYFOB_ID, ucIndex,
+		&pxKeyFobEntry->xKeyFobInfo[ucIndex],
+		sizeof(keyfobidKeyFobInfo_t));
+	if(lStatus == COMMON_ERR_NO_MATCH)
+	{
+	    lStatus = NO_ERROR;
+	}
+	else if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("failed to read keyfob data \r\n");
+	    return lStatus;
+	}
     }
     return lStatus;
 }
@@ -270,49 +342,31 @@ int32_t lKeyfobidReadKey( keyfobidKeyFobInfo_t *pxKeyInfo, uint8_t ucIndex)
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* Keyfob entry structure to read */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
-    /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
+    if(ucIndex >= keyfobidMAX_KEFOB_ENTRIES)
     {
-	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
+	debugERROR_PRINT("Invalid keyfob index \n");
+	return COMMON_ERR_OUT_OF_RANGE;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
 
-    /* Now read the keyfob entry structure */
-    lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
+    /* Each slot is a record of its own, read only the one asked for */
+    lStatus = lLogstoreRead(eLOGSTORE_KEYFOB_ID, ucIndex, pxKeyInfo,
+	    sizeof(keyfobidKeyFobInfo_t));
+    if(lStatus == COMMON_ERR_NO_MATCH)
+    {
+	debugERROR_PRINT("keyfob info for index has no valid data \r\n");
+	return COMMON_ERR_INVAL;
+    }
     if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("Failed to read Keyfob data \r\n");
-	goto CLEANUP;
+	return lStatus;
     }
 
-    /* copy the desired keyfob info based on the index */
-    if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyMagic
-	    == keyfobidKEYFOB_INFO_MAGIC)
-    {
-	memcpy((void *) pxKeyInfo,
-		(void *) &pxBackUpKeyfobData->xKeyFobInfo[ucIndex],
-		sizeof(keyfobidKeyFobInfo_t));
-    }
-    else
+    /* check if the slot holds a valid key */
+    if (pxKeyInfo->ulKeyMagic != keyfobidKEYFOB_INFO_MAGIC)
     {
 	debugERROR_PRINT("keyfob info for index has no valid data \r\n");
 	lStatus = COMMON_ERR_INVAL;
-	goto CLEANUP;
-    }
-
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpKeyfobData)
-    {
-	vPortFree(pxBackUpKeyfobData);
     }
     /* return error code */
     return lStatus;
@@ -323,6 +377,10 @@ int32_t lKeyfobidAddKey( keyfobidKeyFobInfo_t *pxKeyInfo)
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
+    /* Index for keyfob info */
+    uint8_t ucIndex = 0;
+    /* Index to add key */
+    int8_t ucIndexAdd = -1;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -331,84 +389,48 @@ int32_t lKeyfobidAddKey( keyfobidKeyFobInfo_t *pxKeyInfo)
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* Keyfob entry structure for backup */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
-    /* Index for keyfob info */
-    uint8_t ucIndex = 0;
-    /* Index to add key */
-    int8_t ucIndexAdd = -1;
-    /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
-    {
-	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
-    }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
 
-    /* Now read the keyfob entry structure */
-    lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
+    lStatus = prvKeyfobidIndexLoad();
     if(lStatus != NO_ERROR)
     {
-	/* reading might have failed because both partitions does not have valid
-	 * magic header, lets add valid header.
-	 */
-	if(lStatus == commonPARTITIONNONE)
-	{
-	    pxBackUpKeyfobData->ulKeyFobIdMagic = keyfobidKEYFOB_ID_MAGIC;
-	}
-	/* Some other flash error might have occurred report error in this case*/
-	else
-	{
-	    debugERROR_PRINT(" failed to read keyfobid entry data \r\n");
-	    goto CLEANUP;
-	}
+	debugERROR_PRINT(" failed to read keyfobid entry data \r\n");
+	return lStatus;
     }
 
     /* Now find which index is free to hold the key */
+    taskENTER_CRITICAL();
     for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
     {
-	if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyMagic
-		!= keyfobidKEYFOB_INFO_MAGIC)
+	if(!gxKeyfobidIndex.ucUsed[ucIndex])
 	{
 	    ucIndexAdd = ucIndex;
 	    break;
 	}
     }
+    taskEXIT_CRITICAL();
 
     /* Now check if we have found index to hold new key */
     if(ucIndexAdd < 0)
     {
-	lStatus = COMMON_ERR_OUT_OF_RANGE;
-	goto CLEANUP;
+	return COMMON_ERR_OUT_OF_RANGE;
     }
 
-    /* Now we have the free index to add the new key, copy the user keyinfo
-     * to the free index. Before that write the magic header of kefobid
-     * because user is not aware of it.
+    /* Now we have the free index to add the new key. Before that write the
+     * magic header of kefobid because user is not aware of it.
      */
     pxKeyInfo->ulKeyMagic = keyfobidKEYFOB_INFO_MAGIC;
-    memcpy((void *) &pxBackUpKeyfobData->xKeyFobInfo[ucIndexAdd],
-	    (void *) pxKeyInfo, sizeof(keyfobidKeyFobInfo_t));
 
-    /* Now we have updated the keyfob entry structure write it back to flash */
-    lStatus = lKeyfobidWriteKeyFobEntry(pxBackUpKeyfobData);
+    /* Only the slot of new key is written to flash */
+    lStatus = lLogstoreWrite(eLOGSTORE_KEYFOB_ID, ucIndexAdd, pxKeyInfo,
+	    sizeof(keyfobidKeyFobInfo_t));
     if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("Failed to update Keyfob data \r\n");
-	goto CLEANUP;
+	vKeyfobidInvalidateIndex();
+	return lStatus;
     }
+    prvKeyfobidIndexUpdate(ucIndexAdd, pxKeyInfo);
 
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpKeyfobData)
-    {
-	vPortFree(pxBackUpKeyfobData);
-    }
     /* return error code */
     return lStatus;
 }
@@ -418,76 +440,27 @@ int32_t lKeyfobidRemoveKeyKeyFobID( uint32_t ulKeyFobId )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Keyfob entry structure for backup */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
-    /* Index for keyfob info */
-    uint8_t ucIndex = 0;
     /* Keyfob index to delete */
-    int8_t ucIndexDelete = -1;
-    /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
-    {
-	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
-    }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
-
-    /* Now read the keyfob entry structure */
-    lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
-    if(lStatus != NO_ERROR)
-    {
-	debugERROR_PRINT("Failed to read Keyfob data \r\n");
-	goto CLEANUP;
-    }
+    uint8_t ucIndexDelete = 0;
 
     /* Find the index of key which needs to be deleted */
-    for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
-    {
-	/* first need to check if the index has valid magic header */
-	if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyMagic
-		== keyfobidKEYFOB_INFO_MAGIC)
-	{
-	    /* check if the keyfobID is found */
-	    if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyFobId
-		    == ulKeyFobId)
-	    {
-		ucIndexDelete = ucIndex;
-		break;
-	    }
-	}
-    }
-
-    /* Now check if we found key with valid ID to delete */
-    if(ucIndexDelete < 0)
+    lStatus = lKeyfobidFindKeyFobID(ulKeyFobId, &ucIndexDelete);
+    if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("No key found with this ID \r\n");
-	lStatus = COMMON_ERR_OUT_OF_RANGE;
-	goto CLEANUP;
+	return lStatus;
     }
 
-    /* Now we known index for the keyfobid to be deleted, make the magic
-     * number zero that will make the key invalid */
-    pxBackUpKeyfobData->xKeyFobInfo[ucIndexDelete].ulKeyMagic = 0;
-
-    /* Now we have updated the keyfob entry structure write it back to flash */
-    lStatus = lKeyfobidWriteKeyFobEntry(pxBackUpKeyfobData);
+    /* Now we known index for the keyfobid to be deleted, drop its slot */
+    lStatus = lLogstoreDelete(eLOGSTORE_KEYFOB_ID, ucIndexDelete);
     if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("Failed to update Keyfob data \r\n");
-	goto CLEANUP;
+	vKeyfobidInvalidateIndex();
+	return lStatus;
     }
+    prvKeyfobidIndexUpdate(ucIndexDelete, NULL);
 
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpKeyfobData)
-    {
-	vPortFree(pxBackUpKeyfobData);
-    }
     /* return error code */
     return lStatus;
 }
@@ -497,6 +470,8 @@ int32_t lKeyfobidRemoveKeyKeyName( uint8_t *pucKeyName )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
+    /* Keyfob index to delete */
+    uint8_t ucIndexDelete = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
@@ -505,244 +480,448 @@ int32_t lKeyfobidRemoveKeyKeyName( uint8_t *pucKeyName )
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* Keyfob entry structure for backup */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
-    /* Index for keyfob info */
-    uint8_t ucIndex = 0;
-    /* Keyfob index to delete */
-    int8_t ucIndexDelete = -1;
-    /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
+
+    /* Find the index of key which needs to be deleted */
+    lStatus = lKeyfobidFindKeyName(pucKeyName, keyfobidNAME_LEN_ACT,
+	    &ucIndexDelete);
+    if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
+	debugERROR_PRINT("No key found with this name \r\n");
+	return lStatus;
+    }
+    if(ucIndexDelete == 0)
+    {
+	debugERROR_PRINT("This key is First Keyfob.\n  Cannot be deleted \r\n");
+	return COMMON_ERR_UNKNOWN;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
 
-    /* Now read the keyfob entry structure */
-    lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
+    /* Now we known index for the keyfobid to be deleted, drop its slot */
+    lStatus = lLogstoreDelete(eLOGSTORE_KEYFOB_ID, ucIndexDelete);
     if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("Failed to read Keyfob data \r\n");
-	goto CLEANUP;
+	debugERROR_PRINT("Failed to update Keyfob data \r\n");
+	vKeyfobidInvalidateIndex();
+	return lStatus;
     }
+    prvKeyfobidIndexUpdate(ucIndexDelete, NULL);
 
-    /* Find the index of key which needs to be deleted */
-    for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
+    /* return error code */
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lKeyfobidUpdateKeyPrivilages( uint32_t ulKeyFobId, uint32_t ulKeyPrevilage )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* Keyfob info to update */
+    keyfobidKeyFobInfo_t *pxKeyInfo = NULL;
+    /* Keyfob index to update privilage settings */
+    uint8_t ucIndexUpdate = 0;
+
+    /* Find the index of key which needs to be updated */
+    lStatus = lKeyfobidFindKeyFobID(ulKeyFobId, &ucIndexUpdate);
+    if(lStatus != NO_ERROR)
     {
-	/* first need to check if the index has valid magic header */
-	if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyMagic
-		== keyfobidKEYFOB_INFO_MAGIC)
-	{
-	    /* Now compare if the string is equal to ORWL */
-	    if (!memcmp(
-		(const char *) &pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ucKeyName,
-		(const char *) pucKeyName,
-		keyfobidNAME_LEN_ACT))
-	    {
-		/* Keyfob name matches with name provided by user */
-		ucIndexDelete = ucIndex;
-		break;
-	    }
-	}
+	debugERROR_PRINT("No key found with this ID \r\n");
+	return lStatus;
     }
 
-    if(ucIndexDelete == 0)
+    /* allocate dynamic memory */
+    pxKeyInfo = (keyfobidKeyFobInfo_t *) pvPortMalloc(
+	    sizeof(keyfobidKeyFobInfo_t));
+    /* check if memory was allocated properly */
+    if(pxKeyInfo == NULL)
     {
-	debugERROR_PRINT("This key is First Keyfob.\n  Cannot be deleted \r\n");
-	lStatus = COMMON_ERR_UNKNOWN;
-	goto CLEANUP;
+	debugERROR_PRINT(
+		"Failed to allocate memory for keyfob info structure \r\n");
+	return COMMON_ERR_NULL_PTR;
     }
-    /* Now check if we found key with valid name, to delete */
-    if(ucIndexDelete < 0)
+
+    /* Now read the slot of key */
+    lStatus = lKeyfobidReadKey(pxKeyInfo, ucIndexUpdate);
+    if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("No key found with this name \r\n");
-	lStatus = COMMON_ERR_OUT_OF_RANGE;
+	debugERROR_PRINT(" failed to read keyfobid entry data \r\n");
 	goto CLEANUP;
     }
 
-    /* Now we known index for the keyfobid to be deleted, make the magic
-     * number zero that will make the key invalid */
-    pxBackUpKeyfobData->xKeyFobInfo[ucIndexDelete].ulKeyMagic = 0;
+    /* Now we now known index for the keyfobid to be updated*/
+    pxKeyInfo->ulKeyPrevilage = ulKeyPrevilage;
 
-    /* Now we have updated the keyfob entry structure write it back to flash */
-    lStatus = lKeyfobidWriteKeyFobEntry(pxBackUpKeyfobData);
+    /* Only the slot of this key is written back to flash */
+    lStatus = lLogstoreWrite(eLOGSTORE_KEYFOB_ID, ucIndexUpdate, pxKeyInfo,
+	    sizeof(keyfobidKeyFobInfo_t));
     if(lStatus != NO_ERROR)
     {
 	debugERROR_PRINT("Failed to update Keyfob data \r\n");
+	vKeyfobidInvalidateIndex();
 	goto CLEANUP;
     }
+    prvKeyfobidIndexUpdate(ucIndexUpdate, pxKeyInfo);
 
     /* clean up the allocated memory before returning error */
     CLEANUP:
-    if(pxBackUpKeyfobData)
+    if(pxKeyInfo)
     {
-	vPortFree(pxBackUpKeyfobData);
+	/* key info holds the keys */
+	memset(pxKeyInfo, 0, sizeof(keyfobidKeyFobInfo_t));
+	vPortFree(pxKeyInfo);
     }
     /* return error code */
     return lStatus;
 }
 /*----------------------------------------------------------------------------*/
 
-int32_t lKeyfobidUpdateKeyPrivilages( uint32_t ulKeyFobId, uint32_t ulKeyPrevilage )
+int32_t lKeyfobidCheckFreeIndex( uint8_t *pucIndexAdd)
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Keyfob entry structure for backup */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
     /* Index for keyfob info */
     uint8_t ucIndex = 0;
-    /* Keyfob index to update privilage settings */
-    int8_t ucIndexUpdate = -1;
-    /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
+    /* First we need to check if the pointer passed by the user is valid and
+     * not NULL.
+     */
+    if(pucIndexAdd == NULL)
     {
-	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
+	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
 
-    /* Now read the keyfob entry structure */
-    lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
+    lStatus = prvKeyfobidIndexLoad();
     if(lStatus != NO_ERROR)
     {
-	/* reading might have failed because both partitions does not have valid
-	 * magic header, lets add valid header.
-	 */
-	if(lStatus == commonPARTITIONNONE)
-	{
-	    pxBackUpKeyfobData->ulKeyFobIdMagic = keyfobidKEYFOB_ID_MAGIC;
-	}
-	/* Some other flash error might have occurred report error */
-	else
-	{
-	    debugERROR_PRINT(" failed to read keyfobid entry data \r\n");
-	    goto CLEANUP;
-	}
+	debugERROR_PRINT(" failed to read keyfobid entry data \r\n");
+	return lStatus;
     }
 
-    /* Find the index of key which needs to be deleted */
+    /* Now count the keys present */
+    *pucIndexAdd = 0;
+    taskENTER_CRITICAL();
     for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
     {
-	/* first need to check if the index has valid magic header */
-	if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyMagic
-		== keyfobidKEYFOB_INFO_MAGIC)
+	if(gxKeyfobidIndex.ucUsed[ucIndex])
 	{
-	    /* check the keyfobID that matches to user provided keyfobID */
-	    if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyFobId
-		    == ulKeyFobId)
-	    {
-		ucIndexUpdate = ucIndex;
-		break;
-	    }
+	    (*pucIndexAdd)++;
 	}
     }
+    taskEXIT_CRITICAL();
+    /* return error code */
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
 
-    /* Now check if we found key with valid ID to update */
-    if(ucIndexUpdate < 0)
+int32_t lKeyfobidFindKeyName( const uint8_t *pucKeyName, uint8_t ucKeyLen,
+	uint8_t *pucIndex )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* hash bucket */
+    uint8_t ucBucket = 0;
+    /* slot in bucket */
+    uint8_t ucSlot = 0;
+    /* buckets probed */
+    uint8_t ucProbe = 0;
+    /* Index for keyfob info */
+    uint8_t ucIndex = 0;
+    /* First we need to check if the pointer passed by the user is valid and
+     * not NULL.
+     */
+    if((pucKeyName == NULL) || (pucIndex == NULL))
     {
-	debugERROR_PRINT("No key found with this ID \r\n");
-	lStatus = COMMON_ERR_OUT_OF_RANGE;
-	goto CLEANUP;
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    if((ucKeyLen == 0) || (ucKeyLen > keyfobidNAME_LEN))
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
     }
 
-    /* Now we now known index for the keyfobid to be updated*/
-    pxBackUpKeyfobData->xKeyFobInfo[ucIndexUpdate].ulKeyPrevilage =
-	    ulKeyPrevilage;
-
-    /* Now we have updated the keyfob entry structure write it back to flash */
-    lStatus = lKeyfobidWriteKeyFobEntry(pxBackUpKeyfobData);
+    lStatus = prvKeyfobidIndexLoad();
     if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT("Failed to update Keyfob data \r\n");
-	goto CLEANUP;
+	return lStatus;
     }
 
-    /* clean up the allocated memory before returning error */
-    CLEANUP:
-    if(pxBackUpKeyfobData)
+    *pucIndex = keyfobidHASH_EMPTY;
+    taskENTER_CRITICAL();
+    /* names stored with the same length are found through the hash table */
+    ucBucket = prvKeyfobidHashName(pucKeyName, ucKeyLen);
+    for(ucProbe = 0; ucProbe < keyfobidHASH_BUCKETS; ucProbe++)
     {
-	vPortFree(pxBackUpKeyfobData);
+	ucSlot = gxKeyfobidIndex.ucByName[ucBucket];
+	if(ucSlot == keyfobidHASH_EMPTY)
+	{
+	    break;
+	}
+	/* lowest slot wins, same as a scan of the table */
+	if((gxKeyfobidIndex.ucNameLen[ucSlot] == ucKeyLen) &&
+		(ucSlot < *pucIndex) &&
+		(!memcmp(gxKeyfobidIndex.ucKeyName[ucSlot], pucKeyName,
+			ucKeyLen)))
+	{
+	    *pucIndex = ucSlot;
+	}
+	ucBucket = (ucBucket + 1) & (keyfobidHASH_BUCKETS - 1);
+    }
+    /* name given may be a prefix of stored name, check the slots in RAM */
+    if(*pucIndex == keyfobidHASH_EMPTY)
+    {
+	for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
+	{
+	    if((gxKeyfobidIndex.ucUsed[ucIndex]) &&
+		    (!memcmp(gxKeyfobidIndex.ucKeyName[ucIndex], pucKeyName,
+			    ucKeyLen)))
+	    {
+		*pucIndex = ucIndex;
+		break;
+	    }
+	}
+    }
+    taskEXIT_CRITICAL();
+
+    if(*pucIndex == keyfobidHASH_EMPTY)
+    {
+	lStatus = COMMON_ERR_OUT_OF_RANGE;
     }
     /* return error code */
     return lStatus;
 }
 /*----------------------------------------------------------------------------*/
 
-int32_t lKeyfobidCheckFreeIndex( uint8_t *pucIndexAdd)
+int32_t lKeyfobidFindKeyFobID( uint32_t ulKeyFobId, uint8_t *pucIndex )
 {
     /* status to return */
     int32_t lStatus = NO_ERROR;
-    /* Keyfob entry structure for backup */
-    keyfobidKeyFobEntry_t *pxBackUpKeyfobData = NULL;
-    /* Index for keyfob info */
-    uint8_t ucIndex = 0;
+    /* hash bucket */
+    uint8_t ucBucket = 0;
+    /* slot in bucket */
+    uint8_t ucSlot = 0;
+    /* buckets probed */
+    uint8_t ucProbe = 0;
     /* First we need to check if the pointer passed by the user is valid and
      * not NULL.
      */
-    if(pucIndexAdd == NULL)
+    if(pucIndex == NULL)
     {
 	debugERROR_PRINT("Invalid argument \n");
 	return COMMON_ERR_NULL_PTR;
     }
-    /* allocate dynamic memory */
-    pxBackUpKeyfobData = (keyfobidKeyFobEntry_t *) pvPortMalloc(
-	    sizeof(keyfobidKeyFobEntry_t));
-    /* check if memory was allocated properly */
-    if(pxBackUpKeyfobData == NULL)
+
+    lStatus = prvKeyfobidIndexLoad();
+    if(lStatus != NO_ERROR)
     {
-	debugERROR_PRINT(
-		"Failed to allocate memory for keyfob entry structure \r\n");
-	return COMMON_ERR_NULL_PTR;
+	return lStatus;
     }
-    /* After successful allocation of memory do memset to 0xff */
-    memset(pxBackUpKeyfobData, commonDEFAULT_VALUE, sizeof(keyfobidKeyFobEntry_t));
 
-    /* Now read the keyfob entry structure */
-    lStatus = lKeyfobidReadKeyFobEntry(pxBackUpKeyfobData);
-    if(lStatus != NO_ERROR)
+    *pucIndex = keyfobidHASH_EMPTY;
+    taskENTER_CRITICAL();
+    ucBucket = prvKeyfobidHashId(ulKeyFobId);
+    for(ucProbe = 0; ucProbe < keyfobidHASH_BUCKETS; ucProbe++)
     {
-	/* reading might have failed because both partitions does not have valid
-	 * magic header, lets add valid header.
-	 */
-	if(lStatus == commonPARTITIONNONE)
+	ucSlot = gxKeyfobidIndex.ucById[ucBucket];
+	if(ucSlot == keyfobidHASH_EMPTY)
 	{
-	    pxBackUpKeyfobData->ulKeyFobIdMagic = keyfobidKEYFOB_ID_MAGIC;
-	    lStatus = NO_ERROR;
+	    break;
 	}
-	/* Some other flash error might have occurred report error in this case*/
-	else
+	/* lowest slot wins, same as a scan of the table */
+	if((gxKeyfobidIndex.ulKeyFobId[ucSlot] == ulKeyFobId) &&
+		(ucSlot < *pucIndex))
 	{
-	    debugERROR_PRINT(" failed to read keyfobid entry data \r\n");
-	    goto CLEANUP;
+	    *pucIndex = ucSlot;
 	}
+	ucBucket = (ucBucket + 1) & (keyfobidHASH_BUCKETS - 1);
     }
+    taskEXIT_CRITICAL();
 
-    *pucIndexAdd = keyfobidMAX_KEFOB_ENTRIES;
-    /* Now find which index is free to hold the key */
+    if(*pucIndex == keyfobidHASH_EMPTY)
+    {
+	lStatus = COMMON_ERR_OUT_OF_RANGE;
+    }
+    /* return error code */
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulKeyfobidGetGeneration( void )
+{
+    return gulKeyfobidGeneration;
+}
+/*----------------------------------------------------------------------------*/
+
+void vKeyfobidInvalidateIndex( void )
+{
+    taskENTER_CRITICAL();
+    gxKeyfobidIndex.ucValid = 0;
+    gulKeyfobidGeneration++;
+    taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+
+static uint8_t prvKeyfobidHashName( const uint8_t *pucKeyName,
+	uint8_t ucKeyLen )
+{
+    /* running hash */
+    uint32_t ulHash = keyfobidFNV_OFFSET;
+
+    while(ucKeyLen--)
+    {
+	ulHash ^= *pucKeyName++;
+	ulHash *= keyfobidFNV_PRIME;
+    }
+    /* fold upper bits in to the bucket */
+    return (uint8_t) ((ulHash ^ (ulHash >> 16)) & (keyfobidHASH_BUCKETS - 1));
+}
+/*----------------------------------------------------------------------------*/
+
+static uint8_t prvKeyfobidHashId( uint32_t ulKeyFobId )
+{
+    /* top bits of product are best mixed */
+    return (uint8_t) ((ulKeyFobId * keyfobidID_HASH_MUL) >> 28) &
+	    (keyfobidHASH_BUCKETS - 1);
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvKeyfobidIndexRehash( keyfobidIndex_t *pxIndex )
+{
+    /* Index for keyfob info */
+    uint8_t ucIndex = 0;
+    /* hash bucket */
+    uint8_t ucBucket = 0;
+
+    memset(pxIndex->ucByName, keyfobidHASH_EMPTY, sizeof(pxIndex->ucByName));
+    memset(pxIndex->ucById, keyfobidHASH_EMPTY, sizeof(pxIndex->ucById));
     for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
     {
-	if (pxBackUpKeyfobData->xKeyFobInfo[ucIndex].ulKeyMagic
-		!= keyfobidKEYFOB_INFO_MAGIC)
+	if(!pxIndex->ucUsed[ucIndex])
+	{
+	    continue;
+	}
+	/* there are more buckets than slots, free bucket is always found */
+	ucBucket = prvKeyfobidHashName(pxIndex->ucKeyName[ucIndex],
+		pxIndex->ucNameLen[ucIndex]);
+	while(pxIndex->ucByName[ucBucket] != keyfobidHASH_EMPTY)
+	{
+	    ucBucket = (ucBucket + 1) & (keyfobidHASH_BUCKETS - 1);
+	}
+	pxIndex->ucByName[ucBucket] = ucIndex;
+
+	ucBucket = prvKeyfobidHashId(pxIndex->ulKeyFobId[ucIndex]);
+	while(pxIndex->ucById[ucBucket] != keyfobidHASH_EMPTY)
 	{
-	    (*pucIndexAdd)--;
+	    ucBucket = (ucBucket + 1) & (keyfobidHASH_BUCKETS - 1);
 	}
+	pxIndex->ucById[ucBucket] = ucIndex;
     }
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvKeyfobidIndexSlot( keyfobidIndex_t *pxIndex, uint8_t ucIndex,
+	const keyfobidKeyFobInfo_t *pxKeyInfo )
+{
+    if((pxKeyInfo == NULL) ||
+	    (pxKeyInfo->ulKeyMagic != keyfobidKEYFOB_INFO_MAGIC))
+    {
+	pxIndex->ucUsed[ucIndex] = 0;
+	return;
+    }
+    pxIndex->ucUsed[ucIndex] = 1;
+    pxIndex->ulKeyFobId[ucIndex] = pxKeyInfo->ulKeyFobId;
+    /* name length of old entries may not be set, whole name is used then */
+    pxIndex->ucNameLen[ucIndex] = ((pxKeyInfo->ulKeyNameLen == 0) ||
+	    (pxKeyInfo->ulKeyNameLen > keyfobidNAME_LEN)) ?
+		    keyfobidNAME_LEN : (uint8_t) pxKeyInfo->ulKeyNameLen;
+    memcpy(pxIndex->ucKeyName[ucIndex], pxKeyInfo->ucKeyName,
+	    keyfobidNAME_LEN);
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvKeyfobidIndexUpdate( uint8_t ucIndex,
+	const keyfobidKeyFobInfo_t *pxKeyInfo )
+{
+    taskENTER_CRITICAL();
+    gulKeyfobidGeneration++;
+    if(gxKeyfobidIndex.ucValid)
+    {
+	prvKeyfobidIndexSlot(&gxKeyfobidIndex, ucIndex, pxKeyInfo);
+	prvKeyfobidIndexRehash(&gxKeyfobidIndex);
+    }
+    taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvKeyfobidIndexLoad( void )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* Keyfob info read from flash */
+    keyfobidKeyFobInfo_t *pxKeyInfo = NULL;
+    /* index being built */
+    keyfobidIndex_t *pxIndex = NULL;
+    /* generation when build started */
+    uint32_t ulGeneration = 0;
+    /* Index for keyfob info */
+    uint8_t ucIndex = 0;
+
+    if(gxKeyfobidIndex.ucValid)
+    {
+	return NO_ERROR;
+    }
+
+    /* allocate dynamic memory */
+    pxKeyInfo = (keyfobidKeyFobInfo_t *) pvPortMalloc(
+	    sizeof(keyfobidKeyFobInfo_t));
+    pxIndex = (keyfobidIndex_t *) pvPortMalloc(sizeof(keyfobidIndex_t));
+    /* check if memory was allocated properly */
+    if((pxKeyInfo == NULL) || (pxIndex == NULL))
+    {
+	debugERROR_PRINT("Failed to allocate memory for keyfob index \r\n");
+	lStatus = COMMON_ERR_NULL_PTR;
+	goto CLEANUP;
+    }
+
+    /* index is built aside, update made meanwhile makes it stale */
+    do
+    {
+	ulGeneration = gulKeyfobidGeneration;
+	memset(pxIndex, 0, sizeof(keyfobidIndex_t));
+	for(ucIndex = 0; ucIndex < keyfobidMAX_KEFOB_ENTRIES; ucIndex++)
+	{
+	    lStatus = lLogstoreRead(eLOGSTORE_KEYFOB_ID, ucIndex, pxKeyInfo,
+		    sizeof(keyfobidKeyFobInfo_t));
+	    if(lStatus == NO_ERROR)
+	    {
+		prvKeyfobidIndexSlot(pxIndex, ucIndex, pxKeyInfo);
+	    }
+	    else if(lStatus != COMMON_ERR_NO_MATCH)
+	    {
+		debugERROR_PRINT("failed to read keyfob slot %d \r\n", ucIndex);
+		goto CLEANUP;
+	    }
+	}
+	lStatus = NO_ERROR;
+	prvKeyfobidIndexRehash(pxIndex);
+	pxIndex->ucValid = 1;
+
+	taskENTER_CRITICAL();
+	if(ulGeneration == gulKeyfobidGeneration)
+	{
+	    memcpy(&gxKeyfobidIndex, pxIndex, sizeof(keyfobidIndex_t));
+	}
+	taskEXIT_CRITICAL();
+    } while(!gxKeyfobidIndex.ucValid);
+
     /* clean up the allocated memory before returning error */
     CLEANUP:
-    if(pxBackUpKeyfobData)
+    if(pxKeyInfo)
+    {
+	/* key info holds the keys */
+	memset(pxKeyInfo, 0, sizeof(keyfobidKeyFobInfo_t));
+	vPortFree(pxKeyInfo);
+    }
+    if(pxIndex)
     {
-	vPortFree(pxBackUpKeyfobData);
+	vPortFree(pxIndex);
     }
     /* return error code */
     return lStatus;
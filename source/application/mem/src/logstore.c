@@ -0,0 +1,1651 @@
+ /**===========================================================================
+ * @file logstore.c
+ *
+ * @brief This file contains the log structured flash record store.
+ *
+ * Each store owns the flash pages of one partition from flash.h. Records are
+ * appended to the active page together with a header carrying record ID,
+ * length, sequence number and CRC. Latest valid copy of a record wins. When
+ * the store runs out of erased pages, the oldest page is collected: its live
+ * records are copied forward into the spare page and the page is erased.
+ * Erasing oldest page first keeps the wear even across the store pages.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <errors.h>
+#include <mml_sflc.h>
+#include <debug.h>
+#include <printf_lite.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Freertos includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+#include <portable.h>
+
+/* Local includes */
+#include <logstore.h>
+#include <mem_common.h>
+#include <access_keys.h>
+#include <enckeys.h>
+#include <keyfobid.h>
+#include <hist_devtamper.h>
+/* Not exposing flash.h to users */
+#include "flash.h"
+
+/**
+ * Page header magic of a formatted store page.
+ */
+#define logstorePAGE_MAGIC		(0x106570E5U)
+
+/**
+ * Page sequence of a formatted page which is not yet used.
+ */
+#define logstoreSEQ_FREE		(0xFFFFFFFFU)
+
+/**
+ * Value of an erased flash word.
+ */
+#define logstoreBLANK_WORD		(0xFFFFFFFFU)
+
+/**
+ * Records are programmed at word aligned offsets.
+ */
+#define logstoreALIGN			(4)
+
+/**
+ * Round up size to the record alignment.
+ */
+#define logstoreALIGN_UP(x)		(((x) + (logstoreALIGN - 1)) & \
+					~(logstoreALIGN - 1))
+
+/**
+ * No active page.
+ */
+#define logstoreNO_PAGE			(0xFF)
+
+/**
+ * Number of times read is retried if record moves while being read.
+ */
+#define logstoreREAD_RETRY		(3)
+
+/**
+ * Size of the bounce buffer used for flash to flash copies.
+ */
+#define logstoreCHUNK_SIZE		(32)
+
+/**
+ * Page states.
+ */
+#define logstorePAGE_DIRTY		(0)	/** not formatted, erase before use */
+#define logstorePAGE_FREE		(1)	/** formatted and blank */
+#define logstorePAGE_USED		(2)	/** holds records */
+#define logstorePAGE_LEGACY		(3)	/** old partition data being imported */
+
+/**
+ * Page header, programmed right after the page is erased. Page sequence is
+ * programmed when page is opened for records.
+ */
+typedef struct
+{
+    /** logstorePAGE_MAGIC */
+    uint32_t ulMagic;
+    /** Number of times this page is erased */
+    uint32_t ulEraseCount;
+    /** CRC over magic and erase count */
+    uint32_t ulHdrCrc;
+    /** Order in which pages are opened, logstoreSEQ_FREE till then */
+    uint32_t ulPageSeq;
+} xLogstorePageHdr_t;
+
+/**
+ * Record header. Data follows the header, header is programmed after data
+ * so a header is never present for partially programmed data. Sequence
+ * number 0 marks a record overwritten by scrub.
+ */
+typedef struct
+{
+    /** Record ID */
+    uint16_t usId;
+    /** Data length, 0 marks a deleted record */
+    uint16_t usLen;
+    /** Store wide record sequence number */
+    uint32_t ulSeq;
+    /** CRC over ID, length, sequence and data */
+    uint32_t ulCrc;
+} xLogstoreRecHdr_t;
+
+/**
+ * Description of the A/B partition format used before the record store, so
+ * the data can be imported on first boot.
+ */
+typedef struct
+{
+    /** Magic of the old partition, 0 if nothing to import */
+    uint32_t ulMagic;
+    /** Offset of partition 2(backup) from start of store */
+    uint32_t ulPart2Offset;
+    /** Offset of first record in partition */
+    uint16_t usHdrLen;
+    /** Length of each record */
+    uint16_t usRecLen;
+    /** Number of records */
+    uint16_t usRecCount;
+    /** Import only records starting with this magic, 0 to import all */
+    uint32_t ulRecMagic;
+} xLogstoreLegacy_t;
+
+/**
+ * Static configuration of a store.
+ */
+typedef struct
+{
+    /** Start address of store in flash */
+    uint32_t ulBase;
+    /** Number of pages */
+    uint8_t  ucPages;
+    /** Number of record ID's */
+    uint8_t  ucMaxIds;
+    /** logstoreFLAG_xxx */
+    uint8_t  ucFlags;
+    /** Old partition format */
+    xLogstoreLegacy_t xLegacy;
+} xLogstoreConfig_t;
+
+/**
+ * Run time state of a store.
+ */
+typedef struct
+{
+    /** Flash address of latest copy of each record, 0 if not present */
+    uint32_t ulRecAddr[logstoreMAX_RECORD_IDS];
+    /** Sequence number of latest copy of each record */
+    uint32_t ulRecSeq[logstoreMAX_RECORD_IDS];
+    /** Data length of latest copy of each record */
+    uint16_t usRecLen[logstoreMAX_RECORD_IDS];
+    /** Erase count of each page */
+    uint32_t ulEraseCount[logstoreMAX_PAGES];
+    /** Page sequence of each page */
+    uint32_t ulPageSeq[logstoreMAX_PAGES];
+    /** Page state */
+    uint8_t  ucState[logstoreMAX_PAGES];
+    /** Active page, records are appended here */
+    uint8_t  ucActive;
+    /** Store is mounted */
+    uint8_t  ucMounted;
+    /** Old partition import in progress, its pages serve as spare */
+    uint8_t  ucImporting;
+    /** Append offset in active page */
+    uint32_t ulWriteOff;
+    /** Next record sequence number */
+    uint32_t ulNextRecSeq;
+    /** Next page sequence number */
+    uint32_t ulNextPageSeq;
+    /** Pages collected since boot */
+    uint32_t ulCollections;
+    /** Serializes writers */
+    SemaphoreHandle_t xLock;
+} xLogstoreState_t;
+
+/**
+ * Store configuration, indexed by xLogstoreId.
+ */
+static const xLogstoreConfig_t xLogstoreConfig[eLOGSTORE_MAX] =
+{
+    [eLOGSTORE_ACCESS_KEY] =
+    {
+	flashACCESS_KEY_START_ADDR, flashACCESS_KEY_NUM_PAGES, 1,
+	logstoreFLAG_SCRUB,
+	{ keyACCESS_KEY_MAGIC, flashPAGE_SIZE, 0,
+		sizeof(keysDSFT_MASTER_KEYS_t), 1, 0 }
+    },
+    [eLOGSTORE_ENC_KEY] =
+    {
+	flashENC_KEY_START_ADDR, flashENC_KEY_NUM_PAGES, enckeysNUM_RECORDS, 0,
+	{ enckeyENC_KEY_MAGIC, flashPAGE_SIZE, 0,
+		sizeof(enckeysDsftEncKeys_t), 1, 0 }
+    },
+    [eLOGSTORE_KEYFOB_ID] =
+    {
+	flashKEYFOB_ID_START_ADDR, flashKEYFOB_ID_NUM_PAGES,
+	keyfobidMAX_KEFOB_ENTRIES, logstoreFLAG_SCRUB,
+	{ keyfobidKEYFOB_ID_MAGIC, (flashPAGE_SIZE * 2),
+		offsetof(keyfobidKeyFobEntry_t, xKeyFobInfo),
+		sizeof(keyfobidKeyFobInfo_t), keyfobidMAX_KEFOB_ENTRIES,
+		keyfobidKEYFOB_INFO_MAGIC }
+    },
+    [eLOGSTORE_TAMP_HIST] =
+    {
+	flashTAMP_HIST_START_ADDR, flashTAMP_HISTORY_NUM_PAGES, 1, 0,
+	{ devtamperTAMPER_CLEAR_MAGIC, flashPAGE_SIZE, 0,
+		sizeof(devtamperTamperHist_t), 1, 0 }
+    },
+};
+
+/**
+ * Store state, indexed by xLogstoreId.
+ */
+static xLogstoreState_t xLogstoreState[eLOGSTORE_MAX];
+
+/**
+ * @brief Flash address of a store page.
+ *
+ * @param pxCfg store configuration.
+ * @param ucPage page index.
+ *
+ * @return page address.
+ */
+static uint32_t prvLogstorePageAddr( const xLogstoreConfig_t *pxCfg,
+	uint8_t ucPage );
+
+/**
+ * @brief Check if flash range is erased.
+ *
+ * @param ulAddress start address.
+ * @param ulLen length to check.
+ * @param pucBlank set to 1 if range is erased.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreIsBlank( uint32_t ulAddress, uint32_t ulLen,
+	uint8_t *pucBlank );
+
+/**
+ * @brief Read a record and check its CRC.
+ *
+ * Copies up to usLen bytes of record data into pucData, CRC is computed over
+ * the full record.
+ *
+ * @param ulAddress record address.
+ * @param pxHdr record header read from ulAddress.
+ * @param pucData buffer for record data, can be NULL.
+ * @param usLen size of buffer.
+ * @param pucValid set to 1 if CRC matches.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreReadRecord( uint32_t ulAddress,
+	const xLogstoreRecHdr_t *pxHdr, uint8_t *pucData, uint16_t usLen,
+	uint8_t *pucValid );
+
+/**
+ * @brief Erase a page and program the page header.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ * @param ucPage page to erase.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreErasePage( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint8_t ucPage );
+
+/**
+ * @brief Open a free page for appending records.
+ *
+ * A page opened for a collection is committed only after it holds all live
+ * records of the victim, till then mount takes it for a dirty page.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ * @param ucPage page to open.
+ * @param ucCommit program the page sequence now.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreOpenPage( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint8_t ucPage, uint8_t ucCommit );
+
+/**
+ * @brief Commit an open page by programming its page sequence.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ * @param ucPage page to commit.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreCommitPage( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint8_t ucPage );
+
+/**
+ * @brief Append a record to the active page.
+ *
+ * @param pxState store state.
+ * @param usId record ID.
+ * @param pucData record data.
+ * @param usLen record length, 0 for delete marker.
+ * @param ucScrub overwrite the superseded copy of the record.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreAppend( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint16_t usId, const uint8_t *pucData,
+	uint16_t usLen, uint8_t ucScrub );
+
+/**
+ * @brief Copy a record to the active page, keeping its sequence number.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ * @param usId record ID to copy.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreRelocate( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint16_t usId );
+
+/**
+ * @brief Overwrite a superseded record with zeros.
+ *
+ * Record ID and length are left intact so the page can still be scanned.
+ *
+ * @param ulAddress record address.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreScrub( uint32_t ulAddress );
+
+/**
+ * @brief Make room in the active page for a record.
+ *
+ * Opens a new page when the active page is full. If only the spare page is
+ * left, oldest page is collected into it. When the record being written
+ * lives in the collected page, new copy is appended before the page is
+ * erased, so at least one valid copy is always present in flash.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ * @param usId ID of record being written.
+ * @param pucData record data.
+ * @param usLen record length.
+ * @param pucDone set to 1 if record was appended during collection.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreMakeRoom( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint16_t usId, const uint8_t *pucData,
+	uint16_t usLen, uint8_t *pucDone );
+
+/**
+ * @brief Import data from the old A/B partition format.
+ *
+ * Pages of the valid old partition are left untouched till all records are
+ * committed to the other pages. Power off during import repeats the import
+ * on next boot.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ * @param ulPartition valid partition, commonPARTITION1 or commonPARTITION2.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreImport( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint32_t ulPartition );
+
+/**
+ * @brief Mount a store.
+ *
+ * @param pxCfg store configuration.
+ * @param pxState store state.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreMount( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState );
+
+/**
+ * @brief Write or delete a record.
+ *
+ * @param eStore store to write.
+ * @param usId record ID.
+ * @param pvData record data.
+ * @param usLen record length, 0 to delete.
+ * @param ucLock take the store mutex.
+ *
+ * @return error code.
+ */
+static int32_t prvLogstoreWrite( xLogstoreId eStore, uint16_t usId,
+	const void *pvData, uint16_t usLen, uint8_t ucLock );
+
+/* function definition */
+
+static uint32_t prvLogstorePageAddr( const xLogstoreConfig_t *pxCfg,
+	uint8_t ucPage )
+{
+    return pxCfg->ulBase + ((uint32_t) ucPage * flashPAGE_SIZE);
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreIsBlank( uint32_t ulAddress, uint32_t ulLen,
+	uint8_t *pucBlank )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* words read from flash */
+    uint32_t ulWords[logstoreCHUNK_SIZE / sizeof(uint32_t)];
+    /* bytes to read in this iteration */
+    uint32_t ulChunk = 0;
+    /* index of word */
+    uint32_t ulIndex = 0;
+
+    *pucBlank = 1;
+    while(ulLen > 0)
+    {
+	ulChunk = (ulLen > logstoreCHUNK_SIZE) ? logstoreCHUNK_SIZE : ulLen;
+	lStatus = mml_sflc_read(ulAddress, (uint8_t *) ulWords, ulChunk);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	/* range is always word aligned */
+	for(ulIndex = 0; ulIndex < (ulChunk / sizeof(uint32_t)); ulIndex++)
+	{
+	    if(ulWords[ulIndex] != logstoreBLANK_WORD)
+	    {
+		*pucBlank = 0;
+		return NO_ERROR;
+	    }
+	}
+	ulAddress += ulChunk;
+	ulLen -= ulChunk;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreReadRecord( uint32_t ulAddress,
+	const xLogstoreRecHdr_t *pxHdr, uint8_t *pucData, uint16_t usLen,
+	uint8_t *pucValid )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* bounce buffer for data not copied to user */
+    uint8_t ucChunk[logstoreCHUNK_SIZE];
+    /* running CRC */
+    uint32_t ulCrc = 0;
+    /* offset in record data */
+    uint32_t ulOffset = 0;
+    /* bytes to read in this iteration */
+    uint32_t ulRead = 0;
+
+    *pucValid = 0;
+    /* CRC starts with ID, length and sequence */
+    ulCrc = ulCommonCrc32(0, (const uint8_t *) pxHdr,
+	    offsetof(xLogstoreRecHdr_t, ulCrc));
+    ulAddress += sizeof(xLogstoreRecHdr_t);
+
+    /* part of the record the user asked for is read in to user buffer */
+    if((pucData != NULL) && (usLen > 0))
+    {
+	ulRead = (usLen < pxHdr->usLen) ? usLen : pxHdr->usLen;
+	if(ulRead > 0)
+	{
+	    lStatus = mml_sflc_read(ulAddress, pucData, ulRead);
+	    if(lStatus != NO_ERROR)
+	    {
+		return lStatus;
+	    }
+	    ulCrc = ulCommonCrc32(ulCrc, pucData, ulRead);
+	    ulOffset = ulRead;
+	}
+    }
+
+    /* rest of the record is only needed for CRC */
+    while(ulOffset < pxHdr->usLen)
+    {
+	ulRead = pxHdr->usLen - ulOffset;
+	ulRead = (ulRead > logstoreCHUNK_SIZE) ? logstoreCHUNK_SIZE : ulRead;
+	lStatus = mml_sflc_read(ulAddress + ulOffset, ucChunk, ulRead);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	ulCrc = ulCommonCrc32(ulCrc, ucChunk, ulRead);
+	ulOffset += ulRead;
+    }
+
+    if(ulCrc == pxHdr->ulCrc)
+    {
+	*pucValid = 1;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreErasePage( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint8_t ucPage )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* page header to program */
+    xLogstorePageHdr_t xHdr;
+    /* page address */
+    uint32_t ulAddress = prvLogstorePageAddr(pxCfg, ucPage);
+
+    /* Page erase runs with interrupts enabled, only the store is locked */
+    lStatus = mml_sflc_erase(ulAddress, flashPAGE_SIZE);
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to erase page 0x%x \r\n", ulAddress);
+	return lStatus;
+    }
+    pxState->ulEraseCount[ucPage]++;
+    pxState->ulPageSeq[ucPage] = logstoreSEQ_FREE;
+    /* page is erased, it is not usable till the header is programmed */
+    pxState->ucState[ucPage] = logstorePAGE_DIRTY;
+
+    /* program the header, page sequence is left erased */
+    xHdr.ulMagic = logstorePAGE_MAGIC;
+    xHdr.ulEraseCount = pxState->ulEraseCount[ucPage];
+    xHdr.ulHdrCrc = ulCommonCrc32(0, (const uint8_t *) &xHdr,
+	    offsetof(xLogstorePageHdr_t, ulHdrCrc));
+    lStatus = mml_sflc_write(ulAddress, (uint8_t *) &xHdr,
+	    offsetof(xLogstorePageHdr_t, ulPageSeq));
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to format page 0x%x \r\n", ulAddress);
+	return lStatus;
+    }
+    pxState->ucState[ucPage] = logstorePAGE_FREE;
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreOpenPage( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint8_t ucPage, uint8_t ucCommit )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+
+    /* page left over from old format or a power off, erase it first */
+    if(pxState->ucState[ucPage] != logstorePAGE_FREE)
+    {
+	lStatus = prvLogstoreErasePage(pxCfg, pxState, ucPage);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+    }
+
+    pxState->ulPageSeq[ucPage] = pxState->ulNextPageSeq++;
+    pxState->ucState[ucPage] = logstorePAGE_USED;
+    pxState->ucActive = ucPage;
+    pxState->ulWriteOff = sizeof(xLogstorePageHdr_t);
+    if(ucCommit)
+    {
+	lStatus = prvLogstoreCommitPage(pxCfg, pxState, ucPage);
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreCommitPage( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint8_t ucPage )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* page sequence to program */
+    uint32_t ulPageSeq = pxState->ulPageSeq[ucPage];
+
+    /* page sequence word is still erased, program it */
+    lStatus = mml_sflc_write(prvLogstorePageAddr(pxCfg, ucPage) +
+	    offsetof(xLogstorePageHdr_t, ulPageSeq), (uint8_t *) &ulPageSeq,
+	    sizeof(ulPageSeq));
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to open page %d \r\n", ucPage);
+	/* nothing more goes in to this page */
+	pxState->ulWriteOff = flashPAGE_SIZE;
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreAppend( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint16_t usId, const uint8_t *pucData,
+	uint16_t usLen, uint8_t ucScrub )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* record header */
+    xLogstoreRecHdr_t xHdr;
+    /* address to append */
+    uint32_t ulAddress = 0;
+    /* address of the copy being superseded */
+    uint32_t ulOldAddress = pxState->ulRecAddr[usId];
+
+    ulAddress = prvLogstorePageAddr(pxCfg, pxState->ucActive) +
+	    pxState->ulWriteOff;
+
+    /* prepare the header */
+    xHdr.usId = usId;
+    xHdr.usLen = usLen;
+    xHdr.ulSeq = pxState->ulNextRecSeq++;
+    xHdr.ulCrc = ulCommonCrc32(0, (const uint8_t *) &xHdr,
+	    offsetof(xLogstoreRecHdr_t, ulCrc));
+    xHdr.ulCrc = ulCommonCrc32(xHdr.ulCrc, pucData, usLen);
+
+    /* data first, header last. Header marks the record as complete */
+    if(usLen > 0)
+    {
+	lStatus = mml_sflc_write(ulAddress + sizeof(xLogstoreRecHdr_t),
+		(uint8_t *) pucData, usLen);
+	if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("failed to write record data 0x%x \r\n",
+		    ulAddress);
+	    goto DISCARD;
+	}
+    }
+    lStatus = mml_sflc_write(ulAddress, (uint8_t *) &xHdr, sizeof(xHdr));
+    if(lStatus != NO_ERROR)
+    {
+	debugERROR_PRINT("failed to write record header 0x%x \r\n",
+		ulAddress);
+	goto DISCARD;
+    }
+
+    /* record is committed, update the index */
+    pxState->ulRecAddr[usId] = ulAddress;
+    pxState->ulRecSeq[usId] = xHdr.ulSeq;
+    pxState->usRecLen[usId] = usLen;
+    pxState->ulWriteOff += logstoreALIGN_UP(sizeof(xHdr) + usLen);
+
+    /* destroy the old copy if store holds secrets */
+    if((ucScrub) && (ulOldAddress != 0))
+    {
+	lStatus = prvLogstoreScrub(ulOldAddress);
+	if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("failed to scrub record 0x%x \r\n",
+		    ulOldAddress);
+	}
+    }
+    return lStatus;
+
+    /* partially programmed area can not be reused, close the page */
+    DISCARD:
+    pxState->ulWriteOff = flashPAGE_SIZE;
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreRelocate( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint16_t usId )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* record header */
+    xLogstoreRecHdr_t xHdr;
+    /* bounce buffer, flash can't be programmed from flash */
+    uint8_t ucChunk[logstoreCHUNK_SIZE];
+    /* source and destination address */
+    uint32_t ulSrc = pxState->ulRecAddr[usId];
+    uint32_t ulDst = 0;
+    /* offset in record data */
+    uint32_t ulOffset = 0;
+    /* bytes to copy in this iteration */
+    uint32_t ulCopy = 0;
+
+    ulDst = prvLogstorePageAddr(pxCfg, pxState->ucActive) +
+	    pxState->ulWriteOff;
+
+    lStatus = mml_sflc_read(ulSrc, (uint8_t *) &xHdr, sizeof(xHdr));
+    if(lStatus != NO_ERROR)
+    {
+	return lStatus;
+    }
+
+    /* copy the data */
+    while(ulOffset < xHdr.usLen)
+    {
+	ulCopy = xHdr.usLen - ulOffset;
+	ulCopy = (ulCopy > logstoreCHUNK_SIZE) ? logstoreCHUNK_SIZE : ulCopy;
+	lStatus = mml_sflc_read(ulSrc + sizeof(xHdr) + ulOffset, ucChunk,
+		ulCopy);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	lStatus = mml_sflc_write(ulDst + sizeof(xHdr) + ulOffset, ucChunk,
+		ulCopy);
+	if(lStatus != NO_ERROR)
+	{
+	    goto DISCARD;
+	}
+	ulOffset += ulCopy;
+    }
+
+    /* same header, same sequence. Copy and original are identical */
+    lStatus = mml_sflc_write(ulDst, (uint8_t *) &xHdr, sizeof(xHdr));
+    if(lStatus != NO_ERROR)
+    {
+	goto DISCARD;
+    }
+    pxState->ulRecAddr[usId] = ulDst;
+    pxState->ulWriteOff += logstoreALIGN_UP(sizeof(xHdr) + xHdr.usLen);
+    return lStatus;
+
+    /* partially programmed area can not be reused, close the page */
+    DISCARD:
+    debugERROR_PRINT("failed to relocate record 0x%x \r\n", ulSrc);
+    pxState->ulWriteOff = flashPAGE_SIZE;
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreScrub( uint32_t ulAddress )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* record header */
+    xLogstoreRecHdr_t xHdr;
+    /* zeros to program */
+    uint8_t ucZero[logstoreCHUNK_SIZE];
+    /* bytes left to scrub */
+    uint32_t ulLen = 0;
+    /* bytes to scrub in this iteration */
+    uint32_t ulChunk = 0;
+
+    lStatus = mml_sflc_read(ulAddress, (uint8_t *) &xHdr, sizeof(xHdr));
+    if(lStatus != NO_ERROR)
+    {
+	return lStatus;
+    }
+    memset(ucZero, 0, sizeof(ucZero));
+
+    /* clear sequence and CRC first, record is invalid from here on */
+    lStatus = mml_sflc_write(ulAddress + offsetof(xLogstoreRecHdr_t, ulSeq),
+	    ucZero, sizeof(xHdr) - offsetof(xLogstoreRecHdr_t, ulSeq));
+    if(lStatus != NO_ERROR)
+    {
+	return lStatus;
+    }
+
+    /* now the data */
+    ulAddress += sizeof(xHdr);
+    ulLen = logstoreALIGN_UP(xHdr.usLen);
+    while(ulLen > 0)
+    {
+	ulChunk = (ulLen > logstoreCHUNK_SIZE) ? logstoreCHUNK_SIZE : ulLen;
+	lStatus = mml_sflc_write(ulAddress, ucZero, ulChunk);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	ulAddress += ulChunk;
+	ulLen -= ulChunk;
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreMakeRoom( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint16_t usId, const uint8_t *pucData,
+	uint16_t usLen, uint8_t *pucDone )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* space needed */
+    uint32_t ulRecSize = logstoreALIGN_UP(sizeof(xLogstoreRecHdr_t) + usLen);
+    /* number of free pages */
+    uint8_t ucFree = 0;
+    /* page to open */
+    uint8_t ucOpen = logstoreNO_PAGE;
+    /* page to collect */
+    uint8_t ucVictim = logstoreNO_PAGE;
+    /* victim page address */
+    uint32_t ulVictimAddr = 0;
+    /* index of page */
+    uint8_t ucPage = 0;
+    /* index of record */
+    uint16_t usRec = 0;
+    /* attempts, each one opens or collects a page */
+    uint8_t ucTry = 0;
+
+    *pucDone = 0;
+    for(ucTry = 0; ucTry <= pxCfg->ucPages; ucTry++)
+    {
+	/* check if record fits in the active page */
+	if((pxState->ucActive != logstoreNO_PAGE) &&
+		((pxState->ulWriteOff + ulRecSize) <= flashPAGE_SIZE))
+	{
+	    return NO_ERROR;
+	}
+	/* active page is full, it stays as it is till it is collected */
+	pxState->ucActive = logstoreNO_PAGE;
+
+	/* find free page with least erase count, and oldest used page */
+	ucFree = 0;
+	ucOpen = logstoreNO_PAGE;
+	ucVictim = logstoreNO_PAGE;
+	for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+	{
+	    if((pxState->ucState[ucPage] == logstorePAGE_FREE) ||
+		    (pxState->ucState[ucPage] == logstorePAGE_DIRTY))
+	    {
+		ucFree++;
+		if((ucOpen == logstoreNO_PAGE) ||
+			(pxState->ulEraseCount[ucPage] <
+				pxState->ulEraseCount[ucOpen]))
+		{
+		    ucOpen = ucPage;
+		}
+	    }
+	    else if(pxState->ucState[ucPage] == logstorePAGE_USED)
+	    {
+		if((ucVictim == logstoreNO_PAGE) ||
+			(pxState->ulPageSeq[ucPage] <
+				pxState->ulPageSeq[ucVictim]))
+		{
+		    ucVictim = ucPage;
+		}
+	    }
+	}
+
+	if(ucOpen == logstoreNO_PAGE)
+	{
+	    /* spare page is always kept, can not happen */
+	    debugERROR_PRINT("record store has no spare page \r\n");
+	    return COMMON_ERR_BAD_STATE;
+	}
+
+	/* open the free page, if it is not the spare one */
+	if((ucFree > 1) || (ucVictim == logstoreNO_PAGE) ||
+		(pxState->ucImporting))
+	{
+	    lStatus = prvLogstoreOpenPage(pxCfg, pxState, ucOpen, 1);
+	    if(lStatus != NO_ERROR)
+	    {
+		return lStatus;
+	    }
+	    continue;
+	}
+
+	/* spare page is opened, collect the oldest page in to it */
+	lStatus = prvLogstoreOpenPage(pxCfg, pxState, ucOpen, 0);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	ulVictimAddr = prvLogstorePageAddr(pxCfg, ucVictim);
+	for(usRec = 0; usRec < pxCfg->ucMaxIds; usRec++)
+	{
+	    if((usRec != usId) &&
+		    (pxState->ulRecAddr[usRec] >= ulVictimAddr) &&
+		    (pxState->ulRecAddr[usRec] < (ulVictimAddr + flashPAGE_SIZE)))
+	    {
+		lStatus = prvLogstoreRelocate(pxCfg, pxState, usRec);
+		if(lStatus != NO_ERROR)
+		{
+		    goto REMOUNT;
+		}
+	    }
+	}
+
+	/* record being written lives in the victim, new copy must reach flash
+	 * before the victim is erased.
+	 */
+	if((pxState->ulRecAddr[usId] >= ulVictimAddr) &&
+		(pxState->ulRecAddr[usId] < (ulVictimAddr + flashPAGE_SIZE)))
+	{
+	    if((pxState->ulWriteOff + ulRecSize) <= flashPAGE_SIZE)
+	    {
+		/* no scrub, old copy goes with the page erase */
+		lStatus = prvLogstoreAppend(pxCfg, pxState, usId, pucData,
+			usLen, 0);
+		*pucDone = 1;
+	    }
+	    else
+	    {
+		lStatus = prvLogstoreRelocate(pxCfg, pxState, usId);
+	    }
+	    if(lStatus != NO_ERROR)
+	    {
+		goto REMOUNT;
+	    }
+	}
+
+	/* copies are complete, from now on they win over the victim */
+	lStatus = prvLogstoreCommitPage(pxCfg, pxState, ucOpen);
+	if(lStatus != NO_ERROR)
+	{
+	    goto REMOUNT;
+	}
+
+	/* victim holds no live record now */
+	lStatus = prvLogstoreErasePage(pxCfg, pxState, ucVictim);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	pxState->ulCollections++;
+	if(*pucDone)
+	{
+	    return NO_ERROR;
+	}
+    }
+
+    /* live records leave no room for this one */
+    debugERROR_PRINT("record store is full \r\n");
+    return COMMON_ERR_OUT_OF_RANGE;
+
+REMOUNT:
+    /* index points in to a page that is not committed, rebuild it */
+    *pucDone = 0;
+    (void) prvLogstoreMount(pxCfg, pxState);
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreImport( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState, uint32_t ulPartition )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* old partition address */
+    uint32_t ulAddress = pxCfg->ulBase;
+    /* old partition image */
+    uint8_t *pucImage = NULL;
+    /* record in the image */
+    uint8_t *pucRec = NULL;
+    /* image size */
+    uint32_t ulSize = pxCfg->xLegacy.usHdrLen +
+	    ((uint32_t) pxCfg->xLegacy.usRecLen * pxCfg->xLegacy.usRecCount);
+    /* record magic */
+    uint32_t ulRecMagic = 0;
+    /* index of page */
+    uint8_t ucPage = 0;
+    /* index of record */
+    uint16_t usRec = 0;
+    /* record appended while collecting */
+    uint8_t ucDone = 0;
+
+    if(ulPartition == commonPARTITION2)
+    {
+	ulAddress += pxCfg->xLegacy.ulPart2Offset;
+    }
+    debugPRINT("importing old partition 0x%x \r\n", ulAddress);
+
+    pucImage = (uint8_t *) pvPortMalloc(ulSize);
+    if(pucImage == NULL)
+    {
+	debugERROR_PRINT("Failed to allocate memory for import \r\n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    lStatus = mml_sflc_read(ulAddress, pucImage, ulSize);
+    if(lStatus != NO_ERROR)
+    {
+	goto CLEANUP;
+    }
+
+    /* start over, pages of the valid partition are kept as they are */
+    pxState->ucActive = logstoreNO_PAGE;
+    pxState->ucImporting = 1;
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	if((prvLogstorePageAddr(pxCfg, ucPage) >= ulAddress) &&
+		(prvLogstorePageAddr(pxCfg, ucPage) <
+			(ulAddress + pxCfg->xLegacy.ulPart2Offset)))
+	{
+	    pxState->ucState[ucPage] = logstorePAGE_LEGACY;
+	}
+	else
+	{
+	    lStatus = prvLogstoreErasePage(pxCfg, pxState, ucPage);
+	    if(lStatus != NO_ERROR)
+	    {
+		goto CLEANUP;
+	    }
+	}
+    }
+
+    /* append the records */
+    for(usRec = 0; usRec < pxCfg->xLegacy.usRecCount; usRec++)
+    {
+	pucRec = pucImage + pxCfg->xLegacy.usHdrLen +
+		((uint32_t) usRec * pxCfg->xLegacy.usRecLen);
+	memcpy(&ulRecMagic, pucRec, sizeof(ulRecMagic));
+	if((pxCfg->xLegacy.ulRecMagic != 0) &&
+		(ulRecMagic != pxCfg->xLegacy.ulRecMagic))
+	{
+	    continue;
+	}
+	lStatus = prvLogstoreMakeRoom(pxCfg, pxState, usRec, pucRec,
+		pxCfg->xLegacy.usRecLen, &ucDone);
+	if((lStatus == NO_ERROR) && (!ucDone))
+	{
+	    lStatus = prvLogstoreAppend(pxCfg, pxState, usRec, pucRec,
+		    pxCfg->xLegacy.usRecLen, 0);
+	}
+	if(lStatus != NO_ERROR)
+	{
+	    goto CLEANUP;
+	}
+    }
+
+    /* all records committed, old partition can go. Lowest page holds the
+     * magic, it is erased first.
+     */
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	if(pxState->ucState[ucPage] == logstorePAGE_LEGACY)
+	{
+	    lStatus = prvLogstoreErasePage(pxCfg, pxState, ucPage);
+	    if(lStatus != NO_ERROR)
+	    {
+		goto CLEANUP;
+	    }
+	}
+    }
+
+    /* clean up the allocated memory before returning error */
+    CLEANUP:
+    pxState->ucImporting = 0;
+    /* image may hold secrets */
+    memset(pucImage, 0, ulSize);
+    vPortFree(pucImage);
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreMount( const xLogstoreConfig_t *pxCfg,
+	xLogstoreState_t *pxState )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* page header */
+    xLogstorePageHdr_t xPageHdr;
+    /* record header */
+    xLogstoreRecHdr_t xRecHdr;
+    /* page address */
+    uint32_t ulPageAddr = 0;
+    /* offset in page */
+    uint32_t ulOffset = 0;
+    /* record size */
+    uint32_t ulRecSize = 0;
+    /* highest erase count seen */
+    uint32_t ulMaxErase = 0;
+    /* last page sequence scanned */
+    uint32_t ulLastSeq = 0;
+    /* valid partition of old format */
+    int32_t lPartition = 0;
+    /* index of page */
+    uint8_t ucPage = 0;
+    /* page to scan next */
+    uint8_t ucNext = 0;
+    /* flags */
+    uint8_t ucBlank = 0;
+    uint8_t ucValid = 0;
+    /* index of record */
+    uint16_t usRec = 0;
+
+    /* start with empty state, mutex is kept */
+    memset(pxState->ulRecAddr, 0, sizeof(pxState->ulRecAddr));
+    memset(pxState->ulRecSeq, 0, sizeof(pxState->ulRecSeq));
+    memset(pxState->usRecLen, 0, sizeof(pxState->usRecLen));
+    pxState->ucActive = logstoreNO_PAGE;
+    pxState->ucMounted = 0;
+    pxState->ulWriteOff = flashPAGE_SIZE;
+    pxState->ulNextRecSeq = 1;
+    pxState->ulNextPageSeq = 1;
+
+    /* classify the pages */
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	ulPageAddr = prvLogstorePageAddr(pxCfg, ucPage);
+	lStatus = mml_sflc_read(ulPageAddr, (uint8_t *) &xPageHdr,
+		sizeof(xPageHdr));
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	pxState->ulPageSeq[ucPage] = logstoreSEQ_FREE;
+	pxState->ucState[ucPage] = logstorePAGE_DIRTY;
+	if((xPageHdr.ulMagic != logstorePAGE_MAGIC) ||
+		(xPageHdr.ulHdrCrc != ulCommonCrc32(0,
+			(const uint8_t *) &xPageHdr,
+			offsetof(xLogstorePageHdr_t, ulHdrCrc))))
+	{
+	    /* not a store page, erase count is not known */
+	    pxState->ulEraseCount[ucPage] = 0;
+	    continue;
+	}
+	pxState->ulEraseCount[ucPage] = xPageHdr.ulEraseCount;
+	if(xPageHdr.ulEraseCount > ulMaxErase)
+	{
+	    ulMaxErase = xPageHdr.ulEraseCount;
+	}
+	if(xPageHdr.ulPageSeq != logstoreSEQ_FREE)
+	{
+	    pxState->ucState[ucPage] = logstorePAGE_USED;
+	    pxState->ulPageSeq[ucPage] = xPageHdr.ulPageSeq;
+	    if(xPageHdr.ulPageSeq >= pxState->ulNextPageSeq)
+	    {
+		pxState->ulNextPageSeq = xPageHdr.ulPageSeq + 1;
+	    }
+	    continue;
+	}
+	/* free page must be blank after the header */
+	lStatus = prvLogstoreIsBlank(ulPageAddr + sizeof(xPageHdr),
+		flashPAGE_SIZE - sizeof(xPageHdr), &ucBlank);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	if(ucBlank)
+	{
+	    pxState->ucState[ucPage] = logstorePAGE_FREE;
+	}
+    }
+
+    /* pages without header get the highest erase count seen, best guess */
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	if((pxState->ucState[ucPage] == logstorePAGE_DIRTY) &&
+		(pxState->ulEraseCount[ucPage] == 0))
+	{
+	    pxState->ulEraseCount[ucPage] = ulMaxErase;
+	}
+    }
+
+    /* data still in old A/B partition format is imported */
+    if(pxCfg->xLegacy.ulMagic != 0)
+    {
+	lPartition = lCommonChoosePartition(pxCfg->ulBase,
+		pxCfg->ulBase + pxCfg->xLegacy.ulPart2Offset,
+		pxCfg->xLegacy.ulMagic, sizeof(pxCfg->xLegacy.ulMagic));
+	if((lPartition == commonPARTITION1) ||
+		(lPartition == commonPARTITION2))
+	{
+	    lStatus = prvLogstoreImport(pxCfg, pxState, lPartition);
+	    if(lStatus == NO_ERROR)
+	    {
+		pxState->ucMounted = 1;
+	    }
+	    return lStatus;
+	}
+	else if(lPartition != commonPARTITIONNONE)
+	{
+	    return lPartition;
+	}
+    }
+
+    /* scan the used pages, oldest first, so newest copy of a record wins */
+    while(1)
+    {
+	ucNext = logstoreNO_PAGE;
+	for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+	{
+	    if((pxState->ucState[ucPage] == logstorePAGE_USED) &&
+		    (pxState->ulPageSeq[ucPage] > ulLastSeq) &&
+		    ((ucNext == logstoreNO_PAGE) ||
+		     (pxState->ulPageSeq[ucPage] <
+			     pxState->ulPageSeq[ucNext])))
+	    {
+		ucNext = ucPage;
+	    }
+	}
+	if(ucNext == logstoreNO_PAGE)
+	{
+	    break;
+	}
+	ulLastSeq = pxState->ulPageSeq[ucNext];
+	ulPageAddr = prvLogstorePageAddr(pxCfg, ucNext);
+
+	ulOffset = sizeof(xPageHdr);
+	while((ulOffset + sizeof(xRecHdr)) <= flashPAGE_SIZE)
+	{
+	    lStatus = mml_sflc_read(ulPageAddr + ulOffset,
+		    (uint8_t *) &xRecHdr, sizeof(xRecHdr));
+	    if(lStatus != NO_ERROR)
+	    {
+		return lStatus;
+	    }
+	    /* end of log in this page */
+	    if((xRecHdr.usId == 0xFFFF) && (xRecHdr.usLen == 0xFFFF))
+	    {
+		break;
+	    }
+	    ulRecSize = logstoreALIGN_UP(sizeof(xRecHdr) + xRecHdr.usLen);
+	    if((xRecHdr.usId >= pxCfg->ucMaxIds) ||
+		    ((ulOffset + ulRecSize) > flashPAGE_SIZE))
+	    {
+		/* header torn by power off, nothing after it can be trusted */
+		debugPRINT("record store page %d torn at 0x%x \r\n",
+			ucNext, ulOffset);
+		ulOffset = flashPAGE_SIZE;
+		break;
+	    }
+	    /* scrubbed copies have sequence 0 */
+	    if(xRecHdr.ulSeq != 0)
+	    {
+		lStatus = prvLogstoreReadRecord(ulPageAddr + ulOffset,
+			&xRecHdr, NULL, 0, &ucValid);
+		if(lStatus != NO_ERROR)
+		{
+		    return lStatus;
+		}
+		if((ucValid) &&
+			(xRecHdr.ulSeq >= pxState->ulRecSeq[xRecHdr.usId]))
+		{
+		    pxState->ulRecAddr[xRecHdr.usId] = ulPageAddr + ulOffset;
+		    pxState->ulRecSeq[xRecHdr.usId] = xRecHdr.ulSeq;
+		    pxState->usRecLen[xRecHdr.usId] = xRecHdr.usLen;
+		}
+		if(xRecHdr.ulSeq >= pxState->ulNextRecSeq)
+		{
+		    pxState->ulNextRecSeq = xRecHdr.ulSeq + 1;
+		}
+	    }
+	    ulOffset += ulRecSize;
+	}
+
+	/* appending continues only in the newest page, and only if the rest
+	 * of it was never touched.
+	 */
+	if(ulOffset < flashPAGE_SIZE)
+	{
+	    lStatus = prvLogstoreIsBlank(ulPageAddr + ulOffset,
+		    flashPAGE_SIZE - ulOffset, &ucBlank);
+	    if(lStatus != NO_ERROR)
+	    {
+		return lStatus;
+	    }
+	    if(!ucBlank)
+	    {
+		ulOffset = flashPAGE_SIZE;
+	    }
+	}
+	pxState->ucActive = ucNext;
+	pxState->ulWriteOff = ulOffset;
+    }
+
+    /* pages left with copies only, by a collection cut by power off, are
+     * erased now.
+     */
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	if((pxState->ucState[ucPage] != logstorePAGE_USED) ||
+		(ucPage == pxState->ucActive))
+	{
+	    continue;
+	}
+	ulPageAddr = prvLogstorePageAddr(pxCfg, ucPage);
+	for(usRec = 0; usRec < pxCfg->ucMaxIds; usRec++)
+	{
+	    if((pxState->ulRecAddr[usRec] >= ulPageAddr) &&
+		    (pxState->ulRecAddr[usRec] < (ulPageAddr + flashPAGE_SIZE)))
+	    {
+		break;
+	    }
+	}
+	if(usRec == pxCfg->ucMaxIds)
+	{
+	    lStatus = prvLogstoreErasePage(pxCfg, pxState, ucPage);
+	    if(lStatus != NO_ERROR)
+	    {
+		return lStatus;
+	    }
+	}
+    }
+
+    pxState->ucMounted = 1;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvLogstoreWrite( xLogstoreId eStore, uint16_t usId,
+	const void *pvData, uint16_t usLen, uint8_t ucLock )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* store configuration */
+    const xLogstoreConfig_t *pxCfg = NULL;
+    /* store state */
+    xLogstoreState_t *pxState = NULL;
+    /* record appended while collecting */
+    uint8_t ucDone = 0;
+
+    if((eStore >= eLOGSTORE_MAX) || ((pvData == NULL) && (usLen != 0)))
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_INVAL;
+    }
+    pxCfg = &xLogstoreConfig[eStore];
+    pxState = &xLogstoreState[eStore];
+    if((usId >= pxCfg->ucMaxIds) || (logstoreALIGN_UP(sizeof(
+	    xLogstoreRecHdr_t) + usLen) >
+	    (flashPAGE_SIZE - sizeof(xLogstorePageHdr_t))))
+    {
+	debugERROR_PRINT("Invalid record \n");
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if(!pxState->ucMounted)
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    if(ucLock)
+    {
+	xSemaphoreTake(pxState->xLock, portMAX_DELAY);
+    }
+
+    /* deleting a record which is not there */
+    if((usLen == 0) && ((pxState->ulRecAddr[usId] == 0) ||
+	    (pxState->usRecLen[usId] == 0)))
+    {
+	goto UNLOCK;
+    }
+
+    lStatus = prvLogstoreMakeRoom(pxCfg, pxState, usId,
+	    (const uint8_t *) pvData, usLen, &ucDone);
+    if((lStatus == NO_ERROR) && (!ucDone))
+    {
+	lStatus = prvLogstoreAppend(pxCfg, pxState, usId,
+		(const uint8_t *) pvData, usLen,
+		(pxCfg->ucFlags & logstoreFLAG_SCRUB));
+    }
+
+    UNLOCK:
+    if(ucLock)
+    {
+	xSemaphoreGive(pxState->xLock);
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreInit( void )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* index of store */
+    uint8_t ucStore = 0;
+
+    for(ucStore = 0; ucStore < eLOGSTORE_MAX; ucStore++)
+    {
+	if(xLogstoreState[ucStore].xLock == NULL)
+	{
+	    xLogstoreState[ucStore].xLock = xSemaphoreCreateMutex();
+	    if(xLogstoreState[ucStore].xLock == NULL)
+	    {
+		debugERROR_PRINT("Failed to create record store mutex \r\n");
+		return COMMON_ERR_NULL_PTR;
+	    }
+	}
+	lStatus = prvLogstoreMount(&xLogstoreConfig[ucStore],
+		&xLogstoreState[ucStore]);
+	if(lStatus != NO_ERROR)
+	{
+	    debugERROR_PRINT("Failed to mount record store %d \r\n", ucStore);
+	    return lStatus;
+	}
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreRead( xLogstoreId eStore, uint16_t usId, void *pvData,
+	uint16_t usLen )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* store state */
+    xLogstoreState_t *pxState = NULL;
+    /* record header */
+    xLogstoreRecHdr_t xHdr;
+    /* record address */
+    uint32_t ulAddress = 0;
+    /* CRC check result */
+    uint8_t ucValid = 0;
+    /* attempt */
+    uint8_t ucTry = 0;
+
+    if((eStore >= eLOGSTORE_MAX) || (pvData == NULL))
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    pxState = &xLogstoreState[eStore];
+    if(!pxState->ucMounted)
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+    if(usId >= xLogstoreConfig[eStore].ucMaxIds)
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+
+    /* No lock taken, a writer can move the record while it is being read.
+     * Header and CRC tell if what was read is the record, else read again.
+     */
+    for(ucTry = 0; ucTry < logstoreREAD_RETRY; ucTry++)
+    {
+	ulAddress = pxState->ulRecAddr[usId];
+	if(ulAddress == 0)
+	{
+	    return COMMON_ERR_NO_MATCH;
+	}
+	lStatus = mml_sflc_read(ulAddress, (uint8_t *) &xHdr, sizeof(xHdr));
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	if((xHdr.usId != usId) || (xHdr.ulSeq == 0) ||
+		(xHdr.usLen > flashPAGE_SIZE))
+	{
+	    continue;
+	}
+	if(xHdr.usLen == 0)
+	{
+	    /* record is deleted */
+	    return COMMON_ERR_NO_MATCH;
+	}
+	lStatus = prvLogstoreReadRecord(ulAddress, &xHdr, (uint8_t *) pvData,
+		usLen, &ucValid);
+	if(lStatus != NO_ERROR)
+	{
+	    return lStatus;
+	}
+	if(ucValid)
+	{
+	    /* record shorter than the buffer, pad it as erased flash */
+	    if(usLen > xHdr.usLen)
+	    {
+		memset((uint8_t *) pvData + xHdr.usLen, commonDEFAULT_VALUE,
+			usLen - xHdr.usLen);
+	    }
+	    return NO_ERROR;
+	}
+    }
+    debugERROR_PRINT("record %d CRC error \r\n", usId);
+    return COMMON_ERR_BAD_STATE;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreGetRecordAddr( xLogstoreId eStore, uint16_t usId,
+	uint32_t *pulAddress )
+{
+    if((eStore >= eLOGSTORE_MAX) || (pulAddress == NULL))
+    {
+	debugERROR_PRINT("Invalid argument \n");
+	return COMMON_ERR_NULL_PTR;
+    }
+    if(!xLogstoreState[eStore].ucMounted)
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+    if(usId >= xLogstoreConfig[eStore].ucMaxIds)
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    *pulAddress = xLogstoreState[eStore].ulRecAddr[usId];
+    return (*pulAddress == 0) ? COMMON_ERR_NO_MATCH : NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreWrite( xLogstoreId eStore, uint16_t usId, const void *pvData,
+	uint16_t usLen )
+{
+    if(usLen == 0)
+    {
+	return COMMON_ERR_INVAL;
+    }
+    return prvLogstoreWrite(eStore, usId, pvData, usLen, 1);
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreWriteNONRTOS( xLogstoreId eStore, uint16_t usId,
+	const void *pvData, uint16_t usLen )
+{
+    if(usLen == 0)
+    {
+	return COMMON_ERR_INVAL;
+    }
+    return prvLogstoreWrite(eStore, usId, pvData, usLen, 0);
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreDelete( xLogstoreId eStore, uint16_t usId )
+{
+    return prvLogstoreWrite(eStore, usId, NULL, 0, 1);
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreFormat( xLogstoreId eStore )
+{
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+    /* store configuration */
+    const xLogstoreConfig_t *pxCfg = NULL;
+    /* store state */
+    xLogstoreState_t *pxState = NULL;
+    /* index of page */
+    uint8_t ucPage = 0;
+
+    if(eStore >= eLOGSTORE_MAX)
+    {
+	return COMMON_ERR_INVAL;
+    }
+    pxCfg = &xLogstoreConfig[eStore];
+    pxState = &xLogstoreState[eStore];
+    if(pxState->xLock != NULL)
+    {
+	xSemaphoreTake(pxState->xLock, portMAX_DELAY);
+    }
+
+    /* drop the index first, records are gone once erase starts */
+    memset(pxState->ulRecAddr, 0, sizeof(pxState->ulRecAddr));
+    memset(pxState->ulRecSeq, 0, sizeof(pxState->ulRecSeq));
+    memset(pxState->usRecLen, 0, sizeof(pxState->usRecLen));
+    pxState->ucActive = logstoreNO_PAGE;
+    pxState->ulWriteOff = flashPAGE_SIZE;
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	lStatus = prvLogstoreErasePage(pxCfg, pxState, ucPage);
+	if(lStatus != NO_ERROR)
+	{
+	    break;
+	}
+    }
+
+    if(pxState->xLock != NULL)
+    {
+	xSemaphoreGive(pxState->xLock);
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lLogstoreGetInfo( xLogstoreId eStore, xLogstoreInfo_t *pxInfo )
+{
+    /* store configuration */
+    const xLogstoreConfig_t *pxCfg = NULL;
+    /* store state */
+    xLogstoreState_t *pxState = NULL;
+    /* index of page */
+    uint8_t ucPage = 0;
+    /* index of record */
+    uint16_t usRec = 0;
+    /* number of free pages */
+    uint8_t ucFree = 0;
+
+    if((eStore >= eLOGSTORE_MAX) || (pxInfo == NULL))
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    pxCfg = &xLogstoreConfig[eStore];
+    pxState = &xLogstoreState[eStore];
+
+    memset(pxInfo, 0, sizeof(xLogstoreInfo_t));
+    pxInfo->ulMinEraseCount = 0xFFFFFFFFU;
+    for(usRec = 0; usRec < pxCfg->ucMaxIds; usRec++)
+    {
+	if((pxState->ulRecAddr[usRec] != 0) && (pxState->usRecLen[usRec] != 0))
+	{
+	    pxInfo->ulRecords++;
+	}
+    }
+    for(ucPage = 0; ucPage < pxCfg->ucPages; ucPage++)
+    {
+	if((pxState->ucState[ucPage] == logstorePAGE_FREE) ||
+		(pxState->ucState[ucPage] == logstorePAGE_DIRTY))
+	{
+	    ucFree++;
+	}
+	if(pxState->ulEraseCount[ucPage] < pxInfo->ulMinEraseCount)
+	{
+	    pxInfo->ulMinEraseCount = pxState->ulEraseCount[ucPage];
+	}
+	if(pxState->ulEraseCount[ucPage] > pxInfo->ulMaxEraseCount)
+	{
+	    pxInfo->ulMaxEraseCount = pxState->ulEraseCount[ucPage];
+	}
+    }
+    /* one free page is kept as spare for collection */
+    if(ucFree > 1)
+    {
+	pxInfo->ulFreeBytes = (ucFree - 1) *
+		(flashPAGE_SIZE - sizeof(xLogstorePageHdr_t));
+    }
+    if(pxState->ucActive != logstoreNO_PAGE)
+    {
+	pxInfo->ulFreeBytes += flashPAGE_SIZE - pxState->ulWriteOff;
+    }
+    pxInfo->ulCollections = pxState->ulCollections;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
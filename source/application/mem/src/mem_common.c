@@ -47,6 +47,8 @@
 
 /* local includes */
 #include <mem_common.h>
+#include <logstore.h>
+#include <keyfobid.h>
 #include <../src/flash.h>
 
 /* function definition */
@@ -171,22 +173,25 @@ int32_t lCommonEraseFlashRTOS (uint32_t ulAddress, uint32_t ulLength)
 
 int32_t lcommonEraseEncyKey ( void )
 {
-   return lCommonEraseFlash(flashENC_KEY_START_ADDR,
-	   flashENC_KEY_SIZE);
+   return lLogstoreFormat(eLOGSTORE_ENC_KEY);
 }
 /*----------------------------------------------------------------------------*/
 
 int32_t lcommonEraseAccessKey ( void )
 {
-    return lCommonEraseFlash(flashACCESS_KEY_START_ADDR,
-	    flashACCESS_KEY_SIZE);
+    return lLogstoreFormat(eLOGSTORE_ACCESS_KEY);
 }
 /*----------------------------------------------------------------------------*/
 
 int32_t lcommonEraseKeyFobId( void )
 {
-    return lCommonEraseFlash(flashKEYFOB_ID_START_ADDR,
-	    flashKEYFOB_ID_SIZE);
+    /* status to return */
+    int32_t lStatus = NO_ERROR;
+
+    lStatus = lLogstoreFormat(eLOGSTORE_KEYFOB_ID);
+    /* keyfob table is gone, drop the RAM index of it */
+    vKeyfobidInvalidateIndex();
+    return lStatus;
 }
 /*----------------------------------------------------------------------------*/
 
@@ -203,3 +208,29 @@ int32_t lCommonEraseFlash (uint32_t ulAddress, uint32_t ulLen)
     return mml_sflc_erase(ulAddress,ulLen);
 }
 /*----------------------------------------------------------------------------*/
+
+uint32_t ulCommonCrc32( uint32_t ulCrc, const uint8_t *pucData, uint32_t ulLen )
+{
+    /* CRC-32 (IEEE 802.3, reflected 0xEDB88320) table, one nibble at a time
+     * to keep the table small.
+     */
+    static const uint32_t ulCrcTable[16] =
+    {
+	0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU,
+	0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+	0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU,
+	0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU
+    };
+
+    /* continue from the previous CRC */
+    ulCrc = ~ulCrc;
+    while(ulLen > 0)
+    {
+	ulCrc ^= *pucData++;
+	ulCrc = (ulCrc >> 4) ^ ulCrcTable[ulCrc & 0x0F];
+	ulCrc = (ulCrc >> 4) ^ ulCrcTable[ulCrc & 0x0F];
+	ulLen--;
+    }
+    return ~ulCrc;
+}
+/*----------------------------------------------------------------------------*/
@@ -37,7 +37,7 @@
 #include <errors.h>
 #include <string.h>
 #include <stddef.h>
-#include <freeRTOS.h>
+#include <FreeRTOS.h>
 /* Local include */
 #include <mml.h>	/** include Cobra api's and macros*/
 #include <nvsram.h>	/** include nvsram header */
@@ -41,7 +41,20 @@
 
 #define i2cINDEX_0	(0) /**<Array index 0*/
 #define i2cINDEX_1	(1) /**<Array index 1*/
-#define i2cSIZE		(4) /**<I2c read/write size*/
+#define i2cBAUDRATE	(400000) /**<I2c bus clock, Hz*/
+#define i2cFIFO_DEPTH	(8) /**<I2c controller FIFO depth*/
+#define i2cMAX_READ_COUNT	(255) /**<Largest read programmed at once*/
+#define i2cTIMEOUT_MIN_MS	(10) /**<Timeout of a transfer on top of its wire time*/
+
+#define i2cPHASE_IDLE	(0) /**<No transfer*/
+#define i2cPHASE_WRITE	(1) /**<Writing register address and data*/
+#define i2cPHASE_READ	(2) /**<Reading data*/
+
+#define i2cGIO_PORT	(MML_GPIO_DEV0) /**<Port of the I2C pins*/
+#define i2cSDA_GIO	(8) /**<SDA - P0.8, driven as GPIO for bus recovery*/
+#define i2cSCL_GIO	(9) /**<SCL - P0.9, driven as GPIO for bus recovery*/
+#define i2cRECOVERY_CLOCKS	(9) /**<Clocks to free a slave holding SDA*/
+#define i2cRECOVERY_HALF_CLOCK_US	(5) /**<Half period of a recovery clock*/
 
 /** @brief iI2cInit used to initialize I2C.
  *
@@ -72,6 +85,26 @@ int32_t lI2cWrite(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
 int32_t lI2cRead(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
 	uint32_t ulLength, uint8_t *pucData);
 
+/** @brief lI2cTransfer writes the register address and data, then reads
+ * data with a repeated start. Either part may be empty. Any length is taken,
+ * the calling task sleeps until the interrupt handler ends the transfer.
+ *
+ * A transfer which does not end in time returns COMMON_ERR_FATAL_ERROR after
+ * the bus has been recovered.
+ *
+ * @param ucSlaveAddr slave address.
+ * @param ucRegAddr register address.
+ * @param pucTx data to write after the register address.
+ * @param ulTxLen length of data to write.
+ * @param pucRx buffer for data read.
+ * @param ulRxLen length of data to read.
+ *
+ * @return 0 on success and error code on failure.
+ */
+int32_t lI2cTransfer(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
+	const uint8_t *pucTx, uint32_t ulTxLen, uint8_t *pucRx,
+	uint32_t ulRxLen);
+
 /** @brief iI2cIRQHandler interrupt handler.
  *
  * @return void.
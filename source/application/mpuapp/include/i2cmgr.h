@@ -0,0 +1,167 @@
+ /**===========================================================================
+ * @file i2cmgr.h
+ *
+ * @brief This file contains the interface of the I2C bus manager. The manager
+ * task owns the controller and runs the transfers of its clients in
+ * priority order, earliest deadline first among equal priorities.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef INCLUDE_I2CMGR_H_
+#define INCLUDE_I2CMGR_H_
+
+#include <stdint.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+
+#define i2cmgrLE_PRIORITY	(1)	/**< Proximity traffic goes first */
+#define i2cmgrMPU_PRIORITY	(0)	/**< Motion sensor traffic */
+#define i2cmgrLE_DEADLINE_MS	(5)	/**< Default deadline of an LE request */
+#define i2cmgrMPU_DEADLINE_MS	(100)	/**< Default deadline of an MPU request */
+
+/**
+ * I2C bus clients
+ */
+typedef enum
+{
+    eI2CMGR_CLIENT_LE = 0,	/**< LE controller */
+    eI2CMGR_CLIENT_MPU,		/**< motion sensor, and any other slave */
+    eI2CMGR_CLIENT_COUNT,
+} i2cmgrClient_t;
+
+/**
+ * @brief One register transaction. The register address is written, then
+ * pucTx, then pucRx is read with a repeated start.
+ */
+typedef struct
+{
+    /** slave address */
+    uint8_t ucSlaveAddr;
+    /** register address */
+    uint8_t ucRegAddr;
+    /** data to write, may be NULL */
+    const uint8_t *pucTx;
+    /** bytes to write */
+    uint32_t ulTxLen;
+    /** buffer for data read, may be NULL */
+    uint8_t *pucRx;
+    /** bytes to read */
+    uint32_t ulRxLen;
+    /** result, set by the manager */
+    int32_t lStatus;
+} i2cmgrXfer_t;
+
+/**
+ * @brief Statistics of one client since the last reset.
+ */
+typedef struct
+{
+    /** requests completed */
+    uint32_t ulRequests;
+    /** bus transactions run */
+    uint32_t ulTransfers;
+    /** data bytes moved */
+    uint32_t ulBytes;
+    /** failed transactions */
+    uint32_t ulErrors;
+    /** requests completed after their deadline */
+    uint32_t ulDeadlineMisses;
+    /** longest request latency, ticks */
+    TickType_t xMaxLatency;
+    /** sum of request latencies, ticks */
+    TickType_t xTotalLatency;
+    /** bus time used, microseconds */
+    uint32_t ulBusUs;
+} i2cmgrStats_t;
+
+/**
+ * @brief Creates the manager task. To be called after lI2cInit() and before
+ * the scheduler starts.
+ *
+ * @return NO_ERROR or error code.
+ */
+int32_t lI2cmgrInit( void );
+
+/**
+ * @brief Queues transactions of a client and waits until all have run.
+ * Transactions of a request run in order; a higher priority request may run
+ * between them. Until the manager runs, transactions run on the calling task.
+ *
+ * @param eClient client.
+ * @param pxXfer transactions.
+ * @param ulCount number of transactions.
+ * @param xDeadline ticks from now, 0 for the default of the client.
+ *
+ * @return NO_ERROR or the first failing status.
+ */
+int32_t lI2cmgrSubmit( i2cmgrClient_t eClient, i2cmgrXfer_t *pxXfer,
+		       uint32_t ulCount, TickType_t xDeadline );
+
+/**
+ * @brief Runs one transaction for the client owning the slave address.
+ *
+ * @param ucSlaveAddr slave address.
+ * @param ucRegAddr register address.
+ * @param pucTx data to write.
+ * @param ulTxLen bytes to write.
+ * @param pucRx buffer for data read.
+ * @param ulRxLen bytes to read.
+ *
+ * @return NO_ERROR or error code.
+ */
+int32_t lI2cmgrTransfer( uint8_t ucSlaveAddr, uint8_t ucRegAddr,
+			 const uint8_t *pucTx, uint32_t ulTxLen,
+			 uint8_t *pucRx, uint32_t ulRxLen );
+
+/**
+ * @brief Reads the statistics of a client.
+ *
+ * @param eClient client.
+ * @param pxStats filled with the statistics.
+ *
+ * @return NO_ERROR or error code.
+ */
+int32_t lI2cmgrGetStats( i2cmgrClient_t eClient, i2cmgrStats_t *pxStats );
+
+/**
+ * @brief Bus utilisation since the last reset.
+ *
+ * @return bus busy time in 1/1000 of the elapsed time.
+ */
+uint32_t ulI2cmgrGetBusLoad( void );
+
+/**
+ * @brief Clears the statistics of all clients.
+ *
+ * @return void.
+ */
+void vI2cmgrResetStats( void );
+
+#endif /* INCLUDE_I2CMGR_H_ */
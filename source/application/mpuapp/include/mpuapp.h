@@ -34,6 +34,9 @@
 #ifndef MPUAPP_H
 #define MPUAPP_H
 
+#include <stdint.h>
+#include <FreeRTOS.h>
+
 #define mpuappNBIT		(1)    /**<Gpio offset*/
 #define mpuappMPLINITFAILURE	(-1)   /**<MPL INIT error code*/
 #define mpuappMPLLIBFAILURE	(-2)   /**<MPL Library init error code*/
@@ -44,13 +47,34 @@
 #define mpuappDEFAULT_MPU_HZ	(20)   /**<Sampling rate*/
 #define mpuappTap_TRESH		(50)   /**<Tap threshold*/
 #define mpuappBIT0		(1 << 0) /**Bit to wait for event*/
+#define mpuappBITMOTINTEN	(0x40)  /**<Motion interrupt mask*/
+#define mpuappFIFO_MAX_PACKETS	(32)	/**<Packets drained per interrupt*/
 
-/** @brief vMpuappGyroDataReadyCb
- * Every time new gyro data is available, this function is called in an
- * ISR context. In this example, it sets a flag protecting the FIFO read
- * function.
+/** @brief vMpuappGyroDataReadyCb drains the DMP FIFO. The DMP gesture
+ * callbacks run from here, in the calling task.
  */
 void vMpuappGyroDataReadyCb(void);
+
+/** @brief xMpuappWaitInterrupt waits for the MPU INT line.
+ *
+ * @param xTicks longest wait.
+ *
+ * @return pdTRUE if the line fired, pdFALSE on timeout.
+ */
+BaseType_t xMpuappWaitInterrupt(TickType_t xTicks);
+
+/** @brief vMpuappService reads the interrupt status of the MPU, latches a
+ * wake on motion and drains the DMP FIFO when the DMP runs.
+ *
+ * @return void.
+ */
+void vMpuappService(void);
+
+/** @brief xMpuappTakeMotion returns and clears the latched wake on motion.
+ *
+ * @return pdTRUE if motion was seen since the last call.
+ */
+BaseType_t xMpuappTakeMotion(void);
 /** @brief lMpuappmain  entry point.
   *
   * @return 0 on success and error code on failure.
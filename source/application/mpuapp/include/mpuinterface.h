@@ -40,9 +40,7 @@
 #include <semphr.h>
 #include <event_groups.h>
 
-#ifndef ENABLE_MPU_GIO_INTERRUPT
-#define mpuinterfaceFIFOREAD_DELAY 	(100)	/**< Task Delay for Read MPU FIFO */
-#endif
+#define mpuinterfaceFIFO_DRAIN_PERIOD 	(2000)	/**< Longest time between FIFO reads, ms */
 
 /** @brief lIntializeMpu initializes the mpu.
  *
@@ -74,26 +72,23 @@ int32_t lMpuinterfaceEnableMotionDetection(void);
  */
 int32_t lMpuinterfaceDisableMotionDetection(void);
 
-/** @brief This function reads the motion interrupt register and checks
- * if device motion detected. This function need to be called by the
- * application whenever there is a need to check for motion.
+/** @brief This function checks if device motion was detected. The motion
+ * interrupt is latched by the MPU reader task, so the check does not touch
+ * the bus. A detected motion is reported once.
  *
  * @return pdTRUE on motion detection and pdFALSE if no motion detected
  */
 BaseType_t xMpuinterfaceIsMotionDetected( void );
 
-#ifndef ENABLE_MPU_GIO_INTERRUPT
-/* @brief This task polls for the MPU FIFO data for every 100 ms.
+/* @brief This task serves the MPU INT line.
  *
- * It Waits for the on the start command (event) from the supervisor.
- * On receiving the START event, it will start polling for FIFO data.
- * On receiving the STOP event, it will stop the polling.
- * This is a workaround to interrupt mode problem in freeRTOS.
- * after fixing the interrupt mode problem this thread is no more required.
+ * The interrupt handler only wakes the task; the task reads the interrupt
+ * status, latches a wake on motion and drains the DMP FIFO, which delivers
+ * the tap events. Without interrupts the FIFO is drained every
+ * mpuinterfaceFIFO_DRAIN_PERIOD.
  *
  * @return void
  */
 void vMpuinterfaceReadFifoTsk(void *vArgs);
 
-#endif
 #endif /* MPU_INTERFACE_H */
@@ -3,6 +3,9 @@
  *
  * @brief This file is used for i2c operation.
  *
+ * Transfers are run by the I2C interrupt: the task starts the transfer and
+ * sleeps until the interrupt handler has moved all data and signals the end.
+ * A transfer that does not end in time is aborted and the bus recovered.
  *
  * @author vikram.k@design-shift.com
  *
@@ -38,110 +41,392 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <mml_i2c_regs.h>
+#include <mml_gpio.h>
 #include <i2c.h>
+#include <i2cmgr.h>
 #include <debug.h>
+#include <delay.h>
+
+/* FreeRTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/**
+ * @brief State of the transfer in progress.
+ */
+typedef struct
+{
+    /** 7 bit slave address */
+    uint8_t ucSlaveAddr;
+    /** i2cPHASE_xxx */
+    volatile uint8_t ucPhase;
+    /** data to write after the register address */
+    const uint8_t *pucTx;
+    /** bytes to write */
+    uint32_t ulTxLen;
+    /** bytes written */
+    uint32_t ulTxPos;
+    /** buffer for data read */
+    uint8_t *pucRx;
+    /** bytes to read */
+    uint32_t ulRxLen;
+    /** bytes read */
+    uint32_t ulRxPos;
+    /** end of the read programmed in the controller */
+    uint32_t ulRxEnd;
+    /** result of the transfer */
+    volatile int32_t lStatus;
+} i2cXfer_t;
+
+/** Transfer in progress */
+static i2cXfer_t xI2cXfer;
+
+/** Serializes transfers */
+static SemaphoreHandle_t xI2cLock;
+
+/** Given by the interrupt handler at the end of a transfer */
+static SemaphoreHandle_t xI2cDone;
+
+/** Controller configuration, kept for re-initialization */
+static mml_i2c_config_t xI2cConfig;
+
+/**
+ * @brief Programs the next read of up to i2cMAX_READ_COUNT bytes.
+ *
+ * @return error code.
+ */
+static int32_t prvI2cStartRead( void );
+
+/**
+ * @brief Moves data between the transfer buffers and the controller FIFO.
+ *
+ * Called from the interrupt handler, and by the task while the scheduler is
+ * not running.
+ *
+ * @return pdTRUE when the transfer has ended.
+ */
+static BaseType_t prvI2cService( void );
+
+/**
+ * @brief Frees a slave holding SDA low by clocking it out, then issues a STOP
+ * and initializes the controller again.
+ *
+ * @return void.
+ */
+static void prvI2cRecoverBus( void );
+
+/**
+ * @brief Maximum time a transfer may take.
+ *
+ * @param ulBytes bytes on the bus.
+ *
+ * @return timeout in ticks.
+ */
+static TickType_t prvI2cTimeout( uint32_t ulBytes );
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvI2cStartRead( void )
+{
+    int32_t lRetVal;
+    uint32_t ulSize;
+
+    ulSize = xI2cXfer.ulRxLen - xI2cXfer.ulRxPos;
+    if (ulSize > i2cMAX_READ_COUNT)
+    {
+	ulSize = i2cMAX_READ_COUNT;
+    }
+    xI2cXfer.ulRxEnd = xI2cXfer.ulRxPos + ulSize;
+    if ((lRetVal = mml_i2c_ioctl(MML_I2C_SET_READCOUNT, &ulSize))
+	    != NO_ERROR)
+    {
+	return lRetVal;
+    }
+    /* Repeated start, the register pointer was written before */
+    return mml_i2c_read_start(xI2cXfer.ucSlaveAddr);
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvI2cService( void )
+{
+    int32_t lRetVal = NO_ERROR;
+    uint32_t ulBusStatus = 0;
+    uint32_t ulSize;
+
+    if (xI2cXfer.ucPhase == i2cPHASE_IDLE)
+    {
+	return pdFALSE;
+    }
+    mml_i2c_bus_status((unsigned int *)&ulBusStatus);
+
+    if (xI2cXfer.ucPhase == i2cPHASE_WRITE)
+    {
+	if ((ulBusStatus & MML_I2C_SR_TXEMPTY_MASK) == 0)
+	{
+	    return pdFALSE;
+	}
+	if (xI2cXfer.ulTxPos < xI2cXfer.ulTxLen)
+	{
+	    /* Refill the FIFO */
+	    ulSize = xI2cXfer.ulTxLen - xI2cXfer.ulTxPos;
+	    if (ulSize > i2cFIFO_DEPTH)
+	    {
+		ulSize = i2cFIFO_DEPTH;
+	    }
+	    lRetVal = mml_i2c_write((unsigned char *)
+		    &xI2cXfer.pucTx[xI2cXfer.ulTxPos], (unsigned int *)&ulSize);
+	    xI2cXfer.ulTxPos += ulSize;
+	}
+	else if (xI2cXfer.ulRxLen)
+	{
+	    xI2cXfer.ucPhase = i2cPHASE_READ;
+	    lRetVal = prvI2cStartRead();
+	}
+	else if ((ulBusStatus & MML_I2C_SR_BUSY_MASK) == 0)
+	{
+	    xI2cXfer.lStatus = NO_ERROR;
+	}
+    }
+    else
+    {
+	/* Drain the FIFO */
+	while ((xI2cXfer.ulRxPos < xI2cXfer.ulRxEnd) &&
+		((ulBusStatus & MML_I2C_SR_RXEMPTY_MASK) == 0))
+	{
+	    ulSize = xI2cXfer.ulRxEnd - xI2cXfer.ulRxPos;
+	    lRetVal = mml_i2c_read(&xI2cXfer.pucRx[xI2cXfer.ulRxPos],
+		    (unsigned int *)&ulSize);
+	    if ((lRetVal != NO_ERROR) || (ulSize == 0))
+	    {
+		break;
+	    }
+	    xI2cXfer.ulRxPos += ulSize;
+	    mml_i2c_bus_status((unsigned int *)&ulBusStatus);
+	}
+	if ((lRetVal == NO_ERROR) && (xI2cXfer.ulRxPos == xI2cXfer.ulRxEnd))
+	{
+	    if (xI2cXfer.ulRxPos < xI2cXfer.ulRxLen)
+	    {
+		lRetVal = prvI2cStartRead();
+	    }
+	    else
+	    {
+		xI2cXfer.lStatus = NO_ERROR;
+	    }
+	}
+    }
+
+    if (lRetVal != NO_ERROR)
+    {
+	xI2cXfer.lStatus = lRetVal;
+    }
+    if (xI2cXfer.lStatus != COMMON_ERR_IN_PROGRESS)
+    {
+	xI2cXfer.ucPhase = i2cPHASE_IDLE;
+	return pdTRUE;
+    }
+    return pdFALSE;
+}
+/*---------------------------------------------------------------------------*/
 
 void vI2cIRQHandler(void)
 {
-    debugPRINT("i2cIRQHandler\n");
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
+    if (prvI2cService() == pdTRUE)
+    {
+	xSemaphoreGiveFromISR(xI2cDone, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+    }
 }
 /* ---------------------------------------------------------------------------*/
 
-int32_t lI2cInit(void)
+static TickType_t prvI2cTimeout( uint32_t ulBytes )
+{
+    /* A byte takes 9 clocks, allow twice the wire time */
+    return pdMS_TO_TICKS(i2cTIMEOUT_MIN_MS +
+	    ((ulBytes * 9 * 2 * 1000) / i2cBAUDRATE));
+}
+/* ---------------------------------------------------------------------------*/
+
+static void prvI2cRecoverBus( void )
 {
-    mml_i2c_config_t xI2cConfig;
+    mml_gpio_config_t xGpioConfig;
+    mml_gpio_pin_data_t xSda = MML_GPIO_OUT_LOGIC_ZERO;
+    uint32_t ulClock;
+
+    debugERROR_PRINT("I2C bus recovery\n");
+
+    /* Drive SCL from the GPIO, leave SDA to the slave */
+    xGpioConfig.gpio_function = MML_GPIO_NORMAL_FUNCTION;
+    xGpioConfig.gpio_pad_config = MML_GPIO_PAD_PULLUP;
+    xGpioConfig.gpio_intr_mode = 0;
+    xGpioConfig.gpio_intr_polarity = 0;
+    xGpioConfig.gpio_direction = MML_GPIO_DIR_IN;
+    mml_gpio_set_config(i2cGIO_PORT, i2cSDA_GIO, 1, xGpioConfig);
+    xGpioConfig.gpio_direction = MML_GPIO_DIR_OUT;
+    mml_gpio_set_config(i2cGIO_PORT, i2cSCL_GIO, 1, xGpioConfig);
+    mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSCL_GIO, 1, 1);
 
+    /* Up to 9 clocks let a slave finish the byte it is sending */
+    for (ulClock = 0; ulClock < i2cRECOVERY_CLOCKS; ulClock++)
+    {
+	mml_gpio_pin_input(i2cGIO_PORT, i2cSDA_GIO, &xSda);
+	if (xSda == MML_GPIO_OUT_LOGIC_ONE)
+	{
+	    break;
+	}
+	mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSCL_GIO, 1, 0);
+	delayuSEC(i2cRECOVERY_HALF_CLOCK_US);
+	mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSCL_GIO, 1, 1);
+	delayuSEC(i2cRECOVERY_HALF_CLOCK_US);
+    }
+
+    /* STOP: SDA rises while SCL is high */
+    mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSCL_GIO, 1, 0);
+    mml_gpio_set_config(i2cGIO_PORT, i2cSDA_GIO, 1, xGpioConfig);
+    mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSDA_GIO, 1, 0);
+    delayuSEC(i2cRECOVERY_HALF_CLOCK_US);
+    mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSCL_GIO, 1, 1);
+    delayuSEC(i2cRECOVERY_HALF_CLOCK_US);
+    mml_gpio_write_bit_pattern(i2cGIO_PORT, i2cSDA_GIO, 1, 1);
+    delayuSEC(i2cRECOVERY_HALF_CLOCK_US);
+
+    /* Give the pins back to the controller */
+    xGpioConfig.gpio_function = MML_GPIO_SECONDARY_ALT_FUNCTION;
+    xGpioConfig.gpio_direction = MML_GPIO_DIR_IN;
+    mml_gpio_set_config(i2cGIO_PORT, i2cSDA_GIO, 1, xGpioConfig);
+    mml_gpio_set_config(i2cGIO_PORT, i2cSCL_GIO, 1, xGpioConfig);
+    mml_i2c_init(&xI2cConfig);
+}
+/* ---------------------------------------------------------------------------*/
+
+int32_t lI2cInit(void)
+{
     /* Initialize I2C */
-    xI2cConfig.baudrate = 400000;
+    xI2cConfig.baudrate = i2cBAUDRATE;
     xI2cConfig.rxfifo_thr = 1;
     xI2cConfig.flags = MML_I2C_AUTOSTART_ENABLE;
-    /* Just not to provide null pointer */
     xI2cConfig.irq_handler = (irq_handler_t) vI2cIRQHandler;
 
+    if (xI2cLock == NULL)
+    {
+	xI2cLock = xSemaphoreCreateMutex();
+	xI2cDone = xSemaphoreCreateBinary();
+	if ((xI2cLock == NULL) || (xI2cDone == NULL))
+	{
+	    return COMMON_ERR_NULL_PTR;
+	}
+    }
+    xI2cXfer.ucPhase = i2cPHASE_IDLE;
+
     return mml_i2c_init(&xI2cConfig);
 
 }
 /* ---------------------------------------------------------------------------*/
 
-int32_t lI2cWrite(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
-	uint32_t ulLength, uint8_t *pucData)
+int32_t lI2cTransfer(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
+	const uint8_t *pucTx, uint32_t ulTxLen, uint8_t *pucRx,
+	uint32_t ulRxLen)
 {
     int32_t lRetVal;
-    uint8_t ucMsg[2];
-    uint32_t ulLen = 2;
-    uint32_t ulSize;
+    uint32_t ulLen = 1;
+    BaseType_t xRunning;
 
-    /* Length should be always greater than 0*/
-    if (ulLength == 0)
+    if (((ulTxLen != 0) && (pucTx == NULL)) ||
+	    ((ulRxLen != 0) && (pucRx == NULL)))
     {
-	return COMMON_ERR_INVAL;
+	return COMMON_ERR_NULL_PTR;
     }
-    if (pucData == NULL)
+    xRunning = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) ?
+	    pdTRUE : pdFALSE;
+    if (xRunning == pdTRUE)
     {
-	return COMMON_ERR_NULL_PTR;
+	xSemaphoreTake(xI2cLock, portMAX_DELAY);
+	/* A late end of an aborted transfer must not end this one */
+	xSemaphoreTake(xI2cDone, 0);
     }
-    ucMsg[i2cINDEX_0] = ucRegAddr;
-    ucMsg[i2cINDEX_1] = *pucData;
 
-    /* Initialize the I2C operation by writing slave address
-     * and one byte data.
-     */
-    if ((lRetVal = mml_i2c_write_start(ucSlaveAddr,ucMsg,
-	    (unsigned  int*)&ulLen))
-	    != NO_ERROR)
+    mml_i2c_ioctl(MML_I2C_RXFLUSH, 0);
+    mml_i2c_ioctl(MML_I2C_TXFLUSH, 0);
+    xI2cXfer.ucSlaveAddr = ucSlaveAddr;
+    xI2cXfer.pucTx = pucTx;
+    xI2cXfer.ulTxLen = ulTxLen;
+    xI2cXfer.ulTxPos = 0;
+    xI2cXfer.pucRx = pucRx;
+    xI2cXfer.ulRxLen = ulRxLen;
+    xI2cXfer.ulRxPos = 0;
+    xI2cXfer.ulRxEnd = 0;
+    xI2cXfer.lStatus = COMMON_ERR_IN_PROGRESS;
+
+    /* START, slave address and register address. The interrupt handler
+     * moves the data once the FIFO has room. */
+    taskENTER_CRITICAL();
+    xI2cXfer.ucPhase = i2cPHASE_WRITE;
+    lRetVal = mml_i2c_write_start(ucSlaveAddr, &ucRegAddr,
+	    (unsigned int *)&ulLen);
+    if (lRetVal != NO_ERROR)
     {
-	return lRetVal;
+	xI2cXfer.ucPhase = i2cPHASE_IDLE;
     }
+    taskEXIT_CRITICAL();
 
-    /* As I2C operation is initialized check if data lengths is one*/
-    if (ulLength > 1)
+    if (lRetVal == NO_ERROR)
     {
-	/* increment the data pointer as one byte
-	 * of data is already written.
-	 */
-	pucData++;
-	/* Already one by data is written decrement the length by one*/
-	ulLen = ulLength - 1;
-
-	/* If data length is greater than four, in each
-	 * write operation four bytes of data is written
-	 * until length becomes zero.Four byte approach
-	 * is used to avoid limitation on write operation
-	 * for greater length, if any and make code generic.
-	 */
-	for (; ulLen>0; )
+	if (xRunning == pdTRUE)
 	{
-	    if (ulLen > i2cSIZE)
+	    if (xSemaphoreTake(xI2cDone, prvI2cTimeout(ulTxLen + ulRxLen + 2))
+		    != pdTRUE)
 	    {
-		ulSize = i2cSIZE;
+		taskENTER_CRITICAL();
+		xI2cXfer.ucPhase = i2cPHASE_IDLE;
+		taskEXIT_CRITICAL();
+		xI2cXfer.lStatus = COMMON_ERR_FATAL_ERROR;
 	    }
-	    else
-	    {
-		ulSize = ulLen;
-	    }
-
-	    if ((lRetVal = mml_i2c_write(pucData,
-		    (unsigned int *)&ulSize)) != NO_ERROR)
+	}
+	else
+	{
+	    /* Interrupts are masked until the scheduler starts */
+	    while (xI2cXfer.ucPhase != i2cPHASE_IDLE)
 	    {
-		return lRetVal;
+		prvI2cService();
 	    }
-	    pucData += ulSize;
-	    ulLen -= ulSize;
 	}
+	lRetVal = xI2cXfer.lStatus;
+    }
+
+    if (lRetVal == COMMON_ERR_FATAL_ERROR)
+    {
+	debugERROR_PRINT("I2C transfer to 0x%x timed out\n", ucSlaveAddr);
+	prvI2cRecoverBus();
     }
-    return NO_ERROR;
+    if (xRunning == pdTRUE)
+    {
+	xSemaphoreGive(xI2cLock);
+    }
+    return lRetVal;
+}
+/* ---------------------------------------------------------------------------*/
+
+int32_t lI2cWrite(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
+	uint32_t ulLength, uint8_t *pucData)
+{
+    /* Length should be always greater than 0*/
+    if (ulLength == 0)
+    {
+	return COMMON_ERR_INVAL;
+    }
+    if (pucData == NULL)
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    return lI2cmgrTransfer(ucSlaveAddr, ucRegAddr, pucData, ulLength, NULL, 0);
 }
 /* ---------------------------------------------------------------------------*/
 
 int32_t lI2cRead(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
 	uint32_t ulLength, uint8_t  *pucData)
 {
-    int32_t lRetVal;
-    uint32_t ucBusStatus;
-    uint32_t ulLen = 1;       /*Write one byte register address to read from*/
-    uint32_t ulSize;
-
     if (ulLength == 0)
     {
 	return COMMON_ERR_INVAL;
@@ -150,58 +435,6 @@ int32_t lI2cRead(uint8_t ucSlaveAddr, uint8_t ucRegAddr,
     {
 	return COMMON_ERR_NULL_PTR;
     }
-    /* Write the register address to read from and start
-     * i2c operation.
-     */
-    if ((lRetVal = mml_i2c_write_start(ucSlaveAddr, &ucRegAddr,
-	    (unsigned int *)&ulLen)) != NO_ERROR)
-     {
-	return lRetVal;
-     }
-    ulLen = ulLength;
-
-    /* If data length is greater than four, in each
-     * read operation four bytes of data is read
-     * until length becomes zero.Four byte approach
-     * is used to avoid limitation on read operation
-     * for greater length, if any and make code generic.
-     */
-    for (; ulLen>0; )
-	{
-	    if (ulLen > i2cSIZE)
-	    {
-		ulSize = i2cSIZE;
-	    }
-	    else
-	    {
-		ulSize = ulLen;
-	    }
-	    /* Read the register */
-	    if((lRetVal = mml_i2c_ioctl(MML_I2C_SET_READCOUNT, &ulSize))
-		    != NO_ERROR)
-	    {
-		return lRetVal;
-	    }
-
-	    if ((lRetVal = mml_i2c_read_start(ucSlaveAddr)) != NO_ERROR)
-	    {
-		return lRetVal;
-	    }
-	    do
-	    {
-		mml_i2c_bus_status((unsigned int *)&ucBusStatus);
-	    }
-	    while ((ucBusStatus & MML_I2C_SR_RXEMPTY_MASK)
-			  || (ucBusStatus & MML_I2C_SR_BUSY_MASK));
-
-	    if ((lRetVal = mml_i2c_read(pucData,
-		    (unsigned int *)&ulSize)) != NO_ERROR )
-	    {
-		return lRetVal;
-	    }
-
-	    pucData += ulSize;
-	    ulLen -= ulSize;
-	}
-	return NO_ERROR;
+    return lI2cmgrTransfer(ucSlaveAddr, ucRegAddr, NULL, 0, pucData, ulLength);
 }
+/* ---------------------------------------------------------------------------*/
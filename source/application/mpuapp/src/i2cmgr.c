@@ -0,0 +1,395 @@
+ /**===========================================================================
+ * @file i2cmgr.c
+ *
+ * @brief This file contains the I2C bus manager. Clients post a request into
+ * their slot and sleep; the manager task picks the pending request of the
+ * highest priority, earliest deadline first among equal priorities, and runs
+ * one bus transaction of it at a time, so a short proximity read waits for
+ * at most one motion sensor transaction.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <stdint.h>
+#include <string.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Local includes */
+#include <errors.h>
+#include <task_config.h>
+#include <i2c.h>
+#include <i2cmgr.h>
+#include <le_interface.h>
+
+/**
+ * @brief Request slot of a client.
+ */
+typedef struct
+{
+    /** one request per client at a time */
+    SemaphoreHandle_t xLock;
+    /** given by the manager when the request has run */
+    SemaphoreHandle_t xDone;
+    /** transactions of the request */
+    i2cmgrXfer_t *pxXfer;
+    /** number of transactions */
+    uint32_t ulCount;
+    /** next transaction to run */
+    uint32_t ulNext;
+    /** first failing status */
+    int32_t lStatus;
+    /** submit time */
+    TickType_t xSubmit;
+    /** absolute deadline */
+    TickType_t xDeadline;
+    /** request waiting for the manager */
+    volatile uint8_t ucPending;
+    /** client priority */
+    uint8_t ucPriority;
+    /** default deadline, ticks */
+    TickType_t xDefaultDeadline;
+    /** statistics */
+    i2cmgrStats_t xStats;
+} i2cmgrSlot_t;
+
+/** client slots */
+static i2cmgrSlot_t xI2cmgrSlot[eI2CMGR_CLIENT_COUNT];
+
+/** given on every submit */
+static SemaphoreHandle_t xI2cmgrWork;
+
+/** manager task */
+static TaskHandle_t xI2cmgrTask;
+
+/** start of the statistics period */
+static TickType_t xI2cmgrStatsStart;
+
+/**
+ * @brief Picks the slot to serve next.
+ *
+ * @return slot or NULL when no request is pending.
+ */
+static i2cmgrSlot_t *prvI2cmgrPick( void );
+
+/**
+ * @brief Runs the next transaction of a slot and completes the request
+ * after its last one.
+ *
+ * @param pxSlot slot.
+ *
+ * @return void.
+ */
+static void prvI2cmgrStep( i2cmgrSlot_t *pxSlot );
+
+/**
+ * @brief Bus time of a transaction.
+ *
+ * @param ulTxLen bytes written after the register address.
+ * @param ulRxLen bytes read.
+ *
+ * @return microseconds.
+ */
+static uint32_t prvI2cmgrBusUs( uint32_t ulTxLen, uint32_t ulRxLen );
+
+/**
+ * @brief Manager task.
+ *
+ * @param pvArg unused.
+ *
+ * @return void.
+ */
+static void prvI2cmgrTask( void *pvArg );
+/*---------------------------------------------------------------------------*/
+
+static i2cmgrSlot_t *prvI2cmgrPick( void )
+{
+    i2cmgrSlot_t *pxBest = NULL;
+    uint32_t ulIndex;
+
+    taskENTER_CRITICAL();
+    for( ulIndex = 0; ulIndex < eI2CMGR_CLIENT_COUNT; ulIndex++ )
+    {
+	i2cmgrSlot_t *pxSlot = &xI2cmgrSlot[ulIndex];
+
+	if( !pxSlot->ucPending )
+	{
+	    continue;
+	}
+	if( ( pxBest == NULL ) || ( pxSlot->ucPriority > pxBest->ucPriority ) ||
+	    ( ( pxSlot->ucPriority == pxBest->ucPriority ) &&
+	      ( (int32_t) ( pxSlot->xDeadline - pxBest->xDeadline ) < 0 ) ) )
+	{
+	    pxBest = pxSlot;
+	}
+    }
+    taskEXIT_CRITICAL();
+    return pxBest;
+}
+/*---------------------------------------------------------------------------*/
+
+static uint32_t prvI2cmgrBusUs( uint32_t ulTxLen, uint32_t ulRxLen )
+{
+    /* address and register byte, and address again for a read */
+    uint32_t ulBytes = 2 + ulTxLen + ( ulRxLen ? ( 1 + ulRxLen ) : 0 );
+
+    /* 9 clocks per byte */
+    return ( ulBytes * 9 * 1000 ) / ( i2cBAUDRATE / 1000 );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvI2cmgrStep( i2cmgrSlot_t *pxSlot )
+{
+    i2cmgrXfer_t *pxXfer = &pxSlot->pxXfer[pxSlot->ulNext];
+    i2cmgrStats_t *pxStats = &pxSlot->xStats;
+    TickType_t xNow;
+    int32_t lStatus;
+
+    lStatus = lI2cTransfer(pxXfer->ucSlaveAddr, pxXfer->ucRegAddr,
+	    pxXfer->pucTx, pxXfer->ulTxLen, pxXfer->pucRx, pxXfer->ulRxLen);
+    pxXfer->lStatus = lStatus;
+
+    pxStats->ulTransfers++;
+    pxStats->ulBytes += pxXfer->ulTxLen + pxXfer->ulRxLen;
+    pxStats->ulBusUs += prvI2cmgrBusUs(pxXfer->ulTxLen, pxXfer->ulRxLen);
+    if( lStatus != NO_ERROR )
+    {
+	pxStats->ulErrors++;
+	if( pxSlot->lStatus == NO_ERROR )
+	{
+	    pxSlot->lStatus = lStatus;
+	}
+    }
+
+    pxSlot->ulNext++;
+    if( pxSlot->ulNext < pxSlot->ulCount )
+    {
+	return;
+    }
+
+    xNow = xTaskGetTickCount();
+    pxStats->ulRequests++;
+    pxStats->xTotalLatency += xNow - pxSlot->xSubmit;
+    if( ( xNow - pxSlot->xSubmit ) > pxStats->xMaxLatency )
+    {
+	pxStats->xMaxLatency = xNow - pxSlot->xSubmit;
+    }
+    if( (int32_t) ( xNow - pxSlot->xDeadline ) > 0 )
+    {
+	pxStats->ulDeadlineMisses++;
+    }
+    taskENTER_CRITICAL();
+    pxSlot->ucPending = 0;
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(pxSlot->xDone);
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvI2cmgrTask( void *pvArg )
+{
+    i2cmgrSlot_t *pxSlot;
+
+    (void) pvArg;
+
+    while( 1 )
+    {
+	xSemaphoreTake(xI2cmgrWork, portMAX_DELAY);
+	/* Pick again after every transaction */
+	while( ( pxSlot = prvI2cmgrPick() ) != NULL )
+	{
+	    prvI2cmgrStep(pxSlot);
+	}
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lI2cmgrInit( void )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < eI2CMGR_CLIENT_COUNT; ulIndex++ )
+    {
+	xI2cmgrSlot[ulIndex].xLock = xSemaphoreCreateMutex();
+	xI2cmgrSlot[ulIndex].xDone = xSemaphoreCreateBinary();
+	if( ( xI2cmgrSlot[ulIndex].xLock == NULL ) ||
+	    ( xI2cmgrSlot[ulIndex].xDone == NULL ) )
+	{
+	    return COMMON_ERR_FATAL_ERROR;
+	}
+    }
+    xI2cmgrSlot[eI2CMGR_CLIENT_LE].ucPriority = i2cmgrLE_PRIORITY;
+    xI2cmgrSlot[eI2CMGR_CLIENT_LE].xDefaultDeadline =
+	    pdMS_TO_TICKS(i2cmgrLE_DEADLINE_MS);
+    xI2cmgrSlot[eI2CMGR_CLIENT_MPU].ucPriority = i2cmgrMPU_PRIORITY;
+    xI2cmgrSlot[eI2CMGR_CLIENT_MPU].xDefaultDeadline =
+	    pdMS_TO_TICKS(i2cmgrMPU_DEADLINE_MS);
+
+    xI2cmgrWork = xSemaphoreCreateBinary();
+    if( xI2cmgrWork == NULL )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    if( xTaskCreate( prvI2cmgrTask, "I2cMgr", configSTACK_SIZE_I2C_MGR_TSK,
+	    NULL, ePRIORITY_IDLE_TASK, &xI2cmgrTask ) != pdPASS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lI2cmgrSubmit( i2cmgrClient_t eClient, i2cmgrXfer_t *pxXfer,
+		       uint32_t ulCount, TickType_t xDeadline )
+{
+    i2cmgrSlot_t *pxSlot;
+    uint32_t ulIndex;
+    int32_t lStatus = NO_ERROR;
+
+    if( ( eClient >= eI2CMGR_CLIENT_COUNT ) || ( pxXfer == NULL ) )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    if( ulCount == 0 )
+    {
+	return NO_ERROR;
+    }
+
+    /* Nothing to schedule until the manager runs */
+    if( ( xI2cmgrTask == NULL ) ||
+	( xTaskGetSchedulerState() != taskSCHEDULER_RUNNING ) ||
+	( xTaskGetCurrentTaskHandle() == xI2cmgrTask ) )
+    {
+	for( ulIndex = 0; ulIndex < ulCount; ulIndex++ )
+	{
+	    pxXfer[ulIndex].lStatus = lI2cTransfer(pxXfer[ulIndex].ucSlaveAddr,
+		    pxXfer[ulIndex].ucRegAddr, pxXfer[ulIndex].pucTx,
+		    pxXfer[ulIndex].ulTxLen, pxXfer[ulIndex].pucRx,
+		    pxXfer[ulIndex].ulRxLen);
+	    if( ( lStatus == NO_ERROR ) && pxXfer[ulIndex].lStatus )
+	    {
+		lStatus = pxXfer[ulIndex].lStatus;
+	    }
+	}
+	return lStatus;
+    }
+
+    pxSlot = &xI2cmgrSlot[eClient];
+    xSemaphoreTake(pxSlot->xLock, portMAX_DELAY);
+    pxSlot->pxXfer = pxXfer;
+    pxSlot->ulCount = ulCount;
+    pxSlot->ulNext = 0;
+    pxSlot->lStatus = NO_ERROR;
+    pxSlot->xSubmit = xTaskGetTickCount();
+    pxSlot->xDeadline = pxSlot->xSubmit +
+	    ( xDeadline ? xDeadline : pxSlot->xDefaultDeadline );
+    taskENTER_CRITICAL();
+    pxSlot->ucPending = 1;
+    taskEXIT_CRITICAL();
+    xSemaphoreGive(xI2cmgrWork);
+
+    /* Transfers time out in the driver, the request always completes */
+    xSemaphoreTake(pxSlot->xDone, portMAX_DELAY);
+    lStatus = pxSlot->lStatus;
+    xSemaphoreGive(pxSlot->xLock);
+    return lStatus;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lI2cmgrTransfer( uint8_t ucSlaveAddr, uint8_t ucRegAddr,
+			 const uint8_t *pucTx, uint32_t ulTxLen,
+			 uint8_t *pucRx, uint32_t ulRxLen )
+{
+    i2cmgrXfer_t xXfer;
+
+    xXfer.ucSlaveAddr = ucSlaveAddr;
+    xXfer.ucRegAddr = ucRegAddr;
+    xXfer.pucTx = pucTx;
+    xXfer.ulTxLen = ulTxLen;
+    xXfer.pucRx = pucRx;
+    xXfer.ulRxLen = ulRxLen;
+    xXfer.lStatus = NO_ERROR;
+
+    return lI2cmgrSubmit(( ucSlaveAddr == leNORDIC_I2C_SLAVE_ADDR ) ?
+	    eI2CMGR_CLIENT_LE : eI2CMGR_CLIENT_MPU, &xXfer, 1, 0);
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lI2cmgrGetStats( i2cmgrClient_t eClient, i2cmgrStats_t *pxStats )
+{
+    if( eClient >= eI2CMGR_CLIENT_COUNT )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    if( pxStats == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    taskENTER_CRITICAL();
+    *pxStats = xI2cmgrSlot[eClient].xStats;
+    taskEXIT_CRITICAL();
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+uint32_t ulI2cmgrGetBusLoad( void )
+{
+    uint32_t ulBusUs = 0;
+    uint32_t ulElapsedUs;
+    uint32_t ulIndex;
+
+    ulElapsedUs = ( xTaskGetTickCount() - xI2cmgrStatsStart ) *
+	    portTICK_PERIOD_MS * 1000;
+    if( ulElapsedUs == 0 )
+    {
+	return 0;
+    }
+    for( ulIndex = 0; ulIndex < eI2CMGR_CLIENT_COUNT; ulIndex++ )
+    {
+	ulBusUs += xI2cmgrSlot[ulIndex].xStats.ulBusUs;
+    }
+    return (uint32_t) ( ( (uint64_t) ulBusUs * 1000 ) / ulElapsedUs );
+}
+/*---------------------------------------------------------------------------*/
+
+void vI2cmgrResetStats( void )
+{
+    uint32_t ulIndex;
+
+    taskENTER_CRITICAL();
+    for( ulIndex = 0; ulIndex < eI2CMGR_CLIENT_COUNT; ulIndex++ )
+    {
+	memset(&xI2cmgrSlot[ulIndex].xStats, 0, sizeof(i2cmgrStats_t));
+    }
+    xI2cmgrStatsStart = xTaskGetTickCount();
+    taskEXIT_CRITICAL();
+}
+/*---------------------------------------------------------------------------*/
@@ -79,6 +79,10 @@ struct hal_s {
     uint16_t ucDmpFeatures;	/**<DMP feature*/
 };
 static struct hal_s xHal = {0}; /**<Hal structure variable*/
+/** Given by the MPU INT line */
+static SemaphoreHandle_t xMpuappIntSemaphore;
+/** Wake on motion seen by the reader, cleared by xMpuappTakeMotion */
+static volatile uint32_t ulMpuappMotion;
 /* Don't change the variable name it is used by library*/
 /**Key used by MPL library*/
 unsigned char *mpl_key = (unsigned char*)"eMPL 5.1";
@@ -115,6 +119,13 @@ static void prvMpuappTapCb(void);
  */
 static int32_t lMpuappGpioConfig(void);
 
+/** @brief prvMpuappIntISR wakes the reader task on the MPU INT line. The
+ * I2C reads are left to the task.
+ *
+ * @return void.
+ */
+static void prvMpuappIntISR(void);
+
 static int32_t lMpuappGpioConfig(void)
 {
     mml_gpio_config_t xGpioConfig;
@@ -133,37 +144,17 @@ static int32_t lMpuappGpioConfig(void)
 
 static void prvMpuappTapCb(void)
 {
-    BaseType_t xHigherPriorityTaskWoken, xResult;
-
-    /* TODO: check if it is called from thread context or ISR context
-     * Using ARM cortex register
-     * REF: NFC stack for more details
-     * Note:
-     * We can have a generic API in future which decides the caller's context
-     * dynamically. So both interrupt and thread can call this api's without
-     * any change
-     */
-#ifdef ENABLE_MPU_GIO_INTERRUPT
-     /* xHigherPriorityTaskWoken must be initialized to pdFALSE. */
-     xHigherPriorityTaskWoken = pdFALSE;
-
-     xResult = xEventGroupSetBitsFromISR(xgResource.xEventGroupPinEntry,
-	     pinentryGET_TAP_EVENT,&xHigherPriorityTaskWoken );
-
-     if( xResult != pdFAIL )
-       {
-   	/* If xHigherPriorityTaskWoken is now set to pdTRUE then a context
-   	switch should be requested. The macro used is port specific and will
-   	be either portYIELD_FROM_ISR() or portEND_SWITCHING_ISR() - refer to
-   	the documentation page for the port being used. */
-   	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
-       }
-#else	/* polling mode */
-	 do
-	 {
-	     xResult = xEventGroupSetBits( xgResource.xEventGroupPinEntry, pinentryGET_TAP_EVENT );
-	 }while(0);
-#endif
+    /* Called from dmp_read_fifo(), in the reader task */
+    xEventGroupSetBits( xgResource.xEventGroupPinEntry, pinentryGET_TAP_EVENT );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvMpuappIntISR(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    xSemaphoreGiveFromISR(xMpuappIntSemaphore, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 }
 /*---------------------------------------------------------------------------*/
 
@@ -173,8 +164,57 @@ void vMpuappGyroDataReadyCb(void)
     uint8_t ucMore;
     int32_t lQuat[4];
     uint32_t ulSensorTimestamp;
+    uint32_t ulPackets = 0;
+
+    do
+    {
+	ucMore = 0;
+	if (dmp_read_fifo(sGyro, sAccelShort, lQuat, &ulSensorTimestamp,
+		&sSensors, &ucMore))
+	{
+	    /* Empty, or reset after an overflow */
+	    break;
+	}
+    } while (ucMore && (++ulPackets < mpuappFIFO_MAX_PACKETS));
+}
+/*---------------------------------------------------------------------------*/
 
-    dmp_read_fifo(sGyro, sAccelShort, lQuat, &ulSensorTimestamp, &sSensors, &ucMore);
+BaseType_t xMpuappWaitInterrupt(TickType_t xTicks)
+{
+    return xSemaphoreTake(xMpuappIntSemaphore, xTicks);
+}
+/*---------------------------------------------------------------------------*/
+
+void vMpuappService(void)
+{
+    int16_t sIntStatus = 0;
+    uint8_t ucDmpOn = 0;
+
+    /* Reading the status releases the INT line */
+    if (mpu_get_int_status(&sIntStatus) == 0)
+    {
+	if (sIntStatus & mpuappBITMOTINTEN)
+	{
+	    ulMpuappMotion = 1;
+	}
+    }
+    mpu_get_dmp_state(&ucDmpOn);
+    if (ucDmpOn)
+    {
+	vMpuappGyroDataReadyCb();
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+BaseType_t xMpuappTakeMotion(void)
+{
+    uint32_t ulMotion;
+
+    taskENTER_CRITICAL();
+    ulMotion = ulMpuappMotion;
+    ulMpuappMotion = 0;
+    taskEXIT_CRITICAL();
+    return ulMotion ? pdTRUE : pdFALSE;
 }
 /*---------------------------------------------------------------------------*/
 
@@ -209,6 +249,14 @@ int32_t lMpuappmain(void)
     uint16_t usGyroRate, usGyroFsr;
     struct int_param_s xIntParam;
 
+    if (xMpuappIntSemaphore == NULL)
+    {
+	xMpuappIntSemaphore = xSemaphoreCreateBinary();
+	if (xMpuappIntSemaphore == NULL)
+	{
+	    return COMMON_ERR_NULL_PTR;
+	}
+    }
     lMpuappGpioConfig();
     xResult = mpu_init(&xIntParam);
     if (xResult)
@@ -216,14 +264,12 @@ int32_t lMpuappmain(void)
 	return mpuappMPLINITFAILURE;
     }
 
-#ifdef ENABLE_MPU_GIO_INTERRUPT
-    /* configure the interrupt*/
+    /* configure the interrupt; the reader task does the I2C work */
     xResult = lIrqDisable(MML_GPIO_DEV1, gpioINT_MPU6500);
     xResult |= lIrqClearInterrupt(MML_GPIO_DEV1, gpioINT_MPU6500);
     xResult |= lIrqSetup(MML_GPIO_DEV1, gpioINT_MPU6500,
  	  MML_GPIO_INT_MODE_EDGE_TRIGGERED, MML_GPIO_INT_POL_FALLING,
-	  vMpuappGyroDataReadyCb);
-#endif
+	  prvMpuappIntISR);
     if (xResult !=  NO_ERROR)
     {
 	return xResult;
@@ -341,13 +387,11 @@ int32_t lMpuappmain(void)
     dmp_set_interrupt_mode(DMP_INT_GESTURE);
     dmp_enable_feature(xHal.ucDmpFeatures);
     dmp_set_fifo_rate(mpuappDEFAULT_MPU_HZ);
-#ifdef ENABLE_MPU_GIO_INTERRUPT
     xResult = lIrqEnableInterrupt(MML_GPIO_DEV1, gpioINT_MPU6500);
     if (xResult != NO_ERROR)
     {
 	return xResult;
     }
-#endif
     mpu_set_dmp_state(1);
 
     return NO_ERROR;
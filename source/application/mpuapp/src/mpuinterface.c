@@ -46,8 +46,6 @@
 #include <inv_mpu.h>
 #include <usermode.h>
 
-#define mpuappBITMOTINTEN	(0x40)  /**<Motion interrupt mask*/
-
 /*---------------------------------------------------------------------------*/
 
 int32_t lMpuinterfaceIntializeMpu(void)
@@ -82,10 +80,8 @@ int32_t lMpuinterfaceDisableMotionDetection(void)
 
 BaseType_t xMpuinterfaceIsMotionDetected( void )
 {
-    int16_t sIntStatus = 0;
-
-    mpu_get_int_status(&sIntStatus);
-    if (sIntStatus & mpuappBITMOTINTEN)
+    /* Latched by the reader task on the motion interrupt */
+    if (xMpuappTakeMotion() == pdTRUE)
     {
 	debugPRINT("MOTION Detected !!");
 	return pdTRUE;
@@ -94,30 +90,20 @@ BaseType_t xMpuinterfaceIsMotionDetected( void )
 }
 /*---------------------------------------------------------------------------*/
 
-#ifndef ENABLE_MPU_GIO_INTERRUPT
-extern SemaphoreHandle_t prvI2CSemaphore;
 void vMpuinterfaceReadFifoTsk(void *vArgs)
 {
-    xSMAppResources_t *pxRes;
     configASSERT(vArgs != NULL);
-    pxRes = (xSMAppResources_t *)vArgs;
 	while(1)
 	{
-	    /* acquire semaphore: Wait till you acquire it*/
-	    if( xSemaphoreTake( pxRes->prvI2CSemaphore, portMAX_DELAY  ) == pdTRUE )
-	    {
-
-		/* read FIFO */
-		vMpuappGyroDataReadyCb();
-		 xSemaphoreGive( pxRes->prvI2CSemaphore );
-	    }
-		/* sleep 100ms to allow others to run */
-		vTaskDelay(mpuinterfaceFIFOREAD_DELAY);
-
+		/* Sleep until the MPU raises INT. The timeout drains the FIFO
+		 * before it can overflow without a gesture. */
+		xMpuappWaitInterrupt(
+			pdMS_TO_TICKS(mpuinterfaceFIFO_DRAIN_PERIOD));
+		/* the I2C bus manager orders it against LE traffic */
+		vMpuappService();
 	}
 	vTaskDelete( NULL );
 }
-#endif
 /*---------------------------------------------------------------------------*/
 
 
@@ -0,0 +1,172 @@
+ /**===========================================================================
+ * @file nfc_auth.h
+ *
+ * @brief This file contains the AES-128 keyfob authentication. The challenge
+ * travels under a fresh random IV and both directions carry a CMAC tag, so the
+ * keyfob and ORWL each prove the key. Keyfobs without the mode keep the 3DES
+ * scheme.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef NFC_AUTH_H
+#define NFC_AUTH_H
+
+#include <stdint.h>
+
+#include <keyfobid.h>
+#include <nfc_common.h>
+
+#define nfcauthKEY_LEN			(16)	/**< AES-128 key length */
+#define nfcauthBLOCK_LEN		(16)	/**< AES block length */
+#define nfcauthTAG_LEN			(16)	/**< CMAC tag length */
+/** Encrypted challenge length, seed information padded to whole blocks */
+#define nfcauthCHALLENGE_LEN		( ( ( sizeof(NfcCommonSeed_Info_t) + \
+					nfcauthBLOCK_LEN - 1 ) / nfcauthBLOCK_LEN ) * \
+					nfcauthBLOCK_LEN )
+/** Encrypted answer length, SHA1 of the seed padded to whole blocks */
+#define nfcauthANSWER_LEN		(32)
+/** Request: ORWL IV, encrypted challenge, tag */
+#define nfcauthREQUEST_LEN		( nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN + \
+					nfcauthTAG_LEN )
+/** Response: keyfob IV, encrypted answer, tag */
+#define nfcauthRESPONSE_LEN		( nfcauthBLOCK_LEN + nfcauthANSWER_LEN + \
+					nfcauthTAG_LEN )
+
+#define nfcauthLABEL_ENC_KEY		(0x01)	/**< derivation label of the encryption key */
+#define nfcauthLABEL_MAC_KEY		(0x02)	/**< derivation label of the MAC key */
+#define nfcauthLABEL_REQUEST		(0x11)	/**< tag label of the request */
+#define nfcauthLABEL_RESPONSE		(0x12)	/**< tag label of the response */
+
+/**
+ * @brief State of one AES authentication.
+ */
+typedef struct
+{
+    /** session encryption key */
+    uint8_t ucEncKey[nfcauthKEY_LEN];
+    /** session MAC key */
+    uint8_t ucMacKey[nfcauthKEY_LEN];
+    /** random IV of the request, binds the response to this session */
+    uint32_t ulOrwlIV[nfcauthBLOCK_LEN / sizeof(uint32_t)];
+    /** expected answer of the keyfob */
+    uint8_t ucAnswer[nfcauthANSWER_LEN];
+} nfcauthContext_t;
+
+/**
+ * @brief Computes an AES-128 CMAC (RFC 4493).
+ *
+ * @param pucTag output, nfcauthTAG_LEN bytes.
+ * @param pucKey AES-128 key.
+ * @param pucMsg message.
+ * @param ulLen message length.
+ *
+ * @return NO_ERROR on success, error code otherwise.
+ */
+int32_t lNfcAuthCmac( uint8_t *pucTag, const uint8_t *pucKey,
+		      const uint8_t *pucMsg, uint32_t ulLen );
+
+/**
+ * @brief Derives the session keys from the secrets agreed at association.
+ *
+ * @param pxCtx context to fill.
+ * @param pxKeyInfo keyfob entry.
+ *
+ * @return NO_ERROR on success, error code otherwise.
+ */
+int32_t lNfcAuthDeriveKeys( nfcauthContext_t *pxCtx,
+			    const keyfobidKeyFobInfo_t *pxKeyInfo );
+
+/**
+ * @brief Builds the request carrying the challenge under a fresh random IV.
+ *
+ * @param pxCtx context with derived keys.
+ * @param pxChallenge challenge sent to the keyfob.
+ * @param pucRequest output, nfcauthREQUEST_LEN bytes.
+ *
+ * @return NO_ERROR on success, error code otherwise.
+ */
+int32_t lNfcAuthBuildRequest( nfcauthContext_t *pxCtx,
+			      const NfcCommonSeed_Info_t *pxChallenge,
+			      uint8_t *pucRequest );
+
+/**
+ * @brief Verifies the tag of the keyfob response and the answer it carries.
+ *
+ * @param pxCtx context of the request.
+ * @param pucResponse response.
+ * @param ulLen response length.
+ *
+ * @return NO_ERROR when the keyfob proved the key, error code otherwise.
+ */
+int32_t lNfcAuthCheckResponse( nfcauthContext_t *pxCtx,
+			       const uint8_t *pucResponse, uint32_t ulLen );
+
+/**
+ * @brief Runs the AES-128 mutual authentication with the activated keyfob.
+ *
+ * @param pxKeyInfo keyfob entry, of type keyfobidKEY_TYPE_AES128.
+ * @param pxChallenge challenge sent to the keyfob.
+ *
+ * @return eventsKEYFOB_NFC_AUTH_SUCCESS or eventsKEYFOB_NFC_AUTH_FAILURE
+ */
+uint32_t ulNfcAuthAesAuthenticate( const keyfobidKeyFobInfo_t *pxKeyInfo,
+				   const NfcCommonSeed_Info_t *pxChallenge );
+
+/**
+ * @brief Runs the legacy 3DES authentication with the activated keyfob.
+ *
+ * @param pxKeyInfo keyfob entry.
+ * @param pxChallenge challenge sent to the keyfob.
+ *
+ * @return eventsKEYFOB_NFC_AUTH_SUCCESS or eventsKEYFOB_NFC_AUTH_FAILURE
+ */
+uint32_t ulNfcAuthTdesAuthenticate( const keyfobidKeyFobInfo_t *pxKeyInfo,
+				    const NfcCommonSeed_Info_t *pxChallenge );
+
+/**
+ * @brief Authenticates the activated keyfob with the scheme recorded in its
+ * entry.
+ *
+ * @param pxKeyInfo keyfob entry.
+ * @param pxChallenge challenge sent to the keyfob.
+ *
+ * @return eventsKEYFOB_NFC_AUTH_SUCCESS or eventsKEYFOB_NFC_AUTH_FAILURE
+ */
+uint32_t ulNfcAuthAuthenticate( const keyfobidKeyFobInfo_t *pxKeyInfo,
+				const NfcCommonSeed_Info_t *pxChallenge );
+
+/**
+ * @brief Asks the activated keyfob which authentication modes it supports.
+ *
+ * @return mask of commandsAUTH_MODE_xxx, commandsAUTH_MODE_TDES for a
+ * keyfob predating the command.
+ */
+uint32_t ulNfcAuthGetModes( void );
+
+#endif /* NFC_AUTH_H */
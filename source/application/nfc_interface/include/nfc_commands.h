@@ -81,6 +81,9 @@
 #define commandsCVM_PAD_LEN			(2)	/**< 2 bytes are added to make 8 byte align */
 #define commandsINIT_VECTOR_SIZE		(8)	/**< Initializing vector size */
 #define commandsSHA_HASH_LENGTH			(20)	/**< SHA1 Hash length */
+#define commandsAUTH_MODE_TDES			(0x01)	/**< peer supports the 3DES authentication */
+#define commandsAUTH_MODE_AES128		(0x02)	/**< peer supports the AES-128/CMAC authentication */
+#define commandsAUTH_MODE_X25519		(0x04)	/**< peer supports the X25519 association */
 
 extern uint8_t gucIV[commandsINIT_VECTOR_SIZE];
 extern uint8_t gucCVMPIN[commandsCVM_ACTUAL_SIZE+commandsCVM_PAD_LEN];
@@ -102,6 +105,12 @@ typedef enum
 	eCMD_GET_SEED			= 0x19,		/**< Command to read Peer's seed */
 	eCMD_GET_SERIAL			= 0x20,		/**< Command to get the serial number */
 	eCMD_GET_NAME			= 0x22,		/**< Command to get the peer name */
+	eCMD_GET_AUTH_MODES		= 0x23,		/**< Command to read the authentication
+								modes supported by the peer */
+	eCMD_AES_AUTH			= 0x24,		/**< Command carrying the AES
+								authentication request */
+	eCMD_X25519_ASSOCIATION_REQUEST	= 0x25,		/**< Command request for KeyFob-ORWL
+								association over X25519 */
 	eCMD_SAVE_KEYFOB_NAME		= 0x2C		/**< Command to store the key Fob name */
 
 } eCmdORWLCommands_t;
@@ -195,14 +204,15 @@ uint32_t ulNfcCmdGetSerial( uint8_t *pucReadBuf, uint32_t *pulReadLen );
 /**
  * @brief This function send request for key association.
  *
- * @param None
+ * @param ulX25519 pdTRUE to associate over X25519, the peer then expects a
+ *                 32 byte public key. pdFALSE for the NIST P-192 association.
  *
  * @return Status of Key Associate
  *
  * returns PH_NFCLIB_STATUS_SUCCESS on success
  * returns error codes on error
  */
-uint32_t ulNfcCmdKeyAssociate( void );
+uint32_t ulNfcCmdKeyAssociate( uint32_t ulX25519 );
 
 /**
  * @brief This function writes data to KeyFob.
@@ -288,4 +298,31 @@ uint32_t ulNfcCmdConfirmSSK( uint8_t *pucData , uint32_t ulLen );
  * returns error codes on error in selection
  */
 uint32_t ulNfcCmdSaveKey( void );
+
+/**
+ * @brief This function reads the authentication modes supported by the peer.
+ * Keyfobs predating the AES authentication reject the command.
+
+ * @param pucReadBuf Pointer to buffer with contents read from the peer,
+ *                   first byte is a mask of commandsAUTH_MODE_xxx
+ * @param pulReadLen Pointer to parameter to indicate number of bytes read
+ *                   from peer
+ *
+ * @return PH_NFCLIB_STATUS_SUCCESS on success
+ * returns error codes on error
+ */
+uint32_t ulNfcCmdGetAuthModes( uint8_t *pucReadBuf, uint32_t *pulReadLen );
+
+/**
+ * @brief This function sends the AES authentication request. The response is
+ * read with ulNfcCmdReadRawData.
+ *
+ * @param pucWriteBuf Pointer to the request
+ * @param ulWriteLen  Length of the request
+ *
+ * @return
+ * returns PH_NFCLIB_STATUS_SUCCESS on success
+ * returns error codes on error
+ */
+uint32_t ulNfcCmdAesAuth( uint8_t *pucWriteBuf, uint32_t ulWriteLen );
 #endif /* NFC_COMMANDS_H */
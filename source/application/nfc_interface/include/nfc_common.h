@@ -165,6 +165,7 @@ int32_t lNfcCommonGetKeyByName(keyfobidKeyFobInfo_t *pxKeyInfo,
  * @param pucSSK        Pointer to shared secret key
  * @param pucORWL_SK    Pointer to ORWL seed/challenge
  * @param pucKeyFob_SK  Pointer to key fob seed/challenge
+ * @param ulKeyType     Authentication scheme, keyfobidKEY_TYPE_xxx
  *
  * @return int32_t
  * returns NO_ERROR on success
@@ -172,5 +173,6 @@ int32_t lNfcCommonGetKeyByName(keyfobidKeyFobInfo_t *pxKeyInfo,
  */
 int32_t lNfcCommonWriteKeyInfo(uint8_t *pucKeyFOBName, uint8_t ucKeyFOBLen,
 				uint32_t ulprivilege, uint8_t *pucSSK,
-				uint8_t *pucORWL_SK, uint8_t *pucKeyFob_SK);
+				uint8_t *pucORWL_SK, uint8_t *pucKeyFob_SK,
+				uint32_t ulKeyType);
 #endif /* NFC_COMMON_H */
@@ -0,0 +1,129 @@
+ /**===========================================================================
+ * @file nfc_lpcd.h
+ *
+ * @brief This file contains the low power card detection interface of the NFC
+ * front-end. The reader watches its antenna for detuning while the SuC sleeps
+ * and only a detected field change leads to a full RF activation.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef NFC_LPCD_H
+#define NFC_LPCD_H
+
+#include <stdint.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <event_groups.h>
+
+#define nfclpcdWAKE_FIELD		(0)	/**< field changed, run an activation */
+#define nfclpcdWAKE_STOP		(1)	/**< stop event received */
+#define nfclpcdWAKE_TIMEOUT		(2)	/**< deadline passed without a field change */
+
+#define nfclpcdPOWER_DOWN_MS		(250)	/**< task sleep between two detection cycles */
+#define nfclpcdREADER_SLEEP_MS		(5)	/**< reader power down within one detection cycle */
+#define nfclpcdDETECTION_US		(100)	/**< field on time of one detection cycle */
+#define nfclpcdSENSITIVITY		(2)	/**< I/Q deviation counted as a card */
+#define nfclpcdCAL_SAMPLES		(4)	/**< measurements averaged by a calibration */
+#define nfclpcdCAL_MAX_SPREAD		(2)	/**< I/Q spread accepted during calibration */
+#define nfclpcdMAX_FALSE_WAKES		(3)	/**< false wakes before a recalibration */
+#define nfclpcdMAX_RECALIBRATIONS	(2)	/**< recalibrations before timed polling */
+#define nfclpcdPOLL_MIN_MS		(100)	/**< first interval of timed polling */
+#define nfclpcdPOLL_MAX_MS		(800)	/**< longest interval of timed polling */
+
+/**
+ * @brief Tunable parameters of the low power card detection.
+ */
+typedef struct
+{
+    /** task sleep between two detection cycles in ms */
+    uint16_t usPowerDownMs;
+    /** field on time of one detection cycle in us */
+    uint16_t usDetectionUs;
+    /** smallest I or Q deviation from the reference treated as a card */
+    uint8_t ucSensitivity;
+    /** measurements averaged by a calibration */
+    uint8_t ucCalSamples;
+    /** largest I or Q spread accepted during calibration */
+    uint8_t ucCalMaxSpread;
+    /** consecutive false wakes before a recalibration */
+    uint8_t ucMaxFalseWakes;
+    /** recalibrations within one session before falling back to polling */
+    uint8_t ucMaxRecalibrations;
+    /** first and longest interval of the fallback polling in ms */
+    uint16_t usPollMinMs;
+    uint16_t usPollMaxMs;
+} nfclpcdConfig_t;
+
+/**
+ * @brief Replaces the detection parameters. Takes effect at the next
+ * session.
+ *
+ * @param pxConfig new parameters.
+ */
+void vNfcLpcdSetConfig( const nfclpcdConfig_t *pxConfig );
+
+/**
+ * @brief Reads the detection parameters in use.
+ *
+ * @param pxConfig filled with the current parameters.
+ */
+void vNfcLpcdGetConfig( nfclpcdConfig_t *pxConfig );
+
+/**
+ * @brief Starts a detection session. Must be called once before the first
+ * activation attempt; the antenna is calibrated at the first wait, after the
+ * first activation found an empty field.
+ */
+void vNfcLpcdBegin( void );
+
+/**
+ * @brief Waits for a reason to run the next activation.
+ *
+ * The calling task sleeps on the event group between two detection cycles,
+ * so a stop request or the deadline ends the wait at once; each cycle then
+ * blocks on the reader interrupt for a short power down only. A wake whose
+ * I/Q deviation stays below the sensitivity is taken as drift and absorbed
+ * into the reference. When the detection is unavailable or keeps waking
+ * without a card the wait falls back to timed polling with a growing
+ * interval.
+ *
+ * Calling the function again after nfclpcdWAKE_FIELD means the activation
+ * found no peer.
+ *
+ * @param xEventGroup event group carrying the stop request.
+ * @param xStopBits stop bits; they are not cleared.
+ * @param xDeadline tick count at which the wait gives up.
+ *
+ * @return nfclpcdWAKE_FIELD, nfclpcdWAKE_STOP or nfclpcdWAKE_TIMEOUT.
+ */
+uint32_t ulNfcLpcdWait( EventGroupHandle_t xEventGroup, EventBits_t xStopBits,
+			TickType_t xDeadline );
+
+#endif /* NFC_LPCD_H */
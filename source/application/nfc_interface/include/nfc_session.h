@@ -0,0 +1,159 @@
+ /**===========================================================================
+ * @file nfc_session.h
+ *
+ * @brief This file contains the NFC session layer. It tracks the applet
+ * selected on the activated keyfob and caches the card identity per UID so
+ * that a re-authentication skips the SELECT and GetName round trips.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef NFC_SESSION_H
+#define NFC_SESSION_H
+
+#include <stdint.h>
+
+/* nfc interface header */
+#include <nfc_interface.h>
+
+#define nfcsessionWINDOW_MS		(30000)	/**< reuse window of a cached card identity */
+#define nfcsessionUID_MAX_LEN		(10)	/**< longest ISO14443-3A UID */
+#define nfcsessionNAME_MAX_LEN		(32)	/**< longest cached keyfob name */
+#define nfcsessionAPDU_SELECT		(0xA4)	/**< statistics slot of the ISO SELECT */
+#define nfcsessionAPDU_SLOTS		(16)	/**< commands with their own timing counters */
+
+#define nfcsessionAPPLET_NONE		(0)	/**< nothing selected since activation */
+#define nfcsessionAPPLET_MASTER		(1)	/**< master applet selected */
+#define nfcsessionAPPLET_USER		(2)	/**< user applet selected */
+
+/**
+ * @brief Timing counters of one APDU. Times are in timestamp timer counts,
+ * see timerTIMESTAMP_HZ.
+ */
+typedef struct
+{
+    /** command byte, 0 for an unused slot */
+    uint8_t ucApdu;
+    /** exchanges */
+    uint32_t ulCount;
+    /** exchanges that failed */
+    uint32_t ulErrors;
+    /** sum of the exchange times */
+    uint32_t ulTotal;
+    /** longest exchange time */
+    uint32_t ulMax;
+} nfcsessionApduStats_t;
+
+/**
+ * @brief Session layer statistics.
+ */
+typedef struct
+{
+    /** SELECT commands sent */
+    uint32_t ulSelectsSent;
+    /** SELECT commands saved by the tracked applet state */
+    uint32_t ulSelectsSkipped;
+    /** keyfob names served from the identity cache */
+    uint32_t ulNameHits;
+    /** keyfob names read from the card */
+    uint32_t ulNameMisses;
+    /** per APDU timing */
+    nfcsessionApduStats_t xApdu[nfcsessionAPDU_SLOTS];
+} nfcsessionStats_t;
+
+/**
+ * @brief Prepares the session layer. Must be called before the NFC task
+ * starts.
+ *
+ * @return NO_ERROR on success, error code otherwise.
+ */
+int32_t lNfcSessionInit( void );
+
+/**
+ * @brief Records a successful activation. The applet selection is reset
+ * since a freshly activated card starts without one, and the UID of the
+ * peer is read to look up the identity cache.
+ */
+void vNfcSessionActivated( void );
+
+/**
+ * @brief Records the release of the peer.
+ */
+void vNfcSessionReleased( void );
+
+/**
+ * @brief Drops the cached card identity; used when an authentication with
+ * the cached name failed or the keyfob table changed.
+ */
+void vNfcSessionInvalidate( void );
+
+/**
+ * @brief Selects the ORWL user applet unless it is already selected in the
+ * current activation. The user applet is selected by its AID directly and
+ * the master applet is only selected first when that fails.
+ *
+ * @return PH_NFCLIB_STATUS_SUCCESS on success, error code otherwise.
+ */
+uint32_t ulNfcSessionSelectUser( void );
+
+/**
+ * @brief Reads the keyfob name. The name is served from the identity cache
+ * when the same UID was seen within nfcsessionWINDOW_MS.
+ *
+ * @param pucReadBuf buffer receiving the name.
+ * @param pulReadLen in: buffer size, out: name length.
+ *
+ * @return PH_NFCLIB_STATUS_SUCCESS on success, error code otherwise.
+ */
+uint32_t ulNfcSessionGetName( uint8_t *pucReadBuf, uint32_t *pulReadLen );
+
+/**
+ * @brief Runs one timed APDU exchange.
+ *
+ * @param ucApdu command byte the exchange is counted under.
+ * @param pxInput command to transmit.
+ * @param usLen length argument of phNfcLib_Transmit.
+ *
+ * @return status of phNfcLib_Transmit.
+ */
+uint32_t ulNfcSessionTransmit( uint8_t ucApdu, phNfcLib_Transmit_t *pxInput,
+			       uint16_t usLen );
+
+/**
+ * @brief Copies the session statistics.
+ *
+ * @param pxStats filled with the statistics.
+ */
+void vNfcSessionGetStats( nfcsessionStats_t *pxStats );
+
+/**
+ * @brief Clears the session statistics.
+ */
+void vNfcSessionResetStats( void );
+
+#endif /* NFC_SESSION_H */
@@ -0,0 +1,467 @@
+ /**===========================================================================
+ * @file nfc_auth.c
+ *
+ * @brief This file contains the AES-128 keyfob authentication. Session keys are
+ * derived with CMAC from the secrets agreed at association, the challenge is
+ * encrypted under a random IV and both request and response carry a CMAC tag.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <string.h>
+
+/* nfc interface header */
+#include <nfc_interface.h>
+
+/* local includes */
+#include <errors.h>
+#include <events.h>
+#include <trng.h>
+#include <nfc_commands.h>
+#include <nfc_common.h>
+#include <nfc_auth.h>
+
+#include <ucl/ucl_aes.h>
+#include <ucl/ucl_aes_cbc.h>
+
+/** constant of the CMAC subkey derivation (RFC 4493) */
+#define nfcauthCMAC_RB			(0x87)
+
+/** longest message tagged by this module: label, two IVs and an answer */
+#define nfcauthMAC_BUF_LEN		( 1 + ( 2 * nfcauthBLOCK_LEN ) + \
+					nfcauthCHALLENGE_LEN )
+
+/** length of the association secret X and Y taken into the derivation */
+#define nfcauthSECRET_LEN		(24)
+
+/**
+ * @brief Doubles a block in GF(2^128) to derive a CMAC subkey.
+ *
+ * @param pucOut output block.
+ * @param pucIn input block.
+ */
+static void prvNfcAuthDouble( uint8_t *pucOut, const uint8_t *pucIn );
+
+/**
+ * @brief Compares two buffers in time independent of their contents.
+ *
+ * @param pucA first buffer.
+ * @param pucB second buffer.
+ * @param ulLen length.
+ *
+ * @return 0 when equal, non zero otherwise.
+ */
+static uint32_t prvNfcAuthCompare( const uint8_t *pucA, const uint8_t *pucB,
+				   uint32_t ulLen );
+
+/*----------------------------------------------------------------------------*/
+
+static void prvNfcAuthDouble( uint8_t *pucOut, const uint8_t *pucIn )
+{
+    uint8_t ucMsb = pucIn[0] & 0x80;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ( nfcauthBLOCK_LEN - 1 ); ulIndex++ )
+    {
+	pucOut[ulIndex] = (uint8_t) ( ( pucIn[ulIndex] << 1 ) |
+		( pucIn[ulIndex + 1] >> 7 ) );
+    }
+    pucOut[nfcauthBLOCK_LEN - 1] = (uint8_t) ( pucIn[nfcauthBLOCK_LEN - 1] << 1 );
+    /* branch free reduction */
+    pucOut[nfcauthBLOCK_LEN - 1] ^= (uint8_t) ( ( 0 - ( ucMsb >> 7 ) ) &
+	    nfcauthCMAC_RB );
+}
+/*----------------------------------------------------------------------------*/
+
+static uint32_t prvNfcAuthCompare( const uint8_t *pucA, const uint8_t *pucB,
+				   uint32_t ulLen )
+{
+    uint32_t ulDiff = 0;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ulLen; ulIndex++ )
+    {
+	ulDiff |= pucA[ulIndex] ^ pucB[ulIndex];
+    }
+    return ulDiff;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lNfcAuthCmac( uint8_t *pucTag, const uint8_t *pucKey,
+		      const uint8_t *pucMsg, uint32_t ulLen )
+{
+    uint8_t ucKey[nfcauthKEY_LEN];
+    uint8_t ucSub[nfcauthBLOCK_LEN];
+    uint8_t ucX[nfcauthBLOCK_LEN];
+    uint32_t ulBlocks;
+    uint32_t ulBlock;
+    uint32_t ulIndex;
+    uint32_t ulLast;
+    int32_t lStatus = NO_ERROR;
+
+    if( ( pucTag == NULL ) || ( pucKey == NULL ) ||
+	( ( pucMsg == NULL ) && ( ulLen != 0 ) ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    memcpy(ucKey, pucKey, nfcauthKEY_LEN);
+
+    /* L = AES(K, 0); K1 = 2L; K2 = 4L */
+    memset(ucX, 0, nfcauthBLOCK_LEN);
+    if( ucl_aes(ucSub, ucX, ucKey, nfcauthKEY_LEN, UCL_CIPHER_ENCRYPT)
+	    != UCL_OK )
+    {
+	lStatus = COMMON_ERR_FATAL_ERROR;
+	goto END;
+    }
+    prvNfcAuthDouble(ucSub, ucSub);
+
+    ulBlocks = ( ulLen + nfcauthBLOCK_LEN - 1 ) / nfcauthBLOCK_LEN;
+    if( ( ulLen == 0 ) || ( ( ulLen % nfcauthBLOCK_LEN ) != 0 ) )
+    {
+	/* incomplete last block is padded and uses K2 */
+	prvNfcAuthDouble(ucSub, ucSub);
+	ulBlocks = ( ulBlocks == 0 ) ? 1 : ulBlocks;
+    }
+
+    for( ulBlock = 0; ulBlock < ulBlocks; ulBlock++ )
+    {
+	ulLast = ( ulBlock == ( ulBlocks - 1 ) );
+	for( ulIndex = 0; ulIndex < nfcauthBLOCK_LEN; ulIndex++ )
+	{
+	    uint32_t ulPos = ( ulBlock * nfcauthBLOCK_LEN ) + ulIndex;
+
+	    if( ulPos < ulLen )
+	    {
+		ucX[ulIndex] ^= pucMsg[ulPos];
+	    }
+	    else if( ulPos == ulLen )
+	    {
+		ucX[ulIndex] ^= 0x80;
+	    }
+	    if( ulLast )
+	    {
+		ucX[ulIndex] ^= ucSub[ulIndex];
+	    }
+	}
+	if( ucl_aes(ucX, ucX, ucKey, nfcauthKEY_LEN, UCL_CIPHER_ENCRYPT)
+		!= UCL_OK )
+	{
+	    lStatus = COMMON_ERR_FATAL_ERROR;
+	    goto END;
+	}
+    }
+    memcpy(pucTag, ucX, nfcauthTAG_LEN);
+
+END:
+    memset(ucKey, 0, sizeof(ucKey));
+    memset(ucSub, 0, sizeof(ucSub));
+    memset(ucX, 0, sizeof(ucX));
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lNfcAuthDeriveKeys( nfcauthContext_t *pxCtx,
+			    const keyfobidKeyFobInfo_t *pxKeyInfo )
+{
+    uint8_t ucMsg[1 + ( 2 * nfcauthSECRET_LEN )];
+    int32_t lStatus;
+
+    if( ( pxCtx == NULL ) || ( pxKeyInfo == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    /* K = CMAC(Z, label || X || Y) with the secrets of the association */
+    memcpy(&ucMsg[1], pxKeyInfo->xSecKeyX.ucTDESKey, nfcauthSECRET_LEN);
+    memcpy(&ucMsg[1 + nfcauthSECRET_LEN], pxKeyInfo->xSecKeyY.ucTDESKey,
+	    nfcauthSECRET_LEN);
+    ucMsg[0] = nfcauthLABEL_ENC_KEY;
+    lStatus = lNfcAuthCmac(pxCtx->ucEncKey, pxKeyInfo->xSecKeyZ.ucTDESKey,
+	    ucMsg, sizeof(ucMsg));
+    if( lStatus == NO_ERROR )
+    {
+	ucMsg[0] = nfcauthLABEL_MAC_KEY;
+	lStatus = lNfcAuthCmac(pxCtx->ucMacKey, pxKeyInfo->xSecKeyZ.ucTDESKey,
+		ucMsg, sizeof(ucMsg));
+    }
+    memset(ucMsg, 0, sizeof(ucMsg));
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lNfcAuthBuildRequest( nfcauthContext_t *pxCtx,
+			      const NfcCommonSeed_Info_t *pxChallenge,
+			      uint8_t *pucRequest )
+{
+    uint8_t ucPlain[nfcauthCHALLENGE_LEN];
+    uint8_t ucMac[nfcauthMAC_BUF_LEN];
+    uint8_t ucIV[nfcauthBLOCK_LEN];
+    uint8_t *pucCipher = &pucRequest[nfcauthBLOCK_LEN];
+    int32_t lStatus = NO_ERROR;
+
+    if( ( pxCtx == NULL ) || ( pxChallenge == NULL ) || ( pucRequest == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    /* answer the keyfob has to return */
+    memset(pxCtx->ucAnswer, 0, nfcauthANSWER_LEN);
+    if( ucl_sha1(pxCtx->ucAnswer, (uint8_t *) pxChallenge->ucSeed,
+	    commandsMAX_DATA_SIZE) != UCL_OK )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+
+    /* fresh IV per session instead of the fixed 3DES IV */
+    if( ulGenerateRandomNumber(pxCtx->ulOrwlIV,
+	    nfcauthBLOCK_LEN / sizeof(uint32_t)) )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    memcpy(pucRequest, pxCtx->ulOrwlIV, nfcauthBLOCK_LEN);
+
+    memset(ucPlain, 0, sizeof(ucPlain));
+    memcpy(ucPlain, pxChallenge, sizeof(NfcCommonSeed_Info_t));
+    memcpy(ucIV, pxCtx->ulOrwlIV, nfcauthBLOCK_LEN);
+    if( ucl_aes_cbc(pucCipher, ucPlain, pxCtx->ucEncKey, nfcauthKEY_LEN, ucIV,
+	    nfcauthCHALLENGE_LEN, UCL_CIPHER_ENCRYPT) != UCL_OK )
+    {
+	lStatus = COMMON_ERR_FATAL_ERROR;
+	goto END;
+    }
+
+    /* tag = CMAC(Km, label || IV || C) */
+    ucMac[0] = nfcauthLABEL_REQUEST;
+    memcpy(&ucMac[1], pucRequest, nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN);
+    lStatus = lNfcAuthCmac(&pucRequest[nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN],
+	    pxCtx->ucMacKey, ucMac, 1 + nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN);
+
+END:
+    memset(ucPlain, 0, sizeof(ucPlain));
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lNfcAuthCheckResponse( nfcauthContext_t *pxCtx,
+			       const uint8_t *pucResponse, uint32_t ulLen )
+{
+    uint8_t ucMac[nfcauthMAC_BUF_LEN];
+    uint8_t ucTag[nfcauthTAG_LEN];
+    uint8_t ucPlain[nfcauthANSWER_LEN];
+    uint8_t ucIV[nfcauthBLOCK_LEN];
+    uint8_t ucCipher[nfcauthANSWER_LEN];
+    uint32_t ulDiff;
+    int32_t lStatus;
+
+    if( ( pxCtx == NULL ) || ( pucResponse == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( ulLen != nfcauthRESPONSE_LEN )
+    {
+	return COMMON_ERR_INVAL;
+    }
+
+    /* tag = CMAC(Km, label || IV_orwl || IV_keyfob || C); the ORWL IV makes
+     * a recorded response useless in a later session
+     */
+    ucMac[0] = nfcauthLABEL_RESPONSE;
+    memcpy(&ucMac[1], pxCtx->ulOrwlIV, nfcauthBLOCK_LEN);
+    memcpy(&ucMac[1 + nfcauthBLOCK_LEN], pucResponse,
+	    nfcauthBLOCK_LEN + nfcauthANSWER_LEN);
+    lStatus = lNfcAuthCmac(ucTag, pxCtx->ucMacKey, ucMac,
+	    1 + ( 2 * nfcauthBLOCK_LEN ) + nfcauthANSWER_LEN);
+    if( lStatus != NO_ERROR )
+    {
+	return lStatus;
+    }
+    if( prvNfcAuthCompare(ucTag, &pucResponse[nfcauthBLOCK_LEN +
+	    nfcauthANSWER_LEN], nfcauthTAG_LEN) != 0 )
+    {
+	return COMMON_ERR_NO_MATCH;
+    }
+
+    /* only an authenticated answer is decrypted */
+    memcpy(ucIV, pucResponse, nfcauthBLOCK_LEN);
+    memcpy(ucCipher, &pucResponse[nfcauthBLOCK_LEN], nfcauthANSWER_LEN);
+    if( ucl_aes_cbc(ucPlain, ucCipher, pxCtx->ucEncKey, nfcauthKEY_LEN, ucIV,
+	    nfcauthANSWER_LEN, UCL_CIPHER_DECRYPT) != UCL_OK )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    ulDiff = prvNfcAuthCompare(ucPlain, pxCtx->ucAnswer, nfcauthANSWER_LEN);
+    memset(ucPlain, 0, sizeof(ucPlain));
+    return ( ulDiff == 0 ) ? NO_ERROR : COMMON_ERR_NO_MATCH;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcAuthAesAuthenticate( const keyfobidKeyFobInfo_t *pxKeyInfo,
+				   const NfcCommonSeed_Info_t *pxChallenge )
+{
+    nfcauthContext_t xCtx;
+    uint8_t ucRequest[nfcauthREQUEST_LEN];
+    uint8_t ucResponse[commandsRAW_ACCESS_BUF_LEN];
+    uint32_t ulRLen = commandsRAW_ACCESS_BUF_LEN;
+    uint32_t ulResult = eventsKEYFOB_NFC_AUTH_FAILURE;
+
+    if( lNfcAuthDeriveKeys(&xCtx, pxKeyInfo) != NO_ERROR )
+    {
+	debugERROR_PRINT("Failed to derive the session keys \n");
+	goto END;
+    }
+    if( lNfcAuthBuildRequest(&xCtx, pxChallenge, ucRequest) != NO_ERROR )
+    {
+	debugERROR_PRINT("Failed to build the AES request \n");
+	goto END;
+    }
+    if( ulNfcCmdAesAuth(ucRequest, nfcauthREQUEST_LEN)
+	    != PH_NFCLIB_STATUS_SUCCESS )
+    {
+	debugERROR_PRINT("Failed to write data to peer \n");
+	goto END;
+    }
+    if( ulNfcCmdReadRawData(ucResponse, &ulRLen) != PH_NFCLIB_STATUS_SUCCESS )
+    {
+	debugERROR_PRINT("Failed to read data from peer \n");
+	goto END;
+    }
+    if( lNfcAuthCheckResponse(&xCtx, ucResponse, ulRLen) != NO_ERROR )
+    {
+	debugERROR_PRINT("Invalid Data Received \n");
+	goto END;
+    }
+    ulResult = eventsKEYFOB_NFC_AUTH_SUCCESS;
+
+END:
+    memset(&xCtx, 0, sizeof(xCtx));
+    return ulResult;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcAuthTdesAuthenticate( const keyfobidKeyFobInfo_t *pxKeyInfo,
+				    const NfcCommonSeed_Info_t *pxChallenge )
+{
+    uint8_t ucHash[commandsRAW_ACCESS_BUF_LEN] = {0};
+    uint8_t ucDataBuf[commandsRAW_ACCESS_BUF_LEN] = {0};
+    uint8_t ucTmpBuf[commandsRAW_ACCESS_BUF_LEN] = {0};
+    uint8_t ucAnswer[commandsRAW_ACCESS_BUF_LEN] = {0};
+    uint32_t ulRLen;
+    uint32_t ulResult = eventsKEYFOB_NFC_AUTH_FAILURE;
+
+    /* Generate the SHA1 hash */
+    if(ucl_sha1(ucHash, (uint8_t *) pxChallenge->ucSeed,
+	    commandsMAX_DATA_SIZE) != NO_ERROR)
+    {
+	debugERROR_PRINT(" Failed to generate the SHA1 hash");
+	goto END;
+    }
+    /* Encrypt using x and then z*/
+    if(ulNfcCommonEncrpytData(ucTmpBuf, (uint8_t *) pxChallenge,
+	    (uint8_t *) pxKeyInfo->xSecKeyX.ucTDESKey,
+	    sizeof(NfcCommonSeed_Info_t)) != NO_ERROR)
+    {
+	debugERROR_PRINT("Failed to encrypt data \n");
+	goto END;
+    }
+    if(ulNfcCommonEncrpytData(ucDataBuf, ucTmpBuf,
+	    (uint8_t *) pxKeyInfo->xSecKeyZ.ucTDESKey,
+	    sizeof(NfcCommonSeed_Info_t)) != NO_ERROR)
+    {
+	debugERROR_PRINT("Failed to encrypt data \n");
+	goto END;
+    }
+    /* Send the encrypted data to keyFob */
+    if(ulNfcCmdWriteRawData(ucDataBuf, sizeof(NfcCommonSeed_Info_t))
+	    != PH_NFCLIB_STATUS_SUCCESS)
+    {
+	debugERROR_PRINT("Failed to write data to peer \n");
+	goto END;
+    }
+    /* Read data */
+    ulRLen = commandsRAW_ACCESS_BUF_LEN;
+    if(ulNfcCmdReadRawData(ucDataBuf, &ulRLen) != PH_NFCLIB_STATUS_SUCCESS)
+    {
+	debugERROR_PRINT("Failed to read data from peer \n");
+	goto END;
+    }
+    /* Decrypt using z then y */
+    if(ulNfcCommonDecrpytData(ucTmpBuf, ucDataBuf,
+	    (uint8_t *) pxKeyInfo->xSecKeyZ.ucTDESKey, ulRLen) != NO_ERROR)
+    {
+	debugERROR_PRINT("Failed to decrypt data \n");
+	goto END;
+    }
+    if(ulNfcCommonDecrpytData(ucAnswer, ucTmpBuf,
+	    (uint8_t *) pxKeyInfo->xSecKeyY.ucTDESKey, ulRLen) != NO_ERROR)
+    {
+	debugERROR_PRINT("Failed to decrypt data \n");
+	goto END;
+    }
+    ulResult = ulNfcCommonVerifyKey(ucAnswer, ucHash, commandsSHA_HASH_LENGTH);
+
+END:
+    memset(ucAnswer, 0, sizeof(ucAnswer));
+    memset(ucTmpBuf, 0, sizeof(ucTmpBuf));
+    return ulResult;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcAuthAuthenticate( const keyfobidKeyFobInfo_t *pxKeyInfo,
+				const NfcCommonSeed_Info_t *pxChallenge )
+{
+    configASSERT(pxKeyInfo != NULL);
+    configASSERT(pxChallenge != NULL);
+
+    /* the scheme is fixed at association; a keyfob stored as AES is never
+     * accepted through the 3DES exchange
+     */
+    if( pxKeyInfo->ulKeyType == keyfobidKEY_TYPE_AES128 )
+    {
+	return ulNfcAuthAesAuthenticate(pxKeyInfo, pxChallenge);
+    }
+    return ulNfcAuthTdesAuthenticate(pxKeyInfo, pxChallenge);
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcAuthGetModes( void )
+{
+    uint8_t ucModes[commandsRAW_ACCESS_BUF_LEN];
+    uint32_t ulRLen = commandsRAW_ACCESS_BUF_LEN;
+
+    /* keyfobs predating the command answer with an error */
+    if( ( ulNfcCmdGetAuthModes(ucModes, &ulRLen) == PH_NFCLIB_STATUS_SUCCESS ) &&
+	( ulRLen >= 1 ) )
+    {
+	return ucModes[0];
+    }
+    return commandsAUTH_MODE_TDES;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
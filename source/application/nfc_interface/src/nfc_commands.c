@@ -41,6 +41,7 @@
 /* nfc commands header */
 #include <nfc_commands.h>
 #include <nfc_common.h>
+#include <nfc_session.h>
 
 /* error messages header */
 #include <errors.h>
@@ -81,7 +82,8 @@ uint32_t ulNfcCmdSelectMasterApplet( void )
 			commandsMASTER_APPLET_LEN;
 
 	/* initiate transfer */
-	return phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsMASTER_APPLET_LEN );
+	return ulNfcSessionTransmit( nfcsessionAPDU_SELECT,
+			&xphNfcLib_TransmitInput, commandsMASTER_APPLET_LEN );
 }
 /*----------------------------------------------------------------------------*/
 
@@ -111,7 +113,8 @@ uint32_t ulNfcCmdSelectUserApplet( void )
 			commandsUSER_APPLET_LEN;
 
 	/* initiate transfer */
-	return phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsUSER_APPLET_LEN );
+	return ulNfcSessionTransmit( nfcsessionAPDU_SELECT,
+			&xphNfcLib_TransmitInput, commandsUSER_APPLET_LEN );
 }
 /*----------------------------------------------------------------------------*/
 
@@ -145,7 +148,8 @@ uint32_t ulNfcCmdReadRawData( uint8_t *pucReadBuf, uint32_t *pulReadLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Read_Raw_Data command sent \n");
@@ -203,7 +207,8 @@ uint32_t ulNfcCmdReadPublicKey( uint8_t *pucReadBuf, uint32_t *pulReadLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Read_Public_key command sent \n");
@@ -258,7 +263,8 @@ uint32_t ulNfcCmdGetKeyFobChallenge( uint8_t *pucReadBuf, uint32_t *pulReadLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Get_Peer_Challenge command sent \n");
@@ -313,7 +319,8 @@ uint32_t ulNfcCmdGetName( uint8_t *pucReadBuf, uint32_t *pulReadLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Get_Peer_Name command sent \n");
@@ -368,7 +375,8 @@ uint32_t ulNfcCmdGetSerial( uint8_t *pucReadBuf, uint32_t *pulReadLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_GET_SERIAL command sent \n");
@@ -384,7 +392,7 @@ uint32_t ulNfcCmdGetSerial( uint8_t *pucReadBuf, uint32_t *pulReadLen )
 }
 /*----------------------------------------------------------------------------*/
 
-uint32_t ulNfcCmdKeyAssociate( void )
+uint32_t ulNfcCmdKeyAssociate( uint32_t ulX25519 )
 {
 	/* Input buffer to hold DESFIRE data and command */
 	phNfcLib_Transmit_t xphNfcLib_TransmitInput;
@@ -396,7 +404,8 @@ uint32_t ulNfcCmdKeyAssociate( void )
 	uint32_t ulStatus;
 
 	/* Send Key association command */
-	ucCmdBuf = eCMD_ASSOCIATION_REQUEST;
+	ucCmdBuf = ( ulX25519 ) ? eCMD_X25519_ASSOCIATION_REQUEST :
+				  eCMD_ASSOCIATION_REQUEST;
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.bCommand = MFDF_Raw_Comm;
 
 	/* Length of Data in the command buffer */
@@ -404,7 +413,8 @@ uint32_t ulNfcCmdKeyAssociate( void )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Key_Association command sent \n");
@@ -451,7 +461,8 @@ uint32_t ulNfcCmdWriteRawData( uint8_t *pucWriteBuf, uint32_t ulWriteLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Write_Data command sent \n");
@@ -498,7 +509,8 @@ uint32_t ulNfcCmdWritePublicKey( uint8_t *pucWriteBuf, uint32_t ulWriteLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Write_Public_Key command sent \n");
@@ -545,7 +557,8 @@ uint32_t ulNfcCmdSaveKeyFobName( uint8_t *pucWriteBuf, uint32_t ulWriteLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Save_KeyFob_Name command sent \n");
@@ -592,7 +605,8 @@ uint32_t ulNfcCmdSendORWLChallenge( uint8_t *pucWriteBuf, uint32_t ulWriteLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Send_Challenge command sent \n");
@@ -650,7 +664,8 @@ uint32_t ulNfcCmdVerifyCVM( uint8_t *pucKey )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Write_CVM_VERIFY command sent \n");
@@ -689,7 +704,8 @@ uint32_t ulNfcCmdConfirmSSK( uint8_t *pucData , uint32_t ulLen )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Write_SSK_VERIFY command sent \n");
@@ -723,7 +739,8 @@ uint32_t ulNfcCmdSaveKey( void )
 	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
 
 	/* send data */
-	ulStatus = phNfcLib_Transmit( &xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
 	if( !ulStatus )
 	{
 		debugPRINT_NFC("MFDF_Save_Key command sent \n");
@@ -736,3 +753,99 @@ uint32_t ulNfcCmdSaveKey( void )
 	return ulStatus;
 }
 /*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcCmdGetAuthModes( uint8_t *pucReadBuf, uint32_t *pulReadLen )
+{
+	/* Input buffer to hold DESFIRE data and command */
+	phNfcLib_Transmit_t xphNfcLib_TransmitInput;
+
+	/* command buffer */
+	uint8_t ucCmdBuf;
+
+	/* status byte */
+	uint32_t ulStatus;
+
+	/* set if more than 256 Bytes of data expected */
+	uint16_t usMoreDataAvailable = 0;
+
+	/* validate input buffers */
+	if( pucReadBuf == NULL )
+	{
+		debugERROR_PRINT(" Invalid parameters Received \n");
+		return COMMON_ERR_NULL_PTR;
+	}
+
+	/* Send Raw Read command */
+	ucCmdBuf = eCMD_GET_AUTH_MODES;
+	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.bCommand = MFDF_Raw_Comm;
+
+	/* Length of Data in the command buffer */
+	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.bBufLen = 0;
+	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = &ucCmdBuf;
+
+	/* send data */
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf,
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	if( !ulStatus )
+	{
+		debugPRINT_NFC("MFDF_Get_Auth_Modes command sent \n");
+	}
+	else
+	{
+		debugPRINT_NFC("MFDF_Get_Auth_Modes not supported by peer "
+					"ulStatus = 0x%x \n",ulStatus);
+		return ulStatus;
+	}
+
+	return phNfcLib_Receive(pucReadBuf, pulReadLen, &usMoreDataAvailable);
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcCmdAesAuth( uint8_t *pucWriteBuf, uint32_t ulWriteLen )
+{
+	/* Input buffer to hold DESFIRE data and command */
+	phNfcLib_Transmit_t xphNfcLib_TransmitInput;
+
+	/* command buffer */
+	uint8_t ucCmdBuf[commandsRAW_ACCESS_BUF_LEN]={0};
+
+	/* status byte */
+	uint32_t ulStatus;
+
+	uint8_t ucCount = 0 ;
+
+	/* validate input buffers */
+	if( ( pucWriteBuf == NULL ) ||
+	    ( ulWriteLen >= commandsRAW_ACCESS_BUF_LEN ) )
+	{
+		debugERROR_PRINT(" Invalid parameters Received \n");
+		return COMMON_ERR_NULL_PTR;
+	}
+
+	/* Send Write command */
+	ucCmdBuf[ucCount] = eCMD_AES_AUTH;
+	for(ucCount = 0; ucCount < ulWriteLen; ucCount++)
+	{
+		ucCmdBuf[ucCount+1] = pucWriteBuf[ucCount];
+	}
+
+	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.bCommand = MFDF_Raw_Comm;
+	/* Length of Data in the command buffer */
+	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.bBufLen = ulWriteLen;
+	xphNfcLib_TransmitInput.phNfcLib_MifareDesfire.Operation.RawComm.pBuf = ucCmdBuf;
+
+	/* send data */
+	ulStatus = ulNfcSessionTransmit( ucCmdBuf[0],
+			&xphNfcLib_TransmitInput, commandsRAW_ACCESS_CMD_LEN );
+	if( !ulStatus )
+	{
+		debugPRINT_NFC("MFDF_Aes_Auth command sent \n");
+	}
+	else
+	{
+		debugERROR_PRINT("Failed to send MFDF_Aes_Auth command "
+					"ulStatus = 0x%x \n",ulStatus);
+	}
+	return ulStatus;
+}
+/*----------------------------------------------------------------------------*/
@@ -51,41 +51,24 @@ int32_t lNfcCommonGetKeyByName(keyfobidKeyFobInfo_t *pxKeyInfo,
 					    uint8_t pucKeyLen)
 {
     int32_t lStatus = NO_ERROR;
-    uint8_t ucCount = 0;
+    uint8_t ucIndex = 0;
 
-    keyfobidKeyFobInfo_t *pxBackUpKeyfobData = NULL;
-    pxBackUpKeyfobData = (keyfobidKeyFobInfo_t *) pvPortMalloc(
-	sizeof(keyfobidKeyFobInfo_t));
-    if(pxBackUpKeyfobData == NULL)
+    /* Slot is found in the RAM index, only the matching key is read */
+    lStatus = lKeyfobidFindKeyName(pucKeyName, pucKeyLen, &ucIndex);
+    if(lStatus != NO_ERROR)
     {
-        debugERROR_PRINT(""
-        	"Failed to allocate memory for keyfob entry structure ");
-        return COMMON_ERR_NULL_PTR;
+        debugERROR_PRINT(" Key info is not available in flash ");
+        return COMMON_ERR_OUT_OF_RANGE;
     }
 
-    for(ucCount=0;ucCount<keyfobidMAX_KEFOB_ENTRIES;ucCount++)
+    lStatus = lKeyfobidReadKey(pxKeyInfo, ucIndex);
+    if(lStatus == NO_ERROR)
     {
-        lStatus = lKeyfobidReadKey(pxBackUpKeyfobData,ucCount);
-        if(lStatus == NO_ERROR)
-        {
-            if(!memcmp(pxBackUpKeyfobData->ucKeyName,pucKeyName,pucKeyLen))
-            {
-        	debugPRINT_NFC(" KEY NAME match found        ");
-                memcpy((void *)pxKeyInfo, (void *)pxBackUpKeyfobData,
-			sizeof(keyfobidKeyFobInfo_t));
-                break;
-            }
-        }
-        else
-        {
-            debugERROR_PRINT(" Failed to read the keyfob info structure ");
-        }
+        debugPRINT_NFC(" KEY NAME match found        ");
     }
-
-    if((lStatus == NO_ERROR) && (ucCount == keyfobidMAX_KEFOB_ENTRIES))
+    else
     {
-        debugERROR_PRINT(" Key info is not available in flash ");
-        lStatus = COMMON_ERR_OUT_OF_RANGE;
+        debugERROR_PRINT(" Failed to read the keyfob info structure ");
     }
     return lStatus;
 }
@@ -93,7 +76,8 @@ int32_t lNfcCommonGetKeyByName(keyfobidKeyFobInfo_t *pxKeyInfo,
 
 int32_t lNfcCommonWriteKeyInfo(uint8_t *pucKeyFOBName, uint8_t ucKeyFOBLen,
 				uint32_t ulprivilege, uint8_t *pucSSK,
-				uint8_t *pucORWL_SK, uint8_t *pucKeyFob_SK)
+				uint8_t *pucORWL_SK, uint8_t *pucKeyFob_SK,
+				uint32_t ulKeyType)
 {
     int32_t lStatus = NO_ERROR;
     keyfobidKeyFobInfo_t *pxKeyFobInfo = NULL;
@@ -114,6 +98,8 @@ int32_t lNfcCommonWriteKeyInfo(uint8_t *pucKeyFOBName, uint8_t ucKeyFOBLen,
     configASSERT(ulprivilege!=0);
     configASSERT(ucKeyFOBLen!=0);
 
+    /* reserved bytes must not carry heap contents into flash */
+    memset((void *)pxKeyFobInfo, 0, sizeof(keyfobidKeyFobInfo_t));
     memcpy((void *)pxKeyFobInfo->ucKeyName, (void *)pucKeyFOBName, ucKeyFOBLen);
     pxKeyFobInfo->ulKeyNameLen = ucKeyFOBLen;
     pxKeyFobInfo->ulKeyPrevilage = ulprivilege;
@@ -124,6 +110,7 @@ int32_t lNfcCommonWriteKeyInfo(uint8_t *pucKeyFOBName, uint8_t ucKeyFOBLen,
     memcpy((void *)pxKeyFobInfo->xSecKeyY.ucTDESKey, (void *)pucKeyFob_SK,
 	    cryto3DES_KEY_SIZE);
     memcpy((void*)pxKeyFobInfo->ulKeyPIN, gucCVMPIN, sizeof(gucCVMPIN));
+    pxKeyFobInfo->ulKeyType = ulKeyType;
     lStatus = lKeyfobidAddKey(pxKeyFobInfo);
     if(lStatus != NO_ERROR)
     {
@@ -52,8 +52,12 @@
 #include <usermode.h>
 #include <events.h>
 #include <trng.h>
+#include <prng_drbg.h>
 #include <crypto_interface.h>
 #include <nfc_common.h>
+#include <nfc_lpcd.h>
+#include <nfc_session.h>
+#include <nfc_auth.h>
 
 extern uint8_t gucPlain[commandsCONFIRMSSK_SIZE];
 
@@ -67,14 +71,14 @@ uint32_t ulNfcAppTaskBuffer[SIMPLIFIED_ISO_STACK];
 #endif /* PHOSAL_FREERTOS_STATIC_MEM_ALLOCATION */
 
 #define nfcappCLEAR_EVENT		(0)	/**< Clear the event */
-#define nfcapp100MSEC_SEC_FACTOR	(10)	/**< usermodeDELAY_MSEC_100 * 10 = 1 sec */
+#define nfcappMSEC_SEC_FACTOR		(1000)	/**< number of milliseconds in one second */
 #define nfcappSEC_MIN_FACTOR		(60)	/**< number of seconds in one minute */
 #define nfcappDELAY_IN_MINS		(15)	/**< 15 mins delay */
 #define nfcappDELAY_IN_SECS		(10)	/**< 10 secs delay */
 /**
- *  10 secs timeout for card detection
+ *  10 secs timeout for card detection, in ticks
  */
-#define nfcappTIMEOUT			( nfcapp100MSEC_SEC_FACTOR * \
+#define nfcappTIMEOUT			pdMS_TO_TICKS( nfcappMSEC_SEC_FACTOR * \
 					nfcappDELAY_IN_SECS )
 
 /** KeyFob serial last four bytes */
@@ -85,6 +89,12 @@ uint32_t ulNfcAppTaskBuffer[SIMPLIFIED_ISO_STACK];
  */
 static keyfobidKeyFobInfo_t gxKeyFobInfo;
 
+/**
+ * Generation of keyfob table when gxKeyFobInfo was stored. Stored details
+ * are read again once the table is changed.
+ */
+static uint32_t gulKeyFobGeneration;
+
 /**
  * @brief This is a dedicated freeRTOS task for NFC detection and read data
  * from the NFC cards or tags. Polls for the NFC tags and initiates the
@@ -103,6 +113,11 @@ uint32_t ulNfcInterafceInit(void* pvParams)
 
     configASSERT(pvParams != NULL);
 
+    if (lNfcSessionInit() != NO_ERROR)
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
     /* Perform OSAL Initialization. */
     phOsal_Init();
 
@@ -122,7 +137,11 @@ static void prvNfcInterfaceTask(void* pvParams)
     uint32_t ulPLen = 0;
     uint32_t ulRLen = 0;
     uint32_t ulKeyFobLen = 0;
-    uint32_t ulTimeOutCounter = 0;
+    uint32_t ulKeyType = keyfobidKEY_TYPE_TDES;
+    uint32_t ulModes = commandsAUTH_MODE_TDES;
+    uint32_t ulCurveId = cryptoCURVE_ID;
+    uint32_t ulWake = nfclpcdWAKE_FIELD;
+    TickType_t xDeadline;
     uint8_t ucKeyEntryNum = 0;
     uint8_t ucKeyFOBName[nfccommonKEYFOBNAME_FULL_LEN]={0};
     uint8_t ucDataBuf[commandsRAW_ACCESS_BUF_LEN] = {0};
@@ -131,6 +150,7 @@ static void prvNfcInterfaceTask(void* pvParams)
     uint8_t ucORWLKey[cryto3DES_KEY_SIZE] = {0};
     uint8_t ucKeyFobKey[cryto3DES_KEY_SIZE] = {0};
     keyfobidKeyFobInfo_t *pxKeyInfo = NULL;
+    cryptoEcdhCtx_t *pxEcdh = NULL;
     NfcCommonSeed_Info_t xChallenge;
     EventBits_t xBits, xEventRecieved, xStopEventRecieved;
     const TickType_t xTicksToWait = portMAX_DELAY;
@@ -233,48 +253,40 @@ static void prvNfcInterfaceTask(void* pvParams)
 	    {
 		break;
 	    }
-	    /* Activating the card with non blocking activation mode.
-	     * Polling every 100ms for detecting card for 15 mins.
-	     * So nfcappTIMEOUT_15MINS = (((100msdelay * 10)sec * 60)min * 15)
+	    /* Activating the card with non blocking activation mode. The
+	     * first attempt covers a keyfob already in the field. Between
+	     * attempts the reader sits in low power card detection and the
+	     * task sleeps until the antenna is detuned, or falls back to
+	     * timed polling; see nfc_lpcd.c.
 	     */
-	    ulTimeOutCounter = 0;
-	    do
+	    xDeadline = xTaskGetTickCount() + nfcappTIMEOUT;
+	    ulWake = nfclpcdWAKE_FIELD;
+	    vNfcLpcdBegin();
+	    while(phNfcLib_Activate(appTECHNOLOGY_MASK, &PeerInfo, NULL)
+		    != PH_NFCLIB_STATUS_PEER_ACTIVATION_DONE)
 	    {
-		if(phNfcLib_Activate(appTECHNOLOGY_MASK, &PeerInfo,
-				    NULL) != PH_NFCLIB_STATUS_PEER_ACTIVATION_DONE)
+		ulWake = ulNfcLpcdWait(pxResHandle->xEventGroupNFC,
+			eventsNFC_STOP_EXEC, xDeadline);
+		if(ulWake == nfclpcdWAKE_STOP)
 		{
-		    if(ulTimeOutCounter<nfcappTIMEOUT)
-		    {
-			/* Checking for nfc stop execution event */
-			xStopEventRecieved = xEventGroupWaitBits(
-				pxResHandle->xEventGroupNFC,
-				eventsNFC_STOP_EXEC,
-				pdFALSE,
-				pdFALSE,
-				usermodeDELAY_MSEC_100);
-			xStopEventRecieved = xEventGroupClearBits(
-				pxResHandle->xEventGroupNFC,
-				eventsNFC_STOP_EXEC);
-			if((xStopEventRecieved & eventsNFC_STOP_EXEC) ==
-				eventsNFC_STOP_EXEC)
-			{
-				ulEventToSend = eventsKEYFOB_STOP_NFC_SUCCESS;
-				xEventRecieved = xStopEventRecieved;
-				break;
-			}
-			ulTimeOutCounter++;
-		    }
-		    else
-		    {
-			ulEventToSend = eventsKEYFOB_DETECT_TIMEOUT;
-			break;
-		    }
+		    /* Checking for nfc stop execution event */
+		    xStopEventRecieved = xEventGroupClearBits(
+			    pxResHandle->xEventGroupNFC,
+			    eventsNFC_STOP_EXEC);
+		    ulEventToSend = eventsKEYFOB_STOP_NFC_SUCCESS;
+		    xEventRecieved = xStopEventRecieved;
+		    break;
 		}
-		else
+		else if(ulWake == nfclpcdWAKE_TIMEOUT)
 		{
+		    ulEventToSend = eventsKEYFOB_DETECT_TIMEOUT;
 		    break;
 		}
-	    }while(1);
+	    }
+	    if (ulWake == nfclpcdWAKE_FIELD)
+	    {
+		vNfcSessionActivated();
+	    }
 	    switch (PeerInfo.dwActivatedType)
 	    {
 	    case E_PH_NFCLIB_MIFARE_DESFIRE:
@@ -294,12 +306,7 @@ static void prvNfcInterfaceTask(void* pvParams)
 		else if((xEventRecieved & eventsNFC_GET_KEYFOB_SERIAL)
 			== eventsNFC_GET_KEYFOB_SERIAL)
 		{
-		    if (ulNfcCmdSelectMasterApplet() != PH_NFCLIB_STATUS_SUCCESS)
-		    {
-			debugERROR_PRINT("Failed to select Master applet \n");
-			break;
-		    }
-		    if (ulNfcCmdSelectUserApplet() != PH_NFCLIB_STATUS_SUCCESS)
+		    if (ulNfcSessionSelectUser() != PH_NFCLIB_STATUS_SUCCESS)
 		    {
 			debugERROR_PRINT("Failed to select User applet \n");
 			break;
@@ -339,19 +346,14 @@ static void prvNfcInterfaceTask(void* pvParams)
 			== eventsNFC_DETECT_KEYFOB)
 		{
 		    debugPRINT_NFC("Running keyFob authentication procedure \n");
-		    if (ulNfcCmdSelectMasterApplet() != PH_NFCLIB_STATUS_SUCCESS)
-		    {
-			debugERROR_PRINT("Failed to select Master applet \n");
-			break;
-		    }
-		    if (ulNfcCmdSelectUserApplet() != PH_NFCLIB_STATUS_SUCCESS)
+		    if (ulNfcSessionSelectUser() != PH_NFCLIB_STATUS_SUCCESS)
 		    {
 			debugERROR_PRINT("Failed to select User applet \n");
 			break;
 		    }
 		    /* Get Key fob name */
 		    ulRLen = commandsRAW_ACCESS_BUF_LEN;
-		    if (ulNfcCmdGetName(ucDataBuf, &ulRLen)
+		    if (ulNfcSessionGetName(ucDataBuf, &ulRLen)
 			    != PH_NFCLIB_STATUS_SUCCESS)
 		    {
 			debugERROR_PRINT("Failed to read name of peer \n");
@@ -367,7 +369,8 @@ static void prvNfcInterfaceTask(void* pvParams)
 			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
 			break;
 		    }
-		    if(pdTRUE == ucFirstBoot)
+		    if((pdTRUE == ucFirstBoot) ||
+			    (gulKeyFobGeneration != ulKeyfobidGetGeneration()))
 		    {
 			/* Get key fob details from flash */
 			if(lNfcCommonGetKeyByName(pxKeyInfo,ucDataBuf,ulRLen)
@@ -395,17 +398,15 @@ static void prvNfcInterfaceTask(void* pvParams)
 			break;
 		    }
 		    */
-		    /* generate random number */
-		    if (ulGenerateRandomNumber((uint32_t*) xChallenge.ucSeed,
-			    commandsTRNG_NUM_OF_WORDS))
+		    /* generate the BLE seed from the shared DRBG */
+		    if (lPrngDrbgRandom(xChallenge.ucSeed, nfccommonSEED_SIZE))
 		    {
 			debugERROR_PRINT("Failed to generate random number \n");
 			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
 			break;
 		    }
-		    if (ulGenerateRandomNumber(
-			    (uint32_t*) xChallenge.ucSeedIncrFactor,
-			    nfccommonSEED_INC_WLEN))
+		    if (lPrngDrbgRandom(xChallenge.ucSeedIncrFactor,
+			    nfccommonSEED_INC_SIZE))
 		    {
 			debugERROR_PRINT("Failed to generate random number \n");
 			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
@@ -413,76 +414,10 @@ static void prvNfcInterfaceTask(void* pvParams)
 		    }
 		    xChallenge.ucRotInterval[0] = nfccommonROT_INTERVAL;
 		    xChallenge.ucBleRange = pxResHandle->ucBLERange;
-		    /* Generate the SHA1 hash */
-		    ulStatus=ucl_sha1(ucSSKey, xChallenge.ucSeed,
-			    commandsMAX_DATA_SIZE);
-		    if(ulStatus!= NO_ERROR)
-		    {
-			debugERROR_PRINT(" Failed to generate the SHA1 hash");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    /* Encrypt using x and then z*/
-		    ulStatus = ulNfcCommonEncrpytData(ucTmpBuf,
-			    (uint8_t *)&xChallenge,
-			    pxKeyInfo->xSecKeyX.ucTDESKey,
-			    sizeof(NfcCommonSeed_Info_t));
-		    if(ulStatus != NO_ERROR )
-		    {
-			debugERROR_PRINT("Failed to encrypt data \n");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    ulStatus = ulNfcCommonEncrpytData(ucDataBuf,
-			    ucTmpBuf,
-			    pxKeyInfo->xSecKeyZ.ucTDESKey,
-			    sizeof(NfcCommonSeed_Info_t));
-		    if(ulStatus != NO_ERROR )
-		    {
-			debugERROR_PRINT("Failed to encrypt data \n");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    /* Send the encrypted data to keyFob */
-		    if(ulNfcCmdWriteRawData(ucDataBuf,
-			    sizeof(NfcCommonSeed_Info_t))
-			    != PH_NFCLIB_STATUS_SUCCESS)
-		    {
-			debugERROR_PRINT("Failed to write data to peer \n");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    /* Read data */
-		    ulRLen = commandsRAW_ACCESS_BUF_LEN;
-		    if (ulNfcCmdReadRawData(ucDataBuf, &ulRLen)
-			    != PH_NFCLIB_STATUS_SUCCESS)
-		    {
-			debugERROR_PRINT("Failed to read data from peer \n");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    /* Decrypt using z then y */
-		    ulStatus = ulNfcCommonDecrpytData(ucTmpBuf, ucDataBuf,
-			    pxKeyInfo->xSecKeyZ.ucTDESKey, ulRLen);
-		    if (ulStatus != NO_ERROR)
-		    {
-			debugERROR_PRINT("Failed to decrypt data \n");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    ulStatus = ulNfcCommonDecrpytData(ucKeyFobKey, ucTmpBuf,
-			    pxKeyInfo->xSecKeyY.ucTDESKey, ulRLen);
-		    if (ulStatus != NO_ERROR)
-		    {
-			debugERROR_PRINT("Failed to decrypt data \n");
-			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
-			break;
-		    }
-		    if(ulNfcCommonVerifyKey(ucKeyFobKey, ucSSKey,
-			    commandsSHA_HASH_LENGTH)
+		    /* Challenge exchange with the scheme of the keyfob entry */
+		    if(ulNfcAuthAuthenticate(pxKeyInfo, &xChallenge)
 			    != eventsKEYFOB_NFC_AUTH_SUCCESS)
 		    {
-			debugERROR_PRINT("Invalid Data Received \n");
 			ulEventToSend = eventsKEYFOB_NFC_AUTH_FAILURE;
 			break;
 		    }
@@ -533,6 +468,7 @@ static void prvNfcInterfaceTask(void* pvParams)
 			 */
 			memcpy((void*)&gxKeyFobInfo, (void*)pxKeyInfo,
 				sizeof(keyfobidKeyFobInfo_t));
+			gulKeyFobGeneration = ulKeyfobidGetGeneration();
 			ucFirstBoot = pdFALSE;
 			debugPRINT_NFC("KEYFOB AUTHENTICATION SUCCESS\n");
 			ulEventToSend = eventsKEYFOB_NFC_AUTH_SUCCESS;
@@ -579,23 +515,32 @@ static void prvNfcInterfaceTask(void* pvParams)
 		    }
 
 		    debugPRINT_NFC("Running keyFob association procedure \n");
-		    /* Generating the Public Key */
-		    if (ulCryptoEcdh_PublicKeyGen(cryptoCURVE_ID, ucSSKey,
-			    &ulLen) != NO_ERROR)
+		    if (ulNfcSessionSelectUser() != PH_NFCLIB_STATUS_SUCCESS)
 		    {
-			debugERROR_PRINT("Public Key Generation failed \n");
-			ulEventToSend = eventsKEYFOB_NFC_ASSOCIATION_FAILURE;
+			debugERROR_PRINT("Failed to select User applet \n");
 			break;
 		    }
-
-		    if (ulNfcCmdSelectMasterApplet() != PH_NFCLIB_STATUS_SUCCESS)
+		    /* One read of the modes decides both the curve and the
+		     * authentication scheme stored for this keyfob
+		     */
+		    ulModes = ulNfcAuthGetModes();
+		    /* Keyfobs advertising X25519 skip the generic ECP path */
+		    ulCurveId = ( ulModes & commandsAUTH_MODE_X25519 ) ?
+			    cryptoCURVE_X25519 : cryptoCURVE_ID;
+		    ulKeyType = ( ulModes & commandsAUTH_MODE_AES128 ) ?
+			    keyfobidKEY_TYPE_AES128 : keyfobidKEY_TYPE_TDES;
+		    /* Generating the Public Key */
+		    pxEcdh = pxCryptoEcdhAcquire();
+		    if (pxEcdh == NULL)
 		    {
-			debugERROR_PRINT("Failed to select Master applet \n");
+			ulEventToSend = eventsKEYFOB_NFC_ASSOCIATION_FAILURE;
 			break;
 		    }
-		    if (ulNfcCmdSelectUserApplet() != PH_NFCLIB_STATUS_SUCCESS)
+		    if (ulCryptoEcdh_PublicKeyGen(pxEcdh, ulCurveId, ucSSKey,
+			    &ulLen) != NO_ERROR)
 		    {
-			debugERROR_PRINT("Failed to select User applet \n");
+			debugERROR_PRINT("Public Key Generation failed \n");
+			ulEventToSend = eventsKEYFOB_NFC_ASSOCIATION_FAILURE;
 			break;
 		    }
 		    /*Update OLED display */
@@ -603,7 +548,8 @@ static void prvNfcInterfaceTask(void* pvParams)
 		    dispWELCOME_IMGRBX, dispWELCOME_IMGRBY, dispBACKGROUND_BLACK);
 		    vDisplaySetTextPos( dispWELCOME_STR_XCOR, dispWELCOME_STR_YCOR);
 		    vDisplayText((const int8_t *)uiASSOCIATION_PROGRESS);
-		    if (ulNfcCmdKeyAssociate() != PH_NFCLIB_STATUS_SUCCESS)
+		    if (ulNfcCmdKeyAssociate(ulCurveId == cryptoCURVE_X25519)
+			    != PH_NFCLIB_STATUS_SUCCESS)
 		    {
 			debugERROR_PRINT("Key association request failed \n");
 			ulEventToSend = eventsKEYFOB_NFC_ASSOCIATION_FAILURE;
@@ -627,7 +573,7 @@ static void prvNfcInterfaceTask(void* pvParams)
 			break;
 		    }
 		    /* Generate Shared Secret Key */
-		    if (ulCryptoEcdh_GenSSK(ucDataBuf, (uint8_t *)&ulPLen,
+		    if (ulCryptoEcdh_GenSSK(pxEcdh, ucDataBuf, (uint8_t *)&ulPLen,
 			    ucSSKey) != NO_ERROR)
 		    {
 			debugERROR_PRINT(
@@ -754,7 +700,7 @@ static void prvNfcInterfaceTask(void* pvParams)
 		    /* Storing the KeyFob info in the flash*/
 		    if(lNfcCommonWriteKeyInfo(ucKeyFOBName, ulKeyFobLen,
 			    xNfcData.ulKeyPrivilege, ucSSKey, ucORWLKey,
-			    ucKeyFobKey)!= NO_ERROR)
+			    ucKeyFobKey, ulKeyType)!= NO_ERROR)
 		    {
 			debugERROR_PRINT(" Error in writing the key to flash ");
 			ulEventToSend = eventsKEYFOB_NFC_ASSOCIATION_FAILURE;
@@ -782,6 +728,17 @@ static void prvNfcInterfaceTask(void* pvParams)
 		vPortFree(pxKeyInfo);
 		pxKeyInfo = NULL;
 	    }
+	    /* Key pair and secret don't outlive the association attempt */
+	    if(pxEcdh != NULL)
+	    {
+		vCryptoEcdhRelease(pxEcdh);
+		pxEcdh = NULL;
+	    }
+	    /* A cached name that did not authenticate must be read again */
+	    if (ulEventToSend == eventsKEYFOB_NFC_AUTH_FAILURE)
+	    {
+		vNfcSessionInvalidate();
+	    }
 	    if( ulEventToSend != eventsKEYFOB_DETECT_TIMEOUT)
 	    {
 		ulStatus = phNfcLib_Deactivate(PH_NFCLIB_DEACTIVATION_MODE_RELEASE,
@@ -796,6 +753,7 @@ static void prvNfcInterfaceTask(void* pvParams)
 				    PH_NFCLIB_DEACTIVATION_MODE_RF_OFF, &PeerInfo);
 		}
 	    }
+	    vNfcSessionReleased();
 	    /* Disable NFC BOOSTER */
 	    phNfcLibDisableNfcBooster();
 	    /* Disable the RF field so that field should not detect in ideal condition */
@@ -0,0 +1,386 @@
+ /**===========================================================================
+ * @file nfc_lpcd.c
+ *
+ * @brief This file contains the low power card detection of the NFC front-end.
+ * The reader is calibrated on the empty field and put into its power down
+ * detection cycle; the NFC task only runs a full activation when the antenna
+ * is detuned. Timed polling with a growing interval is the fallback when the
+ * detection is unavailable or keeps waking without a card.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <string.h>
+
+/* nfc interface header */
+#include <nfc_interface.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <event_groups.h>
+
+/* local includes */
+#include <errors.h>
+#include <nfc_lpcd.h>
+
+/** detection modes of a session */
+#define nfclpcdMODE_DETECT		(0)	/**< reader side card detection */
+#define nfclpcdMODE_POLL		(1)	/**< timed polling fallback */
+
+/**
+ * @brief State of the current detection session.
+ */
+typedef struct
+{
+    /** nfclpcdMODE_DETECT or nfclpcdMODE_POLL */
+    uint8_t ucMode;
+    /** antenna has to be calibrated before the next detection */
+    uint8_t ucNeedCal;
+    /** reference I and Q of the empty field */
+    uint8_t ucRefI;
+    uint8_t ucRefQ;
+    /** previous wait returned nfclpcdWAKE_FIELD */
+    uint8_t ucPending;
+    /** false wakes since the last calibration */
+    uint8_t ucFalseWakes;
+    /** calibrations done in this session */
+    uint8_t ucCalibrations;
+    /** current interval of the fallback polling in ms */
+    uint16_t usPollMs;
+} nfclpcdState_t;
+
+/** detection parameters */
+static nfclpcdConfig_t xLpcdConfig = {
+    nfclpcdPOWER_DOWN_MS,
+    nfclpcdDETECTION_US,
+    nfclpcdSENSITIVITY,
+    nfclpcdCAL_SAMPLES,
+    nfclpcdCAL_MAX_SPREAD,
+    nfclpcdMAX_FALSE_WAKES,
+    nfclpcdMAX_RECALIBRATIONS,
+    nfclpcdPOLL_MIN_MS,
+    nfclpcdPOLL_MAX_MS,
+};
+
+/** session state */
+static nfclpcdState_t xLpcdState;
+
+/**
+ * @brief Measures the empty field and arms the reader with the averaged
+ * reference. A spread above the configured limit means the antenna
+ * environment is too noisy for the detection.
+ *
+ * @return NO_ERROR on success, error code otherwise.
+ */
+static int32_t prvNfcLpcdCalibrate( void );
+
+/**
+ * @brief Runs one reader side detection cycle. Blocks until the reader
+ * interrupt signals either a detuned field or the end of its short power
+ * down period.
+ *
+ * @param pulField set to pdTRUE when a field change above the sensitivity
+ * was detected.
+ *
+ * @return NO_ERROR on success, error code otherwise.
+ */
+static int32_t prvNfcLpcdDetect( uint32_t *pulField );
+
+/**
+ * @brief Accounts an activation that found no peer after a wake.
+ */
+static void prvNfcLpcdFalseWake( void );
+
+/**
+ * @brief Switches the session to timed polling.
+ */
+static void prvNfcLpcdFallback( void );
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef NXPBUILD__PHHAL_HW_RC663
+static int32_t prvNfcLpcdCalibrate( void )
+{
+    void *pvHal;
+    uint32_t ulSumI = 0;
+    uint32_t ulSumQ = 0;
+    uint8_t ucMinI = UINT8_MAX, ucMaxI = 0;
+    uint8_t ucMinQ = UINT8_MAX, ucMaxQ = 0;
+    uint8_t ucI, ucQ;
+    uint8_t ucSample;
+
+    pvHal = phNfcLib_GetDataParams(PH_COMP_HAL);
+    if( ( pvHal == NULL ) || ( xLpcdConfig.ucCalSamples == 0 ) )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+    /* reference has to be taken without the carrier of the last poll */
+    (void) phhalHw_FieldOff(pvHal);
+
+    for( ucSample = 0; ucSample < xLpcdConfig.ucCalSamples; ucSample++ )
+    {
+	if( phhalHw_Rc663_Cmd_Lpcd_GetConfig(pvHal, &ucI, &ucQ)
+		!= PH_ERR_SUCCESS )
+	{
+	    return COMMON_ERR_FATAL_ERROR;
+	}
+	ulSumI += ucI;
+	ulSumQ += ucQ;
+	ucMinI = ( ucI < ucMinI ) ? ucI : ucMinI;
+	ucMaxI = ( ucI > ucMaxI ) ? ucI : ucMaxI;
+	ucMinQ = ( ucQ < ucMinQ ) ? ucQ : ucMinQ;
+	ucMaxQ = ( ucQ > ucMaxQ ) ? ucQ : ucMaxQ;
+    }
+    if( ( ( ucMaxI - ucMinI ) > xLpcdConfig.ucCalMaxSpread ) ||
+	( ( ucMaxQ - ucMinQ ) > xLpcdConfig.ucCalMaxSpread ) )
+    {
+	debugPRINT_NFC(" LPCD calibration unstable I %d-%d Q %d-%d ",
+		ucMinI, ucMaxI, ucMinQ, ucMaxQ);
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+
+    /* rounded average */
+    xLpcdState.ucRefI = (uint8_t) ( ( ulSumI + ( xLpcdConfig.ucCalSamples / 2 ) )
+	    / xLpcdConfig.ucCalSamples );
+    xLpcdState.ucRefQ = (uint8_t) ( ( ulSumQ + ( xLpcdConfig.ucCalSamples / 2 ) )
+	    / xLpcdConfig.ucCalSamples );
+    if( phhalHw_Rc663_Cmd_Lpcd_SetConfig(pvHal,
+	    PHHAL_HW_RC663_CMD_LPCD_MODE_POWERDOWN, xLpcdState.ucRefI,
+	    xLpcdState.ucRefQ, nfclpcdREADER_SLEEP_MS,
+	    xLpcdConfig.usDetectionUs) != PH_ERR_SUCCESS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    xLpcdState.ucNeedCal = pdFALSE;
+    xLpcdState.ucFalseWakes = 0;
+    xLpcdState.ucCalibrations++;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvNfcLpcdDetect( uint32_t *pulField )
+{
+    void *pvHal;
+    phStatus_t xStatus;
+    uint8_t ucI, ucQ;
+    uint8_t ucDevI, ucDevQ;
+
+    *pulField = pdFALSE;
+    pvHal = phNfcLib_GetDataParams(PH_COMP_HAL);
+    if( pvHal == NULL )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    /* the task sleeps on the reader interrupt for one short power down */
+    xStatus = phhalHw_Rc663_Cmd_Lpcd(pvHal);
+    if( ( xStatus & PH_ERR_MASK ) == PH_ERR_IO_TIMEOUT )
+    {
+	return NO_ERROR;
+    }
+    if( xStatus != PH_ERR_SUCCESS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+
+    /* the reader wakes on any step out of its window; small steps are
+     * temperature and supply drift and only move the reference
+     */
+    if( phhalHw_Rc663_Cmd_Lpcd_GetConfig(pvHal, &ucI, &ucQ) != PH_ERR_SUCCESS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    ucDevI = ( ucI > xLpcdState.ucRefI ) ? ( ucI - xLpcdState.ucRefI ) :
+	    ( xLpcdState.ucRefI - ucI );
+    ucDevQ = ( ucQ > xLpcdState.ucRefQ ) ? ( ucQ - xLpcdState.ucRefQ ) :
+	    ( xLpcdState.ucRefQ - ucQ );
+    if( ( ucDevI >= xLpcdConfig.ucSensitivity ) ||
+	( ucDevQ >= xLpcdConfig.ucSensitivity ) )
+    {
+	*pulField = pdTRUE;
+	return NO_ERROR;
+    }
+    xLpcdState.ucRefI = ucI;
+    xLpcdState.ucRefQ = ucQ;
+    if( phhalHw_Rc663_Cmd_Lpcd_SetConfig(pvHal,
+	    PHHAL_HW_RC663_CMD_LPCD_MODE_POWERDOWN, ucI, ucQ,
+	    nfclpcdREADER_SLEEP_MS, xLpcdConfig.usDetectionUs)
+	    != PH_ERR_SUCCESS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    return NO_ERROR;
+}
+#else /* NXPBUILD__PHHAL_HW_RC663 */
+static int32_t prvNfcLpcdCalibrate( void )
+{
+    /* front-end without card detection, timed polling only */
+    return COMMON_ERR_NOT_INITIALIZED;
+}
+/*----------------------------------------------------------------------------*/
+
+static int32_t prvNfcLpcdDetect( uint32_t *pulField )
+{
+    *pulField = pdTRUE;
+    return COMMON_ERR_NOT_INITIALIZED;
+}
+#endif /* NXPBUILD__PHHAL_HW_RC663 */
+/*----------------------------------------------------------------------------*/
+
+static void prvNfcLpcdFallback( void )
+{
+    debugPRINT_NFC(" LPCD unavailable, timed polling ");
+    xLpcdState.ucMode = nfclpcdMODE_POLL;
+    xLpcdState.usPollMs = xLpcdConfig.usPollMinMs;
+}
+/*----------------------------------------------------------------------------*/
+
+static void prvNfcLpcdFalseWake( void )
+{
+    if( xLpcdState.ucMode == nfclpcdMODE_POLL )
+    {
+	/* nothing in the field; poll less often the longer it stays empty */
+	xLpcdState.usPollMs = ( xLpcdState.usPollMs * 2 );
+	if( xLpcdState.usPollMs > xLpcdConfig.usPollMaxMs )
+	{
+	    xLpcdState.usPollMs = xLpcdConfig.usPollMaxMs;
+	}
+	return;
+    }
+    xLpcdState.ucFalseWakes++;
+    if( xLpcdState.ucFalseWakes < xLpcdConfig.ucMaxFalseWakes )
+    {
+	return;
+    }
+    /* the reference no longer matches the empty field */
+    if( xLpcdState.ucCalibrations > xLpcdConfig.ucMaxRecalibrations )
+    {
+	prvNfcLpcdFallback( );
+	return;
+    }
+    xLpcdState.ucNeedCal = pdTRUE;
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcLpcdSetConfig( const nfclpcdConfig_t *pxConfig )
+{
+    configASSERT(pxConfig != NULL);
+    configASSERT(pxConfig->usPollMinMs != 0);
+    configASSERT(pxConfig->usPollMaxMs >= pxConfig->usPollMinMs);
+
+    taskENTER_CRITICAL();
+    memcpy(&xLpcdConfig, pxConfig, sizeof(xLpcdConfig));
+    taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcLpcdGetConfig( nfclpcdConfig_t *pxConfig )
+{
+    configASSERT(pxConfig != NULL);
+
+    taskENTER_CRITICAL();
+    memcpy(pxConfig, &xLpcdConfig, sizeof(xLpcdConfig));
+    taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcLpcdBegin( void )
+{
+    memset(&xLpcdState, 0, sizeof(xLpcdState));
+    xLpcdState.ucMode = nfclpcdMODE_DETECT;
+    xLpcdState.ucNeedCal = pdTRUE;
+    xLpcdState.usPollMs = xLpcdConfig.usPollMinMs;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcLpcdWait( EventGroupHandle_t xEventGroup, EventBits_t xStopBits,
+			TickType_t xDeadline )
+{
+    TickType_t xRemaining;
+    TickType_t xDelay;
+    uint32_t ulField = pdFALSE;
+
+    configASSERT(xEventGroup != NULL);
+
+    if( xLpcdState.ucPending )
+    {
+	xLpcdState.ucPending = pdFALSE;
+	prvNfcLpcdFalseWake( );
+    }
+
+    while( 1 )
+    {
+	xRemaining = xDeadline - xTaskGetTickCount( );
+	if( ( xRemaining == 0 ) || ( xRemaining > portMAX_DELAY / 2 ) )
+	{
+	    return nfclpcdWAKE_TIMEOUT;
+	}
+
+	/* stop, deadline and the next cycle all end the same wait */
+	xDelay = pdMS_TO_TICKS(( xLpcdState.ucMode == nfclpcdMODE_POLL ) ?
+		xLpcdState.usPollMs : xLpcdConfig.usPowerDownMs);
+	if( xDelay > xRemaining )
+	{
+	    xDelay = xRemaining;
+	}
+	if( xEventGroupWaitBits(xEventGroup, xStopBits, pdFALSE, pdFALSE,
+		xDelay) & xStopBits )
+	{
+	    return nfclpcdWAKE_STOP;
+	}
+	if( xDelay == xRemaining )
+	{
+	    return nfclpcdWAKE_TIMEOUT;
+	}
+	if( xLpcdState.ucMode == nfclpcdMODE_POLL )
+	{
+	    break;
+	}
+
+	if( ( xLpcdState.ucNeedCal ) && ( prvNfcLpcdCalibrate( ) != NO_ERROR ) )
+	{
+	    prvNfcLpcdFallback( );
+	    continue;
+	}
+	if( prvNfcLpcdDetect(&ulField) != NO_ERROR )
+	{
+	    prvNfcLpcdFallback( );
+	    continue;
+	}
+	if( ulField )
+	{
+	    break;
+	}
+    }
+    xLpcdState.ucPending = pdTRUE;
+    return nfclpcdWAKE_FIELD;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
@@ -0,0 +1,314 @@
+ /**===========================================================================
+ * @file nfc_session.c
+ *
+ * @brief This file contains the NFC session layer. The applet selected on the
+ * activated keyfob is tracked so that no SELECT is repeated within one
+ * activation, and the keyfob name is cached per UID for a short window so a
+ * re-authentication of the same tag skips GetName. Every APDU exchange is
+ * timed with the free running timestamp timer.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <string.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* local includes */
+#include <errors.h>
+#include <orwl_timer.h>
+#include <nfc_commands.h>
+#include <nfc_session.h>
+
+/**
+ * @brief Identity of the last authenticated card.
+ */
+typedef struct
+{
+    /** UID of the card, length 0 when nothing is cached */
+    uint8_t ucUid[nfcsessionUID_MAX_LEN];
+    uint8_t ucUidLen;
+    /** name returned by GetName */
+    uint8_t ucName[nfcsessionNAME_MAX_LEN];
+    uint32_t ulNameLen;
+    /** tick count of the GetName the entry was filled from */
+    TickType_t xStamp;
+} nfcsessionIdentity_t;
+
+/** UID of the currently activated peer */
+static uint8_t ucSessionUid[nfcsessionUID_MAX_LEN];
+
+/** length of ucSessionUid, 0 when the UID is unknown */
+static uint8_t ucSessionUidLen;
+
+/** applet selected in the current activation */
+static uint8_t ucSessionApplet = nfcsessionAPPLET_NONE;
+
+/** identity cache */
+static nfcsessionIdentity_t xSessionIdentity;
+
+/** statistics */
+static nfcsessionStats_t xSessionStats;
+
+/**
+ * @brief Returns the timing slot of a command, claiming a free slot on
+ * first use.
+ *
+ * @param ucApdu command byte.
+ *
+ * @return slot, or NULL when all slots are in use.
+ */
+static nfcsessionApduStats_t *prvNfcSessionSlot( uint8_t ucApdu );
+
+/**
+ * @brief Selects the master applet, counted as a SELECT.
+ *
+ * @return PH_NFCLIB_STATUS_SUCCESS on success, error code otherwise.
+ */
+static uint32_t prvNfcSessionSelectMaster( void );
+
+/*----------------------------------------------------------------------------*/
+
+static nfcsessionApduStats_t *prvNfcSessionSlot( uint8_t ucApdu )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < nfcsessionAPDU_SLOTS; ulIndex++ )
+    {
+	if( xSessionStats.xApdu[ulIndex].ucApdu == ucApdu )
+	{
+	    return &xSessionStats.xApdu[ulIndex];
+	}
+	if( xSessionStats.xApdu[ulIndex].ucApdu == 0 )
+	{
+	    xSessionStats.xApdu[ulIndex].ucApdu = ucApdu;
+	    return &xSessionStats.xApdu[ulIndex];
+	}
+    }
+    return NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+static uint32_t prvNfcSessionSelectMaster( void )
+{
+    uint32_t ulStatus;
+
+    xSessionStats.ulSelectsSent++;
+    ulStatus = ulNfcCmdSelectMasterApplet();
+    if( ulStatus == PH_NFCLIB_STATUS_SUCCESS )
+    {
+	ucSessionApplet = nfcsessionAPPLET_MASTER;
+    }
+    return ulStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lNfcSessionInit( void )
+{
+    ucSessionUidLen = 0;
+    ucSessionApplet = nfcsessionAPPLET_NONE;
+    memset(&xSessionIdentity, 0, sizeof(xSessionIdentity));
+    memset(&xSessionStats, 0, sizeof(xSessionStats));
+
+    /* APDU timing uses the shared free running timestamp */
+    return lTimerTimestampInit();
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcSessionActivated( void )
+{
+    void *pvPal;
+
+    ucSessionApplet = nfcsessionAPPLET_NONE;
+    ucSessionUidLen = 0;
+
+    /* only type A peers have a UID; others are never cached */
+    pvPal = phNfcLib_GetDataParams(PH_COMP_PAL_ISO14443P3A);
+    if( pvPal == NULL )
+    {
+	return;
+    }
+    if( phpalI14443p3a_GetSerialNo(pvPal, ucSessionUid, &ucSessionUidLen)
+	    != PH_ERR_SUCCESS )
+    {
+	ucSessionUidLen = 0;
+    }
+    else if( ucSessionUidLen > nfcsessionUID_MAX_LEN )
+    {
+	ucSessionUidLen = 0;
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcSessionReleased( void )
+{
+    ucSessionApplet = nfcsessionAPPLET_NONE;
+    ucSessionUidLen = 0;
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcSessionInvalidate( void )
+{
+    memset(&xSessionIdentity, 0, sizeof(xSessionIdentity));
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcSessionSelectUser( void )
+{
+    uint32_t ulStatus;
+
+    if( ucSessionApplet == nfcsessionAPPLET_USER )
+    {
+	xSessionStats.ulSelectsSkipped += 2;
+	return PH_NFCLIB_STATUS_SUCCESS;
+    }
+
+    /* SELECT by AID reaches the applet from any selection state */
+    xSessionStats.ulSelectsSent++;
+    ulStatus = ulNfcCmdSelectUserApplet();
+    if( ulStatus == PH_NFCLIB_STATUS_SUCCESS )
+    {
+	xSessionStats.ulSelectsSkipped++;
+	ucSessionApplet = nfcsessionAPPLET_USER;
+	return ulStatus;
+    }
+
+    /* keyfobs that only expose the user applet below the master one */
+    ulStatus = prvNfcSessionSelectMaster();
+    if( ulStatus != PH_NFCLIB_STATUS_SUCCESS )
+    {
+	return ulStatus;
+    }
+    xSessionStats.ulSelectsSent++;
+    ulStatus = ulNfcCmdSelectUserApplet();
+    if( ulStatus == PH_NFCLIB_STATUS_SUCCESS )
+    {
+	ucSessionApplet = nfcsessionAPPLET_USER;
+    }
+    return ulStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcSessionGetName( uint8_t *pucReadBuf, uint32_t *pulReadLen )
+{
+    uint32_t ulStatus;
+
+    if( ( pucReadBuf == NULL ) || ( pulReadLen == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    if( ( ucSessionUidLen != 0 ) &&
+	( xSessionIdentity.ucUidLen == ucSessionUidLen ) &&
+	( memcmp(xSessionIdentity.ucUid, ucSessionUid, ucSessionUidLen) == 0 ) &&
+	( ( xTaskGetTickCount() - xSessionIdentity.xStamp ) <
+		pdMS_TO_TICKS(nfcsessionWINDOW_MS) ) &&
+	( xSessionIdentity.ulNameLen <= *pulReadLen ) )
+    {
+	memcpy(pucReadBuf, xSessionIdentity.ucName, xSessionIdentity.ulNameLen);
+	*pulReadLen = xSessionIdentity.ulNameLen;
+	xSessionStats.ulNameHits++;
+	return PH_NFCLIB_STATUS_SUCCESS;
+    }
+
+    xSessionStats.ulNameMisses++;
+    ulStatus = ulNfcCmdGetName(pucReadBuf, pulReadLen);
+    if( ulStatus != PH_NFCLIB_STATUS_SUCCESS )
+    {
+	vNfcSessionInvalidate();
+	return ulStatus;
+    }
+    if( ( ucSessionUidLen != 0 ) && ( *pulReadLen <= nfcsessionNAME_MAX_LEN ) )
+    {
+	memcpy(xSessionIdentity.ucUid, ucSessionUid, ucSessionUidLen);
+	xSessionIdentity.ucUidLen = ucSessionUidLen;
+	memcpy(xSessionIdentity.ucName, pucReadBuf, *pulReadLen);
+	xSessionIdentity.ulNameLen = *pulReadLen;
+	xSessionIdentity.xStamp = xTaskGetTickCount();
+    }
+    else
+    {
+	vNfcSessionInvalidate();
+    }
+    return ulStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulNfcSessionTransmit( uint8_t ucApdu, phNfcLib_Transmit_t *pxInput,
+			       uint16_t usLen )
+{
+    nfcsessionApduStats_t *pxSlot;
+    uint32_t ulStart;
+    uint32_t ulTime;
+    uint32_t ulStatus;
+
+    ulStart = ulTimerTimestamp();
+    ulStatus = phNfcLib_Transmit(pxInput, usLen);
+    ulTime = ulTimerTimestamp() - ulStart;
+
+    taskENTER_CRITICAL();
+    pxSlot = prvNfcSessionSlot(ucApdu);
+    if( pxSlot != NULL )
+    {
+	pxSlot->ulCount++;
+	pxSlot->ulTotal += ulTime;
+	if( ulTime > pxSlot->ulMax )
+	{
+	    pxSlot->ulMax = ulTime;
+	}
+	if( ulStatus != PH_NFCLIB_STATUS_SUCCESS )
+	{
+	    pxSlot->ulErrors++;
+	}
+    }
+    taskEXIT_CRITICAL();
+    return ulStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcSessionGetStats( nfcsessionStats_t *pxStats )
+{
+    configASSERT(pxStats != NULL);
+
+    taskENTER_CRITICAL();
+    memcpy(pxStats, &xSessionStats, sizeof(xSessionStats));
+    taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+
+void vNfcSessionResetStats( void )
+{
+    taskENTER_CRITICAL();
+    memset(&xSessionStats, 0, sizeof(xSessionStats));
+    taskEXIT_CRITICAL();
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
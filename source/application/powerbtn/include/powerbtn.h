@@ -42,6 +42,30 @@
 #define powerbtnPWR_BTN_GIO	( gpioPWRBTIN )   /**< ORWL Power Button GIO */
 #define powerbtnGIO_GROUP	( MML_GPIO_DEV1 ) /**< Power btn GPIO group identifier */
 
+#define powerbtnDEBOUNCE_MS	( 20 )	 /**< Default contact bounce time */
+#define powerbtnDOUBLE_PRESS_MS	( 0 )	 /**< Default double press window, 0 disables */
+#define powerbtnREPEAT_DELAY_MS	( 500 )	 /**< Default hold time before the first repeat */
+#define powerbtnREPEAT_MS	( 150 )	 /**< Default repeat period while held */
+#define powerbtnLONG_PRESS_MS	( 4550 ) /**< Default hold time of a long press */
+
+/**
+ * @brief Timing of the press classification.
+ */
+typedef struct
+{
+    /** edges closer than this are contact bounce */
+    uint16_t usDebounceMs;
+    /** a second press within this time after a release makes a double
+     * press; 0 reports every release as a short press immediately */
+    uint16_t usDoublePressMs;
+    /** hold time before the first repeat to the pin entry */
+    uint16_t usRepeatDelayMs;
+    /** repeat period to the pin entry while held */
+    uint16_t usRepeatMs;
+    /** hold time of a long press */
+    uint32_t ulLongPressMs;
+} powerbtnTiming_t;
+
 /**
  * @brief This function configures the ORWL power button
  *
@@ -49,9 +73,22 @@
  */
 void vPowerbtnConfig( void );
 
+/**
+ * @brief This function changes the timing of the press classification
+ *
+ * @param pxTiming new timing
+ *
+ * @return void
+ */
+void vPowerbtnSetTiming( const powerbtnTiming_t *pxTiming );
+
 /**
  * @brief Power button handler task
  *
+ * Posts per press: pinentryKEY_PRESS when pressed and every repeat period
+ * while held, then one of eventsKEY_PRESS_SHORT, eventsKEY_PRESS_LONG or
+ * pinentryKEY_DOUBLE_PRESS.
+ *
  * @return void
  */
 void vPowerbtnTsk( void *pvArgs );
@@ -3,6 +3,11 @@
  *
  * @brief This file contains power button management functions.
  *
+ * Both edges of the button raise an interrupt, timestamped from the free
+ * running hardware timer. The task sleeps on the edge queue for the whole
+ * press and classifies it from the timestamps: short, long or double press,
+ * with repeats to the pin entry while the button is held.
+ *
  * @author ravikiran@design-shift.com
  *
  ============================================================================
@@ -34,25 +39,53 @@
 
 #include <FreeRTOS.h>
 #include <event_groups.h>
+#include <queue.h>
 #include <powerbtn.h>
 #include <debug.h>
 #include <usermode.h>
 #include <events.h>
 #include <pinentry.h>
+#include <orwl_timer.h>
+
+#define powerbtnEDGE_QUEUE_LEN		(8)	/**< Edges buffered for the task */
+#define powerbtnPRESSED			(MML_GPIO_OUT_LOGIC_ZERO) /**< Level of a pressed button */
+
+/**
+ * @brief Level change of the button.
+ */
+typedef struct
+{
+    /** level after the edge */
+    uint8_t ucLevel;
+    /** timestamp of the edge */
+    uint32_t ulStamp;
+} powerbtnEdge_t;
 
-#define powerbtnTASK_SLEEP_TIME		(150) 				/**< Task sleep time */
-#define powerbtnLONG_PRESS_TIME		(powerbtnTASK_SLEEP_TIME * 30 + 50) 	/**< Count to indicate >5sec press */
-#define powerbtnPRESS_DETECT		(1<<0) 				/**< power button press detect event */
+/** edges from the interrupt handler */
+static QueueHandle_t xPowerbtnEdgeQueue;
 
-/** internal event handle  */
-EventGroupHandle_t prvPowerBtnEventHandleInt;
+/** press classification timing */
+static powerbtnTiming_t xPowerbtnTiming = {
+    powerbtnDEBOUNCE_MS,
+    powerbtnDOUBLE_PRESS_MS,
+    powerbtnREPEAT_DELAY_MS,
+    powerbtnREPEAT_MS,
+    powerbtnLONG_PRESS_MS,
+};
 
 /**
- * @brief Power button press ISR handler
+ * @brief Power button edge ISR handler
  *
  * @return void
  */
-static void vPowerbtnISRPress( void );
+static void vPowerbtnISREdge( void );
+
+/**
+ * @brief This function arms the edge leaving the present level of the button
+ *
+ * @return level of the button
+ */
+static mml_gpio_pin_data_t prvPowerbtnArm( void );
 
 /**
  * @brief This function enables power btn press detection
@@ -62,37 +95,69 @@ static void vPowerbtnISRPress( void );
 static void prvPowerbtnEnable( void );
 
 /**
- * @brief This function disables power btn press detection
+ * @brief This function waits until the button has not changed for the
+ * debounce time
  *
- * @return void
+ * @return settled level of the button
+ */
+static mml_gpio_pin_data_t prvPowerbtnSettle( void );
+
+/**
+ * @brief This function converts a timestamp difference to milliseconds
+ *
+ * @param ulStamps timestamp difference
+ *
+ * @return milliseconds
+ */
+static uint32_t prvPowerbtnStampToMs( uint32_t ulStamps );
+
+/**
+ * @brief This function follows a press until the button is released. The pin
+ * entry gets repeats while the button is held and the user mode a long press
+ * once the hold time is reached.
+ *
+ * @param pxRes resource handle
+ * @param ulPress timestamp of the press
+ * @param pulRelease timestamp of the release
+ * @param xReportLong pdTRUE to report a long press
+ *
+ * @return pdTRUE if a long press was reported
+ */
+static BaseType_t prvPowerbtnHold( xSMAppResources_t *pxRes, uint32_t ulPress,
+	uint32_t *pulRelease, BaseType_t xReportLong );
+
+/**
+ * @brief This function waits for a press confirmed by the debounce
+ *
+ * @param xTicks longest wait
+ * @param pulPress timestamp of the press
+ *
+ * @return pdTRUE on a press, pdFALSE on timeout
  */
-static void prvPowerbtnDisable( void );
+static BaseType_t prvPowerbtnWaitPress( TickType_t xTicks,
+	uint32_t *pulPress );
+
+/*---------------------------------------------------------------------------*/
 
+static mml_gpio_pin_data_t prvPowerbtnArm( void )
+{
+    return ucIrqArmToggle(powerbtnGIO_GROUP, powerbtnPWR_BTN_GIO) ?
+	    MML_GPIO_OUT_LOGIC_ONE : MML_GPIO_OUT_LOGIC_ZERO;
+}
 /*---------------------------------------------------------------------------*/
 
-static void vPowerbtnISRPress( void )
+static void vPowerbtnISREdge( void )
 {
-    uint32_t xResult;
-    BaseType_t xHigherPriorityTaskWoken;
-
-    /* xHigherPriorityTaskWoken must be initialized to pdFALSE. */
-     xHigherPriorityTaskWoken = pdFALSE;
-
-     /* disable power button IRQ */
-     prvPowerbtnDisable();
-
-     /* post an event to POWER BTN handler thread */
-     xResult = xEventGroupSetBitsFromISR(prvPowerBtnEventHandleInt,
-	     powerbtnPRESS_DETECT,&xHigherPriorityTaskWoken );
-
-     if( xResult != pdFAIL )
-       {
-   	/* If xHigherPriorityTaskWoken is now set to pdTRUE then a context
-   	switch should be requested. The macro used is port specific and will
-   	be either portYIELD_FROM_ISR() or portEND_SWITCHING_ISR() - refer to
-   	the documentation page for the port being used. */
-   	portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
-       }
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    powerbtnEdge_t xEdge;
+
+    xEdge.ulStamp = ulTimerTimestamp();
+    xEdge.ucLevel = (uint8_t)prvPowerbtnArm();
+
+    /* A full queue drops the edge, the task reads the level after the
+     * debounce anyway */
+    xQueueSendFromISR(xPowerbtnEdgeQueue, &xEdge, &xHigherPriorityTaskWoken);
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 }
 /*---------------------------------------------------------------------------*/
 
@@ -101,34 +166,47 @@ void vPowerbtnConfig( void )
     mml_gpio_config_t xGpioConfig;
     uint32_t xResult = NO_ERROR;
 
-    prvPowerBtnEventHandleInt = xEventGroupCreate();
-    configASSERT(prvPowerBtnEventHandleInt != NULL);
+    xPowerbtnEdgeQueue = xQueueCreate(powerbtnEDGE_QUEUE_LEN,
+	    sizeof(powerbtnEdge_t));
+    configASSERT(xPowerbtnEdgeQueue != NULL);
+
+    xResult = lTimerTimestampInit();
 
     /* register GPIO and configure for interrupt */
     xGpioConfig.gpio_direction = MML_GPIO_DIR_IN;
     xGpioConfig.gpio_function = MML_GPIO_NORMAL_FUNCTION;
     xGpioConfig.gpio_pad_config = MML_GPIO_PAD_PULLUP;
-    xGpioConfig.gpio_intr_mode = MML_GPIO_INT_MODE_LEVEL_TRIGGERED;
-    xGpioConfig.gpio_intr_polarity = MML_GPIO_INT_POL_HIGH;
+    xGpioConfig.gpio_intr_mode = MML_GPIO_INT_MODE_EDGE_TRIGGERED;
+    xGpioConfig.gpio_intr_polarity = MML_GPIO_INT_POL_FALLING;
 
-    xResult = mml_gpio_set_config(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO, 1,
+    xResult |= mml_gpio_set_config(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO, 1,
 	    xGpioConfig);
 
-    /* configure the interrupt*/
+    /* configure the interrupt; the polarity is flipped on every edge */
     xResult |= lIrqClearInterrupt(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO);
     xResult |= lIrqSetup(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO,
-	    MML_GPIO_INT_MODE_LEVEL_TRIGGERED, MML_GPIO_INT_POL_HIGH,
-	    vPowerbtnISRPress);
+	    MML_GPIO_INT_MODE_EDGE_TRIGGERED, MML_GPIO_INT_POL_FALLING,
+	    vPowerbtnISREdge);
 
     configASSERT(xResult == NO_ERROR);
 }
 /*---------------------------------------------------------------------------*/
 
+void vPowerbtnSetTiming( const powerbtnTiming_t *pxTiming )
+{
+    configASSERT(pxTiming != NULL);
+    taskENTER_CRITICAL();
+    xPowerbtnTiming = *pxTiming;
+    taskEXIT_CRITICAL();
+}
+/*---------------------------------------------------------------------------*/
+
 static void prvPowerbtnEnable( void )
 {
     uint32_t xResult = NO_ERROR;
 
     /* configure the interrupt*/
+    prvPowerbtnArm();
     xResult = lIrqClearInterrupt(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO);
     xResult |= lIrqEnableInterrupt(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO);
 
@@ -136,127 +214,155 @@ static void prvPowerbtnEnable( void )
 }
 /*---------------------------------------------------------------------------*/
 
-static void prvPowerbtnDisable( void )
+static uint32_t prvPowerbtnStampToMs( uint32_t ulStamps )
 {
-    int32_t xResult = NO_ERROR;
+    return (uint32_t)(((uint64_t)ulStamps * 1000) / timerTIMESTAMP_HZ);
+}
+/*---------------------------------------------------------------------------*/
 
-    xResult = lIrqDisable(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO);
-    xResult |= lIrqClearInterrupt(MML_GPIO_DEV1, powerbtnPWR_BTN_GIO);
+static mml_gpio_pin_data_t prvPowerbtnSettle( void )
+{
+    powerbtnEdge_t xEdge;
+    mml_gpio_pin_data_t xLevel = MML_GPIO_OUT_LOGIC_ONE;
 
-    configASSERT(xResult == NO_ERROR);
+    /* Every bounce restarts the debounce time */
+    while (xQueueReceive(xPowerbtnEdgeQueue, &xEdge,
+	    pdMS_TO_TICKS(xPowerbtnTiming.usDebounceMs) + 1) == pdTRUE);
+
+    mml_gpio_pin_input(powerbtnGIO_GROUP, powerbtnPWR_BTN_GIO, &xLevel);
+    return xLevel;
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvPowerbtnWaitPress( TickType_t xTicks,
+	uint32_t *pulPress )
+{
+    powerbtnEdge_t xEdge;
+
+    while (xQueueReceive(xPowerbtnEdgeQueue, &xEdge, xTicks) == pdTRUE)
+    {
+	if (xEdge.ucLevel != powerbtnPRESSED)
+	{
+	    continue;
+	}
+	*pulPress = xEdge.ulStamp;
+	if (prvPowerbtnSettle() == powerbtnPRESSED)
+	{
+	    return pdTRUE;
+	}
+	/* glitch, keep waiting within the same window */
+    }
+    return pdFALSE;
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvPowerbtnHold( xSMAppResources_t *pxRes, uint32_t ulPress,
+	uint32_t *pulRelease, BaseType_t xReportLong )
+{
+    powerbtnEdge_t xEdge;
+    uint32_t ulRepeatAt = xPowerbtnTiming.usRepeatDelayMs;
+    uint32_t ulNext;
+    uint32_t ulHeld;
+    BaseType_t xLong = pdFALSE;
+
+    while (1)
+    {
+	/* Sleep until the release or the next hold event */
+	ulHeld = prvPowerbtnStampToMs(ulTimerTimestamp() - ulPress);
+	ulNext = ulRepeatAt;
+	if ((xReportLong == pdTRUE) && (xLong == pdFALSE) &&
+		(xPowerbtnTiming.ulLongPressMs < ulNext))
+	{
+	    ulNext = xPowerbtnTiming.ulLongPressMs;
+	}
+	ulNext = (ulNext > ulHeld) ? (ulNext - ulHeld) : 0;
+
+	if (xQueueReceive(xPowerbtnEdgeQueue, &xEdge,
+		pdMS_TO_TICKS(ulNext) + 1) == pdTRUE)
+	{
+	    if (xEdge.ucLevel != powerbtnPRESSED)
+	    {
+		*pulRelease = xEdge.ulStamp;
+		if (prvPowerbtnSettle() != powerbtnPRESSED)
+		{
+		    return xLong;
+		}
+	    }
+	    continue;
+	}
+
+	ulHeld = prvPowerbtnStampToMs(ulTimerTimestamp() - ulPress);
+	if ((xReportLong == pdTRUE) && (xLong == pdFALSE) &&
+		(ulHeld >= xPowerbtnTiming.ulLongPressMs))
+	{
+	    /* still holding post long press event */
+	    xEventGroupSetBits( pxRes->xEventGroupUserModeApp,
+		    eventsKEY_PRESS_LONG );
+	    xLong = pdTRUE;
+	}
+	if (ulHeld >= ulRepeatAt)
+	{
+	    /* Send event for pin entry Task */
+	    xEventGroupSetBits( pxRes->xEventGroupPinEntry, pinentryKEY_PRESS );
+	    ulRepeatAt += xPowerbtnTiming.usRepeatMs;
+	}
+    }
 }
 /*---------------------------------------------------------------------------*/
 
 void vPowerbtnTsk( void *pvArgs )
 {
-    uint32_t ulHoldTime = 0 ;
-    uint32_t ulIsBtnReleased = pdFALSE ;
-    EventBits_t xBits = 0;
-    mml_gpio_pin_data_t xInBuf;
+    uint32_t ulPress = 0;
+    uint32_t ulRelease = 0;
     xSMAppResources_t *xpResHandle;
 
     configASSERT(pvArgs != NULL);
 
     xpResHandle = (xSMAppResources_t *)pvArgs;
 
+    /* Configure Interrupt */
+    prvPowerbtnEnable();
+
     do
     {
-	/* Configure Interrupt */
-	prvPowerbtnEnable();
-
-	/* wait for event */
-	xBits = xEventGroupWaitBits(prvPowerBtnEventHandleInt,
-		powerbtnPRESS_DETECT, pdTRUE, pdFALSE, portMAX_DELAY);
-	if((xBits & powerbtnPRESS_DETECT) != powerbtnPRESS_DETECT)
+	/* Sleep until the button is pressed */
+	if (prvPowerbtnWaitPress(portMAX_DELAY, &ulPress) != pdTRUE)
 	{
 	    /* should happen only on portMAX_DELAY timeout !*/
 	    continue;
 	}
-	while(1)
+	/* Send event for pin entry Task */
+	xEventGroupSetBits( xpResHandle->xEventGroupPinEntry, pinentryKEY_PRESS );
+
+	ulRelease = ulPress;
+	if (prvPowerbtnHold(xpResHandle, ulPress, &ulRelease, pdTRUE) == pdTRUE)
 	{
-	    /* Read GIO
-	     * GIO HIGH: Button released
-	     * GIO LOW:  Button still pressed
-	     */
-
-	    /* button press detected */
-	    /* READ GIO & get value */
-	    if (mml_gpio_pin_input(powerbtnGIO_GROUP, powerbtnPWR_BTN_GIO,
-		    &xInBuf) == NO_ERROR)
-	    {
-		/* MML_GPIO_OUT_LOGIC_ONE:  BTN released
-		 * MML_GPIO_OUT_LOGIC_ZERO: BTN pressed
-		 */
-		if (xInBuf == MML_GPIO_OUT_LOGIC_ONE)
-		{
-		    /* check hold time */
-		    if(ulHoldTime >= powerbtnLONG_PRESS_TIME)
-		    {
-			/* post long press event */
-			ulHoldTime = 0;
-			xEventGroupSetBits( xpResHandle->xEventGroupUserModeApp, eventsKEY_PRESS_LONG );
-			break;
-		    }
-		    else
-		    {
-			if (ulHoldTime == 0)
-			{
-			    /*Send event for pin entry Task */
-			   xEventGroupSetBits( xpResHandle->xEventGroupPinEntry,
-				   pinentryKEY_PRESS );
-			}
-			/* post short press event */
-			ulHoldTime = 0 ;
-			xEventGroupSetBits( xpResHandle->xEventGroupUserModeApp, eventsKEY_PRESS_SHORT );
-			break;
-		    }
-		}
-		else
-		{
-		    /* Send event for pin entry Task */
-		    xEventGroupSetBits( xpResHandle->xEventGroupPinEntry,
-			    pinentryKEY_PRESS );
-		    if(ulHoldTime >= powerbtnLONG_PRESS_TIME)
-		    {
-			ulHoldTime = 0;
-			/* still holding post long press event */
-			xEventGroupSetBits( xpResHandle->xEventGroupUserModeApp, eventsKEY_PRESS_LONG );
-			/* don't break till released */
-			ulIsBtnReleased = pdFALSE;
-			while(ulIsBtnReleased == pdFALSE)
-			{
-			    /* Send event for pin entry Task */
-			    xEventGroupSetBits( xpResHandle->xEventGroupPinEntry, pinentryKEY_PRESS );
-			    if (mml_gpio_pin_input(powerbtnGIO_GROUP,
-				    powerbtnPWR_BTN_GIO, &xInBuf) == NO_ERROR)
-			    {
-				if(xInBuf == MML_GPIO_OUT_LOGIC_ONE)
-				{
-				    /* button released */
-				    ulIsBtnReleased = pdTRUE;
-				}
-				vTaskDelay(powerbtnTASK_SLEEP_TIME);
-			    }
-			    else
-			    {
-				//should never happen. But now assuming key released !
-				break;
-			    }
-			}
-			/* Break inner while loop */
-			break;
-		    }
-		    ulHoldTime += powerbtnTASK_SLEEP_TIME;
-		    vTaskDelay(powerbtnTASK_SLEEP_TIME);
-		}
-	    }
-	    else
-	    {
-		/* it should never happen */
-		debugERROR_PRINT("Failed to READ GIO !!");
-		break;
-	    }
+	    /* long press already posted */
+	    continue;
+	}
+	if (prvPowerbtnStampToMs(ulRelease - ulPress) >=
+		xPowerbtnTiming.ulLongPressMs)
+	{
+	    /* released just as the hold time was reached */
+	    xEventGroupSetBits( xpResHandle->xEventGroupUserModeApp,
+		    eventsKEY_PRESS_LONG );
+	    continue;
+	}
+
+	/* A second press within the window makes a double press */
+	if ((xPowerbtnTiming.usDoublePressMs != 0) &&
+		(prvPowerbtnWaitPress(
+		pdMS_TO_TICKS(xPowerbtnTiming.usDoublePressMs), &ulPress) == pdTRUE))
+	{
+	    xEventGroupSetBits( xpResHandle->xEventGroupPinEntry,
+		    pinentryKEY_PRESS | pinentryKEY_DOUBLE_PRESS );
+	    prvPowerbtnHold(xpResHandle, ulPress, &ulRelease, pdFALSE);
+	    continue;
 	}
+
+	/* post short press event */
+	xEventGroupSetBits( xpResHandle->xEventGroupUserModeApp,
+		eventsKEY_PRESS_SHORT );
 	/* continue to block on keypress event */
     }while(1);
 }
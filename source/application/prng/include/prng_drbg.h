@@ -0,0 +1,139 @@
+ /**===========================================================================
+ * @file prng_drbg.h
+ *
+ * @brief This file contains the SP 800-90A HMAC_DRBG (SHA-256). Each task may
+ * own a context, a shared instance seeded from the TRNG pool serves the rest.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef _PRNG_DRBG_H_
+#define _PRNG_DRBG_H_
+
+#include <stdint.h>
+
+#define prngdrbgOUTLEN			(32)		/**< HMAC-SHA-256 output and state length */
+#define prngdrbgENTROPY_LEN		(32)		/**< entropy input per (re)seed, 256 bit strength */
+#define prngdrbgNONCE_LEN		(16)		/**< nonce taken with the instantiate entropy */
+#define prngdrbgMAX_INPUT		(32)		/**< longest personalization or additional input */
+#define prngdrbgMAX_REQUEST		(65536)		/**< longest generate request, 2^19 bits */
+#define prngdrbgRESEED_INTERVAL		(0x10000)	/**< generate requests between reseeds */
+
+#define prngdrbgFLAG_PREDICTION_RES	(0x01)		/**< reseed from the TRNG before every generate */
+
+/**
+ * @brief DRBG instance. Callers own the storage; an instance is only ever
+ * used by one task at a time.
+ */
+typedef struct
+{
+    /** HMAC key K */
+    uint8_t ucKey[prngdrbgOUTLEN];
+    /** chaining value V */
+    uint8_t ucV[prngdrbgOUTLEN];
+    /** generate requests since the last (re)seed */
+    uint32_t ulReseedCounter;
+    /** prngdrbgFLAG_ options given at instantiation */
+    uint32_t ulFlags;
+    /** set while the instance may generate */
+    uint32_t ulInstantiated;
+} prngDrbgCtx_t;
+
+/**
+ * @brief This function instantiates a DRBG with entropy and a nonce from the
+ * TRNG pool.
+ *
+ * @param pxCtx instance to set up.
+ * @param pucPers personalization string, may be NULL.
+ * @param ulPersLen personalization string length, up to prngdrbgMAX_INPUT.
+ * @param ulFlags prngdrbgFLAG_ options.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lPrngDrbgInstantiate( prngDrbgCtx_t *pxCtx, const uint8_t *pucPers,
+			      uint32_t ulPersLen, uint32_t ulFlags );
+
+/**
+ * @brief This function reseeds a DRBG with fresh entropy from the TRNG pool.
+ *
+ * @param pxCtx instantiated DRBG.
+ * @param pucAdd additional input, may be NULL.
+ * @param ulAddLen additional input length, up to prngdrbgMAX_INPUT.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lPrngDrbgReseed( prngDrbgCtx_t *pxCtx, const uint8_t *pucAdd,
+			 uint32_t ulAddLen );
+
+/**
+ * @brief This function generates random bytes. The DRBG reseeds itself once
+ * prngdrbgRESEED_INTERVAL requests have been served, and before every
+ * request when prediction resistance is asked for here or at instantiation.
+ *
+ * @param pxCtx instantiated DRBG.
+ * @param pucOut buffer to fill.
+ * @param ulLen bytes requested, up to prngdrbgMAX_REQUEST.
+ * @param pucAdd additional input, may be NULL.
+ * @param ulAddLen additional input length, up to prngdrbgMAX_INPUT.
+ * @param ulPredRes non zero to reseed before this request.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lPrngDrbgGenerate( prngDrbgCtx_t *pxCtx, uint8_t *pucOut,
+			   uint32_t ulLen, const uint8_t *pucAdd,
+			   uint32_t ulAddLen, uint32_t ulPredRes );
+
+/**
+ * @brief This function wipes a DRBG instance.
+ *
+ * @param pxCtx instance to wipe.
+ *
+ * @return void
+ */
+void vPrngDrbgUninstantiate( prngDrbgCtx_t *pxCtx );
+
+/**
+ * @brief This function runs the known answer test and instantiates the
+ * shared DRBG. Called once at boot, after the TRNG pool is up.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lPrngDrbgInit( void );
+
+/**
+ * @brief This function fills the buffer from the shared DRBG. Requests from
+ * several tasks are serialised.
+ *
+ * @param pucOut buffer to fill.
+ * @param ulLen number of bytes requested.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lPrngDrbgRandom( uint8_t *pucOut, uint32_t ulLen );
+
+#endif /* _PRNG_DRBG_H_ */
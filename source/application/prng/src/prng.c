@@ -34,17 +34,24 @@
  */
 
 #include <cyassl/ctaocrypt/settings.h>
-#include <cyassl/ctaocrypt/random.h>
 #include <cyassl/ctaocrypt/arc4.h>
 #include <debug.h>
 #include <prng.h>
 #include <errors.h>
+#include <string.h>
 #define prngSEEDMAXSIZE    (32)             /**< Seed maximum size */
+#define prngDROPSIZE       (256)            /**< keystream bytes dropped after
+						 keying, as InitRng() did */
 
 /* Global variables */
 uint8_t ucSeed[ prngSEEDMAXSIZE ] = {0};    /* To store the current seed
 					       given by the user*/
-RNG xRng;			    /* random number generator instance */
+/* The BLE broadcast data is the keystream of the seed the keyfob holds, so
+ * it has to stay ARC4 keyed with the seed exactly as InitRng() keyed it.
+ * The state after the drop is kept so the same seed is not rescheduled. */
+static Arc4 xArc4Base;		    /* keystream state for ucSeed, after drop */
+static Arc4 xArc4;		    /* keystream state in use */
+static uint32_t ulArc4Keyed = 0;    /* set once xArc4Base matches ucSeed */
 
 uint8_t ucPrngGetSeedByte(uint32_t ulCount)
 {
@@ -59,7 +66,8 @@ uint8_t ucPrngGetSeedByte(uint32_t ulCount)
 
 int32_t lPrngReadSeed(uint8_t* pucSeed, size_t xSize)
 {
-    uint32_t ulRet;
+    uint8_t ucDrop[prngDROPSIZE];
+
     if( xSize > prngSEEDMAXSIZE )
     {
 	debugERROR_PRINT("\nseed cannot be greater than 32 bytes\n");
@@ -72,39 +80,43 @@ int32_t lPrngReadSeed(uint8_t* pucSeed, size_t xSize)
 	return COMMON_ERR_NULL_PTR;
     }
 
+    /* Same seed as the current one: restart its keystream */
+    if( ulArc4Keyed && ( memcmp(ucSeed, pucSeed, xSize) == 0 ) )
+    {
+	memcpy(&xArc4, &xArc4Base, sizeof(xArc4));
+	return NO_ERROR;
+    }
+
     /* copy the seed given by user into the ucseed array */
     memcpy(ucSeed, pucSeed, xSize);
 
-    /* If there is a current instance in use, remove it */
-    memset(&xRng, 0, sizeof(xRng));
-
-/* Initialize the RNG module. Seed will be passed internally to the module */
-    ulRet = InitRng(&xRng);
-    if (ulRet != NO_ERROR)
-    {
-        debugERROR_PRINT("\nunable to do init\n");
-        return COMMON_ERR_NOT_INITIALIZED;
-    }
+    /* Key with the whole seed array and drop the start of the keystream */
+    Arc4SetKey(&xArc4Base, ucSeed, prngSEEDMAXSIZE);
+    memset(ucDrop, 0, sizeof(ucDrop));
+    Arc4Process(&xArc4Base, ucDrop, ucDrop, sizeof(ucDrop));
+    memset(ucDrop, 0, sizeof(ucDrop));
+    memcpy(&xArc4, &xArc4Base, sizeof(xArc4));
+    ulArc4Keyed = 1;
     return NO_ERROR;
 }
 /*-----------------------------------------------------------------------------*/
 
 int32_t lPrngGenerateRandom(uint8_t* pucBlock, size_t xSize)
 {
-    uint32_t ulRet;
-
     if(pucBlock == NULL)
     {
 	debugERROR_PRINT("\nNULL pointer given as argument\n");
 	return COMMON_ERR_NULL_PTR;
     }
 
-    ulRet = RNG_GenerateBlock(&xRng, pucBlock, xSize);
-    if (ulRet != NO_ERROR)
+    if(!ulArc4Keyed)
     {
-	debugERROR_PRINT("\nunable to do generate random number\n");
-	return COMMON_ERR_UNKNOWN;
+	debugERROR_PRINT("\nno seed given\n");
+	return COMMON_ERR_NOT_INITIALIZED;
     }
+
+    memset(pucBlock, 0, xSize);
+    Arc4Process(&xArc4, pucBlock, pucBlock, xSize);
     return NO_ERROR;
 }
 
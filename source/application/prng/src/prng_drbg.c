@@ -0,0 +1,475 @@
+ /**===========================================================================
+ * @file prng_drbg.c
+ *
+ * @brief This file contains the SP 800-90A HMAC_DRBG (SHA-256) seeded from the
+ * TRNG pool, and the shared instance behind lPrngDrbgRandom().
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <string.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Local includes */
+#include <errors.h>
+#include <trng_pool.h>
+#include <prng_drbg.h>
+#include <ucl/ucl_defs.h>
+#include <ucl/ucl_hmac_sha256.h>
+
+/* debug and log message header */
+#include <debug.h>
+
+/** longest seed material, entropy, nonce and personalization */
+#define prngdrbgMAX_SEED	( prngdrbgENTROPY_LEN + prngdrbgNONCE_LEN + \
+				  prngdrbgMAX_INPUT )
+/** known answer test output length */
+#define prngdrbgKAT_LEN		(128)
+
+/** shared instance behind lPrngDrbgRandom() */
+static prngDrbgCtx_t xPrngDrbgShared;
+/** serialises the users of xPrngDrbgShared */
+static SemaphoreHandle_t xPrngDrbgMutex = NULL;
+
+/** NIST CAVP HMAC_DRBG SHA-256 vector, entropy input followed by nonce */
+static const uint8_t ucPrngDrbgKatSeed[prngdrbgENTROPY_LEN +
+				       prngdrbgNONCE_LEN] = {
+    0xca, 0x85, 0x19, 0x11, 0x34, 0x93, 0x84, 0xbf,
+    0xfe, 0x89, 0xde, 0x1c, 0xbd, 0xc4, 0x6e, 0x68,
+    0x31, 0xe4, 0x4d, 0x34, 0xa4, 0xfb, 0x93, 0x5e,
+    0xe2, 0x85, 0xdd, 0x14, 0xb7, 0x1a, 0x74, 0x88,
+    0x65, 0x9b, 0xa9, 0x6c, 0x60, 0x1d, 0xc6, 0x9f,
+    0xc9, 0x02, 0x94, 0x08, 0x05, 0xec, 0x0c, 0xa8
+};
+
+/** returned bits of the second generate call of the vector */
+static const uint8_t ucPrngDrbgKatOut[prngdrbgKAT_LEN] = {
+    0xe5, 0x28, 0xe9, 0xab, 0xf2, 0xde, 0xce, 0x54,
+    0xd4, 0x7c, 0x7e, 0x75, 0xe5, 0xfe, 0x30, 0x21,
+    0x49, 0xf8, 0x17, 0xea, 0x9f, 0xb4, 0xbe, 0xe6,
+    0xf4, 0x19, 0x96, 0x97, 0xd0, 0x4d, 0x5b, 0x89,
+    0xd5, 0x4f, 0xbb, 0x97, 0x8a, 0x15, 0xb5, 0xc4,
+    0x43, 0xc9, 0xec, 0x21, 0x03, 0x6d, 0x24, 0x60,
+    0xb6, 0xf7, 0x3e, 0xba, 0xd0, 0xdc, 0x2a, 0xba,
+    0x6e, 0x62, 0x4a, 0xbf, 0x07, 0x74, 0x5b, 0xc1,
+    0x07, 0x69, 0x4b, 0xb7, 0x54, 0x7b, 0xb0, 0x99,
+    0x5f, 0x70, 0xde, 0x25, 0xd6, 0xb2, 0x9e, 0x2d,
+    0x30, 0x11, 0xbb, 0x19, 0xd2, 0x76, 0x76, 0xc0,
+    0x71, 0x62, 0xc8, 0xb5, 0xcc, 0xde, 0x06, 0x68,
+    0x96, 0x1d, 0xf8, 0x68, 0x03, 0x48, 0x2c, 0xb3,
+    0x7e, 0xd6, 0xd5, 0xc0, 0xbb, 0x8d, 0x50, 0xcf,
+    0x1f, 0x50, 0xd4, 0x76, 0xaa, 0x04, 0x58, 0xbd,
+    0xab, 0xa8, 0x06, 0xf4, 0x8b, 0xe9, 0xdc, 0xb8
+};
+
+/**
+ * @brief Computes HMAC-SHA-256 with the instance key over V, an optional
+ * separator byte and the provided data.
+ *
+ * @param pxCtx DRBG instance giving the key and V.
+ * @param lSep separator byte or -1 for none.
+ * @param pucData provided data, may be NULL.
+ * @param ulLen provided data length, up to prngdrbgMAX_SEED.
+ * @param pucMac filled with prngdrbgOUTLEN bytes.
+ *
+ * @return NO_ERROR on success or error code
+ */
+static int32_t prvPrngDrbgHmac( prngDrbgCtx_t *pxCtx, int32_t lSep,
+				const uint8_t *pucData, uint32_t ulLen,
+				uint8_t *pucMac );
+
+/**
+ * @brief HMAC_DRBG update function, SP 800-90A 10.1.2.2.
+ *
+ * @param pxCtx DRBG instance.
+ * @param pucData provided data, may be NULL.
+ * @param ulLen provided data length, up to prngdrbgMAX_SEED.
+ *
+ * @return NO_ERROR on success or error code
+ */
+static int32_t prvPrngDrbgUpdate( prngDrbgCtx_t *pxCtx, const uint8_t *pucData,
+				  uint32_t ulLen );
+
+/**
+ * @brief Sets the initial state from the seed material.
+ *
+ * @param pxCtx DRBG instance.
+ * @param pucSeed seed material.
+ * @param ulLen seed material length, up to prngdrbgMAX_SEED.
+ *
+ * @return NO_ERROR on success or error code
+ */
+static int32_t prvPrngDrbgSeed( prngDrbgCtx_t *pxCtx, const uint8_t *pucSeed,
+				uint32_t ulLen );
+
+/**
+ * @brief Generates without the reseed checks. The additional input, if any,
+ * is mixed in before and after the output.
+ *
+ * @param pxCtx DRBG instance.
+ * @param pucOut buffer to fill.
+ * @param ulLen bytes requested.
+ * @param pucAdd additional input, may be NULL.
+ * @param ulAddLen additional input length.
+ *
+ * @return NO_ERROR on success or error code
+ */
+static int32_t prvPrngDrbgOutput( prngDrbgCtx_t *pxCtx, uint8_t *pucOut,
+				  uint32_t ulLen, const uint8_t *pucAdd,
+				  uint32_t ulAddLen );
+
+/**
+ * @brief Instantiate and generate known answer test.
+ *
+ * @return NO_ERROR if the output matched or COMMON_ERR_BAD_STATE
+ */
+static int32_t prvPrngDrbgKat( void );
+
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvPrngDrbgHmac( prngDrbgCtx_t *pxCtx, int32_t lSep,
+				const uint8_t *pucData, uint32_t ulLen,
+				uint8_t *pucMac )
+{
+    uint8_t ucMsg[prngdrbgOUTLEN + 1 + prngdrbgMAX_SEED];
+    uint32_t ulMsgLen = prngdrbgOUTLEN;
+    int32_t lStatus;
+
+    memcpy(ucMsg, pxCtx->ucV, prngdrbgOUTLEN);
+    if( lSep >= 0 )
+    {
+	ucMsg[ulMsgLen++] = (uint8_t) lSep;
+    }
+    if( ulLen )
+    {
+	memcpy(&ucMsg[ulMsgLen], pucData, ulLen);
+	ulMsgLen += ulLen;
+    }
+    lStatus = ucl_hmac_sha256(pucMac, prngdrbgOUTLEN, ucMsg, ulMsgLen,
+			      pxCtx->ucKey, prngdrbgOUTLEN);
+    memset(ucMsg, 0, sizeof(ucMsg));
+    return ( lStatus == UCL_OK ) ? NO_ERROR : COMMON_ERR_UNKNOWN;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvPrngDrbgUpdate( prngDrbgCtx_t *pxCtx, const uint8_t *pucData,
+				  uint32_t ulLen )
+{
+    uint8_t ucMac[prngdrbgOUTLEN];
+    int32_t lSep;
+
+    for( lSep = 0; lSep < 2; lSep++ )
+    {
+	/* K = HMAC(K, V || sep || data), V = HMAC(K, V) */
+	if( prvPrngDrbgHmac(pxCtx, lSep, pucData, ulLen, ucMac) != NO_ERROR )
+	{
+	    return COMMON_ERR_UNKNOWN;
+	}
+	memcpy(pxCtx->ucKey, ucMac, prngdrbgOUTLEN);
+	if( prvPrngDrbgHmac(pxCtx, -1, NULL, 0, ucMac) != NO_ERROR )
+	{
+	    return COMMON_ERR_UNKNOWN;
+	}
+	memcpy(pxCtx->ucV, ucMac, prngdrbgOUTLEN);
+
+	/* the second round only runs with provided data */
+	if( ulLen == 0 )
+	{
+	    break;
+	}
+    }
+    memset(ucMac, 0, sizeof(ucMac));
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvPrngDrbgSeed( prngDrbgCtx_t *pxCtx, const uint8_t *pucSeed,
+				uint32_t ulLen )
+{
+    memset(pxCtx->ucKey, 0x00, prngdrbgOUTLEN);
+    memset(pxCtx->ucV, 0x01, prngdrbgOUTLEN);
+    if( prvPrngDrbgUpdate(pxCtx, pucSeed, ulLen) != NO_ERROR )
+    {
+	vPrngDrbgUninstantiate(pxCtx);
+	return COMMON_ERR_UNKNOWN;
+    }
+    pxCtx->ulReseedCounter = 1;
+    pxCtx->ulInstantiated = pdTRUE;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvPrngDrbgOutput( prngDrbgCtx_t *pxCtx, uint8_t *pucOut,
+				  uint32_t ulLen, const uint8_t *pucAdd,
+				  uint32_t ulAddLen )
+{
+    uint8_t ucMac[prngdrbgOUTLEN];
+    uint32_t ulChunk;
+
+    if( ulAddLen && ( prvPrngDrbgUpdate(pxCtx, pucAdd, ulAddLen) != NO_ERROR ) )
+    {
+	return COMMON_ERR_UNKNOWN;
+    }
+    while( ulLen )
+    {
+	/* V = HMAC(K, V) is the next output block */
+	if( prvPrngDrbgHmac(pxCtx, -1, NULL, 0, ucMac) != NO_ERROR )
+	{
+	    memset(ucMac, 0, sizeof(ucMac));
+	    return COMMON_ERR_UNKNOWN;
+	}
+	memcpy(pxCtx->ucV, ucMac, prngdrbgOUTLEN);
+	ulChunk = ( ulLen < prngdrbgOUTLEN ) ? ulLen : prngdrbgOUTLEN;
+	memcpy(pucOut, ucMac, ulChunk);
+	pucOut += ulChunk;
+	ulLen -= ulChunk;
+    }
+    memset(ucMac, 0, sizeof(ucMac));
+    if( prvPrngDrbgUpdate(pxCtx, pucAdd, ulAddLen) != NO_ERROR )
+    {
+	return COMMON_ERR_UNKNOWN;
+    }
+    pxCtx->ulReseedCounter++;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvPrngDrbgKat( void )
+{
+    prngDrbgCtx_t xCtx;
+    uint8_t ucOut[prngdrbgKAT_LEN];
+    int32_t lResult = COMMON_ERR_BAD_STATE;
+
+    if( ( prvPrngDrbgSeed(&xCtx, ucPrngDrbgKatSeed,
+			  sizeof(ucPrngDrbgKatSeed)) == NO_ERROR ) &&
+	( prvPrngDrbgOutput(&xCtx, ucOut, sizeof(ucOut), NULL, 0) == NO_ERROR ) &&
+	( prvPrngDrbgOutput(&xCtx, ucOut, sizeof(ucOut), NULL, 0) == NO_ERROR ) &&
+	( memcmp(ucOut, ucPrngDrbgKatOut, sizeof(ucOut)) == 0 ) )
+    {
+	lResult = NO_ERROR;
+    }
+    vPrngDrbgUninstantiate(&xCtx);
+    memset(ucOut, 0, sizeof(ucOut));
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lPrngDrbgInstantiate( prngDrbgCtx_t *pxCtx, const uint8_t *pucPers,
+			      uint32_t ulPersLen, uint32_t ulFlags )
+{
+    uint8_t ucSeed[prngdrbgMAX_SEED];
+    int32_t lStatus;
+
+    if( pxCtx == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( ( ulPersLen > prngdrbgMAX_INPUT ) ||
+	( ( pucPers == NULL ) && ulPersLen ) )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    vPrngDrbgUninstantiate(pxCtx);
+
+    /* seed material is entropy || nonce || personalization string */
+    lStatus = lTrngPoolGet(ucSeed, prngdrbgENTROPY_LEN + prngdrbgNONCE_LEN);
+    if( lStatus == NO_ERROR )
+    {
+	if( ulPersLen )
+	{
+	    memcpy(&ucSeed[prngdrbgENTROPY_LEN + prngdrbgNONCE_LEN], pucPers,
+		   ulPersLen);
+	}
+	lStatus = prvPrngDrbgSeed(pxCtx, ucSeed, prngdrbgENTROPY_LEN +
+				  prngdrbgNONCE_LEN + ulPersLen);
+	pxCtx->ulFlags = ulFlags;
+    }
+    memset(ucSeed, 0, sizeof(ucSeed));
+    return lStatus;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lPrngDrbgReseed( prngDrbgCtx_t *pxCtx, const uint8_t *pucAdd,
+			 uint32_t ulAddLen )
+{
+    uint8_t ucSeed[prngdrbgENTROPY_LEN + prngdrbgMAX_INPUT];
+    int32_t lStatus;
+
+    if( pxCtx == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( ( ulAddLen > prngdrbgMAX_INPUT ) || ( ( pucAdd == NULL ) && ulAddLen ) )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    if( !pxCtx->ulInstantiated )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    /* seed material is entropy || additional input */
+    lStatus = lTrngPoolGet(ucSeed, prngdrbgENTROPY_LEN);
+    if( lStatus == NO_ERROR )
+    {
+	if( ulAddLen )
+	{
+	    memcpy(&ucSeed[prngdrbgENTROPY_LEN], pucAdd, ulAddLen);
+	}
+	lStatus = prvPrngDrbgUpdate(pxCtx, ucSeed, prngdrbgENTROPY_LEN + ulAddLen);
+	if( lStatus == NO_ERROR )
+	{
+	    pxCtx->ulReseedCounter = 1;
+	}
+	else
+	{
+	    vPrngDrbgUninstantiate(pxCtx);
+	}
+    }
+    memset(ucSeed, 0, sizeof(ucSeed));
+    return lStatus;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lPrngDrbgGenerate( prngDrbgCtx_t *pxCtx, uint8_t *pucOut,
+			   uint32_t ulLen, const uint8_t *pucAdd,
+			   uint32_t ulAddLen, uint32_t ulPredRes )
+{
+    int32_t lStatus;
+
+    if( ( pxCtx == NULL ) || ( pucOut == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( ( ulLen > prngdrbgMAX_REQUEST ) || ( ulAddLen > prngdrbgMAX_INPUT ) ||
+	( ( pucAdd == NULL ) && ulAddLen ) )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    if( !pxCtx->ulInstantiated )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    if( ulPredRes || ( pxCtx->ulFlags & prngdrbgFLAG_PREDICTION_RES ) ||
+	( pxCtx->ulReseedCounter > prngdrbgRESEED_INTERVAL ) )
+    {
+	/* the additional input goes into the reseed instead */
+	lStatus = lPrngDrbgReseed(pxCtx, pucAdd, ulAddLen);
+	if( lStatus != NO_ERROR )
+	{
+	    debugERROR_PRINT("DRBG reseed failed\n");
+	    return lStatus;
+	}
+	pucAdd = NULL;
+	ulAddLen = 0;
+    }
+
+    lStatus = prvPrngDrbgOutput(pxCtx, pucOut, ulLen, pucAdd, ulAddLen);
+    if( lStatus != NO_ERROR )
+    {
+	memset(pucOut, 0, ulLen);
+	vPrngDrbgUninstantiate(pxCtx);
+    }
+    return lStatus;
+}
+/*---------------------------------------------------------------------------*/
+
+void vPrngDrbgUninstantiate( prngDrbgCtx_t *pxCtx )
+{
+    if( pxCtx != NULL )
+    {
+	memset(pxCtx, 0, sizeof(*pxCtx));
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lPrngDrbgInit( void )
+{
+    static const uint8_t ucPers[] = "ORWL shared DRBG";
+    int32_t lStatus;
+
+    if( xPrngDrbgMutex != NULL )
+    {
+	return NO_ERROR;
+    }
+    if( prvPrngDrbgKat() != NO_ERROR )
+    {
+	debugERROR_PRINT("DRBG known answer test failed\n");
+	return COMMON_ERR_BAD_STATE;
+    }
+    lStatus = lPrngDrbgInstantiate(&xPrngDrbgShared, ucPers,
+				   sizeof(ucPers) - 1, 0);
+    if( lStatus != NO_ERROR )
+    {
+	debugERROR_PRINT("DRBG instantiation failed\n");
+	return lStatus;
+    }
+    xPrngDrbgMutex = xSemaphoreCreateMutex();
+    if( xPrngDrbgMutex == NULL )
+    {
+	vPrngDrbgUninstantiate(&xPrngDrbgShared);
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lPrngDrbgRandom( uint8_t *pucOut, uint32_t ulLen )
+{
+    int32_t lStatus = NO_ERROR;
+    uint32_t ulChunk;
+
+    if( pucOut == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( xPrngDrbgMutex == NULL )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+
+    xSemaphoreTake(xPrngDrbgMutex, portMAX_DELAY);
+    while( ulLen && ( lStatus == NO_ERROR ) )
+    {
+	ulChunk = ( ulLen < prngdrbgMAX_REQUEST ) ? ulLen : prngdrbgMAX_REQUEST;
+	lStatus = lPrngDrbgGenerate(&xPrngDrbgShared, pucOut, ulChunk, NULL, 0, 0);
+	pucOut += ulChunk;
+	ulLen -= ulChunk;
+    }
+    xSemaphoreGive(xPrngDrbgMutex);
+    return lStatus;
+}
+/*---------------------------------------------------------------------------*/
+/* EOF */
@@ -36,7 +36,7 @@
 #include <stdint.h>
 #include <errors.h>
 #include <stddef.h>
-#include <freeRtos.h>
+#include <FreeRTOS.h>
 #include <string.h>
 
 /* driver includes */
@@ -51,7 +51,7 @@
 #include <debug.h>
 #include <orwl_gpio.h>
 #include <hist_devtamper.h>
-#include <init.h>
+#include <Init.h>
 #include <reset.h>
 #include <mfgdata.h>
 #include <rtc.h>
@@ -68,7 +68,7 @@ extern uint8_t ucGPIODisplayInitDone;
 __attribute__((section(".nmi_code")))void vSecmonDefaultTamperDetectNmi( void )
 {
     int32_t lResult;
-    devtamperTamperHist_t *pxTamperHistory;
+    uint32_t ulDRSLogRTC = 0;
     uint32_t ulDevState = eBOOTMODE_DEV_USER_TAMPER;
     keysDSFT_MASTER_KEYS_t *pxMasterKeys;
     uint32_t ulSecalm = 0;
@@ -131,10 +131,6 @@ __attribute__((section(".nmi_code")))void vSecmonDefaultTamperDetectNmi( void )
 	/* power OFF Intel sub-system */
 	gpioIntelCpuShutdown();
 
-	/* Memory allocation for tamper history storing */
-	pxTamperHistory = pvPortMalloc(sizeof(devtamperTamperHist_t));
-	configASSERT(pxTamperHistory != NULL);
-
 	/* Memory allocation for reading access key structure */
 	pxMasterKeys = pvPortMalloc(sizeof(keysDSFT_MASTER_KEYS_t));
 	configASSERT(pxMasterKeys != NULL);
@@ -143,28 +139,11 @@ __attribute__((section(".nmi_code")))void vSecmonDefaultTamperDetectNmi( void )
 	 * initialized. This register reads the second register from RTC. This
 	 * will be updated if there is new DRS or if battery is removed.
 	 */
-	IO_READ_U32(secmonDLRTC, pxTamperHistory->xTamperEvent[0].ulDRSLogRTC);
-
-	/* Now convert the 32 bit second DRS Log RTC register value to human
-	 * readable values in rtcDateTime_t format.
-	 */
-	lResult = lRtcConvertRawToDateTime(
-		pxTamperHistory->xTamperEvent[0].ulDRSLogRTC,
-		&pxTamperHistory->xTamperEvent[0].xTamperDateTime);
-	if(lResult != NO_ERROR)
-	{
-	    debugERROR_PRINT_ISR("Failed to convert raw to date and time..\n");
-	    goto ERRORSTATE;
-	}
-
-	/* Update the tamper cause */
-	pxTamperHistory->xTamperEvent[0].ultamperCause = ulSecalm;
-
-	/* Event type */
-	pxTamperHistory->xTamperEvent[0].ulEventTyype = devtamperEVENT_TAMPER;
+	IO_READ_U32(secmonDLRTC, ulDRSLogRTC);
 
-	/*Write tamper history */
-	lResult = lDevtamperWriteTampHistoryNONRTOS(pxTamperHistory);
+	/* Append the tamper event, with its cause, to tamper history */
+	lResult = lDevtamperLogAppendNONRTOS(devtamperEVENT_TAMPER, ulDRSLogRTC,
+		ulSecalm);
 	if( lResult != NO_ERROR )
 	{
 	    debugERROR_PRINT_ISR("Failed to write tamper history..\n");
@@ -208,10 +187,6 @@ __attribute__((section(".nmi_code")))void vSecmonDefaultTamperDetectNmi( void )
 	}
 
 	/* release allocated resources */
-	if(pxTamperHistory)
-	{
-	    vPortFree(pxTamperHistory);
-	}
 	if(pxMasterKeys)
 	{
 	    vPortFree(pxMasterKeys);
@@ -36,54 +36,27 @@
 /*---------------------------------------------------------------------------*/
 /** Application includes */
 #include <printf_lite.h>
+#include <logring.h>
 
 /**
- *  Macros internal to the file. Do not modify !!!!
- * These Macros shouldn't be used directly.
+ * Log macros. Once the scheduler runs, each message is one record queued to
+ * the deferred log (logring.h); prefix, function and line are added when the
+ * drain task writes it out. Format strings must be literals.
  */
 
-/** debug prefix and informations */
-#define debugORWL_DBG_PREFIX		(lite_printf("[ORWL_DBG]:"))
-#define debugORWL_DBG_MSG( fmt )	(lite_printf( fmt ))
-#define debugORWL_DBG_INFO		(lite_printf("%s():%d:",__func__,__LINE__))
-
-/** error prefix and informations */
-#define debugORWL_ERR_PREFIX		(lite_printf("[ORWL_ERR]:"))
-#define debugORWL_DBG_MSG( fmt )	(lite_printf( fmt ))
-#define debugORWL_DBG_INFO		(lite_printf("%s():%d:",__func__,__LINE__))
-
-/** error prefix and informations, for ISR */
-#define debugISR_ERR_PREFIX		(lite_printf_isr("[ISR_ERR]:"))
-#define debugISR_DBG_MSG( fmt )		(lite_printf_isr( fmt ))
-#define debugISR_DBG_INFO		(lite_printf_isr("%s():%d:",__func__,__LINE__))
-
-/** warning prefix and information */
-#define debugORWL_WARN_PREFIX		(lite_printf("[ORWL_WARNING]:"))
-#define debugORWL_DBG_MSG( fmt )	(lite_printf( fmt ))
-#define debugORWL_DBG_INFO		(lite_printf("%s():%d:",__func__,__LINE__))
-
 /** print debug logs */
 #define debugPRINT(...) do {\
-	debugORWL_DBG_PREFIX;\
-	debugORWL_DBG_INFO;\
-	lite_printf(__VA_ARGS__);\
-	lite_printf( "\n" );\
+	vLogringWrite( eLOGRING_DBG, __func__, __LINE__, __VA_ARGS__ );\
 } while(0)
 
 /** print error logs */
 #define debugERROR_PRINT(...) do {\
-	debugORWL_ERR_PREFIX;\
-	debugORWL_DBG_INFO;\
-	lite_printf(__VA_ARGS__);\
-	lite_printf( "!!!!\n" );\
+	vLogringWrite( eLOGRING_ERR, __func__, __LINE__, __VA_ARGS__ );\
 } while(0)
 
 /** print warning logs */
 #define debugWARNING_PRINT(...) do {\
-	debugORWL_WARN_PREFIX;\
-	debugORWL_DBG_INFO;\
-	lite_printf(__VA_ARGS__);\
-	lite_printf( "!!!!\n" );\
+	vLogringWrite( eLOGRING_WARN, __func__, __LINE__, __VA_ARGS__ );\
 } while(0)
 
 /** Print plain, without function name and log type */
@@ -98,10 +71,7 @@
 
 /** print error logs, this should be called from ISR context. */
 #define debugERROR_PRINT_ISR(...) do {\
-	debugISR_ERR_PREFIX;\
-	debugISR_DBG_INFO;\
-	lite_printf_isr(__VA_ARGS__);\
-	lite_printf_isr( "!!!!\n" );\
+	vLogringWrite( eLOGRING_ISR_ERR, __func__, __LINE__, __VA_ARGS__ );\
 } while(0)
 
 /*---------------------------------------------------------------------------*/
@@ -40,6 +40,12 @@
 /** Delay factor */
 #define delayUS_FACT			108
 
+#ifdef ORWL_HOST_SIM
+/** The host simulation is cycle free: busy wait delays complete at once */
+#define delayMICRO_SEC(us_to_delay)	do { (void)(us_to_delay); } while(0)
+#define delayuSEC(us_to_delay)		do { (void)(us_to_delay); } while(0)
+#else
+
 /** for generating delay in micro second & must be used
  * before schedular starts */
 #define delayMICRO_SEC(us_to_delay)					\
@@ -72,4 +78,5 @@
 		}							\
 	}								\
 }
+#endif /* ORWL_HOST_SIM */
 #endif /* _INCLUDE_DELAY_H_ */
@@ -122,4 +122,14 @@ int32_t lIrqInit(void);
  * @return 0 on success and error code on failure.
  */
 int32_t lIrqClearInterrupt(mml_gpio_id_t xDevId, uint32_t ulPinNo);
+
+/** @brief ucIrqArmToggle arms the edge leaving the present level of
+ * 	  a given gpio pin. To be called from its ISR.
+ *
+ * @param  xDevId device identifier.
+ * @param  ulPinNo gpio pin number.
+ *
+ * @return level of the pin the armed edge leaves, 1 for high.
+ */
+uint8_t ucIrqArmToggle(mml_gpio_id_t xDevId, uint32_t ulPinNo);
 #endif
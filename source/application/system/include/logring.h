@@ -0,0 +1,151 @@
+ /**===========================================================================
+ * @file logring.h
+ *
+ * @brief This file contains the deferred console log. Log calls store the
+ *  * format string, caller and packed arguments in a lock-free ring and return;
+ *  * a low priority task formats and writes them to the console.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef INCLUDE_LOGRING_H_
+#define INCLUDE_LOGRING_H_
+
+#include <stdint.h>
+#include <stdarg.h>
+
+/** Records in the ring, power of 2 */
+#define logringRECORDS			(32)
+/** Argument words of one record */
+#define logringMAX_ARGS			(8)
+/** Bytes of %s argument copies of one record */
+#define logringMAX_STR			(48)
+/** Drain task polling period while the ring is empty */
+#define logringDRAIN_PERIOD_MS		(10)
+
+/* Binary console frame, written instead of text with _DEBUG_LOG_BINARY_ */
+#define logringSYNC_0			(0xA5) /**< first sync byte */
+#define logringSYNC_1			(0x5A) /**< second sync byte */
+
+/**
+ * log levels, select prefix and suffix of the line
+ */
+typedef enum
+{
+    eLOGRING_PLAIN = 0,		/**< text as is */
+    eLOGRING_DBG,		/**< [ORWL_DBG] */
+    eLOGRING_ERR,		/**< [ORWL_ERR] */
+    eLOGRING_WARN,		/**< [ORWL_WARNING] */
+    eLOGRING_ISR_ERR,		/**< [ISR_ERR] */
+    eLOGRING_DROPPED		/**< records lost to a full ring, ulArg[0] */
+} logringLevel_t;
+
+/**
+ * @brief One deferred log record.
+ */
+typedef struct
+{
+    /** reservation number + 1 once the record is complete */
+    volatile uint32_t ulCommit;
+    /** format string; its flash address identifies it to the host decoder */
+    const char *pcFmt;
+    /** function of the caller, constant string, NULL for plain records */
+    const char *pcFunc;
+    /** tick count when logged */
+    uint32_t ulTick;
+    /** line of the caller */
+    uint16_t usLine;
+    /** logringLevel_t */
+    uint8_t ucLevel;
+    /** argument words used */
+    uint8_t ucArgs;
+    /** arguments packed by lite_pack_args() */
+    uint32_t ulArg[logringMAX_ARGS];
+    /** copies of %s arguments */
+    char cStr[logringMAX_STR];
+} logringRecord_t;
+
+/**
+ * @brief Queue one log record
+ *
+ * Lock-free; can be called from tasks and interrupts. When the ring is full
+ * the record is dropped and counted.
+ *
+ * @param ucLevel logringLevel_t.
+ * @param pcFunc calling function, constant string or NULL.
+ * @param ulLine calling line.
+ * @param pcFmt format string, must stay valid - a literal.
+ * @param xArgs arguments of the format.
+ *
+ * @return void
+ */
+void vLogringWriteV( uint8_t ucLevel, const char *pcFunc, uint32_t ulLine,
+		     const char *pcFmt, va_list xArgs );
+
+/**
+ * @brief Queue one log record
+ *
+ * Variadic form of vLogringWriteV().
+ *
+ * @param ucLevel logringLevel_t.
+ * @param pcFunc calling function, constant string or NULL.
+ * @param ulLine calling line.
+ * @param pcFmt format string, must stay valid - a literal.
+ *
+ * @return void
+ */
+void vLogringWrite( uint8_t ucLevel, const char *pcFunc, uint32_t ulLine,
+		    const char *pcFmt, ... );
+
+/**
+ * @brief Write out every record queued so far
+ *
+ * For paths that reset or stop the system, where the drain task will not
+ * run again. Can be called from any context.
+ *
+ * @return void
+ */
+void vLogringFlush( void );
+
+/**
+ * @brief Get number of records dropped on a full ring
+ *
+ * @return dropped records since boot
+ */
+uint32_t ulLogringGetDropped( void );
+
+/**
+ * @brief Create the drain task
+ *
+ * Records queued before are kept and written once the scheduler runs.
+ *
+ * @return error code
+ */
+int32_t lLogringInit( void );
+
+#endif /* INCLUDE_LOGRING_H_ */
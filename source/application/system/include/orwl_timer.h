@@ -50,6 +50,7 @@ typedef struct
 
 #define timerLE_TIMER_ID			(MML_TMR_DEV0)	/**< Le seed update timer id */
 #define timerPROXIMITY_TIMER_ID			(MML_TMR_DEV1)	/**< 24 hrs proximity timer id */
+#define timerTIMESTAMP_TIMER_ID			(MML_TMR_DEV2)	/**< Free running timestamp timer id */
 #define timerONE_SEC_TIMEOUT			(54000000)	/**< Timer compare value for one second timeout */
 /* NOTE: clock = MML_TMR_PRES_DIV_64 and timeout = 1 * 54000000 gives 64 sec timer */
 /**< 15 mins Le timeout value = (15mins * 60secs)/64 = 14.0625 */
@@ -60,6 +61,14 @@ typedef struct
 #define timerPROXIMITY_TIMOUT_VALUE		(21)
 #define timerPROXIMITY_TIMEOUT			(timerPROXIMITY_TIMOUT_VALUE *\
 						timerONE_SEC_TIMEOUT )
+/**< Timestamp timer prescaler, 1024 gives ~19us per count and wraps after ~22 hrs */
+#define timerTIMESTAMP_PRESCALER		(MML_TMR_PRES_DIV_1024)
+/**< Timestamp counts per second */
+#define timerTIMESTAMP_HZ			(timerONE_SEC_TIMEOUT >>\
+						timerTIMESTAMP_PRESCALER)
+/**< Milliseconds to timestamp counts */
+#define timerMS_TO_STAMP( ms )			((uint32_t)(((uint64_t)(ms) *\
+						timerTIMESTAMP_HZ) / 1000))
 
 /**
  * @brief This function is the wrapper function used for initializing Le timer.
@@ -80,6 +89,26 @@ int32_t lTimerLeTmrInit( void );
  */
 int32_t lTimerProximityTimeoutTmrInit( void );
 
+/**
+ * @brief This function starts the free running timestamp timer. Calling it
+ * again once the timer runs does nothing.
+ *
+ * @param None
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lTimerTimestampInit( void );
+
+/**
+ * @brief This function reads the timestamp timer. It may be called from an
+ * interrupt handler. Differences of two timestamps are valid across a wrap.
+ *
+ * @param None
+ *
+ * @return timestamp in timerTIMESTAMP_HZ counts
+ */
+uint32_t ulTimerTimestamp( void );
+
 /**
  * @brief This function is the wrapper function used for reading the count value
  * of given timer.
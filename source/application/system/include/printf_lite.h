@@ -41,10 +41,27 @@
 #ifndef _PRINTF_LITE_H_
 #define _PRINTF_LITE_H_
 
+#include <stdarg.h>
+#include <stdint.h>
+
+/** Packed %s argument that was NULL or did not fit */
+#define LITE_PACK_NULL		(0xFFFFFFFF)
+
 /******************************************************************************/
+/* Once the scheduler runs, lite_printf() and lite_printf_isr() only queue   */
+/* the message to the deferred log, see logring.h.                          */
 int lite_printf(const char *fmt, ...);
 int lite_printf_isr(const char *fmt, ...);
 int lite_snprintf(char *str, int size, const char *fmt, ...);
+/* Store the arguments of fmt in words; %s strings are copied to str. Returns */
+/* number of words used.                                                      */
+int lite_pack_args(const char *fmt, va_list ap, uint32_t *words, int max_words,
+		   char *str, int max_str);
+/* Write fmt to console right away, for use before the scheduler runs       */
+int lite_vprintf_sync(const char *fmt, va_list ap);
+/* Write fmt to console with arguments packed by lite_pack_args()            */
+int lite_printf_packed(const char *fmt, const uint32_t *words, int count,
+		       const char *str);
 #endif /* _PRINTF_LITE_H_ */
 
 /******************************************************************************/
@@ -39,12 +39,14 @@
 
 #include <mml_gcr.h>
 #include <orwl_gpio.h>
+#include <logring.h>
 
 /* SYSTEM RESET */
 #define resetSYSTEM_RESET						\
 {									\
 	do								\
 	{								\
+		vLogringFlush();					\
                 gpioIntelCpuShutdown();                                 \
 		mml_reset_system();					\
 	}while(0);							\
@@ -63,5 +63,8 @@ enum taskPriority
 #define configSTACK_SIZE_NFC_PROD_TEST		(1024)	/**< Nfc Production test task stack size*/
 #define configSTACK_SIZE_INTEL_SUC_MANAGE_DATA  (512)	/**< Managing received data task */
 #define configSTACK_SIZE_TAMPER_MODE_TASK       (512)  /**< Managing received data task */
+#define configSTACK_SIZE_LOG_DRAIN_TSK		(256)	/**< Deferred log drain task */
+#define configSTACK_SIZE_I2C_MGR_TSK		(256)	/**< I2C bus manager task */
+#define configSTACK_SIZE_TRNG_POOL_TSK		(256)	/**< TRNG entropy pool refill task */
 /*---------------------------------------------------------------------------*/
 #endif /* INCLUDE_TASK_CONFIG_H_ */
@@ -153,3 +153,23 @@ int32_t lIrqClearInterrupt(mml_gpio_id_t xDevId, uint32_t ulPinNo)
     return mml_gpio_clear_interrupt(xDevId, ulPinNo, irqNBITS);
 }
 /*---------------------------------------------------------------------------*/
+
+uint8_t ucIrqArmToggle(mml_gpio_id_t xDevId, uint32_t ulPinNo)
+{
+    mml_gpio_pin_data_t xArmed = MML_GPIO_OUT_LOGIC_ONE;
+    mml_gpio_pin_data_t xLevel = MML_GPIO_OUT_LOGIC_ONE;
+
+    /* Re-arm until the level read matches the edge armed, so an edge
+     * while re-arming is not lost */
+    do
+    {
+	mml_gpio_pin_input(xDevId, ulPinNo, &xArmed);
+	mml_gpio_set_int_pol(xDevId, ulPinNo,
+		(xArmed == MML_GPIO_OUT_LOGIC_ONE) ? MML_GPIO_INT_POL_FALLING :
+		MML_GPIO_INT_POL_RAISING);
+	mml_gpio_pin_input(xDevId, ulPinNo, &xLevel);
+    } while (xLevel != xArmed);
+
+    return (xLevel == MML_GPIO_OUT_LOGIC_ONE) ? 1 : 0;
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,359 @@
+ /**===========================================================================
+ * @file logring.c
+ *
+ * @brief This file contains the deferred console log. Producers reserve a
+ *  * record with a compare and swap on the ring head, so tasks and interrupts
+ *  * can log without a critical section, and commit it by writing its
+ *  * reservation number. The drain task runs at the lowest priority and writes
+ *  * committed records in order as text, or as binary frames for the host
+ *  * decoder (tools/logring_decode.py) with _DEBUG_LOG_BINARY_.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+/* Global includes */
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* Local includes */
+#include <errors.h>
+#include <printf_lite.h>
+#include <private.h>
+#include <task_config.h>
+#include <logring.h>
+
+/** record ring */
+static logringRecord_t xLogringRing[logringRECORDS];
+/** next record to reserve, moved by producers */
+static uint32_t ulLogringHead;
+/** next record to write out, moved by consumers */
+static uint32_t ulLogringTail;
+/** records dropped on a full ring */
+static uint32_t ulLogringDropped;
+/** dropped records already reported */
+static uint32_t ulLogringReported;
+
+/**
+ * @brief Write one record to the console
+ *
+ * @param pxRecord record to write.
+ *
+ * @return void
+ */
+static void prvLogringEmit( const logringRecord_t *pxRecord );
+
+/**
+ * @brief Write prefix, function and line of a record as text
+ *
+ * @param ucLevel logringLevel_t.
+ * @param pcFunc calling function or NULL.
+ * @param ulLine calling line.
+ *
+ * @return void
+ */
+static void prvLogringPrefix( uint8_t ucLevel, const char *pcFunc,
+			      uint32_t ulLine );
+
+/**
+ * @brief Write out the record at the tail of the ring
+ *
+ * @return pdTRUE if the ring may hold more, pdFALSE if it is empty or the
+ * tail record is still being written
+ */
+static BaseType_t prvLogringDrainOne( void );
+
+/**
+ * @brief Drain task, writes out records and reports drops
+ *
+ * @param pvArg unused.
+ *
+ * @return void
+ */
+static void prvLogringDrainTask( void *pvArg );
+
+/*---------------------------------------------------------------------------*/
+
+static void prvLogringPrefix( uint8_t ucLevel, const char *pcFunc,
+			      uint32_t ulLine )
+{
+    uint32_t ulInfo[2];
+
+    switch( ucLevel )
+    {
+    case eLOGRING_DBG:
+	lite_printf_packed("[ORWL_DBG]:", NULL, 0, NULL);
+	break;
+    case eLOGRING_ERR:
+	lite_printf_packed("[ORWL_ERR]:", NULL, 0, NULL);
+	break;
+    case eLOGRING_WARN:
+	lite_printf_packed("[ORWL_WARNING]:", NULL, 0, NULL);
+	break;
+    case eLOGRING_ISR_ERR:
+	lite_printf_packed("[ISR_ERR]:", NULL, 0, NULL);
+	break;
+    default:
+	return;
+    }
+    if( pcFunc != NULL )
+    {
+	/* function name is a constant string, offset 0 of itself */
+	ulInfo[0] = 0;
+	ulInfo[1] = ulLine;
+	lite_printf_packed("%s():%d:", ulInfo, 2, pcFunc);
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+#ifdef _DEBUG_LOG_BINARY_
+static void prvLogringEmit( const logringRecord_t *pxRecord )
+{
+    uint8_t ucFrame[20 + ( logringMAX_ARGS * 4 ) + logringMAX_STR];
+    uint32_t ulLen = 0;
+    uint32_t ulStrLen;
+    uint32_t ulIndex;
+    uint8_t ucSum = 0;
+
+/* little endian store of a 32 bit value */
+#define logringPUT32( x ) do { \
+	ucFrame[ulLen++] = (uint8_t)( x ); \
+	ucFrame[ulLen++] = (uint8_t)( ( x ) >> 8 ); \
+	ucFrame[ulLen++] = (uint8_t)( ( x ) >> 16 ); \
+	ucFrame[ulLen++] = (uint8_t)( ( x ) >> 24 ); \
+} while( 0 )
+
+    /* string copies are zero filled, trailing zeros carry nothing */
+    for( ulStrLen = logringMAX_STR; ulStrLen > 0; ulStrLen-- )
+    {
+	if( pxRecord->cStr[ulStrLen - 1] != '\0' )
+	{
+	    break;
+	}
+    }
+
+    /* Addresses are resolved by the decoder from the ELF image */
+    logringPUT32( (uint32_t)(uintptr_t) pxRecord->pcFmt );
+    logringPUT32( (uint32_t)(uintptr_t) pxRecord->pcFunc );
+    logringPUT32( pxRecord->ulTick );
+    ucFrame[ulLen++] = (uint8_t) pxRecord->usLine;
+    ucFrame[ulLen++] = (uint8_t)( pxRecord->usLine >> 8 );
+    ucFrame[ulLen++] = pxRecord->ucLevel;
+    ucFrame[ulLen++] = pxRecord->ucArgs;
+    for( ulIndex = 0; ulIndex < pxRecord->ucArgs; ulIndex++ )
+    {
+	logringPUT32( pxRecord->ulArg[ulIndex] );
+    }
+    ucFrame[ulLen++] = (uint8_t) ulStrLen;
+    memcpy( &ucFrame[ulLen], pxRecord->cStr, ulStrLen );
+    ulLen += ulStrLen;
+
+#undef logringPUT32
+
+    /* sync, length, payload, sum of payload */
+    while( uart_write_char( logringSYNC_0 ) != NO_ERROR );
+    while( uart_write_char( logringSYNC_1 ) != NO_ERROR );
+    while( uart_write_char( (char) ulLen ) != NO_ERROR );
+    for( ulIndex = 0; ulIndex < ulLen; ulIndex++ )
+    {
+	ucSum += ucFrame[ulIndex];
+	while( uart_write_char( ucFrame[ulIndex] ) != NO_ERROR );
+    }
+    while( uart_write_char( ucSum ) != NO_ERROR );
+}
+#else
+static void prvLogringEmit( const logringRecord_t *pxRecord )
+{
+    if( pxRecord->ucLevel == eLOGRING_DROPPED )
+    {
+	lite_printf_packed("[ORWL_LOG]: %d records dropped!!!!\n",
+		pxRecord->ulArg, 1, NULL);
+	return;
+    }
+    prvLogringPrefix( pxRecord->ucLevel, pxRecord->pcFunc, pxRecord->usLine );
+    lite_printf_packed( pxRecord->pcFmt, pxRecord->ulArg, pxRecord->ucArgs,
+	    pxRecord->cStr );
+    if( pxRecord->ucLevel == eLOGRING_DBG )
+    {
+	lite_printf_packed( "\n", NULL, 0, NULL );
+    }
+    else if( pxRecord->ucLevel != eLOGRING_PLAIN )
+    {
+	lite_printf_packed( "!!!!\n", NULL, 0, NULL );
+    }
+}
+#endif /* _DEBUG_LOG_BINARY_ */
+/*---------------------------------------------------------------------------*/
+
+void vLogringWriteV( uint8_t ucLevel, const char *pcFunc, uint32_t ulLine,
+		     const char *pcFmt, va_list xArgs )
+{
+    logringRecord_t *pxRecord;
+    uint32_t ulHead;
+
+    if( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED )
+    {
+	/* Nothing else runs yet and nothing would drain, write it now */
+	prvLogringPrefix( ucLevel, pcFunc, ulLine );
+	lite_vprintf_sync( pcFmt, xArgs );
+	if( ucLevel == eLOGRING_DBG )
+	{
+	    lite_printf_packed( "\n", NULL, 0, NULL );
+	}
+	else if( ucLevel != eLOGRING_PLAIN )
+	{
+	    lite_printf_packed( "!!!!\n", NULL, 0, NULL );
+	}
+	return;
+    }
+
+    /* Reserve a record; a full ring drops instead of waiting */
+    ulHead = __atomic_load_n( &ulLogringHead, __ATOMIC_RELAXED );
+    do
+    {
+	if( ( ulHead - __atomic_load_n( &ulLogringTail, __ATOMIC_ACQUIRE ) )
+		>= logringRECORDS )
+	{
+	    __atomic_fetch_add( &ulLogringDropped, 1, __ATOMIC_RELAXED );
+	    return;
+	}
+    } while( !__atomic_compare_exchange_n( &ulLogringHead, &ulHead, ulHead + 1,
+	    pdTRUE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) );
+
+    pxRecord = &xLogringRing[ulHead & ( logringRECORDS - 1 )];
+    pxRecord->pcFmt = pcFmt;
+    pxRecord->pcFunc = pcFunc;
+    pxRecord->ulTick = xTaskGetTickCountFromISR( );
+    pxRecord->usLine = (uint16_t) ulLine;
+    pxRecord->ucLevel = ucLevel;
+    memset( pxRecord->cStr, 0, sizeof(pxRecord->cStr) );
+    pxRecord->ucArgs = (uint8_t) lite_pack_args( pcFmt, xArgs,
+	    pxRecord->ulArg, logringMAX_ARGS, pxRecord->cStr, logringMAX_STR );
+
+    /* Record is visible to consumers from here */
+    __atomic_store_n( &pxRecord->ulCommit, ulHead + 1, __ATOMIC_RELEASE );
+}
+/*---------------------------------------------------------------------------*/
+
+void vLogringWrite( uint8_t ucLevel, const char *pcFunc, uint32_t ulLine,
+		    const char *pcFmt, ... )
+{
+    va_list xArgs;
+
+    va_start( xArgs, pcFmt );
+    vLogringWriteV( ucLevel, pcFunc, ulLine, pcFmt, xArgs );
+    va_end( xArgs );
+}
+/*---------------------------------------------------------------------------*/
+
+static BaseType_t prvLogringDrainOne( void )
+{
+    logringRecord_t xRecord;
+    logringRecord_t *pxRecord;
+    uint32_t ulTail;
+
+    ulTail = __atomic_load_n( &ulLogringTail, __ATOMIC_ACQUIRE );
+    pxRecord = &xLogringRing[ulTail & ( logringRECORDS - 1 )];
+    if( __atomic_load_n( &pxRecord->ulCommit, __ATOMIC_ACQUIRE ) !=
+	    ( ulTail + 1 ) )
+    {
+	/* Empty, or the producer is still filling it in */
+	return pdFALSE;
+    }
+    memcpy( &xRecord, pxRecord, sizeof(xRecord) );
+
+    /* Releasing the record lets producers reuse it. A flush in another
+     * context may have written it out meanwhile; then skip it.
+     */
+    if( __atomic_compare_exchange_n( &ulLogringTail, &ulTail, ulTail + 1,
+	    pdFALSE, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED ) )
+    {
+	prvLogringEmit( &xRecord );
+    }
+    return pdTRUE;
+}
+/*---------------------------------------------------------------------------*/
+
+void vLogringFlush( void )
+{
+    logringRecord_t xRecord;
+    uint32_t ulDropped;
+
+    while( prvLogringDrainOne( ) == pdTRUE )
+    {
+	;
+    }
+
+    /* Report drops once the backlog is out, in order with the records */
+    ulDropped = __atomic_load_n( &ulLogringDropped, __ATOMIC_RELAXED );
+    if( ulDropped != ulLogringReported )
+    {
+	memset( &xRecord, 0, sizeof(xRecord) );
+	xRecord.ucLevel = eLOGRING_DROPPED;
+	xRecord.ucArgs = 1;
+	xRecord.ulArg[0] = ulDropped - ulLogringReported;
+	xRecord.ulTick = xTaskGetTickCountFromISR( );
+	ulLogringReported = ulDropped;
+	prvLogringEmit( &xRecord );
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+uint32_t ulLogringGetDropped( void )
+{
+    return __atomic_load_n( &ulLogringDropped, __ATOMIC_RELAXED );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvLogringDrainTask( void *pvArg )
+{
+    (void) pvArg;
+
+    while( 1 )
+    {
+	vLogringFlush( );
+	vTaskDelay( pdMS_TO_TICKS( logringDRAIN_PERIOD_MS ) );
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lLogringInit( void )
+{
+    if( xTaskCreate( prvLogringDrainTask, "LogDrain",
+	    configSTACK_SIZE_LOG_DRAIN_TSK, NULL, ePRIORITY_DEFUALT,
+	    NULL ) != pdPASS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
@@ -55,6 +55,7 @@
 #include <printf_lite.h>
 #include <private.h>
 #include <debug.h>
+#include <logring.h>
 #include <task_config.h>
 #include <uart_config.h>
 #include <orwl_gpio.h>
@@ -64,10 +65,15 @@
 #include <orwl_disp_interface.h>
 #include <irq.h>
 #include <i2c.h>
+#include <i2cmgr.h>
 #include <mpuinterface.h>
 #include <Init.h>
 #include <mem_common.h>
+#include <logstore.h>
+#include <hist_devtamper.h>
 #include <pinentry.h>
+#include <trng_pool.h>
+#include <prng_drbg.h>
 #include <orwl_err.h>
 
 /* RTOS includes */
@@ -95,6 +101,10 @@
 #include <nfcprod_test.h>
 #endif
 
+#ifdef ORWL_HOST_SIM
+#include <sim.h>
+#endif
+
 /*---------------------------------------------------------------------------*/
 
 /* TODO: remove this or modify this based on use case */
@@ -177,6 +187,22 @@ static void prvMainSetupORWL( void ) {
 	   while(1);
        }
 
+       /* Mount the flash record stores, before tamper NMI can use them */
+       iresult = lLogstoreInit();
+       if ( iresult )
+       {
+   	/* Oops, I did it again ... */
+	   while(1);
+       }
+
+       /* Mount the tamper event log, it imports from the record store */
+       iresult = lDevtamperLogInit();
+       if ( iresult )
+       {
+   	/* Oops, I did it again ... */
+	   while(1);
+       }
+
        /* Wait for system to stabilize */
        delayMICRO_SEC(10000);
 
@@ -254,9 +280,33 @@ int main( void ) {
 	 */
 	ucGPIODisplayInitDone = ucGPIODisplayInitDone | initDISPLAY_INIT_DONE;
 
+	/* Display updates go through the framebuffer from here on */
+	ierr = lOledFbInit();
+	if (ierr)
+	{
+	    debugERROR_PRINT("OLED framebuffer initialization failed\n");
+	    while(1);
+	}
+
 	/* Initializing the crypto library */
 	vNfcCommonCryptoInit( );
 
+	/* Random numbers come from the health tested entropy pool */
+	ierr = lTrngPoolInit();
+	if (ierr)
+	{
+	    debugERROR_PRINT("TRNG entropy pool initialization failed\n");
+	    while(1);
+	}
+
+	/* Shared DRBG, seeded from the entropy pool */
+	ierr = lPrngDrbgInit();
+	if (ierr)
+	{
+	    debugERROR_PRINT("DRBG initialization failed\n");
+	    while(1);
+	}
+
 	/* Initialize I2C */
 	ierr = lI2cInit();
 	if (ierr)
@@ -265,6 +315,14 @@ int main( void ) {
 	    while(1);
 	}
 
+	/* I2C transfers of all clients go through the bus manager */
+	ierr = lI2cmgrInit();
+	if (ierr)
+	{
+	    debugERROR_PRINT("I2C bus manager creation failed\n");
+	    while(1);
+	}
+
 	/* Register the interrupt handler */
 	ierr = lIrqInit();
 	if(ierr)
@@ -273,6 +331,14 @@ int main( void ) {
 	    while(1);
 	}
 
+	/* Start the console log drain; messages are deferred from here on */
+	ierr = lLogringInit();
+	if(ierr)
+	{
+	    debugERROR_PRINT("Log drain task creation failed\n");
+	    while(1);
+	}
+
 	//while(1);
 	/* Initialize system global resources */
 	if( ulSystemResInitGlobalSystemResources( ) != NO_ERROR ) {
@@ -412,7 +478,7 @@ int main( void ) {
 		    while(1);
 		}
 
-		#ifndef ENABLE_MPU_GIO_INTERRUPT
+		    /* Sleeps until the MPU raises its INT line */
 		    ierr = xTaskCreate(vMpuinterfaceReadFifoTsk, "MpuReadFifoTask",
 			    configSTACK_SIZE_MPU_FIFO_READ_TSK,
 			    &xgResource, ePRIORITY_IDLE_TASK,
@@ -422,10 +488,6 @@ int main( void ) {
 			debugPRINT("Failed to create task");
 			while (1);
 		    }
-
-		    /* keep this task in suspended mode */
-		    vTaskSuspend(xgResource.xMpuFifoTskHandle);
-		#endif
 	    break;
 	    case eBOOTMODE_DEV_USER:
 
@@ -498,20 +560,16 @@ int main( void ) {
 			while(1);
 		    }
 
-		    #ifndef ENABLE_MPU_GIO_INTERRUPT
-			ierr = xTaskCreate(vMpuinterfaceReadFifoTsk, "MpuReadFifoTask",
-				configSTACK_SIZE_MPU_FIFO_READ_TSK,
-				&xgResource, ePRIORITY_IDLE_TASK,
-				&xgResource.xMpuFifoTskHandle);
-			if (ierr != pdPASS)
-			{
-			    debugERROR_PRINT("Failed to create task");
-			    while (1);
-			}
-
-			/* keep this task in suspended mode */
-			vTaskSuspend(xgResource.xMpuFifoTskHandle);
-		    #endif
+		    /* Sleeps until the MPU raises its INT line */
+		    ierr = xTaskCreate(vMpuinterfaceReadFifoTsk, "MpuReadFifoTask",
+			    configSTACK_SIZE_MPU_FIFO_READ_TSK,
+			    &xgResource, ePRIORITY_IDLE_TASK,
+			    &xgResource.xMpuFifoTskHandle);
+		    if (ierr != pdPASS)
+		    {
+			debugERROR_PRINT("Failed to create task");
+			while (1);
+		    }
 
 		    ierr = xTaskCreate(vPowerbtnTsk, "PowerBtnTask",
 			    configSTACK_SIZE_POWER_BTN_TSK, &xgResource,
@@ -561,6 +619,10 @@ int main( void ) {
 		while(1);
 	    break;
 	}
+#endif
+#ifdef ORWL_HOST_SIM
+	/* Host simulation: start the benchmark runner if requested */
+	vSimBenchStart( );
 #endif
 	/* Start the scheduler. */
 	vTaskStartScheduler( );
@@ -33,6 +33,7 @@
  */
 
 #include <orwl_timer.h>
+#include <orwl_oled.h>
 
 /* Global structure to store the used timer id details */
 static timerUsedList_t xTimerIdList;
@@ -62,6 +63,16 @@ static void prvLe_Timeout_Handler( void );
  * @return void
  */
 static void prvProximity_Timeout_Handler( void );
+
+/**
+ * @brief This function is the timestamp timer wrap handler. The timestamp is
+ * read modulo 2^32, nothing is to be done on a wrap.
+ *
+ * @param None
+ *
+ * @return void
+ */
+static void prvTimestamp_Wrap_Handler( void );
 /*----------------------------------------------------------------------------*/
 
 static void prvLe_Timeout_Handler( void )
@@ -70,6 +81,7 @@ static void prvLe_Timeout_Handler( void )
 	if( lTimerClose( timerLE_TIMER_ID ))
 	{
 		debugERROR_PRINT(" Failed to close LE TIMER in ISR");
+		vOledFbDirect();
 		vDisplayClearScreenNONRTOS(dispWELCOME_IMGLTX,dispWELCOME_IMGLTY,
 		dispWELCOME_IMGRBX, dispWELCOME_IMGRBY, dispBACKGROUND_BLACK);
 		vDisplaySetTextPosNONRTOS( dispWELCOME_STR_XCOR,
@@ -88,6 +100,7 @@ static void prvLe_Timeout_Handler( void )
 	{
 		debugERROR_PRINT("Failed to re-init LE timer in Le timeout"
 			"handler");
+		vOledFbDirect();
 		vDisplayClearScreenNONRTOS(dispWELCOME_IMGLTX,dispWELCOME_IMGLTY,
 		dispWELCOME_IMGRBX, dispWELCOME_IMGRBY, dispBACKGROUND_BLACK);
 		vDisplaySetTextPosNONRTOS( dispWELCOME_STR_XCOR,
@@ -148,6 +161,41 @@ int32_t lTimerProximityTimeoutTmrInit( void )
 }
 /*----------------------------------------------------------------------------*/
 
+static void prvTimestamp_Wrap_Handler( void )
+{
+	mml_tmr_interrupt_clear( timerTIMESTAMP_TIMER_ID );
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lTimerTimestampInit( void )
+{
+	mml_tmr_config_t xConfig;
+
+	if(( xTimerIdList.ulUsedTimerList )&( 0x01<<timerTIMESTAMP_TIMER_ID ))
+	{
+		return NO_ERROR;
+	}
+	xConfig.timeout = UINT32_MAX;
+	xConfig.count = 1;
+	xConfig.pwm_value = 0;
+	xConfig.clock = timerTIMESTAMP_PRESCALER;
+	xConfig.mode = MML_TMR_MODE_CONTINUOUS;
+	xConfig.polarity = MML_TMR_POLARITY_LOW;
+	xConfig.handler = prvTimestamp_Wrap_Handler;
+
+	return lTimerInit( &xConfig , timerTIMESTAMP_TIMER_ID );
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulTimerTimestamp( void )
+{
+	unsigned int ulCount = 0;
+
+	mml_tmr_read( timerTIMESTAMP_TIMER_ID, &ulCount );
+	return (uint32_t)ulCount;
+}
+/*----------------------------------------------------------------------------*/
+
 int32_t lTimerRead( mml_tmr_id_t eTimer_id , uint32_t * pulCountValue )
 {
 	return mml_tmr_read(eTimer_id, pulCountValue );
@@ -42,6 +42,7 @@
 #include <printf_lite.h>
 
 #include <stdarg.h> /** For va_start(), etc ... */
+#include <stdint.h>
 #include <config.h>
 #include <errors.h>
 /** Other includes */
@@ -56,6 +57,19 @@
 #include <task.h>
 #include <portable.h>
 
+/** Deferred log */
+#include <logring.h>
+
+/** Argument source of private_printf() */
+typedef struct
+{
+	va_list ap;			/**< variable arguments, used when words is NULL */
+	const uint32_t *words;		/**< arguments packed by lite_pack_args() */
+	int count;			/**< number of packed words */
+	int next;			/**< next packed word to fetch */
+	const char *str;		/**< strings packed by lite_pack_args() */
+} printf_args_t;
+
 char *gTempPtr ;
 unsigned int sizeRxBuff ;
 unsigned int  __index = 0;
@@ -69,7 +83,7 @@ void write_string(const char *text);
 int check_string(const char *str);
 int private_printf(void (*putc)(char c),
 								char *fmt,
-								va_list ap);
+								printf_args_t *args);
 void write_char(char c);
 int write_char_buf(const char c);
 void write_long(unsigned long long  n,
@@ -87,22 +101,22 @@ int cvt(unsigned long long val,
 
 int lite_printf(const char *fmt, ...)
 {
-    int							result = COMMON_ERR_UNKNOWN;
-	va_list						ap;
+    int							result = NO_ERROR;
+	printf_args_t				args;
 
+    args.words = NULL;
+    va_start(args.ap, fmt);
     if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
     {
-	taskENTER_CRITICAL();
+	/** Queue it, drain task writes it out */
+	vLogringWriteV(eLOGRING_PLAIN, NULL, 0, fmt, args.ap);
     }
-
-    va_start(ap, fmt);
-    result = private_printf(write_char, (char*)fmt, ap);
-    va_end(ap);
-
-    if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    else
     {
-	taskEXIT_CRITICAL();
+	/** Nothing else runs yet, write it right away */
+	result = private_printf(write_char, (char*)fmt, &args);
     }
+    va_end(args.ap);
     /** We're done */
     return result;
 }
@@ -110,12 +124,21 @@ int lite_printf(const char *fmt, ...)
 
 int lite_printf_isr(const char *fmt, ...)
 {
-    int							result = COMMON_ERR_UNKNOWN;
-	va_list						ap;
+    int							result = NO_ERROR;
+	printf_args_t				args;
 
-    va_start(ap, fmt);
-    result = private_printf(write_char, (char*)fmt, ap);
-    va_end(ap);
+    args.words = NULL;
+    va_start(args.ap, fmt);
+    if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+    {
+	/** Ring is lock-free, fine from interrupt */
+	vLogringWriteV(eLOGRING_PLAIN, NULL, 0, fmt, args.ap);
+    }
+    else
+    {
+	result = private_printf(write_char, (char*)fmt, &args);
+    }
+    va_end(args.ap);
 
     /** We're done */
     return result;
@@ -125,7 +148,7 @@ int lite_printf_isr(const char *fmt, ...)
 int lite_snprintf(char *str, int size, const char *fmt, ...)
 {
     int							result = COMMON_ERR_UNKNOWN;
-	va_list						ap;
+	printf_args_t				args;
 
     // Let us initilize
 
@@ -133,9 +156,10 @@ int lite_snprintf(char *str, int size, const char *fmt, ...)
 	gTempPtr = str ;
 	__index = 0 ;
 
-    va_start(ap, fmt);
-    result = private_printf(write_char_buf, (char*)fmt, ap);
-    va_end(ap);
+    args.words = NULL;
+    va_start(args.ap, fmt);
+    result = private_printf(write_char_buf, (char*)fmt, &args);
+    va_end(args.ap);
     /** We're done */
     return result;
 }
@@ -335,10 +359,204 @@ int cvt(unsigned long long val,
     return (length);
 }
 
+/******************************************************************************/
+/******************************************************************************/
+/* Fetch next packed word, 0 once all are used                           */
+static uint32_t arg_word(printf_args_t *args)
+{
+    if( args->next < args->count )
+    {
+	return args->words[args->next++];
+    }
+    return 0;
+}
+
+/******************************************************************************/
+/* Fetch a numeric argument of the given size                           */
+static long long arg_int(printf_args_t *args, int islong, int islonglong)
+{
+    unsigned long long val;
+
+    if( args->words == NULL )
+    {
+	if( islonglong )
+	{
+	    return va_arg(args->ap, long long);
+	}
+	if( islong )
+	{
+	    return (long long)va_arg(args->ap, long);
+	}
+	return (long long)va_arg(args->ap, int);
+    }
+    /* Packed the same way in lite_pack_args() */
+    if( islonglong || ( islong && ( sizeof(long) > sizeof(uint32_t) ) ) )
+    {
+	val = arg_word(args);
+	val |= (unsigned long long)arg_word(args) << 32;
+	return (long long)val;
+    }
+    return (long long)(int32_t)arg_word(args);
+}
+
+/******************************************************************************/
+/* Fetch a string argument                                              */
+static char *arg_string(printf_args_t *args)
+{
+    uint32_t offset;
+
+    if( args->words == NULL )
+    {
+	return va_arg(args->ap, char *);
+    }
+    offset = arg_word(args);
+    if( offset == LITE_PACK_NULL )
+    {
+	return NULL;
+    }
+    return (char *)&args->str[offset];
+}
+
+/******************************************************************************/
+int lite_pack_args(const char *fmt, va_list ap, uint32_t *words, int max_words,
+		   char *str, int max_str)
+{
+    int							count = 0;
+    int							used = 0;
+    int							islong;
+    int							islonglong;
+    int							len;
+    unsigned long long			val;
+    const char					*cp;
+    char						c;
+
+    while( ( c = *fmt++ ) != '\0' )
+    {
+	if( c != '%' )
+	{
+	    continue;
+	}
+	/* Skip flags, width and precision as private_printf() does */
+	c = *fmt++;
+	while( ( c == '-' ) || ( c == '.' ) || M_COBRA_IS_DIGIT(c) )
+	{
+	    c = *fmt++;
+	}
+	islong = islonglong = 0;
+	if( c == 'l' )
+	{
+	    c = *fmt++;
+	    islong = 1;
+	    if( c == 'l' )
+	    {
+		c = *fmt++;
+		islonglong = 1;
+	    }
+	}
+	switch( c )
+	{
+	case '\0':
+	    /* Format ends in a conversion */
+	    return count;
+	case 'p':
+	    islong = 1;
+	    /* fall through */
+	case 'd':
+	case 'D':
+	case 'x':
+	case 'X':
+	case 'u':
+	case 'U':
+	case 'b':
+	case 'B':
+	    if( islonglong || ( islong && ( sizeof(long) > sizeof(uint32_t) ) ) )
+	    {
+		if( ( count + 2 ) > max_words )
+		{
+		    return count;
+		}
+		val = islonglong ? (unsigned long long)va_arg(ap, long long) :
+			(unsigned long long)va_arg(ap, long);
+		words[count++] = (uint32_t)val;
+		words[count++] = (uint32_t)( val >> 32 );
+	    }
+	    else
+	    {
+		if( count == max_words )
+		{
+		    return count;
+		}
+		words[count++] = islong ? (uint32_t)va_arg(ap, long) :
+			(uint32_t)va_arg(ap, int);
+	    }
+	    break;
+	case 'c':
+	case 'C':
+	    if( count == max_words )
+	    {
+		return count;
+	    }
+	    words[count++] = (uint32_t)va_arg(ap, int);
+	    break;
+	case 's':
+	case 'S':
+	    if( count == max_words )
+	    {
+		return count;
+	    }
+	    /* Caller's string may not outlive the call, keep a copy */
+	    cp = va_arg(ap, const char *);
+	    if( ( cp == NULL ) || ( used >= max_str ) )
+	    {
+		words[count++] = LITE_PACK_NULL;
+		break;
+	    }
+	    for( len = 0; cp[len] && ( ( used + len + 1 ) < max_str ); len++ )
+	    {
+		str[used + len] = cp[len];
+	    }
+	    str[used + len] = '\0';
+	    words[count++] = used;
+	    used += len + 1;
+	    break;
+	default:
+	    /* '%' and unknown conversions take no argument */
+	    break;
+	}
+    }
+    return count;
+}
+
+/******************************************************************************/
+int lite_vprintf_sync(const char *fmt, va_list ap)
+{
+	printf_args_t				args;
+	int							result;
+
+    args.words = NULL;
+    va_copy(args.ap, ap);
+    result = private_printf(write_char, (char*)fmt, &args);
+    va_end(args.ap);
+    return result;
+}
+
+/******************************************************************************/
+int lite_printf_packed(const char *fmt, const uint32_t *words, int count,
+		       const char *str)
+{
+	printf_args_t				args;
+
+    args.words = words;
+    args.count = count;
+    args.next = 0;
+    args.str = str;
+    return private_printf(write_char, (char*)fmt, &args);
+}
+
 /******************************************************************************/
 int private_printf(void (*putc)(const char c),
 								char *fmt,
-								va_list ap)
+								printf_args_t *args)
 {
     char						buf[sizeof(unsigned long long) * 8];
     char						c;
@@ -364,7 +582,7 @@ int private_printf(void (*putc)(const char c),
         for( i = 0; i < 8; i++ )
         {
             write_char(' ');
-            val = va_arg(ap, unsigned long);
+            val = arg_int(args, 1, 0);
             write_hex(val);
         }
         write_string(">\n");
@@ -434,18 +652,7 @@ int private_printf(void (*putc)(const char c),
             case 'U':
             case 'b':
             case 'B':
-                if (islonglong)
-                {
-                    val = va_arg(ap, long long);
-                }
-                else if (islong)
-                {
-                    val = (long long)va_arg(ap, long);
-                }
-                else
-                {
-                    val = (long long)va_arg(ap, int);
-                }
+                val = arg_int(args, islong, islonglong);
                 if ((c == 'd') || (c == 'D'))
                 {
                     if (val < 0)
@@ -500,7 +707,7 @@ int private_printf(void (*putc)(const char c),
                 break;
             case 's':
             case 'S':
-                cp = va_arg(ap, char *);
+                cp = arg_string(args);
                 if (cp == NULL)
                     cp = "<null>";
                 else if (!check_string(cp))
@@ -514,7 +721,7 @@ int private_printf(void (*putc)(const char c),
                 break;
             case 'c':
             case 'C':
-                c = va_arg(ap, int /*char*/);
+                c = (int)arg_int(args, 0, 0) /*char*/;
                 (*putc)(c);
                 res++;
                 continue;
@@ -63,6 +63,7 @@
  * @brief This is an interface function between application and TRNG driver.
  * On successful execution, this function will generate True Random number and
  * populate the application Buffer with the Random number of given length.
+ * Data comes from the entropy pool once lTrngPoolInit has run.
  *
  * @param ulpRandNumBuf Data buffer to store the random number generated.
  * 						Buffer of sufficient size must be supplied by the caller
@@ -76,4 +77,16 @@
  */
 uint32_t ulGenerateRandomNumber(uint32_t *pulRandNumBuf, uint32_t ulNumWords);
 
+/**
+ * @brief This function reads the TRNG hardware directly, waiting for every
+ * 128 bit of data. Only the entropy pool should use it, see trng_pool.h.
+ *
+ * @param ulpRandNumBuf Data buffer to store the random number generated.
+ * @param ulNumWords	Number of of data words requested by the caller
+ *
+ * @return error number will be returned on failure
+ *			On success returns NO_ERROR(0)
+ */
+uint32_t ulTrngReadRaw(uint32_t *pulRandNumBuf, uint32_t ulNumWords);
+
 #endif /* _TRNG_H_ */
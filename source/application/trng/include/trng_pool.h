@@ -0,0 +1,122 @@
+ /**===========================================================================
+ * @file trng_pool.h
+ *
+ * @brief This file contains the TRNG entropy pool API. A low priority task
+ * keeps a pool of health tested and conditioned random bytes in RAM, so
+ * consumers do not wait on the TRNG hardware.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef _TRNG_POOL_H_
+#define _TRNG_POOL_H_
+
+#include <stdint.h>
+
+#define trngpoolSIZE			(256)	/**< conditioned bytes kept in the pool */
+#define trngpoolLOW_WATER		(128)	/**< level at which readers wake the refill task */
+#define trngpoolBLOCK_LEN		(32)	/**< conditioned bytes out of one raw block, SHA-256 length */
+#define trngpoolRAW_WORDS		(20)	/**< TRNG words conditioned into one block */
+#define trngpoolREFILL_PERIOD_MS	(1000)	/**< refill task checks the pool at least this often */
+
+/* SP 800-90B health tests on byte samples, for an assumed min-entropy of
+ * 4 bits per byte and a false alarm probability of 2^-20 */
+#define trngpoolRCT_CUTOFF		(6)	/**< repetition count test cutoff, 1 + 20 / 4 */
+#define trngpoolAPT_WINDOW		(512)	/**< adaptive proportion test window */
+#define trngpoolAPT_CUTOFF		(62)	/**< adaptive proportion test cutoff for the window */
+#define trngpoolSTARTUP_SAMPLES		(1024)	/**< samples tested before the first output */
+#define trngpoolMAX_FAILURES		(3)	/**< raw blocks failing in a row before the TRNG is declared failed */
+
+/**
+ * @brief Pool statistics
+ */
+typedef struct
+{
+    /** conditioned blocks produced */
+    uint32_t ulBlocks;
+    /** repetition count test failures */
+    uint32_t ulRctFailures;
+    /** adaptive proportion test failures */
+    uint32_t ulAptFailures;
+    /** reads served from the pool */
+    uint32_t ulPoolReads;
+    /** reads conditioned on the caller's time as the pool was short */
+    uint32_t ulDirectReads;
+    /** lowest level seen by a reader */
+    uint32_t ulLowestLevel;
+} trngpoolStats_t;
+
+/**
+ * @brief This function runs the start up health tests, fills the pool and
+ * creates the refill task. Random numbers are read straight from the TRNG
+ * till this is called.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lTrngPoolInit( void );
+
+/**
+ * @brief This function copies random bytes out of the pool. It never waits
+ * on the TRNG.
+ *
+ * @param pucBuf buffer to fill.
+ * @param ulLen number of bytes requested.
+ *
+ * @return NO_ERROR on success, COMMON_ERR_IN_PROGRESS if the pool holds less
+ * than ulLen bytes, COMMON_ERR_BAD_STATE if the TRNG failed its health tests
+ */
+int32_t lTrngPoolRead( uint8_t *pucBuf, uint32_t ulLen );
+
+/**
+ * @brief This function fills the buffer from the pool, conditioning fresh
+ * TRNG data on the caller's time if the pool is short.
+ *
+ * @param pucBuf buffer to fill.
+ * @param ulLen number of bytes requested.
+ *
+ * @return NO_ERROR on success or error code
+ */
+int32_t lTrngPoolGet( uint8_t *pucBuf, uint32_t ulLen );
+
+/**
+ * @brief This function gives the number of bytes in the pool.
+ *
+ * @return bytes available to lTrngPoolRead
+ */
+uint32_t ulTrngPoolLevel( void );
+
+/**
+ * @brief This function copies the pool statistics.
+ *
+ * @param pxStats filled with the statistics.
+ *
+ * @return void
+ */
+void vTrngPoolGetStats( trngpoolStats_t *pxStats );
+
+#endif /* _TRNG_POOL_H_ */
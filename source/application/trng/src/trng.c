@@ -35,6 +35,11 @@
 
 /* Local includes */
 #include <trng.h>
+#include <trng_pool.h>
+
+#ifdef ORWL_HOST_SIM
+#include <sim.h>
+#endif
 
 /* debug and log message header */
 #include <debug.h>
@@ -123,6 +128,11 @@ static uint32_t prvTrngRead( uint32_t *pulRandNumBuf, uint32_t ulReadLen ) {
 
 	/* First clear RNG_I4S bit before asking for a new 128bits TRN */
 	reg_trng->trngcr |= MML_TRNGCN_RNG_ISC_MASK;
+#ifdef ORWL_HOST_SIM
+	/* Register writes are not observable in the simulation, fresh data
+	 * would otherwise wait for the register model */
+	vSimTrngService();
+#endif
 	ulLoopCount = trngMAX_WAIT_TIME;
 
 	/* Only 128bits number is read */
@@ -154,6 +164,26 @@ static uint32_t prvTrngRead( uint32_t *pulRandNumBuf, uint32_t ulReadLen ) {
 
 uint32_t ulGenerateRandomNumber( uint32_t *pulRandNumBuf, uint32_t ulNumWords ) {
 
+	/* validate input buffer */
+	if (pulRandNumBuf == NULL) {
+		return COMMON_ERR_NULL_PTR;
+	}
+
+	/* check for minimum number: Never restrict on Max request */
+	if (ulNumWords < trngMIN_TRNG_GEN_WORDS) {
+		debugPRINT_TRNG(" Requested length must be minimum %d \n",trngMIN_TRNG_GEN_WORDS);
+		return COMMON_ERR_OUT_OF_RANGE;
+	}
+
+	/* Health tested and conditioned data out of RAM */
+	return (uint32_t) lTrngPoolGet((uint8_t *) pulRandNumBuf,
+			ulNumWords * trngWORD_TO_BYTE_FACT);
+}
+
+/*****************************************************************************/
+
+uint32_t ulTrngReadRaw( uint32_t *pulRandNumBuf, uint32_t ulNumWords ) {
+
 	/*status byte*/
 	uint32_t ulStatus;
 
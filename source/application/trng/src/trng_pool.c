@@ -0,0 +1,450 @@
+ /**===========================================================================
+ * @file trng_pool.c
+ *
+ * @brief This file contains the TRNG entropy pool. Raw TRNG data passes the
+ * SP 800-90B repetition count and adaptive proportion tests and is
+ * conditioned with SHA-256 before it is kept in RAM for consumers.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <string.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+/* Local includes */
+#include <errors.h>
+#include <task_config.h>
+#include <trng.h>
+#include <trng_pool.h>
+#include <ucl/ucl_defs.h>
+#include <ucl/ucl_sha256.h>
+
+/* debug and log message header */
+#include <debug.h>
+
+/** conditioned bytes, read from ulTrngPoolTail on */
+static uint8_t ucTrngPool[trngpoolSIZE];
+/** oldest byte of the pool */
+static uint32_t ulTrngPoolTail;
+/** bytes in the pool */
+static uint32_t ulTrngPoolCount;
+/** serialises the producers, the health test state is theirs */
+static SemaphoreHandle_t xTrngPoolMutex = NULL;
+/** refill task, woken by readers at the low water mark */
+static TaskHandle_t xTrngPoolTask = NULL;
+/** set once the TRNG failed its health tests */
+static uint32_t ulTrngPoolFailed;
+/** pool statistics */
+static trngpoolStats_t xTrngPoolStats;
+
+/** last sample of the repetition count test */
+static uint8_t ucTrngRctLast;
+/** run length of ucTrngRctLast */
+static uint32_t ulTrngRctRun;
+/** reference sample of the adaptive proportion window */
+static uint8_t ucTrngAptRef;
+/** samples of the window seen */
+static uint32_t ulTrngAptSeen;
+/** occurrences of ucTrngAptRef in the window */
+static uint32_t ulTrngAptHits;
+
+/**
+ * @brief Runs the health tests over raw TRNG data.
+ *
+ * The tests keep their state across calls. A failed adaptive proportion
+ * test starts a new window.
+ *
+ * @param pucRaw raw data, one sample per byte.
+ * @param ulLen number of samples.
+ *
+ * @return NO_ERROR if both tests passed or COMMON_ERR_BAD_STATE
+ */
+static int32_t prvTrngPoolHealth( const uint8_t *pucRaw, uint32_t ulLen );
+
+/**
+ * @brief Conditions one block of health tested TRNG data.
+ *
+ * Raw blocks failing the tests are dropped. trngpoolMAX_FAILURES of them in
+ * a row declare the TRNG failed. Caller holds xTrngPoolMutex once the pool
+ * is initialised.
+ *
+ * @param pucBlock filled with trngpoolBLOCK_LEN bytes.
+ *
+ * @return NO_ERROR on success or error code
+ */
+static int32_t prvTrngPoolCondition( uint8_t *pucBlock );
+
+/**
+ * @brief Conditions one block and adds it to the pool.
+ *
+ * @return NO_ERROR on success or error code
+ */
+static int32_t prvTrngPoolRefill( void );
+
+/**
+ * @brief Refill task. Tops the pool up when woken by a reader or every
+ * trngpoolREFILL_PERIOD_MS.
+ *
+ * @param pvArg unused.
+ *
+ * @return void
+ */
+static void prvTrngPoolTask( void *pvArg );
+
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvTrngPoolHealth( const uint8_t *pucRaw, uint32_t ulLen )
+{
+    int32_t lResult = NO_ERROR;
+    uint32_t ulIndex;
+    uint8_t ucSample;
+
+    for( ulIndex = 0; ulIndex < ulLen; ulIndex++ )
+    {
+	ucSample = pucRaw[ulIndex];
+
+	/* Repetition count test */
+	if( ( ulTrngRctRun != 0 ) && ( ucSample == ucTrngRctLast ) )
+	{
+	    if( ++ulTrngRctRun >= trngpoolRCT_CUTOFF )
+	    {
+		xTrngPoolStats.ulRctFailures++;
+		ulTrngRctRun = 1;
+		lResult = COMMON_ERR_BAD_STATE;
+	    }
+	}
+	else
+	{
+	    ucTrngRctLast = ucSample;
+	    ulTrngRctRun = 1;
+	}
+
+	/* Adaptive proportion test, first sample of a window is the
+	 * reference */
+	if( ulTrngAptSeen == 0 )
+	{
+	    ucTrngAptRef = ucSample;
+	    ulTrngAptHits = 1;
+	}
+	else if( ( ucSample == ucTrngAptRef ) &&
+		( ++ulTrngAptHits >= trngpoolAPT_CUTOFF ) )
+	{
+	    xTrngPoolStats.ulAptFailures++;
+	    ulTrngAptSeen = 0;
+	    lResult = COMMON_ERR_BAD_STATE;
+	    continue;
+	}
+	if( ++ulTrngAptSeen == trngpoolAPT_WINDOW )
+	{
+	    ulTrngAptSeen = 0;
+	}
+    }
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvTrngPoolCondition( uint8_t *pucBlock )
+{
+    uint32_t ulRaw[trngpoolRAW_WORDS];
+    uint32_t ulTry;
+    int32_t lResult = COMMON_ERR_BAD_STATE;
+
+    if( ulTrngPoolFailed )
+    {
+	return COMMON_ERR_BAD_STATE;
+    }
+
+    for( ulTry = 0; ulTry < trngpoolMAX_FAILURES; ulTry++ )
+    {
+	lResult = (int32_t) ulTrngReadRaw( ulRaw, trngpoolRAW_WORDS );
+	if( lResult != NO_ERROR )
+	{
+	    break;
+	}
+	lResult = prvTrngPoolHealth( (const uint8_t *) ulRaw, sizeof(ulRaw) );
+	if( lResult == NO_ERROR )
+	{
+	    /* 640 raw bits at 4 bits per byte give 320 bits of entropy,
+	     * enough for a full entropy 256 bit output */
+	    if( ucl_sha256( pucBlock, (uint8_t *) ulRaw, sizeof(ulRaw) )
+		    != UCL_OK )
+	    {
+		lResult = COMMON_ERR_FATAL_ERROR;
+	    }
+	    else
+	    {
+		xTrngPoolStats.ulBlocks++;
+	    }
+	    break;
+	}
+	debugERROR_PRINT("TRNG health test failed, block dropped\n");
+    }
+    memset( ulRaw, 0, sizeof(ulRaw) );
+
+    if( lResult == COMMON_ERR_BAD_STATE )
+    {
+	debugERROR_PRINT("TRNG failed its health tests\n");
+	ulTrngPoolFailed = 1;
+    }
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+static int32_t prvTrngPoolRefill( void )
+{
+    uint8_t ucBlock[trngpoolBLOCK_LEN];
+    uint32_t ulHead;
+    uint32_t ulIndex;
+    int32_t lResult;
+
+    /* Pool is filled before the mutex exists, from lTrngPoolInit */
+    if( xTrngPoolMutex != NULL )
+    {
+	xSemaphoreTake( xTrngPoolMutex, portMAX_DELAY );
+    }
+    lResult = prvTrngPoolCondition( ucBlock );
+    if( xTrngPoolMutex != NULL )
+    {
+	xSemaphoreGive( xTrngPoolMutex );
+    }
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+
+    taskENTER_CRITICAL( );
+    for( ulIndex = 0; ( ulIndex < trngpoolBLOCK_LEN ) &&
+	    ( ulTrngPoolCount < trngpoolSIZE ); ulIndex++ )
+    {
+	ulHead = ( ulTrngPoolTail + ulTrngPoolCount ) % trngpoolSIZE;
+	ucTrngPool[ulHead] = ucBlock[ulIndex];
+	ulTrngPoolCount++;
+    }
+    taskEXIT_CRITICAL( );
+
+    memset( ucBlock, 0, sizeof(ucBlock) );
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvTrngPoolTask( void *pvArg )
+{
+    (void) pvArg;
+
+    while( 1 )
+    {
+	(void) ulTaskNotifyTake( pdTRUE,
+		pdMS_TO_TICKS( trngpoolREFILL_PERIOD_MS ) );
+	while( ulTrngPoolLevel( ) <= ( trngpoolSIZE - trngpoolBLOCK_LEN ) )
+	{
+	    if( prvTrngPoolRefill( ) != NO_ERROR )
+	    {
+		break;
+	    }
+	}
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lTrngPoolInit( void )
+{
+    uint32_t ulRaw[trngTRNG_SINGLE_SHOT_READ_LEN];
+    uint32_t ulSamples;
+    int32_t lResult;
+
+    /* Start up tests, their samples are not used */
+    for( ulSamples = 0; ulSamples < trngpoolSTARTUP_SAMPLES;
+	    ulSamples += sizeof(ulRaw) )
+    {
+	lResult = (int32_t) ulTrngReadRaw( ulRaw, trngTRNG_SINGLE_SHOT_READ_LEN );
+	if( lResult == NO_ERROR )
+	{
+	    lResult = prvTrngPoolHealth( (const uint8_t *) ulRaw,
+		    sizeof(ulRaw) );
+	}
+	if( lResult != NO_ERROR )
+	{
+	    debugERROR_PRINT("TRNG start up test failed\n");
+	    ulTrngPoolFailed = 1;
+	    return lResult;
+	}
+    }
+
+    /* Tasks find a full pool once the scheduler starts */
+    while( ulTrngPoolCount <= ( trngpoolSIZE - trngpoolBLOCK_LEN ) )
+    {
+	lResult = prvTrngPoolRefill( );
+	if( lResult != NO_ERROR )
+	{
+	    return lResult;
+	}
+    }
+    xTrngPoolStats.ulLowestLevel = ulTrngPoolCount;
+
+    /* lTrngPoolGet uses the pool from here on */
+    xTrngPoolMutex = xSemaphoreCreateMutex( );
+    if( xTrngPoolMutex == NULL )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+
+    if( xTaskCreate( prvTrngPoolTask, "TrngPool",
+	    configSTACK_SIZE_TRNG_POOL_TSK, NULL, ePRIORITY_DEFUALT,
+	    &xTrngPoolTask ) != pdPASS )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lTrngPoolRead( uint8_t *pucBuf, uint32_t ulLen )
+{
+    uint32_t ulFirst;
+    uint32_t ulLevel;
+    int32_t lResult = NO_ERROR;
+
+    if( pucBuf == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( ulTrngPoolFailed )
+    {
+	return COMMON_ERR_BAD_STATE;
+    }
+
+    taskENTER_CRITICAL( );
+    if( ulTrngPoolCount < ulLen )
+    {
+	lResult = COMMON_ERR_IN_PROGRESS;
+    }
+    else
+    {
+	/* Bytes handed out are wiped from the pool */
+	ulFirst = trngpoolSIZE - ulTrngPoolTail;
+	if( ulFirst > ulLen )
+	{
+	    ulFirst = ulLen;
+	}
+	memcpy( pucBuf, &ucTrngPool[ulTrngPoolTail], ulFirst );
+	memset( &ucTrngPool[ulTrngPoolTail], 0, ulFirst );
+	memcpy( &pucBuf[ulFirst], ucTrngPool, ulLen - ulFirst );
+	memset( ucTrngPool, 0, ulLen - ulFirst );
+	ulTrngPoolTail = ( ulTrngPoolTail + ulLen ) % trngpoolSIZE;
+	ulTrngPoolCount -= ulLen;
+	xTrngPoolStats.ulPoolReads++;
+	if( ulTrngPoolCount < xTrngPoolStats.ulLowestLevel )
+	{
+	    xTrngPoolStats.ulLowestLevel = ulTrngPoolCount;
+	}
+    }
+    ulLevel = ulTrngPoolCount;
+    taskEXIT_CRITICAL( );
+
+    if( ( ulLevel < trngpoolLOW_WATER ) && ( xTrngPoolTask != NULL ) )
+    {
+	xTaskNotifyGive( xTrngPoolTask );
+    }
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+int32_t lTrngPoolGet( uint8_t *pucBuf, uint32_t ulLen )
+{
+    uint8_t ucBlock[trngpoolBLOCK_LEN];
+    uint32_t ulChunk;
+    int32_t lResult;
+
+    if( xTrngPoolMutex == NULL )
+    {
+	/* Pool not running yet, read the TRNG as before */
+	if( ( ulLen % trngWORD_TO_BYTE_FACT ) != 0 )
+	{
+	    return COMMON_ERR_INVAL;
+	}
+	return (int32_t) ulTrngReadRaw( (uint32_t *) pucBuf,
+		ulLen / trngWORD_TO_BYTE_FACT );
+    }
+
+    lResult = lTrngPoolRead( pucBuf, ulLen );
+    if( lResult != COMMON_ERR_IN_PROGRESS )
+    {
+	return lResult;
+    }
+
+    /* Pool is short, condition the request on the caller's time */
+    xSemaphoreTake( xTrngPoolMutex, portMAX_DELAY );
+    while( ulLen > 0 )
+    {
+	lResult = prvTrngPoolCondition( ucBlock );
+	if( lResult != NO_ERROR )
+	{
+	    break;
+	}
+	ulChunk = ( ulLen < trngpoolBLOCK_LEN ) ? ulLen : trngpoolBLOCK_LEN;
+	memcpy( pucBuf, ucBlock, ulChunk );
+	pucBuf += ulChunk;
+	ulLen -= ulChunk;
+    }
+    xTrngPoolStats.ulDirectReads++;
+    xSemaphoreGive( xTrngPoolMutex );
+
+    memset( ucBlock, 0, sizeof(ucBlock) );
+    return lResult;
+}
+/*---------------------------------------------------------------------------*/
+
+uint32_t ulTrngPoolLevel( void )
+{
+    uint32_t ulLevel;
+
+    taskENTER_CRITICAL( );
+    ulLevel = ulTrngPoolCount;
+    taskEXIT_CRITICAL( );
+    return ulLevel;
+}
+/*---------------------------------------------------------------------------*/
+
+void vTrngPoolGetStats( trngpoolStats_t *pxStats )
+{
+    if( pxStats == NULL )
+    {
+	return;
+    }
+    taskENTER_CRITICAL( );
+    memcpy( pxStats, &xTrngPoolStats, sizeof(trngpoolStats_t) );
+    taskEXIT_CRITICAL( );
+}
+/*---------------------------------------------------------------------------*/
+/* EOF */
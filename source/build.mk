@@ -87,3 +87,12 @@ AppSourceDir	+=	$(SrcAppDir) \
 			$(SrcPRNG) \
 			$(LeSrcDir) \
 			$(IntelSucCommSrcDir)
+
+##Host simulation build, the rules are in source/sim/Makefile
+ifeq ($(ORWL_TARGET),sim)
+include source/sim/build.mk
+ORWL_CONFIGS	+=	$(SIM_CONFIGS)
+AppIncludeDir	:=	$(SimHeadrDir) $(SimRtosIncludeDir) $(AppIncludeDir) \
+			$(SimLibIncludeDir)
+AppSourceDir	+=	$(SimSrcDir)
+endif
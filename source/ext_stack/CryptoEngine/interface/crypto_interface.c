@@ -40,16 +40,253 @@
 /* debug includes */
 #include <debug.h>
 
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+
 /* ecdh include */
 #include <mbedtls/ecdh.h>
 
 #include <crypto_interface.h>
 
-/* Global ecdh context */
-mbedtls_ecdh_context gxSrv;
+/* Curve group, loaded once and shared read only by the ECDH contexts */
+static mbedtls_ecp_group xCryptoGroup;
+
+/* ECDH contexts handed out by pxCryptoEcdhAcquire() */
+static cryptoEcdhCtx_t xCryptoEcdhPool[cryptoECDH_POOL_SIZE];
+
+/**
+ * @brief Set up the group of an ECDH context
+ *
+ * The first group made of static constants, including the precomputed comb
+ * table of the generator, is kept and shallow copied into later contexts,
+ * which neither reload nor recompute it. Groups owning allocated values are
+ * loaded into each context.
+ *
+ * @param ucCurveId curve ID
+ * @param pxGrp     group of the ECDH context, initialized
+ *
+ * @return NO_ERROR on success, mbedtls error code on failure
+ */
+static uint32_t prvCryptoGroupSetup( uint8_t ucCurveId, mbedtls_ecp_group *pxGrp );
+
+/**
+ * @brief Wipe memory holding key material
+ *
+ * Writes through a volatile pointer so the compiler can't drop the stores.
+ *
+ * @param pvBuf buffer to wipe
+ * @param xLen  length of the buffer
+ *
+ * @return void
+ */
+static void prvCryptoZeroize( void *pvBuf, size_t xLen );
+
+/**
+ * @brief Generate an X25519 key pair in an ECDH context
+ *
+ * @param pxCtx       ECDH context of the session
+ * @param pucDHPubKey Pointer to the public key buffer
+ * @param pulLEN      Pointer to the length of the public key
+ *
+ * @return NO_ERROR on success, error code on failure
+ */
+static uint32_t prvCryptoX25519KeyGen( cryptoEcdhCtx_t *pxCtx,
+				       uint8_t *pucDHPubKey, uint32_t *pulLEN );
+
+/**
+ * @brief Derive the shared secret key from the peer's X25519 public key
+ *
+ * Rejects peer keys of small order, which give an all zero secret.
+ *
+ * @param pxCtx        ECDH context holding the X25519 private key
+ * @param pucDHPubKey  Pointer to the peer's public key
+ * @param pucPubKeyLen Peer's public key length input and shared secret
+ *                     key length output
+ * @param pucDataBuf   Pointer to the shared secret key buffer
+ *
+ * @return NO_ERROR on success, error code on failure
+ */
+static uint32_t prvCryptoX25519GenSSK( cryptoEcdhCtx_t *pxCtx,
+				       uint8_t *pucDHPubKey,
+				       uint8_t *pucPubKeyLen,
+				       uint8_t *pucDataBuf );
+/*---------------------------------------------------------------------------*/
+
+static uint32_t prvCryptoGroupSetup( uint8_t ucCurveId, mbedtls_ecp_group *pxGrp )
+{
+    uint32_t ulStatus;
+    uint32_t ulShared;
+
+    taskENTER_CRITICAL();
+    ulShared = ( xCryptoGroup.id == (mbedtls_ecp_group_id) ucCurveId );
+    if( ulShared )
+    {
+	memcpy( pxGrp, &xCryptoGroup, sizeof(mbedtls_ecp_group) );
+    }
+    taskEXIT_CRITICAL();
+    if( ulShared )
+    {
+	return NO_ERROR;
+    }
+
+    if((ulStatus=mbedtls_ecp_group_load( pxGrp, ucCurveId )) != NO_ERROR )
+    {
+	return ulStatus;
+    }
+
+    /* Groups owning allocated values can't be shared */
+    if( pxGrp->h == 1 )
+    {
+	taskENTER_CRITICAL();
+	if( xCryptoGroup.id == MBEDTLS_ECP_DP_NONE )
+	{
+	    memcpy( &xCryptoGroup, pxGrp, sizeof(mbedtls_ecp_group) );
+	}
+	taskEXIT_CRITICAL();
+    }
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvCryptoZeroize( void *pvBuf, size_t xLen )
+{
+    volatile uint8_t *pucBuf = pvBuf;
+
+    while( xLen-- )
+    {
+	*pucBuf++ = 0;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static uint32_t prvCryptoX25519KeyGen( cryptoEcdhCtx_t *pxCtx,
+				       uint8_t *pucDHPubKey, uint32_t *pulLEN )
+{
+    uint32_t ulStatus;
+
+    if((ulStatus=ucTrue_Rand( NULL, pxCtx->ucX25519Key,
+			      cryptoX25519_KEY_LEN )) != NO_ERROR )
+    {
+	debugERROR_PRINT(" Failed to generate X25519 private key");
+	prvCryptoZeroize( pxCtx->ucX25519Key, cryptoX25519_KEY_LEN );
+	return ulStatus;
+    }
+    vCryptoX25519Public( pucDHPubKey, pxCtx->ucX25519Key );
+    *pulLEN = cryptoX25519_KEY_LEN;
+    pxCtx->ulX25519 = pdTRUE;
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+static uint32_t prvCryptoX25519GenSSK( cryptoEcdhCtx_t *pxCtx,
+				       uint8_t *pucDHPubKey,
+				       uint8_t *pucPubKeyLen,
+				       uint8_t *pucDataBuf )
+{
+    uint32_t ulStatus;
+    uint8_t ucSecret[cryptoX25519_KEY_LEN];
+    uint8_t ucSHA1_SSK[cryptoSHA1_LEN];
+    uint8_t ucAcc = 0;
+    uint32_t ulIndex;
+
+    if( *pucPubKeyLen != cryptoX25519_KEY_LEN )
+    {
+	debugERROR_PRINT(" Invalid X25519 public key length");
+	return COMMON_ERR_INVAL;
+    }
+
+    vCryptoX25519( ucSecret, pxCtx->ucX25519Key, pucDHPubKey );
+    /* The key pair is used for a single agreement */
+    prvCryptoZeroize( pxCtx->ucX25519Key, cryptoX25519_KEY_LEN );
+    pxCtx->ulX25519 = pdFALSE;
 
-/* Global pseudo random generator info structure */
-cryptoRnd_pseudo_info_t gxrnd_info;
+    for( ulIndex = 0; ulIndex < cryptoX25519_KEY_LEN; ulIndex++ )
+    {
+	ucAcc |= ucSecret[ulIndex];
+    }
+    if( ucAcc == 0 )
+    {
+	debugERROR_PRINT(" Peers X25519 public key has small order");
+	return COMMON_ERR_INVAL;
+    }
+
+    ulStatus=ucl_sha1( ucSHA1_SSK, ucSecret, cryptoX25519_KEY_LEN );
+    prvCryptoZeroize( ucSecret, sizeof(ucSecret) );
+    if(ulStatus != NO_ERROR)
+    {
+	debugERROR_PRINT(" Failed to generate the SHA1 hash");
+	prvCryptoZeroize( ucSHA1_SSK, sizeof(ucSHA1_SSK) );
+	return ulStatus;
+    }
+
+    /* Same 3DES key layout as the NIST curve secret */
+    memcpy( pucDataBuf, ucSHA1_SSK, cryptoSHA1_LEN );
+    memcpy( pucDataBuf + cryptoSHA1_LEN, ucSHA1_SSK,
+	    cryto3DES_KEY_SIZE - cryptoSHA1_LEN );
+    *pucPubKeyLen = cryto3DES_KEY_SIZE;
+    prvCryptoZeroize( ucSHA1_SSK, sizeof(ucSHA1_SSK) );
+    return NO_ERROR;
+}
+/*---------------------------------------------------------------------------*/
+
+void vCryptoEcdhInit( cryptoEcdhCtx_t *pxCtx )
+{
+    if( pxCtx == NULL )
+    {
+	return;
+    }
+    memset( pxCtx, 0, sizeof(cryptoEcdhCtx_t) );
+    mbedtls_ecdh_init( &pxCtx->xEcdh );
+}
+/*---------------------------------------------------------------------------*/
+
+cryptoEcdhCtx_t *pxCryptoEcdhAcquire( void )
+{
+    cryptoEcdhCtx_t *pxCtx = NULL;
+    uint32_t ulIndex;
+
+    taskENTER_CRITICAL();
+    for( ulIndex = 0; ulIndex < cryptoECDH_POOL_SIZE; ulIndex++ )
+    {
+	if( !xCryptoEcdhPool[ulIndex].ulInUse )
+	{
+	    pxCtx = &xCryptoEcdhPool[ulIndex];
+	    pxCtx->ulInUse = pdTRUE;
+	    break;
+	}
+    }
+    taskEXIT_CRITICAL();
+
+    if( pxCtx == NULL )
+    {
+	debugERROR_PRINT(" No free ECDH context");
+	return NULL;
+    }
+    mbedtls_ecdh_init( &pxCtx->xEcdh );
+    pxCtx->ulPooled = pdTRUE;
+    return pxCtx;
+}
+/*---------------------------------------------------------------------------*/
+
+void vCryptoEcdhRelease( cryptoEcdhCtx_t *pxCtx )
+{
+    if( pxCtx == NULL )
+    {
+	return;
+    }
+    mbedtls_ecdh_free( &pxCtx->xEcdh );
+    prvCryptoZeroize( &pxCtx->xEcdh, sizeof(mbedtls_ecdh_context) );
+    prvCryptoZeroize( pxCtx->ucX25519Key, cryptoX25519_KEY_LEN );
+    pxCtx->ulX25519 = pdFALSE;
+    if( pxCtx->ulPooled )
+    {
+	taskENTER_CRITICAL();
+	pxCtx->ulInUse = pdFALSE;
+	taskEXIT_CRITICAL();
+    }
+}
+/*---------------------------------------------------------------------------*/
 
 uint8_t ucTrue_Rand( void *pvRNGState, uint8_t *pucOutput, size_t xLen )
 {
@@ -78,25 +315,41 @@ uint8_t ucTrue_Rand( void *pvRNGState, uint8_t *pucOutput, size_t xLen )
 }
 /*---------------------------------------------------------------------------*/
 
-uint32_t ulCryptoEcdh_PublicKeyGen(uint8_t ucCurveId, uint8_t *pucDHPubKey, uint32_t *pulLEN)
+uint32_t ulCryptoEcdh_PublicKeyGen(cryptoEcdhCtx_t *pxCtx, uint8_t ucCurveId,
+				   uint8_t *pucDHPubKey, uint32_t *pulLEN)
 {
     uint32_t ulStatus;
     uint8_t ucBuf[cryptoMAX_BUF_LEN];
     size_t xlen;
 
-    mbedtls_ecdh_init( &gxSrv );
-    memset( &gxrnd_info, 0x00, sizeof( cryptoRnd_pseudo_info_t ) );
+    if( pxCtx == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
 
-    /* Get type of elliptic curve used */
-    if((ulStatus=mbedtls_ecp_group_load( &gxSrv.grp, ucCurveId )) != NO_ERROR )
+    if( ucCurveId == cryptoCURVE_X25519 )
     {
-        debugERROR_PRINT(" Failed to load Elliptical Curve Parameter");
-        return ulStatus;
+	return prvCryptoX25519KeyGen( pxCtx, pucDHPubKey, pulLEN );
+    }
+    prvCryptoZeroize( pxCtx->ucX25519Key, cryptoX25519_KEY_LEN );
+    pxCtx->ulX25519 = pdFALSE;
+
+    /* Get type of elliptic curve used, a context keeps its group */
+    if( pxCtx->xEcdh.grp.id != (mbedtls_ecp_group_id) ucCurveId )
+    {
+	mbedtls_ecdh_free( &pxCtx->xEcdh );
+	mbedtls_ecdh_init( &pxCtx->xEcdh );
+	if((ulStatus=prvCryptoGroupSetup( ucCurveId, &pxCtx->xEcdh.grp )) != NO_ERROR )
+	{
+	    debugERROR_PRINT(" Failed to load Elliptical Curve Parameter");
+	    return ulStatus;
+	}
     }
 
     /* Generate public keys and generates the data in ucBuf in Little Endian */
-    if((ulStatus=mbedtls_ecdh_make_params( &gxSrv, &xlen, ucBuf, cryptoMAX_BUF_LEN,
-                                           &ucTrue_Rand, &gxrnd_info )) != NO_ERROR )
+    if((ulStatus=mbedtls_ecdh_make_params( &pxCtx->xEcdh, &xlen, ucBuf,
+					   cryptoMAX_BUF_LEN, &ucTrue_Rand,
+					   NULL )) != NO_ERROR )
     {
         debugERROR_PRINT(" Failed to generate ecdh parameters");
         return ulStatus;
@@ -116,7 +369,8 @@ uint32_t ulCryptoEcdh_PublicKeyGen(uint8_t ucCurveId, uint8_t *pucDHPubKey, uint
 }
 /*---------------------------------------------------------------------------*/
 
-uint32_t ulCryptoEcdh_GenSSK(uint8_t *pucDHPubKey, uint8_t *pucPubKeyLen, uint8_t *pucDataBuf)
+uint32_t ulCryptoEcdh_GenSSK(cryptoEcdhCtx_t *pxCtx, uint8_t *pucDHPubKey,
+			     uint8_t *pucPubKeyLen, uint8_t *pucDataBuf)
 {
     uint32_t ulStatus;
     uint8_t ucSHA1_SSK[cryto3DES_KEY_SIZE];
@@ -124,12 +378,23 @@ uint32_t ulCryptoEcdh_GenSSK(uint8_t *pucDHPubKey, uint8_t *pucPubKeyLen, uint8_
     uint8_t ucTmpBuf[cryptoBUF_LEN];
     size_t xlen;
 
+    if( pxCtx == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+
+    if( pxCtx->ulX25519 )
+    {
+	return prvCryptoX25519GenSSK( pxCtx, pucDHPubKey, pucPubKeyLen,
+				      pucDataBuf );
+    }
+
     xlen=*pucPubKeyLen;
     ucTmpBuf[0]=xlen;
     /* Data buffer should contain Length of public key and public key */
     memcpy(&ucTmpBuf[1],pucDHPubKey,xlen);
     xlen+=1;
-    if((ulStatus=mbedtls_ecdh_read_public( &gxSrv, ucTmpBuf, xlen )) != NO_ERROR )
+    if((ulStatus=mbedtls_ecdh_read_public( &pxCtx->xEcdh, ucTmpBuf, xlen )) != NO_ERROR )
     {
         debugERROR_PRINT(" Failed to read Peers Public Key");
         return ulStatus;
@@ -137,10 +402,12 @@ uint32_t ulCryptoEcdh_GenSSK(uint8_t *pucDHPubKey, uint8_t *pucPubKeyLen, uint8_
 
     /* Generate the shared secret key and update the parameters accordingly*/
     /* Length of the key will be updated on xlen */
-    if((ulStatus=mbedtls_ecdh_calc_secret( &gxSrv, &xlen, ucBuf, cryptoMAX_BUF_LEN,
-                                         &ucTrue_Rand, &gxrnd_info))!= NO_ERROR )
+    if((ulStatus=mbedtls_ecdh_calc_secret( &pxCtx->xEcdh, &xlen, ucBuf,
+					   cryptoMAX_BUF_LEN, &ucTrue_Rand,
+					   NULL))!= NO_ERROR )
     {
         debugERROR_PRINT(" Failed to calculate the secret");
+        prvCryptoZeroize( ucBuf, sizeof(ucBuf) );
         return ulStatus;
     }
 
@@ -150,17 +417,22 @@ uint32_t ulCryptoEcdh_GenSSK(uint8_t *pucDHPubKey, uint8_t *pucPubKeyLen, uint8_
     for(i=0;i<xlen;i++)
         debugPRINT(" 0x%02x",ucBuf[i]);
 #endif
-    if((ulStatus=ucl_sha1(ucSHA1_SSK,ucBuf,xlen))!= NO_ERROR)
+    ulStatus=ucl_sha1(ucSHA1_SSK,ucBuf,xlen);
+    prvCryptoZeroize( ucBuf, sizeof(ucBuf) );
+    if(ulStatus != NO_ERROR)
     {
         debugERROR_PRINT(" Failed to generate the SHA1 hash");
+        prvCryptoZeroize( ucSHA1_SSK, sizeof(ucSHA1_SSK) );
         return ulStatus;
     }
 
     memcpy(pucDataBuf,ucSHA1_SSK,cryptoSHA1_LEN);
     memcpy(pucDataBuf+cryptoSHA1_LEN,ucSHA1_SSK,xlen-cryptoSHA1_LEN);
     *pucPubKeyLen = xlen;
+    prvCryptoZeroize( ucSHA1_SSK, sizeof(ucSHA1_SSK) );
 
-    mbedtls_ecdh_free( &gxSrv );
+    /* The secret is hashed out, drop it from the context */
+    mbedtls_mpi_free( &pxCtx->xEcdh.z );
     return ulStatus;
 }
 /*---------------------------------------------------------------------------*/
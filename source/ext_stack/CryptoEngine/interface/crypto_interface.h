@@ -40,13 +40,17 @@
 #include <trng.h>
 #include <ucl/ucl_types.h>
 #include <ucl/ucl_sha1.h>
+#include <mbedtls/ecdh.h>
+#include <crypto_x25519.h>
 
 #define cryptoCURVE_ID          (1)         /**< curve id for 192-bits NIST curve */
+#define cryptoCURVE_X25519      (MBEDTLS_ECP_DP_CURVE25519) /**< curve id for X25519 */
 #define cryptoMAX_BUF_LEN       (1000)      /**< Max Buffer Length */
 #define cryptoBUF_LEN           (64)        /**< Buffer length */
 #define cryto3DES_KEY_SIZE      (24)        /**< Key length used in 3DES */
 #define cryptoHEADERLENGTH      (4)         /**< Tls server header length */
 #define cryptoSHA1_LEN          (20)        /**< Length of SHA1 Output */
+#define cryptoECDH_POOL_SIZE    (2)         /**< ECDH contexts in the pool */
 
 /**
  * Info structure for the pseudo random function
@@ -61,29 +65,75 @@ typedef struct
     uint32_t v0, v1;
 } cryptoRnd_pseudo_info_t;
 
+/**
+ * ECDH key agreement context, one per session. Either owned by the caller
+ * and set up with vCryptoEcdhInit() or taken from the pool with
+ * pxCryptoEcdhAcquire(); vCryptoEcdhRelease() wipes both kinds.
+ */
+typedef struct
+{
+    mbedtls_ecdh_context xEcdh;	/**< key pair, peer key and shared secret */
+    uint8_t ucX25519Key[cryptoX25519_KEY_LEN];	/**< X25519 private key */
+    uint32_t ulX25519;		/**< set while the context holds an X25519 key */
+    uint32_t ulPooled;		/**< set for contexts of the pool */
+    uint32_t ulInUse;		/**< set while a pool context is handed out */
+} cryptoEcdhCtx_t;
+
 extern unsigned char g[50];
 
+/**
+ * @brief This function sets up a caller owned ECDH context.
+ *
+ * @param pxCtx context to set up
+ *
+ * @return void
+ */
+void vCryptoEcdhInit( cryptoEcdhCtx_t *pxCtx );
+
+/**
+ * @brief This function takes a context from the ECDH pool.
+ *
+ * @return context, NULL if all cryptoECDH_POOL_SIZE are in use
+ */
+cryptoEcdhCtx_t *pxCryptoEcdhAcquire( void );
+
+/**
+ * @brief This function frees and wipes an ECDH context, the private key and
+ * shared secret included, and gives pool contexts back.
+ *
+ * @param pxCtx context to release, may be NULL
+ *
+ * @return void
+ */
+void vCryptoEcdhRelease( cryptoEcdhCtx_t *pxCtx );
+
 /**
  * @brief This function used to generate the public key.
  *
  * It takes elliptical curve parameter as input and set all ecp parameters.
- * Generates public key and the private key
+ * Generates public key and the private key. The curve group is loaded once
+ * and shared read only between the contexts. cryptoCURVE_X25519 runs on the
+ * fixed field arithmetic of vCryptoX25519() instead of the mbedtls group,
+ * its public key is the 32 byte u-coordinate.
  *
+ * @param pxCtx       ECDH context of the session
  * @param ucCurveId   Curve ID
  * @param pucDHPubKey Pointer to ECDH public key Buffer
  * @param pulLEN      Pointer to Length of the Public key
  *
  * @return uint32_t status of public key generation
  */
-uint32_t ulCryptoEcdh_PublicKeyGen(uint8_t ucCurveId, uint8_t *pucDHPubKey,
-					uint32_t *pulLEN);
+uint32_t ulCryptoEcdh_PublicKeyGen(cryptoEcdhCtx_t *pxCtx, uint8_t ucCurveId,
+				   uint8_t *pucDHPubKey, uint32_t *pulLEN);
 
 /**
  * @brief This function used to generate the shared secret key.
  *
  * This function generates the shared secret key from the peer's public key.
- * And Encrypt the SSK using SHA1.
+ * And Encrypt the SSK using SHA1. The X25519 secret is reduced to a
+ * cryto3DES_KEY_SIZE key the same way.
  *
+ * @param pxCtx        ECDH context given to ulCryptoEcdh_PublicKeyGen()
  * @param pucDHPubKey  Pointer to ECDH public key Buffer
  * @param pucPubKeyLen Used as ECDH public key Length input and Shared Secret
  *                     Key Length Output
@@ -91,7 +141,8 @@ uint32_t ulCryptoEcdh_PublicKeyGen(uint8_t ucCurveId, uint8_t *pucDHPubKey,
  *
  * @return uint32_t status of public key generation
  */
-uint32_t ulCryptoEcdh_GenSSK(uint8_t *pucDHPubKey, uint8_t *pucPubKeyLen, uint8_t *pucDataBuf);
+uint32_t ulCryptoEcdh_GenSSK(cryptoEcdhCtx_t *pxCtx, uint8_t *pucDHPubKey,
+			     uint8_t *pucPubKeyLen, uint8_t *pucDataBuf);
 
 /**
  * @brief This function generates random number using TRNG.
@@ -0,0 +1,571 @@
+ /**===========================================================================
+ * @file crypto_x25519.c
+ *
+ * @brief This file contains a constant time X25519 key agreement (RFC 7748)
+ * over fixed 255-bit field elements
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stdint.h>
+#include <string.h>
+
+#include <crypto_x25519.h>
+
+#define cryptoX25519_LIMBS      (10)        /**< Limbs of a field element */
+#define cryptoX25519_A24        (121665)    /**< (A - 2) / 4 of curve25519 */
+#define cryptoX25519_BITS       (255)       /**< Bits of the clamped scalar */
+
+/**
+ * Element of GF(2^255 - 19) in radix 2^25.5: even limbs hold 26 bits, odd
+ * limbs 25 bits. Limbs are signed, carried elements stay within 2^25 in
+ * magnitude and sums or differences of two of them are valid multiplication
+ * inputs, so the ladder needs no carry after an addition.
+ */
+typedef struct
+{
+    int32_t lLimb[cryptoX25519_LIMBS];	/**< limbs, least significant first */
+} cryptoX25519Fe_t;
+
+/** Bit position of each limb, last entry is the field size */
+static const uint8_t ucCryptoX25519Pos[cryptoX25519_LIMBS + 1] = {
+    0, 26, 51, 77, 102, 128, 153, 179, 204, 230, 255
+};
+
+/**
+ * @brief Width in bits of a limb
+ *
+ * @param ulLimb limb index
+ *
+ * @return 26 for even limbs, 25 for odd limbs
+ */
+static inline uint32_t prvX25519Width( uint32_t ulLimb );
+
+/**
+ * @brief Carry 64 bit limb accumulators into a field element
+ *
+ * The top carry wraps into the first limb multiplied by 19, as
+ * 2^255 = 19 mod p.
+ *
+ * @param pxH   carried field element
+ * @param pllT  accumulators, overwritten
+ *
+ * @return void
+ */
+static void prvX25519Carry( cryptoX25519Fe_t *pxH, int64_t *pllT );
+
+/**
+ * @brief Multiply two field elements
+ *
+ * @param pxH result, may alias an input
+ * @param pxF first factor
+ * @param pxG second factor
+ *
+ * @return void
+ */
+static void prvX25519Mul( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			  const cryptoX25519Fe_t *pxG );
+
+/**
+ * @brief Square a field element
+ *
+ * Computes each cross product once, about half the multiplications of
+ * prvX25519Mul().
+ *
+ * @param pxH result, may alias the input
+ * @param pxF element to square
+ *
+ * @return void
+ */
+static void prvX25519Sqr( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF );
+
+/**
+ * @brief Square a field element repeatedly
+ *
+ * @param pxH result, may alias the input
+ * @param pxF element to square
+ * @param ulCount number of squarings, at least one
+ *
+ * @return void
+ */
+static void prvX25519SqrN( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			   uint32_t ulCount );
+
+/**
+ * @brief Multiply a field element by a small constant
+ *
+ * @param pxH result
+ * @param pxF element
+ * @param lC constant, below 2^17
+ *
+ * @return void
+ */
+static void prvX25519MulSmall( cryptoX25519Fe_t *pxH,
+			       const cryptoX25519Fe_t *pxF, int32_t lC );
+
+/**
+ * @brief Add two field elements, without carry
+ *
+ * @param pxH result
+ * @param pxF first term
+ * @param pxG second term
+ *
+ * @return void
+ */
+static void prvX25519Add( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			  const cryptoX25519Fe_t *pxG );
+
+/**
+ * @brief Subtract two field elements, without carry
+ *
+ * @param pxH result
+ * @param pxF minuend
+ * @param pxG subtrahend
+ *
+ * @return void
+ */
+static void prvX25519Sub( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			  const cryptoX25519Fe_t *pxG );
+
+/**
+ * @brief Invert a field element as z^(p - 2)
+ *
+ * Fixed addition chain of 254 squarings and 11 multiplications.
+ *
+ * @param pxH result
+ * @param pxZ element to invert, zero gives zero
+ *
+ * @return void
+ */
+static void prvX25519Invert( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxZ );
+
+/**
+ * @brief Swap two field elements when ulSwap is set, without branching
+ *
+ * @param pxF first element
+ * @param pxG second element
+ * @param ulSwap 1 to swap, 0 to keep
+ *
+ * @return void
+ */
+static void prvX25519Cswap( cryptoX25519Fe_t *pxF, cryptoX25519Fe_t *pxG,
+			    uint32_t ulSwap );
+
+/**
+ * @brief Decode a little endian u-coordinate, ignoring the top bit
+ *
+ * @param pxH decoded element
+ * @param pucIn 32 byte encoding
+ *
+ * @return void
+ */
+static void prvX25519FromBytes( cryptoX25519Fe_t *pxH, const uint8_t *pucIn );
+
+/**
+ * @brief Encode a field element fully reduced, little endian
+ *
+ * @param pucOut 32 byte encoding
+ * @param pxF carried element
+ *
+ * @return void
+ */
+static void prvX25519ToBytes( uint8_t *pucOut, const cryptoX25519Fe_t *pxF );
+
+/**
+ * @brief Wipe memory holding key material
+ *
+ * @param pvBuf buffer to wipe
+ * @param xLen  length of the buffer
+ *
+ * @return void
+ */
+static void prvX25519Zeroize( void *pvBuf, size_t xLen );
+/*---------------------------------------------------------------------------*/
+
+static inline uint32_t prvX25519Width( uint32_t ulLimb )
+{
+    return 26 - ( ulLimb & 1 );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Carry( cryptoX25519Fe_t *pxH, int64_t *pllT )
+{
+    uint32_t ulIndex;
+    uint32_t ulWidth;
+    int64_t llC;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	/* rounded carry, leaves the limb within +-2^(width - 1) */
+	ulWidth = prvX25519Width( ulIndex );
+	llC = ( pllT[ulIndex] + ( (int64_t) 1 << ( ulWidth - 1 ) ) ) >> ulWidth;
+	pllT[ulIndex] -= llC * ( (int64_t) 1 << ulWidth );
+	if( ulIndex < cryptoX25519_LIMBS - 1 )
+	{
+	    pllT[ulIndex + 1] += llC;
+	}
+	else
+	{
+	    pllT[0] += llC * 19;
+	}
+    }
+    llC = ( pllT[0] + ( (int64_t) 1 << 25 ) ) >> 26;
+    pllT[0] -= llC * ( (int64_t) 1 << 26 );
+    pllT[1] += llC;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	pxH->lLimb[ulIndex] = (int32_t) pllT[ulIndex];
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Mul( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			  const cryptoX25519Fe_t *pxG )
+{
+    int64_t llT[cryptoX25519_LIMBS] = {0};
+    int32_t lG19[cryptoX25519_LIMBS];
+    int32_t lF[2];
+    uint32_t ulI, ulJ;
+
+    for( ulJ = 0; ulJ < cryptoX25519_LIMBS; ulJ++ )
+    {
+	lG19[ulJ] = pxG->lLimb[ulJ] * 19;
+    }
+
+    for( ulI = 0; ulI < cryptoX25519_LIMBS; ulI++ )
+    {
+	/* two odd limbs meet half a bit above their limb position */
+	lF[0] = pxF->lLimb[ulI];
+	lF[1] = pxF->lLimb[ulI] * (int32_t) ( 1 + ( ulI & 1 ) );
+
+	for( ulJ = 0; ulJ < cryptoX25519_LIMBS - ulI; ulJ++ )
+	{
+	    llT[ulI + ulJ] += (int64_t) lF[ulJ & 1] * pxG->lLimb[ulJ];
+	}
+	for( ; ulJ < cryptoX25519_LIMBS; ulJ++ )
+	{
+	    llT[ulI + ulJ - cryptoX25519_LIMBS] += (int64_t) lF[ulJ & 1] * lG19[ulJ];
+	}
+    }
+    prvX25519Carry( pxH, llT );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Sqr( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF )
+{
+    int64_t llT[cryptoX25519_LIMBS] = {0};
+    int64_t llP;
+    int32_t lF19[cryptoX25519_LIMBS];
+    uint32_t ulI, ulJ;
+
+    for( ulJ = 0; ulJ < cryptoX25519_LIMBS; ulJ++ )
+    {
+	lF19[ulJ] = pxF->lLimb[ulJ] * 19;
+    }
+
+    for( ulI = 0; ulI < cryptoX25519_LIMBS; ulI++ )
+    {
+	for( ulJ = ulI; ulJ < cryptoX25519_LIMBS; ulJ++ )
+	{
+	    if( ulI + ulJ < cryptoX25519_LIMBS )
+	    {
+		llP = (int64_t) pxF->lLimb[ulI] * pxF->lLimb[ulJ];
+	    }
+	    else
+	    {
+		llP = (int64_t) pxF->lLimb[ulI] * lF19[ulJ];
+	    }
+	    /* cross products appear twice */
+	    if( ulI != ulJ )
+	    {
+		llP += llP;
+	    }
+	    if( ulI & ulJ & 1 )
+	    {
+		llP += llP;
+	    }
+	    llT[( ulI + ulJ ) % cryptoX25519_LIMBS] += llP;
+	}
+    }
+    prvX25519Carry( pxH, llT );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519SqrN( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			   uint32_t ulCount )
+{
+    prvX25519Sqr( pxH, pxF );
+    while( --ulCount )
+    {
+	prvX25519Sqr( pxH, pxH );
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519MulSmall( cryptoX25519Fe_t *pxH,
+			       const cryptoX25519Fe_t *pxF, int32_t lC )
+{
+    int64_t llT[cryptoX25519_LIMBS];
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	llT[ulIndex] = (int64_t) pxF->lLimb[ulIndex] * lC;
+    }
+    prvX25519Carry( pxH, llT );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Add( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			  const cryptoX25519Fe_t *pxG )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	pxH->lLimb[ulIndex] = pxF->lLimb[ulIndex] + pxG->lLimb[ulIndex];
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Sub( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxF,
+			  const cryptoX25519Fe_t *pxG )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	pxH->lLimb[ulIndex] = pxF->lLimb[ulIndex] - pxG->lLimb[ulIndex];
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Invert( cryptoX25519Fe_t *pxH, const cryptoX25519Fe_t *pxZ )
+{
+    cryptoX25519Fe_t xZ2, xZ9, xZ11, xZ5, xZ10, xZ20, xZ50, xZ100, xT;
+
+    /* xZn holds z^(2^n - 1) */
+    prvX25519Sqr( &xZ2, pxZ );
+    prvX25519SqrN( &xT, &xZ2, 2 );
+    prvX25519Mul( &xZ9, &xT, pxZ );
+    prvX25519Mul( &xZ11, &xZ9, &xZ2 );
+    prvX25519Sqr( &xT, &xZ11 );
+    prvX25519Mul( &xZ5, &xT, &xZ9 );
+    prvX25519SqrN( &xT, &xZ5, 5 );
+    prvX25519Mul( &xZ10, &xT, &xZ5 );
+    prvX25519SqrN( &xT, &xZ10, 10 );
+    prvX25519Mul( &xZ20, &xT, &xZ10 );
+    prvX25519SqrN( &xT, &xZ20, 20 );
+    prvX25519Mul( &xT, &xT, &xZ20 );
+    prvX25519SqrN( &xT, &xT, 10 );
+    prvX25519Mul( &xZ50, &xT, &xZ10 );
+    prvX25519SqrN( &xT, &xZ50, 50 );
+    prvX25519Mul( &xZ100, &xT, &xZ50 );
+    prvX25519SqrN( &xT, &xZ100, 100 );
+    prvX25519Mul( &xT, &xT, &xZ100 );
+    prvX25519SqrN( &xT, &xT, 50 );
+    prvX25519Mul( &xT, &xT, &xZ50 );
+    /* 2^255 - 32 + 11 = p - 2 */
+    prvX25519SqrN( &xT, &xT, 5 );
+    prvX25519Mul( pxH, &xT, &xZ11 );
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Cswap( cryptoX25519Fe_t *pxF, cryptoX25519Fe_t *pxG,
+			    uint32_t ulSwap )
+{
+    int32_t lMask = -(int32_t) ulSwap;
+    int32_t lX;
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	lX = lMask & ( pxF->lLimb[ulIndex] ^ pxG->lLimb[ulIndex] );
+	pxF->lLimb[ulIndex] ^= lX;
+	pxG->lLimb[ulIndex] ^= lX;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519FromBytes( cryptoX25519Fe_t *pxH, const uint8_t *pucIn )
+{
+    uint64_t ullV;
+    uint32_t ulIndex, ulByte, ulCount;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	/* a limb spans at most five bytes */
+	ulByte = ucCryptoX25519Pos[ulIndex] >> 3;
+	ullV = 0;
+	for( ulCount = 0; ( ulCount < 5 ) &&
+		( ulByte + ulCount < cryptoX25519_KEY_LEN ); ulCount++ )
+	{
+	    ullV |= (uint64_t) pucIn[ulByte + ulCount] << ( 8 * ulCount );
+	}
+	ullV >>= ucCryptoX25519Pos[ulIndex] & 7;
+	pxH->lLimb[ulIndex] = (int32_t) ( ullV &
+		( ( (uint64_t) 1 << prvX25519Width( ulIndex ) ) - 1 ) );
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519ToBytes( uint8_t *pucOut, const cryptoX25519Fe_t *pxF )
+{
+    int64_t llT[cryptoX25519_LIMBS];
+    int64_t llQ, llC;
+    uint64_t ullAcc = 0;
+    uint32_t ulIndex, ulWidth, ulBits = 0, ulOut = 0;
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	llT[ulIndex] = pxF->lLimb[ulIndex];
+    }
+
+    /* q = floor(f / p), then f - q * p is the canonical value */
+    llQ = ( llT[cryptoX25519_LIMBS - 1] * 19 + ( (int64_t) 1 << 24 ) ) >> 25;
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	llQ = ( llT[ulIndex] + llQ ) >> prvX25519Width( ulIndex );
+    }
+    llT[0] += llQ * 19;
+
+    /* floor carries, the carry out of the top limb is q * 2^255 */
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	ulWidth = prvX25519Width( ulIndex );
+	llC = llT[ulIndex] >> ulWidth;
+	llT[ulIndex] -= llC * ( (int64_t) 1 << ulWidth );
+	if( ulIndex < cryptoX25519_LIMBS - 1 )
+	{
+	    llT[ulIndex + 1] += llC;
+	}
+    }
+
+    for( ulIndex = 0; ulIndex < cryptoX25519_LIMBS; ulIndex++ )
+    {
+	ullAcc |= (uint64_t) llT[ulIndex] << ulBits;
+	ulBits += prvX25519Width( ulIndex );
+	while( ulBits >= 8 )
+	{
+	    pucOut[ulOut++] = (uint8_t) ullAcc;
+	    ullAcc >>= 8;
+	    ulBits -= 8;
+	}
+    }
+    pucOut[ulOut] = (uint8_t) ullAcc;
+}
+/*---------------------------------------------------------------------------*/
+
+static void prvX25519Zeroize( void *pvBuf, size_t xLen )
+{
+    volatile uint8_t *pucBuf = pvBuf;
+
+    while( xLen-- )
+    {
+	*pucBuf++ = 0;
+    }
+}
+/*---------------------------------------------------------------------------*/
+
+void vCryptoX25519( uint8_t *pucOut, const uint8_t *pucScalar,
+		    const uint8_t *pucPoint )
+{
+    uint8_t ucE[cryptoX25519_KEY_LEN];
+    cryptoX25519Fe_t xX1, xX2, xZ2, xX3, xZ3;
+    cryptoX25519Fe_t xA, xAA, xB, xBB, xE, xC, xD, xDA, xCB;
+    uint32_t ulSwap = 0, ulBit;
+    int32_t lPos;
+
+    memcpy( ucE, pucScalar, cryptoX25519_KEY_LEN );
+    ucE[0] &= 248;
+    ucE[31] &= 127;
+    ucE[31] |= 64;
+
+    prvX25519FromBytes( &xX1, pucPoint );
+    memset( &xX2, 0, sizeof(xX2) );
+    xX2.lLimb[0] = 1;
+    memset( &xZ2, 0, sizeof(xZ2) );
+    xX3 = xX1;
+    memset( &xZ3, 0, sizeof(xZ3) );
+    xZ3.lLimb[0] = 1;
+
+    /* Montgomery ladder, the same operations for every scalar bit */
+    for( lPos = cryptoX25519_BITS - 1; lPos >= 0; lPos-- )
+    {
+	ulBit = ( ucE[lPos >> 3] >> ( lPos & 7 ) ) & 1;
+	ulSwap ^= ulBit;
+	prvX25519Cswap( &xX2, &xX3, ulSwap );
+	prvX25519Cswap( &xZ2, &xZ3, ulSwap );
+	ulSwap = ulBit;
+
+	prvX25519Add( &xA, &xX2, &xZ2 );
+	prvX25519Sqr( &xAA, &xA );
+	prvX25519Sub( &xB, &xX2, &xZ2 );
+	prvX25519Sqr( &xBB, &xB );
+	prvX25519Sub( &xE, &xAA, &xBB );
+	prvX25519Add( &xC, &xX3, &xZ3 );
+	prvX25519Sub( &xD, &xX3, &xZ3 );
+	prvX25519Mul( &xDA, &xD, &xA );
+	prvX25519Mul( &xCB, &xC, &xB );
+
+	prvX25519Add( &xX3, &xDA, &xCB );
+	prvX25519Sqr( &xX3, &xX3 );
+	prvX25519Sub( &xZ3, &xDA, &xCB );
+	prvX25519Sqr( &xZ3, &xZ3 );
+	prvX25519Mul( &xZ3, &xZ3, &xX1 );
+	prvX25519Mul( &xX2, &xAA, &xBB );
+	prvX25519MulSmall( &xZ2, &xE, cryptoX25519_A24 );
+	prvX25519Add( &xZ2, &xZ2, &xAA );
+	prvX25519Mul( &xZ2, &xZ2, &xE );
+    }
+    prvX25519Cswap( &xX2, &xX3, ulSwap );
+    prvX25519Cswap( &xZ2, &xZ3, ulSwap );
+
+    prvX25519Invert( &xZ2, &xZ2 );
+    prvX25519Mul( &xX2, &xX2, &xZ2 );
+    prvX25519ToBytes( pucOut, &xX2 );
+
+    prvX25519Zeroize( ucE, sizeof(ucE) );
+    prvX25519Zeroize( &xX2, sizeof(xX2) );
+    prvX25519Zeroize( &xZ2, sizeof(xZ2) );
+    prvX25519Zeroize( &xX3, sizeof(xX3) );
+    prvX25519Zeroize( &xZ3, sizeof(xZ3) );
+}
+/*---------------------------------------------------------------------------*/
+
+void vCryptoX25519Public( uint8_t *pucPublic, const uint8_t *pucPrivate )
+{
+    static const uint8_t ucBase[cryptoX25519_KEY_LEN] = { 9 };
+
+    vCryptoX25519( pucPublic, pucPrivate, ucBase );
+}
+/*---------------------------------------------------------------------------*/
+/* EOF */
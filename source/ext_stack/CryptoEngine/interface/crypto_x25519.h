@@ -0,0 +1,68 @@
+ /**===========================================================================
+ * @file crypto_x25519.h
+ *
+ * @brief This file contains the declarations of the X25519 key agreement of
+ * RFC 7748
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+#ifndef CRYPTO_X25519_H
+#define CRYPTO_X25519_H
+
+#include <stdint.h>
+
+#define cryptoX25519_KEY_LEN    (32)        /**< Length of X25519 keys and secrets */
+
+/**
+ * @brief This function computes the X25519 function of RFC 7748.
+ *
+ * Runs in constant time over fixed 255-bit field elements and uses neither
+ * the heap nor mbedtls_mpi. The scalar is clamped on the fly.
+ *
+ * @param pucOut    Pointer to the 32 byte resulting u-coordinate
+ * @param pucScalar Pointer to the 32 byte scalar, little endian
+ * @param pucPoint  Pointer to the 32 byte input u-coordinate, little endian
+ *
+ * @return void
+ */
+void vCryptoX25519( uint8_t *pucOut, const uint8_t *pucScalar,
+		    const uint8_t *pucPoint );
+
+/**
+ * @brief This function computes the X25519 public key of a private key.
+ *
+ * @param pucPublic  Pointer to the 32 byte public key
+ * @param pucPrivate Pointer to the 32 byte private key
+ *
+ * @return void
+ */
+void vCryptoX25519Public( uint8_t *pucPublic, const uint8_t *pucPrivate );
+
+#endif /* CRYPTO_X25519_H */
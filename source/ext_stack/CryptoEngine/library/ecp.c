@@ -334,7 +334,8 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp )
         mbedtls_mpi_free( &grp->N );
     }
 
-    if( grp->T != NULL )
+    /* T_size is 0 for the static comb tables of ecp_curves.c */
+    if( grp->T != NULL && grp->T_size != 0 )
     {
         for( i = 0; i < grp->T_size; i++ )
             mbedtls_ecp_point_free( &grp->T[i] );
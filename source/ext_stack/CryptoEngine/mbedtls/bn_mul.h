@@ -629,6 +629,48 @@
            "r6", "r7", "r8", "r9", "cc"         \
          );
 
+#elif defined(__thumb2__) && defined(__ARM_FEATURE_DSP)
+
+/*
+ * ARMv7E-M (Cortex-M4/M7): UMAAL adds the carry and the destination limb
+ * to the 64-bit product in one instruction and cannot overflow, so a limb
+ * costs two loads, one UMAAL and one store. MULADDC_HUIT moves limbs in
+ * pairs with LDM/STM.
+ */
+#define MULADDC_INIT                                    \
+    asm(                                                \
+            "ldr    r0, %3                      \n\t"   \
+            "ldr    r1, %4                      \n\t"   \
+            "ldr    r2, %5                      \n\t"   \
+            "ldr    r3, %6                      \n\t"
+
+#define MULADDC_CORE                                    \
+            "ldr    r4, [r0], #4                \n\t"   \
+            "ldr    r5, [r1]                    \n\t"   \
+            "umaal  r5, r2, r3, r4              \n\t"   \
+            "str    r5, [r1], #4                \n\t"
+
+#define MULADDC_PAIR                                    \
+            "ldmia  r0!, {r4, r5}               \n\t"   \
+            "ldmia  r1, {r6, r7}                \n\t"   \
+            "umaal  r6, r2, r3, r4              \n\t"   \
+            "umaal  r7, r2, r3, r5              \n\t"   \
+            "stmia  r1!, {r6, r7}               \n\t"
+
+#define MULADDC_HUIT                                    \
+            MULADDC_PAIR    MULADDC_PAIR                \
+            MULADDC_PAIR    MULADDC_PAIR
+
+#define MULADDC_STOP                                    \
+            "str    r2, %0                      \n\t"   \
+            "str    r1, %1                      \n\t"   \
+            "str    r0, %2                      \n\t"   \
+         : "=m" (c),  "=m" (d), "=m" (s)        \
+         : "m" (s), "m" (d), "m" (c), "m" (b)   \
+         : "r0", "r1", "r2", "r3", "r4", "r5",  \
+           "r6", "r7", "cc", "memory"           \
+         );
+
 #else
 
 #define MULADDC_INIT                                    \
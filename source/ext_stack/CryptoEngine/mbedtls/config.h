@@ -51,8 +51,12 @@
  *      include/mbedtls/bn_mul.h
  *
  * Comment to disable the use of assembly code.
+ *
+ * The host simulation keeps the portable C multiply-accumulate kernels.
  */
-//#define MBEDTLS_HAVE_ASM
+#if !defined(ORWL_HOST_SIM)
+#define MBEDTLS_HAVE_ASM
+#endif
 
 /**
  * \def MBEDTLS_HAVE_SSE2
@@ -460,7 +464,7 @@
  *
  * Comment this macro to disable NIST curves optimisation.
  */
-//#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_ECP_NIST_OPTIM
 
 /**
  * \def MBEDTLS_ECDSA_DETERMINISTIC
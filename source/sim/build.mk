@@ -0,0 +1,84 @@
+#===========================================================================
+# @file build.mk
+#
+# @brief This file contains the host simulation build configuration. It is
+#	included by source/build.mk when building with ORWL_TARGET=sim and
+#	replaces the Maxim SDK, the ARM FreeRTOS port and the target linker
+#	script with the simulated peripherals and the FreeRTOS POSIX port.
+#
+# @author ravikiran@design-shift.com
+#
+#============================================================================
+#
+# Copyright  Design SHIFT, 2017-2018
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#	Redistributions of source code must retain the above copyright.
+#	Neither the name of the [ORWL] nor the
+#	names of its contributors may be used to endorse or promote products
+#	derived from this software without specific prior written permission.
+#
+#  THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+#  EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+#  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+#  DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+#  DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+#  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+#  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+#  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+#  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+#  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#============================================================================
+
+## Simulation headers must be searched before any SDK header
+SimHeadrDir	= $(srcbase)/sim/include
+SimSrcDir	= $(srcbase)/sim/src
+
+##FreeRTOS kernel with the POSIX port; not part of this tree
+FREERTOS_KERNEL_DIR	?= $(srcbase)/../../FreeRTOS-Kernel
+SimRtosIncludeDir	= $(FREERTOS_KERNEL_DIR)/include \
+			  $(FREERTOS_KERNEL_DIR)/portable/ThirdParty/GCC/Posix \
+			  $(FREERTOS_KERNEL_DIR)/portable/ThirdParty/GCC/Posix/utils
+SimRtosSrc		= $(FREERTOS_KERNEL_DIR)/tasks.c \
+			  $(FREERTOS_KERNEL_DIR)/queue.c \
+			  $(FREERTOS_KERNEL_DIR)/list.c \
+			  $(FREERTOS_KERNEL_DIR)/timers.c \
+			  $(FREERTOS_KERNEL_DIR)/event_groups.c \
+			  $(FREERTOS_KERNEL_DIR)/portable/MemMang/heap_3.c \
+			  $(FREERTOS_KERNEL_DIR)/portable/ThirdParty/GCC/Posix/port.c \
+			  $(FREERTOS_KERNEL_DIR)/portable/ThirdParty/GCC/Posix/utils/wait_for_event.c
+
+##Target only sources which are not built for the host
+SimExcludeSrc	= $(SrcAppDir)/vectors.c
+
+##Host builds of the precompiled vendor libraries (ucl, MPL, ramtex, NXP)
+SIM_LIB_PATH	?= $(srcbase)/../sim_libs
+SimLibIncludeDir = $(SIM_LIB_PATH)/include
+LIBS_SIM	+= ucl mplmpu ramtexlib pthread m
+
+##Simulation configuration
+# The firmware stores addresses in uint32_t, hence a 32 bit host build.
+# Peripheral reset requests complete at once in the simulation.
+SIM_CONFIGS	=	-DORWL_HOST_SIM \
+			-D_GPIO_RESET_AT_INIT_ \
+			-D_UART_RESET_AT_INIT_ \
+			-D_TIMER_RESET_AT_INIT_ \
+			-m32
+
+##Linker symbols of the target image are provided by the simulation core
+SIM_LDFLAGS	=	-m32 -pthread \
+			-Wl,--defsym,__section_nvic_start=ulSimVectorTable \
+			-Wl,--defsym,__section_nmi_code_start=ulSimNmiCode \
+			-Wl,--defsym,__section_nmi_code_end=ulSimNmiCode \
+			-Wl,--defsym,__section_nmi_code_load_start=ulSimNmiCode
+
+# Usage, from the repository root (rules in source/sim/Makefile):
+#	make -f source/sim/Makefile FREERTOS_KERNEL_DIR=... SIM_LIB_PATH=...
+#	make -f source/sim/Makefile bench SIM_BENCH=all
+# or by hand:
+#	ORWL_SIM_FLASH=flash.bin ORWL_SIM_BENCH=all build_sim/orwl_sim
+# ORWL_SIM_BENCH selects benchmarks by name prefix, "all" runs every one.
+
+# EOF
@@ -0,0 +1,95 @@
+ /**===========================================================================
+ * @file FreeRTOSConfig.h
+ *
+ * @brief This file contains the FreeRTOS kernel configuration of the host
+ * simulation build, which runs on the FreeRTOS POSIX port.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/** scheduler */
+#define configUSE_PREEMPTION			( 1 )
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION	( 0 )
+#define configUSE_IDLE_HOOK			( 0 )
+#define configUSE_TICK_HOOK			( 0 )
+#define configCPU_CLOCK_HZ			( 108000000UL )
+#define configTICK_RATE_HZ			( 1000 )
+#define configMAX_PRIORITIES			( 8 )
+#define configMINIMAL_STACK_SIZE		( ( unsigned short ) 1024 )
+#define configMAX_TASK_NAME_LEN			( 24 )
+#define configUSE_16_BIT_TICKS			( 0 )
+#define configIDLE_SHOULD_YIELD			( 1 )
+#define configUSE_TASK_NOTIFICATIONS		( 1 )
+
+/** heap; the POSIX port needs generous stacks for the host C library */
+#define configSUPPORT_DYNAMIC_ALLOCATION	( 1 )
+#define configSUPPORT_STATIC_ALLOCATION		( 0 )
+#define configTOTAL_HEAP_SIZE			( ( size_t ) ( 8 * 1024 * 1024 ) )
+#define configAPPLICATION_ALLOCATED_HEAP	( 0 )
+
+/** synchronisation primitives */
+#define configUSE_MUTEXES			( 1 )
+#define configUSE_RECURSIVE_MUTEXES		( 1 )
+#define configUSE_COUNTING_SEMAPHORES		( 1 )
+#define configUSE_QUEUE_SETS			( 1 )
+#define configQUEUE_REGISTRY_SIZE		( 16 )
+
+/** software timers; also required by xEventGroupSetBitsFromISR() */
+#define configUSE_TIMERS			( 1 )
+#define configTIMER_TASK_PRIORITY		( configMAX_PRIORITIES - 1 )
+#define configTIMER_QUEUE_LENGTH		( 32 )
+#define configTIMER_TASK_STACK_DEPTH		( configMINIMAL_STACK_SIZE * 2 )
+
+/** diagnostics */
+#define configCHECK_FOR_STACK_OVERFLOW		( 0 )
+#define configUSE_MALLOC_FAILED_HOOK		( 0 )
+#define configUSE_TRACE_FACILITY		( 1 )
+#define configGENERATE_RUN_TIME_STATS		( 0 )
+#define configUSE_STATS_FORMATTING_FUNCTIONS	( 0 )
+
+/** optional API */
+#define INCLUDE_vTaskPrioritySet		( 1 )
+#define INCLUDE_uxTaskPriorityGet		( 1 )
+#define INCLUDE_vTaskDelete			( 1 )
+#define INCLUDE_vTaskSuspend			( 1 )
+#define INCLUDE_vTaskDelayUntil			( 1 )
+#define INCLUDE_vTaskDelay			( 1 )
+#define INCLUDE_xTaskGetSchedulerState		( 1 )
+#define INCLUDE_xTaskGetCurrentTaskHandle	( 1 )
+#define INCLUDE_uxTaskGetStackHighWaterMark	( 1 )
+#define INCLUDE_xTimerPendFunctionCall		( 1 )
+#define INCLUDE_xEventGroupSetBitFromISR	( 1 )
+
+/** firmware asserts terminate the simulation with a diagnostic */
+extern void vSimAssertCalled( const char *pcFile, unsigned long ulLine );
+#define configASSERT( x )	if( ( x ) == 0 ) vSimAssertCalled( __FILE__, __LINE__ )
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,68 @@
+ /**===========================================================================
+ * @file errors.h
+ *
+ * @brief This file contains the common error codes of the Maxim MML SDK as
+ * seen by the host simulation build.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_ERRORS_H_
+#define simINCLUDE_ERRORS_H_
+
+/** No error */
+#define NO_ERROR			( 0 )
+
+/** Error code base of the common errors */
+#define COMMON_ERR_BASE			( 0x01 << 0xF )
+
+/** Common error codes */
+#define COMMON_ERR_UNKNOWN		( COMMON_ERR_BASE + 0x01 )
+#define COMMON_ERR_NULL_PTR		( COMMON_ERR_BASE + 0x02 )
+#define COMMON_ERR_INVAL		( COMMON_ERR_BASE + 0x03 )
+#define COMMON_ERR_OUT_OF_RANGE		( COMMON_ERR_BASE + 0x04 )
+#define COMMON_ERR_BAD_STATE		( COMMON_ERR_BASE + 0x05 )
+#define COMMON_ERR_NOT_INITIALIZED	( COMMON_ERR_BASE + 0x06 )
+#define COMMON_ERR_IN_PROGRESS		( COMMON_ERR_BASE + 0x07 )
+#define COMMON_ERR_NO_MATCH		( COMMON_ERR_BASE + 0x08 )
+#define COMMON_ERR_FATAL_ERROR		( COMMON_ERR_BASE + 0x09 )
+#define COMMON_ERR_RUNNING		( COMMON_ERR_BASE + 0x0A )
+#define COMMON_ERR_MAX			( COMMON_ERR_BASE + 0x0B )
+
+/** Peripheral specific error codes */
+#define MML_GPIO_ERR_BASE		( 0x02 << 0xF )
+#define MML_GPIO_ERR_OUT_OF_RANGE	( MML_GPIO_ERR_BASE + 0x01 )
+#define MML_UART_ERR_BASE		( 0x03 << 0xF )
+#define MML_UART_ERR_IRQ_SET		( MML_UART_ERR_BASE + 0x01 )
+#define N_MML_SFLC_ERR_BASE		( 0x04 << 0xF )
+#define N_MML_SFLC_ERR_NOT_ACCESSIBLE	( N_MML_SFLC_ERR_BASE + 0x01 )
+#define N_MML_SFLC_ERR_OUT_OF_RANGE	( N_MML_SFLC_ERR_BASE + 0x02 )
+#define MML_I2C_ERR_BASE		( 0x05 << 0xF )
+#define MML_I2C_ERR_NACK		( MML_I2C_ERR_BASE + 0x01 )
+
+#endif /* simINCLUDE_ERRORS_H_ */
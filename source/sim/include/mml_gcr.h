@@ -0,0 +1,57 @@
+ /**===========================================================================
+ * @file mml_gcr.h
+ *
+ * @brief This file contains the global control API of the simulated SoC.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_GCR_H_
+#define simINCLUDE_MML_GCR_H_
+
+#include <mml_gcr_regs.h>
+
+/** system frequency selection */
+typedef enum
+{
+    MML_GCR_SYSFREQ_54MHZ = 0,
+    MML_GCR_SYSFREQ_108MHZ,
+} mml_gcr_sysfreq_t;
+
+/** @brief Sets the system frequency; no effect on the host.
+ *
+ * @param eFreq requested frequency.
+ * @return NO_ERROR always.
+ */
+int mml_set_system_frequency( mml_gcr_sysfreq_t eFreq );
+
+/** @brief Resets the system; terminates the simulation process.
+ */
+void mml_reset_system( void );
+
+#endif /* simINCLUDE_MML_GCR_H_ */
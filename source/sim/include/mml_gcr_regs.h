@@ -0,0 +1,65 @@
+ /**===========================================================================
+ * @file mml_gcr_regs.h
+ *
+ * @brief This file contains the global control register layout of the simulated
+ * SoC.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_GCR_REGS_H_
+#define simINCLUDE_MML_GCR_REGS_H_
+
+#include <stdint.h>
+#include <mq55/arch/mml.h>
+
+/** reset register bits; self clearing, serviced by the register model */
+#define MML_GCR_RSTR_GPIO_MASK		( 1 << 2 )
+#define MML_GCR_RSTR_TIMERS_MASK	( 1 << 3 )
+#define MML_GCR_RSTR_UARTS_MASK		( 1 << 4 )
+
+/** peripheral clock enable bit positions */
+#define MML_PERCKCN_DEV_T0		( 2 )
+#define MML_PERCKCN_DEV_T1		( 3 )
+#define MML_PERCKCN_DEV_T2		( 4 )
+#define MML_PERCKCN_DEV_T3		( 5 )
+#define MML_PERCKCN_DEV_UART0		( 9 )
+#define MML_PERCKCN_DEV_UART1		( 10 )
+
+/** global control registers */
+typedef struct
+{
+    volatile uint32_t	scon;
+    volatile uint32_t	rstr;
+    volatile uint32_t	clkcn;
+    volatile uint32_t	pmr;
+    volatile uint32_t	reserved[5];
+    volatile uint32_t	perckcn;
+} mml_gcr_regs_t;
+
+#endif /* simINCLUDE_MML_GCR_REGS_H_ */
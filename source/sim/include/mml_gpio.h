@@ -0,0 +1,138 @@
+ /**===========================================================================
+ * @file mml_gpio.h
+ *
+ * @brief This file contains the GPIO API of the simulated SoC. Pin state lives in
+ * the simulation and interrupts are raised synchronously on a pin change.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_GPIO_H_
+#define simINCLUDE_MML_GPIO_H_
+
+#include <stdint.h>
+#include <errors.h>
+#include <mml_gpio_regs.h>
+
+/** pin range of a GPIO port */
+#define MML_GPIO_BIT_RANGE_MIN		( 0 )
+#define MML_GPIO_BIT_RANGE_MAX		( 31 )
+#define MML_GPIO_BIT_RANGE_NB		( 32 )
+
+/** SDHC LED pin, kept for SDK compatibility */
+#define MML_GPIO2_SDHC_LED_PIN		( 0 )
+
+/** GPIO ports */
+typedef enum
+{
+    MML_GPIO_DEV0 = 0,
+    MML_GPIO_DEV1,
+    MML_GPIO_DEV2,
+    MML_GPIO_DEV_COUNT
+} mml_gpio_id_t;
+
+#define MML_GPIO_DEV_MIN		( MML_GPIO_DEV0 )
+#define MML_GPIO_DEV_MAX		( MML_GPIO_DEV2 )
+
+/** pin direction */
+typedef enum
+{
+    MML_GPIO_DIR_IN = 0,
+    MML_GPIO_DIR_OUT,
+} mml_gpio_direction_t;
+
+/** pin function */
+typedef enum
+{
+    MML_GPIO_NORMAL_FUNCTION = 0,
+    MML_GPIO_SECONDARY_ALT_FUNCTION,
+    MML_GPIO_TERTIARY_ALT_FUNCTION,
+} mml_gpio_function_t;
+
+/** pad configuration */
+typedef enum
+{
+    MML_GPIO_PAD_NORMAL = 0,
+    MML_GPIO_PAD_PULLUP,
+    MML_GPIO_PAD_PULLDOWN,
+} mml_gpio_pad_config_t;
+
+/** interrupt trigger mode */
+typedef enum
+{
+    MML_GPIO_INT_MODE_LEVEL_TRIGGERED = 0,
+    MML_GPIO_INT_MODE_EDGE_TRIGGERED,
+} mml_gpio_intr_mode_t;
+
+/** interrupt polarity */
+typedef enum
+{
+    MML_GPIO_INT_POL_LOW = 0,
+    MML_GPIO_INT_POL_FALLING = 0,
+    MML_GPIO_INT_POL_HIGH = 1,
+    MML_GPIO_INT_POL_RAISING = 1,
+} mml_gpio_intr_polarity_t;
+
+/** pin level; one byte wide since callers read it into uint8_t storage */
+typedef enum __attribute__ ((packed))
+{
+    MML_GPIO_OUT_LOGIC_ZERO = 0,
+    MML_GPIO_OUT_LOGIC_ONE,
+} mml_gpio_pin_data_t;
+
+/** pin configuration */
+typedef struct
+{
+    mml_gpio_direction_t	gpio_direction;
+    mml_gpio_function_t		gpio_function;
+    mml_gpio_pad_config_t	gpio_pad_config;
+    uint32_t			gpio_intr_mode;
+    uint32_t			gpio_intr_polarity;
+} mml_gpio_config_t;
+
+int mml_gpio_init( mml_gpio_id_t id, int offset, int bits_count,
+		   mml_gpio_config_t config );
+int mml_gpio_reset_interface( void );
+int mml_gpio_set_config( mml_gpio_id_t id, int offset, int bits_count,
+			 mml_gpio_config_t config );
+int mml_gpio_write_bit_pattern( mml_gpio_id_t id, int offset, int bits_count,
+				unsigned int data );
+int mml_gpio_read_bit_pattern( mml_gpio_id_t id, int offset, int bits_count,
+			       unsigned int *p_data );
+int mml_gpio_pin_input( mml_gpio_id_t id, int offset,
+			mml_gpio_pin_data_t *p_input );
+int mml_gpio_set_int_trigger_mode( mml_gpio_id_t id, int offset,
+				   uint32_t mode );
+int mml_gpio_set_int_pol( mml_gpio_id_t id, int offset, uint32_t pol );
+int mml_gpio_enable_interrupt( mml_gpio_id_t id, int offset, int bits_count );
+int mml_gpio_disable_interrupt( mml_gpio_id_t id, int offset, int bits_count );
+int mml_gpio_clear_interrupt( mml_gpio_id_t id, int offset, int bits_count );
+int mml_gpio_get_interrupt_status( mml_gpio_id_t id, int offset_min,
+				   int offset_max, int *p_status );
+
+#endif /* simINCLUDE_MML_GPIO_H_ */
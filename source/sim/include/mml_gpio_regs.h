@@ -0,0 +1,55 @@
+ /**===========================================================================
+ * @file mml_gpio_regs.h
+ *
+ * @brief This file contains the GPIO register layout of the simulated SoC.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_GPIO_REGS_H_
+#define simINCLUDE_MML_GPIO_REGS_H_
+
+#include <stdint.h>
+#include <mq55/arch/mml.h>
+
+/** GPIO registers */
+typedef struct
+{
+    volatile uint32_t	en;
+    volatile uint32_t	out;
+    volatile uint32_t	in;
+    volatile uint32_t	int_mod;
+    volatile uint32_t	int_pol;
+    volatile uint32_t	int_en;
+    volatile uint32_t	int_stat;
+    volatile uint32_t	out_en;
+    volatile uint32_t	pad_cfg1;
+    volatile uint32_t	pad_cfg2;
+} mml_gpio_regs_t;
+
+#endif /* simINCLUDE_MML_GPIO_REGS_H_ */
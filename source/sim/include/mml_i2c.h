@@ -0,0 +1,73 @@
+ /**===========================================================================
+ * @file mml_i2c.h
+ *
+ * @brief This file contains the I2C master API of the simulated SoC. Slave
+ * devices are register file models attached through sim.h.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_I2C_H_
+#define simINCLUDE_MML_I2C_H_
+
+#include <stdint.h>
+#include <errors.h>
+#include <cobra_defines.h>
+#include <mml_i2c_regs.h>
+
+/** configuration flags */
+#define MML_I2C_AUTOSTART_ENABLE	( 1 << 0 )
+
+/** ioctl commands */
+typedef enum
+{
+    MML_I2C_SET_FREQ = 0,
+    MML_I2C_SET_READCOUNT,
+    MML_I2C_RXFLUSH,
+    MML_I2C_TXFLUSH,
+} mml_i2c_ioctl_t;
+
+/** I2C configuration */
+typedef struct
+{
+    uint32_t		baudrate;
+    uint32_t		rxfifo_thr;
+    uint32_t		flags;
+    irq_handler_t	irq_handler;
+} mml_i2c_config_t;
+
+int mml_i2c_init( mml_i2c_config_t *config );
+int mml_i2c_write_start( unsigned char address, const unsigned char *data,
+			 unsigned int *plength );
+int mml_i2c_write( unsigned char *data, unsigned int *plength );
+int mml_i2c_read_start( unsigned char address );
+int mml_i2c_read( unsigned char *data, unsigned int *plength );
+int mml_i2c_ioctl( mml_i2c_ioctl_t command, void *data );
+int mml_i2c_bus_status( unsigned int *pstatus );
+
+#endif /* simINCLUDE_MML_I2C_H_ */
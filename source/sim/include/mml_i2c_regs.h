@@ -0,0 +1,60 @@
+ /**===========================================================================
+ * @file mml_i2c_regs.h
+ *
+ * @brief This file contains the I2C register definitions of the simulated SoC.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_I2C_REGS_H_
+#define simINCLUDE_MML_I2C_REGS_H_
+
+#include <stdint.h>
+#include <mq55/arch/mml.h>
+
+/** status register */
+#define MML_I2C_SR_BUSY_MASK		( 1 << 0 )
+#define MML_I2C_SR_RXEMPTY_MASK		( 1 << 1 )
+#define MML_I2C_SR_RXFULL_MASK		( 1 << 2 )
+#define MML_I2C_SR_TXEMPTY_MASK		( 1 << 3 )
+#define MML_I2C_SR_TXFULL_MASK		( 1 << 4 )
+
+/** I2C registers */
+typedef struct
+{
+    volatile uint32_t	cr;
+    volatile uint32_t	sr;
+    volatile uint32_t	ier;
+    volatile uint32_t	isr;
+    volatile uint32_t	brr;
+    volatile uint32_t	rcr;
+    volatile uint32_t	txr;
+    volatile uint32_t	dr;
+} mml_i2c_regs_t;
+
+#endif /* simINCLUDE_MML_I2C_REGS_H_ */
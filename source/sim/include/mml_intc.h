@@ -0,0 +1,61 @@
+ /**===========================================================================
+ * @file mml_intc.h
+ *
+ * @brief This file contains the interrupt controller API of the simulated SoC.
+ * Interrupts are delivered synchronously by the simulated peripherals.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_INTC_H_
+#define simINCLUDE_MML_INTC_H_
+
+#include <cobra_defines.h>
+#include <mml_intc_regs.h>
+
+/** global interrupt masking has no meaning on the host */
+#define cpsid()
+#define cpsie()
+
+/** @brief Installs an interrupt handler.
+ *
+ * @param eId interrupt number.
+ * @param ePrio interrupt priority, ignored on the host.
+ * @param pvHandler handler invoked on the interrupt.
+ * @return NO_ERROR on success, COMMON_ERR_OUT_OF_RANGE on bad number.
+ */
+int mml_intc_setup_irq( mml_intc_id_t eId, mml_intc_prio_t ePrio,
+			void (*pvHandler)( void ) );
+
+/** @brief Raises an interrupt; used by the simulated peripherals.
+ *
+ * @param eId interrupt number.
+ */
+void vSimIntcRaise( mml_intc_id_t eId );
+
+#endif /* simINCLUDE_MML_INTC_H_ */
@@ -0,0 +1,67 @@
+ /**===========================================================================
+ * @file mml_intc_regs.h
+ *
+ * @brief This file contains the interrupt controller definitions of the
+ * simulated SoC.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_INTC_REGS_H_
+#define simINCLUDE_MML_INTC_REGS_H_
+
+#include <stdint.h>
+
+/** interrupt numbers of the simulated SoC */
+typedef enum
+{
+    MML_INTNUM_GPIO0 = 0,
+    MML_INTNUM_GPIO1,
+    MML_INTNUM_GPIO2,
+    MML_INTNUM_UART0,
+    MML_INTNUM_UART1,
+    MML_INTNUM_I2C,
+    MML_INTNUM_SPI0,
+    MML_INTNUM_SPI1,
+    MML_INTNUM_SPI2,
+    MML_INTNUM_TMR0,
+    MML_INTNUM_TMR1,
+    MML_INTNUM_TMR2,
+    MML_INTNUM_TMR3,
+    MML_INTNUM_TRNG,
+    MML_INTNUM_COUNT
+} mml_intc_id_t;
+
+/** interrupt priorities */
+typedef enum
+{
+    MML_INTC_PRIO_0 = 0,
+    MML_INTC_PRIO_15 = 15,
+} mml_intc_prio_t;
+
+#endif /* simINCLUDE_MML_INTC_REGS_H_ */
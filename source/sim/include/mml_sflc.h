@@ -0,0 +1,53 @@
+ /**===========================================================================
+ * @file mml_sflc.h
+ *
+ * @brief This file contains the flash controller API of the simulated SoC. The
+ * flash array is memory mapped at MML_MEM_FLASH_BASE and persisted in a host
+ * image file.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_SFLC_H_
+#define simINCLUDE_MML_SFLC_H_
+
+#include <stdint.h>
+#include <errors.h>
+#include <mq55/arch/mml.h>
+
+/** flash page size */
+#define MML_SFLC_PAGE_SIZE		( 4096 )
+
+int mml_sflc_init( void );
+int mml_sflc_read( unsigned int address, unsigned char *p_data,
+		   unsigned int length );
+int mml_sflc_write( unsigned int address, unsigned char *p_data,
+		    unsigned int length );
+int mml_sflc_erase( unsigned int address, unsigned int length );
+
+#endif /* simINCLUDE_MML_SFLC_H_ */
@@ -0,0 +1,99 @@
+ /**===========================================================================
+ * @file mml_spi.h
+ *
+ * @brief This file contains the SPI API of the simulated SoC. Transmitted bytes
+ * are counted and handed to an optional sink installed through sim.h.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_SPI_H_
+#define simINCLUDE_MML_SPI_H_
+
+#include <stdint.h>
+#include <errors.h>
+#include <mml_spi_regs.h>
+
+/** SPI ports */
+typedef enum
+{
+    MML_SPI_DEV0 = 0,
+    MML_SPI_DEV1,
+    MML_SPI_DEV2,
+    MML_SPI_DEV_COUNT
+} mml_spi_dev_t;
+
+#define MML_SPI_DEV_MIN			( MML_SPI_DEV0 )
+#define MML_SPI_DEV_MAX			( MML_SPI_DEV2 )
+
+/** configuration values */
+#define MML_SPI_MODE_MASTER		( 1 )
+#define MML_SPI_WOR_NOT_OPEN_DRAIN	( 0 )
+#define MML_SPI_SCLK_LOW		( 0 )
+#define MML_SPI_PHASE_LOW		( 0 )
+#define MML_SPI_BRG_IRQ_DISABLE		( 0 )
+#define MML_SPI_SSV_LOW			( 0 )
+#define MML_SPI_SSIO_OUTPUT		( 1 )
+#define MML_SPI_TLJ_DIRECT		( 0 )
+#define MML_SPI_DMA_DISABLE		( 0 )
+#define MML_SPI_DMA_ENABLE		( 1 )
+
+/** DMA channel parameters */
+typedef struct
+{
+    uint32_t	active;
+    uint32_t	channel;
+} mml_spi_dma_t;
+
+/** SPI configuration */
+typedef struct
+{
+    uint32_t		baudrate;
+    uint32_t		word_size;
+    uint32_t		mode;
+    uint32_t		wor;
+    uint32_t		clk_pol;
+    uint32_t		phase;
+    uint32_t		brg_irq;
+    uint32_t		ssv;
+    uint32_t		ssio;
+    uint32_t		tlj;
+    mml_spi_dma_t	dma_tx;
+    mml_spi_dma_t	dma_rx;
+    uint32_t		ssel;
+} mml_spi_params_t;
+
+/** enables the SPI port */
+#define M_MML_SPI_ENABLE(dev)		mml_spi_enable( (dev) )
+
+int mml_spi_init( mml_spi_dev_t devnum, mml_spi_params_t *pparams );
+int mml_spi_transmit( mml_spi_dev_t devnum, unsigned char *data,
+		      unsigned int length );
+int mml_spi_enable( mml_spi_dev_t devnum );
+
+#endif /* simINCLUDE_MML_SPI_H_ */
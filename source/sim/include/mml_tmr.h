@@ -0,0 +1,109 @@
+ /**===========================================================================
+ * @file mml_tmr.h
+ *
+ * @brief This file contains the timer API of the simulated SoC. Timers are
+ * backed by FreeRTOS software timers so that their handlers run in the
+ * simulated interrupt context.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_TMR_H_
+#define simINCLUDE_MML_TMR_H_
+
+#include <stdint.h>
+#include <errors.h>
+#include <mq55/arch/mml.h>
+
+/** timers */
+typedef enum
+{
+    MML_TMR_DEV0 = 0,
+    MML_TMR_DEV1,
+    MML_TMR_DEV2,
+    MML_TMR_DEV3,
+    MML_TMR_DEV_COUNT
+} mml_tmr_id_t;
+
+#define MML_TMR_DEV_MIN			( MML_TMR_DEV0 )
+#define MML_TMR_DEV_MAX			( MML_TMR_DEV3 )
+
+/** prescaler */
+typedef enum
+{
+    MML_TMR_PRES_DIV_1 = 0,
+    MML_TMR_PRES_DIV_2,
+    MML_TMR_PRES_DIV_4,
+    MML_TMR_PRES_DIV_8,
+    MML_TMR_PRES_DIV_16,
+    MML_TMR_PRES_DIV_32,
+    MML_TMR_PRES_DIV_64,
+    MML_TMR_PRES_DIV_128,
+    MML_TMR_PRES_DIV_256,
+    MML_TMR_PRES_DIV_512,
+    MML_TMR_PRES_DIV_1024,
+    MML_TMR_PRES_DIV_2048,
+    MML_TMR_PRES_DIV_4096,
+} mml_tmr_prescaler_t;
+
+/** timer modes */
+typedef enum
+{
+    MML_TMR_MODE_ONE_SHOT = 0,
+    MML_TMR_MODE_CONTINUOUS,
+    MML_TMR_MODE_COUNTER,
+} mml_tmr_mode_t;
+
+typedef enum
+{
+    MML_TMR_POLARITY_LOW = 0,
+    MML_TMR_POLARITY_HIGH,
+} mml_tmr_polarity_t;
+
+/** timer configuration */
+typedef struct
+{
+    uint32_t		timeout;
+    uint32_t		count;
+    uint32_t		pwm_value;
+    mml_tmr_prescaler_t	clock;
+    mml_tmr_mode_t	mode;
+    mml_tmr_polarity_t	polarity;
+    void		(*handler)( void );
+} mml_tmr_config_t;
+
+int mml_tmr_init( mml_tmr_id_t id, mml_tmr_config_t *config );
+int mml_tmr_reset_interface( void );
+int mml_tmr_enable( mml_tmr_id_t id );
+int mml_tmr_disable( mml_tmr_id_t id );
+int mml_tmr_close( mml_tmr_id_t id );
+int mml_tmr_read( mml_tmr_id_t id, unsigned int *p_count );
+int mml_tmr_interrupt_enable( mml_tmr_id_t id );
+int mml_tmr_interrupt_clear( mml_tmr_id_t id );
+
+#endif /* simINCLUDE_MML_TMR_H_ */
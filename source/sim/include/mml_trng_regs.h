@@ -0,0 +1,54 @@
+ /**===========================================================================
+ * @file mml_trng_regs.h
+ *
+ * @brief This file contains the TRNG register layout of the simulated SoC.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_TRNG_REGS_H_
+#define simINCLUDE_MML_TRNG_REGS_H_
+
+#include <stdint.h>
+#include <mq55/arch/mml.h>
+
+/** control register bits */
+#define MML_TRNGCN_RNG_EN_MASK		( 1 << 0 )
+#define MML_TRNGCN_RNG_BS_MASK		( 1 << 1 )
+#define MML_TRNGCN_RNG_ISC_MASK		( 1 << 2 )
+#define MML_TRNGCN_RNG_I4S_MASK		( 1 << 3 )
+#define MML_TRNGCN_AESKG_MASK		( 1 << 4 )
+
+/** TRNG registers */
+typedef struct
+{
+    volatile uint32_t	trngcr;
+    volatile uint32_t	trngdr;
+} mml_trng_regs_t;
+
+#endif /* simINCLUDE_MML_TRNG_REGS_H_ */
@@ -0,0 +1,123 @@
+ /**===========================================================================
+ * @file mml_uart.h
+ *
+ * @brief This file contains the UART API of the simulated SoC. UART0 is the
+ * console and goes to stdout, UART1 is the Intel link and is driven by the
+ * simulation through sim.h.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MML_UART_H_
+#define simINCLUDE_MML_UART_H_
+
+#include <stdint.h>
+#include <errors.h>
+#include <mml_uart_regs.h>
+
+/** UART ports */
+typedef enum
+{
+    MML_UART_DEV0 = 0,
+    MML_UART_DEV1,
+    MML_UART_DEV_COUNT
+} mml_uart_id_t;
+
+#define MML_UART_DEV_MIN		( MML_UART_DEV0 )
+#define MML_UART_DEV_MAX		( MML_UART_DEV1 )
+
+/** frame format */
+typedef enum
+{
+    MML_UART_DATA_TRANSFER_SIZE_5_BITS = 0,
+    MML_UART_DATA_TRANSFER_SIZE_6_BITS,
+    MML_UART_DATA_TRANSFER_SIZE_7_BITS,
+    MML_UART_DATA_TRANSFER_SIZE_8_BITS,
+} mml_uart_data_bits_t;
+
+typedef enum
+{
+    MML_UART_HW_FLOW_CTL_DISABLE = 0,
+    MML_UART_HW_FLOW_CTL_ENABLE,
+} mml_uart_flwctrl_t;
+
+typedef enum
+{
+    MML_UART_PARITY_NONE = 0,
+    MML_UART_PARITY_ODD,
+    MML_UART_PARITY_EVEN,
+} mml_uart_parity_t;
+
+typedef enum
+{
+    MML_UART_PARITY_MODE_ONES = 0,
+    MML_UART_PARITY_MODE_ZEROS,
+} mml_uart_parity_mode_t;
+
+typedef enum
+{
+    MML_UART_RTS_IO_LEVEL_LOW = 0,
+    MML_UART_RTS_IO_LEVEL_HIGH,
+} mml_uart_rts_ctl_t;
+
+typedef enum
+{
+    MML_UART_STOPBITS_ONE = 0,
+    MML_UART_STOPBITS_ONE_DOT_FIVE,
+} mml_uart_stop_bits_t;
+
+/** interrupt handler */
+typedef void (*mml_uart_handler_t)( void );
+
+/** UART configuration */
+typedef struct
+{
+    uint32_t			baudrate;
+    mml_uart_data_bits_t	data_bits;
+    mml_uart_flwctrl_t		flwctrl;
+    mml_uart_parity_t		parity;
+    mml_uart_parity_mode_t	parity_mode;
+    mml_uart_rts_ctl_t		rts_ctl;
+    mml_uart_stop_bits_t	stop_bits;
+    mml_uart_handler_t		handler;
+} mml_uart_config_t;
+
+/** interrupt gating at the platform level */
+#define M_MML_UART_INTERRUPT_ENABLE(dev)	mml_uart_irq_gate( (dev), 1 )
+#define M_MML_UART_INTERRUPT_DISABLE(dev)	mml_uart_irq_gate( (dev), 0 )
+
+int mml_uart_init( mml_uart_id_t id, mml_uart_config_t config );
+int mml_uart_reset_interface( void );
+int mml_uart_write_char( mml_uart_id_t id, unsigned char data );
+int mml_uart_flush_raw( mml_uart_id_t id, unsigned int mask );
+void mml_uart_interrupt_clear( mml_uart_id_t id, unsigned int mask );
+void mml_uart_interrupt_set( mml_uart_id_t id, unsigned int mask );
+void mml_uart_interrupt_ack( mml_uart_id_t id );
+int mml_uart_irq_gate( mml_uart_id_t id, int enable );
+
+#endif /* simINCLUDE_MML_UART_H_ */
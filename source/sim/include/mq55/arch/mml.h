@@ -0,0 +1,75 @@
+ /**===========================================================================
+ * @file mml.h
+ *
+ * @brief This file contains the memory map of the simulated MQ55 SoC used by
+ * the host simulation build. Every address below is backed by a host mapping
+ * created by the simulation core before the firmware main() runs.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_MQ55_ARCH_MML_H_
+#define simINCLUDE_MQ55_ARCH_MML_H_
+
+/** Flash: memory mapped and file backed by the simulated flash controller */
+#define MML_MEM_FLASH_BASE		( 0x10000000 )
+#define MML_MEM_FLASH_SIZE		( 0x00100000 )
+
+/** Peripheral window: one anonymous mapping covers all the register blocks
+ * below as well as the secure monitor block at 0x40004000 */
+#define MML_MEM_PERIPH_BASE		( 0x40000000 )
+#define MML_MEM_PERIPH_SIZE		( 0x00100000 )
+
+/** Register blocks inside the peripheral window */
+#define MML_GCR_IOBASE			( 0x40000000 )
+#define MML_SNVSRAM_IOBASE		( 0x40008000 )
+#define MML_TRNG_IOBASE			( 0x40009000 )
+#define MML_INTC_IOBASE			( 0x4000A000 )
+#define MML_SFLC_IOBASE			( 0x4000B000 )
+#define MML_I2C_IOBASE			( 0x4000C000 )
+#define MML_TMR0_IOBASE			( 0x40010000 )
+#define MML_TMR1_IOBASE			( 0x40011000 )
+#define MML_TMR2_IOBASE			( 0x40012000 )
+#define MML_TMR3_IOBASE			( 0x40013000 )
+#define MML_GPIO0_IOBASE		( 0x40020000 )
+#define MML_GPIO1_IOBASE		( 0x40021000 )
+#define MML_GPIO2_IOBASE		( 0x40022000 )
+#define MML_UART0_IOBASE		( 0x40030000 )
+#define MML_UART1_IOBASE		( 0x40031000 )
+#define MML_SPI0_IOBASE			( 0x40040000 )
+#define MML_SPI1_IOBASE			( 0x40041000 )
+#define MML_SPI2_IOBASE			( 0x40042000 )
+
+/** Secure NV SRAM */
+#define MML_MEM_SNVSRAM_BASE		( MML_SNVSRAM_IOBASE )
+#define MML_MEM_SNVSRAM_SIZE		( 0x00000400 )
+
+/** Simulated core clock */
+#define MML_SYS_FREQ			( 108000000 )
+
+#endif /* simINCLUDE_MQ55_ARCH_MML_H_ */
@@ -0,0 +1,59 @@
+ /**===========================================================================
+ * @file rtc.h
+ *
+ * @brief This file contains the RTC API as seen by the host simulation build. The
+ * RTC counts host wall clock seconds plus a settable offset.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_RTC_H_
+#define simINCLUDE_RTC_H_
+
+#include <stdint.h>
+#include <errors.h>
+
+/** date and time */
+typedef struct
+{
+    uint8_t	ucMonth;
+    uint8_t	ucDate;
+    uint16_t	usYear;
+    uint8_t	ucHour;
+    uint8_t	ucMinute;
+    uint8_t	ucSecond;
+    uint8_t	ucWeekday;
+} rtcDateTime_t;
+
+int32_t lRtcGetDateTime( rtcDateTime_t *pxDateTime );
+int32_t lRtcSetDateTime( rtcDateTime_t *pxDateTime );
+int32_t lRtcGetRTCSeconds( uint32_t *pulSeconds );
+int32_t lRtcConvertRawToDateTime( uint32_t ulSeconds,
+				  rtcDateTime_t *pxDateTime );
+
+#endif /* simINCLUDE_RTC_H_ */
@@ -0,0 +1,243 @@
+ /**===========================================================================
+ * @file sim.h
+ *
+ * @brief This file contains the control interface of the host simulation. It is
+ * used by the benchmark runner and by test drivers to inject stimulus into the
+ * simulated peripherals and to read back their activity counters.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+#ifndef simINCLUDE_SIM_H_
+#define simINCLUDE_SIM_H_
+
+/* Global includes */
+#include <stdint.h>
+
+/* simulated driver includes */
+#include <mml_gpio.h>
+#include <mml_uart.h>
+#include <mml_spi.h>
+
+/**
+ * environment variable naming the flash image file
+ */
+#define simENV_FLASH_IMAGE		"ORWL_SIM_FLASH"
+
+/**
+ * default flash image file
+ */
+#define simDEFAULT_FLASH_IMAGE		"orwl_flash.bin"
+
+/**
+ * environment variable enabling the benchmark runner
+ */
+#define simENV_BENCH			"ORWL_SIM_BENCH"
+
+/**
+ * environment variable overriding the benchmark iteration count
+ */
+#define simENV_BENCH_ITERS		"ORWL_SIM_BENCH_ITERS"
+
+/**
+ * number of words of the simulated vector table
+ */
+#define simVECTOR_COUNT			(64)
+
+/**
+ * number of registers of a simulated I2C slave
+ */
+#define simI2C_REG_COUNT		(256)
+
+/**
+ * size of the UART transmit capture ring, must be power of 2
+ */
+#define simUART_TX_RING_SIZE		(4096)
+
+/**
+ * @brief Flash activity counters.
+ */
+typedef struct
+{
+    /** number of read calls */
+    uint32_t	ulReads;
+    /** number of write calls */
+    uint32_t	ulWrites;
+    /** number of erased pages */
+    uint32_t	ulPageErases;
+    /** bytes read */
+    uint32_t	ulBytesRead;
+    /** bytes written */
+    uint32_t	ulBytesWritten;
+    /** highest erase count of any single page */
+    uint32_t	ulMaxPageErases;
+} simFlashStats_t;
+
+/**
+ * @brief Register file model of an I2C slave device.
+ */
+typedef struct simI2cSlave
+{
+    /** 7 bit slave address */
+    uint8_t	ucAddr;
+    /** register pointer, auto incremented on every access */
+    uint8_t	ucRegPtr;
+    /** register file */
+    uint8_t	ucRegs[simI2C_REG_COUNT];
+    /** optional hook invoked after a register was written */
+    void	(*vOnWrite)( struct simI2cSlave *pxSlave, uint8_t ucReg );
+    /** next slave in the bus list */
+    struct simI2cSlave *pxNext;
+} simI2cSlave_t;
+
+/** @brief Returns monotonic host time.
+ *
+ * @return nanoseconds since an arbitrary origin.
+ */
+uint64_t ullSimNowNs( void );
+
+/** @brief Terminates the simulation.
+ *
+ * Flushes the flash image and the console and exits the process.
+ *
+ * @param lStatus process exit status.
+ */
+void vSimExit( int32_t lStatus );
+
+/** @brief Reads the flash activity counters.
+ *
+ * @param pxStats counters output.
+ */
+void vSimFlashGetStats( simFlashStats_t *pxStats );
+
+/** @brief Clears the flash activity counters.
+ */
+void vSimFlashResetStats( void );
+
+/** @brief Feeds bytes to the receive side of a UART.
+ *
+ * The installed UART handler is invoked once per byte, synchronously in the
+ * context of the caller.
+ *
+ * @param eId UART port.
+ * @param pucData bytes to receive.
+ * @param ulLen number of bytes.
+ */
+void vSimUartInject( mml_uart_id_t eId, const uint8_t *pucData,
+		     uint32_t ulLen );
+
+/** @brief Records a byte written to the UART data register.
+ *
+ * @param eId UART port.
+ * @param ucData transmitted byte.
+ */
+void vSimUartTxPut( mml_uart_id_t eId, uint8_t ucData );
+
+/** @brief Raises the transmit FIFO interrupt of a UART.
+ *
+ * The simulated transmit FIFO never fills, so the handler is invoked once,
+ * synchronously in the context of the caller, if the half empty interrupt
+ * is enabled.
+ *
+ * @param eId UART port.
+ */
+void vSimUartTxKick( mml_uart_id_t eId );
+
+/** @brief Drains the transmit capture ring of a UART.
+ *
+ * @param eId UART port.
+ * @param pucData output buffer.
+ * @param ulMax size of output buffer.
+ * @return number of bytes copied.
+ */
+uint32_t ulSimUartTxRead( mml_uart_id_t eId, uint8_t *pucData,
+			  uint32_t ulMax );
+
+/** @brief Mutes or unmutes the console UART.
+ *
+ * @param ulMute non zero discards console output.
+ */
+void vSimUartConsoleMute( uint32_t ulMute );
+
+/** @brief Drives a GPIO input pin and raises its interrupt if armed.
+ *
+ * @param eId GPIO port.
+ * @param ulPin pin number.
+ * @param ulLevel 0 or 1.
+ */
+void vSimGpioSetInput( mml_gpio_id_t eId, uint32_t ulPin, uint32_t ulLevel );
+
+/** @brief Reads a GPIO output pin.
+ *
+ * @param eId GPIO port.
+ * @param ulPin pin number.
+ * @return pin level.
+ */
+uint32_t ulSimGpioGetOutput( mml_gpio_id_t eId, uint32_t ulPin );
+
+/** @brief Attaches a slave model to the I2C bus.
+ *
+ * @param pxSlave slave model, must stay valid while attached.
+ * @return NO_ERROR or COMMON_ERR_INVAL if the address is taken.
+ */
+int32_t lSimI2cAttach( simI2cSlave_t *pxSlave );
+
+/** @brief Installs the byte sink of a SPI port.
+ *
+ * @param eId SPI port.
+ * @param vSink sink called with every transmitted buffer, may be NULL.
+ */
+void vSimSpiSetSink( mml_spi_dev_t eId,
+		     void (*vSink)( const uint8_t *pucData, uint32_t ulLen ) );
+
+/** @brief Number of bytes transmitted on a SPI port.
+ *
+ * @param eId SPI port.
+ * @return byte count.
+ */
+uint32_t ulSimSpiTxCount( mml_spi_dev_t eId );
+
+/** @brief Seeds the TRNG model for reproducible runs.
+ *
+ * @param ulSeed seed value, must be non zero.
+ */
+void vSimTrngSeed( uint32_t ulSeed );
+
+/** @brief Services the TRNG registers; called by the register model and by
+ * the TRNG driver once it asks for fresh data.
+ */
+void vSimTrngService( void );
+
+/** @brief Creates the benchmark runner task if requested.
+ *
+ * The runner is only created when simENV_BENCH is set. It runs every
+ * benchmark and terminates the simulation with vSimExit().
+ */
+void vSimBenchStart( void );
+
+#endif /* simINCLUDE_SIM_H_ */
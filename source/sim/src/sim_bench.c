@@ -0,0 +1,715 @@
+ /**===========================================================================
+ * @file sim_bench.c
+ *
+ * @brief This file contains the benchmark runner of the host simulation. Every
+ * entry of the benchmark table is run for a fixed number of iterations inside
+ * a FreeRTOS task and reported as one machine readable line:
+ *
+ *   bench <name> iters=<n> min_ns=<t> avg_ns=<t> max_ns=<t> erases=<n> writes=<n>
+ *
+ * where erases and writes are the flash page erases and program calls of the
+ * whole run. Times are host nanoseconds and only meaningful relative to
+ * earlier runs on the same machine. Setups that check results against a
+ * reference fail the entry on a mismatch; none of them has been run yet, see
+ * source/sim/Makefile.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <task.h>
+
+/* application includes */
+#include <errors.h>
+#include <printf_lite.h>
+#include <keyfobid.h>
+#include <trng.h>
+#include <prng.h>
+#include <prng_drbg.h>
+#include <nfc_common.h>
+#include <nfc_auth.h>
+#include <crypto_interface.h>
+
+#include <ucl/ucl_aes_cbc.h>
+#include <mbedtls/bignum.h>
+
+/* simulation includes */
+#include <sim.h>
+
+/**
+ * default number of iterations per benchmark
+ */
+#define benchDEFAULT_ITERS	(100)
+
+/**
+ * stack size of the benchmark task
+ */
+#define benchSTACK_SIZE		(4096)
+
+/**
+ * priority of the benchmark task; above the application tasks
+ */
+#define benchPRIORITY		( configMAX_PRIORITIES - 2 )
+
+/**
+ * bignum operand size, the ROT RSA modulus
+ */
+#define benchMPI_BYTES		(256)
+
+/**
+ * operands checked against the reference before the bignum benchmarks
+ */
+#define benchMPI_CHECKS		(8)
+
+/**
+ * @brief Benchmark table entry.
+ */
+typedef struct
+{
+    /** name reported in the result line */
+    const char	*pcName;
+    /** optional preparation, run once before timing */
+    int32_t	(*lSetup)( void );
+    /** one timed iteration */
+    int32_t	(*lRun)( uint32_t ulIter );
+} benchEntry_t;
+
+/** keyfob entry used by the keyfob benchmarks */
+static keyfobidKeyFobEntry_t prvBenchEntry;
+
+/** keyfob info used by the keyfob benchmarks */
+static keyfobidKeyFobInfo_t prvBenchInfo;
+
+/** keyfob entry used by the authentication benchmarks */
+static keyfobidKeyFobInfo_t prvBenchAuthKey;
+
+/** challenge used by the authentication benchmarks */
+static NfcCommonSeed_Info_t prvBenchChallenge;
+
+/** bignum operands: A, a distinct copy B, modulus, exponent, result and the
+ * cached R^2 mod N */
+static mbedtls_mpi prvBenchMpiA, prvBenchMpiB, prvBenchMpiN, prvBenchMpiE;
+static mbedtls_mpi prvBenchMpiX, prvBenchMpiRR;
+
+/** caller owned context of the key agreement benchmarks */
+static cryptoEcdhCtx_t prvBenchEcdh;
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Writes a keyfob table holding a single admin key. */
+static int32_t prvBenchKeyfobSetup( void )
+{
+    memset(&prvBenchEntry, 0, sizeof(prvBenchEntry));
+    prvBenchEntry.ulKeyFobIdMagic = keyfobidKEYFOB_ID_MAGIC;
+    prvBenchEntry.xKeyFobInfo[0].ulKeyMagic = keyfobidKEYFOB_INFO_MAGIC;
+    prvBenchEntry.xKeyFobInfo[0].ulKeyFobId = 1;
+    prvBenchEntry.xKeyFobInfo[0].ulKeyNameLen = 8;
+    memcpy(prvBenchEntry.xKeyFobInfo[0].ucKeyName, "ADMINKEY", 8);
+    return lKeyfobidWriteKeyFobEntry(&prvBenchEntry);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One full keyfob table write. */
+static int32_t prvBenchKeyfobWrite( uint32_t ulIter )
+{
+    prvBenchEntry.xKeyFobInfo[0].ulKeyPrevilage = ulIter;
+    return lKeyfobidWriteKeyFobEntry(&prvBenchEntry);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One full keyfob table read. */
+static int32_t prvBenchKeyfobRead( uint32_t ulIter )
+{
+    (void) ulIter;
+    return lKeyfobidReadKeyFobEntry(&prvBenchEntry);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One single key read. */
+static int32_t prvBenchKeyfobReadKey( uint32_t ulIter )
+{
+    (void) ulIter;
+    return lKeyfobidReadKey(&prvBenchInfo, 0);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Key lookup by name, as done for NFC authentication. */
+static int32_t prvBenchKeyfobFindName( uint32_t ulIter )
+{
+    int32_t lResult;
+    uint8_t ucIndex;
+
+    (void) ulIter;
+    lResult = lKeyfobidFindKeyName((const uint8_t *) "ADMINKEY", 8, &ucIndex);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    return lKeyfobidReadKey(&prvBenchInfo, ucIndex);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Associates and removes one key. */
+static int32_t prvBenchKeyfobAddRemove( uint32_t ulIter )
+{
+    int32_t lResult;
+
+    memset(&prvBenchInfo, 0, sizeof(prvBenchInfo));
+    prvBenchInfo.ulKeyFobId = 0x100 + ulIter;
+    prvBenchInfo.ulKeyNameLen = 8;
+    memcpy(prvBenchInfo.ucKeyName, "BENCHKEY", 8);
+    lResult = lKeyfobidAddKey(&prvBenchInfo);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    return lKeyfobidRemoveKeyKeyFobID(prvBenchInfo.ulKeyFobId);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One 128 bit TRNG read. */
+static int32_t prvBenchTrng( uint32_t ulIter )
+{
+    uint32_t ulRand[4];
+
+    (void) ulIter;
+    return (int32_t) ulGenerateRandomNumber(ulRand, 4);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One 128 bit read of the TRNG hardware, bypassing the pool. */
+static int32_t prvBenchTrngRaw( uint32_t ulIter )
+{
+    uint32_t ulRand[4];
+
+    (void) ulIter;
+    return (int32_t) ulTrngReadRaw(ulRand, 4);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One 256 bit read of the shared DRBG. */
+static int32_t prvBenchDrbg( uint32_t ulIter )
+{
+    uint8_t ucRand[32];
+
+    (void) ulIter;
+    return lPrngDrbgRandom(ucRand, sizeof(ucRand));
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief BLE broadcast data for a fresh seed, as usermode does it. */
+static int32_t prvBenchPrngBle( uint32_t ulIter )
+{
+    uint8_t ucSeed[nfccommonSEED_SIZE] = {0};
+    uint8_t ucData[16];
+    int32_t lStatus;
+
+    memcpy(ucSeed, &ulIter, sizeof(ulIter));
+    lStatus = lPrngReadSeed(ucSeed, sizeof(ucSeed));
+    if( lStatus == NO_ERROR )
+    {
+	lStatus = lPrngGenerateRandom(ucData, sizeof(ucData));
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Fills the association secrets and the challenge. */
+static int32_t prvBenchAuthSetup( void )
+{
+    memset(&prvBenchAuthKey, 0, sizeof(prvBenchAuthKey));
+    if( ulGenerateRandomNumber((uint32_t *) prvBenchAuthKey.xSecKeyZ.ucTDESKey,
+	    cryto3DES_KEY_SIZE / sizeof(uint32_t)) ||
+	ulGenerateRandomNumber((uint32_t *) prvBenchAuthKey.xSecKeyX.ucTDESKey,
+	    cryto3DES_KEY_SIZE / sizeof(uint32_t)) ||
+	ulGenerateRandomNumber((uint32_t *) prvBenchAuthKey.xSecKeyY.ucTDESKey,
+	    cryto3DES_KEY_SIZE / sizeof(uint32_t)) ||
+	ulGenerateRandomNumber((uint32_t *) prvBenchChallenge.ucSeed,
+	    nfccommonSEED_SIZE / sizeof(uint32_t)) )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Cryptography of both ends of one 3DES authentication. */
+static int32_t prvBenchAuthTdes( uint32_t ulIter )
+{
+    uint8_t ucHash[commandsRAW_ACCESS_BUF_LEN] = {0};
+    uint8_t ucPeerHash[commandsRAW_ACCESS_BUF_LEN] = {0};
+    uint8_t ucBuf[commandsRAW_ACCESS_BUF_LEN];
+    uint8_t ucTmp[commandsRAW_ACCESS_BUF_LEN];
+    uint8_t *pucX = prvBenchAuthKey.xSecKeyX.ucTDESKey;
+    uint8_t *pucY = prvBenchAuthKey.xSecKeyY.ucTDESKey;
+    uint8_t *pucZ = prvBenchAuthKey.xSecKeyZ.ucTDESKey;
+    uint32_t ulLen = sizeof(NfcCommonSeed_Info_t);
+    uint32_t ulStatus;
+
+    prvBenchChallenge.ucSeed[0] = (uint8_t) ulIter;
+    /* ORWL request */
+    ulStatus = ucl_sha1(ucHash, prvBenchChallenge.ucSeed, commandsMAX_DATA_SIZE);
+    ulStatus |= ulNfcCommonEncrpytData(ucTmp, (uint8_t *) &prvBenchChallenge,
+	    pucX, ulLen);
+    ulStatus |= ulNfcCommonEncrpytData(ucBuf, ucTmp, pucZ, ulLen);
+    /* keyfob answer */
+    ulStatus |= ulNfcCommonDecrpytData(ucTmp, ucBuf, pucZ, ulLen);
+    ulStatus |= ulNfcCommonDecrpytData(ucBuf, ucTmp, pucX, ulLen);
+    ulStatus |= ucl_sha1(ucPeerHash, ucBuf, commandsMAX_DATA_SIZE);
+    ulStatus |= ulNfcCommonEncrpytData(ucTmp, ucPeerHash, pucY,
+	    cryto3DES_KEY_SIZE);
+    ulStatus |= ulNfcCommonEncrpytData(ucBuf, ucTmp, pucZ, cryto3DES_KEY_SIZE);
+    /* ORWL check */
+    ulStatus |= ulNfcCommonDecrpytData(ucTmp, ucBuf, pucZ, cryto3DES_KEY_SIZE);
+    ulStatus |= ulNfcCommonDecrpytData(ucBuf, ucTmp, pucY, cryto3DES_KEY_SIZE);
+    if( ulStatus != NO_ERROR )
+    {
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    if( ulNfcCommonVerifyKey(ucBuf, ucHash, commandsSHA_HASH_LENGTH)
+	    != eventsKEYFOB_NFC_AUTH_SUCCESS )
+    {
+	return COMMON_ERR_NO_MATCH;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Keyfob side of the AES authentication.
+ *
+ * @param pucRequest request built by ORWL.
+ * @param pucResponse filled with the response.
+ * @return NO_ERROR or the first failing status.
+ */
+static int32_t prvBenchAuthAesKeyfob( const uint8_t *pucRequest,
+				      uint8_t *pucResponse )
+{
+    nfcauthContext_t xPeer;
+    uint8_t ucMac[1 + ( 2 * nfcauthBLOCK_LEN ) + nfcauthCHALLENGE_LEN];
+    uint8_t ucTag[nfcauthTAG_LEN];
+    uint8_t ucIV[nfcauthBLOCK_LEN];
+    uint8_t ucPlain[nfcauthCHALLENGE_LEN];
+    uint8_t ucAnswer[nfcauthANSWER_LEN] = {0};
+    uint32_t ulIV[nfcauthBLOCK_LEN / sizeof(uint32_t)];
+    int32_t lStatus;
+
+    lStatus = lNfcAuthDeriveKeys(&xPeer, &prvBenchAuthKey);
+    ucMac[0] = nfcauthLABEL_REQUEST;
+    memcpy(&ucMac[1], pucRequest, nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN);
+    lStatus |= lNfcAuthCmac(ucTag, xPeer.ucMacKey, ucMac,
+	    1 + nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN);
+    if( ( lStatus != NO_ERROR ) || memcmp(ucTag,
+	    &pucRequest[nfcauthBLOCK_LEN + nfcauthCHALLENGE_LEN], nfcauthTAG_LEN) )
+    {
+	return COMMON_ERR_NO_MATCH;
+    }
+    memcpy(ucIV, pucRequest, nfcauthBLOCK_LEN);
+    lStatus |= ucl_aes_cbc(ucPlain, (uint8_t *) &pucRequest[nfcauthBLOCK_LEN],
+	    xPeer.ucEncKey, nfcauthKEY_LEN, ucIV, nfcauthCHALLENGE_LEN,
+	    UCL_CIPHER_DECRYPT);
+    lStatus |= ucl_sha1(ucAnswer, ucPlain, commandsMAX_DATA_SIZE);
+    lStatus |= (int32_t) ulGenerateRandomNumber(ulIV,
+	    nfcauthBLOCK_LEN / sizeof(uint32_t));
+    memcpy(pucResponse, ulIV, nfcauthBLOCK_LEN);
+    memcpy(ucIV, ulIV, nfcauthBLOCK_LEN);
+    lStatus |= ucl_aes_cbc(&pucResponse[nfcauthBLOCK_LEN], ucAnswer,
+	    xPeer.ucEncKey, nfcauthKEY_LEN, ucIV, nfcauthANSWER_LEN,
+	    UCL_CIPHER_ENCRYPT);
+    ucMac[0] = nfcauthLABEL_RESPONSE;
+    memcpy(&ucMac[1], pucRequest, nfcauthBLOCK_LEN);
+    memcpy(&ucMac[1 + nfcauthBLOCK_LEN], pucResponse,
+	    nfcauthBLOCK_LEN + nfcauthANSWER_LEN);
+    lStatus |= lNfcAuthCmac(&pucResponse[nfcauthBLOCK_LEN + nfcauthANSWER_LEN],
+	    xPeer.ucMacKey, ucMac, 1 + ( 2 * nfcauthBLOCK_LEN ) +
+	    nfcauthANSWER_LEN);
+    return ( lStatus == NO_ERROR ) ? NO_ERROR : COMMON_ERR_FATAL_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Cryptography of both ends of one AES authentication. */
+static int32_t prvBenchAuthAes( uint32_t ulIter )
+{
+    nfcauthContext_t xCtx;
+    uint8_t ucRequest[nfcauthREQUEST_LEN];
+    uint8_t ucResponse[nfcauthRESPONSE_LEN];
+    int32_t lStatus;
+
+    prvBenchChallenge.ucSeed[0] = (uint8_t) ulIter;
+    lStatus = lNfcAuthDeriveKeys(&xCtx, &prvBenchAuthKey);
+    if( lStatus == NO_ERROR )
+    {
+	lStatus = lNfcAuthBuildRequest(&xCtx, &prvBenchChallenge, ucRequest);
+    }
+    if( lStatus == NO_ERROR )
+    {
+	lStatus = prvBenchAuthAesKeyfob(ucRequest, ucResponse);
+    }
+    if( lStatus == NO_ERROR )
+    {
+	lStatus = lNfcAuthCheckResponse(&xCtx, ucResponse, nfcauthRESPONSE_LEN);
+    }
+    return lStatus;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Deterministic byte source for the bignum operands. */
+static int prvBenchMpiRng( void *pvState, unsigned char *pucOut, size_t xLen )
+{
+    uint32_t *pulState = (uint32_t *) pvState;
+
+    while( xLen-- )
+    {
+	*pulState = ( *pulState * 1664525UL ) + 1013904223UL;
+	*pucOut++ = (unsigned char) ( *pulState >> 24 );
+    }
+    return 0;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief X = A^E mod N by square and multiply over the schoolbook
+ * multiplication of distinct operands, the reference for mbedtls_mpi_exp_mod.
+ */
+static int32_t prvBenchMpiRefExpMod( mbedtls_mpi *pxX, const mbedtls_mpi *pxA,
+				     const mbedtls_mpi *pxE,
+				     const mbedtls_mpi *pxN )
+{
+    mbedtls_mpi xBase, xTmp;
+    int32_t lRet;
+    size_t xBit;
+
+    mbedtls_mpi_init(&xBase);
+    mbedtls_mpi_init(&xTmp);
+    lRet = mbedtls_mpi_mod_mpi(&xBase, pxA, pxN);
+    lRet |= mbedtls_mpi_lset(pxX, 1);
+    for( xBit = mbedtls_mpi_bitlen(pxE); ( lRet == 0 ) && ( xBit > 0 ); xBit-- )
+    {
+	lRet |= mbedtls_mpi_copy(&xTmp, pxX);
+	lRet |= mbedtls_mpi_mul_mpi(pxX, pxX, &xTmp);
+	lRet |= mbedtls_mpi_mod_mpi(pxX, pxX, pxN);
+	if( mbedtls_mpi_get_bit(pxE, xBit - 1) )
+	{
+	    lRet |= mbedtls_mpi_mul_mpi(pxX, pxX, &xBase);
+	    lRet |= mbedtls_mpi_mod_mpi(pxX, pxX, pxN);
+	}
+    }
+    mbedtls_mpi_free(&xBase);
+    mbedtls_mpi_free(&xTmp);
+    return lRet;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Checks squaring and Montgomery exponentiation against the
+ * reference on benchMPI_CHECKS operands, then leaves the last ones for the
+ * timed runs. The first operand is all ones to carry through every limb.
+ */
+static int32_t prvBenchMpiSetup( void )
+{
+    mbedtls_mpi xRef;
+    uint32_t ulState = 0x4F52574C;
+    uint32_t ulCheck;
+    int32_t lRet = 0;
+
+    mbedtls_mpi_init(&xRef);
+    mbedtls_mpi_free(&prvBenchMpiRR);
+    lRet |= mbedtls_mpi_lset(&prvBenchMpiE, 65537);
+    for( ulCheck = 0; ( lRet == 0 ) && ( ulCheck < benchMPI_CHECKS ); ulCheck++ )
+    {
+	if( ulCheck == 0 )
+	{
+	    lRet |= mbedtls_mpi_lset(&prvBenchMpiA, 1);
+	    lRet |= mbedtls_mpi_shift_l(&prvBenchMpiA, benchMPI_BYTES * 8);
+	    lRet |= mbedtls_mpi_sub_int(&prvBenchMpiA, &prvBenchMpiA, 1);
+	}
+	else
+	{
+	    lRet |= mbedtls_mpi_fill_random(&prvBenchMpiA, benchMPI_BYTES,
+					    prvBenchMpiRng, &ulState);
+	}
+	lRet |= mbedtls_mpi_fill_random(&prvBenchMpiN, benchMPI_BYTES,
+					prvBenchMpiRng, &ulState);
+	lRet |= mbedtls_mpi_set_bit(&prvBenchMpiN, benchMPI_BYTES * 8 - 1, 1);
+	lRet |= mbedtls_mpi_set_bit(&prvBenchMpiN, 0, 1);
+	lRet |= mbedtls_mpi_copy(&prvBenchMpiB, &prvBenchMpiA);
+
+	/* A * A on the squaring path against A * B on the schoolbook one */
+	lRet |= mbedtls_mpi_mul_mpi(&prvBenchMpiX, &prvBenchMpiA, &prvBenchMpiA);
+	lRet |= mbedtls_mpi_mul_mpi(&xRef, &prvBenchMpiA, &prvBenchMpiB);
+	if( ( lRet == 0 ) && mbedtls_mpi_cmp_mpi(&prvBenchMpiX, &xRef) )
+	{
+	    printf("bench mpi square mismatch on operand %u\n", ulCheck);
+	    lRet = COMMON_ERR_NO_MATCH;
+	}
+
+	/* Montgomery squaring and reduction against the reference */
+	lRet |= mbedtls_mpi_exp_mod(&prvBenchMpiX, &prvBenchMpiA, &prvBenchMpiE,
+				    &prvBenchMpiN, NULL);
+	lRet |= prvBenchMpiRefExpMod(&xRef, &prvBenchMpiA, &prvBenchMpiE,
+				     &prvBenchMpiN);
+	if( ( lRet == 0 ) && mbedtls_mpi_cmp_mpi(&prvBenchMpiX, &xRef) )
+	{
+	    printf("bench mpi exp_mod mismatch on operand %u\n", ulCheck);
+	    lRet = COMMON_ERR_NO_MATCH;
+	}
+    }
+    mbedtls_mpi_free(&xRef);
+    return lRet;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One product of distinct operands. */
+static int32_t prvBenchMpiMul( uint32_t ulIter )
+{
+    (void) ulIter;
+    return mbedtls_mpi_mul_mpi(&prvBenchMpiX, &prvBenchMpiA, &prvBenchMpiB);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One square. */
+static int32_t prvBenchMpiSqr( uint32_t ulIter )
+{
+    (void) ulIter;
+    return mbedtls_mpi_mul_mpi(&prvBenchMpiX, &prvBenchMpiA, &prvBenchMpiA);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One RSA public key operation, R^2 mod N cached as in rot.c. */
+static int32_t prvBenchMpiExpMod( uint32_t ulIter )
+{
+    (void) ulIter;
+    return mbedtls_mpi_exp_mod(&prvBenchMpiX, &prvBenchMpiA, &prvBenchMpiE,
+			       &prvBenchMpiN, &prvBenchMpiRR);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Checks X25519 against RFC 7748 section 6.1 and sets up the
+ * context. */
+static int32_t prvBenchEcdhSetup( void )
+{
+    static const uint8_t ucPrivate[cryptoX25519_KEY_LEN] = {
+	0x77, 0x07, 0x6d, 0x0a, 0x73, 0x18, 0xa5, 0x7d,
+	0x3c, 0x16, 0xc1, 0x72, 0x51, 0xb2, 0x66, 0x45,
+	0xdf, 0x4c, 0x2f, 0x87, 0xeb, 0xc0, 0x99, 0x2a,
+	0xb1, 0x77, 0xfb, 0xa5, 0x1d, 0xb9, 0x2c, 0x2a
+    };
+    static const uint8_t ucPublic[cryptoX25519_KEY_LEN] = {
+	0x85, 0x20, 0xf0, 0x09, 0x89, 0x30, 0xa7, 0x54,
+	0x74, 0x8b, 0x7d, 0xdc, 0xb4, 0x3e, 0xf7, 0x5a,
+	0x0d, 0xbf, 0x3a, 0x0d, 0x26, 0x38, 0x1a, 0xf4,
+	0xeb, 0xa4, 0xa9, 0x8e, 0xaa, 0x9b, 0x4e, 0x6a
+    };
+    uint8_t ucOut[cryptoX25519_KEY_LEN];
+
+    vCryptoEcdhRelease(&prvBenchEcdh);
+    vCryptoEcdhInit(&prvBenchEcdh);
+    vCryptoX25519Public(ucOut, ucPrivate);
+    if( memcmp(ucOut, ucPublic, sizeof(ucOut)) )
+    {
+	printf("bench x25519 result mismatch\n");
+	return COMMON_ERR_NO_MATCH;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One association key pair on the NIST P-192 curve. */
+static int32_t prvBenchEcdhP192( uint32_t ulIter )
+{
+    uint8_t ucKey[cryptoBUF_LEN];
+    uint32_t ulLen;
+
+    (void) ulIter;
+    return ulCryptoEcdh_PublicKeyGen(&prvBenchEcdh, cryptoCURVE_ID, ucKey,
+				     &ulLen);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One association key pair on X25519. */
+static int32_t prvBenchEcdhX25519( uint32_t ulIter )
+{
+    uint8_t ucKey[cryptoBUF_LEN];
+    uint32_t ulLen;
+
+    (void) ulIter;
+    return ulCryptoEcdh_PublicKeyGen(&prvBenchEcdh, cryptoCURVE_X25519, ucKey,
+				     &ulLen);
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief One formatted console line. */
+static int32_t prvBenchConsole( uint32_t ulIter )
+{
+    lite_printf("bench console line %d value 0x%x\n", ulIter, ulIter * 7);
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** benchmark table */
+static const benchEntry_t prvBenchTable[] = {
+    { "keyfob_write_entry",	prvBenchKeyfobSetup,	prvBenchKeyfobWrite },
+    { "keyfob_read_entry",	prvBenchKeyfobSetup,	prvBenchKeyfobRead },
+    { "keyfob_read_key",	prvBenchKeyfobSetup,	prvBenchKeyfobReadKey },
+    { "keyfob_find_name",	prvBenchKeyfobSetup,	prvBenchKeyfobFindName },
+    { "keyfob_add_remove",	prvBenchKeyfobSetup,	prvBenchKeyfobAddRemove },
+    { "trng_read_16b",		NULL,			prvBenchTrng },
+    { "trng_raw_16b",		NULL,			prvBenchTrngRaw },
+    { "drbg_read_32b",		lPrngDrbgInit,		prvBenchDrbg },
+    { "prng_ble_16b",		NULL,			prvBenchPrngBle },
+    { "nfc_auth_tdes",		prvBenchAuthSetup,	prvBenchAuthTdes },
+    { "nfc_auth_aes",		prvBenchAuthSetup,	prvBenchAuthAes },
+    { "mpi_mul_2048",		prvBenchMpiSetup,	prvBenchMpiMul },
+    { "mpi_sqr_2048",		prvBenchMpiSetup,	prvBenchMpiSqr },
+    { "mpi_exp_mod_2048",	prvBenchMpiSetup,	prvBenchMpiExpMod },
+    { "ecdh_keygen_p192",	prvBenchEcdhSetup,	prvBenchEcdhP192 },
+    { "ecdh_keygen_x25519",	prvBenchEcdhSetup,	prvBenchEcdhX25519 },
+    { "console_printf",		NULL,			prvBenchConsole },
+};
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Runs and reports one benchmark.
+ *
+ * @param pxEntry benchmark.
+ * @param ulIters number of iterations.
+ * @return NO_ERROR or the first failing status.
+ */
+static int32_t prvBenchRun( const benchEntry_t *pxEntry, uint32_t ulIters )
+{
+    simFlashStats_t xFlash;
+    uint64_t ullMin = UINT64_MAX;
+    uint64_t ullMax = 0;
+    uint64_t ullSum = 0;
+    uint64_t ullStart;
+    uint64_t ullTime;
+    uint32_t ulIter;
+    int32_t lResult = NO_ERROR;
+
+    if( pxEntry->lSetup )
+    {
+	lResult = pxEntry->lSetup( );
+	if( lResult != NO_ERROR )
+	{
+	    printf("bench %s setup failed 0x%x\n", pxEntry->pcName, lResult);
+	    return lResult;
+	}
+    }
+
+    vSimFlashResetStats( );
+    vSimUartConsoleMute(1);
+    for( ulIter = 0; ulIter < ulIters; ulIter++ )
+    {
+	ullStart = ullSimNowNs( );
+	lResult = pxEntry->lRun(ulIter);
+	ullTime = ullSimNowNs( ) - ullStart;
+	if( lResult != NO_ERROR )
+	{
+	    break;
+	}
+	ullSum += ullTime;
+	ullMin = ( ullTime < ullMin ) ? ullTime : ullMin;
+	ullMax = ( ullTime > ullMax ) ? ullTime : ullMax;
+    }
+    vSimUartConsoleMute(0);
+    vSimFlashGetStats(&xFlash);
+
+    if( lResult != NO_ERROR )
+    {
+	printf("bench %s failed at iteration %u status 0x%x\n", pxEntry->pcName,
+		ulIter, lResult);
+	return lResult;
+    }
+    printf("bench %s iters=%u min_ns=%llu avg_ns=%llu max_ns=%llu "
+	    "erases=%u writes=%u\n", pxEntry->pcName, ulIters,
+	    (unsigned long long) ullMin,
+	    (unsigned long long) ( ullSum / ulIters ),
+	    (unsigned long long) ullMax, xFlash.ulPageErases, xFlash.ulWrites);
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Benchmark task; runs the table and ends the simulation.
+ *
+ * @param pvArg unused.
+ */
+static void prvBenchTask( void *pvArg )
+{
+    const char *pcIters;
+    const char *pcFilter;
+    uint32_t ulIters = benchDEFAULT_ITERS;
+    uint32_t ulIndex;
+    int32_t lStatus = NO_ERROR;
+
+    (void) pvArg;
+    pcIters = getenv(simENV_BENCH_ITERS);
+    if( pcIters && ( atoi(pcIters) > 0 ) )
+    {
+	ulIters = (uint32_t) atoi(pcIters);
+    }
+    /* a value other than "all" selects benchmarks by name prefix */
+    pcFilter = getenv(simENV_BENCH);
+
+    for( ulIndex = 0;
+	 ulIndex < ( sizeof(prvBenchTable) / sizeof(prvBenchTable[0]) );
+	 ulIndex++ )
+    {
+	if( strcmp(pcFilter, "all") &&
+	    strncmp(prvBenchTable[ulIndex].pcName, pcFilter, strlen(pcFilter)) )
+	{
+	    continue;
+	}
+	if( prvBenchRun(&prvBenchTable[ulIndex], ulIters) != NO_ERROR )
+	{
+	    lStatus = EXIT_FAILURE;
+	}
+    }
+    vSimExit(lStatus);
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimBenchStart( void )
+{
+    if( getenv(simENV_BENCH) == NULL )
+    {
+	return;
+    }
+    if( xTaskCreate(prvBenchTask, "SimBench", benchSTACK_SIZE, NULL,
+	    benchPRIORITY, NULL) != pdPASS )
+    {
+	fprintf(stderr, "sim: unable to create benchmark task\n");
+	vSimExit(EXIT_FAILURE);
+    }
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
@@ -0,0 +1,220 @@
+ /**===========================================================================
+ * @file sim_core.c
+ *
+ * @brief This file contains the core of the host simulation. It maps the SoC
+ * address space into the process before main() runs, provides the linker
+ * symbols of the target image and runs the register model which services
+ * the self clearing and status bits of the simulated peripherals.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_gcr.h>
+#include <mml_gcr_regs.h>
+#include <mml_intc.h>
+
+/* simulation includes */
+#include <sim.h>
+#include "sim_private.h"
+
+/**
+ * Vector table and NMI section of the target image. The host build links
+ * __section_nvic_start and the __section_nmi_code_* symbols to these
+ * objects through --defsym, see build.mk.
+ */
+uint32_t ulSimVectorTable[simVECTOR_COUNT];
+uint32_t ulSimNmiCode[1];
+
+/** process arguments, kept to re-execute on system reset */
+static char **prvSimArgv;
+
+/** installed interrupt handlers */
+static void (*prvSimIrqTable[MML_INTNUM_COUNT])( void );
+
+/** register model thread */
+static pthread_t prvSimRegModel;
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Register model.
+ *
+ * Clears self clearing reset bits and keeps the TRNG supplied with data, the
+ * way the silicon does asynchronously to the core.
+ *
+ * @param pvArg unused.
+ * @return never returns.
+ */
+static void *prvSimRegModelThread( void *pvArg )
+{
+    volatile mml_gcr_regs_t *pxGcr = (volatile mml_gcr_regs_t *)MML_GCR_IOBASE;
+    struct timespec xPeriod = { 0, simREG_MODEL_PERIOD_US * 1000 };
+
+    (void) pvArg;
+    for( ;; )
+    {
+	/* reset requests complete immediately */
+	pxGcr->rstr = 0;
+	vSimTrngService( );
+	nanosleep(&xPeriod, NULL);
+    }
+    return NULL;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Maps a fixed region of the SoC address space.
+ *
+ * @param ulBase base address.
+ * @param ulSize size of region.
+ * @return NO_ERROR on success.
+ */
+static int32_t prvSimMapRegion( uint32_t ulBase, uint32_t ulSize )
+{
+    void *pvMap;
+
+    pvMap = mmap((void *)(uintptr_t)ulBase, ulSize, PROT_READ | PROT_WRITE,
+	    MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if( pvMap != (void *)(uintptr_t)ulBase )
+    {
+	fprintf(stderr, "sim: unable to map 0x%08x..0x%08x\n", ulBase,
+		ulBase + ulSize);
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Simulation start up; runs before the firmware main().
+ *
+ * @param lArgc argument count.
+ * @param ppcArgv argument vector.
+ */
+__attribute__ ((constructor))
+static void prvSimInit( int lArgc, char **ppcArgv )
+{
+    (void) lArgc;
+    prvSimArgv = ppcArgv;
+
+    /* unbuffered console keeps the output ordered with stderr */
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    if( prvSimMapRegion(MML_MEM_PERIPH_BASE, MML_MEM_PERIPH_SIZE)
+	    != NO_ERROR )
+    {
+	exit(EXIT_FAILURE);
+    }
+    if( lSimFlashMap( ) != NO_ERROR )
+    {
+	exit(EXIT_FAILURE);
+    }
+    if( pthread_create(&prvSimRegModel, NULL, prvSimRegModelThread, NULL) )
+    {
+	fprintf(stderr, "sim: unable to start register model\n");
+	exit(EXIT_FAILURE);
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+uint64_t ullSimNowNs( void )
+{
+    struct timespec xNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &xNow);
+    return ((uint64_t) xNow.tv_sec * 1000000000ULL) + (uint64_t) xNow.tv_nsec;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimExit( int32_t lStatus )
+{
+    vSimFlashSync( );
+    fflush(stdout);
+    fflush(stderr);
+    _exit((int) lStatus);
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimAssertCalled( const char *pcFile, unsigned long ulLine )
+{
+    fprintf(stderr, "sim: assert failed at %s:%lu\n", pcFile, ulLine);
+    vSimFlashSync( );
+    abort( );
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_set_system_frequency( mml_gcr_sysfreq_t eFreq )
+{
+    (void) eFreq;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+void mml_reset_system( void )
+{
+    /* a system reset restarts the image; flash contents survive */
+    vSimFlashSync( );
+    fflush(stdout);
+    execv("/proc/self/exe", prvSimArgv);
+    /* exec failed, behave like a power off */
+    vSimExit(EXIT_FAILURE);
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_intc_setup_irq( mml_intc_id_t eId, mml_intc_prio_t ePrio,
+			void (*pvHandler)( void ) )
+{
+    (void) ePrio;
+    if( eId >= MML_INTNUM_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    prvSimIrqTable[eId] = pvHandler;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimIntcRaise( mml_intc_id_t eId )
+{
+    if( ( eId < MML_INTNUM_COUNT ) && prvSimIrqTable[eId] )
+    {
+	prvSimIrqTable[eId]( );
+    }
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
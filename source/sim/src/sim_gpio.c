@@ -0,0 +1,366 @@
+ /**===========================================================================
+ * @file sim_gpio.c
+ *
+ * @brief This file contains the simulated GPIO ports. Pin levels live in the
+ * register window; driving an input through sim.h raises the port interrupt
+ * synchronously when the pin is armed.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stddef.h>
+#include <stdint.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_gpio.h>
+#include <mml_gpio_regs.h>
+#include <mml_intc.h>
+
+/* simulation includes */
+#include <sim.h>
+
+/** register windows of the ports */
+static volatile mml_gpio_regs_t * const prvGpioRegs[MML_GPIO_DEV_COUNT] = {
+    (volatile mml_gpio_regs_t *) MML_GPIO0_IOBASE,
+    (volatile mml_gpio_regs_t *) MML_GPIO1_IOBASE,
+    (volatile mml_gpio_regs_t *) MML_GPIO2_IOBASE,
+};
+
+/** interrupt line of the ports */
+static const mml_intc_id_t prvGpioIrq[MML_GPIO_DEV_COUNT] = {
+    MML_INTNUM_GPIO0, MML_INTNUM_GPIO1, MML_INTNUM_GPIO2
+};
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Validates a port and pin range and builds its mask.
+ *
+ * @param id GPIO port.
+ * @param offset first pin.
+ * @param bits_count number of pins.
+ * @param pulMask mask output.
+ * @return NO_ERROR or MML_GPIO_ERR_OUT_OF_RANGE.
+ */
+static int prvGpioMask( mml_gpio_id_t id, int offset, int bits_count,
+			uint32_t *pulMask )
+{
+    if( ( id >= MML_GPIO_DEV_COUNT ) || ( offset < MML_GPIO_BIT_RANGE_MIN ) ||
+	( bits_count < 1 ) ||
+	( ( offset + bits_count ) > MML_GPIO_BIT_RANGE_NB ) )
+    {
+	return MML_GPIO_ERR_OUT_OF_RANGE;
+    }
+    *pulMask = ( bits_count == MML_GPIO_BIT_RANGE_NB ) ? 0xFFFFFFFFU :
+	    ( ( ( 1U << bits_count ) - 1 ) << offset );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_init( mml_gpio_id_t id, int offset, int bits_count,
+		   mml_gpio_config_t config )
+{
+    return mml_gpio_set_config(id, offset, bits_count, config);
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_reset_interface( void )
+{
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_set_config( mml_gpio_id_t id, int offset, int bits_count,
+			 mml_gpio_config_t config )
+{
+    uint32_t ulMask;
+    int lResult;
+    volatile mml_gpio_regs_t *pxRegs;
+
+    lResult = prvGpioMask(id, offset, bits_count, &ulMask);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    pxRegs = prvGpioRegs[id];
+    pxRegs->en |= ulMask;
+    if( config.gpio_direction == MML_GPIO_DIR_OUT )
+    {
+	pxRegs->out_en |= ulMask;
+    }
+    else
+    {
+	pxRegs->out_en &= ~ulMask;
+	/* an unconnected pulled up input reads high */
+	if( config.gpio_pad_config == MML_GPIO_PAD_PULLUP )
+	{
+	    pxRegs->in |= ulMask;
+	}
+    }
+    if( config.gpio_intr_mode == MML_GPIO_INT_MODE_EDGE_TRIGGERED )
+    {
+	pxRegs->int_mod |= ulMask;
+    }
+    else
+    {
+	pxRegs->int_mod &= ~ulMask;
+    }
+    if( config.gpio_intr_polarity )
+    {
+	pxRegs->int_pol |= ulMask;
+    }
+    else
+    {
+	pxRegs->int_pol &= ~ulMask;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_write_bit_pattern( mml_gpio_id_t id, int offset, int bits_count,
+				unsigned int data )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    lResult = prvGpioMask(id, offset, bits_count, &ulMask);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    prvGpioRegs[id]->out = ( prvGpioRegs[id]->out & ~ulMask ) |
+	    ( ( data << offset ) & ulMask );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_read_bit_pattern( mml_gpio_id_t id, int offset, int bits_count,
+			       unsigned int *p_data )
+{
+    uint32_t ulMask;
+    uint32_t ulLevels;
+    int lResult;
+    volatile mml_gpio_regs_t *pxRegs;
+
+    if( p_data == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    lResult = prvGpioMask(id, offset, bits_count, &ulMask);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    /* outputs read back their driven level */
+    pxRegs = prvGpioRegs[id];
+    ulLevels = ( pxRegs->out & pxRegs->out_en ) | ( pxRegs->in & ~pxRegs->out_en );
+    *p_data = ( ulLevels & ulMask ) >> offset;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_pin_input( mml_gpio_id_t id, int offset,
+			mml_gpio_pin_data_t *p_input )
+{
+    unsigned int ulLevel;
+    int lResult;
+
+    if( p_input == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    lResult = mml_gpio_read_bit_pattern(id, offset, 1, &ulLevel);
+    if( lResult == NO_ERROR )
+    {
+	*p_input = ( ulLevel ) ? MML_GPIO_OUT_LOGIC_ONE : MML_GPIO_OUT_LOGIC_ZERO;
+    }
+    return lResult;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_set_int_trigger_mode( mml_gpio_id_t id, int offset,
+				   uint32_t mode )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    lResult = prvGpioMask(id, offset, 1, &ulMask);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    if( mode == MML_GPIO_INT_MODE_EDGE_TRIGGERED )
+    {
+	prvGpioRegs[id]->int_mod |= ulMask;
+    }
+    else
+    {
+	prvGpioRegs[id]->int_mod &= ~ulMask;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_set_int_pol( mml_gpio_id_t id, int offset, uint32_t pol )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    lResult = prvGpioMask(id, offset, 1, &ulMask);
+    if( lResult != NO_ERROR )
+    {
+	return lResult;
+    }
+    if( pol )
+    {
+	prvGpioRegs[id]->int_pol |= ulMask;
+    }
+    else
+    {
+	prvGpioRegs[id]->int_pol &= ~ulMask;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_enable_interrupt( mml_gpio_id_t id, int offset, int bits_count )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    lResult = prvGpioMask(id, offset, bits_count, &ulMask);
+    if( lResult == NO_ERROR )
+    {
+	prvGpioRegs[id]->int_en |= ulMask;
+    }
+    return lResult;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_disable_interrupt( mml_gpio_id_t id, int offset, int bits_count )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    lResult = prvGpioMask(id, offset, bits_count, &ulMask);
+    if( lResult == NO_ERROR )
+    {
+	prvGpioRegs[id]->int_en &= ~ulMask;
+    }
+    return lResult;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_clear_interrupt( mml_gpio_id_t id, int offset, int bits_count )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    lResult = prvGpioMask(id, offset, bits_count, &ulMask);
+    if( lResult == NO_ERROR )
+    {
+	prvGpioRegs[id]->int_stat &= ~ulMask;
+    }
+    return lResult;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_gpio_get_interrupt_status( mml_gpio_id_t id, int offset_min,
+				   int offset_max, int *p_status )
+{
+    uint32_t ulMask;
+    int lResult;
+
+    if( p_status == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    lResult = prvGpioMask(id, offset_min, offset_max - offset_min + 1, &ulMask);
+    if( lResult == NO_ERROR )
+    {
+	*p_status = (int) ( prvGpioRegs[id]->int_stat & ulMask );
+    }
+    return lResult;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimGpioSetInput( mml_gpio_id_t eId, uint32_t ulPin, uint32_t ulLevel )
+{
+    volatile mml_gpio_regs_t *pxRegs;
+    uint32_t ulMask;
+    uint32_t ulOld;
+    uint32_t ulFire;
+
+    if( ( eId >= MML_GPIO_DEV_COUNT ) || ( ulPin > MML_GPIO_BIT_RANGE_MAX ) )
+    {
+	return;
+    }
+    pxRegs = prvGpioRegs[eId];
+    ulMask = 1U << ulPin;
+    ulOld = pxRegs->in & ulMask;
+    if( ulLevel )
+    {
+	pxRegs->in |= ulMask;
+    }
+    else
+    {
+	pxRegs->in &= ~ulMask;
+    }
+
+    if( pxRegs->int_mod & ulMask )
+    {
+	/* edge: rising for high polarity, falling for low polarity */
+	ulFire = ( ( pxRegs->int_pol & ulMask ) ? ( !ulOld && ulLevel )
+						: ( ulOld && !ulLevel ) );
+    }
+    else
+    {
+	/* level: active while the pin matches the polarity */
+	ulFire = ( ( pxRegs->int_pol & ulMask ) ? ulLevel : !ulLevel );
+    }
+
+    if( ulFire && ( pxRegs->int_en & ulMask ) )
+    {
+	pxRegs->int_stat |= ulMask;
+	vSimIntcRaise(prvGpioIrq[eId]);
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulSimGpioGetOutput( mml_gpio_id_t eId, uint32_t ulPin )
+{
+    if( ( eId >= MML_GPIO_DEV_COUNT ) || ( ulPin > MML_GPIO_BIT_RANGE_MAX ) )
+    {
+	return 0;
+    }
+    return ( prvGpioRegs[eId]->out >> ulPin ) & 1U;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
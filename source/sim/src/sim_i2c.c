@@ -0,0 +1,307 @@
+ /**===========================================================================
+ * @file sim_i2c.c
+ *
+ * @brief This file contains the simulated I2C master. Transfers complete
+ * immediately against register file slave models attached through sim.h; the
+ * first byte written after a start selects the register, further bytes are
+ * written with auto increment. The handler given to mml_i2c_init() is raised
+ * after every start and write, as the FIFO interrupt of the controller would.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <string.h>
+#include <stdint.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_i2c.h>
+#include <mml_i2c_regs.h>
+
+/* simulation includes */
+#include <sim.h>
+
+/**
+ * size of the simulated receive FIFO
+ */
+#define i2cRX_FIFO_SIZE		( simI2C_REG_COUNT )
+
+/** attached slaves */
+static simI2cSlave_t *prvI2cSlaves;
+
+/** slave of the transfer in progress */
+static simI2cSlave_t *prvI2cActive;
+
+/** a register pointer byte is expected next */
+static uint32_t prvI2cExpectReg;
+
+/** programmed read length */
+static uint32_t prvI2cReadCount = 1;
+
+/** receive FIFO */
+static uint8_t prvI2cRxFifo[i2cRX_FIFO_SIZE];
+static uint32_t prvI2cRxLen;
+static uint32_t prvI2cRxPos;
+
+/** handler installed by mml_i2c_init() */
+static irq_handler_t prvI2cHandler;
+
+/** the handler is running */
+static uint32_t prvI2cInIrq;
+
+/** the handler is raised again when it returns */
+static uint32_t prvI2cIrqPending;
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Looks up an attached slave.
+ *
+ * @param ucAddr 7 bit address.
+ * @return slave or NULL.
+ */
+static simI2cSlave_t *prvI2cFind( uint8_t ucAddr )
+{
+    simI2cSlave_t *pxSlave;
+
+    for( pxSlave = prvI2cSlaves; pxSlave; pxSlave = pxSlave->pxNext )
+    {
+	if( pxSlave->ucAddr == ucAddr )
+	{
+	    break;
+	}
+    }
+    return pxSlave;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Writes bytes to the active slave.
+ *
+ * @param pucData bytes.
+ * @param ulLen byte count.
+ */
+static void prvI2cPush( const uint8_t *pucData, uint32_t ulLen )
+{
+    uint32_t ulIndex;
+
+    for( ulIndex = 0; ulIndex < ulLen; ulIndex++ )
+    {
+	if( prvI2cExpectReg )
+	{
+	    prvI2cActive->ucRegPtr = pucData[ulIndex];
+	    prvI2cExpectReg = 0;
+	    continue;
+	}
+	prvI2cActive->ucRegs[prvI2cActive->ucRegPtr] = pucData[ulIndex];
+	if( prvI2cActive->vOnWrite )
+	{
+	    prvI2cActive->vOnWrite(prvI2cActive, prvI2cActive->ucRegPtr);
+	}
+	prvI2cActive->ucRegPtr++;
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Raises the controller interrupt. A request from inside the handler
+ * is delivered when the handler returns.
+ */
+static void prvI2cRaise( void )
+{
+    if( prvI2cHandler == NULL )
+    {
+	return;
+    }
+    if( prvI2cInIrq )
+    {
+	prvI2cIrqPending = 1;
+	return;
+    }
+    prvI2cInIrq = 1;
+    do
+    {
+	prvI2cIrqPending = 0;
+	prvI2cHandler( );
+    } while( prvI2cIrqPending );
+    prvI2cInIrq = 0;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lSimI2cAttach( simI2cSlave_t *pxSlave )
+{
+    if( pxSlave == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( prvI2cFind(pxSlave->ucAddr) )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    pxSlave->pxNext = prvI2cSlaves;
+    prvI2cSlaves = pxSlave;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_init( mml_i2c_config_t *config )
+{
+    if( config == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    prvI2cActive = NULL;
+    prvI2cRxLen = 0;
+    prvI2cRxPos = 0;
+    prvI2cHandler = config->irq_handler;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_write_start( unsigned char address, const unsigned char *data,
+			 unsigned int *plength )
+{
+    if( ( data == NULL ) || ( plength == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    prvI2cActive = prvI2cFind(address);
+    if( prvI2cActive == NULL )
+    {
+	return MML_I2C_ERR_NACK;
+    }
+    prvI2cExpectReg = 1;
+    prvI2cPush(data, *plength);
+    prvI2cRaise( );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_write( unsigned char *data, unsigned int *plength )
+{
+    if( ( data == NULL ) || ( plength == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( prvI2cActive == NULL )
+    {
+	return COMMON_ERR_BAD_STATE;
+    }
+    prvI2cPush(data, *plength);
+    prvI2cRaise( );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_read_start( unsigned char address )
+{
+    uint32_t ulIndex;
+
+    prvI2cActive = prvI2cFind(address);
+    if( prvI2cActive == NULL )
+    {
+	return MML_I2C_ERR_NACK;
+    }
+    /* the whole programmed read lands in the FIFO at once */
+    for( ulIndex = 0; ulIndex < prvI2cReadCount; ulIndex++ )
+    {
+	prvI2cRxFifo[ulIndex] = prvI2cActive->ucRegs[prvI2cActive->ucRegPtr++];
+    }
+    prvI2cRxLen = prvI2cReadCount;
+    prvI2cRxPos = 0;
+    prvI2cRaise( );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_read( unsigned char *data, unsigned int *plength )
+{
+    uint32_t ulCount;
+
+    if( ( data == NULL ) || ( plength == NULL ) )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    ulCount = prvI2cRxLen - prvI2cRxPos;
+    if( *plength < ulCount )
+    {
+	ulCount = *plength;
+    }
+    memcpy(data, &prvI2cRxFifo[prvI2cRxPos], ulCount);
+    prvI2cRxPos += ulCount;
+    *plength = ulCount;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_ioctl( mml_i2c_ioctl_t command, void *data )
+{
+    switch( command )
+    {
+	case MML_I2C_SET_READCOUNT:
+	    if( data == NULL )
+	    {
+		return COMMON_ERR_NULL_PTR;
+	    }
+	    if( ( *(unsigned int *) data == 0 ) ||
+		( *(unsigned int *) data > i2cRX_FIFO_SIZE ) )
+	    {
+		return COMMON_ERR_OUT_OF_RANGE;
+	    }
+	    prvI2cReadCount = *(unsigned int *) data;
+	    break;
+	case MML_I2C_RXFLUSH:
+	    prvI2cRxLen = 0;
+	    prvI2cRxPos = 0;
+	    break;
+	case MML_I2C_TXFLUSH:
+	case MML_I2C_SET_FREQ:
+	    break;
+	default:
+	    return COMMON_ERR_INVAL;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_i2c_bus_status( unsigned int *pstatus )
+{
+    if( pstatus == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    /* the bus is never busy and TX always drained; RX empty reflects the
+     * FIFO */
+    *pstatus = MML_I2C_SR_TXEMPTY_MASK;
+    if( prvI2cRxPos >= prvI2cRxLen )
+    {
+	*pstatus |= MML_I2C_SR_RXEMPTY_MASK;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
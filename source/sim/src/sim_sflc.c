@@ -0,0 +1,261 @@
+ /**===========================================================================
+ * @file sim_sflc.c
+ *
+ * @brief This file contains the simulated flash controller. The flash array is a
+ * shared file mapping at MML_MEM_FLASH_BASE which behaves like NOR flash:
+ * erase sets a page to 0xFF and programming can only clear bits.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_sflc.h>
+
+/* simulation includes */
+#include <sim.h>
+#include "sim_private.h"
+
+/**
+ * number of pages of the simulated flash
+ */
+#define sflcPAGE_COUNT		( MML_MEM_FLASH_SIZE / MML_SFLC_PAGE_SIZE )
+
+/**
+ * erased flash byte
+ */
+#define sflcERASED_BYTE		( 0xFF )
+
+/** flash array */
+static uint8_t *prvSflcArray;
+
+/** activity counters */
+static simFlashStats_t prvSflcStats;
+
+/** per page erase counters */
+static uint32_t prvSflcPageErases[sflcPAGE_COUNT];
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Validates a flash range.
+ *
+ * @param ulAddress start address.
+ * @param ulLength number of bytes.
+ * @return NO_ERROR if the range lies inside the flash.
+ */
+static int32_t prvSflcCheckRange( uint32_t ulAddress, uint32_t ulLength )
+{
+    if( ( ulAddress < MML_MEM_FLASH_BASE ) ||
+	( ulLength > MML_MEM_FLASH_SIZE ) ||
+	( ( ulAddress - MML_MEM_FLASH_BASE ) > ( MML_MEM_FLASH_SIZE - ulLength ) ) )
+    {
+	return N_MML_SFLC_ERR_NOT_ACCESSIBLE;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lSimFlashMap( void )
+{
+    const char *pcPath;
+    int lFd;
+    off_t xSize;
+    void *pvMap;
+
+    pcPath = getenv(simENV_FLASH_IMAGE);
+    if( pcPath == NULL )
+    {
+	pcPath = simDEFAULT_FLASH_IMAGE;
+    }
+
+    lFd = open(pcPath, O_RDWR | O_CREAT, 0600);
+    if( lFd < 0 )
+    {
+	fprintf(stderr, "sim: unable to open flash image %s\n", pcPath);
+	return COMMON_ERR_FATAL_ERROR;
+    }
+
+    /* a new image starts out erased */
+    xSize = lseek(lFd, 0, SEEK_END);
+    if( xSize < (off_t) MML_MEM_FLASH_SIZE )
+    {
+	uint8_t ucErased[MML_SFLC_PAGE_SIZE];
+
+	memset(ucErased, sflcERASED_BYTE, sizeof(ucErased));
+	while( xSize < (off_t) MML_MEM_FLASH_SIZE )
+	{
+	    if( pwrite(lFd, ucErased, sizeof(ucErased), xSize)
+		    != (ssize_t) sizeof(ucErased) )
+	    {
+		close(lFd);
+		return COMMON_ERR_FATAL_ERROR;
+	    }
+	    xSize += sizeof(ucErased);
+	}
+    }
+
+    pvMap = mmap((void *)(uintptr_t)MML_MEM_FLASH_BASE, MML_MEM_FLASH_SIZE,
+	    PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED_NOREPLACE, lFd, 0);
+    close(lFd);
+    if( pvMap != (void *)(uintptr_t)MML_MEM_FLASH_BASE )
+    {
+	fprintf(stderr, "sim: unable to map flash image %s\n", pcPath);
+	return COMMON_ERR_FATAL_ERROR;
+    }
+    prvSflcArray = (uint8_t *) pvMap;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimFlashSync( void )
+{
+    if( prvSflcArray )
+    {
+	msync(prvSflcArray, MML_MEM_FLASH_SIZE, MS_SYNC);
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimFlashGetStats( simFlashStats_t *pxStats )
+{
+    uint32_t ulPage;
+
+    prvSflcStats.ulMaxPageErases = 0;
+    for( ulPage = 0; ulPage < sflcPAGE_COUNT; ulPage++ )
+    {
+	if( prvSflcPageErases[ulPage] > prvSflcStats.ulMaxPageErases )
+	{
+	    prvSflcStats.ulMaxPageErases = prvSflcPageErases[ulPage];
+	}
+    }
+    *pxStats = prvSflcStats;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimFlashResetStats( void )
+{
+    memset(&prvSflcStats, 0, sizeof(prvSflcStats));
+    memset(prvSflcPageErases, 0, sizeof(prvSflcPageErases));
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_sflc_init( void )
+{
+    return ( prvSflcArray ) ? NO_ERROR : COMMON_ERR_NOT_INITIALIZED;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_sflc_read( unsigned int address, unsigned char *p_data,
+		   unsigned int length )
+{
+    int32_t lStatus;
+
+    if( p_data == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    lStatus = prvSflcCheckRange(address, length);
+    if( lStatus != NO_ERROR )
+    {
+	return lStatus;
+    }
+    memcpy(p_data, &prvSflcArray[address - MML_MEM_FLASH_BASE], length);
+    prvSflcStats.ulReads++;
+    prvSflcStats.ulBytesRead += length;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_sflc_write( unsigned int address, unsigned char *p_data,
+		    unsigned int length )
+{
+    int32_t lStatus;
+    uint8_t *pucDst;
+    uint32_t ulIndex;
+
+    if( p_data == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    lStatus = prvSflcCheckRange(address, length);
+    if( lStatus != NO_ERROR )
+    {
+	return lStatus;
+    }
+    /* programming can only clear bits */
+    pucDst = &prvSflcArray[address - MML_MEM_FLASH_BASE];
+    for( ulIndex = 0; ulIndex < length; ulIndex++ )
+    {
+	pucDst[ulIndex] &= p_data[ulIndex];
+    }
+    prvSflcStats.ulWrites++;
+    prvSflcStats.ulBytesWritten += length;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_sflc_erase( unsigned int address, unsigned int length )
+{
+    int32_t lStatus;
+    uint32_t ulFirst;
+    uint32_t ulLast;
+    uint32_t ulPage;
+
+    if( length == 0 )
+    {
+	return NO_ERROR;
+    }
+    lStatus = prvSflcCheckRange(address, length);
+    if( lStatus != NO_ERROR )
+    {
+	return lStatus;
+    }
+    /* erase works on whole pages */
+    ulFirst = ( address - MML_MEM_FLASH_BASE ) / MML_SFLC_PAGE_SIZE;
+    ulLast = ( address - MML_MEM_FLASH_BASE + length - 1 ) / MML_SFLC_PAGE_SIZE;
+    for( ulPage = ulFirst; ulPage <= ulLast; ulPage++ )
+    {
+	memset(&prvSflcArray[ulPage * MML_SFLC_PAGE_SIZE], sflcERASED_BYTE,
+		MML_SFLC_PAGE_SIZE);
+	prvSflcPageErases[ulPage]++;
+	prvSflcStats.ulPageErases++;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
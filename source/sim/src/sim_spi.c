@@ -0,0 +1,132 @@
+ /**===========================================================================
+ * @file sim_spi.c
+ *
+ * @brief This file contains the simulated SPI ports. Transmitted data is
+ * counted and handed to an optional per port sink.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stddef.h>
+#include <stdint.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_spi.h>
+
+/* simulation includes */
+#include <sim.h>
+
+/**
+ * @brief State of a simulated SPI port.
+ */
+typedef struct
+{
+    /** port initialized */
+    uint32_t	ulInit;
+    /** port enabled */
+    uint32_t	ulEnabled;
+    /** transmitted bytes */
+    uint32_t	ulTxCount;
+    /** byte sink */
+    void	(*vSink)( const uint8_t *pucData, uint32_t ulLen );
+} simSpi_t;
+
+/** simulated ports */
+static simSpi_t prvSpi[MML_SPI_DEV_COUNT];
+
+/*----------------------------------------------------------------------------*/
+
+int mml_spi_init( mml_spi_dev_t devnum, mml_spi_params_t *pparams )
+{
+    if( devnum >= MML_SPI_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if( pparams == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    prvSpi[devnum].ulInit = 1;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_spi_enable( mml_spi_dev_t devnum )
+{
+    if( devnum >= MML_SPI_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    prvSpi[devnum].ulEnabled = 1;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_spi_transmit( mml_spi_dev_t devnum, unsigned char *data,
+		      unsigned int length )
+{
+    if( devnum >= MML_SPI_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if( data == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( !prvSpi[devnum].ulInit )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+    prvSpi[devnum].ulTxCount += length;
+    if( prvSpi[devnum].vSink )
+    {
+	prvSpi[devnum].vSink(data, length);
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimSpiSetSink( mml_spi_dev_t eId,
+		     void (*vSink)( const uint8_t *pucData, uint32_t ulLen ) )
+{
+    if( eId < MML_SPI_DEV_COUNT )
+    {
+	prvSpi[eId].vSink = vSink;
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulSimSpiTxCount( mml_spi_dev_t eId )
+{
+    return ( eId < MML_SPI_DEV_COUNT ) ? prvSpi[eId].ulTxCount : 0;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
@@ -0,0 +1,305 @@
+ /**===========================================================================
+ * @file sim_sys.c
+ *
+ * @brief This file contains the simulated timers and RTC. Hardware timers are
+ * backed by FreeRTOS software timers, the RTC by the host wall clock.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_tmr.h>
+#include <rtc.h>
+
+/* RTOS includes */
+#include <FreeRTOS.h>
+#include <timers.h>
+
+/* simulation includes */
+#include <sim.h>
+
+/**
+ * @brief State of a simulated hardware timer.
+ */
+typedef struct
+{
+    /** configuration from mml_tmr_init() */
+    mml_tmr_config_t	xConfig;
+    /** backing software timer */
+    TimerHandle_t	xTimer;
+    /** host time of the last enable */
+    uint64_t		ullStartNs;
+    /** timer running */
+    uint32_t		ulRunning;
+    /** interrupt enabled */
+    uint32_t		ulIrqEnabled;
+} simTmr_t;
+
+/** simulated timers */
+static simTmr_t prvTmr[MML_TMR_DEV_COUNT];
+
+/** RTC offset to the host clock in seconds */
+static int64_t prvRtcOffset;
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Timer period in nanoseconds.
+ *
+ * @param pxTmr timer.
+ * @return period.
+ */
+static uint64_t prvTmrPeriodNs( simTmr_t *pxTmr )
+{
+    uint64_t ullTicks;
+
+    ullTicks = (uint64_t) pxTmr->xConfig.timeout << pxTmr->xConfig.clock;
+    return ( ullTicks * 1000000000ULL ) / MML_SYS_FREQ;
+}
+/*----------------------------------------------------------------------------*/
+
+/** @brief Software timer callback; runs the timer interrupt handler.
+ *
+ * @param xTimer expired timer.
+ */
+static void prvTmrExpired( TimerHandle_t xTimer )
+{
+    simTmr_t *pxTmr = (simTmr_t *) pvTimerGetTimerID(xTimer);
+
+    if( pxTmr->xConfig.mode == MML_TMR_MODE_ONE_SHOT )
+    {
+	pxTmr->ulRunning = 0;
+    }
+    else
+    {
+	pxTmr->ullStartNs = ullSimNowNs( );
+    }
+    if( pxTmr->ulIrqEnabled && pxTmr->xConfig.handler )
+    {
+	pxTmr->xConfig.handler( );
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_init( mml_tmr_id_t id, mml_tmr_config_t *config )
+{
+    TickType_t xPeriod;
+    simTmr_t *pxTmr;
+
+    if( id >= MML_TMR_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if( config == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    pxTmr = &prvTmr[id];
+    pxTmr->xConfig = *config;
+    xPeriod = pdMS_TO_TICKS(prvTmrPeriodNs(pxTmr) / 1000000ULL);
+    if( xPeriod == 0 )
+    {
+	xPeriod = 1;
+    }
+    if( pxTmr->xTimer == NULL )
+    {
+	pxTmr->xTimer = xTimerCreate("SimTmr", xPeriod,
+		( config->mode != MML_TMR_MODE_ONE_SHOT ), pxTmr, prvTmrExpired);
+	if( pxTmr->xTimer == NULL )
+	{
+	    return COMMON_ERR_FATAL_ERROR;
+	}
+    }
+    else
+    {
+	xTimerStop(pxTmr->xTimer, 0);
+	xTimerChangePeriod(pxTmr->xTimer, xPeriod, 0);
+	xTimerStop(pxTmr->xTimer, 0);
+    }
+    pxTmr->ulRunning = 0;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_reset_interface( void )
+{
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_enable( mml_tmr_id_t id )
+{
+    if( ( id >= MML_TMR_DEV_COUNT ) || ( prvTmr[id].xTimer == NULL ) )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+    prvTmr[id].ullStartNs = ullSimNowNs( );
+    prvTmr[id].ulRunning = 1;
+    xTimerReset(prvTmr[id].xTimer, 0);
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_disable( mml_tmr_id_t id )
+{
+    if( ( id >= MML_TMR_DEV_COUNT ) || ( prvTmr[id].xTimer == NULL ) )
+    {
+	return COMMON_ERR_NOT_INITIALIZED;
+    }
+    prvTmr[id].ulRunning = 0;
+    xTimerStop(prvTmr[id].xTimer, 0);
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_close( mml_tmr_id_t id )
+{
+    int lResult;
+
+    lResult = mml_tmr_disable(id);
+    if( lResult == NO_ERROR )
+    {
+	prvTmr[id].ulIrqEnabled = 0;
+    }
+    return lResult;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_read( mml_tmr_id_t id, unsigned int *p_count )
+{
+    uint64_t ullElapsed;
+
+    if( id >= MML_TMR_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if( p_count == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( !prvTmr[id].ulRunning )
+    {
+	*p_count = 0;
+	return NO_ERROR;
+    }
+    /* convert elapsed host time back to prescaled timer counts */
+    ullElapsed = ullSimNowNs( ) - prvTmr[id].ullStartNs;
+    *p_count = (unsigned int) ( ( ( ullElapsed * MML_SYS_FREQ ) / 1000000000ULL )
+	    >> prvTmr[id].xConfig.clock );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_interrupt_enable( mml_tmr_id_t id )
+{
+    if( id >= MML_TMR_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    prvTmr[id].ulIrqEnabled = 1;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_tmr_interrupt_clear( mml_tmr_id_t id )
+{
+    return ( id < MML_TMR_DEV_COUNT ) ? NO_ERROR : COMMON_ERR_OUT_OF_RANGE;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lRtcGetRTCSeconds( uint32_t *pulSeconds )
+{
+    if( pulSeconds == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    *pulSeconds = (uint32_t) ( (int64_t) time(NULL) + prvRtcOffset );
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lRtcConvertRawToDateTime( uint32_t ulSeconds,
+				  rtcDateTime_t *pxDateTime )
+{
+    time_t xTime = (time_t) ulSeconds;
+    struct tm xTm;
+
+    if( pxDateTime == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    if( gmtime_r(&xTime, &xTm) == NULL )
+    {
+	return COMMON_ERR_INVAL;
+    }
+    pxDateTime->ucMonth = (uint8_t) ( xTm.tm_mon + 1 );
+    pxDateTime->ucDate = (uint8_t) xTm.tm_mday;
+    pxDateTime->usYear = (uint16_t) ( xTm.tm_year + 1900 );
+    pxDateTime->ucHour = (uint8_t) xTm.tm_hour;
+    pxDateTime->ucMinute = (uint8_t) xTm.tm_min;
+    pxDateTime->ucSecond = (uint8_t) xTm.tm_sec;
+    pxDateTime->ucWeekday = (uint8_t) xTm.tm_wday;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lRtcGetDateTime( rtcDateTime_t *pxDateTime )
+{
+    uint32_t ulSeconds;
+
+    lRtcGetRTCSeconds(&ulSeconds);
+    return lRtcConvertRawToDateTime(ulSeconds, pxDateTime);
+}
+/*----------------------------------------------------------------------------*/
+
+int32_t lRtcSetDateTime( rtcDateTime_t *pxDateTime )
+{
+    struct tm xTm;
+
+    if( pxDateTime == NULL )
+    {
+	return COMMON_ERR_NULL_PTR;
+    }
+    memset(&xTm, 0, sizeof(xTm));
+    xTm.tm_mon = pxDateTime->ucMonth - 1;
+    xTm.tm_mday = pxDateTime->ucDate;
+    xTm.tm_year = pxDateTime->usYear - 1900;
+    xTm.tm_hour = pxDateTime->ucHour;
+    xTm.tm_min = pxDateTime->ucMinute;
+    xTm.tm_sec = pxDateTime->ucSecond;
+    prvRtcOffset = (int64_t) timegm(&xTm) - (int64_t) time(NULL);
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
@@ -0,0 +1,93 @@
+ /**===========================================================================
+ * @file sim_trng.c
+ *
+ * @brief This file contains the TRNG model of the host simulation. The register
+ * model keeps the data register refilled from a xorshift generator and
+ * completes AES key generation requests.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stdint.h>
+#include <time.h>
+
+/* simulated driver includes */
+#include <mml_trng_regs.h>
+
+/* simulation includes */
+#include <sim.h>
+#include "sim_private.h"
+
+/** generator state */
+static uint32_t prvTrngState;
+
+/*----------------------------------------------------------------------------*/
+
+/** @brief Next generator output.
+ *
+ * @return pseudo random word.
+ */
+static uint32_t prvTrngNext( void )
+{
+    uint32_t ulX = prvTrngState;
+
+    if( ulX == 0 )
+    {
+	ulX = (uint32_t) time(NULL) | 1U;
+    }
+    ulX ^= ulX << 13;
+    ulX ^= ulX >> 17;
+    ulX ^= ulX << 5;
+    prvTrngState = ulX;
+    return ulX;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimTrngSeed( uint32_t ulSeed )
+{
+    prvTrngState = ulSeed;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimTrngService( void )
+{
+    volatile mml_trng_regs_t *pxTrng = (volatile mml_trng_regs_t *)MML_TRNG_IOBASE;
+    uint32_t ulCr;
+
+    ulCr = pxTrng->trngcr;
+    /* key generation completes within one service period */
+    ulCr &= ~( MML_TRNGCN_AESKG_MASK | MML_TRNGCN_RNG_ISC_MASK );
+    /* 128 bit of fresh data are always available */
+    ulCr |= MML_TRNGCN_RNG_I4S_MASK;
+    pxTrng->trngcr = ulCr;
+    pxTrng->trngdr = prvTrngNext( );
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
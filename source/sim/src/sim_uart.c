@@ -0,0 +1,259 @@
+ /**===========================================================================
+ * @file sim_uart.c
+ *
+ * @brief This file contains the simulated UART ports. The console port prints to
+ * stdout. Receive data is injected byte by byte through the register window
+ * and transmitted bytes are kept in a capture ring per port.
+ *
+ * @author ravikiran.hv@design-shift.com
+ *
+ ============================================================================
+ *
+ * Copyright  Design SHIFT, 2017-2018
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright.
+ *     * Neither the name of the [ORWL] nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ ============================================================================
+ *
+ */
+
+/* Global includes */
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/* simulated driver includes */
+#include <errors.h>
+#include <mml_uart.h>
+#include <mml_uart_regs.h>
+#include <mml_intc.h>
+
+/* simulation includes */
+#include <sim.h>
+
+/**
+ * @brief State of a simulated UART port.
+ */
+typedef struct
+{
+    /** register window of the port */
+    volatile mml_uart_regs_t	*pxRegs;
+    /** handler installed by mml_uart_init() */
+    mml_uart_handler_t		pvHandler;
+    /** platform level interrupt gate */
+    uint32_t			ulIrqEnabled;
+    /** transmit capture ring */
+    uint8_t			ucTxRing[simUART_TX_RING_SIZE];
+    /** ring write index */
+    uint32_t			ulTxHead;
+    /** ring read index */
+    uint32_t			ulTxTail;
+} simUart_t;
+
+/** simulated ports */
+static simUart_t prvUart[MML_UART_DEV_COUNT] = {
+    { (volatile mml_uart_regs_t *) MML_UART0_IOBASE, NULL, 0, {0}, 0, 0 },
+    { (volatile mml_uart_regs_t *) MML_UART1_IOBASE, NULL, 0, {0}, 0, 0 },
+};
+
+/** console mute */
+static uint32_t prvUartConsoleMute;
+
+/*----------------------------------------------------------------------------*/
+
+int mml_uart_init( mml_uart_id_t id, mml_uart_config_t config )
+{
+    if( id >= MML_UART_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    prvUart[id].pvHandler = config.handler;
+    prvUart[id].pxRegs->sr = MML_UART_SR_RXEMPTY_MASK | MML_UART_SR_TXEMPTY_MASK;
+    prvUart[id].pxRegs->isr = 0;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_uart_reset_interface( void )
+{
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_uart_write_char( mml_uart_id_t id, unsigned char data )
+{
+    if( id >= MML_UART_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if( id == MML_UART_DEV0 )
+    {
+	if( !prvUartConsoleMute )
+	{
+	    putchar(data);
+	}
+    }
+    else
+    {
+	vSimUartTxPut(id, data);
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_uart_flush_raw( mml_uart_id_t id, unsigned int mask )
+{
+    if( id >= MML_UART_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    if( mask & MML_UART_CR_RXFLUSH_MASK )
+    {
+	prvUart[id].pxRegs->sr |= MML_UART_SR_RXEMPTY_MASK;
+    }
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+void mml_uart_interrupt_clear( mml_uart_id_t id, unsigned int mask )
+{
+    if( id < MML_UART_DEV_COUNT )
+    {
+	prvUart[id].pxRegs->isr &= ~mask;
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+void mml_uart_interrupt_set( mml_uart_id_t id, unsigned int mask )
+{
+    if( id < MML_UART_DEV_COUNT )
+    {
+	prvUart[id].pxRegs->ier |= mask;
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+void mml_uart_interrupt_ack( mml_uart_id_t id )
+{
+    (void) id;
+}
+/*----------------------------------------------------------------------------*/
+
+int mml_uart_irq_gate( mml_uart_id_t id, int enable )
+{
+    if( id >= MML_UART_DEV_COUNT )
+    {
+	return COMMON_ERR_OUT_OF_RANGE;
+    }
+    prvUart[id].ulIrqEnabled = (uint32_t) enable;
+    return NO_ERROR;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimUartInject( mml_uart_id_t eId, const uint8_t *pucData,
+		     uint32_t ulLen )
+{
+    simUart_t *pxUart;
+    uint32_t ulIndex;
+
+    if( ( eId >= MML_UART_DEV_COUNT ) || ( pucData == NULL ) )
+    {
+	return;
+    }
+    pxUart = &prvUart[eId];
+    for( ulIndex = 0; ulIndex < ulLen; ulIndex++ )
+    {
+	/* one byte in the FIFO; the handler drains it and sees RX empty */
+	pxUart->pxRegs->dr = pucData[ulIndex];
+	pxUart->pxRegs->sr |= MML_UART_SR_RXEMPTY_MASK;
+	if( pxUart->ulIrqEnabled && pxUart->pvHandler &&
+	    ( pxUart->pxRegs->ier & MML_UART_IER_FFRXIE_MASK ) )
+	{
+	    pxUart->pxRegs->isr |= MML_UART_ISR_FFRXIS_MASK;
+	    pxUart->pvHandler( );
+	}
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimUartTxPut( mml_uart_id_t eId, uint8_t ucData )
+{
+    simUart_t *pxUart;
+
+    if( eId >= MML_UART_DEV_COUNT )
+    {
+	return;
+    }
+    pxUart = &prvUart[eId];
+    pxUart->ucTxRing[pxUart->ulTxHead & ( simUART_TX_RING_SIZE - 1 )] = ucData;
+    pxUart->ulTxHead++;
+    /* oldest data is overwritten when the reader falls behind */
+    if( ( pxUart->ulTxHead - pxUart->ulTxTail ) > simUART_TX_RING_SIZE )
+    {
+	pxUart->ulTxTail = pxUart->ulTxHead - simUART_TX_RING_SIZE;
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimUartTxKick( mml_uart_id_t eId )
+{
+    simUart_t *pxUart;
+
+    if( eId >= MML_UART_DEV_COUNT )
+    {
+	return;
+    }
+    pxUart = &prvUart[eId];
+    if( pxUart->ulIrqEnabled && pxUart->pvHandler &&
+	( pxUart->pxRegs->ier & MML_UART_IER_FFTXHIE_MASK ) )
+    {
+	pxUart->pxRegs->isr |= MML_UART_ISR_FFTXHIS_MASK;
+	pxUart->pvHandler( );
+    }
+}
+/*----------------------------------------------------------------------------*/
+
+uint32_t ulSimUartTxRead( mml_uart_id_t eId, uint8_t *pucData,
+			  uint32_t ulMax )
+{
+    simUart_t *pxUart;
+    uint32_t ulCount = 0;
+
+    if( ( eId >= MML_UART_DEV_COUNT ) || ( pucData == NULL ) )
+    {
+	return 0;
+    }
+    pxUart = &prvUart[eId];
+    while( ( ulCount < ulMax ) && ( pxUart->ulTxTail != pxUart->ulTxHead ) )
+    {
+	pucData[ulCount++] =
+		pxUart->ucTxRing[pxUart->ulTxTail & ( simUART_TX_RING_SIZE - 1 )];
+	pxUart->ulTxTail++;
+    }
+    return ulCount;
+}
+/*----------------------------------------------------------------------------*/
+
+void vSimUartConsoleMute( uint32_t ulMute )
+{
+    prvUartConsoleMute = ulMute;
+}
+/*----------------------------------------------------------------------------*/
+/* EOF */
@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+#===========================================================================
+# @file logring_decode.py
+#
+# @brief Decodes the binary console log of a firmware built with
+#	  -D_DEBUG_LOG_BINARY_. Format strings and function names are sent as
+#	  flash addresses and resolved from the ELF image of the same build.
+#
+#	  usage: logring_decode.py <firmware.elf> [capture file, default stdin]
+#
+# @author ravikiran@design-shift.com
+#
+#============================================================================
+#
+# Copyright (c) Design SHIFT, 2017-2018
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 	Redistributions of source code must retain the above copyright.
+# 	Neither the name of the [ORWL] nor the
+#	names of its contributors may be used to endorse or promote products
+#	derived from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY DESIGN SHIFT ''AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL DESIGN SHIFT BE LIABLE FOR ANY
+# DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#============================================================================
+
+import struct
+import sys
+
+# must match logring.h
+SYNC = b'\xa5\x5a'
+LEVEL_PLAIN, LEVEL_DBG, LEVEL_ERR, LEVEL_WARN, LEVEL_ISR_ERR, LEVEL_DROPPED = range(6)
+PREFIX = { LEVEL_DBG: '[ORWL_DBG]:', LEVEL_ERR: '[ORWL_ERR]:',
+           LEVEL_WARN: '[ORWL_WARNING]:', LEVEL_ISR_ERR: '[ISR_ERR]:' }
+# must match printf_lite.h
+PACK_NULL = 0xFFFFFFFF
+
+
+class Image(object):
+    """Allocated sections of an ELF32 little endian image."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+            raise ValueError('%s: not an ELF32 little endian image' % path)
+        shoff, = struct.unpack_from('<I', data, 0x20)
+        shentsize, shnum = struct.unpack_from('<HH', data, 0x2e)
+        self.sections = []
+        for i in range(shnum):
+            (name, stype, flags, addr, offset,
+             size) = struct.unpack_from('<IIIIII', data, shoff + i * shentsize)
+            # SHF_ALLOC with contents (not NOBITS)
+            if (flags & 2) and stype != 8 and size:
+                self.sections.append((addr, data[offset:offset + size]))
+
+    def string(self, addr):
+        for base, blob in self.sections:
+            if base <= addr < base + len(blob):
+                end = blob.find(b'\0', addr - base)
+                if end < 0:
+                    end = len(blob)
+                return blob[addr - base:end].decode('latin-1')
+        return '<0x%08x>' % addr
+
+
+def lite_format(fmt, words, strings):
+    """Formats like printf_lite from packed argument words."""
+    out = []
+    args = iter(words)
+    i = 0
+    while i < len(fmt):
+        c = fmt[i]
+        i += 1
+        if c != '%':
+            out.append(c)
+            continue
+        left = zero = False
+        width = 0
+        if i < len(fmt) and fmt[i] == '-':
+            left = True
+            i += 1
+        if i < len(fmt) and fmt[i] == '0':
+            zero = True
+            i += 1
+        while i < len(fmt) and (fmt[i].isdigit() or fmt[i] == '.'):
+            if fmt[i] != '.':
+                width = width * 10 + int(fmt[i])
+            i += 1
+        longs = 0
+        while i < len(fmt) and fmt[i] == 'l':
+            longs += 1
+            i += 1
+        if i >= len(fmt):
+            break
+        conv = fmt[i]
+        i += 1
+        if conv == '%':
+            out.append('%')
+            continue
+        if conv == 's':
+            off = next(args, PACK_NULL)
+            if off == PACK_NULL:
+                text = '<null>'
+            else:
+                end = strings.find(b'\0', off)
+                text = strings[off:end if end >= 0 else None].decode('latin-1')
+        elif conv == 'c':
+            text = chr(next(args, 0) & 0xff)
+        else:
+            value = next(args, 0)
+            # firmware longs are 32 bit, long long takes two words
+            if longs >= 2:
+                value |= next(args, 0) << 32
+                bits = 64
+            else:
+                bits = 32
+            if conv in 'di' and value >> (bits - 1):
+                value -= 1 << bits
+            if conv == 'p':
+                text = '0x%08x' % value
+            elif conv in 'xX':
+                text = '%x' % value
+                if conv == 'X':
+                    text = text.upper()
+            elif conv == 'b':
+                text = bin(value)[2:]
+            else:
+                text = '%d' % value
+        pad = ('0' if zero and not left and conv != 's' else ' ')
+        if left:
+            text = text.ljust(width)
+        elif pad == '0' and text.startswith('-'):
+            text = '-' + text[1:].rjust(width - 1, '0')
+        else:
+            text = text.rjust(width, pad)
+        out.append(text)
+    return ''.join(out)
+
+
+def records(stream):
+    """Yields the payloads of valid frames; noise between frames is skipped."""
+    buf = b''
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            return
+        buf += chunk
+        while True:
+            start = buf.find(SYNC)
+            if start < 0:
+                buf = buf[-1:]
+                break
+            if len(buf) < start + 3:
+                buf = buf[start:]
+                break
+            length = buf[start + 2]
+            end = start + 3 + length
+            if len(buf) < end + 1:
+                buf = buf[start:]
+                break
+            payload = buf[start + 3:end]
+            if sum(payload) & 0xff == buf[end]:
+                yield payload
+                buf = buf[end + 1:]
+            else:
+                buf = buf[start + 1:]
+
+
+def decode(image, payload):
+    fmt, func, tick, line, level, nargs = struct.unpack_from('<IIIHBB', payload)
+    pos = 16
+    words = struct.unpack_from('<%dI' % nargs, payload, pos)
+    pos += 4 * nargs
+    strlen = payload[pos]
+    strings = payload[pos + 1:pos + 1 + strlen] + b'\0'
+
+    if level == LEVEL_DROPPED:
+        return '[%10u] [ORWL_LOG]: %d records dropped!!!!\n' % (tick, words[0])
+    text = ''
+    if level in PREFIX:
+        text = PREFIX[level]
+        if func:
+            text += '%s():%d:' % (image.string(func), line)
+    text += lite_format(image.string(fmt), words, strings)
+    if level == LEVEL_DBG:
+        text += '\n'
+    elif level != LEVEL_PLAIN:
+        text += '!!!!\n'
+    return '[%10u] %s' % (tick, text)
+
+
+def main(argv):
+    if len(argv) not in (2, 3):
+        sys.stderr.write('usage: %s <firmware.elf> [capture]\n' % argv[0])
+        return 1
+    image = Image(argv[1])
+    stream = open(argv[2], 'rb') if len(argv) == 3 else sys.stdin.buffer
+    for payload in records(stream):
+        sys.stdout.write(decode(image, payload))
+        sys.stdout.flush()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
+
+# EOF